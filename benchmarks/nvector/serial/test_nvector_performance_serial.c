@@ -47,6 +47,7 @@ int main(int argc, char *argv[])
   int nvecs;           /* number of tests    */
   int nsums;           /* number of sums     */
   int cachesize;       /* size of cache (MB) */
+  int simd;            /* use SIMD kernels   */
   int flag;            /* return flag        */
 
   printf("\nStart Tests\n");
@@ -56,7 +57,7 @@ int main(int argc, char *argv[])
   if (argc < 7){
     printf("ERROR: SIX (6) arguments required: ");
     printf("<vector length> <number of vectors> <number of sums> <number of tests> ");
-    printf("<cache size (MB)> <print timing>\n");
+    printf("<cache size (MB)> <print timing> [<use SIMD kernels>]\n");
     return(-1);
   }
 
@@ -92,18 +93,22 @@ int main(int argc, char *argv[])
   print_timing = atoi(argv[6]);
   SetTiming(print_timing, 0);
 
+  simd = (argc > 7) ? atoi(argv[7]) : 0;
+
   printf("\nRunning with: \n");
   printf("  vector length         %ld \n", (long int) veclen);
   printf("  max number of vectors %d  \n", nvecs);
   printf("  max number of sums    %d  \n", nsums);
   printf("  number of tests       %d  \n", ntests);
   printf("  timing on/off         %d  \n", print_timing);
+  printf("  SIMD kernels on/off   %d  \n", simd);
 
   flag = SUNContext_Create(NULL, &ctx);
   if (flag) return flag;
 
   /* Create vectors */
   X = N_VNew_Serial(veclen, ctx);
+  N_VEnableSIMD_Serial(X, simd);
 
   /* run tests */
   if (print_timing) printf("\n\n standard operations:\n");
@@ -20,14 +20,8 @@
 # Currently only available in CVODE.
 # ---------------------------------------------------------------
 
-if(ENABLE_CUDA OR ENABLE_HIP)
-  set(CUDA_OR_HIP TRUE)
-else()
-  set(CUDA_OR_HIP FALSE)
-endif()
-
-sundials_option(SUNDIALS_BUILD_PACKAGE_FUSED_KERNELS BOOL "Build specialized fused GPU kernels" OFF
-                DEPENDS_ON BUILD_CVODE CUDA_OR_HIP
+sundials_option(SUNDIALS_BUILD_PACKAGE_FUSED_KERNELS BOOL "Build specialized fused integrator kernels" OFF
+                DEPENDS_ON BUILD_CVODE
                 DEPENDS_ON_THROW_ERROR)
 
 # ---------------------------------------------------------------
@@ -120,6 +114,8 @@ list(APPEND SUNDIALS_BUILD_LIST "BUILD_NVECTOR_KOKKOS")
 # required modules are in the build list, but cannot be disabled
 set(BUILD_SUNMATRIX_BAND TRUE)
 list(APPEND SUNDIALS_BUILD_LIST "BUILD_SUNMATRIX_BAND")
+set(BUILD_SUNMATRIX_BLOCKDENSE TRUE)
+list(APPEND SUNDIALS_BUILD_LIST "BUILD_SUNMATRIX_BLOCKDENSE")
 set(BUILD_SUNMATRIX_DENSE TRUE)
 list(APPEND SUNDIALS_BUILD_LIST "BUILD_SUNMATRIX_DENSE")
 set(BUILD_SUNMATRIX_SPARSE TRUE)
@@ -178,6 +174,12 @@ set(BUILD_SUNLINSOL_SPGMR TRUE)
 list(APPEND SUNDIALS_BUILD_LIST "BUILD_SUNLINSOL_SPGMR")
 set(BUILD_SUNLINSOL_SPTFQMR TRUE)
 list(APPEND SUNDIALS_BUILD_LIST "BUILD_SUNLINSOL_SPTFQMR")
+set(BUILD_SUNLINSOL_SSGMR TRUE)
+list(APPEND SUNDIALS_BUILD_LIST "BUILD_SUNLINSOL_SSGMR")
+set(BUILD_SUNLINSOL_GCRODR TRUE)
+list(APPEND SUNDIALS_BUILD_LIST "BUILD_SUNLINSOL_GCRODR")
+set(BUILD_SUNLINSOL_BLOCKDENSE TRUE)
+list(APPEND SUNDIALS_BUILD_LIST "BUILD_SUNLINSOL_BLOCKDENSE")
 
 sundials_option(BUILD_SUNLINSOL_CUSOLVERSP BOOL "Build the SUNLINSOL_CUSOLVERSP module (requires CUDA and 32-bit indexing)" ON
                 DEPENDS_ON ENABLE_CUDA CMAKE_CUDA_COMPILER BUILD_NVECTOR_CUDA BUILD_SUNMATRIX_CUSPARSE
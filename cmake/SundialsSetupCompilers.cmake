@@ -231,6 +231,42 @@ if(SUNDIALS_BUILD_WITH_PROFILING AND
   message(SEND_ERROR "The SUNDIALS native profiler requires POSIX timers or MPI_Wtime, but neither were found.")
 endif()
 
+# ---------------------------------------------------------------
+# Check for Linux perf events used by the profiler hardware counters
+# ---------------------------------------------------------------
+if(SUNDIALS_BUILD_WITH_PROFILING AND (NOT ENABLE_CALIPER))
+  check_c_source_compiles("
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    int main() {
+      struct perf_event_attr attr;
+      attr.size = sizeof(attr);
+      return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0) &&
+             ioctl(0, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    }
+  " SUNDIALS_PERF_EVENTS)
+endif()
+
+# ---------------------------------------------------------------
+# Check for memory mapped files used by the CVODES adjoint
+# check point file
+# ---------------------------------------------------------------
+if(BUILD_CVODES)
+  check_c_source_compiles("
+    #define _POSIX_C_SOURCE 200809L
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+    int main() {
+      void *p = mmap(0, 1, PROT_READ, MAP_PRIVATE, 0, 0);
+      return (p == MAP_FAILED) + (int) pwrite(0, p, 1, 0) +
+             posix_fadvise(0, 0, 1, POSIX_FADV_WILLNEED);
+    }
+  " SUNDIALS_MMAP)
+endif()
+
 # ---------------------------------------------------------------
 # Check for deprecated attribute with message
 # ---------------------------------------------------------------
@@ -96,6 +96,25 @@ if(SUNDIALS_POSIX_TIMERS) # set in SundialsPOSIXTimers.cmake
   set(SUNDIALS_HAVE_POSIX_TIMERS TRUE)
 endif()
 
+# prepare substitution variable SUNDIALS_LOGGING_HAVE_PTHREADS for
+# sundials_config.h, the asynchronous logger uses a POSIX thread
+if(SUNDIALS_LOGGING_LEVEL GREATER_EQUAL 1)
+  find_package(Threads)
+  if(CMAKE_USE_PTHREADS_INIT)
+    set(SUNDIALS_LOGGING_HAVE_PTHREADS TRUE)
+  endif()
+endif()
+
+# prepare substitution variable SUNDIALS_HAVE_PERF_EVENTS for sundials_config.h
+if(SUNDIALS_PERF_EVENTS) # set in SundialsSetupCompilers.cmake
+  set(SUNDIALS_HAVE_PERF_EVENTS TRUE)
+endif()
+
+# prepare substitution variable SUNDIALS_HAVE_MMAP for sundials_config.h
+if(SUNDIALS_MMAP) # set in SundialsSetupCompilers.cmake
+  set(SUNDIALS_HAVE_MMAP TRUE)
+endif()
+
 # =============================================================================
 # All required substitution variables should be available at this point.
 # Generate the header file and place it in the binary dir.
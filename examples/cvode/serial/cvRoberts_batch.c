@@ -0,0 +1,433 @@
+/* -----------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------
+ * The following example integrates an ensemble of independent
+ * chemical kinetics problems with the batched CVODE integrator.
+ * Each system is the Robertson problem from cvRoberts_dns.c,
+ *    dy1/dt = -k1*y1 + k2*y2*y3
+ *    dy2/dt = k1*y1 - k2*y2*y3 - k3*(y2)^2
+ *    dy3/dt = k3*(y2)^2
+ * with k1 = .04*(1 + s/nsys), k2 = 1.e4, k3 = 3.e7 for system s,
+ * on the interval from t = 0.0 to t = 4.e10, with initial
+ * conditions: y1 = 1.0, y2 = y3 = 0. The problem is stiff and the
+ * different rate constants lead to different step size and order
+ * sequences in the systems.
+ *
+ * The program integrates the ensemble with CVodeBatch, using the
+ * batched user-supplied Jacobian or difference quotient Jacobians,
+ * prints the first and last systems in decades from t = .4 to
+ * t = 4.e10. The solutions at t = 4.e4 are then compared with
+ * reference solutions computed by CVODE with the dense linear solver
+ * for each system separately, using tolerances 1.e-4 times smaller.
+ *
+ * The program takes three optional arguments, the number of systems,
+ * a flag to use difference quotient Jacobians (0 or 1), and the
+ * number of OpenMP threads:
+ *
+ *    ./cvRoberts_batch [nsys] [dq] [nthreads]
+ * -----------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cvode/cvode.h>              /* prototypes for CVODE fcts., consts.  */
+#include <cvode/cvode_batch.h>        /* prototypes for batched CVODE fcts.   */
+#include <nvector/nvector_serial.h>   /* access to serial N_Vector            */
+#include <sunmatrix/sunmatrix_dense.h> /* access to dense SUNMatrix           */
+#include <sunlinsol/sunlinsol_dense.h> /* access to dense SUNLinearSolver     */
+#include <sundials/sundials_math.h>   /* defs. of SUNRabs, SUNMAX             */
+#include <sundials/sundials_types.h>  /* defs. of realtype, sunindextype      */
+
+/* Problem Constants */
+
+#define NEQ   3                /* number of equations per system       */
+#define NSYS  100              /* default number of systems            */
+#define Y1    RCONST(1.0)      /* initial y components */
+#define Y2    RCONST(0.0)
+#define Y3    RCONST(0.0)
+#define RTOL  RCONST(1.0e-4)   /* scalar relative tolerance            */
+#define ATOL1 RCONST(1.0e-8)   /* vector absolute tolerance components */
+#define ATOL2 RCONST(1.0e-14)
+#define ATOL3 RCONST(1.0e-6)
+#define T0    RCONST(0.0)      /* initial time           */
+#define T1    RCONST(0.4)      /* first output time      */
+#define TMULT RCONST(10.0)     /* output time factor     */
+#define NOUT  12               /* number of output times */
+#define NCMP  5                /* output used in the comparison to CVODE */
+#define RFAC  RCONST(1.0e-4)   /* reference tolerance factor             */
+#define MAXERR RCONST(10.0)    /* allowed weighted error                 */
+
+#define ZERO  RCONST(0.0)
+#define ONE   RCONST(1.0)
+
+/* User data: the rate constant k1 of each system */
+
+typedef struct {
+  int nsys;
+  realtype *k1;
+  int sysid;     /* system integrated by f and Jac */
+} *UserData;
+
+/* Functions Called by the Solvers */
+
+static int fbatch(int nactive, const int *sysid, const realtype *t,
+                  realtype *y, realtype *ydot, void *user_data);
+
+static int Jbatch(int nactive, const int *sysid, const realtype *t,
+                  realtype *y, realtype *fy, realtype *J, sunindextype ldj,
+                  void *user_data);
+
+static int f(realtype t, N_Vector y, N_Vector ydot, void *user_data);
+
+static int Jac(realtype t, N_Vector y, N_Vector fy, SUNMatrix J,
+               void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3);
+
+/* Private functions */
+
+static int SolveSerial(SUNContext sunctx, UserData data, N_Vector ybatch,
+                       realtype tout, N_Vector abstol);
+static int check_retval(void *returnvalue, const char *funcname, int opt);
+
+/*
+ *-------------------------------
+ * Main Program
+ *-------------------------------
+ */
+
+int main(int argc, char *argv[])
+{
+  SUNContext sunctx;
+  realtype tout, tcmp, *ydata;
+  N_Vector y, ycmp, abstol;
+  UserData data;
+  void *cvb_mem;
+  long int nfe, nje, nsetups, *nst, nstmin, nstmax;
+  int nsys, dq, nthreads, retval, iout, s;
+
+  y = ycmp = abstol = NULL;
+  data = NULL;
+  cvb_mem = NULL;
+
+  nsys     = (argc > 1) ? atoi(argv[1]) : NSYS;
+  dq       = (argc > 2) ? atoi(argv[2]) : 0;
+  nthreads = (argc > 3) ? atoi(argv[3]) : 1;
+  if (nsys < 1) nsys = NSYS;
+  if (nthreads < 1) nthreads = 1;
+
+  /* Create the SUNDIALS context */
+  retval = SUNContext_Create(NULL, &sunctx);
+  if (check_retval(&retval, "SUNContext_Create", 1)) return(1);
+
+  /* Set the rate constants of all systems */
+  data = (UserData) malloc(sizeof *data);
+  data->nsys = nsys;
+  data->k1 = (realtype *) malloc(nsys * sizeof(realtype));
+  for (s = 0; s < nsys; s++)
+    data->k1[s] = RCONST(0.04) * (ONE + ((realtype) s) / nsys);
+
+  /* Initial conditions of all systems, stored one after another */
+  y = N_VNew_Serial(nsys * NEQ, sunctx);
+  if (check_retval((void *)y, "N_VNew_Serial", 0)) return(1);
+  ydata = N_VGetArrayPointer(y);
+  for (s = 0; s < nsys; s++) {
+    ydata[s*NEQ]   = Y1;
+    ydata[s*NEQ+1] = Y2;
+    ydata[s*NEQ+2] = Y3;
+  }
+
+  ycmp = N_VClone(y);
+  if (check_retval((void *)ycmp, "N_VClone", 0)) return(1);
+
+  /* Set the vector absolute tolerance shared by all systems */
+  abstol = N_VNew_Serial(NEQ, sunctx);
+  if (check_retval((void *)abstol, "N_VNew_Serial", 0)) return(1);
+  NV_Ith_S(abstol,0) = ATOL1;
+  NV_Ith_S(abstol,1) = ATOL2;
+  NV_Ith_S(abstol,2) = ATOL3;
+
+  /* Create and initialize the batched integrator */
+  cvb_mem = CVodeBatchCreate(nsys, NEQ, sunctx);
+  if (check_retval((void *)cvb_mem, "CVodeBatchCreate", 0)) return(1);
+
+  retval = CVodeBatchInit(cvb_mem, fbatch, T0, y);
+  if (check_retval(&retval, "CVodeBatchInit", 1)) return(1);
+
+  retval = CVodeBatchSVtolerances(cvb_mem, RTOL, abstol);
+  if (check_retval(&retval, "CVodeBatchSVtolerances", 1)) return(1);
+
+  retval = CVodeBatchSetUserData(cvb_mem, data);
+  if (check_retval(&retval, "CVodeBatchSetUserData", 1)) return(1);
+
+  if (!dq) {
+    retval = CVodeBatchSetJacFn(cvb_mem, Jbatch);
+    if (check_retval(&retval, "CVodeBatchSetJacFn", 1)) return(1);
+  }
+
+  retval = CVodeBatchSetNumThreads(cvb_mem, nthreads);
+  if (check_retval(&retval, "CVodeBatchSetNumThreads", 1)) return(1);
+
+  /* In loop, call CVodeBatch, print results, and test for error. */
+  printf("\nEnsemble of %d 3-species kinetics problems (%s Jacobian)\n\n",
+         nsys, dq ? "difference quotient" : "user-supplied");
+
+  tout = tcmp = T1;
+  for (iout = 0; iout < NOUT; iout++) {
+    retval = CVodeBatch(cvb_mem, tout, y);
+    if (check_retval(&retval, "CVodeBatch", 1)) return(1);
+
+    printf("At t = %0.4e  sys 0: %14.6e %14.6e %14.6e\n", tout,
+           ydata[0], ydata[1], ydata[2]);
+    printf("%22s sys %d: %14.6e %14.6e %14.6e\n", "", nsys-1,
+           ydata[(nsys-1)*NEQ], ydata[(nsys-1)*NEQ+1], ydata[(nsys-1)*NEQ+2]);
+
+    if (iout == NCMP) {
+      N_VScale(ONE, y, ycmp);
+      tcmp = tout;
+    }
+
+    tout *= TMULT;
+  }
+
+  /* Print some final statistics */
+  nst = (long int *) malloc(nsys * sizeof(long int));
+  retval = CVodeBatchGetNumSteps(cvb_mem, nst);
+  check_retval(&retval, "CVodeBatchGetNumSteps", 1);
+  nstmin = nstmax = nst[0];
+  for (s = 1; s < nsys; s++) {
+    nstmin = SUNMIN(nstmin, nst[s]);
+    nstmax = SUNMAX(nstmax, nst[s]);
+  }
+  retval = CVodeBatchGetNumRhsEvals(cvb_mem, &nfe);
+  check_retval(&retval, "CVodeBatchGetNumRhsEvals", 1);
+  retval = CVodeBatchGetNumJacEvals(cvb_mem, &nje);
+  check_retval(&retval, "CVodeBatchGetNumJacEvals", 1);
+  retval = CVodeBatchGetNumLinSolvSetups(cvb_mem, &nsetups);
+  check_retval(&retval, "CVodeBatchGetNumLinSolvSetups", 1);
+
+  printf("\nFinal Statistics:\n");
+  printf("steps per system = %ld to %ld\n", nstmin, nstmax);
+  printf("batched evaluations: nfe = %ld nje = %ld nsetups = %ld\n",
+         nfe, nje, nsetups);
+
+  /* Compare with CVODE reference solutions for each system */
+  retval = SolveSerial(sunctx, data, ycmp, tcmp, abstol);
+
+  /* Free memory */
+  free(nst);
+  CVodeBatchFree(&cvb_mem);
+  N_VDestroy(y);
+  N_VDestroy(ycmp);
+  N_VDestroy(abstol);
+  free(data->k1);
+  free(data);
+  SUNContext_Free(&sunctx);
+
+  return(retval);
+}
+
+/*
+ *-------------------------------
+ * Functions called by the solvers
+ *-------------------------------
+ */
+
+/* Batched right-hand side of the active systems */
+
+static int fbatch(int nactive, const int *sysid, const realtype *t,
+                  realtype *y, realtype *ydot, void *user_data)
+{
+  UserData data = (UserData) user_data;
+  realtype y1, y2, y3, k1, yd1, yd3;
+  int k;
+
+  for (k = 0; k < nactive; k++) {
+    k1 = data->k1[sysid[k]];
+    y1 = y[k*NEQ]; y2 = y[k*NEQ+1]; y3 = y[k*NEQ+2];
+
+    yd1 = ydot[k*NEQ]   = -k1*y1 + RCONST(1.0e4)*y2*y3;
+    yd3 = ydot[k*NEQ+2] = RCONST(3.0e7)*y2*y2;
+          ydot[k*NEQ+1] = -yd1 - yd3;
+  }
+
+  return(0);
+}
+
+/* Batched Jacobian, entry (i,j) of slot k is J[(j*NEQ + i)*ldj + k] */
+
+static int Jbatch(int nactive, const int *sysid, const realtype *t,
+                  realtype *y, realtype *fy, realtype *J, sunindextype ldj,
+                  void *user_data)
+{
+  UserData data = (UserData) user_data;
+  realtype y2, y3;
+  int k;
+
+  for (k = 0; k < nactive; k++) {
+    y2 = y[k*NEQ+1]; y3 = y[k*NEQ+2];
+
+    J[(0*NEQ+0)*ldj + k] = -data->k1[sysid[k]];
+    J[(1*NEQ+0)*ldj + k] = RCONST(1.0e4)*y3;
+    J[(2*NEQ+0)*ldj + k] = RCONST(1.0e4)*y2;
+
+    J[(0*NEQ+1)*ldj + k] = data->k1[sysid[k]];
+    J[(1*NEQ+1)*ldj + k] = RCONST(-1.0e4)*y3-RCONST(6.0e7)*y2;
+    J[(2*NEQ+1)*ldj + k] = RCONST(-1.0e4)*y2;
+
+    J[(0*NEQ+2)*ldj + k] = ZERO;
+    J[(1*NEQ+2)*ldj + k] = RCONST(6.0e7)*y2;
+    J[(2*NEQ+2)*ldj + k] = ZERO;
+  }
+
+  return(0);
+}
+
+/* Right-hand side and Jacobian of the system data->sysid for CVODE */
+
+static int f(realtype t, N_Vector y, N_Vector ydot, void *user_data)
+{
+  UserData data = (UserData) user_data;
+
+  return(fbatch(1, &(data->sysid), &t, N_VGetArrayPointer(y),
+                N_VGetArrayPointer(ydot), user_data));
+}
+
+static int Jac(realtype t, N_Vector y, N_Vector fy, SUNMatrix J,
+               void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
+{
+  UserData data = (UserData) user_data;
+
+  /* the dense matrix columns are contiguous, i.e. ldj = 1 */
+  return(Jbatch(1, &(data->sysid), &t, N_VGetArrayPointer(y),
+                N_VGetArrayPointer(fy), SUNDenseMatrix_Data(J), 1,
+                user_data));
+}
+
+/*
+ *-------------------------------
+ * Private helper functions
+ *-------------------------------
+ */
+
+/* Integrate every system with CVODE at tighter tolerances and check the
+   largest weighted error of the batched solutions ybatch at tout */
+
+static int SolveSerial(SUNContext sunctx, UserData data, N_Vector ybatch,
+                       realtype tout, N_Vector abstol)
+{
+  realtype t, *yb, *ys, *atol, w, err, maxerr;
+  N_Vector y, ratol;
+  SUNMatrix A;
+  SUNLinearSolver LS;
+  void *cvode_mem;
+  int s, i, retval;
+
+  y = N_VNew_Serial(NEQ, sunctx);
+  if (check_retval((void *)y, "N_VNew_Serial", 0)) return(1);
+  A = SUNDenseMatrix(NEQ, NEQ, sunctx);
+  if (check_retval((void *)A, "SUNDenseMatrix", 0)) return(1);
+  LS = SUNLinSol_Dense(y, A, sunctx);
+  if (check_retval((void *)LS, "SUNLinSol_Dense", 0)) return(1);
+
+  ratol = N_VClone(abstol);
+  if (check_retval((void *)ratol, "N_VClone", 0)) return(1);
+  N_VScale(RFAC, abstol, ratol);
+
+  ys   = N_VGetArrayPointer(y);
+  yb   = N_VGetArrayPointer(ybatch);
+  atol = N_VGetArrayPointer(abstol);
+
+  N_VConst(ZERO, y);
+  cvode_mem = CVodeCreate(CV_BDF, sunctx);
+  if (check_retval((void *)cvode_mem, "CVodeCreate", 0)) return(1);
+  retval = CVodeInit(cvode_mem, f, T0, y);
+  if (check_retval(&retval, "CVodeInit", 1)) return(1);
+  retval = CVodeSVtolerances(cvode_mem, RFAC*RTOL, ratol);
+  if (check_retval(&retval, "CVodeSVtolerances", 1)) return(1);
+  retval = CVodeSetUserData(cvode_mem, data);
+  if (check_retval(&retval, "CVodeSetUserData", 1)) return(1);
+  retval = CVodeSetLinearSolver(cvode_mem, LS, A);
+  if (check_retval(&retval, "CVodeSetLinearSolver", 1)) return(1);
+  retval = CVodeSetJacFn(cvode_mem, Jac);
+  if (check_retval(&retval, "CVodeSetJacFn", 1)) return(1);
+  retval = CVodeSetMaxNumSteps(cvode_mem, 50000);
+  if (check_retval(&retval, "CVodeSetMaxNumSteps", 1)) return(1);
+
+  maxerr = ZERO;
+  for (s = 0; s < data->nsys; s++) {
+    data->sysid = s;
+    ys[0] = Y1; ys[1] = Y2; ys[2] = Y3;
+    retval = CVodeReInit(cvode_mem, T0, y);
+    if (check_retval(&retval, "CVodeReInit", 1)) return(1);
+    retval = CVode(cvode_mem, tout, y, &t, CV_NORMAL);
+    if (check_retval(&retval, "CVode", 1)) return(1);
+
+    err = ZERO;
+    for (i = 0; i < NEQ; i++) {
+      w = ONE / (RTOL * SUNRabs(ys[i]) + atol[i]);
+      err = SUNMAX(err, SUNRabs(yb[s*NEQ + i] - ys[i]) * w);
+    }
+    maxerr = SUNMAX(maxerr, err);
+  }
+
+  printf("\nComparison with CVODE reference solutions at t = %0.4e: ", tout);
+  if (maxerr < MAXERR) {
+    printf("PASSED\n");
+    retval = 0;
+  } else {
+    printf("FAILED, max weighted error = %g\n", (double) maxerr);
+    retval = 1;
+  }
+
+  CVodeFree(&cvode_mem);
+  SUNLinSolFree(LS);
+  SUNMatDestroy(A);
+  N_VDestroy(ratol);
+  N_VDestroy(y);
+
+  return(retval);
+}
+
+/*
+ * Check function return value...
+ *   opt == 0 means SUNDIALS function allocates memory so check if
+ *            returned NULL pointer
+ *   opt == 1 means SUNDIALS function returns an integer value so check if
+ *            retval < 0
+ *   opt == 2 means function allocates memory so check if returned
+ *            NULL pointer
+ */
+
+static int check_retval(void *returnvalue, const char *funcname, int opt)
+{
+  int *retval;
+
+  /* Check if SUNDIALS function returned NULL pointer - no memory allocated */
+  if (opt == 0 && returnvalue == NULL) {
+    fprintf(stderr, "\nSUNDIALS_ERROR: %s() failed - returned NULL pointer\n\n",
+            funcname);
+    return(1); }
+
+  /* Check if retval < 0 */
+  else if (opt == 1) {
+    retval = (int *) returnvalue;
+    if (*retval < 0) {
+      fprintf(stderr, "\nSUNDIALS_ERROR: %s() failed with retval = %d\n\n",
+              funcname, *retval);
+      return(1); }}
+
+  /* Check if function returned NULL pointer - no memory allocated */
+  else if (opt == 2 && returnvalue == NULL) {
+    fprintf(stderr, "\nMEMORY_ERROR:  %s() failed - returned NULL pointer\n\n",
+            funcname);
+    return(1); }
+
+  return(0);
+}
@@ -32,6 +32,7 @@ int main(int argc, char *argv[])
   int          retval;            /* function return value     */
   sunindextype length;            /* vector length             */
   N_Vector     U, V, W, X, Y, Z;  /* test vectors              */
+  N_Vector     S, S1, S2;         /* SIMD test vectors         */
   int          print_timing;      /* turn timing on/off        */
 
   Test_Init(NULL);
@@ -195,6 +196,34 @@ int main(int argc, char *argv[])
   fails += Test_N_VScaleAddMultiVectorArray(V, length, 0);
   fails += Test_N_VLinearCombinationVectorArray(V, length, 0);
 
+  /* Explicitly vectorized operations tests */
+  printf("\nTesting SIMD vector operations:\n\n");
+
+  /* create vectors and enable fused operations and SIMD kernels */
+  S = N_VNew_Serial(length, sunctx);
+  retval = N_VEnableFusedOps_Serial(S, SUNTRUE);
+  if (S == NULL || retval != 0 || N_VEnableSIMD_Serial(S, SUNTRUE)) {
+    N_VDestroy(W);
+    N_VDestroy(X);
+    N_VDestroy(Y);
+    N_VDestroy(Z);
+    N_VDestroy(U);
+    N_VDestroy(V);
+    printf("FAIL: Unable to create a new vector \n\n");
+    Test_Finalize();
+    return(1);
+  }
+  S1 = N_VClone(S);
+  S2 = N_VClone(S);
+
+  fails += Test_N_VLinearSum(S, S1, S2, length, 0);
+  fails += Test_N_VDotProd(S, S1, length, 0);
+  fails += Test_N_VWrmsNorm(S, S1, length, 0);
+  fails += Test_N_VWSqrSumLocal(S, S1, length, 0);
+  fails += Test_N_VLinearCombination(S, length, 0);
+  fails += Test_N_VScaleAddMulti(S, length, 0);
+  fails += Test_N_VDotProdMulti(S, length, 0);
+
   /* local reduction operations */
   printf("\nTesting local reduction operations:\n\n");
 
@@ -226,6 +255,9 @@ int main(int argc, char *argv[])
   N_VDestroy(Z);
   N_VDestroy(U);
   N_VDestroy(V);
+  N_VDestroy(S);
+  N_VDestroy(S1);
+  N_VDestroy(S2);
 
   /* Print result */
   if (fails) {
@@ -0,0 +1,239 @@
+/*
+ * -----------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------
+ * This is the testing routine to check the SUNLinSol BlockDense
+ * module implementation.
+ * -----------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sundials/sundials_types.h>
+#include <sunlinsol/sunlinsol_blockdense.h>
+#include <sunmatrix/sunmatrix_blockdense.h>
+#include <nvector/nvector_serial.h>
+#include <sundials/sundials_math.h>
+#include "test_sunlinsol.h"
+
+#if defined(SUNDIALS_EXTENDED_PRECISION)
+#define GSYM "Lg"
+#define ESYM "Le"
+#define FSYM "Lf"
+#else
+#define GSYM "g"
+#define ESYM "e"
+#define FSYM "f"
+#endif
+
+/* prototypes for custom tests */
+int Test_ZeroPivot(SUNMatrix A, N_Vector x, SUNContext sunctx);
+
+/* ----------------------------------------------------------------------
+ * SUNLinSol_BlockDense Testing Routine
+ * --------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+  int             fails = 0;          /* counter for test failures  */
+  sunindextype    nblocks, M;         /* number and size of blocks  */
+  SUNLinearSolver LS;                 /* solver object              */
+  SUNMatrix       A, B;               /* test matrices              */
+  N_Vector        x, y, b;            /* test vectors               */
+  int             print_timing, num_threads;
+  sunindextype    i, j, k;
+  realtype        *xdata;
+  SUNContext      sunctx;
+
+  if (SUNContext_Create(NULL, &sunctx)) {
+    printf("ERROR: SUNContext_Create failed\n");
+    return(-1);
+  }
+
+  /* check input and set matrix dimensions */
+  if (argc < 5) {
+    printf("ERROR: FOUR (4) Inputs required: number of blocks, block size, number of threads, print timing \n");
+    return(-1);
+  }
+
+  nblocks = (sunindextype) atol(argv[1]);
+  if (nblocks <= 0) {
+    printf("ERROR: number of blocks must be a positive integer \n");
+    return(-1);
+  }
+
+  M = (sunindextype) atol(argv[2]);
+  if (M <= 0) {
+    printf("ERROR: block size must be a positive integer \n");
+    return(-1);
+  }
+
+  num_threads = atoi(argv[3]);
+  if (num_threads <= 0) {
+    printf("ERROR: number of threads must be a positive integer \n");
+    return(-1);
+  }
+
+  print_timing = atoi(argv[4]);
+  SetTiming(print_timing);
+
+  printf("\nBlock-diagonal dense linear solver test: %ld blocks of size %ld, %d threads\n\n",
+         (long int) nblocks, (long int) M, num_threads);
+
+  /* Create matrices and vectors */
+  A = SUNBlockDenseMatrix(nblocks, M, sunctx);
+  B = SUNBlockDenseMatrix(nblocks, M, sunctx);
+  SUNBlockDenseMatrix_SetNumThreads(A, num_threads);
+  x = N_VNew_Serial(nblocks*M, sunctx);
+  y = N_VNew_Serial(nblocks*M, sunctx);
+  b = N_VNew_Serial(nblocks*M, sunctx);
+
+  /* Fill each block with uniform random data in [0,1/M] plus the
+     anti-identity to ensure the solver needs to do row-swapping */
+  for (k=0; k<nblocks; k++) {
+    for (j=0; j<M; j++) {
+      for (i=0; i<M; i++)
+        SM_ELEMENT_BD(A,k,i,j) = (realtype) rand() / (realtype) RAND_MAX / M;
+      SM_ELEMENT_BD(A,k,M-1-j,j) += ONE;
+    }
+  }
+
+  /* Fill x vector with uniform random data in [0,1] */
+  xdata = N_VGetArrayPointer(x);
+  for (j=0; j<nblocks*M; j++) {
+    xdata[j] = (realtype) rand() / (realtype) RAND_MAX;
+  }
+
+  /* copy A and x into B and y to print in case of solver failure */
+  SUNMatCopy(A, B);
+  N_VScale(ONE, x, y);
+
+  /* create right-hand side vector for linear solve */
+  fails = SUNMatMatvec(A, x, b);
+  if (fails) {
+    printf("FAIL: SUNLinSol SUNMatMatvec failure\n");
+
+    /* Free matrices and vectors */
+    SUNMatDestroy(A);
+    SUNMatDestroy(B);
+    N_VDestroy(x);
+    N_VDestroy(y);
+    N_VDestroy(b);
+
+    return(1);
+  }
+
+  /* Create block-diagonal dense linear solver */
+  LS = SUNLinSol_BlockDense(x, A, sunctx);
+
+  /* Run Tests */
+  fails += Test_SUNLinSolInitialize(LS, 0);
+  fails += Test_SUNLinSolSetup(LS, A, 0);
+  fails += Test_SUNLinSolSolve(LS, A, x, b, 100*UNIT_ROUNDOFF, SUNTRUE, 0);
+
+  fails += Test_SUNLinSolGetType(LS, SUNLINEARSOLVER_DIRECT, 0);
+  fails += Test_SUNLinSolGetID(LS, SUNLINEARSOLVER_BLOCKDENSE, 0);
+  fails += Test_SUNLinSolLastFlag(LS, 0);
+  fails += Test_SUNLinSolSpace(LS, 0);
+
+  /* Zero pivot in a single block */
+  fails += Test_ZeroPivot(B, y, sunctx);
+
+  /* Print result */
+  if (fails) {
+    printf("FAIL: SUNLinSol module failed %i tests \n \n", fails);
+  } else {
+    printf("SUCCESS: SUNLinSol module passed all tests \n \n");
+  }
+
+  /* Free solver, matrix and vectors */
+  SUNLinSolFree(LS);
+  SUNMatDestroy(A);
+  SUNMatDestroy(B);
+  N_VDestroy(x);
+  N_VDestroy(y);
+  N_VDestroy(b);
+  SUNContext_Free(&sunctx);
+
+  return(fails);
+}
+
+/* ----------------------------------------------------------------------
+ * Zero pivot test:
+ *    zeroing the last column of the last block makes that block
+ *    singular, the setup should fail and the last flag should give
+ *    the global column of the zero pivot
+ * --------------------------------------------------------------------*/
+int Test_ZeroPivot(SUNMatrix A, N_Vector x, SUNContext sunctx)
+{
+  int             failure = 0;
+  SUNLinearSolver LS;
+  SUNMatrix       C;
+  sunindextype    i, M, nblocks, flag;
+
+  nblocks = SUNBlockDenseMatrix_NumBlocks(A);
+  M = SUNBlockDenseMatrix_BlockRows(A);
+
+  C = SUNMatClone(A);
+  SUNMatCopy(A, C);
+  for (i=0; i<M; i++)
+    SM_ELEMENT_BD(C,nblocks-1,i,M-1) = ZERO;
+
+  LS = SUNLinSol_BlockDense(x, C, sunctx);
+  failure = SUNLinSolSetup(LS, C);
+  flag = SUNLinSolLastFlag(LS);
+
+  if ( (failure != SUNLS_LUFACT_FAIL) || (flag != nblocks*M) ) {
+    printf(">>> FAILED test -- SUNLinSol_BlockDense zero pivot: "
+           "flag = %d, last flag = %ld\n", failure, (long int) flag);
+    failure = 1;
+  } else {
+    printf("    PASSED test -- SUNLinSol_BlockDense zero pivot\n");
+    failure = 0;
+  }
+
+  SUNLinSolFree(LS);
+  SUNMatDestroy(C);
+
+  return(failure);
+}
+
+/* ----------------------------------------------------------------------
+ * Implementation-specific 'check' routines
+ * --------------------------------------------------------------------*/
+int check_vector(N_Vector X, N_Vector Y, realtype tol)
+{
+  int failure = 0;
+  sunindextype i, local_length;
+  realtype *Xdata, *Ydata, maxerr;
+
+  Xdata = N_VGetArrayPointer(X);
+  Ydata = N_VGetArrayPointer(Y);
+  local_length = N_VGetLength_Serial(X);
+
+  /* check vector data */
+  for(i=0; i < local_length; i++)
+    failure += SUNRCompareTol(Xdata[i], Ydata[i], tol);
+
+  if (failure > ZERO) {
+    maxerr = ZERO;
+    for(i=0; i < local_length; i++)
+      maxerr = SUNMAX(SUNRabs(Xdata[i]-Ydata[i]), maxerr);
+    printf("check err failure: maxerr = %"GSYM" (tol = %"GSYM")\n",
+	   maxerr, tol);
+    return(1);
+  }
+  else
+    return(0);
+}
+
+void sync_device()
+{
+}
@@ -36,6 +36,9 @@
 #define FSYM "f"
 #endif
 
+/* prototypes for custom tests */
+int Test_MixedPrecision(SUNMatrix A, N_Vector x, SUNContext sunctx);
+
 /* ----------------------------------------------------------------------
  * SUNLinSol_Dense Testing Routine
  * --------------------------------------------------------------------*/
@@ -153,6 +156,9 @@ int main(int argc, char *argv[])
   fails += Test_SUNLinSolLastFlag(LS, 0);
   fails += Test_SUNLinSolSpace(LS, 0);
 
+  /* Mixed precision factorization with iterative refinement */
+  fails += Test_MixedPrecision(B, y, sunctx);
+
   /* Print result */
   if (fails) {
     printf("FAIL: SUNLinSol module failed %i tests \n \n", fails);
@@ -183,6 +189,103 @@ int main(int argc, char *argv[])
   return(fails);
 }
 
+/* ----------------------------------------------------------------------
+ * Mixed precision tests:
+ *    A x = b is solved to full precision by refining the single
+ *      precision factorization (A is not overwritten by the setup)
+ *    the same system is solved in place with x and b the same vector
+ *    a matrix that is singular in single precision falls back to a
+ *      full precision factorization
+ * --------------------------------------------------------------------*/
+int Test_MixedPrecision(SUNMatrix A, N_Vector x, SUNContext sunctx)
+{
+  int             failure = 0;
+  SUNLinearSolver LS;
+  SUNMatrix       C;
+  N_Vector        b;
+  realtype        *col;
+  long int        nrefine, nfallback;
+  sunindextype    i, N;
+
+#if defined(SUNDIALS_SINGLE_PRECISION)
+  return(0);
+#endif
+
+  N = SUNDenseMatrix_Rows(A);
+  C = SUNMatClone(A);
+  b = N_VClone(x);
+
+  /* test 1: refinement of the single precision solution */
+  SUNMatCopy(A, C);
+  SUNMatMatvec(C, x, b);
+  LS = SUNLinSol_Dense(x, C, sunctx);
+  failure = SUNLinSol_DenseSetMixedPrecision(LS, SUNTRUE);
+  if (failure) {
+    printf(">>> FAILED test -- SUNLinSol_DenseSetMixedPrecision returned %d \n",
+           failure);
+    SUNLinSolFree(LS);  SUNMatDestroy(C);  N_VDestroy(b);
+    return(1);
+  }
+  failure += Test_SUNLinSolSetup(LS, C, 0);
+  failure += Test_SUNLinSolSolve(LS, C, x, b, 100*UNIT_ROUNDOFF, SUNTRUE, 0);
+  SUNLinSol_DenseGetNumRefineIters(LS, &nrefine);
+  SUNLinSol_DenseGetNumFallbacks(LS, &nfallback);
+  if (nfallback != 0) {
+    printf(">>> FAILED test -- mixed precision solve fell back to full precision \n");
+    failure++;
+  }
+  SUNLinSolFree(LS);
+
+  /* test 2: solve in place, b is overwritten by the solution */
+  SUNMatCopy(A, C);
+  SUNMatMatvec(C, x, b);
+  LS = SUNLinSol_Dense(x, C, sunctx);
+  SUNLinSol_DenseSetMixedPrecision(LS, SUNTRUE);
+  failure += Test_SUNLinSolSetup(LS, C, 0);
+  if (SUNLinSolSolve(LS, C, b, b, ZERO) != SUNLS_SUCCESS ||
+      check_vector(x, b, 1000*UNIT_ROUNDOFF)) {
+    printf(">>> FAILED test -- mixed precision solve with x = b \n");
+    failure++;
+  }
+  SUNLinSolFree(LS);
+
+  /* test 3: fall back for a matrix that is singular in single precision,
+     C = I except for the leading block [1 1; 1 1+2^-26] */
+  if (N > 1) {
+    SUNMatZero(C);
+    for (i=0; i<N; i++) SUNDenseMatrix_Column(C, i)[i] = ONE;
+    col = SUNDenseMatrix_Column(C, 0);
+    col[1] = ONE;
+    col = SUNDenseMatrix_Column(C, 1);
+    col[0] = ONE;
+    col[1] = ONE + SUNRpowerI(RCONST(0.5), 26);
+    SUNMatMatvec(C, x, b);
+
+    LS = SUNLinSol_Dense(x, C, sunctx);
+    SUNLinSol_DenseSetMixedPrecision(LS, SUNTRUE);
+    failure += Test_SUNLinSolSetup(LS, C, 0);
+    failure += Test_SUNLinSolSolve(LS, C, x, b, SUNRsqrt(UNIT_ROUNDOFF),
+                                   SUNTRUE, 0);
+    SUNLinSol_DenseGetNumFallbacks(LS, &nfallback);
+    if (nfallback != 1) {
+      printf(">>> FAILED test -- mixed precision setup did not fall back \n");
+      failure++;
+    }
+    SUNLinSolFree(LS);
+  }
+
+  SUNMatDestroy(C);
+  N_VDestroy(b);
+
+  if (failure)
+    printf(">>> FAILED test -- SUNLinSol_Dense mixed precision \n");
+  else
+    printf("    PASSED test -- SUNLinSol_Dense mixed precision (%ld refinement steps) \n",
+           nrefine);
+
+  return(failure);
+}
+
 /* ----------------------------------------------------------------------
  * Implementation-specific 'check' routines
  * --------------------------------------------------------------------*/
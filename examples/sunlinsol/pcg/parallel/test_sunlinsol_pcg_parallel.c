@@ -106,7 +106,7 @@ int main(int argc, char *argv[])
   SUNLinearSolver LS;               /* linear solver object      */
   N_Vector        xhat, x, b;       /* test vectors              */
   UserData        ProbData;         /* problem data structure    */
-  int             maxl, print_timing;
+  int             maxl, print_timing, pipelined;
   sunindextype    i;
   realtype        *vecdata;
   double          tol;
@@ -133,6 +133,7 @@ int main(int argc, char *argv[])
     printf("  Maximum Krylov subspace dimension should be >0\n");
     printf("  Solver tolerance should be >0\n");
     printf("  timing output flag should be 0 or 1 \n");
+    printf("  (optional) pipelined iteration flag should be 0 or 1\n");
     return 1;
   }
   ProbData.Nloc = (sunindextype) atol(argv[1]);
@@ -153,6 +154,7 @@ int main(int argc, char *argv[])
   }
   print_timing = atoi(argv[4]);
   SetTiming(print_timing);
+  pipelined = (argc > 5) ? atoi(argv[5]) : 0;
 
   if (ProbData.myid == 0) {
     printf("\nPCG linear solver test:\n");
@@ -161,7 +163,8 @@ int main(int argc, char *argv[])
            (long int) ProbData.nprocs * ProbData.Nloc);
     printf("  Maximum Krylov subspace dimension = %i\n", maxl);
     printf("  Solver Tolerance = %g\n", tol);
-    printf("  timing output flag = %i\n\n", print_timing);
+    printf("  timing output flag = %i\n", print_timing);
+    printf("  pipelined iteration flag = %i\n\n", pipelined);
   }
 
   /* Create vectors */
@@ -200,6 +203,7 @@ int main(int argc, char *argv[])
   fails += Test_SUNLinSolSetScalingVectors(LS, ProbData.s, NULL,
                                            ProbData.myid);
   fails += Test_SUNLinSolSetZeroGuess(LS, ProbData.myid);
+  fails += SUNLinSol_PCGSetPipelined(LS, pipelined);
   fails += Test_SUNLinSolInitialize(LS, ProbData.myid);
   fails += Test_SUNLinSolSpace(LS, ProbData.myid);
   if (fails) {
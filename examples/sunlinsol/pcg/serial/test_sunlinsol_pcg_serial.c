@@ -102,7 +102,7 @@ int main(int argc, char *argv[])
   SUNLinearSolver LS;               /* linear solver object      */
   N_Vector        xhat, x, b;       /* test vectors              */
   UserData        ProbData;         /* problem data structure    */
-  int             maxl, print_timing;
+  int             maxl, print_timing, pipelined;
   sunindextype    i;
   realtype        *vecdata;
   double          tol;
@@ -120,6 +120,7 @@ int main(int argc, char *argv[])
     printf("  Maximum Krylov subspace dimension should be >0\n");
     printf("  Solver tolerance should be >0\n");
     printf("  timing output flag should be 0 or 1 \n");
+    printf("  (optional) pipelined iteration flag should be 0 or 1\n");
     return 1;
   }
   ProbData.N = (sunindextype) atol(argv[1]);
@@ -140,12 +141,14 @@ int main(int argc, char *argv[])
   }
   print_timing = atoi(argv[4]);
   SetTiming(print_timing);
+  pipelined = (argc > 5) ? atoi(argv[5]) : 0;
 
   printf("\nPCG linear solver test:\n");
   printf("  Problem size = %ld\n", (long int) ProbData.N);
   printf("  Maximum Krylov subspace dimension = %i\n", maxl);
   printf("  Solver Tolerance = %g\n", tol);
-  printf("  timing output flag = %i\n\n", print_timing);
+  printf("  timing output flag = %i\n", print_timing);
+  printf("  pipelined iteration flag = %i\n\n", pipelined);
 
   /* Create vectors */
   x = N_VNew_Serial(ProbData.N, sunctx);
@@ -175,6 +178,7 @@ int main(int argc, char *argv[])
   fails += Test_SUNLinSolSetPreconditioner(LS, &ProbData, PSetup, PSolve, 0);
   fails += Test_SUNLinSolSetScalingVectors(LS, ProbData.s, NULL, 0);
   fails += Test_SUNLinSolSetZeroGuess(LS, 0);
+  fails += SUNLinSol_PCGSetPipelined(LS, pipelined);
   fails += Test_SUNLinSolInitialize(LS, 0);
   fails += Test_SUNLinSolSpace(LS, 0);
   if (fails) {
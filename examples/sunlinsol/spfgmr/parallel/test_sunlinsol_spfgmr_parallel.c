@@ -126,7 +126,7 @@ int main(int argc, char *argv[])
   if (argc < 6) {
     printf("ERROR: FIVE (5) Inputs required:\n");
     printf("  Local problem size should be >0\n");
-    printf("  Gram-Schmidt orthogonalization type should be 1 or 2\n");
+    printf("  Gram-Schmidt orthogonalization type should be 1, 2 or 3\n");
     printf("  Maximum Krylov subspace dimension should be >0\n");
     printf("  Solver tolerance should be >0\n");
     printf("  timing output flag should be 0 or 1 \n");
@@ -139,8 +139,8 @@ int main(int argc, char *argv[])
     return 1;
   }
   gstype = atoi(argv[2]);
-  if ((gstype < 1) || (gstype > 2)) {
-    printf("ERROR: Gram-Schmidt orthogonalization type must be either 1 or 2\n");
+  if ((gstype < 1) || (gstype > 3)) {
+    printf("ERROR: Gram-Schmidt orthogonalization type must be 1, 2 or 3\n");
     return 1;
   }
   maxl = atoi(argv[3]);
@@ -39,6 +39,8 @@
 
 /* constants */
 #define FIVE      RCONST(5.0)
+#define TEN       RCONST(10.0)
+#define HUNDRED   RCONST(100.0)
 #define THOUSAND  RCONST(1000.0)
 
 /* user data structure */
@@ -52,10 +54,15 @@ typedef struct {
 /* private functions */
 /*    matrix-vector product  */
 int ATimes(void* ProbData, N_Vector v, N_Vector z);
+/*    graded bidiagonal matrix-vector product */
+int ATimesGraded(void* ProbData, N_Vector v, N_Vector z);
 /*    preconditioner setup */
 int PSetup(void* ProbData);
 /*    preconditioner solve */
 int PSolve(void* ProbData, N_Vector r, N_Vector z, realtype tol, int lr);
+/*    checks the Arnoldi relation for DCGS2 */
+static int check_arnoldi(SUNLinearSolver S, UserData *ProbData,
+                         SUNATimesFn atimes);
 /*    checks function return values  */
 static int check_flag(void *flagvalue, const char *funcname, int opt);
 /*    uniform random number generator in [0,1] */
@@ -74,6 +81,7 @@ sunindextype problem_size;
  * 4. tridiagonal system w/ scale vector s1 (Jacobi preconditioning)
  * 5. tridiagonal system w/ scale vector s2 (no preconditioning)
  * 6. tridiagonal system w/ scale vector s2 (Jacobi preconditioning)
+ * 7. graded bidiagonal system (DCGS2 only, checks the Arnoldi relation)
  *
  * Note: We construct a tridiagonal matrix Ahat, a random solution xhat,
  *       and a corresponding rhs vector bhat = Ahat*xhat, such that each
@@ -113,7 +121,7 @@ int main(int argc, char *argv[])
   if (argc < 7) {
     printf("ERROR: SIX (6) Inputs required:\n");
     printf("  Problem size should be >0\n");
-    printf("  Gram-Schmidt orthogonalization type should be 1 or 2\n");
+    printf("  Gram-Schmidt orthogonalization type should be 1, 2 or 3\n");
     printf("  Preconditioning type should be 1 or 2\n");
     printf("  Maximum Krylov subspace dimension should be >0\n");
     printf("  Solver tolerance should be >0\n");
@@ -127,8 +135,8 @@ int main(int argc, char *argv[])
     return 1;
   }
   gstype = atoi(argv[2]);
-  if ((gstype < 1) || (gstype > 2)) {
-    printf("ERROR: Gram-Schmidt orthogonalization type must be either 1 or 2\n");
+  if ((gstype < 1) || (gstype > 3)) {
+    printf("ERROR: Gram-Schmidt orthogonalization type must be 1, 2 or 3\n");
     return 1;
   }
   pretype = atoi(argv[3]);
@@ -216,6 +224,7 @@ int main(int argc, char *argv[])
   fails += Test_SUNLinSolSetup(LS, NULL, 0);
   fails += Test_SUNLinSolSolve(LS, NULL, x, b, tol, SUNTRUE, 0);
   fails += Test_SUNLinSolSolve(LS, NULL, x, b, tol, SUNFALSE, 0);
+  if (gstype == SUN_DCGS2_GS) fails += check_arnoldi(LS, &ProbData, ATimes);
   fails += Test_SUNLinSolLastFlag(LS, 0);
   fails += Test_SUNLinSolNumIters(LS, 0);
   fails += Test_SUNLinSolResNorm(LS, 0);
@@ -282,6 +291,7 @@ int main(int argc, char *argv[])
   fails += Test_SUNLinSolSetup(LS, NULL, 0);
   fails += Test_SUNLinSolSolve(LS, NULL, x, b, tol, SUNTRUE, 0);
   fails += Test_SUNLinSolSolve(LS, NULL, x, b, tol, SUNFALSE, 0);
+  if (gstype == SUN_DCGS2_GS) fails += check_arnoldi(LS, &ProbData, ATimes);
   fails += Test_SUNLinSolLastFlag(LS, 0);
   fails += Test_SUNLinSolNumIters(LS, 0);
   fails += Test_SUNLinSolResNorm(LS, 0);
@@ -350,6 +360,7 @@ int main(int argc, char *argv[])
   fails += Test_SUNLinSolSetup(LS, NULL, 0);
   fails += Test_SUNLinSolSolve(LS, NULL, x, b, tol, SUNTRUE, 0);
   fails += Test_SUNLinSolSolve(LS, NULL, x, b, tol, SUNFALSE, 0);
+  if (gstype == SUN_DCGS2_GS) fails += check_arnoldi(LS, &ProbData, ATimes);
   fails += Test_SUNLinSolLastFlag(LS, 0);
   fails += Test_SUNLinSolNumIters(LS, 0);
   fails += Test_SUNLinSolResNorm(LS, 0);
@@ -398,6 +409,43 @@ int main(int argc, char *argv[])
   }
 
 
+  /*** Test 7: graded bidiagonal system, DCGS2 Arnoldi relation ***/
+
+  /* The Krylov basis of this system is ill-conditioned so the first pass
+     of DCGS2 loses orthogonality and the correction of the Hessenberg
+     matrix in the following step matters. The solve does not need to
+     converge, only the Arnoldi relation for the basis is checked. */
+  if (gstype == SUN_DCGS2_GS) {
+
+    /* set scaling vectors and the graded diagonal */
+    N_VConst(ONE, ProbData.s1);
+    N_VConst(ONE, ProbData.s2);
+    vecdata = N_VGetArrayPointer(ProbData.d);
+    for (i=0; i<ProbData.N; i++)
+      vecdata[i] = SUNRpowerR(TEN, TEN*i/(ProbData.N-1));
+
+    N_VConst(ONE, b);
+    N_VConst(ZERO, x);
+
+    SUNLinSolFree(LS);
+    LS = SUNLinSol_SPGMR(x, SUN_PREC_NONE, SUNMIN(maxl, ProbData.N/2), sunctx);
+    fails  = SUNLinSol_SPGMRSetGSType(LS, gstype);
+    fails += SUNLinSolSetATimes(LS, &ProbData, ATimesGraded);
+    fails += SUNLinSolInitialize(LS);
+    fails += SUNLinSolSetZeroGuess(LS, SUNTRUE);
+    if (SUNLinSolSolve(LS, NULL, x, b, SUN_UNIT_ROUNDOFF) < 0) fails++;
+    fails += check_arnoldi(LS, &ProbData, ATimesGraded);
+
+    /* Print result */
+    if (fails) {
+      printf("FAIL: SUNLinSol_SPGMR module, problem 7, failed %i tests\n\n", fails);
+      passfail += 1;
+    } else {
+      printf("SUCCESS: SUNLinSol_SPGMR module, problem 7, passed all tests\n\n");
+    }
+  }
+
+
   /* Free solver and vectors */
   SUNLinSolFree(LS);
   N_VDestroy(x);
@@ -450,6 +498,29 @@ int ATimes(void* Data, N_Vector v_vec, N_Vector z_vec)
   return 0;
 }
 
+/* graded bidiagonal matrix-vector product, z_i = d_i v_i + v_{i+1} */
+int ATimesGraded(void* Data, N_Vector v_vec, N_Vector z_vec)
+{
+  realtype *v, *z, *d;
+  sunindextype i, N;
+  UserData *ProbData;
+
+  ProbData = (UserData *) Data;
+  v = N_VGetArrayPointer(v_vec);
+  if (check_flag(v, "N_VGetArrayPointer", 0)) return 1;
+  z = N_VGetArrayPointer(z_vec);
+  if (check_flag(z, "N_VGetArrayPointer", 0)) return 1;
+  d = N_VGetArrayPointer(ProbData->d);
+  if (check_flag(d, "N_VGetArrayPointer", 0)) return 1;
+  N = ProbData->N;
+
+  for (i=0; i<N-1; i++)
+    z[i] = d[i]*v[i] + v[i+1];
+  z[N-1] = d[N-1]*v[N-1];
+
+  return 0;
+}
+
 /* preconditioner setup -- nothing to do here since everything is already stored */
 int PSetup(void* Data) { return 0; }
 
@@ -478,6 +549,58 @@ int PSolve(void* Data, N_Vector r_vec, N_Vector z_vec, realtype tol, int lr)
   return 0;
 }
 
+/* With DCGS2 the Hessenberg matrix is not overwritten by its QR
+   factorization, check that the basis from the last solve (without
+   preconditioning or restarts) is orthonormal and satisfies the Arnoldi
+   relation s1 A s2^{-1} V_k = V_{k+1} H_k */
+static int check_arnoldi(SUNLinearSolver S, UserData *ProbData,
+                         SUNATimesFn atimes)
+{
+  N_Vector *V, w, z;
+  realtype **Hes, err, orth, dot;
+  int i, j, k;
+
+  V   = ((SUNLinearSolverContent_SPGMR) S->content)->V;
+  Hes = ((SUNLinearSolverContent_SPGMR) S->content)->Hes;
+  k   = SUNLinSolNumIters(S);
+  if (k == 0) return(0);
+
+  w = N_VClone(V[0]);
+  z = N_VClone(V[0]);
+
+  /* loss of orthogonality max |V^T V - I| */
+  orth = ZERO;
+  for (i=0; i<=k; i++)
+    for (j=0; j<=i; j++) {
+      dot = N_VDotProd(V[i], V[j]);
+      if (i == j) dot -= ONE;
+      orth = SUNMAX(orth, SUNRabs(dot));
+    }
+
+  /* relative Arnoldi residual max ||s1 A s2^{-1} v_j - V_{j+2} h_j|| */
+  err = ZERO;
+  for (j=0; j<k; j++) {
+    N_VDiv(V[j], ProbData->s2, w);
+    if (atimes(ProbData, w, z)) { err = ONE; break; }
+    N_VProd(ProbData->s1, z, z);
+    dot = SUNRsqrt(N_VDotProd(z, z));
+    for (i=0; i<=j+1; i++) N_VLinearSum(ONE, z, -Hes[i][j], V[i], z);
+    err = SUNMAX(err, SUNRsqrt(N_VDotProd(z, z)) / dot);
+  }
+
+  N_VDestroy(w);
+  N_VDestroy(z);
+
+  printf("    Arnoldi residual = %"ESYM", loss of orthogonality = %"ESYM"\n",
+         err, orth);
+  if (err > HUNDRED*UNIT_ROUNDOFF || orth > SUNRsqrt(UNIT_ROUNDOFF)) {
+    printf(">>> FAILED test -- DCGS2 Arnoldi relation\n");
+    return(1);
+  }
+  printf("    PASSED test -- DCGS2 Arnoldi relation\n");
+  return(0);
+}
+
 /* uniform random number generator */
 static realtype urand()
 {
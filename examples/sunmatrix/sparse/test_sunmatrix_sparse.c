@@ -34,6 +34,8 @@ int Test_SUNMatScaleAdd2(SUNMatrix A, SUNMatrix B, N_Vector x,
 int Test_SUNMatScaleAddI2(SUNMatrix A, N_Vector x, N_Vector y);
 int Test_SUNSparseMatrixToCSC(SUNMatrix A);
 int Test_SUNSparseMatrixToCSR(SUNMatrix A);
+int Test_SUNSparseMatrixILU(SUNMatrix A, N_Vector x, N_Vector y);
+int Test_SUNSparseMatrixThreads(SUNMatrix A, N_Vector x, N_Vector y);
 
 /* ----------------------------------------------------------------------
  * Main SUNMatrix Testing Routine
@@ -377,6 +379,10 @@ int main(int argc, char *argv[])
   } else {
     fails += Test_SUNSparseMatrixToCSR(A);
   }
+  if (square) {
+    fails += Test_SUNSparseMatrixILU(A, x, y);
+  }
+  fails += Test_SUNSparseMatrixThreads(A, x, y);
 
   /* Print result */
   if (fails) {
@@ -582,6 +588,26 @@ int Test_SUNMatScaleAdd2(SUNMatrix A, SUNMatrix B, N_Vector x,
     printf("    PASSED test -- SUNMatScaleAdd2 check 3 \n");
   }
 
+  /* test 4: repeat test 1 to reuse the recorded pattern of A+B */
+  failure = SUNMatCopy(A, C);            /* C = A */
+  failure += SUNMatScaleAdd(ONE, C, B);  /* C = A+B */
+  failure += SUNMatMatvec(C, x, u);      /* u = Cx = Ax+Bx */
+  if (failure) {
+    printf(">>> FAILED test -- SUNMatCopy, SUNMatScaleAdd or SUNMatMatvec failed \n");
+    SUNMatDestroy(C);  SUNMatDestroy(D);  SUNMatDestroy(E);
+    N_VDestroy(u);  N_VDestroy(v);  return(1);
+  }
+  N_VLinearSum(ONE,y,ONE,z,v);           /* v = y+z */
+  failure = check_vector(u, v, tol);     /* u ?= v */
+  if (failure) {
+    printf(">>> FAILED test -- SUNMatScaleAdd2 check 4 \n");
+    SUNMatDestroy(C);  SUNMatDestroy(D);  SUNMatDestroy(E);
+    N_VDestroy(u);  N_VDestroy(v);  return(1);
+  }
+  else {
+    printf("    PASSED test -- SUNMatScaleAdd2 check 4 \n");
+  }
+
   SUNMatDestroy(C);
   SUNMatDestroy(D);
   SUNMatDestroy(E);
@@ -731,6 +757,26 @@ int Test_SUNMatScaleAddI2(SUNMatrix A, N_Vector x, N_Vector y)
     printf("    PASSED test -- SUNMatScaleAddI2 check 3 \n");
   }
 
+  /* test 4: repeat test 2 to reuse the recorded diagonal locations */
+  failure = SUNMatCopy(A, C);
+  failure += SUNMatScaleAddI(NEG_ONE, C);   /* C = I-A */
+  failure += SUNMatMatvec(C, x, z);
+  if (failure) {
+    printf(">>> FAILED test -- SUNMatCopy, SUNMatScaleAddI or SUNMatMatvec failed \n");
+    SUNMatDestroy(B);  SUNMatDestroy(C);  SUNMatDestroy(D);
+    N_VDestroy(z);  N_VDestroy(w);  return(1);
+  }
+  N_VLinearSum(ONE,x,NEG_ONE,y,w);
+  failure = check_vector(z, w, tol);
+  if (failure) {
+    printf(">>> FAILED test -- SUNMatScaleAddI2 check 4 \n");
+    SUNMatDestroy(B);  SUNMatDestroy(C);  SUNMatDestroy(D);
+    N_VDestroy(z);  N_VDestroy(w);  return(1);
+  }
+  else {
+    printf("    PASSED test -- SUNMatScaleAddI2 check 4 \n");
+  }
+
   SUNMatDestroy(B);
   SUNMatDestroy(C);
   SUNMatDestroy(D);
@@ -811,6 +857,249 @@ int Test_SUNSparseMatrixToCSC(SUNMatrix A)
   return(0);
 }
 
+/* ----------------------------------------------------------------------
+ * Threaded matrix-vector product test:
+ *    a copy of A using 4 threads (inherited by its clones) gives the
+ *    same product as A, the threads are only used when compiled with
+ *    OpenMP
+ * --------------------------------------------------------------------*/
+int Test_SUNSparseMatrixThreads(SUNMatrix A, N_Vector x, N_Vector y)
+{
+  int       failure;
+  SUNMatrix B, C;
+  N_Vector  z, w;
+  realtype  tol=100*UNIT_ROUNDOFF;
+
+  B = SUNMatClone(A);
+  SUNMatCopy(A, B);
+  failure = SUNSparseMatrix_SetNumThreads(B, 4);
+  if (failure) {
+    printf(">>> FAILED test -- SUNSparseMatrix_SetNumThreads returned %d\n",
+           failure);
+    SUNMatDestroy(B);
+    return(1);
+  }
+
+  C = SUNMatClone(B);
+  if (SUNSparseMatrix_NumThreads(C) != 4) {
+    printf(">>> FAILED test -- SUNMatClone did not keep the number of threads\n");
+    SUNMatDestroy(B);
+    SUNMatDestroy(C);
+    return(1);
+  }
+  SUNMatCopy(B, C);
+
+  z = N_VClone(y);
+  w = N_VClone(y);
+
+  failure = SUNMatMatvec(A, x, z);
+  failure += SUNMatMatvec(C, x, w);
+  if (failure) {
+    printf(">>> FAILED test -- SUNMatMatvec returned nonzero\n");
+    SUNMatDestroy(B);  SUNMatDestroy(C);
+    N_VDestroy(z);  N_VDestroy(w);
+    return(1);
+  }
+
+  if (check_vector(z, w, tol)) {
+    printf(">>> FAILED test -- threaded SUNMatMatvec check_vector failed\n");
+    SUNMatDestroy(B);  SUNMatDestroy(C);
+    N_VDestroy(z);  N_VDestroy(w);
+    return(1);
+  }
+
+  printf("    PASSED test -- SUNSparseMatrix threaded matvec\n");
+
+  SUNMatDestroy(B);
+  SUNMatDestroy(C);
+  N_VDestroy(z);
+  N_VDestroy(w);
+
+  return(0);
+}
+
+/* ----------------------------------------------------------------------
+ * Incomplete LU tests for square sparse matrices:
+ *    ILU(0) of a tridiagonal matrix is its exact LU factorization
+ *    ILU(N) of A + c I (for small c) is its exact LU factorization and
+ *      the numeric factorization can be repeated for new values
+ *    ILU(0) of a 2x2 block diagonal matrix is its exact LU factorization
+ *      and the solve levels are wide enough to use multiple threads
+ * --------------------------------------------------------------------*/
+int Test_SUNSparseMatrixILU(SUNMatrix A, N_Vector x, N_Vector y)
+{
+  int          failure;
+  SUNMatrix    B, T;
+  SUNSparseILU ilu;
+  N_Vector     z;
+  realtype     *tdata, tol=1000*UNIT_ROUNDOFF;
+  sunindextype i, j, o, N, nnz, nlevL, nlevU;
+  sunindextype *tidx, *tptr;
+
+  N = SUNSparseMatrix_Rows(A);
+  z = N_VClone(x);
+
+  /* test 1: ILU(0) solve with a tridiagonal matrix */
+  T     = SUNSparseMatrix(N, N, 3*N, SUNSparseMatrix_SparseType(A),
+                          A->sunctx);
+  tdata = SUNSparseMatrix_Data(T);
+  tidx  = SUNSparseMatrix_IndexValues(T);
+  tptr  = SUNSparseMatrix_IndexPointers(T);
+  nnz   = 0;
+  for (i=0; i<N; i++) {
+    tptr[i] = nnz;
+    if (i > 0) {
+      tdata[nnz] = NEG_ONE;  tidx[nnz] = i-1;  nnz++;
+    }
+    tdata[nnz] = RCONST(4.0);  tidx[nnz] = i;  nnz++;
+    if (i < N-1) {
+      tdata[nnz] = -TWO;  tidx[nnz] = i+1;  nnz++;
+    }
+  }
+  tptr[N] = nnz;
+
+  ilu = SUNSparseMatrix_ILUCreate(T, 0);
+  if (ilu == NULL) {
+    printf(">>> FAILED test -- SUNSparseMatrix_ILUCreate returned NULL \n");
+    SUNMatDestroy(T);  N_VDestroy(z);  return(1);
+  }
+  SUNSparseMatrix_ILUGetInfo(ilu, &nnz, &nlevL, &nlevU);
+  if ((nnz != 3*N-2) || (nlevL != N) || (nlevU != N)) {
+    printf(">>> FAILED test -- SUNSparseMatrix_ILUGetInfo unexpected values \n");
+    SUNSparseMatrix_ILUFree(ilu);  SUNMatDestroy(T);  N_VDestroy(z);
+    return(1);
+  }
+  failure = SUNSparseMatrix_ILUFactor(ilu, T);
+  if (failure) {
+    printf(">>> FAILED test -- SUNSparseMatrix_ILUFactor returned %d \n",
+           failure);
+    SUNSparseMatrix_ILUFree(ilu);  SUNMatDestroy(T);  N_VDestroy(z);
+    return(1);
+  }
+  SUNMatMatvec(T, x, y);
+  SUNSparseMatrix_ILUSolve(ilu, y, z);
+  failure = check_vector(z, x, tol);
+
+  /* a matrix with the other storage type or a different pattern, but the
+     same number of nonzeros, must be rejected */
+  if (!failure) {
+    B = SUNSparseMatrix(N, N, 3*N,
+                        (SUNSparseMatrix_SparseType(A) == CSR_MAT) ?
+                        CSC_MAT : CSR_MAT, A->sunctx);
+    for (i=0; i<=N; i++)
+      SUNSparseMatrix_IndexPointers(B)[i] = tptr[i];
+    for (i=0; i<tptr[N]; i++) {
+      SUNSparseMatrix_IndexValues(B)[i] = tidx[i];
+      SUNSparseMatrix_Data(B)[i] = tdata[i];
+    }
+    if (SUNSparseMatrix_ILUFactor(ilu, B) != SUNMAT_ILL_INPUT) failure = 1;
+    SUNMatDestroy(B);
+  }
+  if (!failure && (N > 2)) {
+    B = SUNMatClone(T);
+    SUNMatCopy(T, B);
+    SUNSparseMatrix_IndexValues(B)[0] = N-1;
+    if (SUNSparseMatrix_ILUFactor(ilu, B) != SUNMAT_ILL_INPUT) failure = 1;
+    SUNMatDestroy(B);
+  }
+  SUNSparseMatrix_ILUFree(ilu);
+  SUNMatDestroy(T);
+  if (failure) {
+    printf(">>> FAILED test -- SUNSparseMatrixILU check 1 \n");
+    N_VDestroy(z);  return(1);
+  }
+
+  /* test 2: complete fill with a random matrix, refactor in place */
+  B = SUNMatClone(A);
+  SUNMatCopy(A, B);
+  SUNMatScaleAddI(RCONST(0.01), B);   /* B = 0.01 A + I */
+
+  ilu = SUNSparseMatrix_ILUCreate(B, (int) N);
+  if (ilu == NULL) {
+    printf(">>> FAILED test -- SUNSparseMatrix_ILUCreate returned NULL \n");
+    SUNMatDestroy(B);  N_VDestroy(z);  return(1);
+  }
+  failure = SUNSparseMatrix_ILUFactor(ilu, B);
+  if (!failure) {
+    SUNMatMatvec(B, x, y);
+    N_VScale(ONE, y, z);
+    SUNSparseMatrix_ILUSolve(ilu, z, z);
+    failure = check_vector(z, x, tol);
+  }
+  if (!failure) {
+    for (i=0; i<SUNSparseMatrix_NNZ(B); i++)
+      SUNSparseMatrix_Data(B)[i] *= TWO;
+    failure = SUNSparseMatrix_ILUFactor(ilu, B);
+    if (!failure) {
+      SUNMatMatvec(B, x, y);
+      SUNSparseMatrix_ILUSolve(ilu, y, z);
+      failure = check_vector(z, x, tol);
+    }
+  }
+  SUNSparseMatrix_ILUFree(ilu);
+  SUNMatDestroy(B);
+  if (failure) {
+    printf(">>> FAILED test -- SUNSparseMatrixILU check 2 \n");
+    N_VDestroy(z);  return(1);
+  }
+
+  /* test 3: ILU(0) threaded solve with a 2x2 block diagonal matrix, entry
+     (i,j) of each block is 4 if i = j, -2 if i < j, and -1 if i > j */
+  T     = SUNSparseMatrix(N, N, 2*N, SUNSparseMatrix_SparseType(A),
+                          A->sunctx);
+  tdata = SUNSparseMatrix_Data(T);
+  tidx  = SUNSparseMatrix_IndexValues(T);
+  tptr  = SUNSparseMatrix_IndexPointers(T);
+  nnz   = 0;
+  for (o=0; o<N; o++) {
+    tptr[o] = nnz;
+    j = (o % 2 == 0) ? o+1 : o-1;
+    if (j < o) {
+      tidx[nnz] = j;  nnz++;
+    }
+    tidx[nnz] = o;  nnz++;
+    if ((j > o) && (j < N)) {
+      tidx[nnz] = j;  nnz++;
+    }
+    for (i=tptr[o]; i<nnz; i++) {
+      if (tidx[i] == o)
+        tdata[i] = RCONST(4.0);
+      else if ((SUNSparseMatrix_SparseType(A) == CSR_MAT) == (o < tidx[i]))
+        tdata[i] = -TWO;
+      else
+        tdata[i] = NEG_ONE;
+    }
+  }
+  tptr[N] = nnz;
+  failure = SUNSparseMatrix_SetNumThreads(T, 4);
+
+  ilu = NULL;
+  if (!failure) {
+    ilu = SUNSparseMatrix_ILUCreate(T, 0);
+    failure = (ilu == NULL);
+  }
+  if (!failure) {
+    SUNSparseMatrix_ILUGetInfo(ilu, NULL, &nlevL, &nlevU);
+    failure = (nlevL != SUNMIN(N,2)) || (nlevU != SUNMIN(N,2));
+  }
+  if (!failure) failure = SUNSparseMatrix_ILUFactor(ilu, T);
+  if (!failure) {
+    SUNMatMatvec(T, x, y);
+    SUNSparseMatrix_ILUSolve(ilu, y, z);
+    failure = check_vector(z, x, tol);
+  }
+  SUNSparseMatrix_ILUFree(ilu);
+  SUNMatDestroy(T);
+  N_VDestroy(z);
+  if (failure) {
+    printf(">>> FAILED test -- SUNSparseMatrixILU check 3 \n");
+    return(1);
+  }
+
+  printf("    PASSED test -- SUNSparseMatrixILU\n");
+  return(0);
+}
+
 
 /* ----------------------------------------------------------------------
  * Check matrix
@@ -118,13 +118,29 @@ int main(int argc, char *argv[])
   int                mxiter  = 20;
   int                maa     = 0;           /* no acceleration */
   realtype           damping = RCONST(1.0); /* no damping      */
+  int                orth    = 0;           /* built-in MGS    */
+  realtype           maxcond = ZERO;        /* no limit        */
+  SUNQRAddFn         qr_func = NULL;
   long int           niters  = 0;
+  long int           nrestarts = 0;
   realtype*          data    = NULL;
   SUNContext         sunctx     = NULL;
 
   /* Check if a acceleration/dampling values were provided */
   if (argc > 1) maa     = (long int) atoi(argv[1]);
   if (argc > 2) damping = (realtype) atof(argv[2]);
+  if (argc > 3) orth    = atoi(argv[3]);
+  if (argc > 4) maxcond = (realtype) atof(argv[4]);
+
+  /* Set the QR update function: 0 = built-in MGS, 1 = MGS, 2 = ICWY,
+     3 = CGS2, 4 = DCGS2 */
+  switch (orth) {
+  case 1: qr_func = SUNQRAdd_MGS;   break;
+  case 2: qr_func = SUNQRAdd_ICWY;  break;
+  case 3: qr_func = SUNQRAdd_CGS2;  break;
+  case 4: qr_func = SUNQRAdd_DCGS2; break;
+  default: qr_func = NULL;
+  }
 
   /* Print problem description */
   printf("Solve the nonlinear system:\n");
@@ -140,6 +156,8 @@ int main(int argc, char *argv[])
   printf("    max iters = %d\n", mxiter);
   printf("    accel vec = %d\n", maa);
   printf("    damping   = %"GSYM"\n", damping);
+  printf("    orth      = %d\n", orth);
+  printf("    max cond  = %"GSYM"\n", maxcond);
 
   /* create SUNDIALS context */
   retval = SUNContext_Create(NULL, &sunctx);
@@ -196,6 +214,14 @@ int main(int argc, char *argv[])
   retval = SUNNonlinSolSetDamping_FixedPoint(NLS, damping);
   if (check_retval(&retval, "SUNNonlinSolSetDamping", 1)) return(1);
 
+  /* set the QR update function */
+  retval = SUNNonlinSolSetQRAdd_FixedPoint(NLS, qr_func);
+  if (check_retval(&retval, "SUNNonlinSolSetQRAdd", 1)) return(1);
+
+  /* set the condition limit for the acceleration subspace */
+  retval = SUNNonlinSolSetMaxCond_FixedPoint(NLS, maxcond);
+  if (check_retval(&retval, "SUNNonlinSolSetMaxCond", 1)) return(1);
+
   /* solve the nonlinear system */
   retval = SUNNonlinSolSolve(NLS, Imem->y0, Imem->ycor, Imem->w, tol, SUNTRUE,
                              Imem);
@@ -210,6 +236,12 @@ int main(int argc, char *argv[])
 
   printf("Number of nonlinear iterations: %ld\n",niters);
 
+  /* get the number of acceleration subspace restarts */
+  retval = SUNNonlinSolGetNumRestarts_FixedPoint(NLS, &nrestarts);
+  if (check_retval(&retval, "SUNNonlinSolGetNumRestarts", 1)) return(1);
+
+  printf("Number of acceleration restarts: %ld\n",nrestarts);
+
   /* check solution */
   retval = check_ans(Imem->ycur, tol);
 
@@ -11,7 +11,9 @@
  * SPDX-License-Identifier: BSD-3-Clause
  * SUNDIALS Copyright End
  * -----------------------------------------------------------------------------
- * This is the testing routine to check the SUNNonlinearSolver Newton module
+ * This is the testing routine to check the SUNNonlinearSolver Newton module.
+ * An optional command line input enables (1) or disables (0, default) the
+ * adaptive Eisenstat-Walker forcing term.
  * ---------------------------------------------------------------------------*/
 
 #include <stdio.h>
@@ -73,6 +75,8 @@ typedef struct IntegratorMemRec {
   N_Vector x;
   SUNMatrix A;
   SUNLinearSolver LS;
+  SUNNonlinearSolver NLS;
+  int forcing;
 } *IntegratorMem;
 
 /* Linear solver setup interface function */
@@ -94,6 +98,7 @@ int main(int argc, char *argv[])
   IntegratorMem      Imem;       /* proxy for integrator memory */
   SUNNonlinearSolver NLS;        /* nonlinear solver object     */
   long int           niters;     /* number of nonlinear iters   */
+  realtype           eta;        /* forcing term                */
   int                retval = 0; /* return value                */
   SUNContext         sunctx;
 
@@ -104,6 +109,10 @@ int main(int argc, char *argv[])
   /* create proxy for integrator memory */
   Imem = (IntegratorMem) malloc(sizeof(struct IntegratorMemRec));
 
+  /* check for forcing term input */
+  Imem->forcing = (argc > 1) ? atoi(argv[1]) : 0;
+  printf("Adaptive forcing term: %s\n", (Imem->forcing) ? "on" : "off");
+
   /* create vector */
   Imem->y0 = N_VNew_Serial(NEQ, sunctx);
   if (check_retval((void *)Imem->y0, "N_VNew_Serial", 0)) return(1);
@@ -169,6 +178,13 @@ int main(int argc, char *argv[])
   retval = SUNNonlinSolSetMaxIters(NLS, MAXIT);
   if (check_retval(&retval, "SUNNonlinSolSetMaxIters", 1)) return(1);
 
+  /* enable the adaptive forcing term */
+  retval = SUNNonlinSolSetForcing_Newton(NLS, Imem->forcing);
+  if (check_retval(&retval, "SUNNonlinSolSetForcing_Newton", 1)) return(1);
+
+  /* attach the nonlinear solver to query the forcing term in LSolve */
+  Imem->NLS = NLS;
+
   /* solve the nonlinear system */
   retval = SUNNonlinSolSolve(NLS, Imem->y0, Imem->ycor, Imem->w, TOL, SUNTRUE,
                              Imem);
@@ -195,6 +211,14 @@ int main(int argc, char *argv[])
 
   printf("Number of nonlinear iterations: %ld\n",niters);
 
+  /* the forcing term is zero outside of a nonlinear solve */
+  retval = SUNNonlinSolGetForcingTerm(NLS, &eta);
+  if (check_retval(&retval, "SUNNonlinSolGetForcingTerm", 1)) return(1);
+  if (eta != ZERO) {
+    printf("ERROR: nonzero forcing term after the solve\n");
+    retval = 1;
+  }
+
   /* Free vector, matrix, linear solver, and nonlinear solver */
   N_VDestroy(Imem->y0);
   N_VDestroy(Imem->ycur);
@@ -248,6 +272,7 @@ int LSetup(booleantype jbad, booleantype* jcur, void* mem)
 int LSolve(N_Vector b, void* mem)
 {
   int retval;
+  realtype eta;
   IntegratorMem Imem;
 
   if (mem == NULL) {
@@ -256,6 +281,17 @@ int LSolve(N_Vector b, void* mem)
   }
   Imem = (IntegratorMem) mem;
 
+  /* check the forcing term, an iterative linear solver would use eta*||b||
+     as the tolerance for the linear residual */
+  retval = SUNNonlinSolGetForcingTerm(Imem->NLS, &eta);
+  if (retval != SUN_NLS_SUCCESS) return(-1);
+  printf("Forcing term: eta = %"GSYM"\n", eta);
+  if ( (Imem->forcing && ((eta <= ZERO) || (eta >= ONE))) ||
+       (!Imem->forcing && (eta != ZERO)) ) {
+    printf("ERROR: invalid forcing term\n");
+    return(-1);
+  }
+
   retval = SUNLinSolSolve(Imem->LS, Imem->A, Imem->x, b, ZERO);
   N_VScale(ONE, Imem->x, b);
 
@@ -280,6 +280,7 @@ SUNDIALS_EXPORT int ARKStepSetJacEvalFrequency(void *arkode_mem,
 SUNDIALS_EXPORT int ARKStepSetLinearSolutionScaling(void *arkode_mem,
                                                     booleantype onoff);
 SUNDIALS_EXPORT int ARKStepSetEpsLin(void *arkode_mem, realtype eplifac);
+SUNDIALS_EXPORT int ARKStepSetEpsLinMax(void *arkode_mem, realtype eplmax);
 SUNDIALS_EXPORT int ARKStepSetMassEpsLin(void *arkode_mem, realtype eplifac);
 SUNDIALS_EXPORT int ARKStepSetLSNormFactor(void *arkode_mem,
                                            realtype nrmfac);
@@ -192,6 +192,13 @@ SUNDIALS_EXPORT int CVodeComputeState(void *cvode_mem, N_Vector ycor, N_Vector y
 /* Dense output function */
 SUNDIALS_EXPORT int CVodeGetDky(void *cvode_mem, realtype t, int k,
                                 N_Vector dky);
+SUNDIALS_EXPORT int CVodeGetDkyMany(void *cvode_mem, int nt, realtype *t,
+                                    int k, N_Vector *dky);
+
+/* Integrator state functions for warm restarts */
+SUNDIALS_EXPORT int CVodeGetStateBufSize(void *cvode_mem, long int *size);
+SUNDIALS_EXPORT int CVodeWriteState(void *cvode_mem, void *buf);
+SUNDIALS_EXPORT int CVodeReadState(void *cvode_mem, void *buf);
 
 /* Optional output functions */
 SUNDIALS_EXPORT int CVodeGetWorkSpace(void *cvode_mem, long int *lenrw,
@@ -0,0 +1,98 @@
+/* -----------------------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------------------
+ * This is the header file for CVODE's batched integrator for ensembles of
+ * independent ODE systems of equal size. Every system keeps its own step
+ * size, order, Nordsieck history, and error test, while the right-hand side
+ * and Jacobian are evaluated for all systems still integrating in one call.
+ * ---------------------------------------------------------------------------*/
+
+#ifndef _CVODE_BATCH_H
+#define _CVODE_BATCH_H
+
+#include <sundials/sundials_nvector.h>
+#include <cvode/cvode.h>
+
+#ifdef __cplusplus  /* wrapper to enable C++ usage */
+extern "C" {
+#endif
+
+/* -----------------------------------------------------------------------------
+ * CVodeBatch user-supplied function prototypes
+ * -----------------------------------------------------------------------------
+ * Both functions act on the nactive systems currently in the batch. The
+ * state of the system in slot k (0 <= k < nactive) is y[k*n], ..., y[k*n+n-1],
+ * its time is t[k], and its index in the ensemble is sysid[k]. Jacobian entry
+ * (i,j) of the system in slot k is J[(j*n + i)*ldj + k].
+ * ---------------------------------------------------------------------------*/
+
+typedef int (*CVBatchRhsFn)(int nactive, const int *sysid, const realtype *t,
+                            realtype *y, realtype *ydot, void *user_data);
+
+typedef int (*CVBatchJacFn)(int nactive, const int *sysid, const realtype *t,
+                            realtype *y, realtype *fy, realtype *J,
+                            sunindextype ldj, void *user_data);
+
+/* -----------------------------------------------------------------------------
+ * CVodeBatch exported functions
+ * ---------------------------------------------------------------------------*/
+
+/* Creation and initialization functions */
+SUNDIALS_EXPORT void *CVodeBatchCreate(int nsys, sunindextype n,
+                                       SUNContext sunctx);
+SUNDIALS_EXPORT int CVodeBatchInit(void *cvb_mem, CVBatchRhsFn f,
+                                   realtype t0, N_Vector y0);
+SUNDIALS_EXPORT int CVodeBatchReInit(void *cvb_mem, realtype t0, N_Vector y0);
+
+/* Tolerance input functions */
+SUNDIALS_EXPORT int CVodeBatchSStolerances(void *cvb_mem, realtype reltol,
+                                           realtype abstol);
+SUNDIALS_EXPORT int CVodeBatchSVtolerances(void *cvb_mem, realtype reltol,
+                                           N_Vector abstol);
+
+/* Optional input functions */
+SUNDIALS_EXPORT int CVodeBatchSetJacFn(void *cvb_mem, CVBatchJacFn jac);
+SUNDIALS_EXPORT int CVodeBatchSetUserData(void *cvb_mem, void *user_data);
+SUNDIALS_EXPORT int CVodeBatchSetMaxOrd(void *cvb_mem, int maxord);
+SUNDIALS_EXPORT int CVodeBatchSetMaxNumSteps(void *cvb_mem, long int mxsteps);
+SUNDIALS_EXPORT int CVodeBatchSetNumThreads(void *cvb_mem, int nthreads);
+
+/* Solver function */
+SUNDIALS_EXPORT int CVodeBatch(void *cvb_mem, realtype tout, N_Vector yout);
+
+/* Optional output functions, per-system values are returned in arrays of
+   length nsys indexed by system */
+SUNDIALS_EXPORT int CVodeBatchGetSystemFlags(void *cvb_mem, int *flags);
+SUNDIALS_EXPORT int CVodeBatchGetCurrentTime(void *cvb_mem, realtype *tcur);
+SUNDIALS_EXPORT int CVodeBatchGetNumSteps(void *cvb_mem, long int *nsteps);
+SUNDIALS_EXPORT int CVodeBatchGetNumErrTestFails(void *cvb_mem,
+                                                 long int *netfails);
+SUNDIALS_EXPORT int CVodeBatchGetNumNonlinSolvIters(void *cvb_mem,
+                                                    long int *nniters);
+SUNDIALS_EXPORT int CVodeBatchGetNumNonlinSolvConvFails(void *cvb_mem,
+                                                        long int *nnfails);
+SUNDIALS_EXPORT int CVodeBatchGetLastOrder(void *cvb_mem, int *qlast);
+SUNDIALS_EXPORT int CVodeBatchGetLastStep(void *cvb_mem, realtype *hlast);
+
+/* Batch-wide counters */
+SUNDIALS_EXPORT int CVodeBatchGetNumRhsEvals(void *cvb_mem, long int *nfevals);
+SUNDIALS_EXPORT int CVodeBatchGetNumJacEvals(void *cvb_mem, long int *njevals);
+SUNDIALS_EXPORT int CVodeBatchGetNumLinSolvSetups(void *cvb_mem,
+                                                  long int *nlinsetups);
+
+/* Free function */
+SUNDIALS_EXPORT void CVodeBatchFree(void **cvb_mem);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -95,6 +95,7 @@ SUNDIALS_EXPORT int CVodeSetLinearSolutionScaling(void *cvode_mem,
 SUNDIALS_EXPORT int CVodeSetDeltaGammaMaxBadJac(void *cvode_mem,
                                                 realtype dgmax_jbad);
 SUNDIALS_EXPORT int CVodeSetEpsLin(void *cvode_mem, realtype eplifac);
+SUNDIALS_EXPORT int CVodeSetEpsLinMax(void *cvode_mem, realtype eplmax);
 SUNDIALS_EXPORT int CVodeSetLSNormFactor(void *arkode_mem,
                                          realtype nrmfac);
 SUNDIALS_EXPORT int CVodeSetPreconditioner(void *cvode_mem,
@@ -104,6 +105,7 @@ SUNDIALS_EXPORT int CVodeSetJacTimes(void *cvode_mem,
                                      CVLsJacTimesSetupFn jtsetup,
                                      CVLsJacTimesVecFn jtimes);
 SUNDIALS_EXPORT int CVodeSetLinSysFn(void *cvode_mem, CVLsLinSysFn linsys);
+SUNDIALS_EXPORT int CVodeSetJacSparsityPattern(void *cvode_mem, SUNMatrix S);
 
 /*-----------------------------------------------------------------
   Optional outputs from the CVLS linear solver interface
@@ -115,6 +117,8 @@ SUNDIALS_EXPORT int CVodeGetJacNumSteps(void *cvode_mem, long int *nst_J);
 SUNDIALS_EXPORT int CVodeGetLinWorkSpace(void *cvode_mem,
                                          long int *lenrwLS,
                                          long int *leniwLS);
+SUNDIALS_EXPORT int CVodeGetNumJacColors(void *cvode_mem,
+                                         long int *ncolors);
 SUNDIALS_EXPORT int CVodeGetNumJacEvals(void *cvode_mem,
                                         long int *njevals);
 SUNDIALS_EXPORT int CVodeGetNumPrecEvals(void *cvode_mem,
@@ -564,6 +564,9 @@ SUNDIALS_EXPORT int CVodeB(void *cvode_mem, realtype tBout, int itaskB);
 /* Optional Input Functions For Adjoint Problems */
 
 SUNDIALS_EXPORT int CVodeSetAdjNoSensi(void *cvode_mem);
+SUNDIALS_EXPORT int CVodeSetAdjMemoryBudget(void *cvode_mem, long int nbytes);
+SUNDIALS_EXPORT int CVodeSetAdjCheckpointFile(void *cvode_mem,
+                                              const char *filename);
 
 SUNDIALS_EXPORT int CVodeSetUserDataB(void *cvode_mem, int which,
                                       void *user_dataB);
@@ -599,6 +602,9 @@ SUNDIALS_EXPORT void *CVodeGetAdjCVodeBmem(void *cvode_mem, int which);
 
 SUNDIALS_EXPORT int CVodeGetAdjY(void *cvode_mem, realtype t, N_Vector y);
 
+SUNDIALS_EXPORT int CVodeGetAdjNumRecompSteps(void *cvode_mem,
+                                              long int *nstrecomp);
+
 typedef struct {
   void *my_addr;
   void *next_addr;
@@ -103,6 +103,7 @@ SUNDIALS_EXPORT int CVodeSetLinearSolutionScaling(void *cvode_mem,
 SUNDIALS_EXPORT int CVodeSetDeltaGammaMaxBadJac(void *cvode_mem,
                                                 realtype dgmax_jbad);
 SUNDIALS_EXPORT int CVodeSetEpsLin(void *cvode_mem, realtype eplifac);
+SUNDIALS_EXPORT int CVodeSetEpsLinMax(void *cvode_mem, realtype eplmax);
 SUNDIALS_EXPORT int CVodeSetLSNormFactor(void *arkode_mem,
                                          realtype nrmfac);
 SUNDIALS_EXPORT int CVodeSetPreconditioner(void *cvode_mem,
@@ -240,6 +241,9 @@ SUNDIALS_EXPORT int CVodeSetJacFnBS(void *cvode_mem, int which,
 SUNDIALS_EXPORT int CVodeSetEpsLinB(void *cvode_mem, int which,
                                     realtype eplifacB);
 
+SUNDIALS_EXPORT int CVodeSetEpsLinMaxB(void *cvode_mem, int which,
+                                       realtype eplmaxB);
+
 SUNDIALS_EXPORT int CVodeSetLSNormFactorB(void *arkode_mem, int which,
                                           realtype nrmfacB);
 
@@ -104,6 +104,7 @@ SUNDIALS_EXPORT int IDASetJacTimes(void *ida_mem,
                                    IDALsJacTimesSetupFn jtsetup,
                                    IDALsJacTimesVecFn jtimes);
 SUNDIALS_EXPORT int IDASetEpsLin(void *ida_mem, realtype eplifac);
+SUNDIALS_EXPORT int IDASetEpsLinMax(void *ida_mem, realtype eplmax);
 SUNDIALS_EXPORT int IDASetLSNormFactor(void *ida_mem,
                                        realtype nrmfac);
 SUNDIALS_EXPORT int IDASetLinearSolutionScaling(void *ida_mem,
@@ -240,6 +241,8 @@ SUNDIALS_EXPORT int IDASetJacFnBS(void *ida_mem, int which,
 
 SUNDIALS_EXPORT int IDASetEpsLinB(void *ida_mem, int which,
                                   realtype eplifacB);
+SUNDIALS_EXPORT int IDASetEpsLinMaxB(void *ida_mem, int which,
+                                     realtype eplmaxB);
 SUNDIALS_EXPORT int IDASetLSNormFactorB(void *ida_mem, int which,
                                         realtype nrmfacB);
 SUNDIALS_EXPORT int IDASetLinearSolutionScalingB(void *ida_mem, int which,
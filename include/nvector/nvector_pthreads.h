@@ -57,11 +57,18 @@ extern "C" {
  * -----------------------------------------------------------------
  */
 
+/* Persistent team of worker threads shared by a vector and its clones. The
+   team is created with the vector and the workers wait for work between
+   vector operations rather than being created and joined for every call. */
+
+struct _Pthreads_Team;
+
 struct _N_VectorContent_Pthreads {
-  sunindextype length;   /* vector length           */
-  booleantype own_data;  /* data ownership flag     */
-  realtype *data;        /* data array              */
-  int num_threads;       /* number of POSIX threads */
+  sunindextype length;         /* vector length              */
+  booleantype own_data;        /* data ownership flag        */
+  realtype *data;              /* data array                 */
+  int num_threads;             /* number of POSIX threads    */
+  struct _Pthreads_Team *team; /* persistent thread team     */
 };
 
 typedef struct _N_VectorContent_Pthreads *N_VectorContent_Pthreads;
@@ -112,6 +119,8 @@ typedef struct _Pthreads_Data Pthreads_Data;
 
 #define NV_NUM_THREADS_PT(v)   ( NV_CONTENT_PT(v)->num_threads )
 
+#define NV_TEAM_PT(v)          ( NV_CONTENT_PT(v)->team )
+
 #define NV_OWN_DATA_PT(v)      ( NV_CONTENT_PT(v)->own_data )
 
 #define NV_DATA_PT(v)          ( NV_CONTENT_PT(v)->data )
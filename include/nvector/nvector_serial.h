@@ -51,10 +51,15 @@ extern "C" {
  * -----------------------------------------------------------------
  */
 
+/* Table of explicitly vectorized kernels, see N_VEnableSIMD_Serial */
+
+struct _N_VSIMDKernels_Serial;
+
 struct _N_VectorContent_Serial {
-  sunindextype length;   /* vector length       */
-  booleantype own_data;  /* data ownership flag */
-  realtype *data;        /* data array          */
+  sunindextype length;                        /* vector length       */
+  booleantype own_data;                       /* data ownership flag */
+  realtype *data;                             /* data array          */
+  const struct _N_VSIMDKernels_Serial *simd;  /* SIMD kernels or NULL */
 };
 
 typedef struct _N_VectorContent_Serial *N_VectorContent_Serial;
@@ -74,6 +79,8 @@ typedef struct _N_VectorContent_Serial *N_VectorContent_Serial;
 
 #define NV_DATA_S(v)     ( NV_CONTENT_S(v)->data )
 
+#define NV_SIMD_S(v)     ( NV_CONTENT_S(v)->simd )
+
 #define NV_Ith_S(v,i)    ( NV_DATA_S(v)[i] )
 
 /*
@@ -184,6 +191,9 @@ SUNDIALS_EXPORT int N_VEnableWrmsNormMaskVectorArray_Serial(N_Vector v, booleant
 SUNDIALS_EXPORT int N_VEnableScaleAddMultiVectorArray_Serial(N_Vector v, booleantype tf);
 SUNDIALS_EXPORT int N_VEnableLinearCombinationVectorArray_Serial(N_Vector v, booleantype tf);
 
+/* explicitly vectorized kernels */
+SUNDIALS_EXPORT int N_VEnableSIMD_Serial(N_Vector v, booleantype tf);
+
 /*
  * -----------------------------------------------------------------
  * Deprecated functions
@@ -69,13 +69,17 @@ enum { SUN_PREC_NONE, SUN_PREC_LEFT, SUN_PREC_RIGHT, SUN_PREC_BOTH };
  * SUN_CLASSICAL_GS : The iterative solver uses the classical
  *                    Gram-Schmidt routine SUNClassicalGS listed in
  *                    this file.
+ *
+ * SUN_DCGS2_GS     : The iterative solver uses delayed classical
+ *                    Gram-Schmidt with reorthogonalization, requiring
+ *                    one global reduction per iteration.
  * -----------------------------------------------------------------
  */
 
 /* DEPRECATED MODIFIED_GS: use SUN_MODIFIED_GS */
 /* DEPRECATED CLASSICAL_GS: use SUN_CLASSICAL_GS */
 enum { MODIFIED_GS = 1, CLASSICAL_GS = 2 };
-enum { SUN_MODIFIED_GS = 1, SUN_CLASSICAL_GS = 2 };
+enum { SUN_MODIFIED_GS = 1, SUN_CLASSICAL_GS = 2, SUN_DCGS2_GS = 3 };
 
 /*
  * -----------------------------------------------------------------
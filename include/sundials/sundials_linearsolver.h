@@ -93,6 +93,9 @@ typedef enum
   SUNLINEARSOLVER_ONEMKLDENSE,
   SUNLINEARSOLVER_GINKGO,
   SUNLINEARSOLVER_KOKKOSDENSE,
+  SUNLINEARSOLVER_SSGMR,
+  SUNLINEARSOLVER_GCRODR,
+  SUNLINEARSOLVER_BLOCKDENSE,
   SUNLINEARSOLVER_CUSTOM
 } SUNLinearSolver_ID;
 
@@ -67,6 +67,7 @@ typedef enum
   SUNMATRIX_CUSPARSE,
   SUNMATRIX_GINKGO,
   SUNMATRIX_KOKKOSDENSE,
+  SUNMATRIX_BLOCKDENSE,
   SUNMATRIX_CUSTOM
 } SUNMatrix_ID;
 
@@ -108,6 +108,7 @@ struct _generic_SUNNonlinearSolver_Ops
   int (*getnumiters)(SUNNonlinearSolver, long int*);
   int (*getcuriter)(SUNNonlinearSolver, int*);
   int (*getnumconvfails)(SUNNonlinearSolver, long int*);
+  int (*getforcingterm)(SUNNonlinearSolver, realtype*);
 #ifdef __cplusplus
   _generic_SUNNonlinearSolver_Ops() = default;
 #endif
@@ -164,6 +165,8 @@ SUNDIALS_EXPORT int SUNNonlinSolGetCurIter(SUNNonlinearSolver NLS, int* iter);
 
 SUNDIALS_EXPORT int SUNNonlinSolGetNumConvFails(SUNNonlinearSolver NLS, long int* nconvfails);
 
+SUNDIALS_EXPORT int SUNNonlinSolGetForcingTerm(SUNNonlinearSolver NLS, realtype* eta);
+
 /* -----------------------------------------------------------------------------
  * SUNNonlinearSolver return values
  * ---------------------------------------------------------------------------*/
@@ -18,6 +18,7 @@
 #include <stdio.h>
 
 #include "sundials/sundials_config.h"
+#include "sundials/sundials_types.h"
 
 #if defined(SUNDIALS_BUILD_WITH_PROFILING) && defined(SUNDIALS_CALIPER_ENABLED)
 #include "caliper/cali.h"
@@ -36,6 +37,21 @@ SUNDIALS_EXPORT int SUNProfiler_End(SUNProfiler p, const char* name);
 SUNDIALS_EXPORT int SUNProfiler_Print(SUNProfiler p, FILE* fp);
 SUNDIALS_EXPORT int SUNProfiler_Reset(SUNProfiler p);
 
+/* Timers registered by name return integer handles that are valid for all
+   profilers and can be used with the lower overhead Id functions */
+SUNDIALS_EXPORT int SUNProfiler_RegisterTimer(const char* name, int* id);
+SUNDIALS_EXPORT int SUNProfiler_TimerId(const char* name, int* cache);
+SUNDIALS_EXPORT int SUNProfiler_BeginId(SUNProfiler p, int id);
+SUNDIALS_EXPORT int SUNProfiler_EndId(SUNProfiler p, int id);
+
+/* Accumulate hardware counters (Linux perf events) for each region */
+SUNDIALS_EXPORT int SUNProfiler_EnableCounters(SUNProfiler p, booleantype onoff);
+
+/* Record a timeline of region begin/end events and write it in the Chrome
+   trace event format */
+SUNDIALS_EXPORT int SUNProfiler_EnableTrace(SUNProfiler p, long capacity);
+SUNDIALS_EXPORT int SUNProfiler_WriteTrace(SUNProfiler p, const char* filename);
+
 #if defined(SUNDIALS_BUILD_WITH_PROFILING) && defined(SUNDIALS_CALIPER_ENABLED)
 
 #define SUNDIALS_MARK_FUNCTION_BEGIN(profobj) CALI_MARK_FUNCTION_BEGIN
@@ -54,9 +70,14 @@ SUNDIALS_EXPORT int SUNProfiler_Reset(SUNProfiler p);
 
 #elif defined(SUNDIALS_BUILD_WITH_PROFILING)
 
-#define SUNDIALS_MARK_FUNCTION_BEGIN(profobj) SUNProfiler_Begin(profobj, __func__)
+/* The function timer handle is registered on the first call and cached in a
+   static variable that is shared with SUNDIALS_MARK_FUNCTION_END */
+#define SUNDIALS_MARK_FUNCTION_BEGIN(profobj) \
+    static int sun_profiler_func_id = -1; \
+    SUNProfiler_BeginId(profobj, SUNProfiler_TimerId(__func__, &sun_profiler_func_id))
 
-#define SUNDIALS_MARK_FUNCTION_END(profobj) SUNProfiler_End(profobj, __func__)
+#define SUNDIALS_MARK_FUNCTION_END(profobj) \
+    SUNProfiler_EndId(profobj, SUNProfiler_TimerId(__func__, &sun_profiler_func_id))
 
 #define SUNDIALS_WRAP_STATEMENT(profobj, name, stmt) \
     SUNProfiler_Begin(profobj, (name)); \
@@ -68,7 +89,10 @@ SUNDIALS_EXPORT int SUNProfiler_Reset(SUNProfiler p);
 #define SUNDIALS_MARK_END(profobj, name) SUNProfiler_End(profobj, (name))
 
 #ifdef __cplusplus
-#define SUNDIALS_CXX_MARK_FUNCTION(profobj) sundials::ProfilerMarkScope __ProfilerMarkScope(profobj, __func__)
+#define SUNDIALS_CXX_MARK_FUNCTION(profobj) \
+    static int sun_profiler_func_id = -1; \
+    sundials::ProfilerMarkScope __ProfilerMarkScope(profobj, \
+      SUNProfiler_TimerId(__func__, &sun_profiler_func_id))
 #endif
 
 #else
@@ -102,15 +126,25 @@ public:
   ProfilerMarkScope(SUNProfiler prof, const char* name) {
     prof_ = prof;
     name_ = name;
+    id_   = -1;
     SUNProfiler_Begin(prof_, name_);
   }
 
+  ProfilerMarkScope(SUNProfiler prof, int id) {
+    prof_ = prof;
+    name_ = nullptr;
+    id_   = id;
+    SUNProfiler_BeginId(prof_, id_);
+  }
+
   ~ProfilerMarkScope() {
-    SUNProfiler_End(prof_, name_);
+    if (name_) SUNProfiler_End(prof_, name_);
+    else SUNProfiler_EndId(prof_, id_);
   }
 private:
   SUNProfiler prof_;
   const char* name_;
+  int id_;
 };
 }
 
@@ -47,6 +47,15 @@ struct _SUNLinearSolverContent_Dense {
   sunindextype N;
   sunindextype *pivots;
   sunindextype last_flag;
+  /* mixed precision factorization with iterative refinement */
+  booleantype mixed;
+  booleantype fallback;
+  float *lu;
+  float *fwork;
+  realtype *rwork;
+  realtype anorm;
+  long int nrefine;
+  long int nfallback;
 };
 
 typedef struct _SUNLinearSolverContent_Dense *SUNLinearSolverContent_Dense;
@@ -56,6 +65,12 @@ typedef struct _SUNLinearSolverContent_Dense *SUNLinearSolverContent_Dense;
  * ---------------------------------------- */
 
 SUNDIALS_EXPORT SUNLinearSolver SUNLinSol_Dense(N_Vector y, SUNMatrix A, SUNContext sunctx);
+SUNDIALS_EXPORT int SUNLinSol_DenseSetMixedPrecision(SUNLinearSolver S,
+                                                     booleantype onoff);
+SUNDIALS_EXPORT int SUNLinSol_DenseGetNumRefineIters(SUNLinearSolver S,
+                                                     long int *nrefine);
+SUNDIALS_EXPORT int SUNLinSol_DenseGetNumFallbacks(SUNLinearSolver S,
+                                                   long int *nfallback);
 SUNDIALS_EXPORT SUNLinearSolver_Type SUNLinSolGetType_Dense(SUNLinearSolver S);
 SUNDIALS_EXPORT SUNLinearSolver_ID SUNLinSolGetID_Dense(SUNLinearSolver S);
 SUNDIALS_EXPORT int SUNLinSolInitialize_Dense(SUNLinearSolver S);
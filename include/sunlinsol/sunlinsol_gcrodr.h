@@ -0,0 +1,153 @@
+/* -----------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------
+ * This is the header file for the GCRODR implementation of the
+ * SUNLINSOL module, SUNLINSOL_GCRODR.  The GCRODR algorithm is a
+ * Krylov subspace recycling variant of the Scaled Preconditioned
+ * GMRES (Generalized Minimal Residual) method that retains a
+ * deflation subspace of harmonic Ritz vectors between restarts and
+ * between calls to the solver.
+ *
+ * Note:
+ *   - The definition of the generic SUNLinearSolver structure can
+ *     be found in the header file sundials_linearsolver.h.
+ * -----------------------------------------------------------------
+ */
+
+#ifndef _SUNLINSOL_GCRODR_H
+#define _SUNLINSOL_GCRODR_H
+
+#include <stdio.h>
+
+#include <sundials/sundials_linearsolver.h>
+#include <sundials/sundials_matrix.h>
+#include <sundials/sundials_nvector.h>
+
+#ifdef __cplusplus  /* wrapper to enable C++ usage */
+extern "C" {
+#endif
+
+/* Default GCRODR solver parameters */
+#define SUNGCRODR_MAXL_DEFAULT    5
+#define SUNGCRODR_MAXRS_DEFAULT   0
+#define SUNGCRODR_KDIM_DEFAULT    2
+
+/* -----------------------------------------
+ * GCRODR Implementation of SUNLinearSolver
+ * ----------------------------------------- */
+
+struct _SUNLinearSolverContent_GCRODR {
+  int maxl;
+  int pretype;
+  int kdim;
+  int max_restarts;
+  booleantype zeroguess;
+  int numiters;
+  realtype resnorm;
+  int last_flag;
+
+  SUNATimesFn ATimes;
+  void* ATData;
+  SUNPSetupFn Psetup;
+  SUNPSolveFn Psolve;
+  void* PData;
+
+  N_Vector s1;
+  N_Vector s2;
+  N_Vector *V;
+  realtype **Hes;
+  realtype **QR;
+  realtype *givens;
+  N_Vector xcor;
+  realtype *yg;
+  N_Vector vtemp;
+
+  realtype *cv;
+  N_Vector *Xv;
+  N_Vector *W;
+
+  int nrecycle;
+  N_Vector *U;
+  N_Vector *C;
+  N_Vector *Unew;
+  N_Vector *Cnew;
+
+  booleantype sb;
+  realtype **WZ;
+  realtype **A1;
+  realtype **X;
+  realtype **E;
+  realtype **P;
+  realtype **Q;
+  realtype **R;
+  sunindextype *pivots;
+  realtype *work;
+
+  long int nupdates;
+  long int nratimes;
+};
+
+typedef struct _SUNLinearSolverContent_GCRODR *SUNLinearSolverContent_GCRODR;
+
+
+/* ----------------------------------------
+ * Exported Functions for SUNLINSOL_GCRODR
+ * ---------------------------------------- */
+
+SUNDIALS_EXPORT SUNLinearSolver SUNLinSol_GCRODR(N_Vector y,
+                                                 int pretype,
+                                                 int maxl,
+                                                 SUNContext sunctx);
+SUNDIALS_EXPORT int SUNLinSol_GCRODRSetPrecType(SUNLinearSolver S,
+                                                int pretype);
+SUNDIALS_EXPORT int SUNLinSol_GCRODRSetRecycleDim(SUNLinearSolver S,
+                                                  int kdim);
+SUNDIALS_EXPORT int SUNLinSol_GCRODRSetMaxRestarts(SUNLinearSolver S,
+                                                   int maxrs);
+SUNDIALS_EXPORT int SUNLinSol_GCRODRResetRecycle(SUNLinearSolver S);
+SUNDIALS_EXPORT int SUNLinSol_GCRODRGetRecycleDim(SUNLinearSolver S,
+                                                  int *nrecycle);
+SUNDIALS_EXPORT int SUNLinSol_GCRODRGetNumRecycleUpdates(SUNLinearSolver S,
+                                                         long int *nupdates);
+SUNDIALS_EXPORT int SUNLinSol_GCRODRGetNumRecycleATimes(SUNLinearSolver S,
+                                                        long int *nratimes);
+SUNDIALS_EXPORT SUNLinearSolver_Type SUNLinSolGetType_GCRODR(SUNLinearSolver S);
+SUNDIALS_EXPORT SUNLinearSolver_ID SUNLinSolGetID_GCRODR(SUNLinearSolver S);
+SUNDIALS_EXPORT int SUNLinSolInitialize_GCRODR(SUNLinearSolver S);
+SUNDIALS_EXPORT int SUNLinSolSetATimes_GCRODR(SUNLinearSolver S, void* A_data,
+                                              SUNATimesFn ATimes);
+SUNDIALS_EXPORT int SUNLinSolSetPreconditioner_GCRODR(SUNLinearSolver S,
+                                                      void* P_data,
+                                                      SUNPSetupFn Pset,
+                                                      SUNPSolveFn Psol);
+SUNDIALS_EXPORT int SUNLinSolSetScalingVectors_GCRODR(SUNLinearSolver S,
+                                                      N_Vector s1,
+                                                      N_Vector s2);
+SUNDIALS_EXPORT int SUNLinSolSetZeroGuess_GCRODR(SUNLinearSolver S,
+                                                 booleantype onff);
+SUNDIALS_EXPORT int SUNLinSolSetup_GCRODR(SUNLinearSolver S, SUNMatrix A);
+SUNDIALS_EXPORT int SUNLinSolSolve_GCRODR(SUNLinearSolver S, SUNMatrix A,
+                                          N_Vector x, N_Vector b, realtype tol);
+SUNDIALS_EXPORT int SUNLinSolNumIters_GCRODR(SUNLinearSolver S);
+SUNDIALS_EXPORT realtype SUNLinSolResNorm_GCRODR(SUNLinearSolver S);
+SUNDIALS_EXPORT N_Vector SUNLinSolResid_GCRODR(SUNLinearSolver S);
+SUNDIALS_EXPORT sunindextype SUNLinSolLastFlag_GCRODR(SUNLinearSolver S);
+SUNDIALS_EXPORT int SUNLinSolSpace_GCRODR(SUNLinearSolver S,
+                                          long int *lenrwLS,
+                                          long int *leniwLS);
+SUNDIALS_EXPORT int SUNLinSolFree_GCRODR(SUNLinearSolver S);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -60,6 +60,13 @@ struct _SUNLinearSolverContent_PCG {
   N_Vector z;
   N_Vector Ap;
 
+  booleantype pipelined;
+  N_Vector w;
+  N_Vector m;
+  N_Vector n;
+  N_Vector q;
+  N_Vector Aq;
+
   int print_level;
   FILE* info_file;
 };
@@ -79,6 +86,8 @@ SUNDIALS_EXPORT int SUNLinSol_PCGSetPrecType(SUNLinearSolver S,
                                              int pretype);
 SUNDIALS_EXPORT int SUNLinSol_PCGSetMaxl(SUNLinearSolver S,
                                          int maxl);
+SUNDIALS_EXPORT int SUNLinSol_PCGSetPipelined(SUNLinearSolver S,
+                                              booleantype onoff);
 
 SUNDIALS_EXPORT SUNLinearSolver_Type SUNLinSolGetType_PCG(SUNLinearSolver S);
 SUNDIALS_EXPORT SUNLinearSolver_ID SUNLinSolGetID_PCG(SUNLinearSolver S);
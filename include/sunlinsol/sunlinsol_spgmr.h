@@ -67,6 +67,7 @@ struct _SUNLinearSolverContent_SPGMR {
   N_Vector s2;
   N_Vector *V;
   realtype **Hes;
+  realtype **QR;
   realtype *givens;
   N_Vector xcor;
   realtype *yg;
@@ -0,0 +1,112 @@
+/* -----------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------
+ * This is the header file for the block-diagonal dense implementation
+ * of the SUNMATRIX module, SUNMATRIX_BLOCKDENSE.
+ *
+ * Notes:
+ *   - The matrix is block diagonal with nblocks square dense blocks
+ *     of size M, for a total of nblocks*M rows and columns. Block k
+ *     acts on the entries k*M, ..., (k+1)*M-1 of a vector.
+ *   - The blocks are interleaved in a single data array, entry (i,j)
+ *     of block k is stored in data[(j*M + i)*nblocks + k], so that
+ *     operations that loop over the blocks access contiguous memory.
+ *   - The definition of the generic SUNMatrix structure can be found
+ *     in the header file sundials_matrix.h.
+ * -----------------------------------------------------------------
+ */
+
+#ifndef _SUNMATRIX_BLOCKDENSE_H
+#define _SUNMATRIX_BLOCKDENSE_H
+
+#include <stdio.h>
+#include <sundials/sundials_matrix.h>
+
+#ifdef __cplusplus  /* wrapper to enable C++ usage */
+extern "C" {
+#endif
+
+/* ------------------------------------------------------
+ * Block-diagonal Dense Implementation of SUNMATRIX_BLOCKDENSE
+ * ------------------------------------------------------ */
+
+struct _SUNMatrixContent_BlockDense {
+  sunindextype nblocks;   /* number of blocks                         */
+  sunindextype M;         /* number of rows and columns in each block */
+  sunindextype ldata;     /* length of data array, nblocks*M*M        */
+  realtype *data;         /* interleaved block entries                */
+  int num_threads;        /* number of OpenMP threads                 */
+};
+
+typedef struct _SUNMatrixContent_BlockDense *SUNMatrixContent_BlockDense;
+
+/* --------------------------------------------
+ * Macros for access to SUNMATRIX_BLOCKDENSE
+ * -------------------------------------------- */
+
+#define SM_CONTENT_BD(A)     ( (SUNMatrixContent_BlockDense)(A->content) )
+
+#define SM_NBLOCKS_BD(A)     ( SM_CONTENT_BD(A)->nblocks )
+
+#define SM_BLOCKROWS_BD(A)   ( SM_CONTENT_BD(A)->M )
+
+#define SM_ROWS_BD(A)        ( SM_CONTENT_BD(A)->nblocks * SM_CONTENT_BD(A)->M )
+
+#define SM_COLUMNS_BD(A)     ( SM_CONTENT_BD(A)->nblocks * SM_CONTENT_BD(A)->M )
+
+#define SM_LDATA_BD(A)       ( SM_CONTENT_BD(A)->ldata )
+
+#define SM_DATA_BD(A)        ( SM_CONTENT_BD(A)->data )
+
+#define SM_NUMTHREADS_BD(A)  ( SM_CONTENT_BD(A)->num_threads )
+
+#define SM_ELEMENT_BD(A,k,i,j) \
+  ( SM_CONTENT_BD(A)->data[((j)*SM_CONTENT_BD(A)->M + (i))*SM_CONTENT_BD(A)->nblocks + (k)] )
+
+/* ---------------------------------------------
+ * Exported Functions for SUNMATRIX_BLOCKDENSE
+ * --------------------------------------------- */
+
+SUNDIALS_EXPORT SUNMatrix SUNBlockDenseMatrix(sunindextype nblocks,
+                                              sunindextype M,
+                                              SUNContext sunctx);
+
+SUNDIALS_EXPORT int SUNBlockDenseMatrix_SetNumThreads(SUNMatrix A,
+                                                      int num_threads);
+
+SUNDIALS_EXPORT void SUNBlockDenseMatrix_Print(SUNMatrix A, FILE* outfile);
+
+SUNDIALS_EXPORT sunindextype SUNBlockDenseMatrix_Rows(SUNMatrix A);
+SUNDIALS_EXPORT sunindextype SUNBlockDenseMatrix_Columns(SUNMatrix A);
+SUNDIALS_EXPORT sunindextype SUNBlockDenseMatrix_NumBlocks(SUNMatrix A);
+SUNDIALS_EXPORT sunindextype SUNBlockDenseMatrix_BlockRows(SUNMatrix A);
+SUNDIALS_EXPORT sunindextype SUNBlockDenseMatrix_LData(SUNMatrix A);
+SUNDIALS_EXPORT realtype* SUNBlockDenseMatrix_Data(SUNMatrix A);
+SUNDIALS_EXPORT int SUNBlockDenseMatrix_NumThreads(SUNMatrix A);
+
+SUNDIALS_EXPORT SUNMatrix_ID SUNMatGetID_BlockDense(SUNMatrix A);
+SUNDIALS_EXPORT SUNMatrix SUNMatClone_BlockDense(SUNMatrix A);
+SUNDIALS_EXPORT void SUNMatDestroy_BlockDense(SUNMatrix A);
+SUNDIALS_EXPORT int SUNMatZero_BlockDense(SUNMatrix A);
+SUNDIALS_EXPORT int SUNMatCopy_BlockDense(SUNMatrix A, SUNMatrix B);
+SUNDIALS_EXPORT int SUNMatScaleAdd_BlockDense(realtype c, SUNMatrix A,
+                                              SUNMatrix B);
+SUNDIALS_EXPORT int SUNMatScaleAddI_BlockDense(realtype c, SUNMatrix A);
+SUNDIALS_EXPORT int SUNMatMatvec_BlockDense(SUNMatrix A, N_Vector x,
+                                            N_Vector y);
+SUNDIALS_EXPORT int SUNMatSpace_BlockDense(SUNMatrix A, long int *lenrw,
+                                           long int *leniw);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -53,6 +53,28 @@ extern "C" {
  * Sparse Implementation of SUNMATRIX_SPARSE
  * ------------------------------------------ */
 
+/* Pattern maps recorded by SUNMatScaleAddI and SUNMatScaleAdd the
+   first time they see a sparsity pattern. While the patterns of A
+   and B are unchanged the update A = c*A + B is applied with these
+   maps in a single pass without scanning or allocation. For
+   SUNMatScaleAddI, B is the identity and bmap holds the locations
+   of the diagonal. */
+
+struct _SUNSparseAddMap {
+  sunindextype NP;         /* number of index pointers                */
+  sunindextype nnzA;       /* nonzeros in A before the update         */
+  sunindextype nnzB;       /* nonzeros in B                           */
+  sunindextype nnzC;       /* nonzeros in the result c*A + B          */
+  sunindextype *Ap;        /* index pointers of A before the update   */
+  sunindextype *Ai;        /* index values of A before the update     */
+  sunindextype *Bp;        /* index pointers of B (NULL for identity) */
+  sunindextype *Bi;        /* index values of B (NULL for identity)   */
+  sunindextype *Cp;        /* index pointers of the result, NULL when */
+  sunindextype *Ci;        /*   the result keeps the pattern of A     */
+  sunindextype *amap;      /* entry of A -> location in the result    */
+  sunindextype *bmap;      /* entry of B -> location in the result    */
+};
+
 struct _SUNMatrixContent_Sparse {
   sunindextype M;
   sunindextype N;
@@ -68,6 +90,12 @@ struct _SUNMatrixContent_Sparse {
   /* CSR indices */
   sunindextype **colvals;
   sunindextype **rowptrs;
+  /* threaded matrix-vector product */
+  int num_threads;
+  realtype *work;
+  /* cached pattern maps for SUNMatScaleAddI and SUNMatScaleAdd */
+  struct _SUNSparseAddMap *addimap;
+  struct _SUNSparseAddMap *addmap;
 };
 
 typedef struct _SUNMatrixContent_Sparse *SUNMatrixContent_Sparse;
@@ -95,6 +123,47 @@ typedef struct _SUNMatrixContent_Sparse *SUNMatrixContent_Sparse;
 
 #define SM_INDEXPTRS_S(A)   ( SM_CONTENT_S(A)->indexptrs )
 
+#define SM_NUMTHREADS_S(A)  ( SM_CONTENT_S(A)->num_threads )
+
+
+/* ---------------------------------------------------------------
+ * Incomplete LU factorization of a square SUNMATRIX_SPARSE. The
+ * factors are stored together in CSR format (unit lower triangle
+ * of L and upper triangle of U) with a fixed sparsity pattern
+ * computed once by a symbolic ILU(k) level-of-fill pass so that
+ * the numeric factorization can be repeated for new values of a
+ * matrix with the same pattern. The rows of each triangular solve
+ * are grouped into levels of mutually independent rows, which are
+ * split across OpenMP threads when enabled.
+ * --------------------------------------------------------------- */
+
+struct _SUNSparseILUContent {
+  sunindextype N;          /* matrix dimension                        */
+  int fill;                /* level of fill, k in ILU(k)              */
+  int num_threads;         /* threads used in the triangular solves   */
+  realtype droptol;        /* relative drop tolerance                 */
+  sunindextype nnz;        /* nonzeros in the combined L+U pattern    */
+  sunindextype *rowptr;    /* row pointers of L+U (length N+1)        */
+  sunindextype *colind;    /* sorted column indices of L+U            */
+  sunindextype *diag;      /* location of the diagonal in each row    */
+  realtype *vals;          /* factor values                           */
+  int sparsetype;          /* storage type of the input matrix        */
+  sunindextype annz;       /* nonzeros of the input matrix            */
+  sunindextype *aptr;      /* index pointers of the input matrix      */
+  sunindextype *aidx;      /* index values of the input matrix        */
+  sunindextype *amap;      /* input matrix entry -> L+U location      */
+  sunindextype nlevL;      /* number of levels in the L solve         */
+  sunindextype *levptrL;   /* level pointers for the L solve          */
+  sunindextype *levrowL;   /* rows ordered by level for the L solve   */
+  sunindextype nlevU;      /* number of levels in the U solve         */
+  sunindextype *levptrU;   /* level pointers for the U solve          */
+  sunindextype *levrowU;   /* rows ordered by level for the U solve   */
+  sunindextype *iwork;     /* integer workspace (length N)            */
+  realtype *rwork;         /* real workspace (length N)               */
+};
+
+typedef struct _SUNSparseILUContent *SUNSparseILU;
+
 /* ----------------------------------------
  * Exported Functions for SUNMATRIX_SPARSE
  * ---------------------------------------- */
@@ -118,6 +187,8 @@ SUNDIALS_EXPORT int SUNSparseMatrix_Realloc(SUNMatrix A);
 
 SUNDIALS_EXPORT int SUNSparseMatrix_Reallocate(SUNMatrix A, sunindextype NNZ);
 
+SUNDIALS_EXPORT int SUNSparseMatrix_SetNumThreads(SUNMatrix A, int num_threads);
+
 SUNDIALS_EXPORT void SUNSparseMatrix_Print(SUNMatrix A, FILE* outfile);
 
 SUNDIALS_EXPORT sunindextype SUNSparseMatrix_Rows(SUNMatrix A);
@@ -128,6 +199,7 @@ SUNDIALS_EXPORT int SUNSparseMatrix_SparseType(SUNMatrix A);
 SUNDIALS_EXPORT realtype* SUNSparseMatrix_Data(SUNMatrix A);
 SUNDIALS_EXPORT sunindextype* SUNSparseMatrix_IndexValues(SUNMatrix A);
 SUNDIALS_EXPORT sunindextype* SUNSparseMatrix_IndexPointers(SUNMatrix A);
+SUNDIALS_EXPORT int SUNSparseMatrix_NumThreads(SUNMatrix A);
 
 SUNDIALS_EXPORT SUNMatrix_ID SUNMatGetID_Sparse(SUNMatrix A);
 SUNDIALS_EXPORT SUNMatrix SUNMatClone_Sparse(SUNMatrix A);
@@ -139,6 +211,18 @@ SUNDIALS_EXPORT int SUNMatScaleAddI_Sparse(realtype c, SUNMatrix A);
 SUNDIALS_EXPORT int SUNMatMatvec_Sparse(SUNMatrix A, N_Vector x, N_Vector y);
 SUNDIALS_EXPORT int SUNMatSpace_Sparse(SUNMatrix A, long int *lenrw, long int *leniw);
 
+SUNDIALS_EXPORT SUNSparseILU SUNSparseMatrix_ILUCreate(SUNMatrix A, int fill);
+SUNDIALS_EXPORT int SUNSparseMatrix_ILUSetDropTol(SUNSparseILU ilu,
+                                                  realtype droptol);
+SUNDIALS_EXPORT int SUNSparseMatrix_ILUFactor(SUNSparseILU ilu, SUNMatrix A);
+SUNDIALS_EXPORT int SUNSparseMatrix_ILUSolve(SUNSparseILU ilu, N_Vector b,
+                                             N_Vector x);
+SUNDIALS_EXPORT int SUNSparseMatrix_ILUGetInfo(SUNSparseILU ilu,
+                                               sunindextype *nnzLU,
+                                               sunindextype *nlevL,
+                                               sunindextype *nlevU);
+SUNDIALS_EXPORT void SUNSparseMatrix_ILUFree(SUNSparseILU ilu);
+
 
 #ifdef __cplusplus
 }
@@ -25,6 +25,7 @@
 #include "sundials/sundials_types.h"
 #include "sundials/sundials_nvector.h"
 #include "sundials/sundials_nonlinearsolver.h"
+#include "sundials/sundials_iterative.h"
 
 #ifdef __cplusplus  /* wrapper to enable C++ usage */
 extern "C" {
@@ -63,6 +64,14 @@ struct _SUNNonlinearSolverContent_FixedPoint {
   long int     nconvfails; /* total number of convergence failures           */
   void        *ctest_data; /* data to pass to convergence test function      */
 
+  /* orthogonalization and adaptive depth for Anderson acceleration */
+  SUNQRAddFn   qr_func;    /* QR update function (NULL for built-in MGS)     */
+  struct _SUNQRData *qr_data; /* workspace for qr_func                       */
+  realtype     maxcond;    /* condition limit on R (0 for no limit)          */
+  int          naa;        /* current depth of the acceleration subspace     */
+  int          inext;      /* next df/dg slot to fill                        */
+  long int     nrestarts;  /* number of depth reductions due to conditioning */
+
   /* if 0 (default) nothing is printed, if 1 the residual is printed every iteration */
   int print_level;
   /* if NULL nothing is printed, if 1 the residual is printed every iteration */
@@ -109,6 +118,12 @@ SUNDIALS_EXPORT int SUNNonlinSolSetMaxIters_FixedPoint(SUNNonlinearSolver NLS,
 SUNDIALS_EXPORT int SUNNonlinSolSetDamping_FixedPoint(SUNNonlinearSolver NLS,
                                                       realtype beta);
 
+SUNDIALS_EXPORT int SUNNonlinSolSetQRAdd_FixedPoint(SUNNonlinearSolver NLS,
+                                                    SUNQRAddFn qr_func);
+
+SUNDIALS_EXPORT int SUNNonlinSolSetMaxCond_FixedPoint(SUNNonlinearSolver NLS,
+                                                      realtype maxcond);
+
 /* get functions */
 SUNDIALS_EXPORT int SUNNonlinSolGetNumIters_FixedPoint(SUNNonlinearSolver NLS,
                                                        long int *niters);
@@ -122,6 +137,9 @@ SUNDIALS_EXPORT int SUNNonlinSolGetNumConvFails_FixedPoint(SUNNonlinearSolver NL
 SUNDIALS_EXPORT int SUNNonlinSolGetSysFn_FixedPoint(SUNNonlinearSolver NLS,
                                                     SUNNonlinSolSysFn *SysFn);
 
+SUNDIALS_EXPORT int SUNNonlinSolGetNumRestarts_FixedPoint(SUNNonlinearSolver NLS,
+                                                          long int *nrestarts);
+
 SUNDIALS_DEPRECATED_EXPORT_MSG("Use SUNLogger_SetInfoFilename instead")
 int SUNNonlinSolSetInfoFile_FixedPoint(SUNNonlinearSolver NLS,
                                        FILE* info_file);
@@ -51,6 +51,15 @@ struct _SUNNonlinearSolverContent_Newton {
   long int    nconvfails; /* total number of convergence failures across all solves */
   void*       ctest_data; /* data to pass to convergence test function              */
 
+  /* Eisenstat-Walker forcing term variables */
+  booleantype forcing;    /* adaptive forcing term enabled (SUNTRUE) or not         */
+  realtype    eta;        /* current forcing term                                   */
+  realtype    eta0;       /* forcing term for the first iteration of an attempt     */
+  realtype    eta_max;    /* upper bound on the forcing term                        */
+  realtype    egamma;     /* forcing term scaling factor gamma                      */
+  realtype    ealpha;     /* forcing term exponent alpha                            */
+  realtype    fnorm;      /* WRMS norm of the previous nonlinear residual           */
+
   /* if 0 (default) nothing is printed, if 1 the residual is printed every iteration */
   int print_level;
   /* if NULL nothing is printed, if 1 the residual is printed every iteration */
@@ -100,6 +109,15 @@ SUNDIALS_EXPORT int SUNNonlinSolSetConvTestFn_Newton(SUNNonlinearSolver NLS,
 SUNDIALS_EXPORT int SUNNonlinSolSetMaxIters_Newton(SUNNonlinearSolver NLS,
                                                    int maxiters);
 
+SUNDIALS_EXPORT int SUNNonlinSolSetForcing_Newton(SUNNonlinearSolver NLS,
+                                                  booleantype adaptive);
+
+SUNDIALS_EXPORT int SUNNonlinSolSetForcingParams_Newton(SUNNonlinearSolver NLS,
+                                                        realtype eta0,
+                                                        realtype eta_max,
+                                                        realtype egamma,
+                                                        realtype ealpha);
+
 /* get functions */
 SUNDIALS_EXPORT int SUNNonlinSolGetNumIters_Newton(SUNNonlinearSolver NLS,
                                                    long int *niters);
@@ -110,6 +128,9 @@ SUNDIALS_EXPORT int SUNNonlinSolGetCurIter_Newton(SUNNonlinearSolver NLS,
 SUNDIALS_EXPORT int SUNNonlinSolGetNumConvFails_Newton(SUNNonlinearSolver NLS,
                                                        long int *nconvfails);
 
+SUNDIALS_EXPORT int SUNNonlinSolGetForcingTerm_Newton(SUNNonlinearSolver NLS,
+                                                      realtype *eta);
+
 SUNDIALS_EXPORT int SUNNonlinSolGetSysFn_Newton(SUNNonlinearSolver NLS,
                                                 SUNNonlinSolSysFn *SysFn);
 
@@ -82,6 +82,7 @@ ARKodeMem arkCreate(SUNContext sunctx)
   ark_mem->step_getlinmem      = NULL;
   ark_mem->step_getmassmem     = NULL;
   ark_mem->step_getimplicitrhs = NULL;
+  ark_mem->step_getnonlinsol   = NULL;
   ark_mem->step_mmult          = NULL;
   ark_mem->step_getgammas      = NULL;
   ark_mem->step_init           = NULL;
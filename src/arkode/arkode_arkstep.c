@@ -94,6 +94,7 @@ void* ARKStepCreate(ARKRhsFn fe, ARKRhsFn fi, realtype t0, N_Vector y0,
   ark_mem->step_getlinmem      = arkStep_GetLmem;
   ark_mem->step_getmassmem     = arkStep_GetMassMem;
   ark_mem->step_getimplicitrhs = arkStep_GetImplicitRHS;
+  ark_mem->step_getnonlinsol   = arkStep_GetNonlinSol;
   ark_mem->step_mmult          = NULL;
   ark_mem->step_getgammas      = arkStep_GetGammas;
   ark_mem->step_init           = arkStep_Init;
@@ -1017,6 +1018,25 @@ ARKRhsFn arkStep_GetImplicitRHS(void* arkode_mem)
 }
 
 
+/*---------------------------------------------------------------
+  arkStep_GetNonlinSol:
+
+  This routine returns the SUNNonlinearSolver object, NLS.
+  ---------------------------------------------------------------*/
+SUNNonlinearSolver arkStep_GetNonlinSol(void* arkode_mem)
+{
+  ARKodeMem ark_mem;
+  ARKodeARKStepMem step_mem;
+  int retval;
+
+  /* access ARKodeARKStepMem structure, and return NLS */
+  retval = arkStep_AccessStepMem(arkode_mem, "arkStep_GetNonlinSol",
+                                 &ark_mem, &step_mem);
+  if (retval != ARK_SUCCESS)  return(NULL);
+  return(step_mem->NLS);
+}
+
+
 /*---------------------------------------------------------------
   arkStep_GetGammas:
 
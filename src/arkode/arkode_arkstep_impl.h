@@ -186,6 +186,7 @@ int arkStep_Init(void* arkode_mem, int init_type);
 void* arkStep_GetLmem(void* arkode_mem);
 void* arkStep_GetMassMem(void* arkode_mem);
 ARKRhsFn arkStep_GetImplicitRHS(void* arkode_mem);
+SUNNonlinearSolver arkStep_GetNonlinSol(void* arkode_mem);
 int arkStep_GetGammas(void* arkode_mem, realtype *gamma,
                       realtype *gamrat, booleantype **jcur,
                       booleantype *dgamma_fail);
@@ -132,6 +132,8 @@ int ARKStepSetLinearSolutionScaling(void *arkode_mem, booleantype onoff) {
   return(arkLSSetLinearSolutionScaling(arkode_mem, onoff)); }
 int ARKStepSetEpsLin(void *arkode_mem, realtype eplifac) {
   return(arkLSSetEpsLin(arkode_mem, eplifac)); }
+int ARKStepSetEpsLinMax(void *arkode_mem, realtype eplmax) {
+  return(arkLSSetEpsLinMax(arkode_mem, eplmax)); }
 int ARKStepSetMassEpsLin(void *arkode_mem, realtype eplifac) {
   return(arkLSSetMassEpsLin(arkode_mem, eplifac)); }
 int ARKStepSetLSNormFactor(void *arkode_mem, realtype nrmfac) {
@@ -25,6 +25,7 @@
 #include <arkode/arkode_butcher_erk.h>
 #include <sundials/sundials_context.h>
 #include <sundials/sundials_linearsolver.h>
+#include <sundials/sundials_nonlinearsolver.h>
 
 #include "arkode_types_impl.h"
 #include "arkode_adapt_impl.h"
@@ -196,6 +197,7 @@ typedef void (*ARKTimestepDisableMSetup)(void* arkode_mem);
 typedef void* (*ARKTimestepGetLinMemFn)(void* arkode_mem);
 typedef void* (*ARKTimestepGetMassMemFn)(void* arkode_mem);
 typedef ARKRhsFn (*ARKTimestepGetImplicitRHSFn)(void* arkode_mem);
+typedef SUNNonlinearSolver (*ARKTimestepGetNonlinSolFn)(void* arkode_mem);
 typedef int (*ARKTimestepGetGammasFn)(void* arkode_mem,
                                       realtype *gamma,
                                       realtype *gamrat,
@@ -322,6 +324,7 @@ struct ARKodeMemRec
   ARKTimestepGetLinMemFn      step_getlinmem;
   ARKTimestepGetMassMemFn     step_getmassmem;
   ARKTimestepGetImplicitRHSFn step_getimplicitrhs;
+  ARKTimestepGetNonlinSolFn   step_getnonlinsol;
   ARKMassMultFn               step_mmult;
   ARKTimestepGetGammasFn      step_getgammas;
   ARKTimestepInitFn           step_init;
@@ -745,6 +748,18 @@ struct ARKodeMemRec
   active.
   ---------------------------------------------------------------*/
 
+/*---------------------------------------------------------------
+  ARKTimestepGetNonlinSolFn
+  ---------------------------------------------------------------
+  This routine should return the SUNNonlinearSolver object for
+  the current nonlinear solve; it is used inside the linear solver
+  interface to query the nonlinear solver forcing term when
+  setting the iterative linear solver tolerance.
+
+  This routine should return NULL if no nonlinear solver is
+  attached.
+  ---------------------------------------------------------------*/
+
 /*---------------------------------------------------------------
   ARKTimestepGetGammasFn
   ---------------------------------------------------------------
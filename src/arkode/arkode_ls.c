@@ -21,6 +21,7 @@
 #include "arkode_ls_impl.h"
 #include <sundials/sundials_math.h>
 #include <sunmatrix/sunmatrix_band.h>
+#include <sunmatrix/sunmatrix_blockdense.h>
 #include <sunmatrix/sunmatrix_dense.h>
 #include <sunmatrix/sunmatrix_sparse.h>
 
@@ -200,6 +201,7 @@ int arkLSSetLinearSolver(void *arkode_mem, SUNLinearSolver LS,
   arkls_mem->msbj      = ARKLS_MSBJ;
   arkls_mem->jbad      = SUNTRUE;
   arkls_mem->eplifac   = ARKLS_EPLIN;
+  arkls_mem->eplmax    = ARKLS_EPLMX;
   arkls_mem->last_flag = ARKLS_SUCCESS;
 
   /* If LS supports ATimes, attach ARKLs routine */
@@ -587,6 +589,27 @@ int arkLSSetEpsLin(void *arkode_mem, realtype eplifac)
 }
 
 
+/*---------------------------------------------------------------
+  arkLSSetEpsLinMax specifies the maximum nonlinear -> linear
+  tolerance scale factor used when relaxing the tolerance by a
+  nonlinear solver forcing term.
+  ---------------------------------------------------------------*/
+int arkLSSetEpsLinMax(void *arkode_mem, realtype eplmax)
+{
+  ARKodeMem ark_mem;
+  ARKLsMem  arkls_mem;
+  int       retval;
+
+  /* access ARKLsMem structure; store input and return */
+  retval = arkLs_AccessLMem(arkode_mem, "arkLSSetEpsLinMax",
+                            &ark_mem, &arkls_mem);
+  if (retval != ARK_SUCCESS)  return(retval);
+  arkls_mem->eplmax = (eplmax <= ZERO) ? ARKLS_EPLMX : eplmax;
+
+  return(ARKLS_SUCCESS);
+}
+
+
 /*---------------------------------------------------------------
   arkLSSetNormFactor sets or computes the factor to use when
   converting from the integrator tolerance (WRMS norm) to the
@@ -1954,6 +1977,9 @@ int arkLsDQJac(realtype t, N_Vector y, N_Vector fy,
   } else if (SUNMatGetID(Jac) == SUNMATRIX_BAND) {
     retval = arkLsBandDQJac(t, y, fy, Jac, ark_mem, arkls_mem,
                             fi, tmp1, tmp2);
+  } else if (SUNMatGetID(Jac) == SUNMATRIX_BLOCKDENSE) {
+    retval = arkLsBlockDenseDQJac(t, y, fy, Jac, ark_mem, arkls_mem,
+                                  fi, tmp1, tmp2);
   } else {
     arkProcessError(ark_mem, ARKLS_ILL_INPUT, "ARKLS", "arkLsDQJac",
                     "arkLsDQJac not implemented for this SUNMatrix type!");
@@ -2145,6 +2171,101 @@ int arkLsBandDQJac(realtype t, N_Vector y, N_Vector fy,
 }
 
 
+/*---------------------------------------------------------------
+  arkLsBlockDenseDQJac:
+
+  This routine generates a block-diagonal difference quotient
+  approximation to the Jacobian of f(t,y). It assumes a
+  SUNMATRIX_BLOCKDENSE input with nblocks uncoupled blocks of
+  size M, so column j of every block is perturbed at the same
+  time and only M calls to fi are needed. The elements are loaded
+  with the SM_ELEMENT_BD macro.
+  ---------------------------------------------------------------*/
+int arkLsBlockDenseDQJac(realtype t, N_Vector y, N_Vector fy,
+                         SUNMatrix Jac, ARKodeMem ark_mem,
+                         ARKLsMem arkls_mem, ARKRhsFn fi,
+                         N_Vector tmp1, N_Vector tmp2)
+{
+  N_Vector     ftemp, ytemp;
+  realtype     fnorm, minInc, inc, inc_inv, srur, conj;
+  realtype    *ewt_data, *fy_data, *ftemp_data, *y_data, *ytemp_data;
+  realtype    *cns_data;
+  sunindextype i, j, k, jk, N, M, nblocks;
+  int          retval = 0;
+
+  /* access matrix dimensions */
+  N = SUNBlockDenseMatrix_Columns(Jac);
+  M = SUNBlockDenseMatrix_BlockRows(Jac);
+  nblocks = SUNBlockDenseMatrix_NumBlocks(Jac);
+
+  /* Rename work vectors for use as temporary values of y and f */
+  ftemp = tmp1;
+  ytemp = tmp2;
+
+  /* Obtain pointers to the data for ewt, fy, ftemp, y, ytemp */
+  ewt_data   = N_VGetArrayPointer(ark_mem->ewt);
+  fy_data    = N_VGetArrayPointer(fy);
+  ftemp_data = N_VGetArrayPointer(ftemp);
+  y_data     = N_VGetArrayPointer(y);
+  ytemp_data = N_VGetArrayPointer(ytemp);
+  cns_data = (ark_mem->constraintsSet) ?
+    N_VGetArrayPointer(ark_mem->constraints) : NULL;
+
+  /* Load ytemp with y = predicted y vector */
+  N_VScale(ONE, y, ytemp);
+
+  /* Set minimum increment based on uround and norm of f */
+  srur = SUNRsqrt(ark_mem->uround);
+  fnorm = N_VWrmsNorm(fy, ark_mem->rwt);
+  minInc = (fnorm != ZERO) ?
+    (MIN_INC_MULT * SUNRabs(ark_mem->h) * ark_mem->uround * N * fnorm) : ONE;
+
+  /* Loop over the columns of a block */
+  for (j=0; j < M; j++) {
+
+    /* Increment y_j in all blocks */
+    for (k=0; k < nblocks; k++) {
+      jk = k*M + j;
+      inc = SUNMAX(srur*SUNRabs(y_data[jk]), minInc/ewt_data[jk]);
+
+      /* Adjust sign(inc) if yj has an inequality constraint. */
+      if (ark_mem->constraintsSet) {
+        conj = cns_data[jk];
+        if (SUNRabs(conj) == ONE)      {if ((ytemp_data[jk]+inc)*conj < ZERO)  inc = -inc;}
+        else if (SUNRabs(conj) == TWO) {if ((ytemp_data[jk]+inc)*conj <= ZERO) inc = -inc;}
+      }
+
+      ytemp_data[jk] += inc;
+    }
+
+    /* Evaluate f with incremented y */
+    retval = fi(ark_mem->tcur, ytemp, ftemp, ark_mem->user_data);
+    arkls_mem->nfeDQ++;
+    if (retval != 0) break;
+
+    /* Restore ytemp, then form and load difference quotients */
+    for (k=0; k < nblocks; k++) {
+      jk = k*M + j;
+      ytemp_data[jk] = y_data[jk];
+      inc = SUNMAX(srur*SUNRabs(y_data[jk]), minInc/ewt_data[jk]);
+
+      /* Adjust sign(inc) as before. */
+      if (ark_mem->constraintsSet) {
+        conj = cns_data[jk];
+        if (SUNRabs(conj) == ONE)      {if ((ytemp_data[jk]+inc)*conj < ZERO)  inc = -inc;}
+        else if (SUNRabs(conj) == TWO) {if ((ytemp_data[jk]+inc)*conj <= ZERO) inc = -inc;}
+      }
+
+      inc_inv = ONE/inc;
+      for (i=0; i < M; i++)
+        SM_ELEMENT_BD(Jac,k,i,j) = inc_inv * (ftemp_data[k*M+i] - fy_data[k*M+i]);
+    }
+  }
+
+  return(retval);
+}
+
+
 /*---------------------------------------------------------------
   arkLsDQJtimes:
 
@@ -2329,13 +2450,14 @@ int arkLsInitialize(void* arkode_mem)
       /* Check if an internal or user-supplied Jacobian function is used */
       if (arkls_mem->jacDQ) {
 
-        /* Internal difference quotient Jacobian. Check that A is dense or band,
-           otherwise return an error */
+        /* Internal difference quotient Jacobian. Check that A is dense, band
+           or block-diagonal dense, otherwise return an error */
         retval = 0;
         if (arkls_mem->A->ops->getid) {
 
           if ( (SUNMatGetID(arkls_mem->A) == SUNMATRIX_DENSE) ||
-               (SUNMatGetID(arkls_mem->A) == SUNMATRIX_BAND) ) {
+               (SUNMatGetID(arkls_mem->A) == SUNMATRIX_BAND) ||
+               (SUNMatGetID(arkls_mem->A) == SUNMATRIX_BLOCKDENSE) ) {
             arkls_mem->jac    = arkLsDQJac;
             arkls_mem->J_data = ark_mem;
           } else {
@@ -2608,8 +2730,9 @@ int arkLsSolve(void* arkode_mem, N_Vector b, realtype tnow,
   realtype    bnorm, resnorm;
   ARKodeMem   ark_mem;
   ARKLsMem    arkls_mem;
-  realtype    gamma, gamrat, delta, deltar, rwt_mean;
+  realtype    gamma, gamrat, delta, deltar, rwt_mean, eta;
   booleantype dgamma_fail, *jcur;
+  SUNNonlinearSolver NLS;
   long int    nps_inc;
   int         nli_inc, retval;
 
@@ -2636,8 +2759,19 @@ int arkLsSolve(void* arkode_mem, N_Vector b, realtype tnow,
       arkls_mem->last_flag = ARKLS_SUCCESS;
       return(arkls_mem->last_flag);
     }
+    /* Use the nonlinear solver forcing term (if any) as a relative
+       tolerance, limited to eplmax times the nonlinear tolerance */
+    eta = ZERO;
+    if (ark_mem->step_getnonlinsol) {
+      NLS = ark_mem->step_getnonlinsol(arkode_mem);
+      if (NLS != NULL) {
+        retval = SUNNonlinSolGetForcingTerm(NLS, &eta);
+        if (retval != SUN_NLS_SUCCESS) return(-1);
+      }
+    }
+    delta = SUNMAX(deltar, SUNMIN(eta * bnorm, arkls_mem->eplmax * eRNrm));
     /* Adjust tolerance for 2-norm */
-    delta = deltar * arkls_mem->nrmfac;
+    delta = delta * arkls_mem->nrmfac;
   } else {
     delta = bnorm = ZERO;
   }
@@ -33,9 +33,15 @@ extern "C" {
   ARKLS_EPLIN  default value for factor by which the tolerance
                on the nonlinear iteration is multiplied to get
                a tolerance on the linear iteration
+
+  ARKLS_EPLMX  default value for the maximum factor by which the
+               tolerance on the nonlinear iteration is multiplied
+               when the linear tolerance is relaxed by a nonlinear
+               solver forcing term
   ---------------------------------------------------------------*/
 #define ARKLS_MSBJ   51
 #define ARKLS_EPLIN  RCONST(0.05)
+#define ARKLS_EPLMX  RCONST(0.1)
 
 
 /*---------------------------------------------------------------
@@ -60,6 +66,7 @@ typedef struct ARKLsMemRec {
 
   /* Iterative solver tolerance */
   realtype eplifac;   /* nonlinear -> linear tol scaling factor        */
+  realtype eplmax;    /* max nonlinear -> linear tol scaling factor    */
   realtype nrmfac;    /* integrator -> LS norm conversion factor       */
 
   /* Linear solver, matrix and vector objects/pointers */
@@ -221,6 +228,10 @@ int arkLsBandDQJac(realtype t, N_Vector y, N_Vector fy,
                    SUNMatrix Jac, ARKodeMem ark_mem,
                    ARKLsMem arkls_mem, ARKRhsFn fi,
                    N_Vector tmp1, N_Vector tmp2);
+int arkLsBlockDenseDQJac(realtype t, N_Vector y, N_Vector fy,
+                         SUNMatrix Jac, ARKodeMem ark_mem,
+                         ARKLsMem arkls_mem, ARKRhsFn fi,
+                         N_Vector tmp1, N_Vector tmp2);
 
 /* Generic linit/lsetup/lsolve/lfree interface routines for ARKODE to call */
 int arkLsInitialize(void* arkode_mem);
@@ -266,6 +277,7 @@ int arkLSSetMassLinearSolver(void* arkode_mem, SUNLinearSolver LS,
 int arkLSSetJacFn(void* arkode_mem, ARKLsJacFn jac);
 int arkLSSetMassFn(void* arkode_mem, ARKLsMassFn mass);
 int arkLSSetEpsLin(void* arkode_mem, realtype eplifac);
+int arkLSSetEpsLinMax(void* arkode_mem, realtype eplmax);
 int arkLSSetMassEpsLin(void* arkode_mem, realtype eplifac);
 int arkLSSetNormFactor(void* arkode_mem, realtype nrmfac);
 int arkLSSetMassNormFactor(void* arkode_mem, realtype nrmfac);
@@ -103,6 +103,7 @@ void* MRIStepCreate(ARKRhsFn fse, ARKRhsFn fsi, realtype t0, N_Vector y0,
   ark_mem->step_disablelsetup  = mriStep_DisableLSetup;
   ark_mem->step_getlinmem      = mriStep_GetLmem;
   ark_mem->step_getimplicitrhs = mriStep_GetImplicitRHS;
+  ark_mem->step_getnonlinsol   = mriStep_GetNonlinSol;
   ark_mem->step_getgammas      = mriStep_GetGammas;
   ark_mem->step_init           = mriStep_Init;
   ark_mem->step_fullrhs        = mriStep_FullRHS;
@@ -925,6 +926,25 @@ ARKRhsFn mriStep_GetImplicitRHS(void* arkode_mem)
 }
 
 
+/*---------------------------------------------------------------
+  mriStep_GetNonlinSol:
+
+  This routine returns the SUNNonlinearSolver object, NLS.
+  ---------------------------------------------------------------*/
+SUNNonlinearSolver mriStep_GetNonlinSol(void* arkode_mem)
+{
+  ARKodeMem ark_mem;
+  ARKodeMRIStepMem step_mem;
+  int retval;
+
+  /* access ARKodeMRIStepMem structure, and return NLS */
+  retval = mriStep_AccessStepMem(arkode_mem, "mriStep_GetNonlinSol",
+                                 &ark_mem, &step_mem);
+  if (retval != ARK_SUCCESS)  return(NULL);
+  return(step_mem->NLS);
+}
+
+
 /*---------------------------------------------------------------
   mriStep_GetGammas:
 
@@ -198,6 +198,7 @@ void mriStep_DisableLSetup(void* arkode_mem);
 int mriStep_Init(void* arkode_mem, int init_type);
 void* mriStep_GetLmem(void* arkode_mem);
 ARKRhsFn mriStep_GetImplicitRHS(void* arkode_mem);
+SUNNonlinearSolver mriStep_GetNonlinSol(void* arkode_mem);
 int mriStep_GetGammas(void* arkode_mem, realtype *gamma,
                       realtype *gamrat, booleantype **jcur,
                       booleantype *dgamma_fail);
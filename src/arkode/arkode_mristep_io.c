@@ -80,6 +80,8 @@ int MRIStepSetLinearSolutionScaling(void *arkode_mem, booleantype onoff) {
   return(arkLSSetLinearSolutionScaling(arkode_mem, onoff)); }
 int MRIStepSetEpsLin(void *arkode_mem, realtype eplifac) {
   return(arkLSSetEpsLin(arkode_mem, eplifac)); }
+int MRIStepSetEpsLinMax(void *arkode_mem, realtype eplmax) {
+  return(arkLSSetEpsLinMax(arkode_mem, eplmax)); }
 int MRIStepSetLSNormFactor(void *arkode_mem, realtype nrmfac) {
   return(arkLSSetNormFactor(arkode_mem, nrmfac)); }
 int MRIStepSetPreconditioner(void *arkode_mem, ARKLsPrecSetupFn psetup,
@@ -25,6 +25,7 @@
 #include <string.h>
 
 #include "cvode_impl.h"
+#include "cvode_ls_impl.h"
 #include <sundials/sundials_types.h>
 #include <sunnonlinsol/sunnonlinsol_newton.h>
 
@@ -87,6 +88,14 @@
 #define CV_SV  2
 #define CV_WF  3
 
+/*
+ * Control constants for integrator state buffers
+ * ----------------------------------------------
+ */
+
+#define CV_STATE_MAGIC   0x43565354  /* "CVST" */
+#define CV_STATE_VERSION 1
+
 /*
  * Algorithmic constants
  * ---------------------
@@ -106,6 +115,11 @@
  *
  *   CORTES       constant in nonlinear iteration convergence test
  *
+ * CVodeGetDkyMany
+ *
+ *   DKY_BLOCK    number of vector entries interpolated to all output
+ *                times before moving on to the next entries
+ *
  */
 
 #define FUZZ_FACTOR RCONST(100.0)
@@ -117,6 +131,8 @@
 
 #define CORTES RCONST(0.1)
 
+#define DKY_BLOCK 1024
+
 /*=================================================================*/
 /* Private Helper Functions Prototypes                             */
 /*=================================================================*/
@@ -153,6 +169,18 @@ int cvEwtSetSV_fused(const booleantype atolmin0,
                      N_Vector weight);
 #endif
 
+/* Dense output */
+
+static int cvCheckDkyTime(CVodeMem cv_mem, realtype t, const char *fname);
+static booleantype cvDkyHostVectors(CVodeMem cv_mem, int nt, N_Vector *dky);
+
+/* Integrator state serialization */
+
+static void cvStateHeader(CVodeMem cv_mem, CVStateHeader *hdr);
+static int cvStateVecLen(CVodeMem cv_mem, sunindextype *vlen);
+static void cvStateScalars(CVodeMem cv_mem, const CVStateHeader *hdr,
+                           char *buf, booleantype pack, long int *len);
+
 /* Initial stepsize calculation */
 
 static int cvHin(CVodeMem cv_mem, realtype tout);
@@ -519,6 +547,7 @@ int CVodeInit(void *cvode_mem, CVRhsFn f, realtype t0, N_Vector y0)
   cv_mem->cv_nsetups = 0;
   cv_mem->cv_nhnil   = 0;
   cv_mem->cv_nstlp   = 0;
+  cv_mem->cv_forceSetup = SUNFALSE;
   cv_mem->cv_nscon   = 0;
   cv_mem->cv_nge     = 0;
 
@@ -625,6 +654,7 @@ int CVodeReInit(void *cvode_mem, realtype t0, N_Vector y0)
   cv_mem->cv_nsetups = 0;
   cv_mem->cv_nhnil   = 0;
   cv_mem->cv_nstlp   = 0;
+  cv_mem->cv_forceSetup = SUNFALSE;
   cv_mem->cv_nscon   = 0;
   cv_mem->cv_nge     = 0;
 
@@ -1499,7 +1529,6 @@ int CVode(void *cvode_mem, realtype tout, N_Vector yout,
 int CVodeGetDky(void *cvode_mem, realtype t, int k, N_Vector dky)
 {
   realtype s, r;
-  realtype tfuzz, tp, tn1;
   int i, j, nvec, ier;
   CVodeMem cv_mem;
 
@@ -1525,15 +1554,7 @@ int CVodeGetDky(void *cvode_mem, realtype t, int k, N_Vector dky)
     return(CV_BAD_K);
   }
 
-  /* Allow for some slack */
-  tfuzz = FUZZ_FACTOR * cv_mem->cv_uround *
-    (SUNRabs(cv_mem->cv_tn) + SUNRabs(cv_mem->cv_hu));
-  if (cv_mem->cv_hu < ZERO) tfuzz = -tfuzz;
-  tp = cv_mem->cv_tn - cv_mem->cv_hu - tfuzz;
-  tn1 = cv_mem->cv_tn + tfuzz;
-  if ((t-tp)*(t-tn1) > ZERO) {
-    cvProcessError(cv_mem, CV_BAD_T, "CVODE", "CVodeGetDky", MSGCV_BAD_T,
-                   t, cv_mem->cv_tn-cv_mem->cv_hu, cv_mem->cv_tn);
+  if (cvCheckDkyTime(cv_mem, t, "CVodeGetDky") != CV_SUCCESS) {
     SUNDIALS_MARK_FUNCTION_END(CV_PROFILER);
     return(CV_BAD_T);
   }
@@ -1568,6 +1589,590 @@ int CVodeGetDky(void *cvode_mem, realtype t, int k, N_Vector dky)
   return(CV_SUCCESS);
 }
 
+/*
+ * CVodeGetDkyMany
+ *
+ * This routine computes the k-th derivative of the interpolating
+ * polynomial at each of the nt times t[m] and stores the results in
+ * the vectors dky[m], using the same formula as CVodeGetDky. The
+ * inputs are checked once for all times.
+ *
+ * For serial vectors the polynomial is evaluated with Horner's rule in
+ * a single pass over zn, one block of DKY_BLOCK entries at a time, so
+ * each entry of zn is loaded once regardless of nt. For other vectors,
+ * including the threaded OpenMP and Pthreads vectors whose vector
+ * operations would otherwise be replaced by a single-threaded loop,
+ * each output is a separate N_VLinearCombination over zn.
+ */
+
+int CVodeGetDkyMany(void *cvode_mem, int nt, realtype *t, int k,
+                    N_Vector *dky)
+{
+  realtype s, r, c;
+  realtype fac[L_MAX];
+  realtype *zd[L_MAX], *dd;
+  sunindextype i, i0, i1, N;
+  int j, m, q, nvec, ier;
+  CVodeMem cv_mem;
+
+  /* Check all inputs for legality */
+
+  if (cvode_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODE", "CVodeGetDkyMany",
+                   MSGCV_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+  cv_mem = (CVodeMem) cvode_mem;
+
+  SUNDIALS_MARK_FUNCTION_BEGIN(CV_PROFILER);
+
+  if (nt < 0) {
+    cvProcessError(cv_mem, CV_ILL_INPUT, "CVODE", "CVodeGetDkyMany",
+                   MSGCV_BAD_NT);
+    SUNDIALS_MARK_FUNCTION_END(CV_PROFILER);
+    return(CV_ILL_INPUT);
+  }
+
+  if (nt == 0) {
+    SUNDIALS_MARK_FUNCTION_END(CV_PROFILER);
+    return(CV_SUCCESS);
+  }
+
+  if (t == NULL) {
+    cvProcessError(cv_mem, CV_ILL_INPUT, "CVODE", "CVodeGetDkyMany",
+                   MSGCV_NULL_TDKY);
+    SUNDIALS_MARK_FUNCTION_END(CV_PROFILER);
+    return(CV_ILL_INPUT);
+  }
+
+  if (dky == NULL) {
+    cvProcessError(cv_mem, CV_BAD_DKY, "CVODE", "CVodeGetDkyMany",
+                   MSGCV_NULL_DKY);
+    SUNDIALS_MARK_FUNCTION_END(CV_PROFILER);
+    return(CV_BAD_DKY);
+  }
+  for (m = 0; m < nt; m++) {
+    if (dky[m] == NULL) {
+      cvProcessError(cv_mem, CV_BAD_DKY, "CVODE", "CVodeGetDkyMany",
+                     MSGCV_NULL_DKY);
+      SUNDIALS_MARK_FUNCTION_END(CV_PROFILER);
+      return(CV_BAD_DKY);
+    }
+  }
+
+  q = cv_mem->cv_q;
+  if ((k < 0) || (k > q)) {
+    cvProcessError(cv_mem, CV_BAD_K, "CVODE", "CVodeGetDkyMany", MSGCV_BAD_K);
+    SUNDIALS_MARK_FUNCTION_END(CV_PROFILER);
+    return(CV_BAD_K);
+  }
+
+  for (m = 0; m < nt; m++) {
+    if (cvCheckDkyTime(cv_mem, t[m], "CVodeGetDkyMany") != CV_SUCCESS) {
+      SUNDIALS_MARK_FUNCTION_END(CV_PROFILER);
+      return(CV_BAD_T);
+    }
+  }
+
+  /* fac[j] = c(j,k) * h^(-k) multiplies zn[j] in the sum */
+
+  r = (k == 0) ? ONE : SUNRpowerI(cv_mem->cv_h, -k);
+  for (j = k; j <= q; j++) {
+    c = ONE;
+    for (i = j; i >= j-k+1; i--)
+      c *= i;
+    fac[j] = c * r;
+  }
+
+  if (cvDkyHostVectors(cv_mem, nt, dky)) {
+
+    N = N_VGetLength(cv_mem->cv_zn[0]);
+    for (j = k; j <= q; j++)
+      zd[j] = N_VGetArrayPointer(cv_mem->cv_zn[j]);
+
+    for (i0 = 0; i0 < N; i0 += DKY_BLOCK) {
+      i1 = SUNMIN(i0 + DKY_BLOCK, N);
+      for (m = 0; m < nt; m++) {
+        s  = (t[m] - cv_mem->cv_tn) / cv_mem->cv_h;
+        dd = N_VGetArrayPointer(dky[m]);
+        for (i = i0; i < i1; i++)
+          dd[i] = fac[q] * zd[q][i];
+        for (j = q-1; j >= k; j--)
+          for (i = i0; i < i1; i++)
+            dd[i] = dd[i] * s + fac[j] * zd[j][i];
+      }
+    }
+
+  } else {
+
+    for (m = 0; m < nt; m++) {
+      s = (t[m] - cv_mem->cv_tn) / cv_mem->cv_h;
+      nvec = 0;
+      c = ONE;
+      for (j = k; j <= q; j++) {
+        cv_mem->cv_cvals[nvec] = fac[j] * c;
+        cv_mem->cv_Xvecs[nvec] = cv_mem->cv_zn[j];
+        c *= s;
+        nvec += 1;
+      }
+      ier = N_VLinearCombination(nvec, cv_mem->cv_cvals, cv_mem->cv_Xvecs,
+                                 dky[m]);
+      if (ier != CV_SUCCESS) {
+        SUNDIALS_MARK_FUNCTION_END(CV_PROFILER);
+        return(CV_VECTOROP_ERR);
+      }
+    }
+
+  }
+
+  SUNDIALS_MARK_FUNCTION_END(CV_PROFILER);
+  return(CV_SUCCESS);
+}
+
+/*
+ * cvCheckDkyTime
+ *
+ * This routine checks that t lies within the last step, allowing for
+ * some slack, and reports an error from fname if it does not.
+ */
+
+static int cvCheckDkyTime(CVodeMem cv_mem, realtype t, const char *fname)
+{
+  realtype tfuzz, tp, tn1;
+
+  tfuzz = FUZZ_FACTOR * cv_mem->cv_uround *
+    (SUNRabs(cv_mem->cv_tn) + SUNRabs(cv_mem->cv_hu));
+  if (cv_mem->cv_hu < ZERO) tfuzz = -tfuzz;
+  tp = cv_mem->cv_tn - cv_mem->cv_hu - tfuzz;
+  tn1 = cv_mem->cv_tn + tfuzz;
+  if ((t-tp)*(t-tn1) > ZERO) {
+    cvProcessError(cv_mem, CV_BAD_T, "CVODE", fname, MSGCV_BAD_T,
+                   t, cv_mem->cv_tn-cv_mem->cv_hu, cv_mem->cv_tn);
+    return(CV_BAD_T);
+  }
+
+  return(CV_SUCCESS);
+}
+
+/*
+ * cvDkyHostVectors
+ *
+ * This routine returns SUNTRUE if zn and all of the output vectors
+ * are serial vectors of the same length that CVodeGetDkyMany can
+ * access directly.
+ */
+
+static booleantype cvDkyHostVectors(CVodeMem cv_mem, int nt, N_Vector *dky)
+{
+  sunindextype N;
+  int m;
+
+  if (N_VGetVectorID(cv_mem->cv_zn[0]) != SUNDIALS_NVEC_SERIAL)
+    return(SUNFALSE);
+
+  N = N_VGetLength(cv_mem->cv_zn[0]);
+  for (m = 0; m < nt; m++) {
+    if (N_VGetVectorID(dky[m]) != N_VGetVectorID(cv_mem->cv_zn[0]))
+      return(SUNFALSE);
+    if (N_VGetLength(dky[m]) != N) return(SUNFALSE);
+  }
+
+  return(SUNTRUE);
+}
+
+/*
+ * -----------------------------------------------------------------
+ * Integrator state serialization
+ * -----------------------------------------------------------------
+ */
+
+/*
+ * CVodeGetStateBufSize
+ *
+ * This routine returns the number of bytes CVodeWriteState needs to
+ * store the current integrator state.
+ */
+
+int CVodeGetStateBufSize(void *cvode_mem, long int *size)
+{
+  CVodeMem cv_mem;
+  CVStateHeader hdr;
+  long int len;
+
+  if (cvode_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODE", "CVodeGetStateBufSize",
+                   MSGCV_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+  cv_mem = (CVodeMem) cvode_mem;
+
+  if (cvStateVecLen(cv_mem, NULL) != CV_SUCCESS) {
+    cvProcessError(cv_mem, CV_ILL_INPUT, "CVODE", "CVodeGetStateBufSize",
+                   MSGCV_BAD_NVECTOR);
+    return(CV_ILL_INPUT);
+  }
+
+  cvStateHeader(cv_mem, &hdr);
+  len = (long int) sizeof(CVStateHeader);
+  cvStateScalars(cv_mem, &hdr, NULL, SUNTRUE, &len);
+  *size = len + hdr.nvec * (long int) hdr.vlen;
+
+  return(CV_SUCCESS);
+}
+
+/*
+ * CVodeWriteState
+ *
+ * This routine packs the integrator state after the last successful
+ * step into buf, which must hold at least the number of bytes given
+ * by CVodeGetStateBufSize. The buffer contains a header identifying
+ * the problem configuration, the step data and counters, and the
+ * vectors zn[j], j = 0,...,q, and zn[qmax] (if q < qmax) packed with
+ * N_VBufPack.
+ */
+
+int CVodeWriteState(void *cvode_mem, void *buf)
+{
+  CVodeMem cv_mem;
+  CVStateHeader hdr;
+  char *cbuf;
+  long int len;
+  int j, retval;
+
+  if (cvode_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODE", "CVodeWriteState",
+                   MSGCV_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+  cv_mem = (CVodeMem) cvode_mem;
+
+  if (buf == NULL) {
+    cvProcessError(cv_mem, CV_ILL_INPUT, "CVODE", "CVodeWriteState",
+                   MSGCV_NULL_BUF);
+    return(CV_ILL_INPUT);
+  }
+
+  if (cv_mem->cv_nst == 0) {
+    cvProcessError(cv_mem, CV_ILL_INPUT, "CVODE", "CVodeWriteState",
+                   MSGCV_STATE_NO_STEP);
+    return(CV_ILL_INPUT);
+  }
+
+  if (cvStateVecLen(cv_mem, NULL) != CV_SUCCESS) {
+    cvProcessError(cv_mem, CV_ILL_INPUT, "CVODE", "CVodeWriteState",
+                   MSGCV_BAD_NVECTOR);
+    return(CV_ILL_INPUT);
+  }
+
+  cbuf = (char*) buf;
+
+  cvStateHeader(cv_mem, &hdr);
+  memcpy(cbuf, &hdr, sizeof(CVStateHeader));
+  len = (long int) sizeof(CVStateHeader);
+  cvStateScalars(cv_mem, &hdr, cbuf, SUNTRUE, &len);
+
+  retval = 0;
+  for (j = 0; j <= hdr.q; j++) {
+    retval += N_VBufPack(cv_mem->cv_zn[j], cbuf + len);
+    len += (long int) hdr.vlen;
+  }
+  if (hdr.q < hdr.qmax)
+    retval += N_VBufPack(cv_mem->cv_zn[hdr.qmax], cbuf + len);
+
+  if (retval != 0) {
+    cvProcessError(cv_mem, CV_VECTOROP_ERR, "CVODE", "CVodeWriteState",
+                   MSGCV_BAD_NVECTOR);
+    return(CV_VECTOROP_ERR);
+  }
+
+  return(CV_SUCCESS);
+}
+
+/*
+ * CVodeReadState
+ *
+ * This routine restores an integrator state written by
+ * CVodeWriteState. The integrator must have been initialized with
+ * CVodeInit for a problem of the same size and configured with the
+ * same linear multistep method, maximum order, number of root
+ * functions, and kind of linear solver interface as the integrator
+ * that wrote the state. The input checks done at the first call to
+ * CVode are performed here, and the linear solver setup and Jacobian
+ * evaluation are forced on the next step since the matrix data of the
+ * writer are not part of the state.
+ */
+
+int CVodeReadState(void *cvode_mem, void *buf)
+{
+  CVodeMem cv_mem;
+  CVLsMem cvls_mem;
+  CVStateHeader hdr, ref;
+  char *cbuf;
+  long int len, nje, nfeDQ, nstlj, npe, nli, nps, ncfl, njtsetup, njtimes;
+  realtype tnlj;
+  int j, retval;
+
+  if (cvode_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODE", "CVodeReadState",
+                   MSGCV_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+  cv_mem = (CVodeMem) cvode_mem;
+
+  if (cv_mem->cv_MallocDone == SUNFALSE) {
+    cvProcessError(cv_mem, CV_NO_MALLOC, "CVODE", "CVodeReadState",
+                   MSGCV_NO_MALLOC);
+    return(CV_NO_MALLOC);
+  }
+
+  if (buf == NULL) {
+    cvProcessError(cv_mem, CV_ILL_INPUT, "CVODE", "CVodeReadState",
+                   MSGCV_NULL_BUF);
+    return(CV_ILL_INPUT);
+  }
+
+  if (cvStateVecLen(cv_mem, NULL) != CV_SUCCESS) {
+    cvProcessError(cv_mem, CV_ILL_INPUT, "CVODE", "CVodeReadState",
+                   MSGCV_BAD_NVECTOR);
+    return(CV_ILL_INPUT);
+  }
+
+  /* Check that the buffer matches this integrator */
+
+  cbuf = (char*) buf;
+  memcpy(&hdr, cbuf, sizeof(CVStateHeader));
+  cvStateHeader(cv_mem, &ref);
+
+  if ( (hdr.magic != CV_STATE_MAGIC) || (hdr.version != CV_STATE_VERSION) ||
+       (hdr.realsize != ref.realsize) || (hdr.lmm != ref.lmm) ||
+       (hdr.qmax != ref.qmax) || (hdr.nrtfn != ref.nrtfn) ||
+       (hdr.lsdata != ref.lsdata) || (hdr.vlen != ref.vlen) ||
+       (hdr.q < 1) || (hdr.q > hdr.qmax) ) {
+    cvProcessError(cv_mem, CV_ILL_INPUT, "CVODE", "CVodeReadState",
+                   MSGCV_STATE_BAD_BUF);
+    return(CV_ILL_INPUT);
+  }
+
+  /* Restore the step data, counters, and history array */
+
+  len = (long int) sizeof(CVStateHeader);
+  cvStateScalars(cv_mem, &hdr, cbuf, SUNFALSE, &len);
+
+  retval = 0;
+  for (j = 0; j <= hdr.q; j++) {
+    retval += N_VBufUnpack(cv_mem->cv_zn[j], cbuf + len);
+    len += (long int) hdr.vlen;
+  }
+  if (hdr.q < hdr.qmax)
+    retval += N_VBufUnpack(cv_mem->cv_zn[hdr.qmax], cbuf + len);
+
+  if (retval != 0) {
+    cvProcessError(cv_mem, CV_VECTOROP_ERR, "CVODE", "CVodeReadState",
+                   MSGCV_BAD_NVECTOR);
+    return(CV_VECTOROP_ERR);
+  }
+
+  /* The linear solver initialization resets its counters, so save the
+     restored values and put them back afterwards */
+
+  cvls_mem = (hdr.lsdata) ? (CVLsMem) cv_mem->cv_lmem : NULL;
+  if (cvls_mem != NULL) {
+    nje      = cvls_mem->nje;
+    nfeDQ    = cvls_mem->nfeDQ;
+    nstlj    = cvls_mem->nstlj;
+    npe      = cvls_mem->npe;
+    nli      = cvls_mem->nli;
+    nps      = cvls_mem->nps;
+    ncfl     = cvls_mem->ncfl;
+    njtsetup = cvls_mem->njtsetup;
+    njtimes  = cvls_mem->njtimes;
+    tnlj     = cvls_mem->tnlj;
+  }
+
+  retval = cvInitialSetup(cv_mem);
+  if (retval != CV_SUCCESS) return(retval);
+
+  if (cvls_mem != NULL) {
+    cvls_mem->nje      = nje;
+    cvls_mem->nfeDQ    = nfeDQ;
+    cvls_mem->nstlj    = nstlj;
+    cvls_mem->npe      = npe;
+    cvls_mem->nli      = nli;
+    cvls_mem->nps      = nps;
+    cvls_mem->ncfl     = ncfl;
+    cvls_mem->njtsetup = njtsetup;
+    cvls_mem->njtimes  = njtimes;
+    cvls_mem->tnlj     = tnlj;
+  }
+
+  cv_mem->cv_jcur       = SUNFALSE;
+  cv_mem->cv_forceSetup = SUNTRUE;
+
+  return(CV_SUCCESS);
+}
+
+/*
+ * cvStateHeader
+ *
+ * This routine fills the header describing the current integrator
+ * configuration and order.
+ */
+
+static void cvStateHeader(CVodeMem cv_mem, CVStateHeader *hdr)
+{
+  memset(hdr, 0, sizeof(CVStateHeader));
+  hdr->magic    = CV_STATE_MAGIC;
+  hdr->version  = CV_STATE_VERSION;
+  hdr->realsize = (int) sizeof(realtype);
+  hdr->lmm      = cv_mem->cv_lmm;
+  hdr->qmax     = cv_mem->cv_qmax;
+  hdr->q        = cv_mem->cv_q;
+  hdr->nrtfn    = cv_mem->cv_nrtfn;
+  hdr->lsdata   = (cv_mem->cv_linit == cvLsInitialize);
+  hdr->nvec     = cv_mem->cv_q + ((cv_mem->cv_q < cv_mem->cv_qmax) ? 2 : 1);
+  (void) cvStateVecLen(cv_mem, &(hdr->vlen));
+}
+
+/*
+ * cvStateVecLen
+ *
+ * This routine checks that the vectors support the buffer operations
+ * and, if vlen is not NULL, returns the packed size of one vector
+ * rounded up to a multiple of the size of realtype.
+ */
+
+static int cvStateVecLen(CVodeMem cv_mem, sunindextype *vlen)
+{
+  N_Vector v = cv_mem->cv_tempv;
+  sunindextype rs = (sunindextype) sizeof(realtype);
+  sunindextype size;
+
+  if ( (v->ops->nvbufsize == NULL) || (v->ops->nvbufpack == NULL) ||
+       (v->ops->nvbufunpack == NULL) )
+    return(CV_ILL_INPUT);
+
+  if (vlen == NULL) return(CV_SUCCESS);
+
+  if (N_VBufSize(v, &size) != 0) return(CV_ILL_INPUT);
+  *vlen = ((size + rs - 1) / rs) * rs;
+
+  return(CV_SUCCESS);
+}
+
+/*
+ * cvStateScalars
+ *
+ * This routine packs (pack = SUNTRUE) the step data, counters,
+ * stability limit detection data, rootfinding data, and CVLS counters
+ * into buf starting at byte *len, or unpacks them from buf. If buf is
+ * NULL only the size is computed. On return, *len is the offset of the
+ * first vector, rounded up to a multiple of the size of realtype.
+ */
+
+#define CV_STATE_ITEMS(x, n)                                    \
+  {                                                             \
+    if (buf != NULL) {                                          \
+      if (pack) memcpy(buf + *len, (x), (n) * sizeof(*(x)));    \
+      else      memcpy((x), buf + *len, (n) * sizeof(*(x)));    \
+    }                                                           \
+    *len += (long int) ((n) * sizeof(*(x)));                    \
+  }
+
+#define CV_STATE_ITEM(x) CV_STATE_ITEMS(&(x), 1)
+
+static void cvStateScalars(CVodeMem cv_mem, const CVStateHeader *hdr,
+                           char *buf, booleantype pack, long int *len)
+{
+  CVLsMem cvls_mem;
+  long int rs = (long int) sizeof(realtype);
+
+  /* Step data */
+  CV_STATE_ITEM(cv_mem->cv_q);
+  CV_STATE_ITEM(cv_mem->cv_qprime);
+  CV_STATE_ITEM(cv_mem->cv_next_q);
+  CV_STATE_ITEM(cv_mem->cv_qwait);
+  CV_STATE_ITEM(cv_mem->cv_L);
+  CV_STATE_ITEM(cv_mem->cv_qu);
+  CV_STATE_ITEM(cv_mem->cv_indx_acor);
+  CV_STATE_ITEM(cv_mem->cv_acnrmcur);
+
+  CV_STATE_ITEM(cv_mem->cv_tn);
+  CV_STATE_ITEM(cv_mem->cv_tretlast);
+  CV_STATE_ITEM(cv_mem->cv_h);
+  CV_STATE_ITEM(cv_mem->cv_hprime);
+  CV_STATE_ITEM(cv_mem->cv_next_h);
+  CV_STATE_ITEM(cv_mem->cv_eta);
+  CV_STATE_ITEM(cv_mem->cv_hscale);
+  CV_STATE_ITEM(cv_mem->cv_hu);
+  CV_STATE_ITEM(cv_mem->cv_h0u);
+  CV_STATE_ITEM(cv_mem->cv_etamax);
+  CV_STATE_ITEM(cv_mem->cv_etaqm1);
+  CV_STATE_ITEM(cv_mem->cv_etaq);
+  CV_STATE_ITEM(cv_mem->cv_etaqp1);
+  CV_STATE_ITEMS(cv_mem->cv_tau, L_MAX+1);
+  CV_STATE_ITEMS(cv_mem->cv_tq, NUM_TESTS+1);
+  CV_STATE_ITEMS(cv_mem->cv_l, L_MAX);
+  CV_STATE_ITEM(cv_mem->cv_rl1);
+  CV_STATE_ITEM(cv_mem->cv_gamma);
+  CV_STATE_ITEM(cv_mem->cv_gammap);
+  CV_STATE_ITEM(cv_mem->cv_gamrat);
+  CV_STATE_ITEM(cv_mem->cv_crate);
+  CV_STATE_ITEM(cv_mem->cv_delp);
+  CV_STATE_ITEM(cv_mem->cv_acnrm);
+  CV_STATE_ITEM(cv_mem->cv_saved_tq5);
+  CV_STATE_ITEM(cv_mem->cv_tolsf);
+
+  /* Counters */
+  CV_STATE_ITEM(cv_mem->cv_nst);
+  CV_STATE_ITEM(cv_mem->cv_nfe);
+  CV_STATE_ITEM(cv_mem->cv_ncfn);
+  CV_STATE_ITEM(cv_mem->cv_nni);
+  CV_STATE_ITEM(cv_mem->cv_nnf);
+  CV_STATE_ITEM(cv_mem->cv_netf);
+  CV_STATE_ITEM(cv_mem->cv_nsetups);
+  CV_STATE_ITEM(cv_mem->cv_nstlp);
+  CV_STATE_ITEM(cv_mem->cv_nhnil);
+
+  /* Stability limit detection */
+  CV_STATE_ITEMS(&(cv_mem->cv_ssdat[0][0]), 24);
+  CV_STATE_ITEM(cv_mem->cv_nscon);
+  CV_STATE_ITEM(cv_mem->cv_nor);
+
+  /* Rootfinding */
+  if (hdr->nrtfn > 0) {
+    CV_STATE_ITEM(cv_mem->cv_tlo);
+    CV_STATE_ITEM(cv_mem->cv_thi);
+    CV_STATE_ITEM(cv_mem->cv_trout);
+    CV_STATE_ITEM(cv_mem->cv_toutc);
+    CV_STATE_ITEM(cv_mem->cv_taskc);
+    CV_STATE_ITEM(cv_mem->cv_irfnd);
+    CV_STATE_ITEM(cv_mem->cv_nge);
+    CV_STATE_ITEMS(cv_mem->cv_glo, hdr->nrtfn);
+    CV_STATE_ITEMS(cv_mem->cv_ghi, hdr->nrtfn);
+    CV_STATE_ITEMS(cv_mem->cv_grout, hdr->nrtfn);
+    CV_STATE_ITEMS(cv_mem->cv_iroots, hdr->nrtfn);
+    CV_STATE_ITEMS(cv_mem->cv_gactive, hdr->nrtfn);
+  }
+
+  /* Linear solver interface counters and Jacobian age */
+  if (hdr->lsdata) {
+    cvls_mem = (CVLsMem) cv_mem->cv_lmem;
+    CV_STATE_ITEM(cvls_mem->nje);
+    CV_STATE_ITEM(cvls_mem->nfeDQ);
+    CV_STATE_ITEM(cvls_mem->nstlj);
+    CV_STATE_ITEM(cvls_mem->npe);
+    CV_STATE_ITEM(cvls_mem->nli);
+    CV_STATE_ITEM(cvls_mem->nps);
+    CV_STATE_ITEM(cvls_mem->ncfl);
+    CV_STATE_ITEM(cvls_mem->njtsetup);
+    CV_STATE_ITEM(cvls_mem->njtimes);
+    CV_STATE_ITEM(cvls_mem->tnlj);
+  }
+
+  /* Align the vector data */
+  *len = ((*len + rs - 1) / rs) * rs;
+}
+
 /*
  * CVodeComputeState
  *
@@ -2804,10 +3409,14 @@ static int cvNls(CVodeMem cv_mem, int nflag)
     cv_mem->convfail = ((nflag == FIRST_CALL) || (nflag == PREV_ERR_FAIL)) ?
       CV_NO_FAILURES : CV_FAIL_OTHER;
 
+    /* After CVodeReadState the linear solver data must be recomputed */
+    if (cv_mem->cv_forceSetup) cv_mem->convfail = CV_FAIL_OTHER;
+
     callSetup = (nflag == PREV_CONV_FAIL) || (nflag == PREV_ERR_FAIL) ||
       (cv_mem->cv_nst == 0) ||
       (cv_mem->cv_nst >= cv_mem->cv_nstlp + cv_mem->cv_msbp) ||
-      (SUNRabs(cv_mem->cv_gamrat-ONE) > cv_mem->cv_dgmax_lsetup);
+      (SUNRabs(cv_mem->cv_gamrat-ONE) > cv_mem->cv_dgmax_lsetup) ||
+      cv_mem->cv_forceSetup;
   } else {
     cv_mem->cv_crate = ONE;
     callSetup = SUNFALSE;
@@ -0,0 +1,1974 @@
+/* -----------------------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------------------
+ * This is the implementation file for the batched CVODE integrator.
+ *
+ * All systems in the active batch attempt one BDF step at a time in lockstep.
+ * The step size, order, and error control of every system follow cvStep in
+ * cvode.c, while right-hand side and Jacobian evaluations, the linear solver
+ * setup, and each Newton iteration are performed for the whole batch at once.
+ * The Newton matrices of all systems are stored interleaved so the LU
+ * factorization and solves vectorize across systems; when compiled with
+ * OpenMP the systems are split into contiguous ranges, one per thread.
+ * Systems that reach the output time or fail are swapped to the end of the
+ * slot arrays and drop out of the active batch.
+ * ---------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <sundials/sundials_math.h>
+#include <sundials/sundials_nonlinearsolver.h>
+
+#include "cvode_impl.h"
+#include "cvode_ls_impl.h"
+#include "cvode_batch_impl.h"
+#include "sundials_dense_impl.h"
+
+/* Private constants */
+
+#define ZERO    RCONST(0.0)
+#define POINT2  RCONST(0.2)
+#define HALF    RCONST(0.5)
+#define ONE     RCONST(1.0)
+#define TWO     RCONST(2.0)
+
+/* Initial step size selection constants, see cvHin in cvode.c */
+
+#define HLB_FACTOR RCONST(100.0)
+#define HUB_FACTOR RCONST(0.1)
+#define H_BIAS     HALF
+#define MAX_ITERS  4
+
+/* Fuzz factor used to estimate infinitesimal time intervals */
+
+#define FUZZ_FACTOR RCONST(100.0)
+
+/* Newton iteration constants, see cvode_nls.c and cvode_ls.c */
+
+#define CRDOWN       RCONST(0.3)
+#define RDIV         TWO
+#define MIN_INC_MULT RCONST(1000.0)
+
+/* Error messages */
+
+#define MSGCVB_NO_MEM    "cvb_mem = NULL illegal."
+#define MSGCVB_NO_MALLOC "Attempt to call before CVodeBatchInit."
+#define MSGCVB_MEM_FAIL  "A memory request failed."
+#define MSGCVB_BAD_NVEC  "The vector must provide an array of length nsys*n."
+#define MSGCVB_SYS_FAIL  "At least one system failed, see CVodeBatchGetSystemFlags."
+
+/* Slot access macros */
+
+#define SYS(k)     (&(cvb_mem->sys[k]))
+#define ZN(j,k)    (cvb_mem->zn[j] + (k) * cvb_mem->n)
+#define BLK(v,k)   ((v) + (k) * cvb_mem->n)
+
+/* Private function prototypes */
+
+static int cvbCheckVector(CVodeBatchMem cvb_mem, N_Vector v, const char *fname);
+static void cvbSlotRange(int nslots, int *k0, int *k1);
+static realtype cvbWrmsNorm(sunindextype n, realtype *x, realtype *w);
+static int cvbEwtSet(CVodeBatchMem cvb_mem, int k);
+static int cvbRhs(CVodeBatchMem cvb_mem, booleantype at_tn, realtype *y,
+                  realtype *ydot);
+
+static int cvbInitialStep(CVodeBatchMem cvb_mem, realtype tout);
+static int cvbHin(CVodeBatchMem cvb_mem, realtype tout);
+
+static void cvbBeginAttempt(CVodeBatchMem cvb_mem, int k);
+static void cvbFinishAttempt(CVodeBatchMem cvb_mem, int k, realtype tout);
+static void cvbAdjustOrder(CVodeBatchMem cvb_mem, int k, int deltaq);
+static void cvbIncreaseBDF(CVodeBatchMem cvb_mem, int k);
+static void cvbDecreaseBDF(CVodeBatchMem cvb_mem, int k);
+static void cvbRescale(CVodeBatchMem cvb_mem, int k);
+static void cvbPredict(CVodeBatchMem cvb_mem, int k);
+static void cvbRestore(CVodeBatchMem cvb_mem, int k);
+static void cvbSetBDF(CVodeBatchMem cvb_mem, int k);
+static void cvbCompleteStep(CVodeBatchMem cvb_mem, int k);
+static void cvbPrepareNextStep(CVodeBatchMem cvb_mem, int k, realtype dsm);
+static void cvbSetEta(CVodeBatchMem cvb_mem, int k);
+
+static int cvbNls(CVodeBatchMem cvb_mem);
+static int cvbSetup(CVodeBatchMem cvb_mem, booleantype jbad);
+static int cvbDQJac(CVodeBatchMem cvb_mem);
+static void cvbFactor(CVodeBatchMem cvb_mem);
+static void cvbSolve(CVodeBatchMem cvb_mem, realtype *x);
+
+static int cvbReload(CVodeBatchMem cvb_mem);
+static void cvbFailAll(CVodeBatchMem cvb_mem, int flag, booleantype restore);
+static void cvbGetY(CVodeBatchMem cvb_mem, int k, realtype t, realtype *yout);
+static void cvbCompact(CVodeBatchMem cvb_mem);
+static void cvbSwapSlots(CVodeBatchMem cvb_mem, int a, int b);
+static void cvbSwapBlocks(realtype *va, realtype *vb, sunindextype n);
+
+/*
+ * =================================================================
+ * EXPORTED FUNCTIONS IMPLEMENTATION
+ * =================================================================
+ */
+
+/*
+ * CVodeBatchCreate
+ *
+ * CVodeBatchCreate allocates the memory for an ensemble of nsys
+ * independent ODE systems of size n, including the interleaved
+ * Jacobian and Newton matrices. If a memory request fails, NULL is
+ * returned.
+ */
+
+void *CVodeBatchCreate(int nsys, sunindextype n, SUNContext sunctx)
+{
+  CVodeBatchMem cvb_mem;
+  sunindextype len;
+  int j, k;
+
+  if (sunctx == NULL) {
+    cvProcessError(NULL, 0, "CVODE", "CVodeBatchCreate", MSGCV_NULL_SUNCTX);
+    return(NULL);
+  }
+
+  if ((nsys < 1) || (n < 1)) {
+    cvProcessError(NULL, 0, "CVODE", "CVodeBatchCreate",
+                   "nsys and n must be positive.");
+    return(NULL);
+  }
+
+  cvb_mem = NULL;
+  cvb_mem = (CVodeBatchMem) calloc(1, sizeof(struct CVodeBatchMemRec));
+  if (cvb_mem == NULL) {
+    cvProcessError(NULL, 0, "CVODE", "CVodeBatchCreate", MSGCVB_MEM_FAIL);
+    return(NULL);
+  }
+
+  cvb_mem->sunctx    = sunctx;
+  cvb_mem->nsys      = nsys;
+  cvb_mem->n         = n;
+  cvb_mem->nactive   = 0;
+  cvb_mem->nthreads  = 1;
+  cvb_mem->qmax      = CVB_QMAX;
+  cvb_mem->mxstep    = MXSTEP_DEFAULT;
+  cvb_mem->firstcall = SUNTRUE;
+  cvb_mem->uround    = UNIT_ROUNDOFF;
+
+  len = n * nsys;
+
+  cvb_mem->sys    = (CVodeBatchSys) calloc(nsys, sizeof(struct CVodeBatchSysRec));
+  cvb_mem->slot   = (int *) malloc(nsys * sizeof(int));
+  cvb_mem->sysid  = (int *) malloc(nsys * sizeof(int));
+  cvb_mem->t      = (realtype *) malloc(nsys * sizeof(realtype));
+  cvb_mem->ewt    = (realtype *) malloc(len * sizeof(realtype));
+  cvb_mem->acor   = (realtype *) malloc(len * sizeof(realtype));
+  cvb_mem->y      = (realtype *) malloc(len * sizeof(realtype));
+  cvb_mem->ftemp  = (realtype *) malloc(len * sizeof(realtype));
+  cvb_mem->tempv  = (realtype *) malloc(len * sizeof(realtype));
+  cvb_mem->J      = (realtype *) malloc(n * len * sizeof(realtype));
+  cvb_mem->M      = (realtype *) malloc(n * len * sizeof(realtype));
+  cvb_mem->pivots = (sunindextype *) malloc(len * sizeof(sunindextype));
+  cvb_mem->lufail = (sunindextype *) malloc(nsys * sizeof(sunindextype));
+  cvb_mem->rhs    = (realtype *) malloc(len * sizeof(realtype));
+  cvb_mem->work   = (realtype *) malloc(2 * nsys * sizeof(realtype));
+  for (j = 0; j <= CVB_QMAX; j++)
+    cvb_mem->zn[j] = (realtype *) malloc(len * sizeof(realtype));
+
+  if ( (cvb_mem->sys == NULL) || (cvb_mem->slot == NULL) ||
+       (cvb_mem->sysid == NULL) || (cvb_mem->t == NULL) ||
+       (cvb_mem->ewt == NULL) || (cvb_mem->acor == NULL) ||
+       (cvb_mem->y == NULL) || (cvb_mem->ftemp == NULL) ||
+       (cvb_mem->tempv == NULL) || (cvb_mem->J == NULL) ||
+       (cvb_mem->M == NULL) || (cvb_mem->pivots == NULL) ||
+       (cvb_mem->lufail == NULL) || (cvb_mem->rhs == NULL) ||
+       (cvb_mem->work == NULL) ) {
+    cvProcessError(NULL, 0, "CVODE", "CVodeBatchCreate", MSGCVB_MEM_FAIL);
+    CVodeBatchFree((void**) &cvb_mem);
+    return(NULL);
+  }
+  for (j = 0; j <= CVB_QMAX; j++) {
+    if (cvb_mem->zn[j] == NULL) {
+      cvProcessError(NULL, 0, "CVODE", "CVodeBatchCreate", MSGCVB_MEM_FAIL);
+      CVodeBatchFree((void**) &cvb_mem);
+      return(NULL);
+    }
+  }
+
+  for (k = 0; k < nsys; k++) {
+    cvb_mem->sys[k].sysid = k;
+    cvb_mem->slot[k] = k;
+  }
+
+  return((void *) cvb_mem);
+}
+
+/*
+ * CVodeBatchInit
+ *
+ * CVodeBatchInit attaches the batched right-hand side function and
+ * sets the initial conditions of all systems. y0 holds the initial
+ * state of system s in entries s*n, ..., s*n+n-1.
+ */
+
+int CVodeBatchInit(void *cvb_mem, CVBatchRhsFn f, realtype t0, N_Vector y0)
+{
+  if (cvb_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODE", "CVodeBatchInit", MSGCVB_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+
+  if (f == NULL) {
+    cvProcessError(NULL, CV_ILL_INPUT, "CVODE", "CVodeBatchInit", MSGCV_NULL_F);
+    return(CV_ILL_INPUT);
+  }
+
+  ((CVodeBatchMem) cvb_mem)->f = f;
+
+  return(CVodeBatchReInit(cvb_mem, t0, y0));
+}
+
+/*
+ * CVodeBatchReInit
+ *
+ * CVodeBatchReInit restarts every system at t0 from the states in
+ * y0, resetting the order, step size, and all counters.
+ */
+
+int CVodeBatchReInit(void *cvode_batch_mem, realtype t0, N_Vector y0)
+{
+  CVodeBatchMem cvb_mem;
+  CVodeBatchSys sp;
+  realtype *y0data;
+  int i, k;
+
+  if (cvode_batch_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODE", "CVodeBatchReInit", MSGCVB_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+  cvb_mem = (CVodeBatchMem) cvode_batch_mem;
+
+  if (cvb_mem->f == NULL) {
+    cvProcessError(NULL, CV_NO_MALLOC, "CVODE", "CVodeBatchReInit",
+                   MSGCVB_NO_MALLOC);
+    return(CV_NO_MALLOC);
+  }
+
+  if (cvbCheckVector(cvb_mem, y0, "CVodeBatchReInit") != CV_SUCCESS)
+    return(CV_ILL_INPUT);
+  y0data = N_VGetArrayPointer(y0);
+
+  for (k = 0; k < cvb_mem->nsys; k++) {
+    sp = SYS(k);
+    memcpy(ZN(0,k), y0data + sp->sysid * cvb_mem->n,
+           cvb_mem->n * sizeof(realtype));
+
+    sp->tn        = t0;
+    sp->h         = ZERO;
+    sp->hprime    = ZERO;
+    sp->hscale    = ZERO;
+    sp->hu        = ZERO;
+    sp->eta       = ONE;
+    sp->etamax    = ETA_MAX_FS_DEFAULT;
+    sp->q         = 1;
+    sp->qprime    = 1;
+    sp->qu        = 0;
+    sp->L         = 2;
+    sp->qwait     = sp->L;
+    sp->indx_acor = cvb_mem->qmax;
+    for (i = 0; i <= CVB_QMAX+1; i++) sp->tau[i] = ZERO;
+    for (i = 0; i <= 5; i++) sp->tq[i] = ZERO;
+    for (i = 0; i <= CVB_QMAX; i++) sp->l[i] = ZERO;
+    sp->gammap    = ZERO;
+    sp->gamrat    = ONE;
+    sp->saved_tq5 = ZERO;
+    sp->crate     = ONE;
+    sp->jcur      = SUNFALSE;
+    sp->nstlp     = 0;
+    sp->nstlj     = 0;
+    sp->nflag     = FIRST_CALL;
+    sp->ncf       = 0;
+    sp->nef       = 0;
+    sp->flag      = CV_SUCCESS;
+    sp->reload    = SUNFALSE;
+    sp->nst       = 0;
+    sp->netf      = 0;
+    sp->nni       = 0;
+    sp->ncfn      = 0;
+  }
+
+  cvb_mem->nfe       = 0;
+  cvb_mem->nje       = 0;
+  cvb_mem->nsetups   = 0;
+  cvb_mem->firstcall = SUNTRUE;
+
+  return(CV_SUCCESS);
+}
+
+/*
+ * CVodeBatchSStolerances and CVodeBatchSVtolerances
+ *
+ * These functions specify the relative tolerance and a scalar or
+ * vector absolute tolerance shared by all systems. The vector abstol
+ * has length n.
+ */
+
+int CVodeBatchSStolerances(void *cvode_batch_mem, realtype reltol,
+                           realtype abstol)
+{
+  CVodeBatchMem cvb_mem;
+
+  if (cvode_batch_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODE", "CVodeBatchSStolerances",
+                   MSGCVB_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+  cvb_mem = (CVodeBatchMem) cvode_batch_mem;
+
+  if (reltol < ZERO) {
+    cvProcessError(NULL, CV_ILL_INPUT, "CVODE", "CVodeBatchSStolerances",
+                   MSGCV_BAD_RELTOL);
+    return(CV_ILL_INPUT);
+  }
+
+  if (abstol < ZERO) {
+    cvProcessError(NULL, CV_ILL_INPUT, "CVODE", "CVodeBatchSStolerances",
+                   MSGCV_BAD_ABSTOL);
+    return(CV_ILL_INPUT);
+  }
+
+  if (cvb_mem->Vabstol != NULL) {
+    free(cvb_mem->Vabstol);
+    cvb_mem->Vabstol = NULL;
+  }
+
+  cvb_mem->reltol  = reltol;
+  cvb_mem->Sabstol = abstol;
+  cvb_mem->tolset  = SUNTRUE;
+
+  return(CV_SUCCESS);
+}
+
+int CVodeBatchSVtolerances(void *cvode_batch_mem, realtype reltol,
+                           N_Vector abstol)
+{
+  CVodeBatchMem cvb_mem;
+  realtype *adata;
+  sunindextype i;
+
+  if (cvode_batch_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODE", "CVodeBatchSVtolerances",
+                   MSGCVB_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+  cvb_mem = (CVodeBatchMem) cvode_batch_mem;
+
+  if (reltol < ZERO) {
+    cvProcessError(NULL, CV_ILL_INPUT, "CVODE", "CVodeBatchSVtolerances",
+                   MSGCV_BAD_RELTOL);
+    return(CV_ILL_INPUT);
+  }
+
+  if (abstol == NULL) {
+    cvProcessError(NULL, CV_ILL_INPUT, "CVODE", "CVodeBatchSVtolerances",
+                   MSGCV_NULL_ABSTOL);
+    return(CV_ILL_INPUT);
+  }
+
+  adata = N_VGetArrayPointer(abstol);
+  if ((adata == NULL) || (N_VGetLength(abstol) != cvb_mem->n)) {
+    cvProcessError(NULL, CV_ILL_INPUT, "CVODE", "CVodeBatchSVtolerances",
+                   "abstol must provide an array of length n.");
+    return(CV_ILL_INPUT);
+  }
+
+  for (i = 0; i < cvb_mem->n; i++) {
+    if (adata[i] < ZERO) {
+      cvProcessError(NULL, CV_ILL_INPUT, "CVODE", "CVodeBatchSVtolerances",
+                     MSGCV_BAD_ABSTOL);
+      return(CV_ILL_INPUT);
+    }
+  }
+
+  if (cvb_mem->Vabstol == NULL) {
+    cvb_mem->Vabstol = (realtype *) malloc(cvb_mem->n * sizeof(realtype));
+    if (cvb_mem->Vabstol == NULL) {
+      cvProcessError(NULL, CV_MEM_FAIL, "CVODE", "CVodeBatchSVtolerances",
+                     MSGCVB_MEM_FAIL);
+      return(CV_MEM_FAIL);
+    }
+  }
+  memcpy(cvb_mem->Vabstol, adata, cvb_mem->n * sizeof(realtype));
+
+  cvb_mem->reltol = reltol;
+  cvb_mem->tolset = SUNTRUE;
+
+  return(CV_SUCCESS);
+}
+
+/*
+ * CVodeBatchSet* optional inputs
+ */
+
+int CVodeBatchSetJacFn(void *cvb_mem, CVBatchJacFn jac)
+{
+  if (cvb_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODE", "CVodeBatchSetJacFn",
+                   MSGCVB_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+
+  ((CVodeBatchMem) cvb_mem)->jac = jac;
+
+  return(CV_SUCCESS);
+}
+
+int CVodeBatchSetUserData(void *cvb_mem, void *user_data)
+{
+  if (cvb_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODE", "CVodeBatchSetUserData",
+                   MSGCVB_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+
+  ((CVodeBatchMem) cvb_mem)->user_data = user_data;
+
+  return(CV_SUCCESS);
+}
+
+int CVodeBatchSetMaxOrd(void *cvode_batch_mem, int maxord)
+{
+  CVodeBatchMem cvb_mem;
+  int k;
+
+  if (cvode_batch_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODE", "CVodeBatchSetMaxOrd",
+                   MSGCVB_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+  cvb_mem = (CVodeBatchMem) cvode_batch_mem;
+
+  if (maxord <= 0) {
+    cvProcessError(NULL, CV_ILL_INPUT, "CVODE", "CVodeBatchSetMaxOrd",
+                   MSGCV_NEG_MAXORD);
+    return(CV_ILL_INPUT);
+  }
+
+  /* The history arrays are only reset by CVodeBatchReInit */
+  if (!cvb_mem->firstcall) {
+    cvProcessError(NULL, CV_ILL_INPUT, "CVODE", "CVodeBatchSetMaxOrd",
+                   "The maximum order cannot be changed during the integration.");
+    return(CV_ILL_INPUT);
+  }
+
+  cvb_mem->qmax = SUNMIN(maxord, CVB_QMAX);
+  for (k = 0; k < cvb_mem->nsys; k++) SYS(k)->indx_acor = cvb_mem->qmax;
+
+  return(CV_SUCCESS);
+}
+
+int CVodeBatchSetMaxNumSteps(void *cvb_mem, long int mxsteps)
+{
+  if (cvb_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODE", "CVodeBatchSetMaxNumSteps",
+                   MSGCVB_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+
+  /* Passing mxsteps = 0 sets the default. Passing mxsteps < 0 disables the test. */
+  if (mxsteps == 0)
+    ((CVodeBatchMem) cvb_mem)->mxstep = MXSTEP_DEFAULT;
+  else
+    ((CVodeBatchMem) cvb_mem)->mxstep = mxsteps;
+
+  return(CV_SUCCESS);
+}
+
+int CVodeBatchSetNumThreads(void *cvb_mem, int nthreads)
+{
+  if (cvb_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODE", "CVodeBatchSetNumThreads",
+                   MSGCVB_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+
+  if (nthreads < 1) {
+    cvProcessError(NULL, CV_ILL_INPUT, "CVODE", "CVodeBatchSetNumThreads",
+                   "nthreads < 1 illegal.");
+    return(CV_ILL_INPUT);
+  }
+
+  ((CVodeBatchMem) cvb_mem)->nthreads = nthreads;
+
+  return(CV_SUCCESS);
+}
+
+/*
+ * CVodeBatch
+ *
+ * This routine is the main driver of the batched integrator. Every
+ * system is advanced until it reaches or passes tout, and its
+ * solution at tout is interpolated into the corresponding block of
+ * yout. A system that fails leaves the batch at its last successful
+ * step, with y(tcur) stored in yout and the failure recorded in its
+ * flag.
+ *
+ * The return value is CV_SUCCESS if all systems reached tout, and
+ * otherwise the flag of the failed system with the lowest index.
+ */
+
+int CVodeBatch(void *cvode_batch_mem, realtype tout, N_Vector yout)
+{
+  CVodeBatchMem cvb_mem;
+  CVodeBatchSys sp;
+  realtype *ydata, troundoff;
+  int k, nact, retval;
+
+  if (cvode_batch_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODE", "CVodeBatch", MSGCVB_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+  cvb_mem = (CVodeBatchMem) cvode_batch_mem;
+
+  if (cvb_mem->f == NULL) {
+    cvProcessError(NULL, CV_NO_MALLOC, "CVODE", "CVodeBatch", MSGCVB_NO_MALLOC);
+    return(CV_NO_MALLOC);
+  }
+
+  if (!cvb_mem->tolset) {
+    cvProcessError(NULL, CV_ILL_INPUT, "CVODE", "CVodeBatch", MSGCV_NO_TOL);
+    return(CV_ILL_INPUT);
+  }
+
+  if (cvbCheckVector(cvb_mem, yout, "CVodeBatch") != CV_SUCCESS)
+    return(CV_ILL_INPUT);
+  ydata = N_VGetArrayPointer(yout);
+
+  /* All systems start in the active batch */
+
+  cvb_mem->nactive = cvb_mem->nsys;
+  for (k = 0; k < cvb_mem->nsys; k++) {
+    SYS(k)->done    = SUNFALSE;
+    SYS(k)->flag    = CV_SUCCESS;
+    SYS(k)->nstcall = 0;
+  }
+
+  /* On the first call, load zn[1] and select the initial step sizes */
+
+  if (cvb_mem->firstcall) {
+    retval = cvbInitialStep(cvb_mem, tout);
+    if (retval != CV_SUCCESS) return(retval);
+    cvb_mem->firstcall = SUNFALSE;
+    for (k = cvb_mem->nactive; k < cvb_mem->nsys; k++)
+      memcpy(ydata + SYS(k)->sysid * cvb_mem->n, ZN(0,k),
+             cvb_mem->n * sizeof(realtype));
+  } else {
+    /* A system that already passed tout must have tout in its last step */
+    for (k = 0; k < cvb_mem->nsys; k++) {
+      sp = SYS(k);
+      if ((sp->tn - tout) * sp->h < ZERO) continue;
+      troundoff = FUZZ_FACTOR * cvb_mem->uround *
+        (SUNRabs(sp->tn) + SUNRabs(sp->hu));
+      if ((tout - (sp->tn - sp->hu - troundoff)) * sp->h < ZERO) {
+        cvProcessError(NULL, CV_ILL_INPUT, "CVODE", "CVodeBatch",
+                       "tout is behind the last step of system %d.",
+                       sp->sysid);
+        return(CV_ILL_INPUT);
+      }
+    }
+  }
+
+  /* Remove the systems that already reached tout */
+
+  for (k = 0; k < cvb_mem->nactive; k++) {
+    sp = SYS(k);
+    if (sp->done) continue;
+    if ((sp->tn - tout) * sp->h >= ZERO) {
+      cvbGetY(cvb_mem, k, tout, ydata + sp->sysid * cvb_mem->n);
+      sp->done = SUNTRUE;
+    }
+  }
+  cvbCompact(cvb_mem);
+
+  /* Take steps in lockstep until the active batch is empty. An
+     unrecoverable failure of f or the Jacobian ends all active systems. */
+
+  while (cvb_mem->nactive > 0) {
+
+    nact = cvb_mem->nactive;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(cvb_mem->nthreads) schedule(static)
+#endif
+    for (k = 0; k < nact; k++)
+      cvbBeginAttempt(cvb_mem, k);
+
+    retval = cvbNls(cvb_mem);
+
+    if (retval < 0) {
+      cvbFailAll(cvb_mem, retval, SUNTRUE);
+    } else {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(cvb_mem->nthreads) schedule(static)
+#endif
+      for (k = 0; k < nact; k++)
+        cvbFinishAttempt(cvb_mem, k, tout);
+
+      retval = cvbReload(cvb_mem);
+      if (retval < 0) cvbFailAll(cvb_mem, retval, SUNFALSE);
+    }
+
+    /* Store the output of the systems that left the batch */
+
+    for (k = 0; k < nact; k++) {
+      sp = SYS(k);
+      if (!sp->done) continue;
+      if (sp->flag == CV_SUCCESS)
+        cvbGetY(cvb_mem, k, tout, ydata + sp->sysid * cvb_mem->n);
+      else
+        memcpy(ydata + sp->sysid * cvb_mem->n, ZN(0,k),
+               cvb_mem->n * sizeof(realtype));
+    }
+    cvbCompact(cvb_mem);
+  }
+
+  /* Report the first failed system */
+
+  for (k = 0; k < cvb_mem->nsys; k++) {
+    sp = SYS(cvb_mem->slot[k]);
+    if (sp->flag != CV_SUCCESS) {
+      cvProcessError(NULL, sp->flag, "CVODE", "CVodeBatch", MSGCVB_SYS_FAIL);
+      return(sp->flag);
+    }
+  }
+
+  return(CV_SUCCESS);
+}
+
+/*
+ * CVodeBatchGet* optional outputs
+ *
+ * Per-system outputs are written to arrays of length nsys indexed by
+ * system, regardless of the slot a system currently occupies.
+ */
+
+#define CVB_GET_PER_SYSTEM(fname, type, arg, field)                     \
+  int fname(void *cvode_batch_mem, type *arg)                           \
+  {                                                                     \
+    CVodeBatchMem cvb_mem;                                              \
+    int s;                                                              \
+    if (cvode_batch_mem == NULL) {                                      \
+      cvProcessError(NULL, CV_MEM_NULL, "CVODE", #fname, MSGCVB_NO_MEM); \
+      return(CV_MEM_NULL);                                              \
+    }                                                                   \
+    cvb_mem = (CVodeBatchMem) cvode_batch_mem;                          \
+    for (s = 0; s < cvb_mem->nsys; s++)                                 \
+      arg[s] = SYS(cvb_mem->slot[s])->field;                            \
+    return(CV_SUCCESS);                                                 \
+  }
+
+CVB_GET_PER_SYSTEM(CVodeBatchGetSystemFlags, int, flags, flag)
+CVB_GET_PER_SYSTEM(CVodeBatchGetCurrentTime, realtype, tcur, tn)
+CVB_GET_PER_SYSTEM(CVodeBatchGetNumSteps, long int, nsteps, nst)
+CVB_GET_PER_SYSTEM(CVodeBatchGetNumErrTestFails, long int, netfails, netf)
+CVB_GET_PER_SYSTEM(CVodeBatchGetNumNonlinSolvIters, long int, nniters, nni)
+CVB_GET_PER_SYSTEM(CVodeBatchGetNumNonlinSolvConvFails, long int, nnfails, ncfn)
+CVB_GET_PER_SYSTEM(CVodeBatchGetLastOrder, int, qlast, qu)
+CVB_GET_PER_SYSTEM(CVodeBatchGetLastStep, realtype, hlast, hu)
+
+int CVodeBatchGetNumRhsEvals(void *cvb_mem, long int *nfevals)
+{
+  if (cvb_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODE", "CVodeBatchGetNumRhsEvals",
+                   MSGCVB_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+
+  *nfevals = ((CVodeBatchMem) cvb_mem)->nfe;
+
+  return(CV_SUCCESS);
+}
+
+int CVodeBatchGetNumJacEvals(void *cvb_mem, long int *njevals)
+{
+  if (cvb_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODE", "CVodeBatchGetNumJacEvals",
+                   MSGCVB_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+
+  *njevals = ((CVodeBatchMem) cvb_mem)->nje;
+
+  return(CV_SUCCESS);
+}
+
+int CVodeBatchGetNumLinSolvSetups(void *cvb_mem, long int *nlinsetups)
+{
+  if (cvb_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODE", "CVodeBatchGetNumLinSolvSetups",
+                   MSGCVB_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+
+  *nlinsetups = ((CVodeBatchMem) cvb_mem)->nsetups;
+
+  return(CV_SUCCESS);
+}
+
+/*
+ * CVodeBatchFree
+ *
+ * This routine frees the batched integrator memory.
+ */
+
+void CVodeBatchFree(void **cvode_batch_mem)
+{
+  CVodeBatchMem cvb_mem;
+  int j;
+
+  if (*cvode_batch_mem == NULL) return;
+  cvb_mem = (CVodeBatchMem) (*cvode_batch_mem);
+
+  free(cvb_mem->sys);
+  free(cvb_mem->slot);
+  free(cvb_mem->sysid);
+  free(cvb_mem->t);
+  free(cvb_mem->ewt);
+  free(cvb_mem->acor);
+  free(cvb_mem->y);
+  free(cvb_mem->ftemp);
+  free(cvb_mem->tempv);
+  free(cvb_mem->J);
+  free(cvb_mem->M);
+  free(cvb_mem->pivots);
+  free(cvb_mem->lufail);
+  free(cvb_mem->rhs);
+  free(cvb_mem->work);
+  free(cvb_mem->Vabstol);
+  for (j = 0; j <= CVB_QMAX; j++) free(cvb_mem->zn[j]);
+
+  free(*cvode_batch_mem);
+  *cvode_batch_mem = NULL;
+}
+
+/*
+ * =================================================================
+ * PRIVATE FUNCTIONS
+ * =================================================================
+ */
+
+/*
+ * -----------------------------------------------------------------
+ * Utilities
+ * -----------------------------------------------------------------
+ */
+
+/* Check that v exposes an array holding all systems */
+
+static int cvbCheckVector(CVodeBatchMem cvb_mem, N_Vector v, const char *fname)
+{
+  if ( (v == NULL) || (N_VGetArrayPointer(v) == NULL) ||
+       (N_VGetLength(v) != cvb_mem->n * cvb_mem->nsys) ) {
+    cvProcessError(NULL, CV_ILL_INPUT, "CVODE", fname, MSGCVB_BAD_NVEC);
+    return(CV_ILL_INPUT);
+  }
+  return(CV_SUCCESS);
+}
+
+/* Range of slots [k0, k1) handled by the calling thread */
+
+static void cvbSlotRange(int nslots, int *k0, int *k1)
+{
+#ifdef _OPENMP
+  int tid = omp_get_thread_num();
+  int nth = omp_get_num_threads();
+#else
+  int tid = 0;
+  int nth = 1;
+#endif
+
+  *k0 = (nslots * tid) / nth;
+  *k1 = (nslots * (tid + 1)) / nth;
+}
+
+static realtype cvbWrmsNorm(sunindextype n, realtype *x, realtype *w)
+{
+  sunindextype i;
+  realtype sum = ZERO;
+
+  for (i = 0; i < n; i++) sum += SUNSQR(x[i] * w[i]);
+
+  return(SUNRsqrt(sum / n));
+}
+
+/* Set the error weights of slot k from zn[0], returns -1 on a
+   nonpositive weight denominator */
+
+static int cvbEwtSet(CVodeBatchMem cvb_mem, int k)
+{
+  sunindextype i;
+  realtype *ycur = ZN(0,k), *ewt = BLK(cvb_mem->ewt,k), atol, den;
+
+  for (i = 0; i < cvb_mem->n; i++) {
+    atol = (cvb_mem->Vabstol == NULL) ? cvb_mem->Sabstol : cvb_mem->Vabstol[i];
+    den  = cvb_mem->reltol * SUNRabs(ycur[i]) + atol;
+    if (den <= ZERO) return(-1);
+    ewt[i] = ONE / den;
+  }
+
+  return(0);
+}
+
+/* Evaluate f for all active slots, at the slot times when at_tn is
+   true and at the times already stored in cvb_mem->t otherwise */
+
+static int cvbRhs(CVodeBatchMem cvb_mem, booleantype at_tn, realtype *y,
+                  realtype *ydot)
+{
+  int k;
+
+  for (k = 0; k < cvb_mem->nactive; k++) {
+    cvb_mem->sysid[k] = SYS(k)->sysid;
+    if (at_tn) cvb_mem->t[k] = SYS(k)->tn;
+  }
+
+  cvb_mem->nfe++;
+  return(cvb_mem->f(cvb_mem->nactive, cvb_mem->sysid, cvb_mem->t, y, ydot,
+                    cvb_mem->user_data));
+}
+
+/*
+ * -----------------------------------------------------------------
+ * Initial step
+ * -----------------------------------------------------------------
+ */
+
+/*
+ * cvbInitialStep
+ *
+ * This routine loads zn[1] = f(t0, y0) and the error weights of all
+ * systems, selects the initial step sizes, and scales zn[1] by h as
+ * CVode does on its first call.
+ */
+
+static int cvbInitialStep(CVodeBatchMem cvb_mem, realtype tout)
+{
+  CVodeBatchSys sp;
+  sunindextype i;
+  realtype tdist, tround;
+  int k, retval;
+
+  sp     = SYS(0);
+  tdist  = SUNRabs(tout - sp->tn);
+  tround = cvb_mem->uround * SUNMAX(SUNRabs(sp->tn), SUNRabs(tout));
+  if ((tdist == ZERO) || (tdist < TWO*tround)) {
+    cvProcessError(NULL, CV_TOO_CLOSE, "CVODE", "CVodeBatch", MSGCV_TOO_CLOSE);
+    return(CV_TOO_CLOSE);
+  }
+
+  retval = cvbRhs(cvb_mem, SUNTRUE, cvb_mem->zn[0], cvb_mem->zn[1]);
+  if (retval != 0) {
+    cvProcessError(NULL, (retval < 0) ? CV_RHSFUNC_FAIL : CV_FIRST_RHSFUNC_ERR,
+                   "CVODE", "CVodeBatch", (retval < 0) ?
+                   "The batched right-hand side routine failed at the first call." :
+                   "The batched right-hand side routine failed recoverably at the first call.");
+    return((retval < 0) ? CV_RHSFUNC_FAIL : CV_FIRST_RHSFUNC_ERR);
+  }
+
+  /* A system with invalid error weights leaves the batch */
+  for (k = 0; k < cvb_mem->nactive; k++) {
+    if (cvbEwtSet(cvb_mem, k) != 0) {
+      SYS(k)->flag = CV_ILL_INPUT;
+      SYS(k)->done = SUNTRUE;
+    }
+  }
+  cvbCompact(cvb_mem);
+
+  retval = cvbHin(cvb_mem, tout);
+  if (retval != CV_SUCCESS) {
+    cvProcessError(NULL, retval, "CVODE", "CVodeBatch",
+                   "The batched right-hand side routine failed while selecting the initial steps.");
+    return(retval);
+  }
+
+  for (k = 0; k < cvb_mem->nactive; k++) {
+    sp = SYS(k);
+    sp->hscale = sp->h;
+    sp->hprime = sp->h;
+    for (i = 0; i < cvb_mem->n; i++) ZN(1,k)[i] *= sp->h;
+  }
+
+  return(CV_SUCCESS);
+}
+
+/*
+ * cvbHin
+ *
+ * This routine follows cvHin for every active system. Each pass of
+ * the iteration evaluates the second derivative estimates of all
+ * systems still iterating with one batched call to f. A recoverable
+ * failure of f reduces the trial steps of all of these systems.
+ */
+
+static int cvbHin(CVodeBatchMem cvb_mem, realtype tout)
+{
+  CVodeBatchSys sp;
+  sunindextype i, n;
+  realtype tdiff, tdist, tround, hlb, sign, hgs, hrat, yddnrm, hub_inv, den;
+  realtype *hub, *hg, *hs, *hnew, *y0, *yd0, *ewt, *y, *fy;
+  int *count1, *count2, *active;
+  int k, nact, niter, retval;
+
+  n    = cvb_mem->n;
+  nact = cvb_mem->nactive;
+  if (nact == 0) return(CV_SUCCESS);
+
+  hub    = (realtype *) malloc(4 * nact * sizeof(realtype));
+  count1 = (int *) malloc(3 * nact * sizeof(int));
+  if ((hub == NULL) || (count1 == NULL)) {
+    free(hub); free(count1);
+    return(CV_MEM_FAIL);
+  }
+  hg     = hub + nact;
+  hs     = hg + nact;
+  hnew   = hs + nact;
+  count2 = count1 + nact;
+  active = count2 + nact;
+
+  tdiff  = tout - SYS(0)->tn;
+  sign   = (tdiff > ZERO) ? ONE : -ONE;
+  tdist  = SUNRabs(tdiff);
+  tround = cvb_mem->uround * SUNMAX(SUNRabs(SYS(0)->tn), SUNRabs(tout));
+  hlb    = HLB_FACTOR * tround;
+
+  /* Set the upper bound on h0 from |y0|/|y0'| and tdist, and take the
+     geometric mean of the bounds as the first trial value */
+
+  niter = 0;
+  for (k = 0; k < nact; k++) {
+    y0 = ZN(0,k); yd0 = ZN(1,k); ewt = BLK(cvb_mem->ewt,k);
+    hub_inv = ZERO;
+    for (i = 0; i < n; i++) {
+      den = HUB_FACTOR * SUNRabs(y0[i]) + ONE / ewt[i];
+      hub_inv = SUNMAX(hub_inv, SUNRabs(yd0[i]) / den);
+    }
+    hub[k] = HUB_FACTOR * tdist;
+    if (hub[k] * hub_inv > ONE) hub[k] = ONE / hub_inv;
+
+    hg[k]     = SUNRsqrt(hlb * hub[k]);
+    hs[k]     = hg[k];
+    hnew[k]   = hg[k];
+    count1[k] = 1;
+    count2[k] = 0;
+    active[k] = (hub[k] >= hlb);
+    if (active[k]) niter++;
+  }
+
+  /* Iterate on the estimates of ydd */
+
+  while (niter > 0) {
+
+    for (k = 0; k < nact; k++) {
+      y0 = ZN(0,k); yd0 = ZN(1,k); y = BLK(cvb_mem->y,k);
+      hgs = active[k] ? hg[k] * sign : ZERO;
+      cvb_mem->t[k] = SYS(k)->tn + hgs;
+      for (i = 0; i < n; i++) y[i] = y0[i] + hgs * yd0[i];
+    }
+
+    retval = cvbRhs(cvb_mem, SUNFALSE, cvb_mem->y, cvb_mem->tempv);
+    if (retval < 0) {
+      free(hub); free(count1);
+      return(CV_RHSFUNC_FAIL);
+    }
+
+    for (k = 0; k < nact; k++) {
+      if (!active[k]) continue;
+
+      /* The RHS function failed recoverably; cut step size and test again */
+      if (retval > 0) {
+        count2[k]++;
+        hg[k] *= POINT2;
+        if (count2[k] < MAX_ITERS) continue;
+        /* No recovery is possible on the first or second pass, afterwards
+           fall back to a previous hnew which passed through f() */
+        if (count1[k] <= 2) {
+          free(hub); free(count1);
+          return(CV_REPTD_RHSFUNC_ERR);
+        }
+        hnew[k] = hs[k];
+        active[k] = 0;
+        niter--;
+        continue;
+      }
+
+      yd0 = ZN(1,k); fy = BLK(cvb_mem->tempv,k); ewt = BLK(cvb_mem->ewt,k);
+      hgs = hg[k] * sign;
+      for (i = 0; i < n; i++) fy[i] = (fy[i] - yd0[i]) / hgs;
+      yddnrm = cvbWrmsNorm(n, fy, ewt);
+
+      /* The proposed step size is feasible. Save it. */
+      hs[k] = hg[k];
+
+      /* Propose new step size */
+      hnew[k] = (yddnrm*hub[k]*hub[k] > TWO) ?
+        SUNRsqrt(TWO/yddnrm) : SUNRsqrt(hg[k]*hub[k]);
+
+      hrat = hnew[k] / hg[k];
+
+      /* Stop on the last pass, if hnew does not differ from hg by more than
+         a factor of 2, or after one pass if ydd seems to be bad */
+      if ( (count1[k] == MAX_ITERS) || ((hrat > HALF) && (hrat < TWO)) ) {
+        active[k] = 0;
+        niter--;
+      } else if ((count1[k] > 1) && (hrat > TWO)) {
+        hnew[k] = hg[k];
+        active[k] = 0;
+        niter--;
+      } else {
+        /* Send this value back through f() */
+        hg[k] = hnew[k];
+        count1[k]++;
+        count2[k] = 0;
+      }
+    }
+  }
+
+  /* Apply bounds, bias factor, and attach sign */
+
+  for (k = 0; k < nact; k++) {
+    sp = SYS(k);
+    if (hub[k] < hlb) {
+      sp->h = sign * hg[k];
+      continue;
+    }
+    sp->h = H_BIAS * hnew[k];
+    if (sp->h < hlb)    sp->h = hlb;
+    if (sp->h > hub[k]) sp->h = hub[k];
+    sp->h *= sign;
+  }
+
+  free(hub); free(count1);
+  return(CV_SUCCESS);
+}
+
+/*
+ * -----------------------------------------------------------------
+ * Per-system step functions, see the corresponding routines in
+ * cvode.c
+ * -----------------------------------------------------------------
+ */
+
+/*
+ * cvbBeginAttempt
+ *
+ * This routine starts a step attempt of slot k: it applies a pending
+ * change of step size or order, predicts zn, and sets the BDF
+ * coefficients and gamma.
+ */
+
+static void cvbBeginAttempt(CVodeBatchMem cvb_mem, int k)
+{
+  CVodeBatchSys sp = SYS(k);
+
+  if ((sp->nflag == FIRST_CALL) && (sp->nst > 0) && (sp->hprime != sp->h)) {
+    if (sp->qprime != sp->q) {
+      cvbAdjustOrder(cvb_mem, k, sp->qprime - sp->q);
+      sp->q = sp->qprime;
+      sp->L = sp->q + 1;
+      sp->qwait = sp->L;
+    }
+    cvbRescale(cvb_mem, k);
+  }
+
+  sp->saved_t = sp->tn;
+  cvbPredict(cvb_mem, k);
+  cvbSetBDF(cvb_mem, k);
+
+  sp->rl1    = ONE / sp->l[1];
+  sp->gamma  = sp->h * sp->rl1;
+  if (sp->nst == 0) sp->gammap = sp->gamma;
+  sp->gamrat = (sp->nst > 0) ? sp->gamma / sp->gammap : ONE;
+}
+
+/*
+ * cvbFinishAttempt
+ *
+ * This routine combines cvHandleNFlag, cvDoErrorTest, and the end of
+ * cvStep for slot k. On success the step is completed and the system
+ * leaves the batch once it passes tout or exceeds mxstep steps. On
+ * failure the step is restored and h reduced for the next attempt,
+ * unless the failure is not recoverable.
+ */
+
+static void cvbFinishAttempt(CVodeBatchMem cvb_mem, int k, realtype tout)
+{
+  CVodeBatchSys sp = SYS(k);
+  realtype dsm;
+
+  /* Nonlinear solver failure, see cvHandleNFlag */
+
+  if (sp->status != CV_SUCCESS) {
+    sp->ncfn++;
+    cvbRestore(cvb_mem, k);
+    sp->ncf++;
+    sp->etamax = ONE;
+    if (sp->ncf == MXNCF) {
+      sp->flag = (sp->status == RHSFUNC_RECVR) ?
+        CV_REPTD_RHSFUNC_ERR : CV_CONV_FAILURE;
+      sp->done = SUNTRUE;
+      return;
+    }
+    sp->eta = ETA_CF_DEFAULT;
+    sp->nflag = PREV_CONV_FAIL;
+    cvbRescale(cvb_mem, k);
+    return;
+  }
+
+  /* Error test, see cvDoErrorTest */
+
+  dsm = sp->acnrm * sp->tq[2];
+
+  if (dsm > ONE) {
+    sp->nef++;
+    sp->netf++;
+    sp->nflag = PREV_ERR_FAIL;
+    cvbRestore(cvb_mem, k);
+
+    if (sp->nef == MXNEF) {
+      sp->flag = CV_ERR_FAILURE;
+      sp->done = SUNTRUE;
+      return;
+    }
+
+    sp->etamax = ONE;
+
+    if (sp->nef <= MXNEF1) {
+      sp->eta = ONE / (SUNRpowerR(BIAS2*dsm, ONE/sp->L) + ADDON);
+      sp->eta = SUNMAX(ETA_MIN_EF_DEFAULT, sp->eta);
+      if (sp->nef >= SMALL_NEF_DEFAULT)
+        sp->eta = SUNMIN(sp->eta, ETA_MAX_EF_DEFAULT);
+      cvbRescale(cvb_mem, k);
+      return;
+    }
+
+    /* After MXNEF1 failures, force an order reduction and retry step */
+    sp->eta = ETA_MIN_EF_DEFAULT;
+    if (sp->q > 1) {
+      cvbAdjustOrder(cvb_mem, k, -1);
+      sp->L = sp->q;
+      sp->q--;
+      sp->qwait = sp->L;
+      cvbRescale(cvb_mem, k);
+      return;
+    }
+
+    /* If already at order 1, restart: zn[1] is reloaded by cvbReload */
+    sp->h *= sp->eta;
+    sp->hscale = sp->h;
+    sp->qwait = LONG_WAIT;
+    sp->reload = SUNTRUE;
+    return;
+  }
+
+  /* The step passed, update the history and select the next step */
+
+  cvbCompleteStep(cvb_mem, k);
+  cvbPrepareNextStep(cvb_mem, k, dsm);
+
+  sp->etamax = (sp->nst <= SMALL_NST_DEFAULT) ?
+    ETA_MAX_ES_DEFAULT : ETA_MAX_GS_DEFAULT;
+  sp->nflag = FIRST_CALL;
+  sp->ncf = sp->nef = 0;
+  sp->nstcall++;
+
+  if (cvbEwtSet(cvb_mem, k) != 0) {
+    sp->flag = CV_ILL_INPUT;
+    sp->done = SUNTRUE;
+    return;
+  }
+
+  if ((sp->tn - tout) * sp->h >= ZERO) {
+    sp->flag = CV_SUCCESS;
+    sp->done = SUNTRUE;
+  } else if ((cvb_mem->mxstep > 0) && (sp->nstcall >= cvb_mem->mxstep)) {
+    sp->flag = CV_TOO_MUCH_WORK;
+    sp->done = SUNTRUE;
+  }
+}
+
+/*
+ * cvbAdjustOrder
+ *
+ * This routine adjusts the history array of slot k on an order
+ * change by deltaq, see cvAdjustOrder and cvAdjustBDF.
+ */
+
+static void cvbAdjustOrder(CVodeBatchMem cvb_mem, int k, int deltaq)
+{
+  if ((SYS(k)->q == 2) && (deltaq != 1)) return;
+
+  if (deltaq == 1) cvbIncreaseBDF(cvb_mem, k);
+  else             cvbDecreaseBDF(cvb_mem, k);
+}
+
+static void cvbIncreaseBDF(CVodeBatchMem cvb_mem, int k)
+{
+  CVodeBatchSys sp = SYS(k);
+  realtype alpha0, alpha1, prod, xi, xiold, hsum, A1;
+  realtype *znL, *zacor, *znj;
+  sunindextype m;
+  int i, j;
+
+  for (i = 0; i <= cvb_mem->qmax; i++) sp->l[i] = ZERO;
+  sp->l[2] = alpha1 = prod = xiold = ONE;
+  alpha0 = -ONE;
+  hsum = sp->hscale;
+  if (sp->q > 1) {
+    for (j = 1; j < sp->q; j++) {
+      hsum += sp->tau[j+1];
+      xi = hsum / sp->hscale;
+      prod *= xi;
+      alpha0 -= ONE / (j+1);
+      alpha1 += ONE / xi;
+      for (i = j+2; i >= 2; i--) sp->l[i] = sp->l[i]*xiold + sp->l[i-1];
+      xiold = xi;
+    }
+  }
+  A1 = (-alpha0 - alpha1) / prod;
+
+  znL   = ZN(sp->L,k);
+  zacor = ZN(sp->indx_acor,k);
+  for (m = 0; m < cvb_mem->n; m++) znL[m] = A1 * zacor[m];
+
+  for (j = 2; j <= sp->q; j++) {
+    znj = ZN(j,k);
+    for (m = 0; m < cvb_mem->n; m++) znj[m] += sp->l[j] * znL[m];
+  }
+}
+
+static void cvbDecreaseBDF(CVodeBatchMem cvb_mem, int k)
+{
+  CVodeBatchSys sp = SYS(k);
+  realtype hsum, xi, *znq, *znj;
+  sunindextype m;
+  int i, j;
+
+  for (i = 0; i <= cvb_mem->qmax; i++) sp->l[i] = ZERO;
+  sp->l[2] = ONE;
+  hsum = ZERO;
+  for (j = 1; j <= sp->q-2; j++) {
+    hsum += sp->tau[j];
+    xi = hsum / sp->hscale;
+    for (i = j+2; i >= 2; i--) sp->l[i] = sp->l[i]*xi + sp->l[i-1];
+  }
+
+  znq = ZN(sp->q,k);
+  for (j = 2; j < sp->q; j++) {
+    znj = ZN(j,k);
+    for (m = 0; m < cvb_mem->n; m++) znj[m] -= sp->l[j] * znq[m];
+  }
+}
+
+static void cvbRescale(CVodeBatchMem cvb_mem, int k)
+{
+  CVodeBatchSys sp = SYS(k);
+  realtype factor, *znj;
+  sunindextype m;
+  int j;
+
+  factor = sp->eta;
+  for (j = 1; j <= sp->q; j++) {
+    znj = ZN(j,k);
+    for (m = 0; m < cvb_mem->n; m++) znj[m] *= factor;
+    factor *= sp->eta;
+  }
+
+  sp->h = sp->hscale * sp->eta;
+  sp->hscale = sp->h;
+}
+
+static void cvbPredict(CVodeBatchMem cvb_mem, int k)
+{
+  CVodeBatchSys sp = SYS(k);
+  realtype *zlo, *zhi;
+  sunindextype m;
+  int i, j;
+
+  sp->tn += sp->h;
+
+  for (i = 1; i <= sp->q; i++) {
+    for (j = sp->q; j >= i; j--) {
+      zlo = ZN(j-1,k); zhi = ZN(j,k);
+      for (m = 0; m < cvb_mem->n; m++) zlo[m] += zhi[m];
+    }
+  }
+}
+
+static void cvbRestore(CVodeBatchMem cvb_mem, int k)
+{
+  CVodeBatchSys sp = SYS(k);
+  realtype *zlo, *zhi;
+  sunindextype m;
+  int i, j;
+
+  sp->tn = sp->saved_t;
+
+  for (i = 1; i <= sp->q; i++) {
+    for (j = sp->q; j >= i; j--) {
+      zlo = ZN(j-1,k); zhi = ZN(j,k);
+      for (m = 0; m < cvb_mem->n; m++) zlo[m] -= zhi[m];
+    }
+  }
+}
+
+/*
+ * cvbSetBDF
+ *
+ * This routine computes the BDF coefficients l and the test
+ * quantities tq of slot k, combining cvSetBDF and cvSetTqBDF.
+ */
+
+static void cvbSetBDF(CVodeBatchMem cvb_mem, int k)
+{
+  CVodeBatchSys sp = SYS(k);
+  realtype alpha0, alpha0_hat, xi_inv, xistar_inv, hsum;
+  realtype A1, A2, A3, A4, A5, A6, C, Cpinv, Cppinv;
+  int i, j, q = sp->q;
+
+  sp->l[0] = sp->l[1] = xi_inv = xistar_inv = ONE;
+  for (i = 2; i <= q; i++) sp->l[i] = ZERO;
+  alpha0 = alpha0_hat = -ONE;
+  hsum = sp->h;
+
+  if (q > 1) {
+    for (j = 2; j < q; j++) {
+      hsum += sp->tau[j-1];
+      xi_inv = sp->h / hsum;
+      alpha0 -= ONE / j;
+      for (i = j; i >= 1; i--) sp->l[i] += sp->l[i-1]*xi_inv;
+    }
+
+    /* j = q */
+    alpha0 -= ONE / q;
+    xistar_inv = -sp->l[1] - alpha0;
+    hsum += sp->tau[q-1];
+    xi_inv = sp->h / hsum;
+    alpha0_hat = -sp->l[1] - xi_inv;
+    for (i = q; i >= 1; i--) sp->l[i] += sp->l[i-1]*xistar_inv;
+  }
+
+  A1 = ONE - alpha0_hat + alpha0;
+  A2 = ONE + q * A1;
+  sp->tq[2] = SUNRabs(A1 / (alpha0 * A2));
+  sp->tq[5] = SUNRabs(A2 * xistar_inv / (sp->l[q] * xi_inv));
+  if (sp->qwait == 1) {
+    if (q > 1) {
+      C = xistar_inv / sp->l[q];
+      A3 = alpha0 + ONE / q;
+      A4 = alpha0_hat + xi_inv;
+      Cpinv = (ONE - A4 + A3) / A3;
+      sp->tq[1] = SUNRabs(C * Cpinv);
+    }
+    else sp->tq[1] = ONE;
+    hsum += sp->tau[q];
+    xi_inv = sp->h / hsum;
+    A5 = alpha0 - (ONE / (q+1));
+    A6 = alpha0_hat - xi_inv;
+    Cppinv = (ONE - A6 + A5) / A2;
+    sp->tq[3] = SUNRabs(Cppinv / (xi_inv * (q+2) * A5));
+  }
+  sp->tq[4] = CVB_NLSCOEF / sp->tq[2];
+}
+
+static void cvbCompleteStep(CVodeBatchMem cvb_mem, int k)
+{
+  CVodeBatchSys sp = SYS(k);
+  realtype *acor = BLK(cvb_mem->acor,k), *znj;
+  sunindextype m;
+  int i, j;
+
+  sp->nst++;
+  sp->hu = sp->h;
+  sp->qu = sp->q;
+
+  for (i = sp->q; i >= 2; i--) sp->tau[i] = sp->tau[i-1];
+  if ((sp->q == 1) && (sp->nst > 1)) sp->tau[2] = sp->tau[1];
+  sp->tau[1] = sp->h;
+
+  /* Apply correction to column j of zn: l_j * Delta_n */
+  for (j = 0; j <= sp->q; j++) {
+    znj = ZN(j,k);
+    for (m = 0; m < cvb_mem->n; m++) znj[m] += sp->l[j] * acor[m];
+  }
+
+  sp->qwait--;
+  if ((sp->qwait == 1) && (sp->q != cvb_mem->qmax)) {
+    memcpy(ZN(cvb_mem->qmax,k), acor, cvb_mem->n * sizeof(realtype));
+    sp->saved_tq5 = sp->tq[5];
+    sp->indx_acor = cvb_mem->qmax;
+  }
+}
+
+/*
+ * cvbPrepareNextStep
+ *
+ * This routine selects hprime and qprime for slot k, combining
+ * cvPrepareNextStep, cvComputeEtaqm1, cvComputeEtaqp1, and
+ * cvChooseEta.
+ */
+
+static void cvbPrepareNextStep(CVodeBatchMem cvb_mem, int k, realtype dsm)
+{
+  CVodeBatchSys sp = SYS(k);
+  realtype etaq, etaqm1, etaqp1, etam, ddn, dup, cquot;
+  realtype *acor = BLK(cvb_mem->acor,k), *tempv = BLK(cvb_mem->tempv,k);
+  realtype *zqmax = ZN(cvb_mem->qmax,k);
+  sunindextype m;
+
+  /* If etamax = 1, defer step size or order changes */
+  if (sp->etamax == ONE) {
+    sp->qwait  = SUNMAX(sp->qwait, 2);
+    sp->qprime = sp->q;
+    sp->hprime = sp->h;
+    sp->eta    = ONE;
+    return;
+  }
+
+  /* etaq is the ratio of new to old h at the current order */
+  etaq = ONE / (SUNRpowerR(BIAS2*dsm, ONE/sp->L) + ADDON);
+
+  /* If no order change, adjust eta in cvbSetEta and return */
+  if (sp->qwait != 0) {
+    sp->eta = etaq;
+    sp->qprime = sp->q;
+    cvbSetEta(cvb_mem, k);
+    return;
+  }
+
+  /* Consider an order change */
+  sp->qwait = 2;
+
+  etaqm1 = ZERO;
+  if (sp->q > 1) {
+    ddn = cvbWrmsNorm(cvb_mem->n, ZN(sp->q,k), BLK(cvb_mem->ewt,k)) * sp->tq[1];
+    etaqm1 = ONE / (SUNRpowerR(BIAS1*ddn, ONE/sp->q) + ADDON);
+  }
+
+  etaqp1 = ZERO;
+  if ((sp->q != cvb_mem->qmax) && (sp->saved_tq5 != ZERO)) {
+    cquot = (sp->tq[5] / sp->saved_tq5) *
+      SUNRpowerI(sp->h/sp->tau[2], sp->L);
+    for (m = 0; m < cvb_mem->n; m++) tempv[m] = acor[m] - cquot * zqmax[m];
+    dup = cvbWrmsNorm(cvb_mem->n, tempv, BLK(cvb_mem->ewt,k)) * sp->tq[3];
+    etaqp1 = ONE / (SUNRpowerR(BIAS3*dup, ONE/(sp->L+1)) + ADDON);
+  }
+
+  /* Choose the largest eta, preferring to keep, then decrease the order */
+  etam = SUNMAX(etaqm1, SUNMAX(etaq, etaqp1));
+
+  if ((etam > ETA_MIN_FX_DEFAULT) && (etam < ETA_MAX_FX_DEFAULT)) {
+    sp->eta = ONE;
+    sp->qprime = sp->q;
+  } else if (etam == etaq) {
+    sp->eta = etaq;
+    sp->qprime = sp->q;
+  } else if (etam == etaqm1) {
+    sp->eta = etaqm1;
+    sp->qprime = sp->q - 1;
+  } else {
+    sp->eta = etaqp1;
+    sp->qprime = sp->q + 1;
+    /* Store Delta_n in zn[qmax] to be used in the order increase */
+    memcpy(zqmax, acor, cvb_mem->n * sizeof(realtype));
+  }
+
+  cvbSetEta(cvb_mem, k);
+}
+
+static void cvbSetEta(CVodeBatchMem cvb_mem, int k)
+{
+  CVodeBatchSys sp = SYS(k);
+
+  if ((sp->eta > ETA_MIN_FX_DEFAULT) && (sp->eta < ETA_MAX_FX_DEFAULT)) {
+    /* Eta is within the fixed step bounds, retain step size */
+    sp->eta = ONE;
+    sp->hprime = sp->h;
+    return;
+  }
+
+  if (sp->eta >= ETA_MAX_FX_DEFAULT)
+    sp->eta = SUNMIN(sp->eta, sp->etamax);
+  else
+    sp->eta = SUNMAX(sp->eta, ETA_MIN_DEFAULT);
+
+  sp->hprime = sp->h * sp->eta;
+}
+
+/*
+ * -----------------------------------------------------------------
+ * Batched Newton iteration
+ * -----------------------------------------------------------------
+ */
+
+/*
+ * cvbNls
+ *
+ * This routine solves the BDF nonlinear systems of all active slots
+ * with a modified Newton iteration, following cvNls, the Newton
+ * SUNNonlinearSolver, and cvNlsConvTest. Every iteration evaluates f
+ * once for the whole batch; slots that converged or failed keep their
+ * result while the others continue. Slots that fail with an outdated
+ * Jacobian are retried once after a batched Jacobian update.
+ *
+ * On return the status of every slot is CV_SUCCESS,
+ * SUN_NLS_CONV_RECVR, or RHSFUNC_RECVR. A negative return value means
+ * an unrecoverable failure of f or the Jacobian function.
+ */
+
+static int cvbNls(CVodeBatchMem cvb_mem)
+{
+  CVodeBatchSys sp;
+  booleantype callSetup, jbad, retried;
+  sunindextype len;
+  int k, nact, niter, retval;
+
+  nact = cvb_mem->nactive;
+  len  = cvb_mem->n * nact;
+
+  /* Decide whether to call the setup routine and to update the Jacobian */
+  callSetup = jbad = SUNFALSE;
+  for (k = 0; k < nact; k++) {
+    sp = SYS(k);
+    callSetup = callSetup || (sp->nflag == PREV_CONV_FAIL) ||
+      (sp->nflag == PREV_ERR_FAIL) || (sp->nst == 0) ||
+      (sp->nst >= sp->nstlp + MSBP_DEFAULT) ||
+      (SUNRabs(sp->gamrat - ONE) > DGMAX_LSETUP_DEFAULT);
+    jbad = jbad || (sp->nst == 0) || (sp->nst >= sp->nstlj + CVLS_MSBJ) ||
+      (sp->nflag == PREV_CONV_FAIL);
+
+    sp->status = SUN_NLS_CONTINUE;
+    sp->reload = SUNFALSE;
+  }
+  memset(cvb_mem->acor, 0, len * sizeof(realtype));
+
+  retried = SUNFALSE;
+  niter   = 0;
+
+  for (;;) {
+
+    /* Evaluate f at the current iterates y = zn[0] + acor */
+    for (k = 0; k < len; k++)
+      cvb_mem->y[k] = cvb_mem->zn[0][k] + cvb_mem->acor[k];
+
+    retval = cvbRhs(cvb_mem, SUNTRUE, cvb_mem->y, cvb_mem->ftemp);
+    if (retval < 0) return(CV_RHSFUNC_FAIL);
+    if (retval > 0) {
+      for (k = 0; k < nact; k++)
+        if (SYS(k)->status == SUN_NLS_CONTINUE) SYS(k)->status = RHSFUNC_RECVR;
+      return(CV_SUCCESS);
+    }
+
+    if (callSetup) {
+      retval = cvbSetup(cvb_mem, jbad);
+      if (retval < 0) return(CV_LSETUP_FAIL);
+      callSetup = SUNFALSE;
+    }
+
+    /* Compute the Newton updates -(rl1*zn[1] + acor - gamma*f) */
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(cvb_mem->nthreads) schedule(static)
+#endif
+    for (k = 0; k < nact; k++) {
+      CVodeBatchSys spk = SYS(k);
+      realtype *b = BLK(cvb_mem->tempv,k), *zn1 = ZN(1,k);
+      realtype *acor = BLK(cvb_mem->acor,k), *fk = BLK(cvb_mem->ftemp,k);
+      sunindextype m;
+      for (m = 0; m < cvb_mem->n; m++)
+        b[m] = spk->gamma * fk[m] - spk->rl1 * zn1[m] - acor[m];
+    }
+
+    cvbSolve(cvb_mem, cvb_mem->tempv);
+
+    /* Update the iterates and test for convergence, see cvNlsConvTest */
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(cvb_mem->nthreads) schedule(static)
+#endif
+    for (k = 0; k < nact; k++) {
+      CVodeBatchSys spk = SYS(k);
+      realtype *b = BLK(cvb_mem->tempv,k), *acor = BLK(cvb_mem->acor,k);
+      realtype del, dcon;
+      sunindextype m;
+
+      if (spk->status != SUN_NLS_CONTINUE) continue;
+
+      /* scale the correction to account for a change in gamma */
+      if (spk->gamrat != ONE)
+        for (m = 0; m < cvb_mem->n; m++) b[m] *= TWO / (ONE + spk->gamrat);
+
+      for (m = 0; m < cvb_mem->n; m++) acor[m] += b[m];
+      spk->nni++;
+
+      del = cvbWrmsNorm(cvb_mem->n, b, BLK(cvb_mem->ewt,k));
+      if (niter > 0) spk->crate = SUNMAX(CRDOWN * spk->crate, del/spk->delp);
+      dcon = del * SUNMIN(ONE, spk->crate) / spk->tq[4];
+
+      if (dcon <= ONE) {
+        spk->acnrm = (niter == 0) ? del :
+          cvbWrmsNorm(cvb_mem->n, acor, BLK(cvb_mem->ewt,k));
+        spk->jcur = SUNFALSE;
+        spk->status = CV_SUCCESS;
+      } else if ( ((niter >= 1) && (del > RDIV*spk->delp)) ||
+                  (niter + 1 == CVB_MAXCOR) ) {
+        spk->status = SUN_NLS_CONV_RECVR;
+      } else {
+        spk->delp = del;
+      }
+    }
+    niter++;
+
+    for (k = 0; k < nact; k++)
+      if (SYS(k)->status == SUN_NLS_CONTINUE) break;
+    if (k < nact) continue;
+
+    /* Retry failed slots once with a new Jacobian if theirs was outdated */
+    if (retried) break;
+    for (k = 0; k < nact; k++) {
+      sp = SYS(k);
+      if ((sp->status == SUN_NLS_CONV_RECVR) && !sp->jcur) {
+        sp->status = SUN_NLS_CONTINUE;
+        memset(BLK(cvb_mem->acor,k), 0, cvb_mem->n * sizeof(realtype));
+        retried = SUNTRUE;
+      }
+    }
+    if (!retried) break;
+
+    callSetup = jbad = SUNTRUE;
+    niter = 0;
+  }
+
+  return(CV_SUCCESS);
+}
+
+/*
+ * cvbSetup
+ *
+ * This routine updates the saved Jacobians of all active slots when
+ * jbad is true, forms M = I - gamma J for every slot, and factors the
+ * matrices. A slot with a singular matrix fails recoverably.
+ */
+
+static int cvbSetup(CVodeBatchMem cvb_mem, booleantype jbad)
+{
+  CVodeBatchSys sp;
+  sunindextype n, nn, ld, e;
+  int k, nact, retval;
+
+  n    = cvb_mem->n;
+  nn   = n * n;
+  ld   = cvb_mem->nsys;
+  nact = cvb_mem->nactive;
+
+  if (jbad) {
+    if (cvb_mem->jac != NULL) {
+      retval = cvb_mem->jac(nact, cvb_mem->sysid, cvb_mem->t, cvb_mem->y,
+                            cvb_mem->ftemp, cvb_mem->J, ld,
+                            cvb_mem->user_data);
+    } else {
+      retval = cvbDQJac(cvb_mem);
+    }
+    cvb_mem->nje++;
+    if (retval < 0) return(-1);
+    if (retval > 0) {
+      for (k = 0; k < nact; k++)
+        if (SYS(k)->status == SUN_NLS_CONTINUE)
+          SYS(k)->status = SUN_NLS_CONV_RECVR;
+      return(1);
+    }
+    for (k = 0; k < nact; k++) {
+      SYS(k)->jcur  = SUNTRUE;
+      SYS(k)->nstlj = SYS(k)->nst;
+    }
+  }
+
+  /* M = I - gamma J */
+  for (k = 0; k < nact; k++) cvb_mem->work[k] = -SYS(k)->gamma;
+  for (e = 0; e < nn; e++) {
+    realtype *Je = cvb_mem->J + e * ld, *Me = cvb_mem->M + e * ld;
+    for (k = 0; k < nact; k++) Me[k] = cvb_mem->work[k] * Je[k];
+  }
+  for (e = 0; e < n; e++) {
+    realtype *Me = cvb_mem->M + (e * n + e) * ld;
+    for (k = 0; k < nact; k++) Me[k] += ONE;
+  }
+
+  cvbFactor(cvb_mem);
+  cvb_mem->nsetups++;
+
+  for (k = 0; k < nact; k++) {
+    sp = SYS(k);
+    sp->gamrat = ONE;
+    sp->gammap = sp->gamma;
+    sp->crate  = ONE;
+    sp->nstlp  = sp->nst;
+    if ((cvb_mem->lufail[k] > 0) && (sp->status == SUN_NLS_CONTINUE))
+      sp->status = SUN_NLS_CONV_RECVR;
+  }
+
+  return(0);
+}
+
+/*
+ * cvbDQJac
+ *
+ * This routine approximates the Jacobians of all active slots at
+ * cvb_mem->y by difference quotients, one batched evaluation of f
+ * per column, with increments chosen as in cvLsDenseDQJac.
+ */
+
+static int cvbDQJac(CVodeBatchMem cvb_mem)
+{
+  CVodeBatchSys sp;
+  sunindextype n, ld, i, j;
+  realtype srur, fnorm, yj, inc, *minInc, *ysave, *Jcol;
+  int k, nact, retval;
+
+  n      = cvb_mem->n;
+  ld     = cvb_mem->nsys;
+  nact   = cvb_mem->nactive;
+  minInc = cvb_mem->work;
+  ysave  = cvb_mem->work + cvb_mem->nsys;
+  srur   = SUNRsqrt(cvb_mem->uround);
+
+  for (k = 0; k < nact; k++) {
+    sp = SYS(k);
+    fnorm = cvbWrmsNorm(n, BLK(cvb_mem->ftemp,k), BLK(cvb_mem->ewt,k));
+    minInc[k] = (fnorm != ZERO) ?
+      (MIN_INC_MULT * SUNRabs(sp->h) * cvb_mem->uround * n * fnorm) : ONE;
+  }
+
+  for (j = 0; j < n; j++) {
+
+    for (k = 0; k < nact; k++) {
+      yj = cvb_mem->y[k*n + j];
+      inc = SUNMAX(srur * SUNRabs(yj), minInc[k] / cvb_mem->ewt[k*n + j]);
+      ysave[k] = yj;
+      cvb_mem->y[k*n + j] += inc;
+    }
+
+    retval = cvbRhs(cvb_mem, SUNTRUE, cvb_mem->y, cvb_mem->tempv);
+
+    for (k = 0; k < nact; k++) {
+      inc = cvb_mem->y[k*n + j] - ysave[k];
+      cvb_mem->y[k*n + j] = ysave[k];
+      for (i = 0; i < n; i++) {
+        Jcol = cvb_mem->J + (j * n + i) * ld;
+        Jcol[k] = (cvb_mem->tempv[k*n + i] - cvb_mem->ftemp[k*n + i]) / inc;
+      }
+    }
+
+    if (retval != 0) return(retval);
+  }
+
+  return(0);
+}
+
+/*
+ * cvbFactor and cvbSolve
+ *
+ * These routines compute and apply the pivoted LU factorization of
+ * the Newton matrices of all active slots with the batched dense
+ * kernels shared with SUNLinSol_BlockDense, with matrix entries
+ * interleaved across slots. cvbSolve copies the right-hand sides
+ * into the interleaved rhs array so that the substitutions run
+ * across the slots with unit stride, and copies the solutions back.
+ */
+
+static void cvbFactor(CVodeBatchMem cvb_mem)
+{
+#ifdef _OPENMP
+#pragma omp parallel num_threads(cvb_mem->nthreads)
+#endif
+  {
+    int k0, k1;
+
+    cvbSlotRange(cvb_mem->nactive, &k0, &k1);
+    sunBatchedDenseGETRF(cvb_mem->M, cvb_mem->n, cvb_mem->nsys, k0, k1,
+                         cvb_mem->pivots, cvb_mem->work, cvb_mem->lufail);
+  }
+}
+
+static void cvbSolve(CVodeBatchMem cvb_mem, realtype *x)
+{
+#ifdef _OPENMP
+#pragma omp parallel num_threads(cvb_mem->nthreads)
+#endif
+  {
+    sunindextype i, n = cvb_mem->n, ld = cvb_mem->nsys;
+    realtype *rhs = cvb_mem->rhs;
+    int k, k0, k1;
+
+    cvbSlotRange(cvb_mem->nactive, &k0, &k1);
+    for (k = k0; k < k1; k++)
+      for (i = 0; i < n; i++)
+        rhs[i*ld + k] = x[k*n + i];
+    sunBatchedDenseGETRS(cvb_mem->M, n, ld, k0, k1, cvb_mem->pivots, rhs);
+    for (k = k0; k < k1; k++)
+      for (i = 0; i < n; i++)
+        x[k*n + i] = rhs[i*ld + k];
+  }
+}
+
+/*
+ * -----------------------------------------------------------------
+ * Batch management
+ * -----------------------------------------------------------------
+ */
+
+/*
+ * cvbReload
+ *
+ * This routine reloads zn[1] = h f(tn, zn[0]) for the slots that
+ * restarted at order 1 after repeated error test failures, with one
+ * batched evaluation of f. A recoverable failure of f ends the
+ * integration of these systems.
+ */
+
+static int cvbReload(CVodeBatchMem cvb_mem)
+{
+  CVodeBatchSys sp;
+  sunindextype m;
+  int k, nact, retval;
+
+  nact = cvb_mem->nactive;
+
+  for (k = 0; k < nact; k++)
+    if (SYS(k)->reload) break;
+  if (k == nact) return(CV_SUCCESS);
+
+  retval = cvbRhs(cvb_mem, SUNTRUE, cvb_mem->zn[0], cvb_mem->tempv);
+  if (retval < 0) return(CV_RHSFUNC_FAIL);
+
+  for (k = 0; k < nact; k++) {
+    sp = SYS(k);
+    if (!sp->reload) continue;
+    sp->reload = SUNFALSE;
+    if (retval > 0) {
+      sp->flag = CV_UNREC_RHSFUNC_ERR;
+      sp->done = SUNTRUE;
+      continue;
+    }
+    for (m = 0; m < cvb_mem->n; m++)
+      ZN(1,k)[m] = sp->h * cvb_mem->tempv[k*cvb_mem->n + m];
+  }
+
+  return(CV_SUCCESS);
+}
+
+/* Mark all active systems as failed with flag, restoring zn first if a
+   step attempt is in progress */
+
+static void cvbFailAll(CVodeBatchMem cvb_mem, int flag, booleantype restore)
+{
+  int k;
+
+  for (k = 0; k < cvb_mem->nactive; k++) {
+    if (SYS(k)->done) continue;
+    if (restore) cvbRestore(cvb_mem, k);
+    SYS(k)->flag = flag;
+    SYS(k)->done = SUNTRUE;
+  }
+}
+
+/* Interpolate the solution of slot k at t, see CVodeGetDky */
+
+static void cvbGetY(CVodeBatchMem cvb_mem, int k, realtype t, realtype *yout)
+{
+  CVodeBatchSys sp = SYS(k);
+  realtype s, *znj;
+  sunindextype m;
+  int j;
+
+  s = (sp->h == ZERO) ? ZERO : (t - sp->tn) / sp->h;
+
+  memcpy(yout, ZN(sp->q,k), cvb_mem->n * sizeof(realtype));
+  for (j = sp->q - 1; j >= 0; j--) {
+    znj = ZN(j,k);
+    for (m = 0; m < cvb_mem->n; m++) yout[m] = s * yout[m] + znj[m];
+  }
+}
+
+/* Move the systems that are done behind the active slots */
+
+static void cvbCompact(CVodeBatchMem cvb_mem)
+{
+  int k = 0;
+
+  while (k < cvb_mem->nactive) {
+    if (SYS(k)->done) {
+      cvbSwapSlots(cvb_mem, k, cvb_mem->nactive - 1);
+      cvb_mem->nactive--;
+    } else {
+      k++;
+    }
+  }
+}
+
+static void cvbSwapBlocks(realtype *va, realtype *vb, sunindextype n)
+{
+  sunindextype m;
+  realtype rtmp;
+
+  for (m = 0; m < n; m++) {
+    rtmp = va[m]; va[m] = vb[m]; vb[m] = rtmp;
+  }
+}
+
+/* Exchange the integrator state, vectors, and matrices of two slots */
+
+static void cvbSwapSlots(CVodeBatchMem cvb_mem, int a, int b)
+{
+  struct CVodeBatchSysRec tmp;
+  sunindextype n, ld, e;
+  realtype rtmp;
+  sunindextype ptmp;
+  int j;
+
+  if (a == b) return;
+
+  n  = cvb_mem->n;
+  ld = cvb_mem->nsys;
+
+  tmp = cvb_mem->sys[a];
+  cvb_mem->sys[a] = cvb_mem->sys[b];
+  cvb_mem->sys[b] = tmp;
+  cvb_mem->slot[cvb_mem->sys[a].sysid] = a;
+  cvb_mem->slot[cvb_mem->sys[b].sysid] = b;
+
+  for (j = 0; j <= CVB_QMAX; j++)
+    cvbSwapBlocks(ZN(j,a), ZN(j,b), n);
+  cvbSwapBlocks(BLK(cvb_mem->ewt,a), BLK(cvb_mem->ewt,b), n);
+  cvbSwapBlocks(BLK(cvb_mem->acor,a), BLK(cvb_mem->acor,b), n);
+
+  for (e = 0; e < n * n; e++) {
+    rtmp = cvb_mem->J[e*ld + a];
+    cvb_mem->J[e*ld + a] = cvb_mem->J[e*ld + b];
+    cvb_mem->J[e*ld + b] = rtmp;
+    rtmp = cvb_mem->M[e*ld + a];
+    cvb_mem->M[e*ld + a] = cvb_mem->M[e*ld + b];
+    cvb_mem->M[e*ld + b] = rtmp;
+  }
+
+  for (e = 0; e < n; e++) {
+    ptmp = cvb_mem->pivots[e*ld + a];
+    cvb_mem->pivots[e*ld + a] = cvb_mem->pivots[e*ld + b];
+    cvb_mem->pivots[e*ld + b] = ptmp;
+  }
+}
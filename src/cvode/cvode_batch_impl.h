@@ -0,0 +1,163 @@
+/* -----------------------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------------------
+ * Implementation header file for the batched CVODE integrator.
+ * ---------------------------------------------------------------------------*/
+
+#ifndef _CVODE_BATCH_IMPL_H
+#define _CVODE_BATCH_IMPL_H
+
+#include "cvode/cvode_batch.h"
+
+#ifdef __cplusplus  /* wrapper to enable C++ usage */
+extern "C" {
+#endif
+
+/* =============================================================================
+ * Batched Integrator Constants
+ *
+ * CVB_QMAX     maximum BDF order
+ * CVB_MAXCOR   maximum number of Newton iterations per step attempt
+ * CVB_NLSCOEF  coefficient in the Newton convergence test
+ * ===========================================================================*/
+
+#define CVB_QMAX    5
+#define CVB_MAXCOR  3
+#define CVB_NLSCOEF RCONST(0.1)
+
+/* =============================================================================
+ * Batched Integrator Data Structures
+ * ===========================================================================*/
+
+/* -----------------------------------------------------------------------------
+ * Types : struct CVodeBatchSysRec, CVodeBatchSys
+ * -----------------------------------------------------------------------------
+ * The integrator state of one system. These records live in the batch slots
+ * and move together with the system's vector and matrix data when the batch
+ * is compacted.
+ * ---------------------------------------------------------------------------*/
+typedef struct CVodeBatchSysRec {
+
+  int sysid;            /* index of the system in the ensemble               */
+
+  /* step data */
+  realtype tn;          /* current internal time                             */
+  realtype saved_t;     /* time to restore to after a failed attempt         */
+  realtype h;           /* current step size                                 */
+  realtype hprime;      /* step size to be used on the next step             */
+  realtype hscale;      /* step size at which zn is scaled                   */
+  realtype hu;          /* last successful step size                         */
+  realtype eta;         /* step size ratio hprime/h                          */
+  realtype etamax;      /* eta <= etamax                                     */
+  int q;                /* current order                                     */
+  int qprime;           /* order to be used on the next step                 */
+  int qu;               /* last successful order                             */
+  int qwait;            /* steps to wait before an order change              */
+  int L;                /* L = q + 1                                         */
+  int indx_acor;        /* zn column holding the saved acor                  */
+
+  /* method coefficients */
+  realtype tau[CVB_QMAX+2];  /* last q+1 successful step sizes               */
+  realtype tq[6];            /* test quantities                              */
+  realtype l[CVB_QMAX+1];    /* coefficients of l(x)                         */
+  realtype rl1;              /* 1/l[1]                                       */
+  realtype gamma;            /* gamma = h*rl1                                */
+  realtype gammap;           /* gamma at the last setup                      */
+  realtype gamrat;           /* gamma/gammap                                 */
+  realtype saved_tq5;        /* tq[5] saved for a possible order increase    */
+
+  /* Newton data */
+  realtype crate;       /* estimated convergence rate                        */
+  realtype delp;        /* norm of the previous Newton correction            */
+  realtype acnrm;       /* WRMS norm of acor                                 */
+  booleantype jcur;     /* is the Jacobian current?                          */
+  long int nstlp;       /* step number of the last setup                     */
+  long int nstlj;       /* step number of the last Jacobian evaluation       */
+
+  /* step attempt status */
+  int nflag;            /* FIRST_CALL, PREV_CONV_FAIL, or PREV_ERR_FAIL      */
+  int status;           /* Newton status in the current attempt              */
+  int ncf;              /* convergence failures in this step                 */
+  int nef;              /* error test failures in this step                  */
+  long int nstcall;     /* steps taken in the current CVodeBatch call        */
+  int flag;             /* return flag of the last CVodeBatch call           */
+  booleantype done;     /* has the system left the active batch?             */
+  booleantype reload;   /* does zn[1] need to be reloaded from f?            */
+
+  /* counters */
+  long int nst;         /* number of steps                                   */
+  long int netf;        /* number of error test failures                     */
+  long int nni;         /* number of Newton iterations                       */
+  long int ncfn;        /* number of Newton convergence failures             */
+
+} *CVodeBatchSys;
+
+/* -----------------------------------------------------------------------------
+ * Types : struct CVodeBatchMemRec, CVodeBatchMem
+ * -----------------------------------------------------------------------------
+ * Vectors hold one contiguous block of n entries per slot and matrices store
+ * entry (i,j) of slot k at (j*n + i)*nsys + k, so that loops over the slots
+ * in the Newton solve have unit stride.
+ * ---------------------------------------------------------------------------*/
+typedef struct CVodeBatchMemRec {
+
+  SUNContext sunctx;
+
+  int nsys;             /* number of systems in the ensemble                 */
+  sunindextype n;       /* size of each system                               */
+  int nactive;          /* systems in the active batch, slots [0, nactive)   */
+  int nthreads;         /* number of OpenMP threads                          */
+
+  CVBatchRhsFn f;       /* right-hand side function                          */
+  CVBatchJacFn jac;     /* Jacobian function (NULL for difference quotients) */
+  void *user_data;      /* user pointer passed to f and jac                  */
+
+  realtype reltol;      /* relative tolerance                                */
+  realtype Sabstol;     /* scalar absolute tolerance                         */
+  realtype *Vabstol;    /* vector absolute tolerance (NULL if scalar)        */
+  booleantype tolset;   /* have tolerances been set?                         */
+
+  int qmax;             /* maximum order                                     */
+  long int mxstep;      /* maximum steps per system per CVodeBatch call      */
+  booleantype firstcall;/* is the next CVodeBatch call the first?            */
+  realtype uround;      /* unit roundoff                                     */
+
+  CVodeBatchSys sys;    /* per-slot integrator state                         */
+  int *slot;            /* slot holding each system                          */
+  int *sysid;           /* system in each active slot                        */
+  realtype *t;          /* time of each active slot                          */
+
+  realtype *zn[CVB_QMAX+1]; /* Nordsieck history arrays                      */
+  realtype *ewt;        /* error weights                                     */
+  realtype *acor;       /* accumulated corrections                           */
+  realtype *y;          /* work array for the current iterate                */
+  realtype *ftemp;      /* right-hand side values                            */
+  realtype *tempv;      /* work array                                        */
+
+  realtype *J;          /* saved Jacobians                                   */
+  realtype *M;          /* LU factors of I - gamma J                         */
+  sunindextype *pivots; /* pivot rows, entry (c, k) at c*nsys + k            */
+  sunindextype *lufail; /* first zero pivot column + 1 of each slot          */
+  realtype *rhs;        /* linear system right-hand sides, entry (i, k) at
+                           i*nsys + k                                        */
+  realtype *work;       /* slot-length work array                            */
+
+  long int nfe;         /* number of batched right-hand side evaluations     */
+  long int nje;         /* number of batched Jacobian evaluations            */
+  long int nsetups;     /* number of batched linear solver setups            */
+
+} *CVodeBatchMem;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
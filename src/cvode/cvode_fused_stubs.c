@@ -12,11 +12,19 @@
  * SPDX-License-Identifier: BSD-3-Clause
  * SUNDIALS Copyright End
  * -----------------------------------------------------------------
- * This file implements fused stub kernels for CVODE.
+ * This file implements fused CPU kernels for CVODE. When all of the
+ * vectors are NVECTOR_SERIAL or NVECTOR_OPENMP vectors, each kernel
+ * makes a single pass over the data (threaded with OpenMP when the
+ * library is built with OpenMP and the vectors are OpenMP vectors).
+ * For any other vector the kernels fall back to the equivalent
+ * sequence of N_Vector operations.
  * -----------------------------------------------------------------
  */
 
 
+#include <nvector/nvector_serial.h>
+#include <nvector/nvector_openmp.h>
+
 #include "cvode_diag_impl.h"
 #include "cvode_impl.h"
 
@@ -26,6 +34,41 @@
 #define ONEPT5 RCONST(1.50)
 #define ONE    RCONST(1.0)
 
+/*
+ * -----------------------------------------------------------------
+ * Check if a vector stores its data in a contiguous host array that
+ * can be accessed directly and return the number of threads to use.
+ * -----------------------------------------------------------------
+ */
+
+static booleantype cvFusedHostVector(N_Vector v, int* nthreads)
+{
+  switch (N_VGetVectorID(v))
+  {
+  case SUNDIALS_NVEC_SERIAL:
+    *nthreads = 1;
+    return SUNTRUE;
+  case SUNDIALS_NVEC_OPENMP:
+    *nthreads = NV_NUM_THREADS_OMP(v);
+    return SUNTRUE;
+  default:
+    *nthreads = 1;
+    return SUNFALSE;
+  }
+}
+
+/* Check that all vectors in a fused kernel are host vectors, the number of
+   threads is taken from the first vector */
+
+static booleantype cvFusedHostVectors(int nvec, N_Vector* V, int* nthreads)
+{
+  int i, nt;
+  if (!cvFusedHostVector(V[0], nthreads)) return SUNFALSE;
+  for (i = 1; i < nvec; i++)
+    if (!cvFusedHostVector(V[i], &nt)) return SUNFALSE;
+  return SUNTRUE;
+}
+
 /*
  * -----------------------------------------------------------------
  * Compute the ewt vector when the tol type is CV_SS.
@@ -39,6 +82,32 @@ int cvEwtSetSS_fused(const booleantype atolmin0,
                      N_Vector tempv,
                      N_Vector weight)
 {
+  sunindextype i, N;
+  int nt;
+  realtype *yd, *td, *wd;
+  N_Vector V[3];
+
+  V[0] = weight; V[1] = ycur; V[2] = tempv;
+  if (cvFusedHostVectors(3, V, &nt))
+  {
+    N  = N_VGetLength(weight);
+    yd = N_VGetArrayPointer(ycur);
+    td = N_VGetArrayPointer(tempv);
+    wd = N_VGetArrayPointer(weight);
+
+    /* The component test is done by the caller on tempv, so weight is
+       computed regardless as in the GPU kernels */
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nt) schedule(static) if(nt > 1)
+#endif
+    for (i = 0; i < N; i++)
+    {
+      td[i] = reltol * SUNRabs(yd[i]) + Sabstol;
+      wd[i] = ONE / td[i];
+    }
+    return 0;
+  }
+
   N_VAbs(ycur, tempv);
   N_VScale(reltol, tempv, tempv);
   N_VAddConst(tempv, Sabstol, tempv);
@@ -63,6 +132,31 @@ int cvEwtSetSV_fused(const booleantype atolmin0,
                      N_Vector tempv,
                      N_Vector weight)
 {
+  sunindextype i, N;
+  int nt;
+  realtype *ad, *yd, *td, *wd;
+  N_Vector V[4];
+
+  V[0] = weight; V[1] = Vabstol; V[2] = ycur; V[3] = tempv;
+  if (cvFusedHostVectors(4, V, &nt))
+  {
+    N  = N_VGetLength(weight);
+    ad = N_VGetArrayPointer(Vabstol);
+    yd = N_VGetArrayPointer(ycur);
+    td = N_VGetArrayPointer(tempv);
+    wd = N_VGetArrayPointer(weight);
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nt) schedule(static) if(nt > 1)
+#endif
+    for (i = 0; i < N; i++)
+    {
+      td[i] = reltol * SUNRabs(yd[i]) + ad[i];
+      wd[i] = ONE / td[i];
+    }
+    return 0;
+  }
+
   N_VAbs(ycur, tempv);
   N_VLinearSum(reltol, tempv, ONE,
                Vabstol, tempv);
@@ -88,6 +182,32 @@ int cvCheckConstraints_fused(const N_Vector c,
                              const N_Vector mm,
                              N_Vector tmp)
 {
+  sunindextype i, N;
+  int nt;
+  realtype a, *cd, *wd, *yd, *md, *td;
+  N_Vector V[5];
+
+  V[0] = c; V[1] = ewt; V[2] = y; V[3] = mm; V[4] = tmp;
+  if (cvFusedHostVectors(5, V, &nt))
+  {
+    N  = N_VGetLength(c);
+    cd = N_VGetArrayPointer(c);
+    wd = N_VGetArrayPointer(ewt);
+    yd = N_VGetArrayPointer(y);
+    md = N_VGetArrayPointer(mm);
+    td = N_VGetArrayPointer(tmp);
+
+#ifdef _OPENMP
+#pragma omp parallel for private(a) num_threads(nt) schedule(static) if(nt > 1)
+#endif
+    for (i = 0; i < N; i++)
+    {
+      a     = (SUNRabs(cd[i]) >= ONEPT5) ? ONE : ZERO;
+      td[i] = (yd[i] - PT1 * (a * cd[i] / wd[i])) * md[i];
+    }
+    return 0;
+  }
+
   N_VCompare(ONEPT5, c, tmp);           /* a[i]=1 when |c[i]|=2  */
   N_VProd(tmp, c, tmp);                 /* a * c                 */
   N_VDiv(tmp, ewt, tmp);                /* a * c * wt            */
@@ -111,6 +231,28 @@ int cvNlsResid_fused(const realtype rl1,
                      const N_Vector ftemp,
                      N_Vector res)
 {
+  sunindextype i, N;
+  int nt;
+  realtype *zd, *yd, *fd, *rd;
+  N_Vector V[4];
+
+  V[0] = res; V[1] = zn1; V[2] = ycor; V[3] = ftemp;
+  if (cvFusedHostVectors(4, V, &nt))
+  {
+    N  = N_VGetLength(res);
+    zd = N_VGetArrayPointer(zn1);
+    yd = N_VGetArrayPointer(ycor);
+    fd = N_VGetArrayPointer(ftemp);
+    rd = N_VGetArrayPointer(res);
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nt) schedule(static) if(nt > 1)
+#endif
+    for (i = 0; i < N; i++)
+      rd[i] = ngamma * fd[i] + (rl1 * zd[i] + yd[i]);
+    return 0;
+  }
+
   N_VLinearSum(rl1, zn1, ONE, ycor, res);
   N_VLinearSum(ngamma, ftemp, ONE, res, res);
   return 0;
@@ -130,6 +272,32 @@ int cvDiagSetup_formY(const realtype h,
                       N_Vector ftemp,
                       N_Vector y)
 {
+  sunindextype i, N;
+  int nt;
+  realtype *fpd, *zd, *ypd, *fd, *yd;
+  N_Vector V[5];
+
+  V[0] = y; V[1] = fpred; V[2] = zn1; V[3] = ypred; V[4] = ftemp;
+  if (cvFusedHostVectors(5, V, &nt))
+  {
+    N   = N_VGetLength(y);
+    fpd = N_VGetArrayPointer(fpred);
+    zd  = N_VGetArrayPointer(zn1);
+    ypd = N_VGetArrayPointer(ypred);
+    fd  = N_VGetArrayPointer(ftemp);
+    yd  = N_VGetArrayPointer(y);
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nt) schedule(static) if(nt > 1)
+#endif
+    for (i = 0; i < N; i++)
+    {
+      fd[i] = h * fpd[i] - zd[i];
+      yd[i] = r * fd[i] + ypd[i];
+    }
+    return 0;
+  }
+
   N_VLinearSum(h, fpred, -ONE, zn1, ftemp);
   N_VLinearSum(r, ftemp, ONE, ypred, y);
   return 0;
@@ -153,6 +321,44 @@ int cvDiagSetup_buildM(const realtype fract,
                        N_Vector y,
                        N_Vector M)
 {
+  sunindextype i, N;
+  int nt;
+  booleantype test;
+  realtype *fd, *fpd, *wd, *bd, *bcd, *yd, *Md;
+  N_Vector V[7];
+
+  V[0] = M; V[1] = ftemp; V[2] = fpred; V[3] = ewt; V[4] = bit;
+  V[5] = bitcomp; V[6] = y;
+  if (cvFusedHostVectors(7, V, &nt))
+  {
+    N   = N_VGetLength(M);
+    fd  = N_VGetArrayPointer(ftemp);
+    fpd = N_VGetArrayPointer(fpred);
+    wd  = N_VGetArrayPointer(ewt);
+    bd  = N_VGetArrayPointer(bit);
+    bcd = N_VGetArrayPointer(bitcomp);
+    yd  = N_VGetArrayPointer(y);
+    Md  = N_VGetArrayPointer(M);
+
+#ifdef _OPENMP
+#pragma omp parallel for private(test) num_threads(nt) schedule(static) if(nt > 1)
+#endif
+    for (i = 0; i < N; i++)
+    {
+      Md[i] = fract * fd[i] - h * (Md[i] - fpd[i]);
+      yd[i] = fd[i] * wd[i];
+
+      /* Protect against deltay_i being at roundoff level */
+      test   = (SUNRabs(yd[i]) > uround);
+      bd[i]  = test ? ONE : ZERO;
+      bcd[i] = test ? ZERO : -ONE;
+
+      yd[i] = fract * fd[i] * bd[i] - bcd[i];
+      Md[i] = Md[i] / yd[i] * bd[i] - bcd[i];
+    }
+    return 0;
+  }
+
   N_VLinearSum(ONE, M, -ONE, fpred, M);
   N_VLinearSum(FRACT, ftemp, -h, M, M);
   N_VProd(ftemp, ewt, y);
@@ -176,6 +382,23 @@ int cvDiagSetup_buildM(const realtype fract,
 
 int cvDiagSolve_updateM(const realtype r, N_Vector M)
 {
+  sunindextype i, N;
+  int nt;
+  realtype *Md;
+
+  if (cvFusedHostVector(M, &nt))
+  {
+    N  = N_VGetLength(M);
+    Md = N_VGetArrayPointer(M);
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nt) schedule(static) if(nt > 1)
+#endif
+    for (i = 0; i < N; i++)
+      Md[i] = r * (ONE / Md[i] - ONE) + ONE;
+    return 0;
+  }
+
   N_VInv(M, M);
   N_VAddConst(M, -ONE, M);
   N_VScale(r, M, M);
@@ -388,6 +388,8 @@ typedef struct CVodeMemRec {
   long int  cv_msbp;         /* max number of steps between lsetip calls */
   realtype  cv_dgmax_lsetup; /* gamma ratio threshold to signal for a linear
                               * solver setup */
+  booleantype cv_forceSetup; /* force a linear solver setup with new
+                              * Jacobian data on the next step */
 
   /*------------
     Saved Values
@@ -476,6 +478,29 @@ typedef struct CVodeMemRec {
 
 } *CVodeMem;
 
+/*
+ * -----------------------------------------------------------------
+ * Type : struct CVStateHeader
+ * -----------------------------------------------------------------
+ * The header at the start of a buffer written by CVodeWriteState.
+ * It identifies the buffer and the configuration of the integrator
+ * that wrote it, which CVodeReadState compares with its own.
+ * -----------------------------------------------------------------
+ */
+
+typedef struct {
+  int magic;          /* CV_STATE_MAGIC                              */
+  int version;        /* buffer layout version                       */
+  int realsize;       /* sizeof(realtype)                            */
+  int lmm;            /* linear multistep method                     */
+  int qmax;           /* maximum order                               */
+  int q;              /* current order                               */
+  int nrtfn;          /* number of root functions                    */
+  int lsdata;         /* are CVLS counters included?                 */
+  int nvec;           /* number of packed vectors                    */
+  sunindextype vlen;  /* bytes per packed vector                     */
+} CVStateHeader;
+
 /*
  * =================================================================
  *     I N T E R F A C E   T O    L I N E A R   S O L V E R S
@@ -704,6 +729,11 @@ void cvRescale(CVodeMem cv_mem);
 #define MSGCV_BAD_CONSTR "Illegal values in constraints vector."
 #define MSGCV_BAD_K "Illegal value for k."
 #define MSGCV_NULL_DKY "dky = NULL illegal."
+#define MSGCV_NULL_TDKY "t = NULL illegal."
+#define MSGCV_BAD_NT "nt < 0 illegal."
+#define MSGCV_NULL_BUF "buf = NULL illegal."
+#define MSGCV_STATE_NO_STEP "The state can only be written after a successful step."
+#define MSGCV_STATE_BAD_BUF "The state buffer does not match the integrator configuration."
 #define MSGCV_BAD_T "Illegal value for t." MSG_TIME_INT
 #define MSGCV_NO_ROOT "Rootfinding was not initialized."
 #define MSGCV_NLS_INIT_FAIL "The nonlinear solver's init routine failed."
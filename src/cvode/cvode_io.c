@@ -1023,7 +1023,8 @@ int CVodeSetUseIntegratorFusedKernels(void *cvode_mem, booleantype onoff)
 #ifdef SUNDIALS_BUILD_PACKAGE_FUSED_KERNELS
   id = N_VGetVectorID(cv_mem->cv_ewt);
   if (!cv_mem->cv_MallocDone ||
-      (id != SUNDIALS_NVEC_CUDA && id != SUNDIALS_NVEC_HIP)) {
+      (id != SUNDIALS_NVEC_CUDA && id != SUNDIALS_NVEC_HIP &&
+       id != SUNDIALS_NVEC_SERIAL && id != SUNDIALS_NVEC_OPENMP)) {
     cvProcessError(cv_mem, CV_ILL_INPUT, "CVODE",
                    "CVodeSetUseIntegratorFusedKernels",
                    "Fused Kernels not supported for the provided vector");
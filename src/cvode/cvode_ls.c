@@ -23,6 +23,7 @@
 #include "cvode_ls_impl.h"
 #include <sundials/sundials_math.h>
 #include <sunmatrix/sunmatrix_band.h>
+#include <sunmatrix/sunmatrix_blockdense.h>
 #include <sunmatrix/sunmatrix_dense.h>
 #include <sunmatrix/sunmatrix_sparse.h>
 
@@ -43,6 +44,9 @@ static int cvLsLinSys(realtype t, N_Vector y, N_Vector fy, SUNMatrix A,
                       void *user_data, N_Vector tmp1, N_Vector tmp2,
                       N_Vector tmp3);
 
+static int cvLsSparseDQColoring(CVLsMem cvls_mem, SUNMatrix S);
+static void cvLsFreeSparseDQ(CVLsMem cvls_mem);
+
 /*===============================================================
   CVLS Exported functions -- Required
   ===============================================================*/
@@ -195,6 +199,7 @@ int CVodeSetLinearSolver(void *cvode_mem, SUNLinearSolver LS,
   cvls_mem->jbad       = SUNTRUE;
   cvls_mem->dgmax_jbad = CVLS_DGMAX;
   cvls_mem->eplifac    = CVLS_EPLIN;
+  cvls_mem->eplmax     = CVLS_EPLMX;
   cvls_mem->last_flag  = CVLS_SUCCESS;
 
   /* If LS supports ATimes, attach CVLs routine */
@@ -306,6 +311,58 @@ int CVodeSetJacFn(void *cvode_mem, CVLsJacFn jac)
 }
 
 
+/* CVodeSetJacSparsityPattern specifies the sparsity pattern of the
+   Jacobian for the internal difference quotient approximation with a
+   SUNMATRIX_SPARSE matrix. The pattern is copied and the columns are
+   colored so that columns that do not share a row are perturbed with
+   the same f evaluation. Passing NULL removes the pattern. */
+int CVodeSetJacSparsityPattern(void *cvode_mem, SUNMatrix S)
+{
+  CVodeMem cv_mem;
+  CVLsMem  cvls_mem;
+  int      retval;
+
+  /* access CVLsMem structure */
+  retval = cvLs_AccessLMem(cvode_mem, "CVodeSetJacSparsityPattern",
+                           &cv_mem, &cvls_mem);
+  if (retval != CVLS_SUCCESS)  return(retval);
+
+  /* remove any existing pattern */
+  cvLsFreeSparseDQ(cvls_mem);
+  if (S == NULL)  return(CVLS_SUCCESS);
+
+  /* the pattern must match the sparse system matrix */
+  if ((cvls_mem->A == NULL) || (cvls_mem->A->ops->getid == NULL) ||
+      (SUNMatGetID(cvls_mem->A) != SUNMATRIX_SPARSE)) {
+    cvProcessError(cv_mem, CVLS_ILL_INPUT, "CVLS",
+                   "CVodeSetJacSparsityPattern",
+                   "A sparsity pattern requires a SUNMATRIX_SPARSE system matrix");
+    return(CVLS_ILL_INPUT);
+  }
+  if ((S->ops->getid == NULL) || (SUNMatGetID(S) != SUNMATRIX_SPARSE) ||
+      (SUNSparseMatrix_SparseType(S) !=
+       SUNSparseMatrix_SparseType(cvls_mem->A)) ||
+      (SUNSparseMatrix_Rows(S) != SUNSparseMatrix_Rows(cvls_mem->A)) ||
+      (SUNSparseMatrix_Columns(S) != SUNSparseMatrix_Columns(cvls_mem->A))) {
+    cvProcessError(cv_mem, CVLS_ILL_INPUT, "CVLS",
+                   "CVodeSetJacSparsityPattern",
+                   "The sparsity pattern is incompatible with the system matrix");
+    return(CVLS_ILL_INPUT);
+  }
+
+  /* copy the pattern and color the columns */
+  retval = cvLsSparseDQColoring(cvls_mem, S);
+  if (retval) {
+    cvLsFreeSparseDQ(cvls_mem);
+    cvProcessError(cv_mem, CVLS_MEM_FAIL, "CVLS",
+                   "CVodeSetJacSparsityPattern", MSG_LS_MEM_FAIL);
+    return(CVLS_MEM_FAIL);
+  }
+
+  return(CVLS_SUCCESS);
+}
+
+
 /* CVodeSetDeltaGammaMaxBadJac specifies the maximum gamma ratio change
  * after a NLS convergence failure with a potentially bad Jacobian. If
  * |gamma/gammap-1| < dgmax_jbad then the Jacobian is marked as bad */
@@ -355,6 +412,32 @@ int CVodeSetEpsLin(void *cvode_mem, realtype eplifac)
 }
 
 
+/* CVodeSetEpsLinMax specifies the maximum nonlinear -> linear tolerance
+   scale factor used when relaxing the tolerance by a forcing term */
+int CVodeSetEpsLinMax(void *cvode_mem, realtype eplmax)
+{
+  CVodeMem cv_mem;
+  CVLsMem  cvls_mem;
+  int      retval;
+
+  /* access CVLsMem structure */
+  retval = cvLs_AccessLMem(cvode_mem, "CVodeSetEpsLinMax",
+                           &cv_mem, &cvls_mem);
+  if (retval != CVLS_SUCCESS)  return(retval);
+
+  /* Check for legal eplmax */
+  if(eplmax < ZERO) {
+    cvProcessError(cv_mem, CVLS_ILL_INPUT, "CVLS",
+                   "CVodeSetEpsLinMax", MSG_LS_BAD_EPLMAX);
+    return(CVLS_ILL_INPUT);
+  }
+
+  cvls_mem->eplmax = (eplmax == ZERO) ? CVLS_EPLMX : eplmax;
+
+  return(CVLS_SUCCESS);
+}
+
+
 /* CVodeSetLSNormFactor sets or computes the factor to use when converting from
    the integrator tolerance to the linear solver tolerance (WRMS to L2 norm). */
 int CVodeSetLSNormFactor(void *cvode_mem, realtype nrmfac)
@@ -693,6 +776,24 @@ int CVodeGetNumJacEvals(void *cvode_mem, long int *njevals)
 }
 
 
+/* CVodeGetNumJacColors returns the number of column colors (and f
+   evaluations per Jacobian) used by the sparse difference quotient
+   Jacobian approximation */
+int CVodeGetNumJacColors(void *cvode_mem, long int *ncolors)
+{
+  CVodeMem cv_mem;
+  CVLsMem  cvls_mem;
+  int      retval;
+
+  /* access CVLsMem structure; set output value and return */
+  retval = cvLs_AccessLMem(cvode_mem, "CVodeGetNumJacColors",
+                           &cv_mem, &cvls_mem);
+  if (retval != CVLS_SUCCESS)  return(retval);
+  *ncolors = (long int) cvls_mem->dqncolors;
+  return(CVLS_SUCCESS);
+}
+
+
 /* CVodeGetNumLinRhsEvals returns the number of calls to the ODE
    function needed for the DQ Jacobian approximation or J*v product
    approximation */
@@ -1009,7 +1110,7 @@ int cvLsPSolve(void *cvode_mem, N_Vector r, N_Vector z, realtype tol, int lr)
 /*-----------------------------------------------------------------
   cvLsDQJac
 
-  This routine is a wrapper for the Dense and Band
+  This routine is a wrapper for the Dense, Band, and Sparse
   implementations of the difference quotient Jacobian
   approximation routines.
   ---------------------------------------------------------------*/
@@ -1053,6 +1154,10 @@ int cvLsDQJac(realtype t, N_Vector y, N_Vector fy,
     retval = cvLsDenseDQJac(t, y, fy, Jac, cv_mem, tmp1);
   } else if (SUNMatGetID(Jac) == SUNMATRIX_BAND) {
     retval = cvLsBandDQJac(t, y, fy, Jac, cv_mem, tmp1, tmp2);
+  } else if (SUNMatGetID(Jac) == SUNMATRIX_BLOCKDENSE) {
+    retval = cvLsBlockDenseDQJac(t, y, fy, Jac, cv_mem, tmp1, tmp2);
+  } else if (SUNMatGetID(Jac) == SUNMATRIX_SPARSE) {
+    retval = cvLsSparseDQJac(t, y, fy, Jac, cv_mem, tmp1, tmp2);
   } else {
     cvProcessError(cv_mem, CVLS_ILL_INPUT, "CVLS", "cvLsDQJac",
                    "unrecognized matrix type for cvLsDQJac");
@@ -1254,6 +1359,242 @@ int cvLsBandDQJac(realtype t, N_Vector y, N_Vector fy, SUNMatrix Jac,
 }
 
 
+/*-----------------------------------------------------------------
+  cvLsBlockDenseDQJac
+
+  This routine generates a block-diagonal difference quotient
+  approximation to the Jacobian of f(t,y). It assumes a
+  SUNMATRIX_BLOCKDENSE matrix with nblocks uncoupled blocks of size
+  M, so column j of every block is perturbed at the same time and
+  only M calls to f are needed. The elements are loaded with the
+  SM_ELEMENT_BD macro.
+  -----------------------------------------------------------------*/
+int cvLsBlockDenseDQJac(realtype t, N_Vector y, N_Vector fy, SUNMatrix Jac,
+                        CVodeMem cv_mem, N_Vector tmp1, N_Vector tmp2)
+{
+  N_Vector ftemp, ytemp;
+  realtype fnorm, minInc, inc, inc_inv, srur, conj;
+  realtype *ewt_data, *fy_data, *ftemp_data;
+  realtype *y_data, *ytemp_data, *cns_data;
+  sunindextype i, j, k, jk, N, M, nblocks;
+  CVLsMem cvls_mem;
+  int retval = 0;
+
+  /* initialize cns_data to avoid compiler warning */
+  cns_data = NULL;
+
+  /* access LsMem interface structure */
+  cvls_mem = (CVLsMem) cv_mem->cv_lmem;
+
+  /* access matrix dimensions */
+  N = SUNBlockDenseMatrix_Columns(Jac);
+  M = SUNBlockDenseMatrix_BlockRows(Jac);
+  nblocks = SUNBlockDenseMatrix_NumBlocks(Jac);
+
+  /* Rename work vectors for use as temporary values of y and f */
+  ftemp = tmp1;
+  ytemp = tmp2;
+
+  /* Obtain pointers to the data for ewt, fy, ftemp, y, ytemp */
+  ewt_data   = N_VGetArrayPointer(cv_mem->cv_ewt);
+  fy_data    = N_VGetArrayPointer(fy);
+  ftemp_data = N_VGetArrayPointer(ftemp);
+  y_data     = N_VGetArrayPointer(y);
+  ytemp_data = N_VGetArrayPointer(ytemp);
+  if (cv_mem->cv_constraintsSet)
+    cns_data = N_VGetArrayPointer(cv_mem->cv_constraints);
+
+  /* Load ytemp with y = predicted y vector */
+  N_VScale(ONE, y, ytemp);
+
+  /* Set minimum increment based on uround and norm of f */
+  srur = SUNRsqrt(cv_mem->cv_uround);
+  fnorm = N_VWrmsNorm(fy, cv_mem->cv_ewt);
+  minInc = (fnorm != ZERO) ?
+    (MIN_INC_MULT * SUNRabs(cv_mem->cv_h) * cv_mem->cv_uround * N * fnorm) : ONE;
+
+  /* Loop over the columns of a block */
+  for (j=0; j < M; j++) {
+
+    /* Increment y_j in all blocks */
+    for (k=0; k < nblocks; k++) {
+      jk = k*M + j;
+      inc = SUNMAX(srur*SUNRabs(y_data[jk]), minInc/ewt_data[jk]);
+
+      /* Adjust sign(inc) if yj has an inequality constraint. */
+      if (cv_mem->cv_constraintsSet) {
+        conj = cns_data[jk];
+        if (SUNRabs(conj) == ONE)      {if ((ytemp_data[jk]+inc)*conj < ZERO)  inc = -inc;}
+        else if (SUNRabs(conj) == TWO) {if ((ytemp_data[jk]+inc)*conj <= ZERO) inc = -inc;}
+      }
+
+      ytemp_data[jk] += inc;
+    }
+
+    /* Evaluate f with incremented y */
+    retval = cv_mem->cv_f(cv_mem->cv_tn, ytemp, ftemp, cv_mem->cv_user_data);
+    cvls_mem->nfeDQ++;
+    if (retval != 0) break;
+
+    /* Restore ytemp, then form and load difference quotients */
+    for (k=0; k < nblocks; k++) {
+      jk = k*M + j;
+      ytemp_data[jk] = y_data[jk];
+      inc = SUNMAX(srur*SUNRabs(y_data[jk]), minInc/ewt_data[jk]);
+
+      /* Adjust sign(inc) as before. */
+      if (cv_mem->cv_constraintsSet) {
+        conj = cns_data[jk];
+        if (SUNRabs(conj) == ONE)      {if ((ytemp_data[jk]+inc)*conj < ZERO)  inc = -inc;}
+        else if (SUNRabs(conj) == TWO) {if ((ytemp_data[jk]+inc)*conj <= ZERO) inc = -inc;}
+      }
+
+      inc_inv = ONE/inc;
+      for (i=0; i < M; i++)
+        SM_ELEMENT_BD(Jac,k,i,j) = inc_inv * (ftemp_data[k*M+i] - fy_data[k*M+i]);
+    }
+  }
+
+  return(retval);
+}
+
+
+/*-----------------------------------------------------------------
+  cvLsSparseDQJac
+
+  This routine generates a sparse difference quotient approximation
+  to the Jacobian of f(t,y) using the sparsity pattern and column
+  coloring set by CVodeSetJacSparsityPattern. The pattern is loaded
+  into the CSC or CSR SUNMatrix and all columns of the same color,
+  which do not share any rows, are incremented together so that one
+  evaluation of f is needed for each color. The location of each
+  column entry in the matrix storage is precomputed so both sparse
+  formats are filled the same way.
+  -----------------------------------------------------------------*/
+int cvLsSparseDQJac(realtype t, N_Vector y, N_Vector fy,
+                    SUNMatrix Jac, CVodeMem cv_mem, N_Vector tmp1,
+                    N_Vector tmp2)
+{
+  N_Vector ftemp, ytemp;
+  realtype fnorm, minInc, inc, inc_inv, srur, conj;
+  realtype *J_data, *ewt_data, *fy_data, *ftemp_data;
+  realtype *y_data, *ytemp_data, *cns_data;
+  sunindextype color, i, j, k, c, N;
+  sunindextype *colptrs, *rowvals, *pos, *colorptrs, *colorcols;
+  CVLsMem cvls_mem;
+  int retval = 0;
+
+  /* initialize cns_data to avoid compiler warning */
+  cns_data = NULL;
+
+  /* access LsMem interface structure */
+  cvls_mem = (CVLsMem) cv_mem->cv_lmem;
+
+  /* check for a compatible sparsity pattern */
+  if (cvls_mem->dqcolorcols == NULL) {
+    cvProcessError(cv_mem, CVLS_ILL_INPUT, "CVLS", "cvLsSparseDQJac",
+                   MSG_LS_NO_SPARSITY);
+    return(CVLS_ILL_INPUT);
+  }
+  if ((SUNSparseMatrix_SparseType(Jac) != cvls_mem->dqsparsetype) ||
+      (SUNSparseMatrix_Columns(Jac) != cvls_mem->dqN) ||
+      (SUNSparseMatrix_Rows(Jac) != cvls_mem->dqN)) {
+    cvProcessError(cv_mem, CVLS_ILL_INPUT, "CVLS", "cvLsSparseDQJac",
+                   "The sparsity pattern is incompatible with the Jacobian matrix");
+    return(CVLS_ILL_INPUT);
+  }
+
+  /* Load the sparsity pattern into Jac */
+  N = cvls_mem->dqN;
+  if (SUNSparseMatrix_NNZ(Jac) < cvls_mem->dqnnz) {
+    if (SUNSparseMatrix_Reallocate(Jac, cvls_mem->dqnnz)) {
+      cvProcessError(cv_mem, CVLS_MEM_FAIL, "CVLS", "cvLsSparseDQJac",
+                     MSG_LS_MEM_FAIL);
+      return(CVLS_MEM_FAIL);
+    }
+  }
+  memcpy(SUNSparseMatrix_IndexPointers(Jac), cvls_mem->dqindexptrs,
+         (N+1)*sizeof(sunindextype));
+  memcpy(SUNSparseMatrix_IndexValues(Jac), cvls_mem->dqindexvals,
+         cvls_mem->dqnnz*sizeof(sunindextype));
+
+  /* Rename work vectors for use as temporary values of y and f */
+  ftemp = tmp1;
+  ytemp = tmp2;
+
+  /* Obtain pointers to the data for J, ewt, fy, ftemp, y, ytemp */
+  J_data     = SUNSparseMatrix_Data(Jac);
+  ewt_data   = N_VGetArrayPointer(cv_mem->cv_ewt);
+  fy_data    = N_VGetArrayPointer(fy);
+  ftemp_data = N_VGetArrayPointer(ftemp);
+  y_data     = N_VGetArrayPointer(y);
+  ytemp_data = N_VGetArrayPointer(ytemp);
+  if (cv_mem->cv_constraintsSet)
+    cns_data = N_VGetArrayPointer(cv_mem->cv_constraints);
+
+  colptrs   = cvls_mem->dqcolptrs;
+  rowvals   = cvls_mem->dqrowvals;
+  pos       = cvls_mem->dqpos;
+  colorptrs = cvls_mem->dqcolorptrs;
+  colorcols = cvls_mem->dqcolorcols;
+
+  /* Load ytemp with y = predicted y vector */
+  N_VScale(ONE, y, ytemp);
+
+  /* Set minimum increment based on uround and norm of f */
+  srur = SUNRsqrt(cv_mem->cv_uround);
+  fnorm = N_VWrmsNorm(fy, cv_mem->cv_ewt);
+  minInc = (fnorm != ZERO) ?
+    (MIN_INC_MULT * SUNRabs(cv_mem->cv_h) * cv_mem->cv_uround * N * fnorm) : ONE;
+
+  /* Loop over column colors. */
+  for (color = 0; color < cvls_mem->dqncolors; color++) {
+
+    /* Increment all y_j with this color */
+    for (c = colorptrs[color]; c < colorptrs[color+1]; c++) {
+      j = colorcols[c];
+      inc = SUNMAX(srur*SUNRabs(y_data[j]), minInc/ewt_data[j]);
+
+      /* Adjust sign(inc) if yj has an inequality constraint. */
+      if (cv_mem->cv_constraintsSet) {
+        conj = cns_data[j];
+        if (SUNRabs(conj) == ONE)      {if ((ytemp_data[j]+inc)*conj < ZERO)  inc = -inc;}
+        else if (SUNRabs(conj) == TWO) {if ((ytemp_data[j]+inc)*conj <= ZERO) inc = -inc;}
+      }
+
+      ytemp_data[j] += inc;
+    }
+
+    /* Evaluate f with incremented y */
+    retval = cv_mem->cv_f(t, ytemp, ftemp, cv_mem->cv_user_data);
+    cvls_mem->nfeDQ++;
+    if (retval != 0) break;
+
+    /* Restore ytemp, then form and load difference quotients */
+    for (c = colorptrs[color]; c < colorptrs[color+1]; c++) {
+      j = colorcols[c];
+      ytemp_data[j] = y_data[j];
+      inc = SUNMAX(srur*SUNRabs(y_data[j]), minInc/ewt_data[j]);
+
+      /* Adjust sign(inc) as before. */
+      if (cv_mem->cv_constraintsSet) {
+        conj = cns_data[j];
+        if (SUNRabs(conj) == ONE)      {if ((ytemp_data[j]+inc)*conj < ZERO)  inc = -inc;}
+        else if (SUNRabs(conj) == TWO) {if ((ytemp_data[j]+inc)*conj <= ZERO) inc = -inc;}
+      }
+
+      inc_inv = ONE/inc;
+      for (k = colptrs[j]; k < colptrs[j+1]; k++) {
+        i = rowvals[k];
+        J_data[pos[k]] = inc_inv * (ftemp_data[i] - fy_data[i]);
+      }
+    }
+  }
+
+  return(retval);
+}
+
+
 /*-----------------------------------------------------------------
   cvLsDQJtimes
 
@@ -1431,13 +1772,23 @@ int cvLsInitialize(CVodeMem cv_mem)
       /* Check if an internal or user-supplied Jacobian function is used */
       if (cvls_mem->jacDQ) {
 
-        /* Internal difference quotient Jacobian. Check that A is dense or band,
-           otherwise return an error */
+        /* Internal difference quotient Jacobian. Check that A is dense, band,
+           or sparse with a sparsity pattern, otherwise return an error */
         retval = 0;
         if (cvls_mem->A->ops->getid) {
 
           if ( (SUNMatGetID(cvls_mem->A) == SUNMATRIX_DENSE) ||
-               (SUNMatGetID(cvls_mem->A) == SUNMATRIX_BAND) ) {
+               (SUNMatGetID(cvls_mem->A) == SUNMATRIX_BAND) ||
+               (SUNMatGetID(cvls_mem->A) == SUNMATRIX_BLOCKDENSE) ) {
+            cvls_mem->jac    = cvLsDQJac;
+            cvls_mem->J_data = cv_mem;
+          } else if (SUNMatGetID(cvls_mem->A) == SUNMATRIX_SPARSE) {
+            if (cvls_mem->dqcolorcols == NULL) {
+              cvProcessError(cv_mem, CVLS_ILL_INPUT, "CVLS", "cvLsInitialize",
+                             MSG_LS_NO_SPARSITY);
+              cvls_mem->last_flag = CVLS_ILL_INPUT;
+              return(CVLS_ILL_INPUT);
+            }
             cvls_mem->jac    = cvLsDQJac;
             cvls_mem->J_data = cv_mem;
           } else {
@@ -1637,7 +1988,7 @@ int cvLsSolve(CVodeMem cv_mem, N_Vector b, N_Vector weight,
 {
   CVLsMem  cvls_mem;
   realtype bnorm = ZERO;
-  realtype deltar, delta, w_mean;
+  realtype deltar, delta, w_mean, eta;
   int      curiter, nli_inc, retval;
 #if SUNDIALS_LOGGING_LEVEL >= SUNDIALS_LOGGING_DEBUG
   realtype resnorm;
@@ -1652,8 +2003,11 @@ int cvLsSolve(CVodeMem cv_mem, N_Vector b, N_Vector weight,
   }
   cvls_mem = (CVLsMem) cv_mem->cv_lmem;
 
-  /* get current nonlinear solver iteration */
+  /* get current nonlinear solver iteration and forcing term */
   retval = SUNNonlinSolGetCurIter(cv_mem->NLS, &curiter);
+  if (retval != SUN_NLS_SUCCESS) return(-1);
+  retval = SUNNonlinSolGetForcingTerm(cv_mem->NLS, &eta);
+  if (retval != SUN_NLS_SUCCESS) return(-1);
 
   /* If the linear solver is iterative:
      test norm(b), if small, return x = 0 or x = b;
@@ -1666,8 +2020,13 @@ int cvLsSolve(CVodeMem cv_mem, N_Vector b, N_Vector weight,
       cvls_mem->last_flag = CVLS_SUCCESS;
       return(cvls_mem->last_flag);
     }
+    /* Relax the tolerance to the nonlinear solver forcing term (if any),
+       but never beyond eplmax times the nonlinear tolerance as the
+       Newton convergence test is applied to the (inexact) correction */
+    delta = SUNMAX(deltar, SUNMIN(eta * bnorm,
+                                  cvls_mem->eplmax * cv_mem->cv_tq[4]));
     /* Adjust tolerance for 2-norm */
-    delta = deltar * cvls_mem->nrmfac;
+    delta = delta * cvls_mem->nrmfac;
   } else {
     delta = ZERO;
   }
@@ -1852,6 +2211,9 @@ int cvLsFree(CVodeMem cv_mem)
     cvls_mem->savedJ = NULL;
   }
 
+  /* Free sparse difference quotient Jacobian memory */
+  cvLsFreeSparseDQ(cvls_mem);
+
   /* Nullify other N_Vector pointers */
   cvls_mem->ycur = NULL;
   cvls_mem->fcur = NULL;
@@ -1915,6 +2277,158 @@ int cvLs_AccessLMem(void* cvode_mem, const char *fname,
 }
 
 
+/*-----------------------------------------------------------------
+  cvLsSparseDQColoring
+
+  This routine copies the sparsity pattern of S and partitions its
+  columns into groups (colors) such that no two columns in a group
+  have a nonzero in the same row, i.e., a greedy distance-2 coloring
+  of the column intersection graph in the spirit of Curtis, Powell,
+  and Reid. Columns are colored in order of decreasing number of
+  nonzeros (largest-first) and each column receives the smallest
+  color not used by a column sharing one of its rows.
+  -----------------------------------------------------------------*/
+static int cvLsSparseDQColoring(CVLsMem cvls_mem, SUNMatrix S)
+{
+  sunindextype N, NP, nnz, i, j, k, l, p, c, maxcount;
+  sunindextype *indexptrs, *indexvals, *rowptrs, *colvals;
+  sunindextype *order, *color, *mark, *count;
+  int csc;
+
+  N         = SUNSparseMatrix_Columns(S);
+  NP        = SUNSparseMatrix_NP(S);
+  indexptrs = SUNSparseMatrix_IndexPointers(S);
+  indexvals = SUNSparseMatrix_IndexValues(S);
+  nnz       = indexptrs[NP];
+  csc       = (SUNSparseMatrix_SparseType(S) == CSC_MAT);
+
+  cvls_mem->dqsparsetype = SUNSparseMatrix_SparseType(S);
+  cvls_mem->dqN          = N;
+  cvls_mem->dqnnz        = nnz;
+
+  /* Allocate pattern, column structure, and coloring arrays */
+  cvls_mem->dqindexptrs = (sunindextype*) malloc((NP+1)*sizeof(sunindextype));
+  cvls_mem->dqindexvals = (sunindextype*) malloc(nnz*sizeof(sunindextype));
+  cvls_mem->dqcolptrs   = (sunindextype*) malloc((N+1)*sizeof(sunindextype));
+  cvls_mem->dqrowvals   = (sunindextype*) malloc(nnz*sizeof(sunindextype));
+  cvls_mem->dqpos       = (sunindextype*) malloc(nnz*sizeof(sunindextype));
+  cvls_mem->dqcolorptrs = (sunindextype*) malloc((N+1)*sizeof(sunindextype));
+  cvls_mem->dqcolorcols = (sunindextype*) malloc(N*sizeof(sunindextype));
+
+  /* Work arrays */
+  rowptrs = (sunindextype*) malloc((N+1)*sizeof(sunindextype));
+  colvals = (sunindextype*) malloc(nnz*sizeof(sunindextype));
+  order   = (sunindextype*) malloc(N*sizeof(sunindextype));
+  color   = (sunindextype*) malloc(N*sizeof(sunindextype));
+  mark    = (sunindextype*) malloc(N*sizeof(sunindextype));
+  count   = (sunindextype*) malloc((N+1)*sizeof(sunindextype));
+
+  if (!cvls_mem->dqindexptrs || !cvls_mem->dqindexvals ||
+      !cvls_mem->dqcolptrs || !cvls_mem->dqrowvals || !cvls_mem->dqpos ||
+      !cvls_mem->dqcolorptrs || !cvls_mem->dqcolorcols || !rowptrs ||
+      !colvals || !order || !color || !mark || !count) {
+    free(rowptrs); free(colvals); free(order);
+    free(color); free(mark); free(count);
+    return(-1);
+  }
+
+  memcpy(cvls_mem->dqindexptrs, indexptrs, (NP+1)*sizeof(sunindextype));
+  memcpy(cvls_mem->dqindexvals, indexvals, nnz*sizeof(sunindextype));
+
+  /* Build the column (CSC) and row (CSR) structure of the pattern. For a
+     CSC pattern the column structure is the pattern itself, for a CSR
+     pattern it is the transpose, and vice versa for the row structure. */
+  {
+    sunindextype *optrs = csc ? cvls_mem->dqcolptrs : rowptrs;
+    sunindextype *ovals = csc ? cvls_mem->dqrowvals : colvals;
+    sunindextype *tptrs = csc ? rowptrs : cvls_mem->dqcolptrs;
+    sunindextype *tvals = csc ? colvals : cvls_mem->dqrowvals;
+
+    for (p = 0; p <= N; p++) optrs[p] = indexptrs[p];
+    for (k = 0; k < nnz; k++) ovals[k] = indexvals[k];
+
+    for (p = 0; p <= N; p++) tptrs[p] = 0;
+    for (k = 0; k < nnz; k++) tptrs[indexvals[k]+1]++;
+    for (p = 0; p < N; p++) tptrs[p+1] += tptrs[p];
+    for (p = 0; p < N; p++) mark[p] = tptrs[p];
+    for (p = 0; p < N; p++) {
+      for (k = indexptrs[p]; k < indexptrs[p+1]; k++) {
+        l = mark[indexvals[k]]++;
+        tvals[l] = p;
+        if (!csc) cvls_mem->dqpos[l] = k;
+      }
+    }
+    if (csc) {
+      for (k = 0; k < nnz; k++) cvls_mem->dqpos[k] = k;
+    }
+  }
+
+  /* Order the columns by decreasing number of nonzeros (counting sort) */
+  maxcount = 0;
+  for (j = 0; j < N; j++)
+    maxcount = SUNMAX(maxcount,
+                      cvls_mem->dqcolptrs[j+1] - cvls_mem->dqcolptrs[j]);
+  for (c = 0; c <= N; c++) count[c] = 0;
+  for (j = 0; j < N; j++)
+    count[maxcount - (cvls_mem->dqcolptrs[j+1] - cvls_mem->dqcolptrs[j])]++;
+  for (c = 0, k = 0; c <= N; c++) { l = count[c]; count[c] = k; k += l; }
+  for (j = 0; j < N; j++)
+    order[count[maxcount - (cvls_mem->dqcolptrs[j+1] -
+                            cvls_mem->dqcolptrs[j])]++] = j;
+
+  /* Greedy coloring, mark[c] == j if color c is used by a neighbor of j */
+  for (j = 0; j < N; j++) { color[j] = -1; mark[j] = -1; }
+  cvls_mem->dqncolors = 0;
+  for (p = 0; p < N; p++) {
+    j = order[p];
+    for (k = cvls_mem->dqcolptrs[j]; k < cvls_mem->dqcolptrs[j+1]; k++) {
+      i = cvls_mem->dqrowvals[k];
+      for (l = rowptrs[i]; l < rowptrs[i+1]; l++) {
+        c = color[colvals[l]];
+        if (c >= 0) mark[c] = j;
+      }
+    }
+    for (c = 0; mark[c] == j; c++) ;
+    color[j] = c;
+    cvls_mem->dqncolors = SUNMAX(cvls_mem->dqncolors, c+1);
+  }
+
+  /* Group the columns by color */
+  for (c = 0; c <= cvls_mem->dqncolors; c++) cvls_mem->dqcolorptrs[c] = 0;
+  for (j = 0; j < N; j++) cvls_mem->dqcolorptrs[color[j]+1]++;
+  for (c = 0; c < cvls_mem->dqncolors; c++)
+    cvls_mem->dqcolorptrs[c+1] += cvls_mem->dqcolorptrs[c];
+  for (c = 0; c < cvls_mem->dqncolors; c++) mark[c] = cvls_mem->dqcolorptrs[c];
+  for (j = 0; j < N; j++) cvls_mem->dqcolorcols[mark[color[j]]++] = j;
+
+  free(rowptrs); free(colvals); free(order);
+  free(color); free(mark); free(count);
+
+  return(0);
+}
+
+
+/*-----------------------------------------------------------------
+  cvLsFreeSparseDQ
+
+  This routine frees the sparsity pattern and coloring used by the
+  sparse difference quotient Jacobian approximation.
+  -----------------------------------------------------------------*/
+static void cvLsFreeSparseDQ(CVLsMem cvls_mem)
+{
+  free(cvls_mem->dqindexptrs); cvls_mem->dqindexptrs = NULL;
+  free(cvls_mem->dqindexvals); cvls_mem->dqindexvals = NULL;
+  free(cvls_mem->dqcolptrs);   cvls_mem->dqcolptrs   = NULL;
+  free(cvls_mem->dqrowvals);   cvls_mem->dqrowvals   = NULL;
+  free(cvls_mem->dqpos);       cvls_mem->dqpos       = NULL;
+  free(cvls_mem->dqcolorptrs); cvls_mem->dqcolorptrs = NULL;
+  free(cvls_mem->dqcolorcols); cvls_mem->dqcolorcols = NULL;
+  cvls_mem->dqncolors = 0;
+  cvls_mem->dqnnz     = 0;
+  cvls_mem->dqN       = 0;
+}
+
+
 /*---------------------------------------------------------------
   EOF
   ---------------------------------------------------------------*/
@@ -36,10 +36,15 @@ extern "C" {
   CVLS_EPLIN  default value for factor by which the tolerance on
               the nonlinear iteration is multiplied to get a
               tolerance on the linear iteration
+  CVLS_EPLMX  default value for the maximum factor by which the
+              tolerance on the nonlinear iteration is multiplied when
+              the linear tolerance is relaxed by a nonlinear solver
+              forcing term
   -----------------------------------------------------------------*/
 #define CVLS_MSBJ   51
 #define CVLS_DGMAX  RCONST(0.2)
 #define CVLS_EPLIN  RCONST(0.05)
+#define CVLS_EPLMX  RCONST(0.1)
 
 
 /*-----------------------------------------------------------------
@@ -66,6 +71,7 @@ typedef struct CVLsMemRec {
 
   /* Iterative solver tolerance */
   realtype eplifac;   /* nonlinear -> linear tol scaling factor       */
+  realtype eplmax;    /* max nonlinear -> linear tol scaling factor   */
   realtype nrmfac;    /* integrator -> LS norm conversion factor      */
 
   /* Linear solver, matrix and vector objects/pointers */
@@ -127,6 +133,23 @@ typedef struct CVLsMemRec {
   CVLsLinSysFn linsys;
   void* A_data;
 
+  /* Sparse difference quotient Jacobian (CVodeSetJacSparsityPattern)
+   *     - the pattern index arrays are stored as given by the user
+   *     - the columns of the pattern (CSC form) map into the pattern storage
+   *     - columns with the same color do not share a row and are
+   *       perturbed together */
+  int dqsparsetype;            /* CSC_MAT or CSR_MAT                       */
+  sunindextype dqN;            /* number of rows and columns               */
+  sunindextype dqnnz;          /* number of nonzeros in the pattern        */
+  sunindextype *dqindexptrs;   /* pattern index pointers                   */
+  sunindextype *dqindexvals;   /* pattern index values                     */
+  sunindextype *dqcolptrs;     /* column pointers of the pattern           */
+  sunindextype *dqrowvals;     /* row index of each column entry           */
+  sunindextype *dqpos;         /* storage location of each column entry    */
+  sunindextype dqncolors;      /* number of column colors                  */
+  sunindextype *dqcolorptrs;   /* start of each color in dqcolorcols       */
+  sunindextype *dqcolorcols;   /* columns sorted by color                  */
+
   int last_flag; /* last error flag returned by any function */
 
 } *CVLsMem;
@@ -154,6 +177,12 @@ int cvLsDenseDQJac(realtype t, N_Vector y, N_Vector fy,
 int cvLsBandDQJac(realtype t, N_Vector y, N_Vector fy,
                   SUNMatrix Jac, CVodeMem cv_mem, N_Vector tmp1,
                   N_Vector tmp2);
+int cvLsBlockDenseDQJac(realtype t, N_Vector y, N_Vector fy,
+                        SUNMatrix Jac, CVodeMem cv_mem, N_Vector tmp1,
+                        N_Vector tmp2);
+int cvLsSparseDQJac(realtype t, N_Vector y, N_Vector fy,
+                    SUNMatrix Jac, CVodeMem cv_mem, N_Vector tmp1,
+                    N_Vector tmp2);
 
 /* Generic linit/lsetup/lsolve/lfree interface routines for CVode to call */
 int cvLsInitialize(CVodeMem cv_mem);
@@ -181,6 +210,7 @@ int cvLs_AccessLMem(void* cvode_mem, const char* fname,
 #define MSG_LS_LMEM_NULL      "Linear solver memory is NULL."
 #define MSG_LS_BAD_SIZES      "Illegal bandwidth parameter(s). Must have 0 <=  ml, mu <= N-1."
 #define MSG_LS_BAD_EPLIN      "eplifac < 0 illegal."
+#define MSG_LS_BAD_EPLMAX     "eplmax < 0 illegal."
 
 #define MSG_LS_PSET_FAILED    "The preconditioner setup routine failed in an unrecoverable manner."
 #define MSG_LS_PSOLVE_FAILED  "The preconditioner solve routine failed in an unrecoverable manner."
@@ -188,6 +218,7 @@ int cvLs_AccessLMem(void* cvode_mem, const char* fname,
 #define MSG_LS_JTIMES_FAILED  "The Jacobian x vector routine failed in an unrecoverable manner."
 #define MSG_LS_JACFUNC_FAILED "The Jacobian routine failed in an unrecoverable manner."
 #define MSG_LS_SUNMAT_FAILED  "A SUNMatrix routine failed in an unrecoverable manner."
+#define MSG_LS_NO_SPARSITY    "A sparse difference quotient Jacobian requires a sparsity pattern. Call CVodeSetJacSparsityPattern."
 
 
 #ifdef __cplusplus
@@ -268,6 +268,7 @@ static int cvNlsLSetup(booleantype jbad, booleantype* jcur, void* cvode_mem)
                              &(cv_mem->cv_jcur), cv_mem->cv_vtemp1, cv_mem->cv_vtemp2,
                              cv_mem->cv_vtemp3);
   cv_mem->cv_nsetups++;
+  cv_mem->cv_forceSetup = SUNFALSE;
 
   /* update Jacobian status */
   *jcur = cv_mem->cv_jcur;
@@ -22,6 +22,7 @@
  * =================================================================
  */
 
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -56,12 +57,21 @@
 
 static CkpntMem CVAckpntInit(CVodeMem cv_mem);
 static CkpntMem CVAckpntNew(CVodeMem cv_mem);
+static booleantype CVAckpntNewVecs(CVodeMem cv_mem, CkpntMem ck_mem);
 static void CVAckpntDelete(CkpntMem *ck_memPtr);
+static void CVAckpntRemove(CVadjMem ca_mem, CkpntMem ck_mem,
+                           booleantype reversed);
+
+static int  CVAbudgetInit(CVodeMem cv_mem);
+static void CVAbudgetUpdate(CVadjMem ca_mem);
+static int  CVArevolve(CVodeMem cv_mem, CkpntMem *ck_memPtr);
+static long int CVArevolveAdvance(long int m, int s);
 
 static void CVAbckpbDelete(CVodeBMem *cvB_memPtr);
 
 static int  CVAdataStore(CVodeMem cv_mem, CkpntMem ck_mem);
 static int  CVAckpntGet(CVodeMem cv_mem, CkpntMem ck_mem);
+static int  CVAckpntGetVecs(CVodeMem cv_mem, CkpntMem ck_mem);
 
 static int CVAfindIndex(CVodeMem cv_mem, realtype t,
                         long int *indx, booleantype *newpoint);
@@ -156,6 +166,30 @@ int CVodeAdjInit(void *cvode_mem, long int steps, int interp)
   /* No interpolation data is available */
   ca_mem->ca_ckpntData = NULL;
 
+  /* No memory budget */
+  ca_mem->ca_budget      = SUNFALSE;
+  ca_mem->ca_budgetBytes = 0;
+  ca_mem->ca_nbaseMax    = 0;
+  ca_mem->ca_ntempMax    = 0;
+  ca_mem->ca_nbase       = 0;
+  ca_mem->ca_ntemp       = 0;
+  ca_mem->ca_stride      = 1;
+  ca_mem->ca_lastBase    = 0;
+  ca_mem->ca_nstRecomp   = 0;
+
+  /* No check point file */
+  ca_mem->ca_ckfile   = NULL;
+  ca_mem->ca_ckfd     = -1;
+  ca_mem->ca_ckfend   = 0;
+  ca_mem->ca_ckfree   = NULL;
+  ca_mem->ca_cknfree  = 0;
+  ca_mem->ca_ckfreemax = 0;
+  ca_mem->ca_ckpage   = 0;
+  ca_mem->ca_ckvlen   = 0;
+  ca_mem->ca_ckvlenQ  = 0;
+  ca_mem->ca_ckbuf    = NULL;
+  ca_mem->ca_ckbuflen = 0;
+
   /* ------------------------------------
    * Initialization of interpolation data
    * ------------------------------------ */
@@ -310,6 +344,10 @@ int CVodeAdjReInit(void *cvode_mem)
   ca_mem->ca_nckpnts = 0;
   ca_mem->ca_ckpntData = NULL;
 
+  ca_mem->ca_nbase = 0;
+  ca_mem->ca_ntemp = 0;
+  ca_mem->ca_nstRecomp = 0;
+
   /* CVodeF and CVodeB not called yet */
 
   ca_mem->ca_firstCVodeFcall = SUNTRUE;
@@ -342,6 +380,11 @@ void CVodeAdjFree(void *cvode_mem)
     /* Delete check points one by one */
     while (ca_mem->ck_mem != NULL) CVAckpntDelete(&(ca_mem->ck_mem));
 
+    /* Remove the check point file */
+    cvAstoreClose(cv_mem);
+    free(ca_mem->ca_ckfile);
+    ca_mem->ca_ckfile = NULL;
+
     /* Free vectors at all data points */
     if (ca_mem->ca_IMmallocDone) {
       ca_mem->ca_IMfree(cv_mem);
@@ -477,6 +520,24 @@ int CVodeF(void *cvode_mem, realtype tout, N_Vector yout,
 
     }
 
+    /* Open the check point file, if any */
+    if (ca_mem->ca_ckfile != NULL) {
+      flag = cvAstoreOpen(cv_mem);
+      if (flag != CV_SUCCESS) {
+        SUNDIALS_MARK_FUNCTION_END(CV_PROFILER);
+        return(flag);
+      }
+    }
+
+    /* Split the memory budget, if any, between check points */
+    if (ca_mem->ca_budget) {
+      flag = CVAbudgetInit(cv_mem);
+      if (flag != CV_SUCCESS) {
+        SUNDIALS_MARK_FUNCTION_END(CV_PROFILER);
+        return(flag);
+      }
+    }
+
     dt_mem[0]->t = ca_mem->ck_mem->ck_t0;
     ca_mem->ca_IMstore(cv_mem, dt_mem[0]);
 
@@ -545,7 +606,8 @@ int CVodeF(void *cvode_mem, realtype tout, N_Vector yout,
 
     if ( cv_mem->cv_nst % ca_mem->ca_nsteps == 0 ) {
 
-      ca_mem->ck_mem->ck_t1 = cv_mem->cv_tn;
+      ca_mem->ck_mem->ck_t1   = cv_mem->cv_tn;
+      ca_mem->ck_mem->ck_trev = cv_mem->cv_tn;
 
       /* Create a new check point, load it, and append it to the list */
       tmp = CVAckpntNew(cv_mem);
@@ -559,6 +621,9 @@ int CVodeF(void *cvode_mem, realtype tout, N_Vector yout,
       ca_mem->ca_nckpnts++;
       cv_mem->cv_forceSetup = SUNTRUE;
 
+      /* Keep the number of check points within the memory budget */
+      if (ca_mem->ca_budget) CVAbudgetUpdate(ca_mem);
+
       /* Reset i=0 and load dt_mem[0] */
       dt_mem[0]->t = ca_mem->ck_mem->ck_t0;
       ca_mem->ca_IMstore(cv_mem, dt_mem[0]);
@@ -574,7 +639,8 @@ int CVodeF(void *cvode_mem, realtype tout, N_Vector yout,
     /* Set t1 field of the current ckeck point structure
        for the case in which there will be no future
        check points */
-    ca_mem->ck_mem->ck_t1 = cv_mem->cv_tn;
+    ca_mem->ck_mem->ck_t1   = cv_mem->cv_tn;
+    ca_mem->ck_mem->ck_trev = cv_mem->cv_tn;
 
     /* tfinal is now set to tn */
     ca_mem->ca_tfinal = cv_mem->cv_tn;
@@ -1281,10 +1347,10 @@ int CVodeB(void *cvode_mem, realtype tBout, int itaskB)
   CVodeMem cv_mem;
   CVadjMem ca_mem;
   CVodeBMem cvB_mem, tmp_cvB_mem;
-  CkpntMem ck_mem;
+  CkpntMem ck_mem, tmp_ck_mem;
   int sign, flag=0;
   realtype tfuzz, tBret, tBn;
-  booleantype gotCheckpoint, isActive, reachedTBout;
+  booleantype gotCheckpoint, isActive, anyActive, reachedTBout;
 
   /* Check if cvode_mem exists */
 
@@ -1419,7 +1485,15 @@ int CVodeB(void *cvode_mem, realtype tBout, int itaskB)
 
     if (ck_mem->ck_next == NULL) break;
 
-    ck_mem = ck_mem->ck_next;
+    /* With a memory budget, release temporary check points that all
+       backward problems have passed */
+    if (ca_mem->ca_budget && ck_mem->ck_temp) {
+      tmp_ck_mem = ck_mem->ck_next;
+      CVAckpntRemove(ca_mem, ck_mem, SUNTRUE);
+      ck_mem = tmp_ck_mem;
+    } else {
+      ck_mem = ck_mem->ck_next;
+    }
   }
 
   /* Starting with the current check point from above, loop over check points
@@ -1430,6 +1504,29 @@ int CVodeB(void *cvode_mem, realtype tBout, int itaskB)
     /* Store interpolation data if not available.
        This is the 2nd forward integration pass */
 
+    if (ca_mem->ca_budget) {
+
+      /* A backward problem is ahead of the segments not yet processed
+         (e.g., after CVodeReInitB), reprocess the whole check point */
+      tmp_cvB_mem = cvB_mem;
+      while (tmp_cvB_mem != NULL) {
+        if ( sign*(tmp_cvB_mem->cv_mem->cv_tn - ck_mem->ck_trev) > ZERO ) {
+          ck_mem->ck_nrev = ck_mem->ck_nseg;
+          ck_mem->ck_trev = ck_mem->ck_t1;
+          if (ck_mem == ca_mem->ca_ckpntData) ca_mem->ca_ckpntData = NULL;
+          break;
+        }
+        tmp_cvB_mem = tmp_cvB_mem->cv_next;
+      }
+
+      /* Place temporary check points until a single segment remains */
+      if (ck_mem != ca_mem->ca_ckpntData && ck_mem->ck_nrev > 1) {
+        flag = CVArevolve(cv_mem, &ck_mem);
+        if (flag != CV_SUCCESS) break;
+      }
+
+    }
+
     if (ck_mem != ca_mem->ca_ckpntData) {
       flag = CVAdataStore(cv_mem, ck_mem);
       if (flag != CV_SUCCESS) break;
@@ -1438,6 +1535,8 @@ int CVodeB(void *cvode_mem, realtype tBout, int itaskB)
     /* Loop through all backward problems and, if needed,
      * propagate their solution towards tBout */
 
+    anyActive = SUNFALSE;
+
     tmp_cvB_mem = cvB_mem;
     while (tmp_cvB_mem != NULL) {
 
@@ -1454,6 +1553,8 @@ int CVodeB(void *cvode_mem, realtype tBout, int itaskB)
 
       if ( isActive ) {
 
+        anyActive = SUNTRUE;
+
         /* Store the address of current backward problem memory
          * in ca_mem to be used in the wrapper functions */
         ca_mem->ca_bckpbCrt = tmp_cvB_mem;
@@ -1487,9 +1588,11 @@ int CVodeB(void *cvode_mem, realtype tBout, int itaskB)
       return(flag);
     }
 
-    /* If in CV_ONE_STEP mode, return now (flag = CV_SUCCESS) */
+    /* If in CV_ONE_STEP mode, return now (flag = CV_SUCCESS). With a memory
+       budget, a refined check point may not contain any backward problem, in
+       which case we continue with the next one. */
 
-    if (itaskB == CV_ONE_STEP) break;
+    if (itaskB == CV_ONE_STEP && (anyActive || !ca_mem->ca_budget)) break;
 
     /* If all backward problems have succesfully reached tBout, return now */
 
@@ -1506,9 +1609,16 @@ int CVodeB(void *cvode_mem, realtype tBout, int itaskB)
 
     if ( reachedTBout ) break;
 
-    /* Move check point in linked list to next one */
+    /* Move check point in linked list to next one, releasing the current
+       one if it is a temporary check point */
 
-    ck_mem = ck_mem->ck_next;
+    if (ca_mem->ca_budget && ck_mem->ck_temp) {
+      tmp_ck_mem = ck_mem->ck_next;
+      CVAckpntRemove(ca_mem, ck_mem, SUNTRUE);
+      ck_mem = tmp_ck_mem;
+    } else {
+      ck_mem = ck_mem->ck_next;
+    }
 
   }
 
@@ -1724,6 +1834,15 @@ static CkpntMem CVAckpntInit(CVodeMem cv_mem)
                                cv_mem->cv_znQS[0], ck_mem->ck_znQS[0]);
   }
 
+  /* A single segment, kept for the whole backward pass */
+  ck_mem->ck_trev = ck_mem->ck_t0;
+  ck_mem->ck_nseg = 1;
+  ck_mem->ck_nrev = 1;
+  ck_mem->ck_temp = SUNFALSE;
+
+  /* The initial check point is always kept in memory */
+  ck_mem->ck_stored = SUNFALSE;
+
   /* Next in list */
   ck_mem->ck_next  = NULL;
 
@@ -1740,7 +1859,7 @@ static CkpntMem CVAckpntInit(CVodeMem cv_mem)
 static CkpntMem CVAckpntNew(CVodeMem cv_mem)
 {
   CkpntMem ck_mem;
-  int j, jj, is, qmax;
+  int j, qmax;
 
   /* Allocate space for ckdata */
   ck_mem = NULL;
@@ -1756,12 +1875,72 @@ static CkpntMem CVAckpntNew(CVodeMem cv_mem)
   qmax = cv_mem->cv_qmax;
   ck_mem->ck_zqm = (cv_mem->cv_q < qmax) ? qmax : 0;
 
+  if (cv_mem->cv_adj_mem->ca_ckfd >= 0) {
+
+    /* Write the vectors to the check point file */
+    ck_mem->ck_quadr       = cv_mem->cv_quadr && cv_mem->cv_errconQ;
+    ck_mem->ck_sensi       = cv_mem->cv_sensi;
+    ck_mem->ck_Ns          = cv_mem->cv_Ns;
+    ck_mem->ck_quadr_sensi = cv_mem->cv_quadr_sensi && cv_mem->cv_errconQS;
+    ck_mem->ck_q           = cv_mem->cv_q;
+    if (cvAstoreWrite(cv_mem, ck_mem) != CV_SUCCESS) {
+      free(ck_mem); ck_mem = NULL;
+      return(NULL);
+    }
+
+  } else {
+
+    ck_mem->ck_stored = SUNFALSE;
+    if (!CVAckpntNewVecs(cv_mem, ck_mem)) {
+      free(ck_mem); ck_mem = NULL;
+      return(NULL);
+    }
+
+  }
+
+  for (j=0; j<=L_MAX; j++)        ck_mem->ck_tau[j] = cv_mem->cv_tau[j];
+  for (j=0; j<=NUM_TESTS; j++)    ck_mem->ck_tq[j] = cv_mem->cv_tq[j];
+  for (j=0; j<=cv_mem->cv_q; j++) ck_mem->ck_l[j] = cv_mem->cv_l[j];
+  ck_mem->ck_nst       = cv_mem->cv_nst;
+  ck_mem->ck_tretlast  = cv_mem->cv_tretlast;
+  ck_mem->ck_q         = cv_mem->cv_q;
+  ck_mem->ck_qprime    = cv_mem->cv_qprime;
+  ck_mem->ck_qwait     = cv_mem->cv_qwait;
+  ck_mem->ck_L         = cv_mem->cv_L;
+  ck_mem->ck_gammap    = cv_mem->cv_gammap;
+  ck_mem->ck_h         = cv_mem->cv_h;
+  ck_mem->ck_hprime    = cv_mem->cv_hprime;
+  ck_mem->ck_hscale    = cv_mem->cv_hscale;
+  ck_mem->ck_eta       = cv_mem->cv_eta;
+  ck_mem->ck_etamax    = cv_mem->cv_etamax;
+  ck_mem->ck_t0        = cv_mem->cv_tn;
+  ck_mem->ck_saved_tq5 = cv_mem->cv_saved_tq5;
+  ck_mem->ck_trev      = cv_mem->cv_tn;
+  ck_mem->ck_nseg      = 1;
+  ck_mem->ck_nrev      = 1;
+  ck_mem->ck_temp      = SUNFALSE;
+
+  return(ck_mem);
+}
+
+/*
+ * CVAckpntNewVecs
+ *
+ * This routine allocates the vectors of a new check point and loads
+ * them from cv_mem. Returns SUNFALSE if an allocation failed.
+ */
+
+static booleantype CVAckpntNewVecs(CVodeMem cv_mem, CkpntMem ck_mem)
+{
+  int j, jj, is, qmax;
+
+  qmax = cv_mem->cv_qmax;
+
   for (j=0; j<=cv_mem->cv_q; j++) {
     ck_mem->ck_zn[j] = N_VClone(cv_mem->cv_tempv);
     if (ck_mem->ck_zn[j] == NULL) {
       for (jj=0; jj<j; jj++) N_VDestroy(ck_mem->ck_zn[jj]);
-      free(ck_mem); ck_mem = NULL;
-      return(NULL);
+      return(SUNFALSE);
     }
   }
 
@@ -1769,8 +1948,7 @@ static CkpntMem CVAckpntNew(CVodeMem cv_mem)
     ck_mem->ck_zn[qmax] = N_VClone(cv_mem->cv_tempv);
     if (ck_mem->ck_zn[qmax] == NULL) {
       for (jj=0; jj<=cv_mem->cv_q; jj++) N_VDestroy(ck_mem->ck_zn[jj]);
-      free(ck_mem); ck_mem = NULL;
-      return(NULL);
+      return(SUNFALSE);
     }
   }
 
@@ -1785,8 +1963,7 @@ static CkpntMem CVAckpntNew(CVodeMem cv_mem)
         for (jj=0; jj<j; jj++) N_VDestroy(ck_mem->ck_znQ[jj]);
         if (cv_mem->cv_q < qmax) N_VDestroy(ck_mem->ck_zn[qmax]);
         for (jj=0; jj<=cv_mem->cv_q; j++) N_VDestroy(ck_mem->ck_zn[jj]);
-        free(ck_mem); ck_mem = NULL;
-        return(NULL);
+        return(SUNFALSE);
       }
     }
 
@@ -1796,8 +1973,7 @@ static CkpntMem CVAckpntNew(CVodeMem cv_mem)
         for (jj=0; jj<=cv_mem->cv_q; jj++) N_VDestroy(ck_mem->ck_znQ[jj]);
         N_VDestroy(ck_mem->ck_zn[qmax]);
         for (jj=0; jj<=cv_mem->cv_q; jj++) N_VDestroy(ck_mem->ck_zn[jj]);
-        free(ck_mem); ck_mem = NULL;
-        return(NULL);
+        return(SUNFALSE);
       }
     }
 
@@ -1820,8 +1996,7 @@ static CkpntMem CVAckpntNew(CVodeMem cv_mem)
         }
         if (cv_mem->cv_q < qmax) N_VDestroy(ck_mem->ck_zn[qmax]);
         for (jj=0; jj<=cv_mem->cv_q; jj++) N_VDestroy(ck_mem->ck_zn[jj]);
-        free(ck_mem); ck_mem = NULL;
-        return(NULL);
+        return(SUNFALSE);
       }
     }
 
@@ -1835,8 +2010,7 @@ static CkpntMem CVAckpntNew(CVodeMem cv_mem)
         }
         N_VDestroy(ck_mem->ck_zn[qmax]);
         for (jj=0; jj<=cv_mem->cv_q; jj++) N_VDestroy(ck_mem->ck_zn[jj]);
-        free(ck_mem); ck_mem = NULL;
-        return(NULL);
+        return(SUNFALSE);
       }
     }
 
@@ -1859,8 +2033,7 @@ static CkpntMem CVAckpntNew(CVodeMem cv_mem)
         }
         if (cv_mem->cv_q < qmax) N_VDestroy(ck_mem->ck_zn[qmax]);
         for (jj=0; jj<=cv_mem->cv_q; jj++) N_VDestroy(ck_mem->ck_zn[jj]);
-        free(ck_mem); ck_mem = NULL;
-        return(NULL);
+        return(SUNFALSE);
       }
     }
 
@@ -1876,8 +2049,7 @@ static CkpntMem CVAckpntNew(CVodeMem cv_mem)
         }
         N_VDestroy(ck_mem->ck_zn[qmax]);
         for (jj=0; jj<=cv_mem->cv_q; jj++) N_VDestroy(ck_mem->ck_zn[jj]);
-        free(ck_mem); ck_mem = NULL;
-        return(NULL);
+        return(SUNFALSE);
       }
     }
 
@@ -1948,25 +2120,7 @@ static CkpntMem CVAckpntNew(CVodeMem cv_mem)
     }
   }
 
-  for (j=0; j<=L_MAX; j++)        ck_mem->ck_tau[j] = cv_mem->cv_tau[j];
-  for (j=0; j<=NUM_TESTS; j++)    ck_mem->ck_tq[j] = cv_mem->cv_tq[j];
-  for (j=0; j<=cv_mem->cv_q; j++) ck_mem->ck_l[j] = cv_mem->cv_l[j];
-  ck_mem->ck_nst       = cv_mem->cv_nst;
-  ck_mem->ck_tretlast  = cv_mem->cv_tretlast;
-  ck_mem->ck_q         = cv_mem->cv_q;
-  ck_mem->ck_qprime    = cv_mem->cv_qprime;
-  ck_mem->ck_qwait     = cv_mem->cv_qwait;
-  ck_mem->ck_L         = cv_mem->cv_L;
-  ck_mem->ck_gammap    = cv_mem->cv_gammap;
-  ck_mem->ck_h         = cv_mem->cv_h;
-  ck_mem->ck_hprime    = cv_mem->cv_hprime;
-  ck_mem->ck_hscale    = cv_mem->cv_hscale;
-  ck_mem->ck_eta       = cv_mem->cv_eta;
-  ck_mem->ck_etamax    = cv_mem->cv_etamax;
-  ck_mem->ck_t0        = cv_mem->cv_tn;
-  ck_mem->ck_saved_tq5 = cv_mem->cv_saved_tq5;
-
-  return(ck_mem);
+  return(SUNTRUE);
 }
 
 /*
@@ -1989,6 +2143,12 @@ static void CVAckpntDelete(CkpntMem *ck_memPtr)
   /* move head of list */
   *ck_memPtr = (*ck_memPtr)->ck_next;
 
+  /* the vectors of tmp are in the check point file */
+  if (tmp->ck_stored) {
+    free(tmp); tmp = NULL;
+    return;
+  }
+
   /* free N_Vectors in tmp */
   for (j=0;j<=tmp->ck_q;j++) N_VDestroy(tmp->ck_zn[j]);
   if (tmp->ck_zqm != 0) N_VDestroy(tmp->ck_zn[tmp->ck_zqm]);
@@ -2039,6 +2199,286 @@ static void CVAckpntDelete(CkpntMem *ck_memPtr)
 
 }
 
+/*
+ * CVAckpntRemove
+ *
+ * This routine removes the check point ck_mem from the list and
+ * merges the interval it starts into the preceding (older) check
+ * point. If reversed is SUNTRUE, the backward problems have already
+ * been integrated over the removed interval.
+ */
+
+static void CVAckpntRemove(CVadjMem ca_mem, CkpntMem ck_mem,
+                           booleantype reversed)
+{
+  CkpntMem older, *ptr;
+
+  older = ck_mem->ck_next;
+
+  older->ck_t1    = ck_mem->ck_t1;
+  older->ck_nseg += ck_mem->ck_nseg;
+  if (!reversed) {
+    older->ck_trev  = ck_mem->ck_trev;
+    older->ck_nrev += ck_mem->ck_nrev;
+  }
+
+  if (ck_mem->ck_temp) ca_mem->ca_ntemp--;
+  else                 ca_mem->ca_nbase--;
+
+  if (ca_mem->ca_ckpntData == ck_mem) ca_mem->ca_ckpntData = NULL;
+
+  /* find the link pointing to ck_mem and delete it */
+  cvAstoreRelease(ca_mem, ck_mem);
+  ptr = &(ca_mem->ck_mem);
+  while (*ptr != ck_mem) ptr = &((*ptr)->ck_next);
+  CVAckpntDelete(ptr);
+
+  ca_mem->ca_nckpnts--;
+}
+
+/*
+ * =================================================================
+ * PRIVATE FUNCTIONS FOR THE MEMORY BUDGET
+ * =================================================================
+ */
+
+/*
+ * CVAbudgetInit
+ *
+ * This routine splits the memory budget, less the data points of one
+ * interval, into base check points kept from the forward pass and
+ * temporary check points placed during the backward pass. It is called
+ * at the first call to CVodeF, after the initial check point has been
+ * created.
+ */
+
+static int CVAbudgetInit(CVodeMem cv_mem)
+{
+  CVadjMem ca_mem;
+  long int vecbytes, vecbytesQ, ckbytes, dtbytes, nslots;
+  int Ns, NsQ, NsDt;
+
+  ca_mem = cv_mem->cv_adj_mem;
+
+  vecbytes  = (long int) (cv_mem->cv_lrw1 * sizeof(realtype) +
+                          cv_mem->cv_liw1 * sizeof(sunindextype));
+  vecbytesQ = (long int) (cv_mem->cv_lrw1Q * sizeof(realtype) +
+                          cv_mem->cv_liw1Q * sizeof(sunindextype));
+  if (vecbytes <= 0) {
+    cvProcessError(cv_mem, CV_ILL_INPUT, "CVODEA", "CVodeF", MSGCV_BUDGET_NVEC);
+    return(CV_ILL_INPUT);
+  }
+
+  Ns   = (cv_mem->cv_sensi) ? cv_mem->cv_Ns : 0;
+  NsQ  = (cv_mem->cv_quadr_sensi && cv_mem->cv_errconQS) ? Ns : 0;
+  NsDt = (ca_mem->ca_IMstoreSensi) ? Ns : 0;
+  if (!(cv_mem->cv_quadr && cv_mem->cv_errconQ)) vecbytesQ = 0;
+
+  /* Upper bound on the size of one check point */
+  ckbytes = (long int) sizeof(struct CkpntMemRec) +
+    (cv_mem->cv_qmax + 1) * (vecbytes * (1 + Ns) + vecbytesQ * (1 + NsQ));
+
+  /* Data points for one interval */
+  dtbytes = (long int) sizeof(struct DtpntMemRec);
+  if (ca_mem->ca_IMtype == CV_HERMITE) dtbytes += 2 * vecbytes * (1 + NsDt);
+  else                                 dtbytes += vecbytes * (1 + NsDt);
+  dtbytes *= ca_mem->ca_nsteps + 1;
+
+  nslots = (ca_mem->ca_budgetBytes - dtbytes) / ckbytes;
+  if (nslots < 2) {
+    cvProcessError(cv_mem, CV_ILL_INPUT, "CVODEA", "CVodeF", MSGCV_BAD_BUDGET);
+    return(CV_ILL_INPUT);
+  }
+  if (nslots > INT_MAX) nslots = INT_MAX;
+
+  /* One slot is reserved for the newest check point in CVodeF and for the
+     last temporary check point in CVodeB */
+  ca_mem->ca_nbaseMax = (int) (nslots / 2);
+  ca_mem->ca_ntempMax = (int) (nslots - ca_mem->ca_nbaseMax - 1);
+
+  /* The initial check point is the first base check point */
+  ca_mem->ca_nbase      = 1;
+  ca_mem->ca_ntemp      = 0;
+  ca_mem->ca_stride     = 1;
+  ca_mem->ca_lastBase   = 0;
+  ca_mem->ca_nstRecomp  = 0;
+
+  return(CV_SUCCESS);
+}
+
+/*
+ * CVAbudgetUpdate
+ *
+ * This routine is called by CVodeF after a new check point has been
+ * added at the head of the list. Base check points are kept every
+ * ca_stride intervals; when there are too many, the stride is doubled
+ * and every other base check point is released. The newest check
+ * point is temporary if it is not a base check point and is released
+ * when the next one is created.
+ */
+
+static void CVAbudgetUpdate(CVadjMem ca_mem)
+{
+  CkpntMem ck_mem, tmp;
+  long int seg;
+
+  ck_mem = ca_mem->ck_mem;
+  seg    = ck_mem->ck_nst / ca_mem->ca_nsteps;
+
+  if (ck_mem->ck_next->ck_temp)
+    CVAckpntRemove(ca_mem, ck_mem->ck_next, SUNFALSE);
+
+  if ( (ca_mem->ca_nbaseMax > 1) &&
+       (seg - ca_mem->ca_lastBase == ca_mem->ca_stride) ) {
+    ca_mem->ca_nbase++;
+    ca_mem->ca_lastBase = seg;
+  } else {
+    ck_mem->ck_temp = SUNTRUE;
+    ca_mem->ca_ntemp++;
+  }
+
+  if (ca_mem->ca_nbase <= ca_mem->ca_nbaseMax) return;
+
+  /* Thin the base check points (the initial one is always kept) */
+  ca_mem->ca_stride *= 2;
+
+  ck_mem = ca_mem->ck_mem;
+  while (ck_mem->ck_next != NULL) {
+    tmp = ck_mem->ck_next;
+    if ( !ck_mem->ck_temp &&
+         (ck_mem->ck_nst / ca_mem->ca_nsteps) % ca_mem->ca_stride != 0 ) {
+      if (ck_mem == ca_mem->ck_mem) {
+        /* the newest check point becomes temporary */
+        ck_mem->ck_temp = SUNTRUE;
+        ca_mem->ca_nbase--;
+        ca_mem->ca_ntemp++;
+      } else {
+        CVAckpntRemove(ca_mem, ck_mem, SUNFALSE);
+      }
+    }
+    ck_mem = tmp;
+  }
+
+  ck_mem = ca_mem->ck_mem;
+  while (ck_mem->ck_temp) ck_mem = ck_mem->ck_next;
+  ca_mem->ca_lastBase = ck_mem->ck_nst / ca_mem->ca_nsteps;
+}
+
+/*
+ * CVArevolve
+ *
+ * This routine is called by CVodeB for a check point spanning more
+ * than one interval that has not been processed. It recomputes the
+ * forward solution from the check point, placing temporary check
+ * points following a binomial (revolve) schedule, until the check
+ * point returned in ck_memPtr starts the last unprocessed interval.
+ *
+ * Return values:
+ * CV_SUCCESS
+ * CV_REIFWD_FAIL
+ * CV_FWD_FAIL
+ * CV_MEM_FAIL
+ */
+
+static int CVArevolve(CVodeMem cv_mem, CkpntMem *ck_memPtr)
+{
+  CVadjMem ca_mem;
+  CkpntMem ck_mem, new_mem, *ptr;
+  long int d, nstop;
+  int flag, s;
+  realtype t;
+
+  ca_mem = cv_mem->cv_adj_mem;
+  ck_mem = *ck_memPtr;
+
+  while (ck_mem->ck_nrev > 1) {
+
+    /* Number of intervals to advance with the check points left. When
+       none are left, the one reserved slot is placed on the last interval. */
+    s = ca_mem->ca_ntempMax - ca_mem->ca_ntemp;
+    if (s > 0) d = CVArevolveAdvance(ck_mem->ck_nrev, s + 1);
+    else       d = ck_mem->ck_nrev - 1;
+
+    flag = CVAckpntGet(cv_mem, ck_mem);
+    if (flag != CV_SUCCESS) return(CV_REIFWD_FAIL);
+
+    if (ca_mem->ca_tstopCVodeFcall)
+      CVodeSetStopTime(cv_mem, ca_mem->ca_tstopCVodeF);
+
+    nstop = ck_mem->ck_nst + d * ca_mem->ca_nsteps;
+    while (cv_mem->cv_nst < nstop) {
+      flag = CVode(cv_mem, ck_mem->ck_trev, ca_mem->ca_ytmp, &t, CV_ONE_STEP);
+      if (flag < 0) return(CV_FWD_FAIL);
+      ca_mem->ca_nstRecomp++;
+      /* same as in CVodeF, where a check point was created here */
+      if (cv_mem->cv_nst % ca_mem->ca_nsteps == 0)
+        cv_mem->cv_forceSetup = SUNTRUE;
+    }
+
+    new_mem = CVAckpntNew(cv_mem);
+    if (new_mem == NULL) return(CV_MEM_FAIL);
+
+    new_mem->ck_temp = SUNTRUE;
+    new_mem->ck_t1   = ck_mem->ck_t1;
+    new_mem->ck_trev = ck_mem->ck_trev;
+    new_mem->ck_nseg = ck_mem->ck_nseg - d;
+    new_mem->ck_nrev = ck_mem->ck_nrev - d;
+
+    ck_mem->ck_t1   = new_mem->ck_t0;
+    ck_mem->ck_trev = new_mem->ck_t0;
+    ck_mem->ck_nseg = d;
+    ck_mem->ck_nrev = d;
+
+    /* insert new_mem before ck_mem */
+    ptr = &(ca_mem->ck_mem);
+    while (*ptr != ck_mem) ptr = &((*ptr)->ck_next);
+    new_mem->ck_next = ck_mem;
+    *ptr = new_mem;
+
+    ca_mem->ca_ntemp++;
+    ca_mem->ca_nckpnts++;
+
+    ck_mem = new_mem;
+  }
+
+  *ck_memPtr = ck_mem;
+
+  return(CV_SUCCESS);
+}
+
+/*
+ * CVArevolveAdvance
+ *
+ * This routine returns the number of intervals to advance before
+ * placing the next check point when reversing m intervals with s check
+ * points (including the one at the start). With t the smallest number
+ * of recomputations such that beta(s,t) = (s+t)!/(s!t!) >= m, the
+ * remaining beta(s-1,t) intervals are reversed with s-1 check points.
+ */
+
+static long int CVArevolveAdvance(long int m, int s)
+{
+  double beta;
+  long int t, d;
+
+  if (m <= 2 || s < 2) return(m - 1);
+
+  beta = 1.0;
+  t    = 0;
+  while (beta < (double) m) {
+    t++;
+    beta = beta * (double) (s + t) / (double) t;
+  }
+
+  /* beta(s-1,t) = beta(s,t) s / (s+t) */
+  d = m - (long int) (beta * (double) s / (double) (s + t) + 0.5);
+
+  if (d < 1)     d = 1;
+  if (d > m - 1) d = m - 1;
+
+  return(d);
+}
+
 /*
  * =================================================================
  * PRIVATE FUNCTIONS FOR BACKWARD PROBLEMS
@@ -2127,14 +2567,14 @@ static int CVAdataStore(CVodeMem cv_mem, CkpntMem ck_mem)
   i = 1;
   do {
 
-    flag = CVode(cv_mem, ck_mem->ck_t1, ca_mem->ca_ytmp, &t, CV_ONE_STEP);
+    flag = CVode(cv_mem, ck_mem->ck_trev, ca_mem->ca_ytmp, &t, CV_ONE_STEP);
     if (flag < 0) return(CV_FWD_FAIL);
 
     dt_mem[i]->t = t;
     ca_mem->ca_IMstore(cv_mem, dt_mem[i]);
     i++;
 
-  } while ( sign*(ck_mem->ck_t1 - t) > ZERO );
+  } while ( sign*(ck_mem->ck_trev - t) > ZERO );
 
 
   ca_mem->ca_IMnewData = SUNTRUE;     /* New data is now available    */
@@ -2153,7 +2593,7 @@ static int CVAdataStore(CVodeMem cv_mem, CkpntMem ck_mem)
 
 static int CVAckpntGet(CVodeMem cv_mem, CkpntMem ck_mem)
 {
-  int flag, j, is, qmax, retval;
+  int flag, j, retval;
 
   if (ck_mem->ck_next == NULL) {
 
@@ -2183,8 +2623,6 @@ static int CVAckpntGet(CVodeMem cv_mem, CkpntMem ck_mem)
 
   } else {
 
-    qmax = cv_mem->cv_qmax;
-
     /* Copy parameters from check point data structure */
 
     cv_mem->cv_nst       = ck_mem->ck_nst;
@@ -2202,86 +2640,111 @@ static int CVAckpntGet(CVodeMem cv_mem, CkpntMem ck_mem)
     cv_mem->cv_tn        = ck_mem->ck_t0;
     cv_mem->cv_saved_tq5 = ck_mem->ck_saved_tq5;
 
-    /* Copy the arrays from check point data structure */
+    /* Copy the arrays from check point data structure or file */
 
-    for (j=0; j<=cv_mem->cv_q; j++)
-      cv_mem->cv_cvals[j] = ONE;
+    if (ck_mem->ck_stored) {
+      retval = cvAstoreRead(cv_mem, ck_mem);
+      /* the older check point is restored next by CVodeB */
+      cvAstorePrefetch(cv_mem->cv_adj_mem, ck_mem->ck_next);
+    } else {
+      retval = CVAckpntGetVecs(cv_mem, ck_mem);
+    }
+    if (retval != CV_SUCCESS) return(retval);
 
-    retval = N_VScaleVectorArray(cv_mem->cv_q+1, cv_mem->cv_cvals,
-                                 ck_mem->ck_zn, cv_mem->cv_zn);
-    if (retval != CV_SUCCESS) return (CV_VECTOROP_ERR);
+    for (j=0; j<=L_MAX; j++)        cv_mem->cv_tau[j] = ck_mem->ck_tau[j];
+    for (j=0; j<=NUM_TESTS; j++)    cv_mem->cv_tq[j] = ck_mem->ck_tq[j];
+    for (j=0; j<=cv_mem->cv_q; j++) cv_mem->cv_l[j] = ck_mem->ck_l[j];
 
-    if ( cv_mem->cv_q < qmax )
-      N_VScale(ONE, ck_mem->ck_zn[qmax], cv_mem->cv_zn[qmax]);
+    /* Force a call to setup */
 
-    if (ck_mem->ck_quadr) {
-      for (j=0; j<=cv_mem->cv_q; j++)
-        cv_mem->cv_cvals[j] = ONE;
+    cv_mem->cv_forceSetup = SUNTRUE;
 
-      retval = N_VScaleVectorArray(cv_mem->cv_q+1, cv_mem->cv_cvals,
-                                   ck_mem->ck_znQ, cv_mem->cv_znQ);
-      if (retval != CV_SUCCESS) return (CV_VECTOROP_ERR);
+  }
 
-      if ( cv_mem->cv_q < qmax )
-        N_VScale(ONE, ck_mem->ck_znQ[qmax], cv_mem->cv_znQ[qmax]);
-    }
+  return(CV_SUCCESS);
+}
 
-    if (ck_mem->ck_sensi) {
-      for (j=0; j<=cv_mem->cv_q; j++) {
-        for (is=0; is<cv_mem->cv_Ns; is++) {
-          cv_mem->cv_cvals[j*cv_mem->cv_Ns+is] = ONE;
-          cv_mem->cv_Xvecs[j*cv_mem->cv_Ns+is] = ck_mem->ck_znS[j][is];
-          cv_mem->cv_Zvecs[j*cv_mem->cv_Ns+is] = cv_mem->cv_znS[j][is];
-        }
-      }
+/*
+ * CVAckpntGetVecs
+ *
+ * This routine copies the vectors of the check point ck_mem into
+ * cv_mem. The order q must have been restored already.
+ */
 
-      retval = N_VScaleVectorArray(cv_mem->cv_Ns*(cv_mem->cv_q+1),
-                                   cv_mem->cv_cvals,
-                                   cv_mem->cv_Xvecs, cv_mem->cv_Zvecs);
-      if (retval != CV_SUCCESS) return (CV_VECTOROP_ERR);
+static int CVAckpntGetVecs(CVodeMem cv_mem, CkpntMem ck_mem)
+{
+  int j, is, qmax, retval;
+
+  qmax = cv_mem->cv_qmax;
+
+  for (j=0; j<=cv_mem->cv_q; j++)
+    cv_mem->cv_cvals[j] = ONE;
+
+  retval = N_VScaleVectorArray(cv_mem->cv_q+1, cv_mem->cv_cvals,
+                               ck_mem->ck_zn, cv_mem->cv_zn);
+  if (retval != CV_SUCCESS) return (CV_VECTOROP_ERR);
+
+  if ( cv_mem->cv_q < qmax )
+    N_VScale(ONE, ck_mem->ck_zn[qmax], cv_mem->cv_zn[qmax]);
+
+  if (ck_mem->ck_quadr) {
+    for (j=0; j<=cv_mem->cv_q; j++)
+      cv_mem->cv_cvals[j] = ONE;
+
+    retval = N_VScaleVectorArray(cv_mem->cv_q+1, cv_mem->cv_cvals,
+                                 ck_mem->ck_znQ, cv_mem->cv_znQ);
+    if (retval != CV_SUCCESS) return (CV_VECTOROP_ERR);
 
-      if ( cv_mem->cv_q < qmax ) {
-        for (is=0; is<cv_mem->cv_Ns; is++)
-          cv_mem->cv_cvals[is] = ONE;
+    if ( cv_mem->cv_q < qmax )
+      N_VScale(ONE, ck_mem->ck_znQ[qmax], cv_mem->cv_znQ[qmax]);
+  }
 
-        retval = N_VScaleVectorArray(cv_mem->cv_Ns, cv_mem->cv_cvals,
-                                     ck_mem->ck_znS[qmax], cv_mem->cv_znS[qmax]);
-        if (retval != CV_SUCCESS) return (CV_VECTOROP_ERR);
+  if (ck_mem->ck_sensi) {
+    for (j=0; j<=cv_mem->cv_q; j++) {
+      for (is=0; is<cv_mem->cv_Ns; is++) {
+        cv_mem->cv_cvals[j*cv_mem->cv_Ns+is] = ONE;
+        cv_mem->cv_Xvecs[j*cv_mem->cv_Ns+is] = ck_mem->ck_znS[j][is];
+        cv_mem->cv_Zvecs[j*cv_mem->cv_Ns+is] = cv_mem->cv_znS[j][is];
       }
     }
 
-    if (ck_mem->ck_quadr_sensi) {
-      for (j=0; j<=cv_mem->cv_q; j++) {
-        for (is=0; is<cv_mem->cv_Ns; is++) {
-          cv_mem->cv_cvals[j*cv_mem->cv_Ns+is] = ONE;
-          cv_mem->cv_Xvecs[j*cv_mem->cv_Ns+is] = ck_mem->ck_znQS[j][is];
-          cv_mem->cv_Zvecs[j*cv_mem->cv_Ns+is] = cv_mem->cv_znQS[j][is];
-        }
-      }
+    retval = N_VScaleVectorArray(cv_mem->cv_Ns*(cv_mem->cv_q+1),
+                                 cv_mem->cv_cvals,
+                                 cv_mem->cv_Xvecs, cv_mem->cv_Zvecs);
+    if (retval != CV_SUCCESS) return (CV_VECTOROP_ERR);
 
-      retval = N_VScaleVectorArray(cv_mem->cv_Ns*(cv_mem->cv_q+1),
-                                   cv_mem->cv_cvals,
-                                   cv_mem->cv_Xvecs, cv_mem->cv_Zvecs);
-      if (retval != CV_SUCCESS) return (CV_VECTOROP_ERR);
+    if ( cv_mem->cv_q < qmax ) {
+      for (is=0; is<cv_mem->cv_Ns; is++)
+        cv_mem->cv_cvals[is] = ONE;
 
-      if ( cv_mem->cv_q < qmax ) {
-        for (is=0; is<cv_mem->cv_Ns; is++)
-          cv_mem->cv_cvals[is] = ONE;
+      retval = N_VScaleVectorArray(cv_mem->cv_Ns, cv_mem->cv_cvals,
+                                   ck_mem->ck_znS[qmax], cv_mem->cv_znS[qmax]);
+      if (retval != CV_SUCCESS) return (CV_VECTOROP_ERR);
+    }
+  }
 
-        retval = N_VScaleVectorArray(cv_mem->cv_Ns, cv_mem->cv_cvals,
-                                     ck_mem->ck_znQS[qmax], cv_mem->cv_znQS[qmax]);
-        if (retval != CV_SUCCESS) return (CV_VECTOROP_ERR);
+  if (ck_mem->ck_quadr_sensi) {
+    for (j=0; j<=cv_mem->cv_q; j++) {
+      for (is=0; is<cv_mem->cv_Ns; is++) {
+        cv_mem->cv_cvals[j*cv_mem->cv_Ns+is] = ONE;
+        cv_mem->cv_Xvecs[j*cv_mem->cv_Ns+is] = ck_mem->ck_znQS[j][is];
+        cv_mem->cv_Zvecs[j*cv_mem->cv_Ns+is] = cv_mem->cv_znQS[j][is];
       }
     }
 
-    for (j=0; j<=L_MAX; j++)        cv_mem->cv_tau[j] = ck_mem->ck_tau[j];
-    for (j=0; j<=NUM_TESTS; j++)    cv_mem->cv_tq[j] = ck_mem->ck_tq[j];
-    for (j=0; j<=cv_mem->cv_q; j++) cv_mem->cv_l[j] = ck_mem->ck_l[j];
-
-    /* Force a call to setup */
+    retval = N_VScaleVectorArray(cv_mem->cv_Ns*(cv_mem->cv_q+1),
+                                 cv_mem->cv_cvals,
+                                 cv_mem->cv_Xvecs, cv_mem->cv_Zvecs);
+    if (retval != CV_SUCCESS) return (CV_VECTOROP_ERR);
 
-    cv_mem->cv_forceSetup = SUNTRUE;
+    if ( cv_mem->cv_q < qmax ) {
+      for (is=0; is<cv_mem->cv_Ns; is++)
+        cv_mem->cv_cvals[is] = ONE;
 
+      retval = N_VScaleVectorArray(cv_mem->cv_Ns, cv_mem->cv_cvals,
+                                   ck_mem->ck_znQS[qmax], cv_mem->cv_znQS[qmax]);
+      if (retval != CV_SUCCESS) return (CV_VECTOROP_ERR);
+    }
   }
 
   return(CV_SUCCESS);
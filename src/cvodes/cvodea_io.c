@@ -28,6 +28,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "cvodes_impl.h"
 #include <sundials/sundials_types.h>
@@ -76,6 +77,108 @@ int CVodeSetAdjNoSensi(void *cvode_mem)
   return(CV_SUCCESS);
 }
 
+/*
+ * CVodeSetAdjMemoryBudget
+ *
+ * Limits the memory used for check points and data points to nbytes.
+ * Check points are then placed with binomial (revolve) checkpointing
+ * and forward segments are recomputed as needed by CVodeB. A value of
+ * zero disables the budget.
+ */
+
+int CVodeSetAdjMemoryBudget(void *cvode_mem, long int nbytes)
+{
+  CVodeMem cv_mem;
+  CVadjMem ca_mem;
+
+  /* Check if cvode_mem exists */
+  if (cvode_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODEA", "CVodeSetAdjMemoryBudget", MSGCV_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+  cv_mem = (CVodeMem) cvode_mem;
+
+  /* Was ASA initialized? */
+  if (cv_mem->cv_adjMallocDone == SUNFALSE) {
+    cvProcessError(cv_mem, CV_NO_ADJ, "CVODEA", "CVodeSetAdjMemoryBudget", MSGCV_NO_ADJ);
+    return(CV_NO_ADJ);
+  }
+  ca_mem = cv_mem->cv_adj_mem;
+
+  /* The check point placement is decided during the forward pass */
+  if (!ca_mem->ca_firstCVodeFcall) {
+    cvProcessError(cv_mem, CV_ILL_INPUT, "CVODEA", "CVodeSetAdjMemoryBudget", MSGCV_BUDGET_FWD);
+    return(CV_ILL_INPUT);
+  }
+
+  if (nbytes < 0) {
+    cvProcessError(cv_mem, CV_ILL_INPUT, "CVODEA", "CVodeSetAdjMemoryBudget", MSGCV_NEG_BUDGET);
+    return(CV_ILL_INPUT);
+  }
+
+  ca_mem->ca_budget      = (nbytes > 0);
+  ca_mem->ca_budgetBytes = nbytes;
+
+  return(CV_SUCCESS);
+}
+
+/*
+ * CVodeSetAdjCheckpointFile
+ *
+ * Stores the vectors of the check points in the file filename instead
+ * of in memory. The file is created by CVodeF and removed by
+ * CVodeAdjFree. A NULL filename keeps the check points in memory.
+ */
+
+int CVodeSetAdjCheckpointFile(void *cvode_mem, const char *filename)
+{
+  CVodeMem cv_mem;
+  CVadjMem ca_mem;
+
+  /* Check if cvode_mem exists */
+  if (cvode_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODEA", "CVodeSetAdjCheckpointFile", MSGCV_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+  cv_mem = (CVodeMem) cvode_mem;
+
+  /* Was ASA initialized? */
+  if (cv_mem->cv_adjMallocDone == SUNFALSE) {
+    cvProcessError(cv_mem, CV_NO_ADJ, "CVODEA", "CVodeSetAdjCheckpointFile", MSGCV_NO_ADJ);
+    return(CV_NO_ADJ);
+  }
+  ca_mem = cv_mem->cv_adj_mem;
+
+#if !defined(SUNDIALS_HAVE_MMAP)
+  if (filename != NULL) {
+    cvProcessError(cv_mem, CV_ILL_INPUT, "CVODEA", "CVodeSetAdjCheckpointFile", MSGCV_CKFILE_NONE);
+    return(CV_ILL_INPUT);
+  }
+#endif
+
+  /* The check points are created during the forward pass */
+  if (!ca_mem->ca_firstCVodeFcall) {
+    cvProcessError(cv_mem, CV_ILL_INPUT, "CVODEA", "CVodeSetAdjCheckpointFile", MSGCV_CKFILE_FWD);
+    return(CV_ILL_INPUT);
+  }
+
+  /* Remove the file used before CVodeAdjReInit, if any */
+  cvAstoreClose(cv_mem);
+  free(ca_mem->ca_ckfile);
+  ca_mem->ca_ckfile = NULL;
+
+  if (filename != NULL) {
+    ca_mem->ca_ckfile = (char *) malloc(strlen(filename) + 1);
+    if (ca_mem->ca_ckfile == NULL) {
+      cvProcessError(cv_mem, CV_MEM_FAIL, "CVODEA", "CVodeSetAdjCheckpointFile", MSGCV_MEM_FAIL);
+      return(CV_MEM_FAIL);
+    }
+    strcpy(ca_mem->ca_ckfile, filename);
+  }
+
+  return(CV_SUCCESS);
+}
+
 /* 
  * -----------------------------------------------------------------
  * Optional input functions for backward integration
@@ -559,6 +662,37 @@ void *CVodeGetAdjCVodeBmem(void *cvode_mem, int which)
   return(cvodeB_mem);
 }
 
+/*
+ * CVodeGetAdjNumRecompSteps
+ *
+ * Returns the number of forward steps recomputed to place temporary
+ * check points when a memory budget is set.
+ */
+
+int CVodeGetAdjNumRecompSteps(void *cvode_mem, long int *nstrecomp)
+{
+  CVodeMem cv_mem;
+  CVadjMem ca_mem;
+
+  /* Check if cvode_mem exists */
+  if (cvode_mem == NULL) {
+    cvProcessError(NULL, CV_MEM_NULL, "CVODEA", "CVodeGetAdjNumRecompSteps", MSGCV_NO_MEM);
+    return(CV_MEM_NULL);
+  }
+  cv_mem = (CVodeMem) cvode_mem;
+
+  /* Was ASA initialized? */
+  if (cv_mem->cv_adjMallocDone == SUNFALSE) {
+    cvProcessError(cv_mem, CV_NO_ADJ, "CVODEA", "CVodeGetAdjNumRecompSteps", MSGCV_NO_ADJ);
+    return(CV_NO_ADJ);
+  }
+  ca_mem = cv_mem->cv_adj_mem;
+
+  *nstrecomp = ca_mem->ca_nstRecomp;
+
+  return(CV_SUCCESS);
+}
+
 /*
  * CVodeGetAdjCheckPointsInfo
  *
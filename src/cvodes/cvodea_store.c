@@ -0,0 +1,457 @@
+/* -----------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------
+ * This is the implementation file for the check point file of the
+ * adjoint module in the CVODES solver. The vectors of a check point
+ * are packed with N_VBufPack and appended to the file. When the
+ * check point is restored, its record is memory mapped and unpacked
+ * directly into the Nordsieck arrays, and the record of the previous
+ * (older) check point, which CVodeB needs next, is read ahead by the
+ * operating system. The space of released records is kept in a list
+ * of free extents and reused by later records.
+ * -----------------------------------------------------------------
+ */
+
+/* Minimum POSIX version needed for pwrite and posix_fadvise */
+#if !defined(_POSIX_C_SOURCE) || (_POSIX_C_SOURCE < 200809L)
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cvodes_impl.h"
+
+#if defined(SUNDIALS_HAVE_MMAP)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/*
+ * cvAstoreVecs
+ *
+ * Packs (pack = SUNTRUE) the vectors of the current CVODES state
+ * that are saved in the check point ck_mem into buf or unpacks them
+ * from buf. The vectors are zn[j], j = 0,...,q, and zn[qmax] if it is
+ * saved, followed by the quadrature, sensitivity, and quadrature
+ * sensitivity arrays in the same order. Returns the number of bytes
+ * used in *len.
+ */
+
+static int cvAstoreVecs(CVodeMem cv_mem, CkpntMem ck_mem, char *buf,
+                        booleantype pack, long int *len)
+{
+  CVadjMem ca_mem;
+  N_Vector v;
+  int js[L_MAX+1];
+  int nj, j, k, is, ns, retval;
+
+  ca_mem = cv_mem->cv_adj_mem;
+
+  nj = 0;
+  for (j=0; j<=ck_mem->ck_q; j++) js[nj++] = j;
+  if (ck_mem->ck_zqm != 0) js[nj++] = ck_mem->ck_zqm;
+
+  ns   = (ck_mem->ck_sensi) ? ck_mem->ck_Ns : 0;
+  *len = nj * (long int) ca_mem->ca_ckvlen * (1 + ns);
+  if (ck_mem->ck_quadr)
+    *len += nj * (long int) ca_mem->ca_ckvlenQ;
+  if (ck_mem->ck_quadr_sensi)
+    *len += nj * (long int) ca_mem->ca_ckvlenQ * ck_mem->ck_Ns;
+
+  if (buf == NULL) return(CV_SUCCESS);
+
+  retval = 0;
+
+  for (k=0; k<nj; k++) {
+    v = cv_mem->cv_zn[js[k]];
+    retval += (pack) ? N_VBufPack(v, buf) : N_VBufUnpack(v, buf);
+    buf += ca_mem->ca_ckvlen;
+  }
+
+  if (ck_mem->ck_quadr) {
+    for (k=0; k<nj; k++) {
+      v = cv_mem->cv_znQ[js[k]];
+      retval += (pack) ? N_VBufPack(v, buf) : N_VBufUnpack(v, buf);
+      buf += ca_mem->ca_ckvlenQ;
+    }
+  }
+
+  if (ck_mem->ck_sensi) {
+    for (k=0; k<nj; k++) {
+      for (is=0; is<ck_mem->ck_Ns; is++) {
+        v = cv_mem->cv_znS[js[k]][is];
+        retval += (pack) ? N_VBufPack(v, buf) : N_VBufUnpack(v, buf);
+        buf += ca_mem->ca_ckvlen;
+      }
+    }
+  }
+
+  if (ck_mem->ck_quadr_sensi) {
+    for (k=0; k<nj; k++) {
+      for (is=0; is<ck_mem->ck_Ns; is++) {
+        v = cv_mem->cv_znQS[js[k]][is];
+        retval += (pack) ? N_VBufPack(v, buf) : N_VBufUnpack(v, buf);
+        buf += ca_mem->ca_ckvlenQ;
+      }
+    }
+  }
+
+  return((retval == 0) ? CV_SUCCESS : CV_VECTOROP_ERR);
+}
+
+/* Length of a record rounded up to a multiple of the page size */
+static long int cvAstoreAligned(CVadjMem ca_mem, long int len)
+{
+  return(((len + ca_mem->ca_ckpage - 1) / ca_mem->ca_ckpage) *
+         ca_mem->ca_ckpage);
+}
+
+/*
+ * cvAstoreAlloc
+ *
+ * Returns the offset of alen bytes (a multiple of the page size) for a
+ * new record, taken from the first free extent that is large enough
+ * or else from the end of the file.
+ */
+
+static long int cvAstoreAlloc(CVadjMem ca_mem, long int alen)
+{
+  long int *fx, off;
+  int i, j;
+
+  fx = ca_mem->ca_ckfree;
+
+  for (i=0; i<ca_mem->ca_cknfree; i++) {
+    if (fx[2*i+1] < alen) continue;
+    off = fx[2*i];
+    fx[2*i]   += alen;
+    fx[2*i+1] -= alen;
+    if (fx[2*i+1] == 0) {
+      for (j=i+1; j<ca_mem->ca_cknfree; j++) {
+        fx[2*j-2] = fx[2*j];
+        fx[2*j-1] = fx[2*j+1];
+      }
+      ca_mem->ca_cknfree--;
+    }
+    return(off);
+  }
+
+  off = ca_mem->ca_ckfend;
+  ca_mem->ca_ckfend += alen;
+  return(off);
+}
+
+/*
+ * cvAstoreOpen
+ *
+ * Opens (or truncates) the check point file. Called from CVodeF at
+ * the first call after CVodeAdjInit or CVodeAdjReInit.
+ */
+
+int cvAstoreOpen(CVodeMem cv_mem)
+{
+  CVadjMem ca_mem;
+  N_Vector v;
+  booleantype quadr;
+
+  ca_mem = cv_mem->cv_adj_mem;
+
+  quadr = cv_mem->cv_quadr && cv_mem->cv_errconQ;
+
+  v = cv_mem->cv_tempv;
+  if ( (v->ops->nvbufsize == NULL) || (v->ops->nvbufpack == NULL) ||
+       (v->ops->nvbufunpack == NULL) ) {
+    cvProcessError(cv_mem, CV_ILL_INPUT, "CVODEA", "CVodeF", MSGCV_CKFILE_NVEC);
+    return(CV_ILL_INPUT);
+  }
+  if (N_VBufSize(v, &(ca_mem->ca_ckvlen)) != 0) {
+    cvProcessError(cv_mem, CV_ILL_INPUT, "CVODEA", "CVodeF", MSGCV_CKFILE_NVEC);
+    return(CV_ILL_INPUT);
+  }
+
+  ca_mem->ca_ckvlenQ = 0;
+  if (quadr) {
+    v = cv_mem->cv_tempvQ;
+    if ( (v->ops->nvbufsize == NULL) || (v->ops->nvbufpack == NULL) ||
+         (v->ops->nvbufunpack == NULL) ||
+         (N_VBufSize(v, &(ca_mem->ca_ckvlenQ)) != 0) ) {
+      cvProcessError(cv_mem, CV_ILL_INPUT, "CVODEA", "CVodeF", MSGCV_CKFILE_NVEC);
+      return(CV_ILL_INPUT);
+    }
+  }
+
+  if (ca_mem->ca_ckfd < 0) {
+    ca_mem->ca_ckfd = open(ca_mem->ca_ckfile, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (ca_mem->ca_ckfd < 0) {
+      cvProcessError(cv_mem, CV_ILL_INPUT, "CVODEA", "CVodeF", MSGCV_CKFILE_OPEN);
+      return(CV_ILL_INPUT);
+    }
+  } else if (ftruncate(ca_mem->ca_ckfd, 0) != 0) {
+    cvProcessError(cv_mem, CV_ILL_INPUT, "CVODEA", "CVodeF", MSGCV_CKFILE_IO);
+    return(CV_ILL_INPUT);
+  }
+
+  ca_mem->ca_ckfend  = 0;
+  ca_mem->ca_cknfree = 0;
+  ca_mem->ca_ckpage  = sysconf(_SC_PAGESIZE);
+  if (ca_mem->ca_ckpage <= 0) ca_mem->ca_ckpage = 4096;
+
+  return(CV_SUCCESS);
+}
+
+/*
+ * cvAstoreClose
+ *
+ * Closes and removes the check point file, if open, and frees the
+ * write buffer and the list of free extents.
+ */
+
+void cvAstoreClose(CVodeMem cv_mem)
+{
+  CVadjMem ca_mem;
+
+  ca_mem = cv_mem->cv_adj_mem;
+
+  if (ca_mem->ca_ckfd >= 0) {
+    close(ca_mem->ca_ckfd);
+    unlink(ca_mem->ca_ckfile);
+    ca_mem->ca_ckfd = -1;
+  }
+
+  free(ca_mem->ca_ckbuf);
+  ca_mem->ca_ckbuf    = NULL;
+  ca_mem->ca_ckbuflen = 0;
+  ca_mem->ca_ckfend   = 0;
+
+  free(ca_mem->ca_ckfree);
+  ca_mem->ca_ckfree    = NULL;
+  ca_mem->ca_cknfree   = 0;
+  ca_mem->ca_ckfreemax = 0;
+}
+
+/*
+ * cvAstoreWrite
+ *
+ * Writes the vectors of the current CVODES state, as described by
+ * the flags in ck_mem, to the check point file, in a free extent if
+ * one is large enough or else at the end of the file.
+ */
+
+int cvAstoreWrite(CVodeMem cv_mem, CkpntMem ck_mem)
+{
+  CVadjMem ca_mem;
+  long int len, off, done;
+  ssize_t nw;
+  int retval;
+
+  ca_mem = cv_mem->cv_adj_mem;
+
+  (void) cvAstoreVecs(cv_mem, ck_mem, NULL, SUNTRUE, &len);
+
+  if (len > ca_mem->ca_ckbuflen) {
+    free(ca_mem->ca_ckbuf);
+    ca_mem->ca_ckbuf = (char *) malloc(len);
+    if (ca_mem->ca_ckbuf == NULL) {
+      ca_mem->ca_ckbuflen = 0;
+      return(CV_MEM_FAIL);
+    }
+    ca_mem->ca_ckbuflen = len;
+  }
+
+  retval = cvAstoreVecs(cv_mem, ck_mem, ca_mem->ca_ckbuf, SUNTRUE, &len);
+  if (retval != CV_SUCCESS) return(retval);
+
+  off = cvAstoreAlloc(ca_mem, cvAstoreAligned(ca_mem, len));
+
+  done = 0;
+  while (done < len) {
+    nw = pwrite(ca_mem->ca_ckfd, ca_mem->ca_ckbuf + done, len - done,
+                (off_t) (off + done));
+    if (nw < 0 && errno == EINTR) continue;
+    if (nw <= 0) {
+      cvProcessError(cv_mem, CV_MEM_FAIL, "CVODEA", "CVodeF", MSGCV_CKFILE_IO);
+      return(CV_MEM_FAIL);
+    }
+    done += nw;
+  }
+
+  ck_mem->ck_stored = SUNTRUE;
+  ck_mem->ck_foff   = off;
+  ck_mem->ck_flen   = len;
+
+  return(CV_SUCCESS);
+}
+
+/*
+ * cvAstoreRead
+ *
+ * Maps the record of ck_mem and unpacks it into the Nordsieck arrays
+ * of cv_mem. The order q must have been restored already.
+ */
+
+int cvAstoreRead(CVodeMem cv_mem, CkpntMem ck_mem)
+{
+  CVadjMem ca_mem;
+  void *map;
+  long int len;
+  int retval;
+
+  ca_mem = cv_mem->cv_adj_mem;
+
+  map = mmap(NULL, (size_t) ck_mem->ck_flen, PROT_READ, MAP_PRIVATE,
+             ca_mem->ca_ckfd, (off_t) ck_mem->ck_foff);
+  if (map == MAP_FAILED) {
+    cvProcessError(cv_mem, CV_MEM_FAIL, "CVODEA", "CVodeB", MSGCV_CKFILE_IO);
+    return(CV_MEM_FAIL);
+  }
+
+  retval = cvAstoreVecs(cv_mem, ck_mem, (char *) map, SUNFALSE, &len);
+
+  munmap(map, (size_t) ck_mem->ck_flen);
+
+  return(retval);
+}
+
+/*
+ * cvAstorePrefetch
+ *
+ * Asks the operating system to read the record of ck_mem ahead.
+ */
+
+void cvAstorePrefetch(CVadjMem ca_mem, CkpntMem ck_mem)
+{
+  if (ck_mem == NULL || !ck_mem->ck_stored) return;
+
+  (void) posix_fadvise(ca_mem->ca_ckfd, (off_t) ck_mem->ck_foff,
+                       (off_t) ck_mem->ck_flen, POSIX_FADV_WILLNEED);
+}
+
+/*
+ * cvAstoreRelease
+ *
+ * Called before a check point is deleted. The extent of its record is
+ * added to the list of free extents, merged with adjacent free
+ * extents, and given back to the end of the file if it is the last
+ * one, so that the file does not grow beyond the records alive at the
+ * same time (e.g., temporary check points, see
+ * CVodeSetAdjMemoryBudget). If the list cannot grow the extent is not
+ * reused.
+ */
+
+void cvAstoreRelease(CVadjMem ca_mem, CkpntMem ck_mem)
+{
+  long int *fx, off, len;
+  int i, j, nmax;
+
+  if (!ck_mem->ck_stored) return;
+
+  off = ck_mem->ck_foff;
+  len = cvAstoreAligned(ca_mem, ck_mem->ck_flen);
+
+  /* position of the extent in the list sorted by offset */
+  fx = ca_mem->ca_ckfree;
+  for (i=0; i<ca_mem->ca_cknfree; i++)
+    if (fx[2*i] > off) break;
+
+  if ((i > 0) && (fx[2*i-2] + fx[2*i-1] == off)) {
+
+    /* merge with the previous extent, and with the next one if adjacent */
+    fx[2*i-1] += len;
+    if ((i < ca_mem->ca_cknfree) && (off + len == fx[2*i])) {
+      fx[2*i-1] += fx[2*i+1];
+      for (j=i+1; j<ca_mem->ca_cknfree; j++) {
+        fx[2*j-2] = fx[2*j];
+        fx[2*j-1] = fx[2*j+1];
+      }
+      ca_mem->ca_cknfree--;
+    }
+    i--;
+
+  } else if ((i < ca_mem->ca_cknfree) && (off + len == fx[2*i])) {
+
+    /* merge with the next extent */
+    fx[2*i]    = off;
+    fx[2*i+1] += len;
+
+  } else {
+
+    /* insert a new extent */
+    if (ca_mem->ca_cknfree == ca_mem->ca_ckfreemax) {
+      nmax = 2 * ca_mem->ca_ckfreemax + 8;
+      fx = (long int *) realloc(ca_mem->ca_ckfree, 2 * nmax * sizeof(long int));
+      if (fx == NULL) {
+        /* the space is only lost if the record is not the last one */
+        if (off + len == ca_mem->ca_ckfend) ca_mem->ca_ckfend = off;
+        return;
+      }
+      ca_mem->ca_ckfree    = fx;
+      ca_mem->ca_ckfreemax = nmax;
+    }
+    for (j=ca_mem->ca_cknfree; j>i; j--) {
+      fx[2*j]   = fx[2*j-2];
+      fx[2*j+1] = fx[2*j-1];
+    }
+    fx[2*i]   = off;
+    fx[2*i+1] = len;
+    ca_mem->ca_cknfree++;
+
+  }
+
+  /* give the last extent back to the end of the file */
+  if ((i == ca_mem->ca_cknfree - 1) &&
+      (fx[2*i] + fx[2*i+1] == ca_mem->ca_ckfend)) {
+    ca_mem->ca_ckfend = fx[2*i];
+    ca_mem->ca_cknfree--;
+  }
+}
+
+#else
+
+/* Check point files are not supported, CVodeSetAdjCheckpointFile
+   returns an error so these are not called */
+
+int cvAstoreOpen(CVodeMem cv_mem)
+{
+  cvProcessError(cv_mem, CV_ILL_INPUT, "CVODEA", "CVodeF", MSGCV_CKFILE_NONE);
+  return(CV_ILL_INPUT);
+}
+
+void cvAstoreClose(CVodeMem cv_mem)
+{
+  return;
+}
+
+int cvAstoreWrite(CVodeMem cv_mem, CkpntMem ck_mem)
+{
+  return(CV_ILL_INPUT);
+}
+
+int cvAstoreRead(CVodeMem cv_mem, CkpntMem ck_mem)
+{
+  return(CV_ILL_INPUT);
+}
+
+void cvAstorePrefetch(CVadjMem ca_mem, CkpntMem ck_mem)
+{
+  return;
+}
+
+void cvAstoreRelease(CVadjMem ca_mem, CkpntMem ck_mem)
+{
+  return;
+}
+
+#endif
@@ -767,6 +767,21 @@ struct CkpntMemRec {
   /* Saved values */
   realtype ck_saved_tq5;
 
+  /* Memory budget mode: number of segments of nsteps steps between t0
+     and t1, number of segments between t0 and trev that have not been
+     processed by the backward problems, and whether this is a temporary
+     check point. Without a budget nseg = nrev = 1 and trev = t1. */
+  long int    ck_nseg;
+  long int    ck_nrev;
+  realtype    ck_trev;
+  booleantype ck_temp;
+
+  /* Check point file: are the vectors stored in the file (instead of
+     ck_zn, ck_znQ, ...) and, if so, the offset and length of the record */
+  booleantype ck_stored;
+  long int    ck_foff;
+  long int    ck_flen;
+
   /* Pointer to next structure in list */
   struct CkpntMemRec *ck_next;
 
@@ -943,6 +958,40 @@ struct CVadjMemRec {
   /* address of the check point structure for which data is available */
   struct CkpntMemRec *ca_ckpntData;
 
+  /* Memory budget mode (see CVodeSetAdjMemoryBudget)
+   *   - base check points are kept from the forward pass at segments
+   *     that are multiples of ca_stride (thinned when full)
+   *   - temporary check points are placed by binomial (revolve)
+   *     checkpointing during the backward pass and released once the
+   *     segment they start has been processed */
+  booleantype ca_budget;      /* is a memory budget set?                  */
+  long int ca_budgetBytes;    /* memory budget in bytes                   */
+  int ca_nbaseMax;            /* max. number of base check points         */
+  int ca_ntempMax;            /* max. number of temporary check points    */
+  int ca_nbase;               /* current number of base check points      */
+  int ca_ntemp;               /* current number of temporary check points */
+  long int ca_stride;         /* segments between base check points       */
+  long int ca_lastBase;       /* segment of the newest base check point   */
+  long int ca_nstRecomp;      /* forward steps recomputed to place
+                                 temporary check points                   */
+
+  /* Check point file (see CVodeSetAdjCheckpointFile). The vectors of all
+     but the initial check point are packed with N_VBufPack and appended
+     to the file, each record starting on a page boundary so that it can
+     be memory mapped when the check point is restored. The extents of
+     released records are kept, sorted by offset, and reused. */
+  char *ca_ckfile;            /* file name or NULL                        */
+  int ca_ckfd;                /* file descriptor or -1 if not open        */
+  long int ca_ckfend;         /* end of the last record in the file       */
+  long int *ca_ckfree;        /* free extents, offset 2*i and length 2*i+1 */
+  int ca_cknfree;             /* number of free extents                   */
+  int ca_ckfreemax;           /* capacity of ca_ckfree in extents         */
+  long int ca_ckpage;         /* page size                                */
+  sunindextype ca_ckvlen;     /* buffer size of one state vector          */
+  sunindextype ca_ckvlenQ;    /* buffer size of one quadrature vector     */
+  char *ca_ckbuf;             /* buffer used to write a record            */
+  long int ca_ckbuflen;       /* length of ca_ckbuf                       */
+
   /* ------------------
    * Interpolation data
    * ------------------ */
@@ -1197,6 +1246,15 @@ int cvSensRhs1InternalDQ(int Ns, realtype t,
                          void *fS_data,
                          N_Vector tempv, N_Vector ftemp);
 
+/* Prototypes for the adjoint check point file */
+
+int cvAstoreOpen(CVodeMem cv_mem);
+void cvAstoreClose(CVodeMem cv_mem);
+int cvAstoreWrite(CVodeMem cv_mem, CkpntMem ck_mem);
+int cvAstoreRead(CVodeMem cv_mem, CkpntMem ck_mem);
+void cvAstorePrefetch(CVadjMem ca_mem, CkpntMem ck_mem);
+void cvAstoreRelease(CVadjMem ca_mem, CkpntMem ck_mem);
+
 /*
  * =================================================================
  *    E R R O R    M E S S A G E S
@@ -1369,6 +1427,15 @@ int cvSensRhs1InternalDQ(int Ns, realtype t,
 
 #define MSGCV_NO_ADJ      "Illegal attempt to call before calling CVodeAdjMalloc."
 #define MSGCV_BAD_STEPS   "Steps nonpositive illegal."
+#define MSGCV_NEG_BUDGET  "nbytes < 0 illegal."
+#define MSGCV_BAD_BUDGET  "The memory budget is too small for two check points and the data points between them."
+#define MSGCV_BUDGET_FWD  "The memory budget must be set before the first call to CVodeF."
+#define MSGCV_BUDGET_NVEC "The memory budget requires the N_Vector space operation."
+#define MSGCV_CKFILE_FWD  "The check point file must be set before the first call to CVodeF."
+#define MSGCV_CKFILE_NONE "Check point files are not supported on this platform."
+#define MSGCV_CKFILE_NVEC "The check point file requires the N_Vector buffer operations."
+#define MSGCV_CKFILE_OPEN "The check point file could not be opened."
+#define MSGCV_CKFILE_IO   "Reading or writing the check point file failed."
 #define MSGCV_BAD_INTERP  "Illegal value for interp."
 #define MSGCV_BAD_WHICH   "Illegal value for which."
 #define MSGCV_NO_BCK      "No backward problems have been defined yet."
@@ -276,6 +276,7 @@ int CVodeSetLinearSolver(void *cvode_mem, SUNLinearSolver LS,
   cvls_mem->jbad       = SUNTRUE;
   cvls_mem->dgmax_jbad = CVLS_DGMAX;
   cvls_mem->eplifac    = CVLS_EPLIN;
+  cvls_mem->eplmax     = CVLS_EPLMX;
   cvls_mem->last_flag  = CVLS_SUCCESS;
 
   /* If LS supports ATimes, attach CVLs routine */
@@ -436,6 +437,32 @@ int CVodeSetEpsLin(void *cvode_mem, realtype eplifac)
 }
 
 
+/* CVodeSetEpsLinMax specifies the maximum nonlinear -> linear tolerance
+   scale factor used when relaxing the tolerance by a forcing term */
+int CVodeSetEpsLinMax(void *cvode_mem, realtype eplmax)
+{
+  CVodeMem cv_mem;
+  CVLsMem  cvls_mem;
+  int      retval;
+
+  /* access CVLsMem structure */
+  retval = cvLs_AccessLMem(cvode_mem, "CVodeSetEpsLinMax",
+                           &cv_mem, &cvls_mem);
+  if (retval != CVLS_SUCCESS)  return(retval);
+
+  /* Check for legal eplmax */
+  if(eplmax < ZERO) {
+    cvProcessError(cv_mem, CVLS_ILL_INPUT, "CVSLS",
+                   "CVodeSetEpsLinMax", MSG_LS_BAD_EPLMAX);
+    return(CVLS_ILL_INPUT);
+  }
+
+  cvls_mem->eplmax = (eplmax == ZERO) ? CVLS_EPLMX : eplmax;
+
+  return(CVLS_SUCCESS);
+}
+
+
 /* CVodeSetLSNormFactor sets or computes the factor to use when converting from
    the integrator tolerance to the linear solver tolerance (WRMS to L2 norm). */
 int CVodeSetLSNormFactor(void *cvode_mem, realtype nrmfac)
@@ -1724,9 +1751,10 @@ int cvLsSolve(CVodeMem cv_mem, N_Vector b, N_Vector weight,
 {
   CVLsMem  cvls_mem;
   realtype bnorm = ZERO;
-  realtype deltar, delta, w_mean;
+  realtype deltar, delta, w_mean, eta;
   int      curiter, nli_inc, retval;
   booleantype do_sensi_sim, do_sensi_stg, do_sensi_stg1;
+  SUNNonlinearSolver NLS;
 #if SUNDIALS_LOGGING_LEVEL >= SUNDIALS_LOGGING_DEBUG
   realtype resnorm;
   long int nps_inc;
@@ -1745,15 +1773,21 @@ int cvLsSolve(CVodeMem cv_mem, N_Vector b, N_Vector weight,
   do_sensi_stg  = (cv_mem->cv_sensi && (cv_mem->cv_ism==CV_STAGGERED));
   do_sensi_stg1 = (cv_mem->cv_sensi && (cv_mem->cv_ism==CV_STAGGERED1));
 
-  /* get current nonlinear solver iteration */
+  /* get the active nonlinear solver */
   if (do_sensi_sim)
-    retval = SUNNonlinSolGetCurIter(cv_mem->NLSsim, &curiter);
+    NLS = cv_mem->NLSsim;
   else if (do_sensi_stg && cv_mem->sens_solve)
-    retval = SUNNonlinSolGetCurIter(cv_mem->NLSstg, &curiter);
+    NLS = cv_mem->NLSstg;
   else if (do_sensi_stg1 && cv_mem->sens_solve)
-    retval = SUNNonlinSolGetCurIter(cv_mem->NLSstg1, &curiter);
+    NLS = cv_mem->NLSstg1;
   else
-    retval = SUNNonlinSolGetCurIter(cv_mem->NLS, &curiter);
+    NLS = cv_mem->NLS;
+
+  /* get current nonlinear solver iteration and forcing term */
+  retval = SUNNonlinSolGetCurIter(NLS, &curiter);
+  if (retval != SUN_NLS_SUCCESS) return(-1);
+  retval = SUNNonlinSolGetForcingTerm(NLS, &eta);
+  if (retval != SUN_NLS_SUCCESS) return(-1);
 
   /* If the linear solver is iterative:
      test norm(b), if small, return x = 0 or x = b;
@@ -1766,8 +1800,12 @@ int cvLsSolve(CVodeMem cv_mem, N_Vector b, N_Vector weight,
       cvls_mem->last_flag = CVLS_SUCCESS;
       return(cvls_mem->last_flag);
     }
+    /* Relax the tolerance to the forcing term of the active nonlinear
+       solver (if any), limited to eplmax times tq[4] */
+    delta = SUNMAX(deltar, SUNMIN(eta * bnorm,
+                                  cvls_mem->eplmax * cv_mem->cv_tq[4]));
     /* Adjust tolerance for 2-norm */
-    delta = deltar * cvls_mem->nrmfac;
+    delta = delta * cvls_mem->nrmfac;
   } else {
     delta = ZERO;
   }
@@ -2188,6 +2226,26 @@ int CVodeSetEpsLinB(void *cvode_mem, int which, realtype eplifacB)
 }
 
 
+int CVodeSetEpsLinMaxB(void *cvode_mem, int which, realtype eplmaxB)
+{
+  CVodeMem  cv_mem;
+  CVadjMem  ca_mem;
+  CVodeBMem cvB_mem;
+  CVLsMemB  cvlsB_mem;
+  void     *cvodeB_mem;
+  int       retval;
+
+  /* access relevant memory structures */
+  retval = cvLs_AccessLMemB(cvode_mem, which, "CVodeSetEpsLinMaxB",
+                            &cv_mem, &ca_mem, &cvB_mem, &cvlsB_mem);
+  if (retval != CVLS_SUCCESS)  return(retval);
+
+  /* call corresponding routine for cvodeB_mem structure */
+  cvodeB_mem = (void *) (cvB_mem->cv_mem);
+  return(CVodeSetEpsLinMax(cvodeB_mem, eplmaxB));
+}
+
+
 int CVodeSetLSNormFactorB(void *cvode_mem, int which, realtype nrmfacB)
 {
   CVodeMem  cv_mem;
@@ -36,10 +36,15 @@ extern "C" {
   CVLS_EPLIN  default value for factor by which the tolerance on
               the nonlinear iteration is multiplied to get a
               tolerance on the linear iteration
+  CVLS_EPLMX  default value for the maximum factor by which the
+              tolerance on the nonlinear iteration is multiplied when
+              the linear tolerance is relaxed by a nonlinear solver
+              forcing term
   -----------------------------------------------------------------*/
 #define CVLS_MSBJ   51
 #define CVLS_DGMAX  RCONST(0.2)
 #define CVLS_EPLIN  RCONST(0.05)
+#define CVLS_EPLMX  RCONST(0.1)
 
 
 /*=================================================================
@@ -70,6 +75,7 @@ typedef struct CVLsMemRec {
 
   /* Iterative solver tolerance */
   realtype eplifac;   /* nonlinear -> linear tol scaling factor       */
+  realtype eplmax;    /* max nonlinear -> linear tol scaling factor   */
   realtype nrmfac;    /* integrator -> LS norm conversion factor      */
 
   /* Linear solver, matrix and vector objects/pointers */
@@ -226,6 +232,7 @@ int cvLs_AccessLMemBCur(void *cvode_mem, const char *fname,
 #define MSG_LS_LMEM_NULL      "Linear solver memory is NULL."
 #define MSG_LS_BAD_SIZES      "Illegal bandwidth parameter(s). Must have 0 <=  ml, mu <= N-1."
 #define MSG_LS_BAD_EPLIN      "eplifac < 0 illegal."
+#define MSG_LS_BAD_EPLMAX     "eplmax < 0 illegal."
 #define MSG_LS_BAD_PRETYPE    "Illegal value for pretype. Legal values are PREC_NONE, PREC_LEFT, PREC_RIGHT, and PREC_BOTH."
 #define MSG_LS_PSOLVE_REQ     "pretype != PREC_NONE, but PSOLVE = NULL is illegal."
 #define MSG_LS_BAD_GSTYPE     "Illegal value for gstype. Legal values are MODIFIED_GS and CLASSICAL_GS."
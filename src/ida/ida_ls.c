@@ -24,6 +24,7 @@
 #include <sundials/sundials_math.h>
 #include <sundials/sundials_linearsolver.h>
 #include <sunmatrix/sunmatrix_band.h>
+#include <sunmatrix/sunmatrix_blockdense.h>
 #include <sunmatrix/sunmatrix_dense.h>
 #include <sunmatrix/sunmatrix_sparse.h>
 
@@ -32,6 +33,7 @@
 #define ZERO       RCONST(0.0)
 #define PT25       RCONST(0.25)
 #define PT05       RCONST(0.05)
+#define PT1        RCONST(0.1)
 #define PT9        RCONST(0.9)
 #define ONE        RCONST(1.0)
 #define TWO        RCONST(2.0)
@@ -192,6 +194,7 @@ int IDASetLinearSolver(void *ida_mem, SUNLinearSolver LS, SUNMatrix A)
 
   /* Set default values for the rest of the Ls parameters */
   idals_mem->eplifac   = PT05;
+  idals_mem->eplmax    = PT1;
   idals_mem->dqincfac  = ONE;
   idals_mem->last_flag = IDALS_SUCCESS;
 
@@ -328,6 +331,32 @@ int IDASetEpsLin(void *ida_mem, realtype eplifac)
 }
 
 
+/* IDASetEpsLinMax specifies the maximum nonlinear -> linear tolerance scale
+   factor used when relaxing the tolerance by a nonlinear solver forcing term */
+int IDASetEpsLinMax(void *ida_mem, realtype eplmax)
+{
+  IDAMem   IDA_mem;
+  IDALsMem idals_mem;
+  int      retval;
+
+  /* access IDALsMem structure */
+  retval = idaLs_AccessLMem(ida_mem, "IDASetEpsLinMax",
+                            &IDA_mem, &idals_mem);
+  if (retval != IDALS_SUCCESS)  return(retval);
+
+  /* Check for legal eplmax */
+  if (eplmax < ZERO) {
+    IDAProcessError(IDA_mem, IDALS_ILL_INPUT, "IDALS",
+                    "IDASetEpsLinMax", MSG_LS_NEG_EPLMAX);
+    return(IDALS_ILL_INPUT);
+  }
+
+  idals_mem->eplmax = (eplmax == ZERO) ? PT1 : eplmax;
+
+  return(IDALS_SUCCESS);
+}
+
+
 /* IDASetWRMSNormFactor sets or computes the factor to use when converting from
    the integrator tolerance to the linear solver tolerance (WRMS to L2 norm). */
 int IDASetLSNormFactor(void *ida_mem, realtype nrmfac)
@@ -957,6 +986,9 @@ int idaLsDQJac(realtype t, realtype c_j, N_Vector y, N_Vector yp,
     retval = idaLsDenseDQJac(t, c_j, y, yp, r, Jac, IDA_mem, tmp1);
   } else if (SUNMatGetID(Jac) == SUNMATRIX_BAND) {
     retval = idaLsBandDQJac(t, c_j, y, yp, r, Jac, IDA_mem, tmp1, tmp2, tmp3);
+  } else if (SUNMatGetID(Jac) == SUNMATRIX_BLOCKDENSE) {
+    retval = idaLsBlockDenseDQJac(t, c_j, y, yp, r, Jac, IDA_mem,
+                                  tmp1, tmp2, tmp3);
   } else {
     IDAProcessError(IDA_mem, IDA_ILL_INPUT, "IDALS",
                     "idaLsDQJac",
@@ -1190,6 +1222,126 @@ int idaLsBandDQJac(realtype tt, realtype c_j, N_Vector yy,
 }
 
 
+/*---------------------------------------------------------------
+  idaLsBlockDenseDQJac
+
+  This routine generates a block-diagonal difference quotient
+  approximation JJ to the DAE system Jacobian J. It assumes a
+  SUNMATRIX_BLOCKDENSE input with nblocks uncoupled blocks of
+  size M, so column j of every block is perturbed at the same
+  time and the Jacobian is constructed using M calls to the res
+  routine. The return value is either 0 or the nonzero value
+  returned by the res routine, if any.
+  ---------------------------------------------------------------*/
+int idaLsBlockDenseDQJac(realtype tt, realtype c_j, N_Vector yy,
+                         N_Vector yp, N_Vector rr, SUNMatrix Jac,
+                         IDAMem IDA_mem, N_Vector tmp1, N_Vector tmp2,
+                         N_Vector tmp3)
+{
+  realtype inc, inc_inv, yj, ypj, srur, conj, ewtj;
+  realtype *y_data, *yp_data, *ewt_data, *cns_data = NULL;
+  realtype *ytemp_data, *yptemp_data, *rtemp_data, *r_data;
+  N_Vector rtemp, ytemp, yptemp;
+  sunindextype i, j, k, jk, M, nblocks;
+  IDALsMem idals_mem;
+  int retval = 0;
+
+  /* access LsMem interface structure */
+  idals_mem = (IDALsMem) IDA_mem->ida_lmem;
+
+  /* access matrix dimensions */
+  M = SUNBlockDenseMatrix_BlockRows(Jac);
+  nblocks = SUNBlockDenseMatrix_NumBlocks(Jac);
+
+  /* Rename work vectors for use as temporary values of r, y and yp */
+  rtemp = tmp1;
+  ytemp = tmp2;
+  yptemp= tmp3;
+
+  /* Obtain pointers to the data for all eight vectors used.  */
+  ewt_data    = N_VGetArrayPointer(IDA_mem->ida_ewt);
+  r_data      = N_VGetArrayPointer(rr);
+  y_data      = N_VGetArrayPointer(yy);
+  yp_data     = N_VGetArrayPointer(yp);
+  rtemp_data  = N_VGetArrayPointer(rtemp);
+  ytemp_data  = N_VGetArrayPointer(ytemp);
+  yptemp_data = N_VGetArrayPointer(yptemp);
+  if (IDA_mem->ida_constraintsSet)
+    cns_data = N_VGetArrayPointer(IDA_mem->ida_constraints);
+
+  /* Initialize ytemp and yptemp. */
+  N_VScale(ONE, yy, ytemp);
+  N_VScale(ONE, yp, yptemp);
+
+  /* Compute miscellaneous values for the Jacobian computation. */
+  srur = SUNRsqrt(IDA_mem->ida_uround);
+
+  /* Loop over the columns of a block. */
+  for (j=0; j<M; j++) {
+
+    /* Increment yy[j] and yp[j] in all blocks. */
+    for (k=0; k<nblocks; k++) {
+      jk = k*M + j;
+      yj = y_data[jk];
+      ypj = yp_data[jk];
+      ewtj = ewt_data[jk];
+
+      /* Set increment inc to yj based on sqrt(uround)*abs(yj), with
+      adjustments using ypj and ewtj if this is small, and a further
+      adjustment to give it the same sign as hh*ypj. */
+      inc = SUNMAX( srur * SUNMAX( SUNRabs(yj), SUNRabs(IDA_mem->ida_hh*ypj) ),
+                    ONE/ewtj );
+      if (IDA_mem->ida_hh*ypj < ZERO)  inc = -inc;
+      inc = (yj + inc) - yj;
+
+      /* Adjust sign(inc) again if yj has an inequality constraint. */
+      if (IDA_mem->ida_constraintsSet) {
+        conj = cns_data[jk];
+        if (SUNRabs(conj) == ONE)      {if((yj+inc)*conj <  ZERO) inc = -inc;}
+        else if (SUNRabs(conj) == TWO) {if((yj+inc)*conj <= ZERO) inc = -inc;}
+      }
+
+      /* Increment yj and ypj. */
+      ytemp_data[jk] += inc;
+      yptemp_data[jk] += IDA_mem->ida_cj*inc;
+    }
+
+    /* Call res routine with incremented arguments. */
+    retval = IDA_mem->ida_res(tt, ytemp, yptemp, rtemp, IDA_mem->ida_user_data);
+    idals_mem->nreDQ++;
+    if (retval != 0) break;
+
+    /* Loop over the blocks again. */
+    for (k=0; k<nblocks; k++) {
+      jk = k*M + j;
+
+      /* Reset ytemp and yptemp components that were perturbed. */
+      yj = ytemp_data[jk]  = y_data[jk];
+      ypj = yptemp_data[jk] = yp_data[jk];
+      ewtj = ewt_data[jk];
+
+      /* Set increment inc exactly as above. */
+      inc = SUNMAX( srur * SUNMAX( SUNRabs(yj), SUNRabs(IDA_mem->ida_hh*ypj) ),
+                    ONE/ewtj );
+      if (IDA_mem->ida_hh*ypj < ZERO)  inc = -inc;
+      inc = (yj + inc) - yj;
+      if (IDA_mem->ida_constraintsSet) {
+        conj = cns_data[jk];
+        if (SUNRabs(conj) == ONE)      {if((yj+inc)*conj <  ZERO) inc = -inc;}
+        else if (SUNRabs(conj) == TWO) {if((yj+inc)*conj <= ZERO) inc = -inc;}
+      }
+
+      /* Load the difference quotient Jacobian elements for column j */
+      inc_inv = ONE/inc;
+      for (i=0; i<M; i++)
+        SM_ELEMENT_BD(Jac,k,i,j) = inc_inv * (rtemp_data[k*M+i]-r_data[k*M+i]);
+    }
+  }
+
+  return(retval);
+}
+
+
 /*---------------------------------------------------------------
   idaLsDQJtimes
 
@@ -1285,13 +1437,15 @@ int idaLsInitialize(IDAMem IDA_mem)
   } else if (idals_mem->jacDQ) {
 
     /* If J is non-NULL, and 'jac' is not user-supplied:
-       - if J is dense or band, ensure that our DQ approx. is used
+       - if J is dense, band or block-diagonal dense, ensure that our
+         DQ approx. is used
        - otherwise => error */
     retval = 0;
     if (idals_mem->J->ops->getid) {
 
       if ( (SUNMatGetID(idals_mem->J) == SUNMATRIX_DENSE) ||
-           (SUNMatGetID(idals_mem->J) == SUNMATRIX_BAND) ) {
+           (SUNMatGetID(idals_mem->J) == SUNMATRIX_BAND) ||
+           (SUNMatGetID(idals_mem->J) == SUNMATRIX_BLOCKDENSE) ) {
         idals_mem->jac    = idaLsDQJac;
         idals_mem->J_data = IDA_mem;
       } else {
@@ -1435,7 +1589,7 @@ int idaLsSolve(IDAMem IDA_mem, N_Vector b, N_Vector weight,
 {
   IDALsMem idals_mem;
   int      nli_inc, retval;
-  realtype tol, w_mean;
+  realtype tol, w_mean, eta;
 
   /* access IDALsMem structure */
   if (IDA_mem->ida_lmem == NULL) {
@@ -1451,7 +1605,18 @@ int idaLsSolve(IDAMem IDA_mem, N_Vector b, N_Vector weight,
      applied to the WRMS norm of the residual vector, rather than the
      weighted L2 norm. */
   if (idals_mem->iterative) {
-    tol = idals_mem->nrmfac * idals_mem->eplifac * IDA_mem->ida_epsNewt;
+    tol = idals_mem->eplifac * IDA_mem->ida_epsNewt;
+    /* Use the nonlinear solver forcing term (if any) as a relative
+       tolerance, limited to eplmax times the Newton tolerance */
+    eta = ZERO;
+    if (IDA_mem->NLS != NULL) {
+      retval = SUNNonlinSolGetForcingTerm(IDA_mem->NLS, &eta);
+      if (retval != SUN_NLS_SUCCESS) return(-1);
+    }
+    if (eta > ZERO)
+      tol = SUNMAX(tol, SUNMIN(eta * N_VWrmsNorm(b, weight),
+                               idals_mem->eplmax * IDA_mem->ida_epsNewt));
+    tol *= idals_mem->nrmfac;
   } else {
     tol = ZERO;
   }
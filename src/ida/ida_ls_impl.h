@@ -58,6 +58,7 @@ typedef struct IDALsMemRec {
 
   /* Iterative solver tolerance */
   realtype eplifac;   /* nonlinear -> linear tol scaling factor       */
+  realtype eplmax;    /* max nonlinear -> linear tol scaling factor   */
   realtype nrmfac;    /* integrator -> LS norm conversion factor      */
 
   /* Statistics and associated parameters */
@@ -135,6 +136,10 @@ int idaLsBandDQJac(realtype tt, realtype c_j,  N_Vector yy,
                    N_Vector yp, N_Vector rr, SUNMatrix Jac,
                    IDAMem IDA_mem, N_Vector tmp1,
                    N_Vector tmp2, N_Vector tmp3);
+int idaLsBlockDenseDQJac(realtype tt, realtype c_j, N_Vector yy,
+                         N_Vector yp, N_Vector rr, SUNMatrix Jac,
+                         IDAMem IDA_mem, N_Vector tmp1,
+                         N_Vector tmp2, N_Vector tmp3);
 
 /* Generic linit/lsetup/lsolve/lperf/lfree interface routines for IDA to call */
 int idaLsInitialize(IDAMem IDA_mem);
@@ -177,6 +182,7 @@ int idaLs_AccessLMem(void* ida_mem, const char* fname,
 #define MSG_LS_BAD_GSTYPE     "gstype has an illegal value."
 #define MSG_LS_NEG_MAXRS      "maxrs < 0 illegal."
 #define MSG_LS_NEG_EPLIFAC    "eplifac < 0.0 illegal."
+#define MSG_LS_NEG_EPLMAX     "eplmax < 0.0 illegal."
 #define MSG_LS_NEG_DQINCFAC   "dqincfac < 0.0 illegal."
 #define MSG_LS_PSET_FAILED    "The preconditioner setup routine failed in an unrecoverable manner."
 #define MSG_LS_PSOLVE_FAILED  "The preconditioner solve routine failed in an unrecoverable manner."
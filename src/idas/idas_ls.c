@@ -32,6 +32,7 @@
 #define ZERO       RCONST(0.0)
 #define PT25       RCONST(0.25)
 #define PT05       RCONST(0.05)
+#define PT1        RCONST(0.1)
 #define PT9        RCONST(0.9)
 #define ONE        RCONST(1.0)
 #define TWO        RCONST(2.0)
@@ -243,6 +244,7 @@ int IDASetLinearSolver(void *ida_mem, SUNLinearSolver LS, SUNMatrix A)
 
   /* Set default values for the rest of the Ls parameters */
   idals_mem->eplifac   = PT05;
+  idals_mem->eplmax    = PT1;
   idals_mem->dqincfac  = ONE;
   idals_mem->last_flag = IDALS_SUCCESS;
 
@@ -379,6 +381,32 @@ int IDASetEpsLin(void *ida_mem, realtype eplifac)
 }
 
 
+/* IDASetEpsLinMax specifies the maximum nonlinear -> linear tolerance scale
+   factor used when relaxing the tolerance by a nonlinear solver forcing term */
+int IDASetEpsLinMax(void *ida_mem, realtype eplmax)
+{
+  IDAMem   IDA_mem;
+  IDALsMem idals_mem;
+  int      retval;
+
+  /* access IDALsMem structure */
+  retval = idaLs_AccessLMem(ida_mem, "IDASetEpsLinMax",
+                            &IDA_mem, &idals_mem);
+  if (retval != IDALS_SUCCESS)  return(retval);
+
+  /* Check for legal eplmax */
+  if (eplmax < ZERO) {
+    IDAProcessError(IDA_mem, IDALS_ILL_INPUT, "IDASLS",
+                    "IDASetEpsLinMax", MSG_LS_NEG_EPLMAX);
+    return(IDALS_ILL_INPUT);
+  }
+
+  idals_mem->eplmax = (eplmax == ZERO) ? PT1 : eplmax;
+
+  return(IDALS_SUCCESS);
+}
+
+
 /* IDASetWRMSNormFactor sets or computes the factor to use when converting from
    the integrator tolerance to the linear solver tolerance (WRMS to L2 norm). */
 int IDASetLSNormFactor(void *ida_mem, realtype nrmfac)
@@ -1486,7 +1514,7 @@ int idaLsSolve(IDAMem IDA_mem, N_Vector b, N_Vector weight,
 {
   IDALsMem idals_mem;
   int      nli_inc, retval;
-  realtype tol, w_mean;
+  realtype tol, w_mean, eta;
 
   /* access IDALsMem structure */
   if (IDA_mem->ida_lmem == NULL) {
@@ -1502,7 +1530,31 @@ int idaLsSolve(IDAMem IDA_mem, N_Vector b, N_Vector weight,
      applied to the WRMS norm of the residual vector, rather than the
      weighted L2 norm. */
   if (idals_mem->iterative) {
-    tol = idals_mem->nrmfac * idals_mem->eplifac * IDA_mem->ida_epsNewt;
+    tol = idals_mem->eplifac * IDA_mem->ida_epsNewt;
+    /* Use the nonlinear solver forcing term (if any) as a relative
+       tolerance, limited to eplmax times the Newton tolerance. The forcing
+       term is zero outside of a nonlinear solve, so with staggered
+       sensitivities at most one of NLS and NLSstg reports a nonzero value. */
+    eta = ZERO;
+    if (IDA_mem->ida_sensi && (IDA_mem->ida_ism == IDA_SIMULTANEOUS)) {
+      if (IDA_mem->NLSsim != NULL) {
+        retval = SUNNonlinSolGetForcingTerm(IDA_mem->NLSsim, &eta);
+        if (retval != SUN_NLS_SUCCESS) return(-1);
+      }
+    } else {
+      if (IDA_mem->NLS != NULL) {
+        retval = SUNNonlinSolGetForcingTerm(IDA_mem->NLS, &eta);
+        if (retval != SUN_NLS_SUCCESS) return(-1);
+      }
+      if ((eta <= ZERO) && IDA_mem->ida_sensi && (IDA_mem->NLSstg != NULL)) {
+        retval = SUNNonlinSolGetForcingTerm(IDA_mem->NLSstg, &eta);
+        if (retval != SUN_NLS_SUCCESS) return(-1);
+      }
+    }
+    if (eta > ZERO)
+      tol = SUNMAX(tol, SUNMIN(eta * N_VWrmsNorm(b, weight),
+                               idals_mem->eplmax * IDA_mem->ida_epsNewt));
+    tol *= idals_mem->nrmfac;
   } else {
     tol = ZERO;
   }
@@ -1958,6 +2010,26 @@ int IDASetEpsLinB(void *ida_mem, int which, realtype eplifacB)
 }
 
 
+int IDASetEpsLinMaxB(void *ida_mem, int which, realtype eplmaxB)
+{
+  IDAadjMem IDAADJ_mem;
+  IDAMem    IDA_mem;
+  IDABMem   IDAB_mem;
+  IDALsMemB idalsB_mem;
+  void     *ida_memB;
+  int       retval;
+
+  /* access relevant memory structures */
+  retval = idaLs_AccessLMemB(ida_mem, which, "IDASetEpsLinMaxB", &IDA_mem,
+                             &IDAADJ_mem, &IDAB_mem, &idalsB_mem);
+  if (retval != IDALS_SUCCESS)  return(retval);
+
+  /* call corresponding routine for IDAB_mem structure */
+  ida_memB = (void *) IDAB_mem->IDA_mem;
+  return(IDASetEpsLinMax(ida_memB, eplmaxB));
+}
+
+
 int IDASetLSNormFactorB(void *ida_mem, int which, realtype nrmfacB)
 {
   IDAadjMem IDAADJ_mem;
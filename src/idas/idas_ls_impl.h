@@ -58,6 +58,7 @@ typedef struct IDALsMemRec {
 
   /* Iterative solver tolerance */
   realtype eplifac;   /* nonlinear -> linear tol scaling factor       */
+  realtype eplmax;    /* max nonlinear -> linear tol scaling factor   */
   realtype nrmfac;    /* integrator -> LS norm conversion factor      */
 
   /* Statistics and associated parameters */
@@ -177,6 +178,7 @@ int idaLs_AccessLMem(void* ida_mem, const char* fname,
 #define MSG_LS_BAD_GSTYPE     "gstype has an illegal value."
 #define MSG_LS_NEG_MAXRS      "maxrs < 0 illegal."
 #define MSG_LS_NEG_EPLIFAC    "eplifac < 0.0 illegal."
+#define MSG_LS_NEG_EPLMAX     "eplmax < 0.0 illegal."
 #define MSG_LS_NEG_DQINCFAC   "dqincfac < 0.0 illegal."
 #define MSG_LS_PSET_FAILED    "The preconditioner setup routine failed in an unrecoverable manner."
 #define MSG_LS_PSOLVE_FAILED  "The preconditioner solve routine failed in an unrecoverable manner."
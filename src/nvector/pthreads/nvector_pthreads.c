@@ -33,6 +33,37 @@
 #define ONE    RCONST(1.0)
 #define ONEPT5 RCONST(1.5)
 
+/* Persistent thread team. The calling thread acts as team member 0 and
+   num_threads-1 workers block on the start condition between operations.
+   A generation counter identifies each dispatched operation so a worker
+   never runs the same companion function twice. */
+
+typedef void *(*Pthreads_Kernel)(void *);
+
+typedef struct _Pthreads_Worker {
+  struct _Pthreads_Team *team; /* team the worker belongs to */
+  int                   id;    /* member id in [1, nthreads) */
+} Pthreads_Worker;
+
+struct _Pthreads_Team {
+  int              nthreads;    /* team size including caller          */
+  int              refcount;    /* number of vectors using the team    */
+  pthread_t       *threads;     /* worker threads                      */
+  Pthreads_Worker *workers;     /* worker ids passed to threads        */
+  pthread_mutex_t  run_mutex;   /* serializes dispatches to the team   */
+  pthread_mutex_t  mutex;       /* protects the fields below           */
+  pthread_cond_t   start_cond;  /* signals a new operation to workers  */
+  pthread_cond_t   done_cond;   /* signals the caller workers are done */
+  unsigned long    generation;  /* id of the most recent operation     */
+  int              pending;     /* workers still running the operation */
+  int              nactive;     /* workers with work in the operation  */
+  booleantype      shutdown;    /* tells workers to exit               */
+  Pthreads_Kernel  kernel;      /* companion function to run           */
+  Pthreads_Data   *thread_data; /* per-member thread data              */
+};
+
+typedef struct _Pthreads_Team Pthreads_Team;
+
 /* Private functions for special cases of vector operations */
 static void VCopy_Pthreads(N_Vector x, N_Vector z);                              /* z=x       */
 static void VSum_Pthreads(N_Vector x, N_Vector y, N_Vector z);                   /* z=x+y     */
@@ -121,6 +152,15 @@ static void N_VSplitLoop(int myid, int *nthreads, sunindextype *N,
 /* Function to initialize thread data */
 static void N_VInitThreadData(Pthreads_Data *thread_data);
 
+/* Functions to manage the persistent thread team */
+static Pthreads_Team *N_VTeamCreate_Pthreads(int nthreads);
+static void N_VTeamRetain_Pthreads(Pthreads_Team *team);
+static void N_VTeamRelease_Pthreads(Pthreads_Team *team);
+static void N_VTeamRun_Pthreads(Pthreads_Team *team, int nthreads,
+                                Pthreads_Kernel kernel,
+                                Pthreads_Data *thread_data);
+static void *N_VTeamWorker_Pthreads(void *worker);
+
 /*
  * -----------------------------------------------------------------
  * exported functions
@@ -223,6 +263,11 @@ N_Vector N_VNewEmpty_Pthreads(sunindextype length, int num_threads,
   content->num_threads = num_threads;
   content->own_data    = SUNFALSE;
   content->data        = NULL;
+  content->team        = NULL;
+
+  /* Create the persistent thread team */
+  content->team = N_VTeamCreate_Pthreads(num_threads);
+  if (content->team == NULL) { N_VDestroy_Pthreads(v); return(NULL); }
 
   return(v);
 }
@@ -392,6 +437,10 @@ N_Vector N_VCloneEmpty_Pthreads(N_Vector w)
   content->own_data    = SUNFALSE;
   content->data        = NULL;
 
+  /* Share the thread team with the template vector */
+  content->team = NV_TEAM_PT(w);
+  N_VTeamRetain_Pthreads(content->team);
+
   return(v);
 }
 
@@ -443,6 +492,8 @@ void N_VDestroy_Pthreads(N_Vector v)
       free(NV_DATA_PT(v));
       NV_DATA_PT(v) = NULL;
     }
+    N_VTeamRelease_Pthreads(NV_TEAM_PT(v));
+    NV_TEAM_PT(v) = NULL;
     free(v->content);
     v->content = NULL;
   }
@@ -497,9 +548,7 @@ void N_VLinearSum_Pthreads(realtype a, N_Vector x, realtype b, N_Vector y, N_Vec
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
   realtype c;
   N_Vector v1, v2;
@@ -572,16 +621,11 @@ void N_VLinearSum_Pthreads(realtype a, N_Vector x, realtype b, N_Vector y, N_Vec
      (2) a == 0.0, b == other - user should have called N_VScale
      (3) a,b == other, a !=b, a != -b */
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = (pthread_t *) malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -595,19 +639,12 @@ void N_VLinearSum_Pthreads(realtype a, N_Vector x, realtype b, N_Vector y, N_Vec
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = NV_DATA_PT(y);
     thread_data[i].v3 = NV_DATA_PT(z);
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VLinearSum_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VLinearSum_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return;
@@ -642,7 +679,7 @@ static void *N_VLinearSum_PT(void *thread_data)
   }
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -654,20 +691,13 @@ void N_VConst_Pthreads(realtype c, N_Vector z)
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(z);
   nthreads     = NV_NUM_THREADS_PT(z);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -678,19 +708,12 @@ void N_VConst_Pthreads(realtype c, N_Vector z)
     /* pack thread data */
     thread_data[i].c1 = c;
     thread_data[i].v1 = NV_DATA_PT(z);
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VConst_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(z), nthreads, N_VConst_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return;
@@ -722,7 +745,7 @@ static void *N_VConst_PT(void *thread_data)
     zd[i] = c;
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -734,20 +757,13 @@ void N_VProd_Pthreads(N_Vector x, N_Vector y, N_Vector z)
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -759,19 +775,12 @@ void N_VProd_Pthreads(N_Vector x, N_Vector y, N_Vector z)
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = NV_DATA_PT(y);
     thread_data[i].v3 = NV_DATA_PT(z);
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VProd_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VProd_PT, thread_data);
 
   /* clean up and exit */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return;
@@ -802,7 +811,7 @@ static void *N_VProd_PT(void *thread_data)
     zd[i] = xd[i]*yd[i];
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -814,20 +823,13 @@ void N_VDiv_Pthreads(N_Vector x, N_Vector y, N_Vector z)
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -839,19 +841,12 @@ void N_VDiv_Pthreads(N_Vector x, N_Vector y, N_Vector z)
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = NV_DATA_PT(y);
     thread_data[i].v3 = NV_DATA_PT(z);
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VDiv_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VDiv_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return;
@@ -883,7 +878,7 @@ static void *N_VDiv_PT(void *thread_data)
     zd[i] = xd[i]/yd[i];
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -895,9 +890,7 @@ void N_VScale_Pthreads(realtype c, N_Vector x, N_Vector z)
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
   if (z == x) {  /* BLAS usage: scale x <- cx */
     VScaleBy_Pthreads(c, x);
@@ -909,16 +902,11 @@ void N_VScale_Pthreads(realtype c, N_Vector x, N_Vector z)
   } else if (c == -ONE) {
     VNeg_Pthreads(x, z);
   } else {
-    /* allocate threads and thread data structs */
+    /* allocate thread data structs */
     N            = NV_LENGTH_PT(x);
     nthreads     = NV_NUM_THREADS_PT(x);
-    threads      = malloc(nthreads*sizeof(pthread_t));
     thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-    /* set thread attributes */
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
     for (i=0; i<nthreads; i++) {
       /* initialize thread data */
       N_VInitThreadData(&thread_data[i]);
@@ -930,19 +918,12 @@ void N_VScale_Pthreads(realtype c, N_Vector x, N_Vector z)
       thread_data[i].c1 = c;
       thread_data[i].v1 = NV_DATA_PT(x);
       thread_data[i].v2 = NV_DATA_PT(z);
-
-      /* create threads and call pthread companion function */
-      pthread_create(&threads[i], &attr, N_VScale_PT, (void *) &thread_data[i]);
     }
 
-    /* wait for all threads to finish */
-    for (i=0; i<nthreads; i++) {
-      pthread_join(threads[i], NULL);
-    }
+    /* run companion function on the thread team */
+    N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VScale_PT, thread_data);
 
     /* clean up */
-    pthread_attr_destroy(&attr);
-    free(threads);
     free(thread_data);
   }
 
@@ -976,7 +957,7 @@ static void *N_VScale_PT(void *thread_data)
     zd[i] = c*xd[i];
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -988,20 +969,13 @@ void N_VAbs_Pthreads(N_Vector x, N_Vector z)
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -1012,19 +986,12 @@ void N_VAbs_Pthreads(N_Vector x, N_Vector z)
     /* pack thread data */
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = NV_DATA_PT(z);
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VAbs_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VAbs_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return;
@@ -1055,7 +1022,7 @@ static void *N_VAbs_PT(void *thread_data)
     zd[i] = SUNRabs(xd[i]);
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -1067,20 +1034,13 @@ void N_VInv_Pthreads(N_Vector x, N_Vector z)
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -1091,19 +1051,12 @@ void N_VInv_Pthreads(N_Vector x, N_Vector z)
     /* pack thread data */
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = NV_DATA_PT(z);
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VInv_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VInv_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return;
@@ -1134,7 +1087,7 @@ static void *N_VInv_PT(void *thread_data)
     zd[i] = ONE/xd[i];
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -1146,20 +1099,13 @@ void N_VAddConst_Pthreads(N_Vector x, realtype b, N_Vector z)
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -1171,19 +1117,12 @@ void N_VAddConst_Pthreads(N_Vector x, realtype b, N_Vector z)
     thread_data[i].c1 = b;
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = NV_DATA_PT(z);
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VAddConst_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VAddConst_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return;
@@ -1216,7 +1155,7 @@ static void *N_VAddConst_PT(void *thread_data)
     zd[i] = xd[i] + b;
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -1228,22 +1167,15 @@ realtype N_VDotProd_Pthreads(N_Vector x, N_Vector y)
 {
   sunindextype    N;
   int             i, nthreads;
-  pthread_t       *threads;
   Pthreads_Data   *thread_data;
-  pthread_attr_t  attr;
   pthread_mutex_t global_mutex;
   realtype        sum = ZERO;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N           = NV_LENGTH_PT(x);
   nthreads    = NV_NUM_THREADS_PT(x);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   /* lock for reduction */
   pthread_mutex_init(&global_mutex, NULL);
 
@@ -1259,20 +1191,13 @@ realtype N_VDotProd_Pthreads(N_Vector x, N_Vector y)
     thread_data[i].v2 = NV_DATA_PT(y);
     thread_data[i].global_val   = &sum;
     thread_data[i].global_mutex = &global_mutex;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VDotProd_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VDotProd_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
   pthread_mutex_destroy(&global_mutex);
-  free(threads);
   free(thread_data);
 
   return(sum);
@@ -1314,7 +1239,7 @@ static void *N_VDotProd_PT(void *thread_data)
   pthread_mutex_unlock(global_mutex);
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -1326,22 +1251,15 @@ realtype N_VMaxNorm_Pthreads(N_Vector x)
 {
   sunindextype    N;
   int             i, nthreads;
-  pthread_t       *threads;
   Pthreads_Data   *thread_data;
-  pthread_attr_t  attr;
   pthread_mutex_t global_mutex;
   realtype        max = ZERO;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   /* lock for reduction */
   pthread_mutex_init(&global_mutex, NULL);
 
@@ -1356,20 +1274,13 @@ realtype N_VMaxNorm_Pthreads(N_Vector x)
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].global_val   = &max;
     thread_data[i].global_mutex = &global_mutex;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VMaxNorm_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VMaxNorm_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
   pthread_mutex_destroy(&global_mutex);
-  free(threads);
   free(thread_data);
 
   return(max);
@@ -1412,7 +1323,7 @@ static void *N_VMaxNorm_PT(void *thread_data)
   pthread_mutex_unlock(global_mutex);
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -1434,22 +1345,15 @@ realtype N_VWSqrSumLocal_Pthreads(N_Vector x, N_Vector w)
 {
   sunindextype    N;
   int             i, nthreads;
-  pthread_t       *threads;
   Pthreads_Data   *thread_data;
-  pthread_attr_t  attr;
   pthread_mutex_t global_mutex;
   realtype        sum = ZERO;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N           = NV_LENGTH_PT(x);
   nthreads    = NV_NUM_THREADS_PT(x);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   /* lock for reduction */
   pthread_mutex_init(&global_mutex, NULL);
 
@@ -1465,20 +1369,13 @@ realtype N_VWSqrSumLocal_Pthreads(N_Vector x, N_Vector w)
     thread_data[i].v2 = NV_DATA_PT(w);
     thread_data[i].global_val   = &sum;
     thread_data[i].global_mutex = &global_mutex;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VWSqrSum_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VWSqrSum_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
   pthread_mutex_destroy(&global_mutex);
-  free(threads);
   free(thread_data);
 
   return(sum);
@@ -1520,7 +1417,7 @@ static void *N_VWSqrSum_PT(void *thread_data)
   pthread_mutex_unlock(global_mutex);
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -1542,22 +1439,15 @@ realtype N_VWSqrSumMaskLocal_Pthreads(N_Vector x, N_Vector w, N_Vector id)
 {
   sunindextype    N;
   int             i, nthreads;
-  pthread_t       *threads;
   Pthreads_Data   *thread_data;
-  pthread_attr_t  attr;
   pthread_mutex_t global_mutex;
   realtype        sum = ZERO;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   /* lock for reduction */
   pthread_mutex_init(&global_mutex, NULL);
 
@@ -1574,20 +1464,13 @@ realtype N_VWSqrSumMaskLocal_Pthreads(N_Vector x, N_Vector w, N_Vector id)
     thread_data[i].v3 = NV_DATA_PT(id);
     thread_data[i].global_val   = &sum;
     thread_data[i].global_mutex = &global_mutex;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VWSqrSumMask_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VWSqrSumMask_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
   pthread_mutex_destroy(&global_mutex);
-  free(threads);
   free(thread_data);
 
   return(sum);
@@ -1632,7 +1515,7 @@ static void *N_VWSqrSumMask_PT(void *thread_data)
   pthread_mutex_unlock(global_mutex);
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -1644,25 +1527,18 @@ realtype N_VMin_Pthreads(N_Vector x)
 {
   sunindextype    N;
   int             i, nthreads;
-  pthread_t       *threads;
   Pthreads_Data   *thread_data;
-  pthread_attr_t  attr;
   pthread_mutex_t global_mutex;
   realtype        min;
 
   /* initialize global min */
   min = NV_Ith_PT(x,0);
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N           = NV_LENGTH_PT(x);
   nthreads    = NV_NUM_THREADS_PT(x);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   /* lock for reduction */
   pthread_mutex_init(&global_mutex, NULL);
 
@@ -1677,20 +1553,13 @@ realtype N_VMin_Pthreads(N_Vector x)
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].global_val   = &min;
     thread_data[i].global_mutex = &global_mutex;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VMin_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VMin_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
   pthread_mutex_destroy(&global_mutex);
-  free(threads);
   free(thread_data);
 
   return(min);
@@ -1734,7 +1603,7 @@ static void *N_VMin_PT(void *thread_data)
   pthread_mutex_unlock(global_mutex);
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -1746,22 +1615,15 @@ realtype N_VWL2Norm_Pthreads(N_Vector x, N_Vector w)
 {
   sunindextype    N;
   int             i, nthreads;
-  pthread_t       *threads;
   Pthreads_Data   *thread_data;
-  pthread_attr_t  attr;
   pthread_mutex_t global_mutex;
   realtype        sum = ZERO;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N           = NV_LENGTH_PT(x);
   nthreads    = NV_NUM_THREADS_PT(x);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   /* lock for reduction */
   pthread_mutex_init(&global_mutex, NULL);
 
@@ -1777,20 +1639,13 @@ realtype N_VWL2Norm_Pthreads(N_Vector x, N_Vector w)
     thread_data[i].v2 = NV_DATA_PT(w);
     thread_data[i].global_val   = &sum;
     thread_data[i].global_mutex = &global_mutex;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VWL2Norm_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VWL2Norm_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
   pthread_mutex_destroy(&global_mutex);
-  free(threads);
   free(thread_data);
 
   return(SUNRsqrt(sum));
@@ -1832,7 +1687,7 @@ static void *N_VWL2Norm_PT(void *thread_data)
   pthread_mutex_unlock(global_mutex);
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -1844,22 +1699,15 @@ realtype N_VL1Norm_Pthreads(N_Vector x)
 {
   sunindextype    N;
   int             i, nthreads;
-  pthread_t       *threads;
   Pthreads_Data   *thread_data;
-  pthread_attr_t  attr;
   pthread_mutex_t global_mutex;
   realtype        sum = ZERO;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   /* lock for reduction */
   pthread_mutex_init(&global_mutex, NULL);
 
@@ -1874,20 +1722,13 @@ realtype N_VL1Norm_Pthreads(N_Vector x)
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].global_val   = &sum;
     thread_data[i].global_mutex = &global_mutex;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VL1Norm_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VL1Norm_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
   pthread_mutex_destroy(&global_mutex);
-  free(threads);
   free(thread_data);
 
   return(sum);
@@ -1928,7 +1769,7 @@ static void *N_VL1Norm_PT(void *thread_data)
   pthread_mutex_unlock(global_mutex);
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -1940,20 +1781,13 @@ void N_VCompare_Pthreads(realtype c, N_Vector x, N_Vector z)
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -1965,19 +1799,12 @@ void N_VCompare_Pthreads(realtype c, N_Vector x, N_Vector z)
     thread_data[i].c1  = c;
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = NV_DATA_PT(z);
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VCompare_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VCompare_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return;
@@ -2009,7 +1836,7 @@ static void *N_VCompare_PT(void *thread_data)
     zd[i] = (SUNRabs(xd[i]) >= c) ? ONE : ZERO;
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -2021,22 +1848,15 @@ booleantype N_VInvTest_Pthreads(N_Vector x, N_Vector z)
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
   realtype val = ZERO;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N           = NV_LENGTH_PT(x);
   nthreads    = NV_NUM_THREADS_PT(x);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -2048,19 +1868,12 @@ booleantype N_VInvTest_Pthreads(N_Vector x, N_Vector z)
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = NV_DATA_PT(z);
     thread_data[i].global_val = &val;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VInvTest_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VInvTest_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   if (val > ZERO)
@@ -2107,7 +1920,7 @@ static void *N_VInvTest_PT(void *thread_data)
   }
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -2119,22 +1932,15 @@ booleantype N_VConstrMask_Pthreads(N_Vector c, N_Vector x, N_Vector m)
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
   realtype val = ZERO;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N           = NV_LENGTH_PT(x);
   nthreads    = NV_NUM_THREADS_PT(x);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -2147,19 +1953,12 @@ booleantype N_VConstrMask_Pthreads(N_Vector c, N_Vector x, N_Vector m)
     thread_data[i].v2 = NV_DATA_PT(x);
     thread_data[i].v3 = NV_DATA_PT(m);
     thread_data[i].global_val = &val;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VConstrMask_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VConstrMask_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   if (val > ZERO)
@@ -2214,7 +2013,7 @@ static void *N_VConstrMask_PT(void *thread_data)
   }
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -2226,22 +2025,15 @@ realtype N_VMinQuotient_Pthreads(N_Vector num, N_Vector denom)
 {
   sunindextype    N;
   int             i, nthreads;
-  pthread_t       *threads;
   Pthreads_Data   *thread_data;
-  pthread_attr_t  attr;
   pthread_mutex_t global_mutex;
   realtype        min = BIG_REAL;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N           = NV_LENGTH_PT(num);
   nthreads    = NV_NUM_THREADS_PT(num);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   /* lock for reduction */
   pthread_mutex_init(&global_mutex, NULL);
 
@@ -2257,20 +2049,13 @@ realtype N_VMinQuotient_Pthreads(N_Vector num, N_Vector denom)
     thread_data[i].v2 = NV_DATA_PT(denom);
     thread_data[i].global_val   = &min;
     thread_data[i].global_mutex = &global_mutex;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VMinQuotient_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(num), nthreads, N_VMinQuotient_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
   pthread_mutex_destroy(&global_mutex);
-  free(threads);
   free(thread_data);
 
   return(min);
@@ -2316,7 +2101,7 @@ static void *N_VMinQuotient_PT(void *thread_data)
   pthread_mutex_unlock(global_mutex);
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -2335,9 +2120,7 @@ int N_VLinearCombination_Pthreads(int nvec, realtype* c, N_Vector* X, N_Vector z
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
   /* invalid number of vectors */
   if (nvec < 1) return(-1);
@@ -2357,13 +2140,8 @@ int N_VLinearCombination_Pthreads(int nvec, realtype* c, N_Vector* X, N_Vector z
   /* get vector length and data array */
   N           = NV_LENGTH_PT(z);
   nthreads    = NV_NUM_THREADS_PT(z);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -2376,19 +2154,12 @@ int N_VLinearCombination_Pthreads(int nvec, realtype* c, N_Vector* X, N_Vector z
     thread_data[i].cvals = c;
     thread_data[i].Y1    = X;
     thread_data[i].x1    = z;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VLinearCombination_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(z), nthreads, N_VLinearCombination_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -2428,7 +2199,7 @@ static void *N_VLinearCombination_PT(void *thread_data)
         zd[j] += c[i] * xd[j];
       }
     }
-    pthread_exit(NULL);
+    return(NULL);
   }
 
   /*
@@ -2444,7 +2215,7 @@ static void *N_VLinearCombination_PT(void *thread_data)
         zd[j] += c[i] * xd[j];
       }
     }
-    pthread_exit(NULL);
+    return(NULL);
   }
 
   /*
@@ -2460,7 +2231,7 @@ static void *N_VLinearCombination_PT(void *thread_data)
       zd[j] += c[i] * xd[j];
     }
   }
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -2472,9 +2243,7 @@ int N_VScaleAddMulti_Pthreads(int nvec, realtype* a, N_Vector x, N_Vector* Y, N_
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
   /* invalid number of vectors */
   if (nvec < 1) return(-1);
@@ -2488,13 +2257,8 @@ int N_VScaleAddMulti_Pthreads(int nvec, realtype* a, N_Vector x, N_Vector* Y, N_
   /* get vector length and data array */
   N           = NV_LENGTH_PT(x);
   nthreads    = NV_NUM_THREADS_PT(x);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -2508,19 +2272,12 @@ int N_VScaleAddMulti_Pthreads(int nvec, realtype* a, N_Vector x, N_Vector* Y, N_
     thread_data[i].x1    = x;
     thread_data[i].Y1    = Y;
     thread_data[i].Y2    = Z;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VScaleAddMulti_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VScaleAddMulti_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -2561,7 +2318,7 @@ static void *N_VScaleAddMulti_PT(void *thread_data)
         yd[j] += a[i] * xd[j];
       }
     }
-    pthread_exit(NULL);
+    return(NULL);
   }
 
   /*
@@ -2574,7 +2331,7 @@ static void *N_VScaleAddMulti_PT(void *thread_data)
       zd[j] = a[i] * xd[j] + yd[j];
     }
   }
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -2586,9 +2343,7 @@ int N_VDotProdMulti_Pthreads(int nvec, N_Vector x, N_Vector* Y, realtype* dotpro
 {
   sunindextype    N;
   int             i, nthreads;
-  pthread_t       *threads;
   Pthreads_Data   *thread_data;
-  pthread_attr_t  attr;
   pthread_mutex_t global_mutex;
 
   /* invalid number of vectors */
@@ -2604,16 +2359,11 @@ int N_VDotProdMulti_Pthreads(int nvec, N_Vector x, N_Vector* Y, realtype* dotpro
   for (i=0; i<nvec; i++)
     dotprods[i] = ZERO;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N           = NV_LENGTH_PT(x);
   nthreads    = NV_NUM_THREADS_PT(x);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   /* lock for reduction */
   pthread_mutex_init(&global_mutex, NULL);
 
@@ -2631,20 +2381,13 @@ int N_VDotProdMulti_Pthreads(int nvec, N_Vector x, N_Vector* Y, realtype* dotpro
     thread_data[i].cvals = dotprods;
 
     thread_data[i].global_mutex = &global_mutex;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VDotProdMulti_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, N_VDotProdMulti_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
   pthread_mutex_destroy(&global_mutex);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -2691,7 +2434,7 @@ static void *N_VDotProdMulti_PT(void *thread_data)
   }
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -2711,9 +2454,7 @@ int N_VLinearSumVectorArray_Pthreads(int nvec, realtype a, N_Vector* X,
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
   realtype    c;
   N_Vector*  V1;
@@ -2788,13 +2529,8 @@ int N_VLinearSumVectorArray_Pthreads(int nvec, realtype a, N_Vector* X,
   /* get vector length and data array */
   N           = NV_LENGTH_PT(Z[0]);
   nthreads    = NV_NUM_THREADS_PT(Z[0]);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -2809,20 +2545,12 @@ int N_VLinearSumVectorArray_Pthreads(int nvec, realtype a, N_Vector* X,
     thread_data[i].Y1   = X;
     thread_data[i].Y2   = Y;
     thread_data[i].Y3   = Z;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VLinearSumVectorArray_PT,
-                   (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(Z[0]), nthreads, N_VLinearSumVectorArray_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -2864,7 +2592,7 @@ static void *N_VLinearSumVectorArray_PT(void *thread_data)
   }
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -2876,9 +2604,7 @@ int N_VScaleVectorArray_Pthreads(int nvec, realtype* c, N_Vector* X, N_Vector* Z
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
   /* invalid number of vectors */
   if (nvec < 1) return(-1);
@@ -2892,13 +2618,8 @@ int N_VScaleVectorArray_Pthreads(int nvec, realtype* c, N_Vector* X, N_Vector* Z
   /* get vector length and data array */
   N           = NV_LENGTH_PT(Z[0]);
   nthreads    = NV_NUM_THREADS_PT(Z[0]);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -2911,20 +2632,12 @@ int N_VScaleVectorArray_Pthreads(int nvec, realtype* c, N_Vector* X, N_Vector* Z
     thread_data[i].cvals = c;
     thread_data[i].Y1    = X;
     thread_data[i].Y2    = Z;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VScaleVectorArray_PT,
-                   (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(Z[0]), nthreads, N_VScaleVectorArray_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -2963,7 +2676,7 @@ static void *N_VScaleVectorArray_PT(void *thread_data)
         xd[j] *= c[i];
       }
     }
-    pthread_exit(NULL);
+    return(NULL);
   }
 
   /*
@@ -2976,7 +2689,7 @@ static void *N_VScaleVectorArray_PT(void *thread_data)
       zd[j] = c[i] * xd[j];
     }
   }
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -2988,9 +2701,7 @@ int N_VConstVectorArray_Pthreads(int nvec, realtype c, N_Vector* Z)
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
   /* invalid number of vectors */
   if (nvec < 1) return(-1);
@@ -3004,13 +2715,8 @@ int N_VConstVectorArray_Pthreads(int nvec, realtype c, N_Vector* Z)
   /* get vector length and data array */
   N           = NV_LENGTH_PT(Z[0]);
   nthreads    = NV_NUM_THREADS_PT(Z[0]);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -3022,20 +2728,12 @@ int N_VConstVectorArray_Pthreads(int nvec, realtype c, N_Vector* Z)
     thread_data[i].nvec = nvec;
     thread_data[i].c1   = c;
     thread_data[i].Y1   = Z;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VConstVectorArray_PT,
-                   (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(Z[0]), nthreads, N_VConstVectorArray_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -3069,7 +2767,7 @@ static void *N_VConstVectorArray_PT(void *thread_data)
   }
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -3081,9 +2779,7 @@ int N_VWrmsNormVectorArray_Pthreads(int nvec, N_Vector* X, N_Vector* W, realtype
 {
   sunindextype    N;
   int             i, nthreads;
-  pthread_t       *threads;
   Pthreads_Data   *thread_data;
-  pthread_attr_t  attr;
   pthread_mutex_t global_mutex;
 
   /* invalid number of vectors */
@@ -3099,16 +2795,11 @@ int N_VWrmsNormVectorArray_Pthreads(int nvec, N_Vector* X, N_Vector* W, realtype
   for (i=0; i<nvec; i++)
     nrm[i] = ZERO;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N           = NV_LENGTH_PT(X[0]);
   nthreads    = NV_NUM_THREADS_PT(X[0]);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   /* lock for reduction */
   pthread_mutex_init(&global_mutex, NULL);
 
@@ -3126,25 +2817,17 @@ int N_VWrmsNormVectorArray_Pthreads(int nvec, N_Vector* X, N_Vector* W, realtype
     thread_data[i].cvals = nrm;
 
     thread_data[i].global_mutex = &global_mutex;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VWrmsNormVectorArray_PT,
-                   (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(X[0]), nthreads, N_VWrmsNormVectorArray_PT, thread_data);
 
   /* finalize wrms calculation */
   for (i=0; i<nvec; i++)
     nrm[i] = SUNRsqrt(nrm[i]/N);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
   pthread_mutex_destroy(&global_mutex);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -3191,7 +2874,7 @@ static void *N_VWrmsNormVectorArray_PT(void *thread_data)
   }
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -3204,9 +2887,7 @@ int N_VWrmsNormMaskVectorArray_Pthreads(int nvec, N_Vector* X, N_Vector* W,
 {
   sunindextype    N;
   int             i, nthreads;
-  pthread_t       *threads;
   Pthreads_Data   *thread_data;
-  pthread_attr_t  attr;
   pthread_mutex_t global_mutex;
 
   /* invalid number of vectors */
@@ -3222,16 +2903,11 @@ int N_VWrmsNormMaskVectorArray_Pthreads(int nvec, N_Vector* X, N_Vector* W,
   for (i=0; i<nvec; i++)
     nrm[i] = ZERO;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N           = NV_LENGTH_PT(X[0]);
   nthreads    = NV_NUM_THREADS_PT(X[0]);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   /* lock for reduction */
   pthread_mutex_init(&global_mutex, NULL);
 
@@ -3250,25 +2926,17 @@ int N_VWrmsNormMaskVectorArray_Pthreads(int nvec, N_Vector* X, N_Vector* W,
     thread_data[i].cvals = nrm;
 
     thread_data[i].global_mutex = &global_mutex;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VWrmsNormMaskVectorArray_PT,
-                   (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(X[0]), nthreads, N_VWrmsNormMaskVectorArray_PT, thread_data);
 
   /* finalize wrms calculation */
   for (i=0; i<nvec; i++)
     nrm[i] = SUNRsqrt(nrm[i]/N);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
   pthread_mutex_destroy(&global_mutex);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -3318,7 +2986,7 @@ static void *N_VWrmsNormMaskVectorArray_PT(void *thread_data)
   }
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -3331,9 +2999,7 @@ int N_VScaleAddMultiVectorArray_Pthreads(int nvec, int nsum, realtype* a,
 {
   sunindextype   N;
   int            i, j, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
   int          retval;
   N_Vector*   YY;
@@ -3388,13 +3054,8 @@ int N_VScaleAddMultiVectorArray_Pthreads(int nvec, int nsum, realtype* a,
   /* get vector length and data array */
   N           = NV_LENGTH_PT(X[0]);
   nthreads    = NV_NUM_THREADS_PT(X[0]);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -3409,20 +3070,12 @@ int N_VScaleAddMultiVectorArray_Pthreads(int nvec, int nsum, realtype* a,
     thread_data[i].Y1    = X;
     thread_data[i].ZZ1   = Y;
     thread_data[i].ZZ2   = Z;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VScaleAddMultiVectorArray_PT,
-                   (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(X[0]), nthreads, N_VScaleAddMultiVectorArray_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -3465,7 +3118,7 @@ static void *N_VScaleAddMultiVectorArray_PT(void *thread_data)
         }
       }
     }
-    pthread_exit(NULL);
+    return(NULL);
   }
 
   /*
@@ -3481,7 +3134,7 @@ static void *N_VScaleAddMultiVectorArray_PT(void *thread_data)
       }
     }
   }
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -3494,9 +3147,7 @@ int N_VLinearCombinationVectorArray_Pthreads(int nvec, int nsum, realtype* c,
 {
   sunindextype   N;
   int            i, j, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
   int          retval;
   realtype*    ctmp;
@@ -3569,13 +3220,8 @@ int N_VLinearCombinationVectorArray_Pthreads(int nvec, int nsum, realtype* c,
   /* get vector length and data array */
   N           = NV_LENGTH_PT(Z[0]);
   nthreads    = NV_NUM_THREADS_PT(Z[0]);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -3589,20 +3235,12 @@ int N_VLinearCombinationVectorArray_Pthreads(int nvec, int nsum, realtype* c,
     thread_data[i].cvals = c;
     thread_data[i].ZZ1   = X;
     thread_data[i].Y1    = Z;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, N_VLinearCombinationVectorArray_PT,
-                   (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(Z[0]), nthreads, N_VLinearCombinationVectorArray_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -3645,7 +3283,7 @@ static void *N_VLinearCombinationVectorArray_PT(void *thread_data)
         }
       }
     }
-    pthread_exit(NULL);
+    return(NULL);
   }
 
   /*
@@ -3664,7 +3302,7 @@ static void *N_VLinearCombinationVectorArray_PT(void *thread_data)
         }
       }
     }
-    pthread_exit(NULL);
+    return(NULL);
   }
 
   /*
@@ -3683,7 +3321,7 @@ static void *N_VLinearCombinationVectorArray_PT(void *thread_data)
       }
     }
   }
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -3715,22 +3353,15 @@ int N_VBufPack_Pthreads(N_Vector x, void *buf)
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
   if (x == NULL || buf == NULL) return(-1);
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N           = NV_LENGTH_PT(x);
   nthreads    = NV_NUM_THREADS_PT(x);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -3741,19 +3372,12 @@ int N_VBufPack_Pthreads(N_Vector x, void *buf)
     /* pack thread data */
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = (realtype*)buf;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, VBufPack_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, VBufPack_PT, thread_data);
 
   /* clean up */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -3785,7 +3409,7 @@ static void *VBufPack_PT(void *thread_data)
     bd[i] = xd[i];
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -3797,22 +3421,15 @@ int N_VBufUnpack_Pthreads(N_Vector x, void *buf)
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
   if (x == NULL || buf == NULL) return(-1);
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N           = NV_LENGTH_PT(x);
   nthreads    = NV_NUM_THREADS_PT(x);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -3823,19 +3440,12 @@ int N_VBufUnpack_Pthreads(N_Vector x, void *buf)
     /* pack thread data */
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = (realtype*)buf;
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, VBufUnpack_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, VBufUnpack_PT, thread_data);
 
   /* clean up */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -3867,7 +3477,7 @@ static void *VBufUnpack_PT(void *thread_data)
     xd[i] = bd[i];
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -3886,20 +3496,13 @@ static void VCopy_Pthreads(N_Vector x, N_Vector z)
 {
   sunindextype      N;
   int           i, nthreads;
-  pthread_t     *threads;
   Pthreads_Data *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -3910,19 +3513,12 @@ static void VCopy_Pthreads(N_Vector x, N_Vector z)
     /* pack thread data */
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = NV_DATA_PT(z);
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, VCopy_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, VCopy_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return;
@@ -3953,7 +3549,7 @@ static void *VCopy_PT(void *thread_data)
     zd[i] = xd[i];
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -3965,20 +3561,13 @@ static void VSum_Pthreads(N_Vector x, N_Vector y, N_Vector z)
 {
   sunindextype      N;
   int           i, nthreads;
-  pthread_t     *threads;
   Pthreads_Data *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -3990,19 +3579,12 @@ static void VSum_Pthreads(N_Vector x, N_Vector y, N_Vector z)
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = NV_DATA_PT(y);
     thread_data[i].v3 = NV_DATA_PT(z);
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, VSum_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, VSum_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return;
@@ -4034,7 +3616,7 @@ static void *VSum_PT(void *thread_data)
     zd[i] = xd[i] + yd[i];
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -4046,20 +3628,13 @@ static void VDiff_Pthreads(N_Vector x, N_Vector y, N_Vector z)
 {
   sunindextype  N;
   int           i, nthreads;
-  pthread_t     *threads;
   Pthreads_Data *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -4071,19 +3646,12 @@ static void VDiff_Pthreads(N_Vector x, N_Vector y, N_Vector z)
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = NV_DATA_PT(y);
     thread_data[i].v3 = NV_DATA_PT(z);
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, VDiff_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, VDiff_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return;
@@ -4115,7 +3683,7 @@ static void *VDiff_PT(void *thread_data)
     zd[i] = xd[i] - yd[i];
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -4127,20 +3695,13 @@ static void VNeg_Pthreads(N_Vector x, N_Vector z)
 {
   sunindextype  N;
   int           i, nthreads;
-  pthread_t     *threads;
   Pthreads_Data *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -4151,19 +3712,12 @@ static void VNeg_Pthreads(N_Vector x, N_Vector z)
     /* pack thread data */
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = NV_DATA_PT(z);
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, VNeg_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, VNeg_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return;
@@ -4194,7 +3748,7 @@ static void *VNeg_PT(void *thread_data)
     zd[i] = -xd[i];
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -4206,20 +3760,13 @@ static void VScaleSum_Pthreads(realtype c, N_Vector x, N_Vector y, N_Vector z)
 {
   sunindextype  N;
   int           i, nthreads;
-  pthread_t     *threads;
   Pthreads_Data *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -4232,19 +3779,12 @@ static void VScaleSum_Pthreads(realtype c, N_Vector x, N_Vector y, N_Vector z)
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = NV_DATA_PT(y);
     thread_data[i].v3 = NV_DATA_PT(z);
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, VScaleSum_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, VScaleSum_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return;
@@ -4278,7 +3818,7 @@ static void *VScaleSum_PT(void *thread_data)
     zd[i] = c*(xd[i] + yd[i]);
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -4290,20 +3830,13 @@ static void VScaleDiff_Pthreads(realtype c, N_Vector x, N_Vector y, N_Vector z)
 {
   sunindextype  N;
   int           i, nthreads;
-  pthread_t     *threads;
   Pthreads_Data *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -4316,19 +3849,12 @@ static void VScaleDiff_Pthreads(realtype c, N_Vector x, N_Vector y, N_Vector z)
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = NV_DATA_PT(y);
     thread_data[i].v3 = NV_DATA_PT(z);
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, VScaleDiff_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, VScaleDiff_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return;
@@ -4362,7 +3888,7 @@ static void *VScaleDiff_PT(void *thread_data)
     zd[i] = c*(xd[i] - yd[i]);
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -4374,20 +3900,13 @@ static void VLin1_Pthreads(realtype a, N_Vector x, N_Vector y, N_Vector z)
 {
   sunindextype  N;
   int           i, nthreads;
-  pthread_t     *threads;
   Pthreads_Data *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -4400,19 +3919,12 @@ static void VLin1_Pthreads(realtype a, N_Vector x, N_Vector y, N_Vector z)
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = NV_DATA_PT(y);
     thread_data[i].v3 = NV_DATA_PT(z);
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, VLin1_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, VLin1_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return;
@@ -4446,7 +3958,7 @@ static void *VLin1_PT(void *thread_data)
     zd[i] = (a*xd[i]) + yd[i];
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -4458,20 +3970,13 @@ static void VLin2_Pthreads(realtype a, N_Vector x, N_Vector y, N_Vector z)
 {
   sunindextype  N;
   int           i, nthreads;
-  pthread_t     *threads;
   Pthreads_Data *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -4484,19 +3989,12 @@ static void VLin2_Pthreads(realtype a, N_Vector x, N_Vector y, N_Vector z)
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = NV_DATA_PT(y);
     thread_data[i].v3 = NV_DATA_PT(z);
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, VLin2_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, VLin2_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return;
@@ -4529,7 +4027,7 @@ static void *VLin2_PT(void *thread_data)
     zd[i] = (a*xd[i]) - yd[i];
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -4541,20 +4039,13 @@ static void Vaxpy_Pthreads(realtype a, N_Vector x, N_Vector y)
 {
   sunindextype  N;
   int           i, nthreads;
-  pthread_t     *threads;
   Pthreads_Data *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -4566,19 +4057,12 @@ static void Vaxpy_Pthreads(realtype a, N_Vector x, N_Vector y)
     thread_data[i].c1 = a;
     thread_data[i].v1 = NV_DATA_PT(x);
     thread_data[i].v2 = NV_DATA_PT(y);
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, Vaxpy_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, Vaxpy_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return;
@@ -4611,7 +4095,7 @@ static void *Vaxpy_PT(void *thread_data)
       yd[i] += xd[i];
 
     /* exit */
-    pthread_exit(NULL);
+    return(NULL);
   }
 
   if (a == -ONE) {
@@ -4619,14 +4103,14 @@ static void *Vaxpy_PT(void *thread_data)
       yd[i] -= xd[i];
 
     /* exit */
-    pthread_exit(NULL);
+    return(NULL);
   }
 
   for (i = start; i < end; i++)
     yd[i] += a*xd[i];
 
   /* return */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -4638,20 +4122,13 @@ static void VScaleBy_Pthreads(realtype a, N_Vector x)
 {
   sunindextype  N;
   int           i, nthreads;
-  pthread_t     *threads;
   Pthreads_Data *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(x);
   nthreads     = NV_NUM_THREADS_PT(x);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
   for (i=0; i<nthreads; i++) {
     /* initialize thread data */
     N_VInitThreadData(&thread_data[i]);
@@ -4662,19 +4139,12 @@ static void VScaleBy_Pthreads(realtype a, N_Vector x)
     /* pack thread data */
     thread_data[i].c1 = a;
     thread_data[i].v1 = NV_DATA_PT(x);
-
-    /* create threads and call pthread companion function */
-    pthread_create(&threads[i], &attr, VScaleBy_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++) {
-    pthread_join(threads[i], NULL);
-  }
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(x), nthreads, VScaleBy_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return;
@@ -4706,7 +4176,7 @@ static void *VScaleBy_PT(void *thread_data)
     xd[i] *= a;
 
   /* exit */
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -4720,21 +4190,14 @@ static int VSumVectorArray_Pthreads(int nvec, N_Vector* X, N_Vector* Y, N_Vector
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N           = NV_LENGTH_PT(X[0]);
   nthreads    = NV_NUM_THREADS_PT(X[0]);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-  /* pack thread data, distribute loop indices, and create threads/call kernel */
+  /* pack thread data and distribute loop indices */
   for (i=0; i<nthreads; i++) {
     N_VInitThreadData(&thread_data[i]);
 
@@ -4744,17 +4207,12 @@ static int VSumVectorArray_Pthreads(int nvec, N_Vector* X, N_Vector* Y, N_Vector
     thread_data[i].Y3   = Z;
 
     N_VSplitLoop(i, &nthreads, &N, &thread_data[i].start, &thread_data[i].end);
-
-    pthread_create(&threads[i], &attr, VSumVectorArray_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++)
-    pthread_join(threads[i], NULL);
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(X[0]), nthreads, VSumVectorArray_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -4782,7 +4240,7 @@ static void *VSumVectorArray_PT(void *thread_data)
       zd[j] = xd[j] + yd[j];
   }
 
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -4790,21 +4248,14 @@ static int VDiffVectorArray_Pthreads(int nvec, N_Vector* X, N_Vector* Y, N_Vecto
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N           = NV_LENGTH_PT(X[0]);
   nthreads    = NV_NUM_THREADS_PT(X[0]);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-  /* pack thread data, distribute loop indices, and create threads/call kernel */
+  /* pack thread data and distribute loop indices */
   for (i=0; i<nthreads; i++) {
     N_VInitThreadData(&thread_data[i]);
 
@@ -4814,17 +4265,12 @@ static int VDiffVectorArray_Pthreads(int nvec, N_Vector* X, N_Vector* Y, N_Vecto
     thread_data[i].Y3   = Z;
 
     N_VSplitLoop(i, &nthreads, &N, &thread_data[i].start, &thread_data[i].end);
-
-    pthread_create(&threads[i], &attr, VDiffVectorArray_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++)
-    pthread_join(threads[i], NULL);
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(X[0]), nthreads, VDiffVectorArray_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -4852,7 +4298,7 @@ static void *VDiffVectorArray_PT(void *thread_data)
       zd[j] = xd[j] - yd[j];
   }
 
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -4860,21 +4306,14 @@ static int VScaleSumVectorArray_Pthreads(int nvec, realtype c, N_Vector* X, N_Ve
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N            = NV_LENGTH_PT(X[0]);
   nthreads     = NV_NUM_THREADS_PT(X[0]);
-  threads      = malloc(nthreads*sizeof(pthread_t));
   thread_data  = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-  /* pack thread data, distribute loop indices, and create threads/call kernel */
+  /* pack thread data and distribute loop indices */
   for (i=0; i<nthreads; i++) {
     N_VInitThreadData(&thread_data[i]);
 
@@ -4885,17 +4324,12 @@ static int VScaleSumVectorArray_Pthreads(int nvec, realtype c, N_Vector* X, N_Ve
     thread_data[i].Y3   = Z;
 
     N_VSplitLoop(i, &nthreads, &N, &thread_data[i].start, &thread_data[i].end);
-
-    pthread_create(&threads[i], &attr, VScaleSumVectorArray_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++)
-    pthread_join(threads[i], NULL);
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(X[0]), nthreads, VScaleSumVectorArray_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -4925,7 +4359,7 @@ static void *VScaleSumVectorArray_PT(void *thread_data)
       zd[j] = c * (xd[j] + yd[j]);
   }
 
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -4933,21 +4367,14 @@ static int VScaleDiffVectorArray_Pthreads(int nvec, realtype c, N_Vector* X, N_V
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N           = NV_LENGTH_PT(X[0]);
   nthreads    = NV_NUM_THREADS_PT(X[0]);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-  /* pack thread data, distribute loop indices, and create threads/call kernel */
+  /* pack thread data and distribute loop indices */
   for (i=0; i<nthreads; i++) {
     N_VInitThreadData(&thread_data[i]);
 
@@ -4958,17 +4385,12 @@ static int VScaleDiffVectorArray_Pthreads(int nvec, realtype c, N_Vector* X, N_V
     thread_data[i].Y3   = Z;
 
     N_VSplitLoop(i, &nthreads, &N, &thread_data[i].start, &thread_data[i].end);
-
-    pthread_create(&threads[i], &attr, VScaleDiffVectorArray_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++)
-    pthread_join(threads[i], NULL);
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(X[0]), nthreads, VScaleDiffVectorArray_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -4998,7 +4420,7 @@ static void *VScaleDiffVectorArray_PT(void *thread_data)
       zd[j] = c * (xd[j] - yd[j]);
   }
 
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -5006,21 +4428,14 @@ static int VLin1VectorArray_Pthreads(int nvec, realtype a, N_Vector* X, N_Vector
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N           = NV_LENGTH_PT(X[0]);
   nthreads    = NV_NUM_THREADS_PT(X[0]);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-  /* pack thread data, distribute loop indices, and create threads/call kernel */
+  /* pack thread data and distribute loop indices */
   for (i=0; i<nthreads; i++) {
     N_VInitThreadData(&thread_data[i]);
 
@@ -5031,17 +4446,12 @@ static int VLin1VectorArray_Pthreads(int nvec, realtype a, N_Vector* X, N_Vector
     thread_data[i].Y3   = Z;
 
     N_VSplitLoop(i, &nthreads, &N, &thread_data[i].start, &thread_data[i].end);
-
-    pthread_create(&threads[i], &attr, VLin1VectorArray_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++)
-    pthread_join(threads[i], NULL);
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(X[0]), nthreads, VLin1VectorArray_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -5071,7 +4481,7 @@ static void *VLin1VectorArray_PT(void *thread_data)
       zd[j] = (a * xd[j]) + yd[j];
   }
 
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -5079,21 +4489,14 @@ static int VLin2VectorArray_Pthreads(int nvec, realtype a, N_Vector* X, N_Vector
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N           = NV_LENGTH_PT(X[0]);
   nthreads    = NV_NUM_THREADS_PT(X[0]);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-  /* pack thread data, distribute loop indices, and create threads/call kernel */
+  /* pack thread data and distribute loop indices */
   for (i=0; i<nthreads; i++) {
     N_VInitThreadData(&thread_data[i]);
 
@@ -5104,17 +4507,12 @@ static int VLin2VectorArray_Pthreads(int nvec, realtype a, N_Vector* X, N_Vector
     thread_data[i].Y3   = Z;
 
     N_VSplitLoop(i, &nthreads, &N, &thread_data[i].start, &thread_data[i].end);
-
-    pthread_create(&threads[i], &attr, VLin2VectorArray_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++)
-    pthread_join(threads[i], NULL);
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(X[0]), nthreads, VLin2VectorArray_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -5144,7 +4542,7 @@ static void *VLin2VectorArray_PT(void *thread_data)
       zd[j] = (a * xd[j]) - yd[j];
   }
 
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -5152,21 +4550,14 @@ static int VaxpyVectorArray_Pthreads(int nvec, realtype a, N_Vector* X, N_Vector
 {
   sunindextype   N;
   int            i, nthreads;
-  pthread_t      *threads;
   Pthreads_Data  *thread_data;
-  pthread_attr_t attr;
 
-  /* allocate threads and thread data structs */
+  /* allocate thread data structs */
   N           = NV_LENGTH_PT(X[0]);
   nthreads    = NV_NUM_THREADS_PT(X[0]);
-  threads     = malloc(nthreads*sizeof(pthread_t));
   thread_data = (Pthreads_Data *) malloc(nthreads*sizeof(struct _Pthreads_Data));
 
-  /* set thread attributes */
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-  /* pack thread data, distribute loop indices, and create threads/call kernel */
+  /* pack thread data and distribute loop indices */
   for (i=0; i<nthreads; i++) {
     N_VInitThreadData(&thread_data[i]);
 
@@ -5176,17 +4567,12 @@ static int VaxpyVectorArray_Pthreads(int nvec, realtype a, N_Vector* X, N_Vector
     thread_data[i].Y2   = Y;
 
     N_VSplitLoop(i, &nthreads, &N, &thread_data[i].start, &thread_data[i].end);
-
-    pthread_create(&threads[i], &attr, VaxpyVectorArray_PT, (void *) &thread_data[i]);
   }
 
-  /* wait for all threads to finish */
-  for (i=0; i<nthreads; i++)
-    pthread_join(threads[i], NULL);
+  /* run companion function on the thread team */
+  N_VTeamRun_Pthreads(NV_TEAM_PT(X[0]), nthreads, VaxpyVectorArray_PT, thread_data);
 
   /* clean up and return */
-  pthread_attr_destroy(&attr);
-  free(threads);
   free(thread_data);
 
   return(0);
@@ -5214,7 +4600,7 @@ static void *VaxpyVectorArray_PT(void *thread_data)
       for (j=start; j<end; j++)
         yd[j] += xd[j];
     }
-    pthread_exit(NULL);
+    return(NULL);
   }
 
   if (a == -ONE) {
@@ -5224,7 +4610,7 @@ static void *VaxpyVectorArray_PT(void *thread_data)
       for (j=start; j<end; j++)
         yd[j] -= xd[j];
     }
-    pthread_exit(NULL);
+    return(NULL);
   }
 
   for (i=0; i<my_data->nvec; i++) {
@@ -5233,7 +4619,7 @@ static void *VaxpyVectorArray_PT(void *thread_data)
     for (j=start; j<end; j++)
       yd[j] += a * xd[j];
   }
-  pthread_exit(NULL);
+  return(NULL);
 }
 
 
@@ -5299,6 +4685,210 @@ static void N_VInitThreadData(Pthreads_Data *thread_data)
 }
 
 
+/* ----------------------------------------------------------------------------
+ * Create a thread team with nthreads members. The calling thread is member 0
+ * so only nthreads-1 worker threads are started.
+ */
+
+static Pthreads_Team *N_VTeamCreate_Pthreads(int nthreads)
+{
+  int i;
+  Pthreads_Team *team;
+
+  if (nthreads < 1) return(NULL);
+
+  team = NULL;
+  team = (Pthreads_Team *) malloc(sizeof *team);
+  if (team == NULL) return(NULL);
+
+  team->nthreads    = nthreads;
+  team->refcount    = 1;
+  team->generation  = 0;
+  team->pending     = 0;
+  team->nactive     = 0;
+  team->shutdown    = SUNFALSE;
+  team->kernel      = NULL;
+  team->thread_data = NULL;
+  team->threads     = NULL;
+  team->workers     = NULL;
+
+  pthread_mutex_init(&team->run_mutex, NULL);
+  pthread_mutex_init(&team->mutex, NULL);
+  pthread_cond_init(&team->start_cond, NULL);
+  pthread_cond_init(&team->done_cond, NULL);
+
+  if (nthreads > 1) {
+    team->threads = (pthread_t *) malloc((nthreads-1)*sizeof(pthread_t));
+    team->workers = (Pthreads_Worker *) malloc((nthreads-1)*sizeof(Pthreads_Worker));
+    if (team->threads == NULL || team->workers == NULL) {
+      team->nthreads = 1;
+      N_VTeamRelease_Pthreads(team);
+      return(NULL);
+    }
+
+    for (i=1; i<nthreads; i++) {
+      team->workers[i-1].team = team;
+      team->workers[i-1].id   = i;
+      if (pthread_create(&team->threads[i-1], NULL, N_VTeamWorker_Pthreads,
+                         (void *) &team->workers[i-1])) {
+        /* only shut down the workers that were started */
+        team->nthreads = i;
+        N_VTeamRelease_Pthreads(team);
+        return(NULL);
+      }
+    }
+  }
+
+  return(team);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Add a reference to a thread team (e.g., when cloning a vector)
+ */
+
+static void N_VTeamRetain_Pthreads(Pthreads_Team *team)
+{
+  if (team == NULL) return;
+
+  pthread_mutex_lock(&team->mutex);
+  team->refcount++;
+  pthread_mutex_unlock(&team->mutex);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Remove a reference to a thread team and, if it was the last reference,
+ * stop the workers and free the team
+ */
+
+static void N_VTeamRelease_Pthreads(Pthreads_Team *team)
+{
+  int i;
+
+  if (team == NULL) return;
+
+  pthread_mutex_lock(&team->mutex);
+  team->refcount--;
+  if (team->refcount > 0) {
+    pthread_mutex_unlock(&team->mutex);
+    return;
+  }
+  team->shutdown = SUNTRUE;
+  pthread_cond_broadcast(&team->start_cond);
+  pthread_mutex_unlock(&team->mutex);
+
+  for (i=1; i<team->nthreads; i++)
+    pthread_join(team->threads[i-1], NULL);
+
+  pthread_cond_destroy(&team->done_cond);
+  pthread_cond_destroy(&team->start_cond);
+  pthread_mutex_destroy(&team->mutex);
+  pthread_mutex_destroy(&team->run_mutex);
+
+  free(team->workers);
+  free(team->threads);
+  free(team);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Run a companion function on every member of the thread team and wait for
+ * all members to finish. Member i receives thread_data[i]. If more members
+ * are requested than the team holds, the caller runs the extra work itself.
+ */
+
+static void N_VTeamRun_Pthreads(Pthreads_Team *team, int nthreads,
+                                Pthreads_Kernel kernel,
+                                Pthreads_Data *thread_data)
+{
+  int i, nworkers;
+
+  nworkers = (team->nthreads < nthreads) ? team->nthreads - 1 : nthreads - 1;
+
+  /* nothing to hand off, run on the calling thread */
+  if (nworkers < 1) {
+    for (i=0; i<nthreads; i++)
+      kernel((void *) &thread_data[i]);
+    return;
+  }
+
+  pthread_mutex_lock(&team->run_mutex);
+
+  /* hand work to the workers */
+  pthread_mutex_lock(&team->mutex);
+  team->kernel      = kernel;
+  team->thread_data = thread_data;
+  team->pending     = team->nthreads - 1;
+  team->nactive     = nworkers;
+  team->generation++;
+  pthread_cond_broadcast(&team->start_cond);
+  pthread_mutex_unlock(&team->mutex);
+
+  /* the caller is member 0 and also runs any members beyond the team size */
+  kernel((void *) &thread_data[0]);
+  for (i=nworkers+1; i<nthreads; i++)
+    kernel((void *) &thread_data[i]);
+
+  /* wait for the workers to finish */
+  pthread_mutex_lock(&team->mutex);
+  while (team->pending > 0)
+    pthread_cond_wait(&team->done_cond, &team->mutex);
+  team->kernel      = NULL;
+  team->thread_data = NULL;
+  pthread_mutex_unlock(&team->mutex);
+
+  pthread_mutex_unlock(&team->run_mutex);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Worker thread main loop: wait for a new operation, run the companion
+ * function on this worker's thread data, and report completion
+ */
+
+static void *N_VTeamWorker_Pthreads(void *worker)
+{
+  Pthreads_Team  *team;
+  Pthreads_Kernel kernel;
+  Pthreads_Data  *my_data;
+  unsigned long   seen;
+  int             id, active;
+
+  team = ((Pthreads_Worker *) worker)->team;
+  id   = ((Pthreads_Worker *) worker)->id;
+
+  /* the team starts at generation 0 and an operation may be dispatched
+     before this thread first acquires the mutex */
+  seen = 0;
+
+  pthread_mutex_lock(&team->mutex);
+
+  for (;;) {
+    /* wait for a new operation or shutdown */
+    while (team->generation == seen && !team->shutdown)
+      pthread_cond_wait(&team->start_cond, &team->mutex);
+    if (team->shutdown) break;
+
+    seen    = team->generation;
+    kernel  = team->kernel;
+    my_data = team->thread_data;
+    active  = (id <= team->nactive);
+    pthread_mutex_unlock(&team->mutex);
+
+    /* members beyond the requested size have no work in this operation */
+    if (active) kernel((void *) &my_data[id]);
+
+    pthread_mutex_lock(&team->mutex);
+    team->pending--;
+    if (team->pending == 0) pthread_cond_signal(&team->done_cond);
+  }
+
+  pthread_mutex_unlock(&team->mutex);
+  return(NULL);
+}
+
+
 /*
  * -----------------------------------------------------------------
  * Enable / Disable fused and vector array operations
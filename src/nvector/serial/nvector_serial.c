@@ -20,6 +20,7 @@
 #include <stdlib.h>
 
 #include <nvector/nvector_serial.h>
+#include "nvector_serial_simd.h"
 #include <sundials/sundials_math.h>
 #include "sundials/sundials_nvector.h"
 
@@ -149,6 +150,7 @@ N_Vector N_VNewEmpty_Serial(sunindextype length, SUNContext sunctx)
   content->length   = length;
   content->own_data = SUNFALSE;
   content->data     = NULL;
+  content->simd     = NULL;
 
   return(v);
 }
@@ -310,6 +312,7 @@ N_Vector N_VCloneEmpty_Serial(N_Vector w)
   content->length   = NV_LENGTH_S(w);
   content->own_data = SUNFALSE;
   content->data     = NULL;
+  content->simd     = NV_SIMD_S(w);
 
   return(v);
 }
@@ -394,6 +397,12 @@ void N_VLinearSum_Serial(realtype a, N_Vector x, realtype b, N_Vector y, N_Vecto
 
   xd = yd = zd = NULL;
 
+  if (NV_SIMD_S(x) != NULL) {      /* vectorized kernel covers all cases */
+    NV_SIMD_S(x)->linearsum(NV_LENGTH_S(x), a, NV_DATA_S(x), b, NV_DATA_S(y),
+                            NV_DATA_S(z));
+    return;
+  }
+
   if ((b == ONE) && (z == y)) {    /* BLAS usage: axpy y <- ax+y */
     Vaxpy_Serial(a,x,y);
     return;
@@ -613,6 +622,9 @@ realtype N_VDotProd_Serial(N_Vector x, N_Vector y)
   xd = NV_DATA_S(x);
   yd = NV_DATA_S(y);
 
+  if (NV_SIMD_S(x) != NULL)
+    return(NV_SIMD_S(x)->dotprod(N, xd, yd));
+
   for (i = 0; i < N; i++)
     sum += xd[i]*yd[i];
 
@@ -654,6 +666,9 @@ realtype N_VWSqrSumLocal_Serial(N_Vector x, N_Vector w)
   xd = NV_DATA_S(x);
   wd = NV_DATA_S(w);
 
+  if (NV_SIMD_S(x) != NULL)
+    return(NV_SIMD_S(x)->wsqrsum(N, xd, wd));
+
   for (i = 0; i < N; i++) {
     prodi = xd[i]*wd[i];
     sum += SUNSQR(prodi);
@@ -884,6 +899,20 @@ int N_VLinearCombination_Serial(int nvec, realtype* c, N_Vector* X, N_Vector z)
   N  = NV_LENGTH_S(z);
   zd = NV_DATA_S(z);
 
+  /*
+   * z = c[0]*X[0] + c[1]*X[1], then z += c[i]*X[i] + c[i+1]*X[i+1] so the
+   * vectorized kernels make one pass over z for every two vectors
+   */
+  if (NV_SIMD_S(z) != NULL) {
+    NV_SIMD_S(z)->linearsum(N, c[0], NV_DATA_S(X[0]), c[1], NV_DATA_S(X[1]), zd);
+    for (i=2; i+1<nvec; i+=2)
+      NV_SIMD_S(z)->linearsumadd(N, c[i], NV_DATA_S(X[i]),
+                                 c[i+1], NV_DATA_S(X[i+1]), zd);
+    if (i < nvec)
+      NV_SIMD_S(z)->linearsum(N, c[i], NV_DATA_S(X[i]), ONE, zd, zd);
+    return(0);
+  }
+
   /*
    * X[0] += c[i]*X[i], i = 1,...,nvec-1
    */
@@ -951,6 +980,16 @@ int N_VScaleAddMulti_Serial(int nvec, realtype* a, N_Vector x, N_Vector* Y, N_Ve
   N  = NV_LENGTH_S(x);
   xd = NV_DATA_S(x);
 
+  /*
+   * Z[i][j] = a[i] * x[j] + Y[i][j] with the vectorized kernels
+   */
+  if (NV_SIMD_S(x) != NULL) {
+    for (i=0; i<nvec; i++)
+      NV_SIMD_S(x)->linearsum(N, a[i], xd, ONE, NV_DATA_S(Y[i]),
+                              NV_DATA_S(Z[i]));
+    return(0);
+  }
+
   /*
    * Y[i][j] += a[i] * x[j]
    */
@@ -998,6 +1037,13 @@ int N_VDotProdMulti_Serial(int nvec, N_Vector x, N_Vector* Y, realtype* dotprods
   N  = NV_LENGTH_S(x);
   xd = NV_DATA_S(x);
 
+  /* compute multiple dot products with the vectorized kernels */
+  if (NV_SIMD_S(x) != NULL) {
+    for (i=0; i<nvec; i++)
+      dotprods[i] = NV_SIMD_S(x)->dotprod(N, xd, NV_DATA_S(Y[i]));
+    return(0);
+  }
+
   /* compute multiple dot products */
   for (i=0; i<nvec; i++) {
     yd = NV_DATA_S(Y[i]);
@@ -2148,3 +2194,27 @@ int N_VEnableLinearCombinationVectorArray_Serial(N_Vector v, booleantype tf)
   /* return success */
   return(0);
 }
+
+/* ----------------------------------------------------------------------------
+ * Enable / disable the explicitly vectorized kernels. The kernels for the
+ * widest instruction set supported by the CPU are selected at runtime and are
+ * inherited by clones of the vector.
+ */
+
+int N_VEnableSIMD_Serial(N_Vector v, booleantype tf)
+{
+  /* check that vector is non-NULL */
+  if (v == NULL) return(-1);
+
+  /* check that content structure is non-NULL */
+  if (v->content == NULL) return(-1);
+
+  /* enable/disable kernels */
+  if (tf)
+    NV_SIMD_S(v) = VSIMDSelectKernels_Serial();
+  else
+    NV_SIMD_S(v) = NULL;
+
+  /* return success */
+  return(0);
+}
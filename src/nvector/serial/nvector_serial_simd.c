@@ -0,0 +1,462 @@
+/* -----------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------
+ * This is the implementation file for the explicitly vectorized
+ * kernels used by the serial NVECTOR. AVX-512 and AVX2 kernels are
+ * compiled with function-level target attributes and selected at
+ * runtime from the CPU feature flags, NEON kernels are used on
+ * AArch64, and a portable unrolled kernel is used otherwise. All
+ * reductions use multiple independent accumulators.
+ * -----------------------------------------------------------------*/
+
+#include <sundials/sundials_types.h>
+
+#include "nvector_serial_simd.h"
+
+#if defined(SUNDIALS_DOUBLE_PRECISION) && defined(__x86_64__) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define NV_SIMD_X86
+#include <immintrin.h>
+#elif defined(SUNDIALS_DOUBLE_PRECISION) && defined(__aarch64__) && \
+      defined(__ARM_NEON)
+#define NV_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#define ZERO RCONST(0.0)
+
+/*
+ * -----------------------------------------------------------------
+ * portable kernels
+ * -----------------------------------------------------------------
+ */
+
+static void VLinearSum_Generic(sunindextype n, realtype a, const realtype* x,
+                               realtype b, const realtype* y, realtype* z)
+{
+  sunindextype i;
+  for (i = 0; i < n; i++)
+    z[i] = a * x[i] + b * y[i];
+}
+
+static void VLinearSumAdd_Generic(sunindextype n, realtype a, const realtype* x,
+                                  realtype b, const realtype* y, realtype* z)
+{
+  sunindextype i;
+  for (i = 0; i < n; i++)
+    z[i] += a * x[i] + b * y[i];
+}
+
+static realtype VDotProd_Generic(sunindextype n, const realtype* x,
+                                 const realtype* y)
+{
+  sunindextype i;
+  realtype s0, s1, s2, s3;
+
+  s0 = s1 = s2 = s3 = ZERO;
+  for (i = 0; i + 4 <= n; i += 4) {
+    s0 += x[i]   * y[i];
+    s1 += x[i+1] * y[i+1];
+    s2 += x[i+2] * y[i+2];
+    s3 += x[i+3] * y[i+3];
+  }
+  for (; i < n; i++)
+    s0 += x[i] * y[i];
+
+  return((s0 + s1) + (s2 + s3));
+}
+
+static realtype VWSqrSum_Generic(sunindextype n, const realtype* x,
+                                 const realtype* w)
+{
+  sunindextype i;
+  realtype p0, p1, p2, p3, s0, s1, s2, s3;
+
+  s0 = s1 = s2 = s3 = ZERO;
+  for (i = 0; i + 4 <= n; i += 4) {
+    p0 = x[i]   * w[i];
+    p1 = x[i+1] * w[i+1];
+    p2 = x[i+2] * w[i+2];
+    p3 = x[i+3] * w[i+3];
+    s0 += p0 * p0;
+    s1 += p1 * p1;
+    s2 += p2 * p2;
+    s3 += p3 * p3;
+  }
+  for (; i < n; i++) {
+    p0 = x[i] * w[i];
+    s0 += p0 * p0;
+  }
+
+  return((s0 + s1) + (s2 + s3));
+}
+
+static const N_VSIMDKernels_Serial generic_kernels = {
+  "generic",
+  VLinearSum_Generic,
+  VLinearSumAdd_Generic,
+  VDotProd_Generic,
+  VWSqrSum_Generic
+};
+
+/*
+ * -----------------------------------------------------------------
+ * x86-64 kernels
+ * -----------------------------------------------------------------
+ */
+
+#if defined(NV_SIMD_X86)
+
+/* ---------------------------- AVX2 + FMA ---------------------------- */
+
+#define NV_AVX2 __attribute__((target("avx2,fma")))
+
+NV_AVX2 static double VHsum_AVX2(__m256d v)
+{
+  __m128d lo = _mm256_castpd256_pd128(v);
+  __m128d hi = _mm256_extractf128_pd(v, 1);
+  lo = _mm_add_pd(lo, hi);
+  hi = _mm_unpackhi_pd(lo, lo);
+  return(_mm_cvtsd_f64(_mm_add_sd(lo, hi)));
+}
+
+NV_AVX2 static void VLinearSum_AVX2(sunindextype n, double a, const double* x,
+                                    double b, const double* y, double* z)
+{
+  sunindextype i;
+  __m256d va = _mm256_set1_pd(a);
+  __m256d vb = _mm256_set1_pd(b);
+
+  for (i = 0; i + 4 <= n; i += 4)
+    _mm256_storeu_pd(z + i, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i),
+                                            _mm256_mul_pd(vb, _mm256_loadu_pd(y + i))));
+  for (; i < n; i++)
+    z[i] = a * x[i] + b * y[i];
+}
+
+NV_AVX2 static void VLinearSumAdd_AVX2(sunindextype n, double a, const double* x,
+                                       double b, const double* y, double* z)
+{
+  sunindextype i;
+  __m256d va = _mm256_set1_pd(a);
+  __m256d vb = _mm256_set1_pd(b);
+  __m256d vz;
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    vz = _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i), _mm256_loadu_pd(z + i));
+    _mm256_storeu_pd(z + i, _mm256_fmadd_pd(vb, _mm256_loadu_pd(y + i), vz));
+  }
+  for (; i < n; i++)
+    z[i] += a * x[i] + b * y[i];
+}
+
+NV_AVX2 static double VDotProd_AVX2(sunindextype n, const double* x,
+                                    const double* y)
+{
+  sunindextype i;
+  double sum;
+  __m256d s0 = _mm256_setzero_pd();
+  __m256d s1 = _mm256_setzero_pd();
+  __m256d s2 = _mm256_setzero_pd();
+  __m256d s3 = _mm256_setzero_pd();
+
+  for (i = 0; i + 16 <= n; i += 16) {
+    s0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i),      _mm256_loadu_pd(y + i),      s0);
+    s1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4),  _mm256_loadu_pd(y + i + 4),  s1);
+    s2 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 8),  _mm256_loadu_pd(y + i + 8),  s2);
+    s3 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 12), _mm256_loadu_pd(y + i + 12), s3);
+  }
+  for (; i + 4 <= n; i += 4)
+    s0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), s0);
+
+  sum = VHsum_AVX2(_mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+  for (; i < n; i++)
+    sum += x[i] * y[i];
+
+  return(sum);
+}
+
+NV_AVX2 static double VWSqrSum_AVX2(sunindextype n, const double* x,
+                                    const double* w)
+{
+  sunindextype i;
+  double sum, p;
+  __m256d p0, p1, p2, p3;
+  __m256d s0 = _mm256_setzero_pd();
+  __m256d s1 = _mm256_setzero_pd();
+  __m256d s2 = _mm256_setzero_pd();
+  __m256d s3 = _mm256_setzero_pd();
+
+  for (i = 0; i + 16 <= n; i += 16) {
+    p0 = _mm256_mul_pd(_mm256_loadu_pd(x + i),      _mm256_loadu_pd(w + i));
+    p1 = _mm256_mul_pd(_mm256_loadu_pd(x + i + 4),  _mm256_loadu_pd(w + i + 4));
+    p2 = _mm256_mul_pd(_mm256_loadu_pd(x + i + 8),  _mm256_loadu_pd(w + i + 8));
+    p3 = _mm256_mul_pd(_mm256_loadu_pd(x + i + 12), _mm256_loadu_pd(w + i + 12));
+    s0 = _mm256_fmadd_pd(p0, p0, s0);
+    s1 = _mm256_fmadd_pd(p1, p1, s1);
+    s2 = _mm256_fmadd_pd(p2, p2, s2);
+    s3 = _mm256_fmadd_pd(p3, p3, s3);
+  }
+  for (; i + 4 <= n; i += 4) {
+    p0 = _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(w + i));
+    s0 = _mm256_fmadd_pd(p0, p0, s0);
+  }
+
+  sum = VHsum_AVX2(_mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+  for (; i < n; i++) {
+    p = x[i] * w[i];
+    sum += p * p;
+  }
+
+  return(sum);
+}
+
+static const N_VSIMDKernels_Serial avx2_kernels = {
+  "avx2",
+  VLinearSum_AVX2,
+  VLinearSumAdd_AVX2,
+  VDotProd_AVX2,
+  VWSqrSum_AVX2
+};
+
+/* ------------------------------ AVX-512 ----------------------------- */
+
+#define NV_AVX512 __attribute__((target("avx512f")))
+
+NV_AVX512 static void VLinearSum_AVX512(sunindextype n, double a, const double* x,
+                                        double b, const double* y, double* z)
+{
+  sunindextype i;
+  __m512d va = _mm512_set1_pd(a);
+  __m512d vb = _mm512_set1_pd(b);
+
+  for (i = 0; i + 8 <= n; i += 8)
+    _mm512_storeu_pd(z + i, _mm512_fmadd_pd(va, _mm512_loadu_pd(x + i),
+                                            _mm512_mul_pd(vb, _mm512_loadu_pd(y + i))));
+  for (; i < n; i++)
+    z[i] = a * x[i] + b * y[i];
+}
+
+NV_AVX512 static void VLinearSumAdd_AVX512(sunindextype n, double a, const double* x,
+                                           double b, const double* y, double* z)
+{
+  sunindextype i;
+  __m512d va = _mm512_set1_pd(a);
+  __m512d vb = _mm512_set1_pd(b);
+  __m512d vz;
+
+  for (i = 0; i + 8 <= n; i += 8) {
+    vz = _mm512_fmadd_pd(va, _mm512_loadu_pd(x + i), _mm512_loadu_pd(z + i));
+    _mm512_storeu_pd(z + i, _mm512_fmadd_pd(vb, _mm512_loadu_pd(y + i), vz));
+  }
+  for (; i < n; i++)
+    z[i] += a * x[i] + b * y[i];
+}
+
+NV_AVX512 static double VDotProd_AVX512(sunindextype n, const double* x,
+                                        const double* y)
+{
+  sunindextype i;
+  double sum;
+  __m512d s0 = _mm512_setzero_pd();
+  __m512d s1 = _mm512_setzero_pd();
+  __m512d s2 = _mm512_setzero_pd();
+  __m512d s3 = _mm512_setzero_pd();
+
+  for (i = 0; i + 32 <= n; i += 32) {
+    s0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i),      _mm512_loadu_pd(y + i),      s0);
+    s1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 8),  _mm512_loadu_pd(y + i + 8),  s1);
+    s2 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 16), _mm512_loadu_pd(y + i + 16), s2);
+    s3 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 24), _mm512_loadu_pd(y + i + 24), s3);
+  }
+  for (; i + 8 <= n; i += 8)
+    s0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), s0);
+
+  sum = _mm512_reduce_add_pd(_mm512_add_pd(_mm512_add_pd(s0, s1),
+                                           _mm512_add_pd(s2, s3)));
+  for (; i < n; i++)
+    sum += x[i] * y[i];
+
+  return(sum);
+}
+
+NV_AVX512 static double VWSqrSum_AVX512(sunindextype n, const double* x,
+                                        const double* w)
+{
+  sunindextype i;
+  double sum, p;
+  __m512d p0, p1, p2, p3;
+  __m512d s0 = _mm512_setzero_pd();
+  __m512d s1 = _mm512_setzero_pd();
+  __m512d s2 = _mm512_setzero_pd();
+  __m512d s3 = _mm512_setzero_pd();
+
+  for (i = 0; i + 32 <= n; i += 32) {
+    p0 = _mm512_mul_pd(_mm512_loadu_pd(x + i),      _mm512_loadu_pd(w + i));
+    p1 = _mm512_mul_pd(_mm512_loadu_pd(x + i + 8),  _mm512_loadu_pd(w + i + 8));
+    p2 = _mm512_mul_pd(_mm512_loadu_pd(x + i + 16), _mm512_loadu_pd(w + i + 16));
+    p3 = _mm512_mul_pd(_mm512_loadu_pd(x + i + 24), _mm512_loadu_pd(w + i + 24));
+    s0 = _mm512_fmadd_pd(p0, p0, s0);
+    s1 = _mm512_fmadd_pd(p1, p1, s1);
+    s2 = _mm512_fmadd_pd(p2, p2, s2);
+    s3 = _mm512_fmadd_pd(p3, p3, s3);
+  }
+  for (; i + 8 <= n; i += 8) {
+    p0 = _mm512_mul_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(w + i));
+    s0 = _mm512_fmadd_pd(p0, p0, s0);
+  }
+
+  sum = _mm512_reduce_add_pd(_mm512_add_pd(_mm512_add_pd(s0, s1),
+                                           _mm512_add_pd(s2, s3)));
+  for (; i < n; i++) {
+    p = x[i] * w[i];
+    sum += p * p;
+  }
+
+  return(sum);
+}
+
+static const N_VSIMDKernels_Serial avx512_kernels = {
+  "avx512",
+  VLinearSum_AVX512,
+  VLinearSumAdd_AVX512,
+  VDotProd_AVX512,
+  VWSqrSum_AVX512
+};
+
+#endif /* NV_SIMD_X86 */
+
+/*
+ * -----------------------------------------------------------------
+ * AArch64 kernels
+ * -----------------------------------------------------------------
+ */
+
+#if defined(NV_SIMD_NEON)
+
+static void VLinearSum_NEON(sunindextype n, double a, const double* x,
+                            double b, const double* y, double* z)
+{
+  sunindextype i;
+  float64x2_t va = vdupq_n_f64(a);
+  float64x2_t vb = vdupq_n_f64(b);
+
+  for (i = 0; i + 2 <= n; i += 2)
+    vst1q_f64(z + i, vfmaq_f64(vmulq_f64(vb, vld1q_f64(y + i)),
+                               va, vld1q_f64(x + i)));
+  for (; i < n; i++)
+    z[i] = a * x[i] + b * y[i];
+}
+
+static void VLinearSumAdd_NEON(sunindextype n, double a, const double* x,
+                               double b, const double* y, double* z)
+{
+  sunindextype i;
+  float64x2_t va = vdupq_n_f64(a);
+  float64x2_t vb = vdupq_n_f64(b);
+  float64x2_t vz;
+
+  for (i = 0; i + 2 <= n; i += 2) {
+    vz = vfmaq_f64(vld1q_f64(z + i), va, vld1q_f64(x + i));
+    vst1q_f64(z + i, vfmaq_f64(vz, vb, vld1q_f64(y + i)));
+  }
+  for (; i < n; i++)
+    z[i] += a * x[i] + b * y[i];
+}
+
+static double VDotProd_NEON(sunindextype n, const double* x, const double* y)
+{
+  sunindextype i;
+  double sum;
+  float64x2_t s0 = vdupq_n_f64(0.0);
+  float64x2_t s1 = vdupq_n_f64(0.0);
+  float64x2_t s2 = vdupq_n_f64(0.0);
+  float64x2_t s3 = vdupq_n_f64(0.0);
+
+  for (i = 0; i + 8 <= n; i += 8) {
+    s0 = vfmaq_f64(s0, vld1q_f64(x + i),     vld1q_f64(y + i));
+    s1 = vfmaq_f64(s1, vld1q_f64(x + i + 2), vld1q_f64(y + i + 2));
+    s2 = vfmaq_f64(s2, vld1q_f64(x + i + 4), vld1q_f64(y + i + 4));
+    s3 = vfmaq_f64(s3, vld1q_f64(x + i + 6), vld1q_f64(y + i + 6));
+  }
+  for (; i + 2 <= n; i += 2)
+    s0 = vfmaq_f64(s0, vld1q_f64(x + i), vld1q_f64(y + i));
+
+  sum = vaddvq_f64(vaddq_f64(vaddq_f64(s0, s1), vaddq_f64(s2, s3)));
+  for (; i < n; i++)
+    sum += x[i] * y[i];
+
+  return(sum);
+}
+
+static double VWSqrSum_NEON(sunindextype n, const double* x, const double* w)
+{
+  sunindextype i;
+  double sum, p;
+  float64x2_t p0, p1, p2, p3;
+  float64x2_t s0 = vdupq_n_f64(0.0);
+  float64x2_t s1 = vdupq_n_f64(0.0);
+  float64x2_t s2 = vdupq_n_f64(0.0);
+  float64x2_t s3 = vdupq_n_f64(0.0);
+
+  for (i = 0; i + 8 <= n; i += 8) {
+    p0 = vmulq_f64(vld1q_f64(x + i),     vld1q_f64(w + i));
+    p1 = vmulq_f64(vld1q_f64(x + i + 2), vld1q_f64(w + i + 2));
+    p2 = vmulq_f64(vld1q_f64(x + i + 4), vld1q_f64(w + i + 4));
+    p3 = vmulq_f64(vld1q_f64(x + i + 6), vld1q_f64(w + i + 6));
+    s0 = vfmaq_f64(s0, p0, p0);
+    s1 = vfmaq_f64(s1, p1, p1);
+    s2 = vfmaq_f64(s2, p2, p2);
+    s3 = vfmaq_f64(s3, p3, p3);
+  }
+  for (; i + 2 <= n; i += 2) {
+    p0 = vmulq_f64(vld1q_f64(x + i), vld1q_f64(w + i));
+    s0 = vfmaq_f64(s0, p0, p0);
+  }
+
+  sum = vaddvq_f64(vaddq_f64(vaddq_f64(s0, s1), vaddq_f64(s2, s3)));
+  for (; i < n; i++) {
+    p = x[i] * w[i];
+    sum += p * p;
+  }
+
+  return(sum);
+}
+
+static const N_VSIMDKernels_Serial neon_kernels = {
+  "neon",
+  VLinearSum_NEON,
+  VLinearSumAdd_NEON,
+  VDotProd_NEON,
+  VWSqrSum_NEON
+};
+
+#endif /* NV_SIMD_NEON */
+
+/*
+ * -----------------------------------------------------------------
+ * runtime selection
+ * -----------------------------------------------------------------
+ */
+
+const N_VSIMDKernels_Serial* VSIMDSelectKernels_Serial(void)
+{
+#if defined(NV_SIMD_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return(&avx512_kernels);
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return(&avx2_kernels);
+#elif defined(NV_SIMD_NEON)
+  return(&neon_kernels);
+#endif
+  return(&generic_kernels);
+}
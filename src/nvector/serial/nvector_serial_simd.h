@@ -0,0 +1,58 @@
+/* -----------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------
+ * This is the private header file for the explicitly vectorized
+ * kernels used by the serial NVECTOR when N_VEnableSIMD_Serial has
+ * been called. The kernels operate on raw data arrays and the best
+ * available instruction set is selected at runtime.
+ * -----------------------------------------------------------------*/
+
+#ifndef _NVECTOR_SERIAL_SIMD_H
+#define _NVECTOR_SERIAL_SIMD_H
+
+#include <nvector/nvector_serial.h>
+
+#ifdef __cplusplus  /* wrapper to enable C++ usage */
+extern "C" {
+#endif
+
+/* Table of kernels for one instruction set. The input and output arrays may
+   be the same array, i.e., the kernels must not assume restrict pointers. */
+
+struct _N_VSIMDKernels_Serial {
+  /* name of the instruction set used by the kernels */
+  const char* name;
+
+  /* z = a*x + b*y */
+  void (*linearsum)(sunindextype n, realtype a, const realtype* x,
+                    realtype b, const realtype* y, realtype* z);
+
+  /* z = z + a*x + b*y */
+  void (*linearsumadd)(sunindextype n, realtype a, const realtype* x,
+                       realtype b, const realtype* y, realtype* z);
+
+  /* sum_i x[i]*y[i] */
+  realtype (*dotprod)(sunindextype n, const realtype* x, const realtype* y);
+
+  /* sum_i (x[i]*w[i])^2 */
+  realtype (*wsqrsum)(sunindextype n, const realtype* x, const realtype* w);
+};
+
+typedef struct _N_VSIMDKernels_Serial N_VSIMDKernels_Serial;
+
+/* Returns the kernels for the widest instruction set supported by the CPU */
+const N_VSIMDKernels_Serial* VSIMDSelectKernels_Serial(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -40,8 +40,9 @@ module fsundials_linearsolver_mod
  enum, bind(c)
   enumerator :: SUN_MODIFIED_GS = 1
   enumerator :: SUN_CLASSICAL_GS = 2
+  enumerator :: SUN_DCGS2_GS = 3
  end enum
- public :: SUN_MODIFIED_GS, SUN_CLASSICAL_GS
+ public :: SUN_MODIFIED_GS, SUN_CLASSICAL_GS, SUN_DCGS2_GS
  public :: FSUNModifiedGS
  public :: FModifiedGS
  public :: FSUNClassicalGS
@@ -85,6 +86,9 @@ module fsundials_linearsolver_mod
   enumerator :: SUNLINEARSOLVER_ONEMKLDENSE
   enumerator :: SUNLINEARSOLVER_GINKGO
   enumerator :: SUNLINEARSOLVER_KOKKOSDENSE
+  enumerator :: SUNLINEARSOLVER_SSGMR
+  enumerator :: SUNLINEARSOLVER_GCRODR
+  enumerator :: SUNLINEARSOLVER_BLOCKDENSE
   enumerator :: SUNLINEARSOLVER_CUSTOM
  end enum
  integer, parameter, public :: SUNLinearSolver_ID = kind(SUNLINEARSOLVER_BAND)
@@ -92,7 +96,7 @@ module fsundials_linearsolver_mod
     SUNLINEARSOLVER_LAPACKDENSE, SUNLINEARSOLVER_PCG, SUNLINEARSOLVER_SPBCGS, SUNLINEARSOLVER_SPFGMR, SUNLINEARSOLVER_SPGMR, &
     SUNLINEARSOLVER_SPTFQMR, SUNLINEARSOLVER_SUPERLUDIST, SUNLINEARSOLVER_SUPERLUMT, SUNLINEARSOLVER_CUSOLVERSP_BATCHQR, &
     SUNLINEARSOLVER_MAGMADENSE, SUNLINEARSOLVER_ONEMKLDENSE, SUNLINEARSOLVER_GINKGO, SUNLINEARSOLVER_KOKKOSDENSE, &
-    SUNLINEARSOLVER_CUSTOM
+    SUNLINEARSOLVER_SSGMR, SUNLINEARSOLVER_GCRODR, SUNLINEARSOLVER_BLOCKDENSE, SUNLINEARSOLVER_CUSTOM
  ! struct struct _generic_SUNLinearSolver_Ops
  type, bind(C), public :: SUNLinearSolver_Ops
   type(C_FUNPTR), public :: gettype
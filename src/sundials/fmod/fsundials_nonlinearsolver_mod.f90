@@ -36,6 +36,7 @@ module fsundials_nonlinearsolver_mod
   type(C_FUNPTR), public :: getnumiters
   type(C_FUNPTR), public :: getcuriter
   type(C_FUNPTR), public :: getnumconvfails
+  type(C_FUNPTR), public :: getforcingterm
  end type SUNNonlinearSolver_Ops
  ! struct struct _generic_SUNNonlinearSolver
  type, bind(C), public :: SUNNonlinearSolver
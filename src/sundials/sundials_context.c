@@ -165,6 +165,7 @@ int SUNContext_Free(SUNContext* sunctx)
 #if defined(SUNDIALS_BUILD_WITH_PROFILING) && !defined(SUNDIALS_CALIPER_ENABLED)
   FILE* fp;
   char* sunprofiler_print_env;
+  char* sunprofiler_trace_env;
 #endif
 
   if (!sunctx)
@@ -198,6 +199,10 @@ int SUNContext_Free(SUNContext* sunctx)
   {
     if (fp) SUNProfiler_Print((*sunctx)->profiler, fp);
     if (fp) fclose(fp);
+    /* Write the trace if it was enabled through the environment */
+    sunprofiler_trace_env = getenv("SUNPROFILER_TRACE");
+    if (sunprofiler_trace_env)
+      SUNProfiler_WriteTrace((*sunctx)->profiler, sunprofiler_trace_env);
     if ((*sunctx)->own_profiler) SUNProfiler_Free(&(*sunctx)->profiler);
   }
 #endif
@@ -27,10 +27,22 @@
 #include <sundials/sundials_dense.h>
 #include <sundials/sundials_math.h>
 
+#include "sundials_dense_impl.h"
+
 #define ZERO RCONST(0.0)
 #define ONE  RCONST(1.0)
 #define TWO  RCONST(2.0)
 
+/* number of columns in each panel of the blocked LU factorization */
+#define DENSE_NB 32
+
+static sunindextype denseGETF2(realtype **a, sunindextype m, sunindextype k0,
+                               sunindextype k1, sunindextype *p);
+static void denseRankUpdate(realtype **a, realtype *col_j, sunindextype m,
+                            sunindextype k0, sunindextype k1);
+static void denseRankUpdate2(realtype **a, realtype *col_j, realtype *col_jp1,
+                             sunindextype m, sunindextype k0, sunindextype k1);
+
 /*
  * -----------------------------------------------------
  * Functions working on SUNDlsMat
@@ -133,13 +145,134 @@ sunindextype denseGETRF(realtype **a, sunindextype m, sunindextype n, sunindexty
 }
 
 sunindextype SUNDlsMat_denseGETRF(realtype **a, sunindextype m, sunindextype n, sunindextype *p)
+{
+  sunindextype i, j, k, k0, k1, l, flag;
+  realtype *col_j, *col_k, temp;
+
+  /* The factorization proceeds in panels of DENSE_NB columns. Each panel is
+   * factored with the unblocked algorithm, its row interchanges are then
+   * applied to the columns to the right of the panel, the rows of the panel
+   * are computed with a unit lower triangular solve, and the trailing matrix
+   * receives a rank-DENSE_NB update. The pivot rows are identical to the
+   * unblocked algorithm.
+   */
+  for (k0=0; k0 < n; k0 += DENSE_NB) {
+
+    k1 = SUNMIN(k0 + DENSE_NB, n);
+
+    /* factor the panel, swapping rows in columns 0, ..., k1-1 */
+    flag = denseGETF2(a, m, k0, k1, p);
+    if (flag != 0) return(flag);
+
+    if (k1 == n) break;
+
+    for (j=k1; j < n; j++) {
+
+      col_j = a[j];
+
+      /* apply the row interchanges of the panel */
+      for (k=k0; k < k1; k++) {
+        l = p[k];
+        if (l != k) {
+          temp = col_j[l];
+          col_j[l] = col_j[k];
+          col_j[k] = temp;
+        }
+      }
+
+      /* solve L11 u = a(k0:k1-1,j) with the unit lower triangle of the panel */
+      for (k=k0; k < k1; k++) {
+        col_k = a[k];
+        temp = col_j[k];
+        if (temp != ZERO)
+          for (i=k+1; i < k1; i++)
+            col_j[i] -= temp * col_k[i];
+      }
+    }
+
+    /* a(k1:m-1,k1:n-1) -= L21 U12, two columns at a time */
+    for (j=k1; j+2 <= n; j+=2)
+      denseRankUpdate2(a, a[j], a[j+1], m, k0, k1);
+    if (j < n)
+      denseRankUpdate(a, a[j], m, k0, k1);
+  }
+
+  /* return 0 to indicate success */
+
+  return(0);
+}
+
+void denseGETRS(realtype **a, sunindextype n, sunindextype *p, realtype *b)
+{
+  SUNDlsMat_denseGETRS(a, n, p, b);
+}
+
+void SUNDlsMat_denseGETRS(realtype **a, sunindextype n, sunindextype *p, realtype *b)
+{
+  sunindextype i, k, pk;
+  realtype *c0, *c1, *c2, *c3, b0, b1, b2, b3, tmp;
+
+  /* Permute b, based on pivot information in p */
+  for (k=0; k<n; k++) {
+    pk = p[k];
+    if(pk != k) {
+      tmp = b[k];
+      b[k] = b[pk];
+      b[pk] = tmp;
+    }
+  }
+
+  /* Solve Ly = b, store solution y in b. Four columns of L are applied at a
+     time after solving with their 4 by 4 diagonal block. */
+  for (k=0; k+4 <= n; k+=4) {
+    c0 = a[k];  c1 = a[k+1];  c2 = a[k+2];  c3 = a[k+3];
+    b0 = b[k];
+    b1 = b[k+1] - c0[k+1]*b0;
+    b2 = b[k+2] - c0[k+2]*b0 - c1[k+2]*b1;
+    b3 = b[k+3] - c0[k+3]*b0 - c1[k+3]*b1 - c2[k+3]*b2;
+    b[k+1] = b1;  b[k+2] = b2;  b[k+3] = b3;
+    for (i=k+4; i<n; i++)
+      b[i] -= c0[i]*b0 + c1[i]*b1 + c2[i]*b2 + c3[i]*b3;
+  }
+  for (; k<n-1; k++) {
+    c0 = a[k];
+    for (i=k+1; i<n; i++) b[i] -= c0[i]*b[k];
+  }
+
+  /* Solve Ux = y, store solution x in b, four columns of U at a time */
+  for (k=n-1; k >= 3; k-=4) {
+    c0 = a[k];  c1 = a[k-1];  c2 = a[k-2];  c3 = a[k-3];
+    b0 = b[k] / c0[k];
+    b1 = (b[k-1] - c0[k-1]*b0) / c1[k-1];
+    b2 = (b[k-2] - c0[k-2]*b0 - c1[k-2]*b1) / c2[k-2];
+    b3 = (b[k-3] - c0[k-3]*b0 - c1[k-3]*b1 - c2[k-3]*b2) / c3[k-3];
+    b[k] = b0;  b[k-1] = b1;  b[k-2] = b2;  b[k-3] = b3;
+    for (i=0; i<k-3; i++)
+      b[i] -= c0[i]*b0 + c1[i]*b1 + c2[i]*b2 + c3[i]*b3;
+  }
+  for (; k >= 0; k--) {
+    c0 = a[k];
+    b[k] /= c0[k];
+    for (i=0; i<k; i++) b[i] -= c0[i]*b[k];
+  }
+
+}
+
+/*
+ * Unblocked LU factorization of the panel of columns k0, ..., k1-1 of the
+ * m by n matrix a, assuming the columns to the left of the panel have been
+ * factored. Row interchanges are applied to columns 0, ..., k1-1 only.
+ */
+
+static sunindextype denseGETF2(realtype **a, sunindextype m, sunindextype k0,
+                               sunindextype k1, sunindextype *p)
 {
   sunindextype i, j, k, l;
   realtype *col_j, *col_k;
   realtype temp, mult, a_kj;
 
   /* k-th elimination step number */
-  for (k=0; k < n; k++) {
+  for (k=k0; k < k1; k++) {
 
     col_k  = a[k];
 
@@ -152,9 +285,9 @@ sunindextype SUNDlsMat_denseGETRF(realtype **a, sunindextype m, sunindextype n,
     /* check for zero pivot element */
     if (col_k[l] == ZERO) return(k+1);
 
-    /* swap a(k,1:n) and a(l,1:n) if necessary */
+    /* swap a(k,0:k1-1) and a(l,0:k1-1) if necessary */
     if ( l!= k ) {
-      for (i=0; i<n; i++) {
+      for (i=0; i<k1; i++) {
         temp = a[i][l];
         a[i][l] = a[i][k];
         a[i][k] = temp;
@@ -170,19 +303,14 @@ sunindextype SUNDlsMat_denseGETRF(realtype **a, sunindextype m, sunindextype n,
     mult = ONE/col_k[k];
     for(i=k+1; i < m; i++) col_k[i] *= mult;
 
-    /* row_i = row_i - [a(i,k)/a(k,k)] row_k, i=k+1, ..., m-1 */
-    /* row k is the pivot row after swapping with row l.      */
-    /* The computation is done one column at a time,          */
-    /* column j=k+1, ..., n-1.                                */
+    /* row_i = row_i - [a(i,k)/a(k,k)] row_k, i=k+1, ..., m-1, */
+    /* for the remaining columns of the panel j=k+1, ..., k1-1 */
 
-    for (j=k+1; j < n; j++) {
+    for (j=k+1; j < k1; j++) {
 
       col_j = a[j];
       a_kj = col_j[k];
 
-      /* a(i,j) = a(i,j) - [a(i,k)/a(k,k)]*a(k,j)  */
-      /* a_kj = a(k,j), col_k[i] = - a(i,k)/a(k,k) */
-
       if (a_kj != ZERO) {
         for (i=k+1; i < m; i++)
           col_j[i] -= a_kj * col_k[i];
@@ -190,45 +318,65 @@ sunindextype SUNDlsMat_denseGETRF(realtype **a, sunindextype m, sunindextype n,
     }
   }
 
-  /* return 0 to indicate success */
-
   return(0);
 }
 
-void denseGETRS(realtype **a, sunindextype n, sunindextype *p, realtype *b)
+/*
+ * Update col_j(k1:m-1) -= sum_{k=k0}^{k1-1} a(k1:m-1,k) col_j(k), applying
+ * four columns of the panel per pass over col_j so the compiler can keep the
+ * multipliers in registers and vectorize the inner loop.
+ */
+
+static void denseRankUpdate(realtype **a, realtype *col_j, sunindextype m,
+                            sunindextype k0, sunindextype k1)
 {
-  SUNDlsMat_denseGETRS(a, n, p, b);
+  sunindextype i, k;
+  realtype *c0, *c1, *c2, *c3, u0, u1, u2, u3;
+
+  for (k=k0; k+4 <= k1; k+=4) {
+    c0 = a[k];  c1 = a[k+1];  c2 = a[k+2];  c3 = a[k+3];
+    u0 = col_j[k];  u1 = col_j[k+1];  u2 = col_j[k+2];  u3 = col_j[k+3];
+    for (i=k1; i < m; i++)
+      col_j[i] -= c0[i]*u0 + c1[i]*u1 + c2[i]*u2 + c3[i]*u3;
+  }
+  for (; k < k1; k++) {
+    c0 = a[k];
+    u0 = col_j[k];
+    if (u0 != ZERO)
+      for (i=k1; i < m; i++)
+        col_j[i] -= c0[i]*u0;
+  }
 }
 
-void SUNDlsMat_denseGETRS(realtype **a, sunindextype n, sunindextype *p, realtype *b)
+/*
+ * Same update as denseRankUpdate for rows k1, ..., m-1 of the two columns
+ * col_j and col_jp1, so each column of the panel is loaded once for both.
+ */
+
+static void denseRankUpdate2(realtype **a, realtype *col_j, realtype *col_jp1,
+                             sunindextype m, sunindextype k0, sunindextype k1)
 {
-  sunindextype i, k, pk;
-  realtype *col_k, tmp;
+  sunindextype i, k;
+  realtype *c0, *c1, *c2, *c3, u0, u1, u2, u3, v0, v1, v2, v3;
 
-  /* Permute b, based on pivot information in p */
-  for (k=0; k<n; k++) {
-    pk = p[k];
-    if(pk != k) {
-      tmp = b[k];
-      b[k] = b[pk];
-      b[pk] = tmp;
+  for (k=k0; k+4 <= k1; k+=4) {
+    c0 = a[k];  c1 = a[k+1];  c2 = a[k+2];  c3 = a[k+3];
+    u0 = col_j[k];    u1 = col_j[k+1];    u2 = col_j[k+2];    u3 = col_j[k+3];
+    v0 = col_jp1[k];  v1 = col_jp1[k+1];  v2 = col_jp1[k+2];  v3 = col_jp1[k+3];
+    for (i=k1; i < m; i++) {
+      col_j[i]   -= c0[i]*u0 + c1[i]*u1 + c2[i]*u2 + c3[i]*u3;
+      col_jp1[i] -= c0[i]*v0 + c1[i]*v1 + c2[i]*v2 + c3[i]*v3;
     }
   }
-
-  /* Solve Ly = b, store solution y in b */
-  for (k=0; k<n-1; k++) {
-    col_k = a[k];
-    for (i=k+1; i<n; i++) b[i] -= col_k[i]*b[k];
-  }
-
-  /* Solve Ux = y, store solution x in b */
-  for (k = n-1; k > 0; k--) {
-    col_k = a[k];
-    b[k] /= col_k[k];
-    for (i=0; i<k; i++) b[i] -= col_k[i]*b[k];
+  for (; k < k1; k++) {
+    c0 = a[k];
+    u0 = col_j[k];
+    v0 = col_jp1[k];
+    for (i=k1; i < m; i++) {
+      col_j[i]   -= c0[i]*u0;
+      col_jp1[i] -= c0[i]*v0;
+    }
   }
-  b[0] /= a[0][0];
-
 }
 
 /*
@@ -497,3 +645,125 @@ void SUNDlsMat_denseMatvec(realtype **a, realtype *x, realtype *y, sunindextype
   }
 }
 
+/*
+ * -----------------------------------------------------------------
+ * Batched LU factorization and solve with interleaved storage. These
+ * follow SUNDlsMat_denseGETRF and SUNDlsMat_denseGETRS with every
+ * scalar operation applied to the systems k0 <= k < k1 in an inner
+ * loop over contiguous entries. A system with a zero pivot records
+ * the column in failed and continues with non-finite values.
+ * -----------------------------------------------------------------
+ */
+
+void sunBatchedDenseGETRF(realtype *a, sunindextype n, sunindextype ld,
+                          sunindextype k0, sunindextype k1, sunindextype *p,
+                          realtype *work, sunindextype *failed)
+{
+  sunindextype i, j, c, k, l, *piv;
+  realtype *Aic, *Acc, *Aij, *Acj, *Alj, temp;
+
+  for (k = k0; k < k1; k++) failed[k] = 0;
+
+  for (c = 0; c < n; c++) {
+
+    /* find the pivot row of column c in each system */
+    piv = p + c * ld;
+    Acc = a + (c * n + c) * ld;
+    for (k = k0; k < k1; k++) {
+      piv[k]  = c;
+      work[k] = SUNRabs(Acc[k]);
+    }
+    for (i = c + 1; i < n; i++) {
+      Aic = a + (c * n + i) * ld;
+      for (k = k0; k < k1; k++) {
+        if (SUNRabs(Aic[k]) > work[k]) {
+          work[k] = SUNRabs(Aic[k]);
+          piv[k]  = i;
+        }
+      }
+    }
+
+    /* swap rows c and piv in each system */
+    for (j = 0; j < n; j++) {
+      Acj = a + (j * n + c) * ld;
+      for (k = k0; k < k1; k++) {
+        l = piv[k];
+        if (l != c) {
+          Alj = a + (j * n + l) * ld;
+          temp   = Acj[k];
+          Acj[k] = Alj[k];
+          Alj[k] = temp;
+        }
+      }
+    }
+
+    /* check for zero pivots and scale the multipliers in column c */
+    for (k = k0; k < k1; k++) {
+      if ((Acc[k] == ZERO) && (failed[k] == 0)) failed[k] = c + 1;
+      work[k] = ONE / Acc[k];
+    }
+    for (i = c + 1; i < n; i++) {
+      Aic = a + (c * n + i) * ld;
+      for (k = k0; k < k1; k++)
+        Aic[k] *= work[k];
+    }
+
+    /* update the trailing columns of each system */
+    for (j = c + 1; j < n; j++) {
+      Acj = a + (j * n + c) * ld;
+      for (i = c + 1; i < n; i++) {
+        Aic = a + (c * n + i) * ld;
+        Aij = a + (j * n + i) * ld;
+        for (k = k0; k < k1; k++)
+          Aij[k] -= Aic[k] * Acj[k];
+      }
+    }
+  }
+}
+
+void sunBatchedDenseGETRS(realtype *a, sunindextype n, sunindextype ld,
+                          sunindextype k0, sunindextype k1, sunindextype *p,
+                          realtype *b)
+{
+  sunindextype i, c, k, l, *piv;
+  realtype *Aic, *Acc, *bi, *bc, temp;
+
+  /* permute b, based on the pivots of each system */
+  for (c = 0; c < n; c++) {
+    piv = p + c * ld;
+    bc  = b + c * ld;
+    for (k = k0; k < k1; k++) {
+      l = piv[k];
+      if (l != c) {
+        temp         = bc[k];
+        bc[k]        = b[l*ld + k];
+        b[l*ld + k]  = temp;
+      }
+    }
+  }
+
+  /* solve Ly = b, store solution y in b */
+  for (c = 0; c < n - 1; c++) {
+    bc = b + c * ld;
+    for (i = c + 1; i < n; i++) {
+      Aic = a + (c * n + i) * ld;
+      bi  = b + i * ld;
+      for (k = k0; k < k1; k++)
+        bi[k] -= Aic[k] * bc[k];
+    }
+  }
+
+  /* solve Ux = y, store solution x in b */
+  for (c = n - 1; c >= 0; c--) {
+    Acc = a + (c * n + c) * ld;
+    bc  = b + c * ld;
+    for (k = k0; k < k1; k++)
+      bc[k] /= Acc[k];
+    for (i = 0; i < c; i++) {
+      Aic = a + (c * n + i) * ld;
+      bi  = b + i * ld;
+      for (k = k0; k < k1; k++)
+        bi[k] -= Aic[k] * bc[k];
+    }
+  }
+}
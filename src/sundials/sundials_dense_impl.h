@@ -0,0 +1,38 @@
+/* -----------------------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------------------
+ * This is the implementation header file for SUNDIALS dense matrix functions
+ * shared by different modules.
+ * ---------------------------------------------------------------------------*/
+
+#include <sundials/sundials_dense.h>
+
+/* -----------------------------------------------------------------------------
+ * Batched LU factorization and solve of many small dense systems of size n
+ * with interleaved storage: entry (i,j) of system k is a[(j*n + i)*ld + k],
+ * pivot c of system k is p[c*ld + k], and entry i of the right-hand side of
+ * system k is b[i*ld + k], so that the innermost loops over the systems are
+ * unit stride. Callers gather the right-hand sides of a vector into this
+ * layout and scatter the solutions back. The routines act on the systems
+ * k0 <= k < k1 only,
+ * so that callers may split the systems across threads. The work and failed
+ * arrays are indexed by the system, failed[k] is set to the first column + 1
+ * with a zero pivot (0 on success). These are internal utilities and are not
+ * part of the public API.
+ * ---------------------------------------------------------------------------*/
+
+void sunBatchedDenseGETRF(realtype *a, sunindextype n, sunindextype ld,
+                          sunindextype k0, sunindextype k1, sunindextype *p,
+                          realtype *work, sunindextype *failed);
+
+void sunBatchedDenseGETRS(realtype *a, sunindextype n, sunindextype ld,
+                          sunindextype k0, sunindextype k1, sunindextype *p,
+                          realtype *b);
@@ -26,6 +26,10 @@
 #define FACTOR RCONST(1000.0)
 #define ZERO   RCONST(0.0)
 #define ONE    RCONST(1.0)
+#define HALF   RCONST(0.5)
+
+/* Maximum number of QR iterations per eigenvalue */
+#define MAX_QR_ITERS 30
 
 /*
  * -----------------------------------------------------------------
@@ -161,6 +165,388 @@ int SUNClassicalGS(N_Vector *v, realtype **h, int k, int p, realtype *new_vk_nor
   return(0);
 }
 
+/*
+ * -----------------------------------------------------------------
+ * Function : sunDelayedClassicalGS
+ * -----------------------------------------------------------------
+ * One step of the delayed classical Gram-Schmidt (DCGS2) Arnoldi
+ * process. On input v[0],...,v[k-2] are orthonormal, v[k-1] holds
+ * the once orthogonalized (unnormalized) vector t from the
+ * previous step, and v[k] = A t. The inner products needed to
+ * reorthogonalize and normalize t and to project A t are combined
+ * into a single reduction. On return v[k-1] is normalized, column
+ * k-2 of the Hessenberg matrix is complete, column k-1 holds the
+ * first pass projection of A v[k-1], and v[k] holds the next
+ * candidate vector. When correct is SUNFALSE (flexible GMRES) the
+ * correction for applying A to t rather than v[k-1] is omitted and
+ * the caller must scale the stored preconditioned vector by
+ * 1/h[k-1][k-2].
+ * -----------------------------------------------------------------
+ */
+
+int sunDelayedClassicalGS(N_Vector *v, realtype **h, int k,
+                          booleantype correct, realtype *stemp,
+                          N_Vector *vtemp)
+{
+  int i, j, m, retval;
+  realtype alpha, beta, ab, aa, omega, fac;
+
+  /* The first step only projects A v[0] onto v[0] */
+
+  if (k == 1) {
+    h[0][0] = N_VDotProd(v[1], v[0]);
+    N_VLinearSum(ONE, v[1], -h[0][0], v[0], v[1]);
+    return(0);
+  }
+
+  m = k - 1;
+
+  /* Compute a = V^T t, t^T t, b = V^T w and t^T w with one reduction */
+
+  if (v[0]->ops->nvdotprodmultilocal && v[0]->ops->nvdotprodmultiallreduce) {
+    retval = N_VDotProdMultiLocal(k, v[m], v, stemp);
+    if (retval != 0) return(-1);
+    retval = N_VDotProdMultiLocal(k, v[k], v, stemp + k);
+    if (retval != 0) return(-1);
+    retval = N_VDotProdMultiAllReduce(2*k, v[m], stemp);
+    if (retval != 0) return(-1);
+  } else {
+    retval = N_VDotProdMulti(k, v[m], v, stemp);
+    if (retval != 0) return(-1);
+    retval = N_VDotProdMulti(k, v[k], v, stemp + k);
+    if (retval != 0) return(-1);
+  }
+
+  alpha = stemp[m];
+  beta  = stemp[k+m];
+  ab = aa = ZERO;
+  for (i=0; i < m; i++) {
+    ab += stemp[i] * stemp[k+i];
+    aa += stemp[i] * stemp[i];
+  }
+
+  /* Complete the reorthogonalization of column k-2 and store the
+     correction (H a) for A t in column k-1 */
+
+  for (i=0; i < m; i++) h[i][m-1] += stemp[i];
+
+  for (i=0; i < m; i++) {
+    h[i][m] = ZERO;
+    if (correct)
+      for (j=SUNMAX(i-1,0); j < m; j++) h[i][m] += h[i][j] * stemp[j];
+  }
+  h[m][m] = (correct) ? -stemp[m-1] : ZERO;
+
+  /* Reorthogonalize t and normalize using ||t - V a||^2 = t^T t - a^T a
+     when it is numerically positive, otherwise compute the norm */
+
+  fac = (alpha - aa > ZERO) ? ONE/SUNRsqrt(alpha - aa) : ONE;
+
+  for (i=m-1; i >= 0; i--) {
+    stemp[i+1] = -fac * stemp[i];
+    vtemp[i+1] = v[i];
+  }
+  stemp[0] = fac;
+  vtemp[0] = v[m];
+
+  retval = N_VLinearCombination(k, stemp, vtemp, v[m]);
+  if (retval != 0) return(-1);
+
+  if (alpha - aa > ZERO) {
+    omega = SUNRsqrt(alpha - aa);
+  } else {
+    omega = SUNRsqrt(N_VDotProd(v[m], v[m]));
+    if (omega > ZERO) N_VScale(ONE/omega, v[m], v[m]);
+  }
+
+  h[m][m-1] = omega;
+
+  /* Exact breakdown, the caller's convergence test will stop here */
+
+  if (omega == ZERO) {
+    for (i=0; i <= m; i++) h[i][m] = ZERO;
+    return(0);
+  }
+
+  /* First pass projection of A v[k-1] */
+
+  for (i=0; i < m; i++) h[i][m] = (stemp[k+i] - h[i][m]) / omega;
+  h[m][m] += (beta - ab) / (omega * omega);
+
+  stemp[0] = ONE / omega;
+  vtemp[0] = v[k];
+  for (i=0; i < m; i++) {
+    stemp[i+1] = -stemp[k+i] / omega;
+    vtemp[i+1] = v[i];
+  }
+  stemp[k] = -(beta - ab) / (omega * omega);
+  vtemp[k] = v[m];
+
+  retval = N_VLinearCombination(k+1, stemp, vtemp, v[k]);
+  if (retval != 0) return(-1);
+
+  return(0);
+}
+
+/*
+ * -----------------------------------------------------------------
+ * Function : sunDelayedClassicalGSFinalize
+ * -----------------------------------------------------------------
+ * Completes the last column of a DCGS2 Arnoldi process without
+ * another application of A. The once orthogonalized vector v[k]
+ * is reorthogonalized against v[0],...,v[k-1] and normalized, and
+ * column k-1 of the Hessenberg matrix is updated.
+ * -----------------------------------------------------------------
+ */
+
+int sunDelayedClassicalGSFinalize(N_Vector *v, realtype **h, int k,
+                                  realtype *stemp, N_Vector *vtemp)
+{
+  int i, retval;
+  realtype alpha, aa, omega, fac;
+
+  retval = N_VDotProdMulti(k+1, v[k], v, stemp);
+  if (retval != 0) return(-1);
+
+  alpha = stemp[k];
+  aa = ZERO;
+  for (i=0; i < k; i++) {
+    h[i][k-1] += stemp[i];
+    aa += stemp[i] * stemp[i];
+  }
+
+  fac = (alpha - aa > ZERO) ? ONE/SUNRsqrt(alpha - aa) : ONE;
+
+  for (i=k-1; i >= 0; i--) {
+    stemp[i+1] = -fac * stemp[i];
+    vtemp[i+1] = v[i];
+  }
+  stemp[0] = fac;
+  vtemp[0] = v[k];
+
+  retval = N_VLinearCombination(k+1, stemp, vtemp, v[k]);
+  if (retval != 0) return(-1);
+
+  if (alpha - aa > ZERO) {
+    omega = SUNRsqrt(alpha - aa);
+  } else {
+    omega = SUNRsqrt(N_VDotProd(v[k], v[k]));
+    if (omega > ZERO) N_VScale(ONE/omega, v[k], v[k]);
+  }
+
+  h[k][k-1] = omega;
+
+  return(0);
+}
+
+/*
+ * -----------------------------------------------------------------
+ * Function : sunHessenbergEig
+ * -----------------------------------------------------------------
+ * Eigenvalues of the n x n upper Hessenberg matrix a (stored by
+ * rows) using the implicit Francis double shift QR algorithm as
+ * described in G. H. Golub and C. F. Van Loan, "Matrix
+ * Computations", 4th ed., Section 7.5. Only the active diagonal
+ * block is updated since the Schur form is not needed. The real and
+ * imaginary parts are returned in wr and wi, complex conjugate
+ * pairs are stored consecutively with the positive imaginary part
+ * first. The matrix a is destroyed. Returns 0 on success and 1 if
+ * the iteration did not converge.
+ * -----------------------------------------------------------------
+ */
+
+/* Apply the reflector I - beta v v^T with v = (v0, v1, v2) (v2 is
+   ignored if nv = 2) to rows r..r+nv-1 and columns c0..c1 from the
+   left and to columns r..r+nv-1 and rows c2..c3 from the right */
+static void sunHessReflect(int n, realtype *a, int nv, const realtype *v,
+                           realtype beta, int r, int c0, int c1, int c2,
+                           int c3)
+{
+  int i;
+  realtype w;
+
+  for (i=c0; i<=c1; i++) {
+    w = v[0]*a[r*n+i] + v[1]*a[(r+1)*n+i];
+    if (nv == 3) w += v[2]*a[(r+2)*n+i];
+    w *= beta;
+    a[r*n+i]     -= w*v[0];
+    a[(r+1)*n+i] -= w*v[1];
+    if (nv == 3) a[(r+2)*n+i] -= w*v[2];
+  }
+
+  for (i=c2; i<=c3; i++) {
+    w = a[i*n+r]*v[0] + a[i*n+r+1]*v[1];
+    if (nv == 3) w += a[i*n+r+2]*v[2];
+    w *= beta;
+    a[i*n+r]   -= w*v[0];
+    a[i*n+r+1] -= w*v[1];
+    if (nv == 3) a[i*n+r+2] -= w*v[2];
+  }
+}
+
+/* Compute a reflector mapping x (length nv) to a multiple of e1,
+   returns the new first entry or zero if x is zero */
+static realtype sunHessHouse(int nv, const realtype *x, realtype *v,
+                             realtype *beta)
+{
+  int i;
+  realtype scale, nrm, alpha;
+
+  scale = ZERO;
+  for (i=0; i<nv; i++) scale = SUNMAX(scale, SUNRabs(x[i]));
+  if (scale == ZERO) {
+    *beta = ZERO;
+    return(ZERO);
+  }
+
+  nrm = ZERO;
+  for (i=0; i<nv; i++) {
+    v[i] = x[i] / scale;
+    nrm += v[i]*v[i];
+  }
+  nrm = SUNRsqrt(nrm);
+
+  /* choose the sign that avoids cancellation in v[0] */
+  alpha = (v[0] >= ZERO) ? -nrm : nrm;
+  v[0] -= alpha;
+  *beta = ONE / (nrm * (nrm + SUNRabs(x[0]) / scale));
+
+  return(alpha * scale);
+}
+
+/* Eigenvalues of the 2 x 2 block [p q; r s] */
+static void sunHessEig2(realtype p, realtype q, realtype r, realtype s,
+                        realtype *wr1, realtype *wi1, realtype *wr2,
+                        realtype *wi2)
+{
+  realtype scale, half_diff, disc, root, mean, det;
+
+  scale = SUNRabs(p) + SUNRabs(q) + SUNRabs(r) + SUNRabs(s);
+  if (scale == ZERO) {
+    *wr1 = *wr2 = *wi1 = *wi2 = ZERO;
+    return;
+  }
+  p /= scale; q /= scale; r /= scale; s /= scale;
+
+  mean      = HALF * (p + s);
+  half_diff = HALF * (p - s);
+  disc      = half_diff*half_diff + q*r;
+
+  if (disc >= ZERO) {
+    /* real eigenvalues, the one of larger magnitude first to avoid
+       cancellation and the other from the determinant */
+    root = SUNRsqrt(disc);
+    *wr1 = mean + ((mean >= ZERO) ? root : -root);
+    det  = p*s - q*r;
+    *wr2 = (*wr1 != ZERO) ? det / *wr1 : mean - ((mean >= ZERO) ? root : -root);
+    *wr1 *= scale;
+    *wr2 *= scale;
+    *wi1 = *wi2 = ZERO;
+  } else {
+    root = SUNRsqrt(-disc);
+    *wr1 = *wr2 = mean * scale;
+    *wi1 = root * scale;
+    *wi2 = -root * scale;
+  }
+}
+
+int sunHessenbergEig(int n, realtype *a, realtype *wr, realtype *wi)
+{
+  int lo, hi, k, r, nv, iter;
+  realtype anorm, tst, trace, det, x[3], v[3], beta, alpha, mu;
+
+#define H(i,j) a[(i)*n + (j)]
+
+  /* norm used when the diagonal entries next to a subdiagonal are zero */
+  anorm = ZERO;
+  for (r=0; r<n; r++)
+    for (k=SUNMAX(r-1,0); k<n; k++)
+      anorm = SUNMAX(anorm, SUNRabs(H(r,k)));
+
+  hi   = n - 1;
+  iter = 0;
+  while (hi >= 0) {
+
+    /* find the start of the unreduced block ending at row hi */
+    for (lo=hi; lo>0; lo--) {
+      tst = SUNRabs(H(lo-1,lo-1)) + SUNRabs(H(lo,lo));
+      if (tst == ZERO) tst = anorm;
+      if (SUNRabs(H(lo,lo-1)) <= UNIT_ROUNDOFF * tst) {
+        H(lo,lo-1) = ZERO;
+        break;
+      }
+    }
+
+    if (lo == hi) {
+      /* 1 x 1 block deflated */
+      wr[hi] = H(hi,hi);
+      wi[hi] = ZERO;
+      hi--;
+      iter = 0;
+      continue;
+    }
+
+    if (lo == hi-1) {
+      /* 2 x 2 block deflated */
+      sunHessEig2(H(hi-1,hi-1), H(hi-1,hi), H(hi,hi-1), H(hi,hi),
+                  &wr[hi-1], &wi[hi-1], &wr[hi], &wi[hi]);
+      hi -= 2;
+      iter = 0;
+      continue;
+    }
+
+    if (iter == MAX_QR_ITERS) return(1);
+    iter++;
+
+    /* The shifts are the eigenvalues of the trailing 2 x 2 block,
+       given by their sum and product. If the block has not split
+       after every 10 iterations a double real shift of the last
+       diagonal entry perturbed by the last subdiagonals is used to
+       break possible cycles. */
+    if (iter % 10 == 0) {
+      mu    = H(hi,hi) + SUNRabs(H(hi,hi-1)) + SUNRabs(H(hi-1,hi-2));
+      trace = mu + mu;
+      det   = mu * mu;
+    } else {
+      trace = H(hi-1,hi-1) + H(hi,hi);
+      det   = H(hi-1,hi-1)*H(hi,hi) - H(hi-1,hi)*H(hi,hi-1);
+    }
+
+    /* first column of (H - s1 I)(H - s2 I) */
+    x[0] = H(lo,lo)*H(lo,lo) + H(lo,lo+1)*H(lo+1,lo) - trace*H(lo,lo) + det;
+    x[1] = H(lo+1,lo) * (H(lo,lo) + H(lo+1,lo+1) - trace);
+    x[2] = H(lo+1,lo) * H(lo+2,lo+1);
+
+    /* chase the bulge down the block with 3 x 3 reflectors and a final
+       2 x 2 reflector */
+    for (r=lo; r<hi; r++) {
+      nv = (r < hi-1) ? 3 : 2;
+      if (r > lo) {
+        x[0] = H(r,r-1);
+        x[1] = H(r+1,r-1);
+        if (nv == 3) x[2] = H(r+2,r-1);
+      }
+
+      alpha = sunHessHouse(nv, x, v, &beta);
+      if (beta == ZERO) continue;
+
+      sunHessReflect(n, a, nv, v, beta, r, (r > lo) ? r-1 : lo, hi,
+                     lo, SUNMIN(r+3, hi));
+
+      if (r > lo) {
+        H(r,r-1)   = alpha;
+        H(r+1,r-1) = ZERO;
+        if (nv == 3) H(r+2,r-1) = ZERO;
+      }
+    }
+  }
+
+#undef H
+
+  return(0);
+}
+
+
 /*
  * -----------------------------------------------------------------
  * Function : SUNQRfact
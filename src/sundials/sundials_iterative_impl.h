@@ -33,3 +33,24 @@ struct _SUNQRData
   N_Vector vtemp2;
   realtype *temp_array;
 };
+
+/* -----------------------------------------------------------------------------
+ * Delayed classical Gram-Schmidt (DCGS2) Arnoldi steps used by the GMRES
+ * linear solvers. The workspace arrays must hold at least 2*k realtypes and
+ * k+1 N_Vectors.
+ * ---------------------------------------------------------------------------*/
+
+int sunDelayedClassicalGS(N_Vector *v, realtype **h, int k,
+                          booleantype correct, realtype *stemp,
+                          N_Vector *vtemp);
+
+int sunDelayedClassicalGSFinalize(N_Vector *v, realtype **h, int k,
+                                  realtype *stemp, N_Vector *vtemp);
+
+/* -----------------------------------------------------------------------------
+ * Eigenvalues of a small upper Hessenberg matrix stored by rows, used by the
+ * GMRES linear solvers for Ritz and harmonic Ritz values. This is an internal
+ * utility and is not part of the public API.
+ * ---------------------------------------------------------------------------*/
+
+int sunHessenbergEig(int n, realtype *a, realtype *wr, realtype *wi);
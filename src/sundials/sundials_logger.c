@@ -100,6 +100,29 @@ static FILE* sunOpenLogFile(const char* fname, const char* mode)
   return fp;
 }
 
+#if SUNDIALS_LOGGING_LEVEL > 0
+/* Change an output file, the asynchronous backend first writes the queued
+   messages and then swaps the file while its writer thread is idle */
+static void sunLoggerSetFile(SUNLogger logger, FILE** file, FILE* fp)
+{
+  FILE* old_fp = *file;
+
+  if (logger->async)
+  {
+    sunLoggerAsyncSetFile(logger->async, file, fp);
+  }
+  else
+  {
+    *file = fp;
+  }
+
+  if (old_fp && old_fp != fp)
+  {
+    fflush(old_fp);
+  }
+}
+#endif
+
 static void sunCloseLogFile(void* fp)
 {
   if (fp && fp != stdout && fp != stderr)
@@ -178,6 +201,7 @@ int SUNLogger_Create(void* comm, int output_rank, SUNLogger* logger_ptr)
 #endif
   logger->output_rank = output_rank;
   logger->content     = NULL;
+  logger->async       = NULL;
 
   /* use default routines */
   logger->queuemsg = NULL;
@@ -211,12 +235,17 @@ int SUNLogger_CreateFromEnv(void* comm, SUNLogger* logger)
   const char* warning_fname_env = getenv("SUNLOGGER_WARNING_FILENAME");
   const char* info_fname_env    = getenv("SUNLOGGER_INFO_FILENAME");
   const char* debug_fname_env   = getenv("SUNLOGGER_DEBUG_FILENAME");
+  const char* async_env         = getenv("SUNLOGGER_ASYNC_CAPACITY");
 
   retval += SUNLogger_Create(comm, output_rank, logger);
   retval += SUNLogger_SetErrorFilename(*logger, error_fname_env);
   retval += SUNLogger_SetWarningFilename(*logger, warning_fname_env);
   retval += SUNLogger_SetDebugFilename(*logger, debug_fname_env);
   retval += SUNLogger_SetInfoFilename(*logger, info_fname_env);
+  if (async_env)
+  {
+    retval += SUNLogger_EnableAsync(*logger, atoi(async_env));
+  }
 
   return (retval < 0) ? -1 : 0;
 }
@@ -237,23 +266,19 @@ int SUNLogger_SetErrorFilename(SUNLogger logger, const char* error_filename)
   {
 #if SUNDIALS_LOGGING_LEVEL >= SUNDIALS_LOGGING_ERROR
     FILE* fp = NULL;
-    if (!SUNHashMap_GetValue(logger->filenames, error_filename, (void*)&fp))
+    if (SUNHashMap_GetValue(logger->filenames, error_filename, (void*)&fp))
     {
-      logger->error_fp = fp;
-    }
-    else
-    {
-      logger->error_fp = sunOpenLogFile(error_filename, "w+");
-      if (logger->error_fp)
+      fp = sunOpenLogFile(error_filename, "w+");
+      if (fp)
       {
-        SUNHashMap_Insert(logger->filenames, error_filename,
-                          (void*)logger->error_fp);
+        SUNHashMap_Insert(logger->filenames, error_filename, (void*)fp);
       }
       else
       {
         return -1;
       }
     }
+    sunLoggerSetFile(logger, &logger->error_fp, fp);
 #else
     fprintf(stderr,
             "[LOGGER WARNING] "
@@ -283,23 +308,19 @@ int SUNLogger_SetWarningFilename(SUNLogger logger, const char* warning_filename)
   {
 #if SUNDIALS_LOGGING_LEVEL >= SUNDIALS_LOGGING_WARNING
     FILE* fp = NULL;
-    if (!SUNHashMap_GetValue(logger->filenames, warning_filename, (void*)&fp))
-    {
-      logger->warning_fp = fp;
-    }
-    else
+    if (SUNHashMap_GetValue(logger->filenames, warning_filename, (void*)&fp))
     {
-      logger->warning_fp = sunOpenLogFile(warning_filename, "w+");
-      if (logger->warning_fp)
+      fp = sunOpenLogFile(warning_filename, "w+");
+      if (fp)
       {
-        SUNHashMap_Insert(logger->filenames, warning_filename,
-                          (void*)logger->warning_fp);
+        SUNHashMap_Insert(logger->filenames, warning_filename, (void*)fp);
       }
       else
       {
         return -1;
       }
     }
+    sunLoggerSetFile(logger, &logger->warning_fp, fp);
 #else
     fprintf(stderr,
             "[LOGGER WARNING] "
@@ -329,23 +350,19 @@ int SUNLogger_SetInfoFilename(SUNLogger logger, const char* info_filename)
   {
 #if SUNDIALS_LOGGING_LEVEL >= SUNDIALS_LOGGING_INFO
     FILE* fp = NULL;
-    if (!SUNHashMap_GetValue(logger->filenames, info_filename, (void*)&fp))
-    {
-      logger->info_fp = fp;
-    }
-    else
+    if (SUNHashMap_GetValue(logger->filenames, info_filename, (void*)&fp))
     {
-      logger->info_fp = sunOpenLogFile(info_filename, "w+");
-      if (logger->info_fp)
+      fp = sunOpenLogFile(info_filename, "w+");
+      if (fp)
       {
-        SUNHashMap_Insert(logger->filenames, info_filename,
-                          (void*)logger->info_fp);
+        SUNHashMap_Insert(logger->filenames, info_filename, (void*)fp);
       }
       else
       {
         return -1;
       }
     }
+    sunLoggerSetFile(logger, &logger->info_fp, fp);
 #else
     fprintf(stderr,
             "[LOGGER WARNING] "
@@ -375,23 +392,19 @@ int SUNLogger_SetDebugFilename(SUNLogger logger, const char* debug_filename)
   {
 #if SUNDIALS_LOGGING_LEVEL >= SUNDIALS_LOGGING_DEBUG
     FILE* fp = NULL;
-    if (!SUNHashMap_GetValue(logger->filenames, debug_filename, (void*)&fp))
-    {
-      logger->debug_fp = fp;
-    }
-    else
+    if (SUNHashMap_GetValue(logger->filenames, debug_filename, (void*)&fp))
     {
-      logger->debug_fp = sunOpenLogFile(debug_filename, "w+");
-      if (logger->debug_fp)
+      fp = sunOpenLogFile(debug_filename, "w+");
+      if (fp)
       {
-        SUNHashMap_Insert(logger->filenames, debug_filename,
-                          (void*)logger->debug_fp);
+        SUNHashMap_Insert(logger->filenames, debug_filename, (void*)fp);
       }
       else
       {
         return -1;
       }
     }
+    sunLoggerSetFile(logger, &logger->debug_fp, fp);
 #else
     fprintf(stderr,
             "[LOGGER WARNING] "
@@ -429,7 +442,13 @@ int SUNLogger_QueueMsg(SUNLogger logger, SUNLogLevel lvl, const char* scope,
     {
       /* Default implementation */
       int rank = 0;
-      if (sunLoggerIsOutputRank(logger, &rank))
+      if (logger->async && sunLoggerIsOutputRank(logger, &rank))
+      {
+        /* Queue the message for the background thread */
+        retval = sunLoggerAsyncPush(logger->async, lvl, rank, scope, label,
+                                    msg_txt, args);
+      }
+      else if (sunLoggerIsOutputRank(logger, &rank))
       {
         char* log_msg = NULL;
         sunCreateLogMessage(lvl, rank, scope, label, msg_txt, args, &log_msg);
@@ -494,6 +513,12 @@ int SUNLogger_Flush(SUNLogger logger, SUNLogLevel lvl)
     /* Default implementation */
     if (sunLoggerIsOutputRank(logger, NULL))
     {
+      /* Wait for all queued messages to be written */
+      if (logger->async)
+      {
+        sunLoggerAsyncDrain(logger->async);
+      }
+
       switch (lvl)
       {
       case (SUN_LOGLEVEL_DEBUG):
@@ -548,6 +573,43 @@ int SUNLogger_Flush(SUNLogger logger, SUNLogLevel lvl)
   return retval;
 }
 
+int SUNLogger_EnableAsync(SUNLogger logger, int capacity)
+{
+  if (logger == NULL || capacity < 0)
+  {
+    return -1;
+  }
+
+  /* Write any queued messages before changing modes */
+  if (logger->async)
+  {
+    sunLoggerAsyncDestroy(&logger->async);
+  }
+
+  if (capacity == 0 || !sunLoggerIsOutputRank(logger, NULL))
+  {
+    return 0;
+  }
+
+#if SUNDIALS_LOGGING_LEVEL > 0
+  return sunLoggerAsyncCreate(logger, capacity, &logger->async);
+#else
+  return 0;
+#endif
+}
+
+int SUNLogger_GetNumDroppedMsgs(SUNLogger logger, long int* ndropped)
+{
+  if (logger == NULL || ndropped == NULL)
+  {
+    return -1;
+  }
+
+  *ndropped = (logger->async) ? sunLoggerAsyncNumDropped(logger->async) : 0;
+
+  return 0;
+}
+
 int SUNLogger_GetOutputRank(SUNLogger logger, int* output_rank)
 {
   int retval = 0;
@@ -576,6 +638,11 @@ int SUNLogger_Destroy(SUNLogger* logger)
     if (logger && (*logger))
     {
       /* Default implementation */
+      if ((*logger)->async)
+      {
+        sunLoggerAsyncDestroy(&(*logger)->async);
+      }
+
       if (sunLoggerIsOutputRank(*logger, NULL))
       {
         SUNHashMap_Destroy(&(*logger)->filenames, sunCloseLogFile);
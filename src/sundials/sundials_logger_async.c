@@ -0,0 +1,849 @@
+/* -----------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------
+ * Asynchronous backend for SUNLogger. Messages are stored as compact
+ * binary records (copies of the scope, label, and format strings
+ * followed by the argument values) in a bounded lock-free queue. A
+ * background thread formats the records and writes them to the output
+ * files. When the queue is full new messages are dropped and counted.
+ * -----------------------------------------------------------------*/
+
+#include <sundials/sundials_config.h>
+
+#if defined(SUNDIALS_LOGGING_HAVE_PTHREADS) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define SUN_LOGGER_ASYNC_ENABLED
+#endif
+
+#if defined(SUN_LOGGER_ASYNC_ENABLED) && !defined(_DEFAULT_SOURCE)
+/* Needed for nanosleep */
+#define _DEFAULT_SOURCE
+#endif
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef SUN_LOGGER_ASYNC_ENABLED
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#include "sundials_logger_impl.h"
+
+#ifdef SUN_LOGGER_ASYNC_ENABLED
+
+/* Bytes available in each record for the argument values */
+#define SUN_ASYNC_ARG_BYTES 192
+
+/* Bytes available in each record for the scope, label, and format strings */
+#define SUN_ASYNC_TEXT_BYTES 256
+
+/* Max length of a single conversion specification */
+#define SUN_ASYNC_SPEC_LEN 64
+
+/* Argument value types */
+typedef enum {
+  SUN_ASYNC_NONE,
+  SUN_ASYNC_INT,
+  SUN_ASYNC_UINT,
+  SUN_ASYNC_DOUBLE,
+  SUN_ASYNC_LDOUBLE,
+  SUN_ASYNC_STRING,
+  SUN_ASYNC_POINTER
+} sunAsyncArgType;
+
+/* A parsed conversion specification */
+typedef struct {
+  const char* start;  /* position of the '%'              */
+  const char* end;    /* one past the conversion char     */
+  int star_width;     /* width is given by an argument     */
+  int star_prec;      /* precision is given by an argument */
+  int has_prec;       /* a precision is given              */
+  char conv;          /* conversion character              */
+  sunAsyncArgType type;
+} sunAsyncSpec;
+
+typedef struct {
+  size_t seq; /* sequence number used by the queue */
+  SUNLogLevel lvl;
+  int rank;
+  const char* scope; /* strings stored in text */
+  const char* label;
+  const char* fmt;
+  int nspecs;    /* number of conversions with stored values */
+  int truncated; /* not all arguments fit in the record      */
+  union {
+    long double align;
+    unsigned char bytes[SUN_ASYNC_ARG_BYTES];
+  } args;
+  char text[SUN_ASYNC_TEXT_BYTES];
+} sunAsyncRecord;
+
+struct SUNLoggerAsync_ {
+  SUNLogger logger;
+
+  /* Bounded multi-producer queue, see D. Vyukov, "Bounded MPMC queue" */
+  sunAsyncRecord* records;
+  size_t mask;
+  size_t enqueue_pos;
+  size_t dequeue_pos;
+
+  /* Statistics */
+  long int pushed;
+  long int written;
+  long int dropped;
+
+  /* Background thread */
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+
+  /* Held by the background thread while it writes a record so the logger
+     file pointers are not changed during the write */
+  pthread_mutex_t file_mutex;
+  int sleeping;
+  int stop;
+};
+
+/* Parse the conversion specification starting at the '%' in fmt, returns 0 if
+   the specification is not supported */
+static int sunAsyncParseSpec(const char* fmt, sunAsyncSpec* spec)
+{
+  const char* c = fmt + 1;
+  int length    = 0; /* 1 = long, 2 = long long or size modifiers, 3 = L */
+
+  spec->start      = fmt;
+  spec->star_width = 0;
+  spec->star_prec  = 0;
+  spec->has_prec   = 0;
+  spec->type       = SUN_ASYNC_NONE;
+
+  if (*c == '%')
+  {
+    spec->conv = '%';
+    spec->end  = c + 1;
+    return 1;
+  }
+
+  while (*c && strchr("-+ #0'", *c)) { c++; }
+
+  if (*c == '*')
+  {
+    spec->star_width = 1;
+    c++;
+  }
+  else
+  {
+    while (*c >= '0' && *c <= '9') { c++; }
+  }
+
+  if (*c == '.')
+  {
+    spec->has_prec = 1;
+    c++;
+    if (*c == '*')
+    {
+      spec->star_prec = 1;
+      c++;
+    }
+    else
+    {
+      while (*c >= '0' && *c <= '9') { c++; }
+    }
+  }
+
+  while (*c && strchr("hlLzjtq", *c))
+  {
+    if (*c == 'l') { length++; }
+    else if (*c == 'L' || *c == 'q') { length = 3; }
+    else if (*c != 'h') { length = 2; }
+    c++;
+  }
+
+  spec->conv = *c;
+  spec->end  = c + 1;
+
+  switch (*c)
+  {
+  case 'd':
+  case 'i':
+    spec->type = SUN_ASYNC_INT;
+    break;
+  case 'c':
+    spec->type = SUN_ASYNC_INT;
+    break;
+  case 'u':
+  case 'o':
+  case 'x':
+  case 'X':
+    spec->type = SUN_ASYNC_UINT;
+    break;
+  case 'e':
+  case 'E':
+  case 'f':
+  case 'F':
+  case 'g':
+  case 'G':
+  case 'a':
+  case 'A':
+    spec->type = (length == 3) ? SUN_ASYNC_LDOUBLE : SUN_ASYNC_DOUBLE;
+    break;
+  case 's':
+    spec->type = SUN_ASYNC_STRING;
+    break;
+  case 'p':
+  case 'n':
+    spec->type = SUN_ASYNC_POINTER;
+    break;
+  default:
+    return 0;
+  }
+
+  /* very long specifications are not supported when formatting */
+  if (spec->end - spec->start > SUN_ASYNC_SPEC_LEN) { return 0; }
+
+  /* return the number of length modifiers plus one so the values can be read
+     from the va_list */
+  return (length + 1);
+}
+
+/* Read an integer argument with the given length modifier count */
+static long long sunAsyncReadInt(int length, int is_unsigned, va_list* args)
+{
+  if (is_unsigned)
+  {
+    if (length == 1) { return (long long)va_arg(*args, unsigned long); }
+    if (length >= 2) { return (long long)va_arg(*args, unsigned long long); }
+    return (long long)va_arg(*args, unsigned int);
+  }
+  if (length == 1) { return (long long)va_arg(*args, long); }
+  if (length >= 2) { return va_arg(*args, long long); }
+  return (long long)va_arg(*args, int);
+}
+
+/* Align an offset to 8 bytes */
+static size_t sunAsyncAlign(size_t offset) { return (offset + 7) & ~((size_t)7); }
+
+/* Copy a string into the text of the record at offset, truncating it to the
+   available space, and return the offset after the terminating null */
+static size_t sunAsyncCopyText(sunAsyncRecord* rec, size_t offset,
+                               const char* txt, int* truncated)
+{
+  size_t len = strlen(txt);
+
+  if (offset >= SUN_ASYNC_TEXT_BYTES) { offset = SUN_ASYNC_TEXT_BYTES - 1; }
+  if (len + 1 > SUN_ASYNC_TEXT_BYTES - offset)
+  {
+    len        = SUN_ASYNC_TEXT_BYTES - offset - 1;
+    *truncated = 1;
+  }
+  memcpy(rec->text + offset, txt, len);
+  rec->text[offset + len] = '\0';
+  return offset + len + 1;
+}
+
+/* Copy the argument values described by the format string into the record */
+static void sunAsyncEncode(sunAsyncRecord* rec, const char* fmt, va_list* args)
+{
+  size_t offset = 0;
+  size_t len, space;
+  int length;
+  long long ival;
+  long double ldval;
+  double dval;
+  const char* sval;
+  void* pval;
+  sunAsyncSpec spec;
+  const char* c;
+
+  rec->nspecs    = 0;
+  rec->truncated = 0;
+
+  for (c = strchr(fmt, '%'); c; c = strchr(spec.end, '%'))
+  {
+    length = sunAsyncParseSpec(c, &spec);
+    if (length == 0)
+    {
+      /* Unsupported conversion, the remaining arguments cannot be read */
+      rec->truncated = 1;
+      return;
+    }
+    if (spec.conv == '%')
+    {
+      rec->nspecs++;
+      continue;
+    }
+
+    /* Star width and precision values are stored before the value, check
+       for the worst case space needed (a string needs at least one byte) */
+    space = (spec.star_width + spec.star_prec) * sizeof(long long) +
+            ((spec.type == SUN_ASYNC_STRING) ? 1 : 2 * sizeof(long double));
+    if (offset + space > SUN_ASYNC_ARG_BYTES)
+    {
+      rec->truncated = 1;
+      return;
+    }
+    if (spec.star_width)
+    {
+      ival = (long long)va_arg(*args, int);
+      memcpy(rec->args.bytes + offset, &ival, sizeof(ival));
+      offset += sizeof(ival);
+    }
+    if (spec.star_prec)
+    {
+      ival = (long long)va_arg(*args, int);
+      memcpy(rec->args.bytes + offset, &ival, sizeof(ival));
+      offset += sizeof(ival);
+    }
+
+    switch (spec.type)
+    {
+    case SUN_ASYNC_INT:
+    case SUN_ASYNC_UINT:
+      ival = sunAsyncReadInt(length - 1, spec.type == SUN_ASYNC_UINT, args);
+      memcpy(rec->args.bytes + offset, &ival, sizeof(ival));
+      offset += sizeof(ival);
+      break;
+    case SUN_ASYNC_DOUBLE:
+      dval = va_arg(*args, double);
+      memcpy(rec->args.bytes + offset, &dval, sizeof(dval));
+      offset += sizeof(dval);
+      break;
+    case SUN_ASYNC_LDOUBLE:
+      offset = (offset + sizeof(long double) - 1) & ~(sizeof(long double) - 1);
+      ldval  = va_arg(*args, long double);
+      memcpy(rec->args.bytes + offset, &ldval, sizeof(ldval));
+      offset += sizeof(ldval);
+      break;
+    case SUN_ASYNC_POINTER:
+      pval = va_arg(*args, void*);
+      memcpy(rec->args.bytes + offset, &pval, sizeof(pval));
+      offset += sizeof(pval);
+      break;
+    case SUN_ASYNC_STRING:
+      sval = va_arg(*args, const char*);
+      if (sval == NULL) { sval = "(null)"; }
+      /* copy as much of the string as fits */
+      space = SUN_ASYNC_ARG_BYTES - offset;
+      len = strlen(sval);
+      if (len + 1 > space)
+      {
+        len            = space - 1;
+        rec->truncated = 1;
+      }
+      memcpy(rec->args.bytes + offset, sval, len);
+      rec->args.bytes[offset + len] = '\0';
+      offset += len + 1;
+      break;
+    default:
+      break;
+    }
+
+    offset = sunAsyncAlign(offset);
+    rec->nspecs++;
+
+    if (rec->truncated) { return; }
+  }
+}
+
+/* Append text to a growable buffer */
+static int sunAsyncAppend(char** buf, size_t* len, size_t* cap, const char* txt,
+                          size_t n)
+{
+  char* newbuf;
+
+  if (*len + n + 1 > *cap)
+  {
+    *cap   = 2 * (*len + n + 1);
+    newbuf = (char*)realloc(*buf, *cap);
+    if (newbuf == NULL) { return -1; }
+    *buf = newbuf;
+  }
+  memcpy(*buf + *len, txt, n);
+  *len += n;
+  (*buf)[*len] = '\0';
+  return 0;
+}
+
+/* Format the message text of a record */
+static void sunAsyncDecode(sunAsyncRecord* rec, char** buf, size_t* len,
+                           size_t* cap)
+{
+  size_t offset = 0;
+  int i, n;
+  long long ival;
+  long long width = 0;
+  long long prec  = 0;
+  long double ldval;
+  double dval;
+  void* pval;
+  const char* sval;
+  const char* c;
+  const char* text = rec->fmt;
+  char spec_fmt[SUN_ASYNC_SPEC_LEN + 48];
+  char out[512];
+  char* o;
+  sunAsyncSpec spec;
+
+  *len = 0;
+
+  for (i = 0, c = strchr(rec->fmt, '%'); c && i < rec->nspecs;
+       i++, c = strchr(spec.end, '%'))
+  {
+    sunAsyncParseSpec(c, &spec);
+    sunAsyncAppend(buf, len, cap, text, (size_t)(c - text));
+    text = spec.end;
+
+    if (spec.conv == '%')
+    {
+      sunAsyncAppend(buf, len, cap, "%", 1);
+      continue;
+    }
+    if (spec.conv == 'n')
+    {
+      offset = sunAsyncAlign(offset + sizeof(void*) +
+                             (spec.star_width + spec.star_prec) *
+                               sizeof(long long));
+      continue;
+    }
+
+    if (spec.star_width)
+    {
+      memcpy(&width, rec->args.bytes + offset, sizeof(width));
+      offset += sizeof(width);
+    }
+    if (spec.star_prec)
+    {
+      memcpy(&prec, rec->args.bytes + offset, sizeof(prec));
+      offset += sizeof(prec);
+    }
+
+    /* Rebuild the specification with the star values filled in and the
+       length modifier matching the stored value type */
+    o    = spec_fmt;
+    *o++ = '%';
+    for (sval = spec.start + 1; *sval && strchr("-+ #0'", *sval); sval++)
+    {
+      *o++ = *sval;
+    }
+    if (spec.star_width) { o += sprintf(o, "%lld", width); }
+    else
+    {
+      while (*sval >= '0' && *sval <= '9') { *o++ = *sval++; }
+    }
+    if (spec.star_width) { sval++; }
+    if (spec.has_prec)
+    {
+      sval++;
+      if (spec.star_prec)
+      {
+        if (prec >= 0) { o += sprintf(o, ".%lld", prec); }
+        sval++;
+      }
+      else
+      {
+        *o++ = '.';
+        while (*sval >= '0' && *sval <= '9') { *o++ = *sval++; }
+      }
+    }
+    if ((spec.type == SUN_ASYNC_INT && spec.conv != 'c') ||
+        spec.type == SUN_ASYNC_UINT)
+    {
+      *o++ = 'l';
+      *o++ = 'l';
+    }
+    if (spec.type == SUN_ASYNC_LDOUBLE) { *o++ = 'L'; }
+    *o++ = spec.conv;
+    *o   = '\0';
+
+    n = 0;
+    switch (spec.type)
+    {
+    case SUN_ASYNC_INT:
+    case SUN_ASYNC_UINT:
+      memcpy(&ival, rec->args.bytes + offset, sizeof(ival));
+      offset += sizeof(ival);
+      if (spec.conv == 'c') { n = snprintf(out, sizeof(out), spec_fmt, (int)ival); }
+      else { n = snprintf(out, sizeof(out), spec_fmt, ival); }
+      break;
+    case SUN_ASYNC_DOUBLE:
+      memcpy(&dval, rec->args.bytes + offset, sizeof(dval));
+      offset += sizeof(dval);
+      n = snprintf(out, sizeof(out), spec_fmt, dval);
+      break;
+    case SUN_ASYNC_LDOUBLE:
+      offset = (offset + sizeof(long double) - 1) & ~(sizeof(long double) - 1);
+      memcpy(&ldval, rec->args.bytes + offset, sizeof(ldval));
+      offset += sizeof(ldval);
+      n = snprintf(out, sizeof(out), spec_fmt, ldval);
+      break;
+    case SUN_ASYNC_POINTER:
+      memcpy(&pval, rec->args.bytes + offset, sizeof(pval));
+      offset += sizeof(pval);
+      n = snprintf(out, sizeof(out), spec_fmt, pval);
+      break;
+    case SUN_ASYNC_STRING:
+      sval = (const char*)(rec->args.bytes + offset);
+      offset += strlen(sval) + 1;
+      n = snprintf(out, sizeof(out), spec_fmt, sval);
+      break;
+    default:
+      break;
+    }
+    offset = sunAsyncAlign(offset);
+
+    if (n > 0)
+    {
+      sunAsyncAppend(buf, len, cap, out,
+                     (size_t)n < sizeof(out) ? (size_t)n : sizeof(out) - 1);
+    }
+  }
+
+  if (rec->truncated)
+  {
+    /* write the text up to the first conversion without a stored value */
+    c = strchr(text, '%');
+    sunAsyncAppend(buf, len, cap, text, c ? (size_t)(c - text) : strlen(text));
+    sunAsyncAppend(buf, len, cap, "[truncated]", 11);
+  }
+  else
+  {
+    sunAsyncAppend(buf, len, cap, text, strlen(text));
+  }
+}
+
+/* Format a record and write it to the file for its level */
+static void sunAsyncWrite(SUNLoggerAsync async, sunAsyncRecord* rec,
+                          char** buf, size_t* len, size_t* cap)
+{
+  const char* prefix = NULL;
+  FILE* fp           = NULL;
+  SUNLogger logger   = async->logger;
+
+  switch (rec->lvl)
+  {
+  case (SUN_LOGLEVEL_DEBUG):
+    prefix = "DEBUG";
+    fp     = logger->debug_fp;
+    break;
+  case (SUN_LOGLEVEL_WARNING):
+    prefix = "WARNING";
+    fp     = logger->warning_fp;
+    break;
+  case (SUN_LOGLEVEL_INFO):
+    prefix = "INFO";
+    fp     = logger->info_fp;
+    break;
+  case (SUN_LOGLEVEL_ERROR):
+    prefix = "ERROR";
+    fp     = logger->error_fp;
+    break;
+  default:
+    break;
+  }
+
+  if (fp == NULL) { return; }
+
+  sunAsyncDecode(rec, buf, len, cap);
+  fprintf(fp, "[%s][rank::%d][%s][%s] %s\n", prefix, rec->rank, rec->scope,
+          rec->label, *buf);
+}
+
+/* Format and write a record while holding the file lock */
+static void sunAsyncWriteLocked(SUNLoggerAsync async, sunAsyncRecord* rec,
+                                char** buf, size_t* len, size_t* cap)
+{
+  pthread_mutex_lock(&async->file_mutex);
+  sunAsyncWrite(async, rec, buf, len, cap);
+  pthread_mutex_unlock(&async->file_mutex);
+}
+
+/* Try to remove a record from the queue and write it, returns 1 if a record
+   was written */
+static int sunAsyncPop(SUNLoggerAsync async, char** buf, size_t* len,
+                       size_t* cap)
+{
+  sunAsyncRecord* rec;
+  size_t pos, seq;
+  ptrdiff_t diff;
+
+  pos = __atomic_load_n(&async->dequeue_pos, __ATOMIC_RELAXED);
+  for (;;)
+  {
+    rec  = &async->records[pos & async->mask];
+    seq  = __atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE);
+    diff = (ptrdiff_t)seq - (ptrdiff_t)(pos + 1);
+    if (diff == 0)
+    {
+      if (__atomic_compare_exchange_n(&async->dequeue_pos, &pos, pos + 1, 0,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+      {
+        break;
+      }
+    }
+    else if (diff < 0) { return 0; /* empty */ }
+    else { pos = __atomic_load_n(&async->dequeue_pos, __ATOMIC_RELAXED); }
+  }
+
+  sunAsyncWriteLocked(async, rec, buf, len, cap);
+
+  __atomic_store_n(&rec->seq, pos + async->mask + 1, __ATOMIC_RELEASE);
+  __atomic_add_fetch(&async->written, 1, __ATOMIC_RELEASE);
+  return 1;
+}
+
+static void* sunAsyncThread(void* ptr)
+{
+  SUNLoggerAsync async = (SUNLoggerAsync)ptr;
+  char* buf            = NULL;
+  size_t len           = 0;
+  size_t cap           = 0;
+  struct timespec ts;
+
+  for (;;)
+  {
+    if (sunAsyncPop(async, &buf, &len, &cap)) { continue; }
+
+    if (__atomic_load_n(&async->stop, __ATOMIC_ACQUIRE))
+    {
+      /* write anything pushed before stop was set */
+      while (sunAsyncPop(async, &buf, &len, &cap)) {}
+      break;
+    }
+
+    /* Sleep until a producer signals or a timeout, the flag is rechecked
+       with the lock held so a push between the check and the wait is caught
+       by the timeout at worst */
+    pthread_mutex_lock(&async->mutex);
+    __atomic_store_n(&async->sleeping, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&async->pushed, __ATOMIC_SEQ_CST) ==
+          __atomic_load_n(&async->written, __ATOMIC_SEQ_CST) &&
+        !__atomic_load_n(&async->stop, __ATOMIC_SEQ_CST))
+    {
+      clock_gettime(CLOCK_REALTIME, &ts);
+      ts.tv_nsec += 10000000; /* 10 ms */
+      if (ts.tv_nsec >= 1000000000)
+      {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+      }
+      pthread_cond_timedwait(&async->cond, &async->mutex, &ts);
+    }
+    __atomic_store_n(&async->sleeping, 0, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&async->mutex);
+  }
+
+  free(buf);
+  return NULL;
+}
+
+static void sunAsyncWake(SUNLoggerAsync async)
+{
+  if (__atomic_load_n(&async->sleeping, __ATOMIC_SEQ_CST))
+  {
+    pthread_mutex_lock(&async->mutex);
+    pthread_cond_signal(&async->cond);
+    pthread_mutex_unlock(&async->mutex);
+  }
+}
+
+int sunLoggerAsyncCreate(SUNLogger logger, int capacity, SUNLoggerAsync* async_ptr)
+{
+  size_t i, n;
+  SUNLoggerAsync async;
+
+  *async_ptr = NULL;
+  if (capacity <= 0) { return -1; }
+
+  /* round the capacity up to a power of two */
+  for (n = 2; n < (size_t)capacity; n *= 2) {}
+
+  async = (SUNLoggerAsync)malloc(sizeof(struct SUNLoggerAsync_));
+  if (async == NULL) { return -1; }
+
+  async->records = (sunAsyncRecord*)malloc(n * sizeof(sunAsyncRecord));
+  if (async->records == NULL)
+  {
+    free(async);
+    return -1;
+  }
+  for (i = 0; i < n; i++) { async->records[i].seq = i; }
+
+  async->logger      = logger;
+  async->mask        = n - 1;
+  async->enqueue_pos = 0;
+  async->dequeue_pos = 0;
+  async->pushed      = 0;
+  async->written     = 0;
+  async->dropped     = 0;
+  async->sleeping    = 0;
+  async->stop        = 0;
+
+  pthread_mutex_init(&async->mutex, NULL);
+  pthread_mutex_init(&async->file_mutex, NULL);
+  pthread_cond_init(&async->cond, NULL);
+
+  if (pthread_create(&async->thread, NULL, sunAsyncThread, async))
+  {
+    pthread_mutex_destroy(&async->mutex);
+    pthread_mutex_destroy(&async->file_mutex);
+    pthread_cond_destroy(&async->cond);
+    free(async->records);
+    free(async);
+    return -1;
+  }
+
+  *async_ptr = async;
+  return 0;
+}
+
+int sunLoggerAsyncPush(SUNLoggerAsync async, SUNLogLevel lvl, int rank,
+                       const char* scope, const char* label,
+                       const char* msg_txt, va_list args)
+{
+  sunAsyncRecord* rec;
+  size_t pos, seq, offset;
+  ptrdiff_t diff;
+  int truncated;
+  va_list args_copy;
+
+  pos = __atomic_load_n(&async->enqueue_pos, __ATOMIC_RELAXED);
+  for (;;)
+  {
+    rec  = &async->records[pos & async->mask];
+    seq  = __atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE);
+    diff = (ptrdiff_t)seq - (ptrdiff_t)pos;
+    if (diff == 0)
+    {
+      if (__atomic_compare_exchange_n(&async->enqueue_pos, &pos, pos + 1, 0,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+      {
+        break;
+      }
+    }
+    else if (diff < 0)
+    {
+      /* queue is full */
+      __atomic_add_fetch(&async->dropped, 1, __ATOMIC_RELAXED);
+      sunAsyncWake(async);
+      return 0;
+    }
+    else { pos = __atomic_load_n(&async->enqueue_pos, __ATOMIC_RELAXED); }
+  }
+
+  /* The strings may not outlive this call so they are copied, if the format
+     string is truncated only the conversions that fit are written */
+  truncated  = 0;
+  rec->lvl   = lvl;
+  rec->rank  = rank;
+  rec->scope = rec->text;
+  offset     = sunAsyncCopyText(rec, 0, scope ? scope : "(null)", &truncated);
+  rec->label = rec->text + offset;
+  offset     = sunAsyncCopyText(rec, offset, label ? label : "(null)", &truncated);
+  rec->fmt   = rec->text + offset;
+  sunAsyncCopyText(rec, offset, msg_txt ? msg_txt : "", &truncated);
+  va_copy(args_copy, args);
+  sunAsyncEncode(rec, rec->fmt, &args_copy);
+  va_end(args_copy);
+  if (truncated) { rec->truncated = 1; }
+
+  __atomic_store_n(&rec->seq, pos + 1, __ATOMIC_RELEASE);
+  __atomic_add_fetch(&async->pushed, 1, __ATOMIC_SEQ_CST);
+
+  sunAsyncWake(async);
+  return 0;
+}
+
+void sunLoggerAsyncDrain(SUNLoggerAsync async)
+{
+  long int pushed = __atomic_load_n(&async->pushed, __ATOMIC_SEQ_CST);
+  struct timespec ts;
+
+  ts.tv_sec  = 0;
+  ts.tv_nsec = 50000; /* 50 us */
+
+  while (__atomic_load_n(&async->written, __ATOMIC_ACQUIRE) < pushed)
+  {
+    sunAsyncWake(async);
+    nanosleep(&ts, NULL);
+  }
+}
+
+long int sunLoggerAsyncNumDropped(SUNLoggerAsync async)
+{
+  return __atomic_load_n(&async->dropped, __ATOMIC_RELAXED);
+}
+
+void sunLoggerAsyncSetFile(SUNLoggerAsync async, FILE** file, FILE* fp)
+{
+  /* Messages queued before the change are written to the old file */
+  sunLoggerAsyncDrain(async);
+
+  pthread_mutex_lock(&async->file_mutex);
+  *file = fp;
+  pthread_mutex_unlock(&async->file_mutex);
+}
+
+void sunLoggerAsyncDestroy(SUNLoggerAsync* async)
+{
+  if (async == NULL || *async == NULL) { return; }
+
+  __atomic_store_n(&(*async)->stop, 1, __ATOMIC_SEQ_CST);
+  pthread_mutex_lock(&(*async)->mutex);
+  pthread_cond_signal(&(*async)->cond);
+  pthread_mutex_unlock(&(*async)->mutex);
+  pthread_join((*async)->thread, NULL);
+
+  if ((*async)->dropped > 0)
+  {
+    fprintf(stderr, "[LOGGER WARNING] %ld messages were dropped because the "
+            "asynchronous logger queue was full\n", (*async)->dropped);
+  }
+
+  pthread_mutex_destroy(&(*async)->mutex);
+  pthread_mutex_destroy(&(*async)->file_mutex);
+  pthread_cond_destroy(&(*async)->cond);
+  free((*async)->records);
+  free(*async);
+  *async = NULL;
+}
+
+#else
+
+int sunLoggerAsyncCreate(SUNLogger logger, int capacity, SUNLoggerAsync* async_ptr)
+{
+  *async_ptr = NULL;
+  return -1;
+}
+
+int sunLoggerAsyncPush(SUNLoggerAsync async, SUNLogLevel lvl, int rank,
+                       const char* scope, const char* label,
+                       const char* msg_txt, va_list args)
+{
+  return -1;
+}
+
+void sunLoggerAsyncDrain(SUNLoggerAsync async) {}
+
+long int sunLoggerAsyncNumDropped(SUNLoggerAsync async) { return 0; }
+
+void sunLoggerAsyncSetFile(SUNLoggerAsync async, FILE** file, FILE* fp)
+{
+  *file = fp;
+}
+
+void sunLoggerAsyncDestroy(SUNLoggerAsync* async) {}
+
+#endif
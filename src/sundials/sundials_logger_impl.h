@@ -31,6 +31,19 @@
 #define SUNDIALS_LOGGING_EXTRA_DEBUG
 #endif
 
+/* Asynchronous backend, see sundials_logger_async.c */
+typedef struct SUNLoggerAsync_* SUNLoggerAsync;
+
+int sunLoggerAsyncCreate(SUNLogger logger, int capacity,
+                         SUNLoggerAsync* async);
+int sunLoggerAsyncPush(SUNLoggerAsync async, SUNLogLevel lvl, int rank,
+                       const char* scope, const char* label,
+                       const char* msg_txt, va_list args);
+void sunLoggerAsyncDrain(SUNLoggerAsync async);
+long int sunLoggerAsyncNumDropped(SUNLoggerAsync async);
+void sunLoggerAsyncSetFile(SUNLoggerAsync async, FILE** file, FILE* fp);
+void sunLoggerAsyncDestroy(SUNLoggerAsync* async);
+
 struct SUNLogger_ {
   /* MPI information */
   void* commptr;
@@ -48,6 +61,9 @@ struct SUNLogger_ {
   /* Slic-style format string */
   const char* format;
 
+  /* Asynchronous output (NULL when messages are written synchronously) */
+  SUNLoggerAsync async;
+
   /* Content for custom implementations */
   void* content;
 
@@ -63,6 +63,7 @@ SUNNonlinearSolver SUNNonlinSolNewEmpty(SUNContext sunctx)
   ops->getnumiters     = NULL;
   ops->getcuriter      = NULL;
   ops->getnumconvfails = NULL;
+  ops->getforcingterm  = NULL;
 
   /* attach context and ops, initialize content to NULL */
   NLS->sunctx  = sunctx;
@@ -236,3 +237,15 @@ int SUNNonlinSolGetNumConvFails(SUNNonlinearSolver NLS, long int *nconvfails)
     return(SUN_NLS_SUCCESS);
   }
 }
+
+
+/* get the forcing term for the current linear solve (optional) */
+int SUNNonlinSolGetForcingTerm(SUNNonlinearSolver NLS, realtype *eta)
+{
+  if (NLS->ops->getforcingterm) {
+    return((int) NLS->ops->getforcingterm(NLS, eta));
+  } else {
+    *eta = RCONST(0.0);
+    return(SUN_NLS_SUCCESS);
+  }
+}
@@ -663,7 +663,7 @@ int N_VConstVectorArray(int nvec, realtype c, N_Vector* Z)
 
   }
 
-  SUNDIALS_MARK_FUNCTION_BEGIN(getSUNProfiler(Z[0]));
+  SUNDIALS_MARK_FUNCTION_END(getSUNProfiler(Z[0]));
   return(ier);
 }
 
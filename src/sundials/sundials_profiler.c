@@ -14,6 +14,11 @@
 
 #include <sundials/sundials_config.h>
 
+#if defined(SUNDIALS_HAVE_PERF_EVENTS) && !defined(_DEFAULT_SOURCE)
+/* Needed for syscall */
+#define _DEFAULT_SOURCE
+#endif
+
 #if SUNDIALS_MPI_ENABLED
 #include <sundials/sundials_mpi_types.h>
 #include <mpi.h>
@@ -31,6 +36,15 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(SUNDIALS_HAVE_PERF_EVENTS)
+#include <linux/perf_event.h>
+#include <stdint.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #include <sundials/sundials_profiler.h>
 #include <sundials/sundials_math.h>
@@ -39,12 +53,64 @@
 
 #define SUNDIALS_ROOT_TIMER ((const char*) "From profiler epoch")
 
+/* Hardware counters: cycles, instructions, and last level cache misses. The
+   bytes read from memory are estimated as the cache misses times the cache
+   line size. */
+#define SUNDIALS_NUM_COUNTERS   3
+#define SUNDIALS_CTR_CYCLES     0
+#define SUNDIALS_CTR_INSTR      1
+#define SUNDIALS_CTR_LLC_MISSES 2
+#define SUNDIALS_CACHE_LINE     64
+
+/* Default number of trace events stored per thread */
+#define SUNDIALS_TRACE_CAPACITY 65536
+
+/* Thread local storage and atomic operations used by the trace buffers, without
+   compiler support tracing is only safe from a single thread */
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_THREADS__)
+#define SUN_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__) || defined(__clang__)
+#define SUN_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define SUN_THREAD_LOCAL __declspec(thread)
+#else
+#define SUN_THREAD_LOCAL
+#endif
+
 /* Private functions */
 #if SUNDIALS_MPI_ENABLED
 static int sunCollectTimers(SUNProfiler p);
 #endif
 static void sunPrintTimers(int idx, SUNHashMapKeyValue kv, FILE* fp, void* pvoid);
 static int sunCompareTimes(const void* l, const void* r);
+static int sunBindTimer(SUNProfiler p, int idx);
+static void sunTraceFree(SUNProfiler p);
+static void sunTraceWriteEvents(SUNProfiler p, int rank, FILE* fp);
+
+/*
+  Registered timer names.
+  A process-wide table of copies of the timer names. The handle returned by
+  SUNProfiler_RegisterTimer combines the index of a name in the table with the
+  generation of the table. Handles are shared by all profilers so they can be
+  cached in static variables at the call site.
+
+  Names are added while holding the registration lock and published by
+  incrementing the number of names. The names are stored in chunks that are
+  never moved, so a published name can be read without the lock. The table is
+  freed with the last profiler, which starts a new generation and invalidates
+  the existing handles.
+ */
+
+#define SUN_TIMER_INDEX_BITS 16
+#define SUN_TIMER_CHUNK      256
+#define SUN_TIMER_MAX_CHUNKS ((1 << SUN_TIMER_INDEX_BITS) / SUN_TIMER_CHUNK)
+#define SUN_TIMER_MAX_GEN    ((1 << (30 - SUN_TIMER_INDEX_BITS)) - 1)
+
+static char** sunTimerChunks[SUN_TIMER_MAX_CHUNKS];
+static int    sunNumTimerNames   = 0;
+static int    sunTimerGeneration = 0;
+static int    sunNumProfilers    = 0;
+static char   sunTimerLock       = 0;
 
 /*
   sunTimerStruct.
@@ -64,13 +130,31 @@ struct _sunTimerStruct
   double maximum;
   double elapsed;
   long   count;
+  double counters[SUNDIALS_NUM_COUNTERS]; /* accumulated counter values */
+  double cstart[SUNDIALS_NUM_COUNTERS];   /* values at the region start */
+  char*  name;                            /* key in the map of timers   */
 };
 
 typedef struct _sunTimerStruct sunTimerStruct;
 
-static sunTimerStruct* sunTimerStructNew()
+static sunTimerStruct* sunTimerStructNew(const char* name)
 {
+  int i;
   sunTimerStruct* ts = (sunTimerStruct*) malloc(sizeof(sunTimerStruct));
+  if (ts == NULL) return NULL;
+  /* The timer owns a copy of its name so the map key and trace events do not
+     depend on the lifetime of the string passed by the caller */
+  ts->name = NULL;
+  if (name)
+  {
+    ts->name = (char*) malloc((strlen(name) + 1) * sizeof(char));
+    if (ts->name == NULL)
+    {
+      free(ts);
+      return NULL;
+    }
+    strcpy(ts->name, name);
+  }
 #if SUNDIALS_MPI_ENABLED
   ts->tic = 0.0;
   ts->toc = 0.0;
@@ -84,6 +168,8 @@ static sunTimerStruct* sunTimerStructNew()
   ts->average = 0.0;
   ts->maximum = 0.0;
   ts->count   = 0;
+  for (i = 0; i < SUNDIALS_NUM_COUNTERS; i++)
+    ts->counters[i] = ts->cstart[i] = 0.0;
   return ts;
 }
 
@@ -96,6 +182,7 @@ static void sunTimerStructFree(void* TS)
     if (ts->tic) free(ts->tic);
     if (ts->toc) free(ts->toc);
 #endif
+    free(ts->name);
     free(ts);
   }
 }
@@ -127,6 +214,7 @@ static void sunStopTiming(sunTimerStruct* entry)
 
 static void sunResetTiming(sunTimerStruct* entry)
 {
+  int i;
 #if SUNDIALS_MPI_ENABLED
   entry->tic = 0.0;
   entry->toc = 0.0;
@@ -140,6 +228,181 @@ static void sunResetTiming(sunTimerStruct* entry)
   entry->average = 0.0;
   entry->maximum = 0.0;
   entry->count   = 0;
+  for (i = 0; i < SUNDIALS_NUM_COUNTERS; i++)
+    entry->counters[i] = 0.0;
+}
+
+/* Start (end = 0) or stop (end = 1) time of the last timing in seconds */
+static double sunTimeStamp(sunTimerStruct* entry, int end)
+{
+#if SUNDIALS_MPI_ENABLED
+  return end ? entry->toc : entry->tic;
+#else
+  struct timespec* t = end ? entry->toc : entry->tic;
+  return (double) t->tv_sec + (double) t->tv_nsec * 1e-9;
+#endif
+}
+
+static double sunWallTime()
+{
+#if SUNDIALS_MPI_ENABLED
+  return MPI_Wtime();
+#else
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+#endif
+}
+
+
+/*
+  sunTraceBuffer.
+  A private ring buffer of region begin/end events recorded by one thread. When
+  the buffer is full the oldest events are overwritten.
+ */
+
+struct _sunTraceEvent
+{
+  const char* name;  /* owned by the timer for the region */
+  double      ts;    /* seconds since the trace epoch */
+  char        phase; /* 'B' (begin) or 'E' (end)      */
+};
+
+typedef struct _sunTraceEvent sunTraceEvent;
+
+struct _sunTraceBuffer
+{
+  const void*             thread;   /* unique address owned by the thread */
+  int                     tid;      /* index of the thread in the trace   */
+  long                    head;     /* next position to write             */
+  long                    count;    /* number of events stored            */
+  long                    dropped;  /* number of events overwritten       */
+  sunTraceEvent*          events;
+  struct _sunTraceBuffer* next;
+};
+
+typedef struct _sunTraceBuffer sunTraceBuffer;
+
+/* Per-thread cache of the buffer for the most recently used profiler, the
+   serial number identifies the profiler trace the buffer belongs to */
+static SUN_THREAD_LOCAL long            sunTraceCacheSerial = 0;
+static SUN_THREAD_LOCAL sunTraceBuffer* sunTraceCacheBuffer = NULL;
+
+/* Source of trace serial numbers */
+static long sunTraceSerialCounter = 0;
+
+#if defined(__GNUC__) || defined(__clang__)
+static long sunAtomicIncrement(long* x)
+{
+  return __atomic_add_fetch(x, 1, __ATOMIC_RELAXED);
+}
+
+static void sunAtomicPush(sunTraceBuffer** head, sunTraceBuffer* buf)
+{
+  buf->next = __atomic_load_n(head, __ATOMIC_ACQUIRE);
+  while (!__atomic_compare_exchange_n(head, &buf->next, buf, 0,
+                                      __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+}
+
+static int sunAtomicLoad(int* x)
+{
+  return __atomic_load_n(x, __ATOMIC_ACQUIRE);
+}
+
+static void sunAtomicStore(int* x, int value)
+{
+  __atomic_store_n(x, value, __ATOMIC_RELEASE);
+}
+
+static void sunLock(char* lock)
+{
+  while (__atomic_test_and_set(lock, __ATOMIC_ACQUIRE));
+}
+
+static void sunUnlock(char* lock)
+{
+  __atomic_clear(lock, __ATOMIC_RELEASE);
+}
+#else
+static long sunAtomicIncrement(long* x)
+{
+  return ++(*x);
+}
+
+static void sunAtomicPush(sunTraceBuffer** head, sunTraceBuffer* buf)
+{
+  buf->next = *head;
+  *head     = buf;
+}
+
+static int sunAtomicLoad(int* x)
+{
+  return *x;
+}
+
+static void sunAtomicStore(int* x, int value)
+{
+  *x = value;
+}
+
+static void sunLock(char* lock)
+{
+  *lock = 1;
+}
+
+static void sunUnlock(char* lock)
+{
+  *lock = 0;
+}
+#endif
+
+/* Registered name with the given index */
+static const char* sunTimerName(int idx)
+{
+  return sunTimerChunks[idx / SUN_TIMER_CHUNK][idx % SUN_TIMER_CHUNK];
+}
+
+/* Index of the name for a handle, or -1 if the handle is not valid */
+static int sunTimerIndex(int id)
+{
+  int idx = id & ((1 << SUN_TIMER_INDEX_BITS) - 1);
+
+  if (id < 0) return(-1);
+  if ((id >> SUN_TIMER_INDEX_BITS) != sunAtomicLoad(&sunTimerGeneration))
+    return(-1);
+  if (idx >= sunAtomicLoad(&sunNumTimerNames)) return(-1);
+
+  return(idx);
+}
+
+/* Free the registered names and invalidate the existing handles */
+static void sunTimerNamesFree()
+{
+  int i;
+
+  for (i = 0; i < sunNumTimerNames; i++)
+    free(sunTimerChunks[i / SUN_TIMER_CHUNK][i % SUN_TIMER_CHUNK]);
+  for (i = 0; i < SUN_TIMER_MAX_CHUNKS; i++)
+  {
+    free(sunTimerChunks[i]);
+    sunTimerChunks[i] = NULL;
+  }
+  sunAtomicStore(&sunNumTimerNames, 0);
+  sunAtomicStore(&sunTimerGeneration,
+                 (sunTimerGeneration == SUN_TIMER_MAX_GEN) ? 0
+                                                           : sunTimerGeneration + 1);
+}
+
+static void sunTraceBufferPut(sunTraceBuffer* buf, long capacity,
+                              const char* name, double ts, char phase)
+{
+  sunTraceEvent* e = &buf->events[buf->head];
+  e->name  = name;
+  e->ts    = ts;
+  e->phase = phase;
+  if (++buf->head == capacity) buf->head = 0;
+  if (buf->count < capacity) buf->count++;
+  else buf->dropped++;
 }
 
 
@@ -151,17 +414,109 @@ static void sunResetTiming(sunTimerStruct* entry)
 
 struct _SUNProfiler
 {
-  void*           comm;
-  char*           title;
-  SUNHashMap      map;
-  sunTimerStruct* overhead;
-  double          sundials_time;
+  void*            comm;
+  char*            title;
+  SUNHashMap       map;
+  sunTimerStruct** timers;  /* timers indexed by registered handle */
+  int              ntimers; /* length of the timers array          */
+  sunTimerStruct*  overhead;
+  double           sundials_time;
+
+  /* Hardware counters, the first file descriptor is the group leader and
+     counters that could not be opened have a descriptor of -1 */
+  int              counters_on;
+  int              counter_fd[SUNDIALS_NUM_COUNTERS];
+
+  /* Trace of region begin/end events */
+  long             trace_capacity; /* events per thread, 0 if disabled */
+  long             trace_serial;   /* identifies the current buffers   */
+  long             trace_nthreads; /* number of threads with buffers   */
+  double           trace_epoch;    /* time the trace was enabled       */
+  double           trace_cost;     /* measured cost of one event       */
+  sunTraceBuffer*  trace_buffers;
 };
 
+/* Record a trace event from the calling thread */
+static void sunTraceRecord(SUNProfiler p, const char* name, double ts,
+                           char phase)
+{
+  sunTraceBuffer* buf;
+
+  if (sunTraceCacheSerial == p->trace_serial)
+  {
+    buf = sunTraceCacheBuffer;
+  }
+  else
+  {
+    /* Find the buffer for this thread or create one */
+    for (buf = p->trace_buffers; buf != NULL; buf = buf->next)
+      if (buf->thread == (const void*) &sunTraceCacheSerial) break;
+
+    if (buf == NULL)
+    {
+      buf = (sunTraceBuffer*) malloc(sizeof(sunTraceBuffer));
+      if (buf == NULL) return;
+      buf->events = (sunTraceEvent*) malloc(p->trace_capacity *
+                                            sizeof(sunTraceEvent));
+      if (buf->events == NULL)
+      {
+        free(buf);
+        return;
+      }
+      buf->thread  = (const void*) &sunTraceCacheSerial;
+      buf->tid     = (int) sunAtomicIncrement(&p->trace_nthreads) - 1;
+      buf->head    = 0;
+      buf->count   = 0;
+      buf->dropped = 0;
+      sunAtomicPush(&p->trace_buffers, buf);
+    }
+
+    sunTraceCacheSerial = p->trace_serial;
+    sunTraceCacheBuffer = buf;
+  }
+
+  sunTraceBufferPut(buf, p->trace_capacity, name, ts - p->trace_epoch, phase);
+}
+
+/* Read the current counter values, values is left unchanged if the counters
+   cannot be read */
+static void sunReadCounters(SUNProfiler p, double* values)
+{
+#if defined(SUNDIALS_HAVE_PERF_EVENTS)
+  int i, k;
+  uint64_t data[1 + SUNDIALS_NUM_COUNTERS];
+
+  /* With PERF_FORMAT_GROUP the data is the number of counters followed by the
+     value of each counter in the order they were opened */
+  if (read(p->counter_fd[0], data, sizeof(data)) <= 0) return;
+  for (i = 0, k = 1; i < SUNDIALS_NUM_COUNTERS; i++)
+    values[i] = (p->counter_fd[i] >= 0) ? (double) data[k++] : 0.0;
+#endif
+}
+
+static void sunStartCounters(SUNProfiler p, sunTimerStruct* entry)
+{
+  sunReadCounters(p, entry->cstart);
+}
+
+static void sunStopCounters(SUNProfiler p, sunTimerStruct* entry)
+{
+  int i;
+  double values[SUNDIALS_NUM_COUNTERS];
+
+  /* start from the region start values so that nothing is added when the
+     counters cannot be read */
+  for (i = 0; i < SUNDIALS_NUM_COUNTERS; i++)
+    values[i] = entry->cstart[i];
+  sunReadCounters(p, values);
+  for (i = 0; i < SUNDIALS_NUM_COUNTERS; i++)
+    entry->counters[i] += values[i] - entry->cstart[i];
+}
+
 int SUNProfiler_Create(void* comm, const char* title, SUNProfiler* p)
 {
   SUNProfiler profiler;
-  int max_entries;
+  int i, max_entries;
   char* max_entries_env;
 
   *p = profiler = (SUNProfiler) malloc(sizeof(struct _SUNProfiler));
@@ -169,7 +524,7 @@ int SUNProfiler_Create(void* comm, const char* title, SUNProfiler* p)
   if (profiler == NULL)
     return(-1);
 
-  profiler->overhead = sunTimerStructNew();
+  profiler->overhead = sunTimerStructNew(NULL);
   if (profiler->overhead == NULL)
   {
     free(profiler);
@@ -211,9 +566,40 @@ int SUNProfiler_Create(void* comm, const char* title, SUNProfiler* p)
   profiler->title = malloc((strlen(title) + 1) * sizeof(char));
   strcpy(profiler->title, title);
 
+  /* Timers for registered handles are bound on first use */
+  profiler->timers  = NULL;
+  profiler->ntimers = 0;
+
+  /* Counters are disabled by default, setting the SUNPROFILER_COUNTERS
+     environment variable to a value other than 0 enables them */
+  profiler->counters_on = 0;
+  for (i = 0; i < SUNDIALS_NUM_COUNTERS; i++) profiler->counter_fd[i] = -1;
+  max_entries_env = getenv("SUNPROFILER_COUNTERS");
+  if (max_entries_env && strcmp(max_entries_env, "0"))
+    SUNProfiler_EnableCounters(profiler, SUNTRUE);
+
+  /* Tracing is disabled by default, setting the SUNPROFILER_TRACE environment
+     variable enables it with the capacity given by SUNPROFILER_TRACE_CAPACITY */
+  profiler->trace_capacity = 0;
+  profiler->trace_serial   = 0;
+  profiler->trace_nthreads = 0;
+  profiler->trace_epoch    = 0.0;
+  profiler->trace_cost     = 0.0;
+  profiler->trace_buffers  = NULL;
+  if (getenv("SUNPROFILER_TRACE"))
+  {
+    max_entries_env = getenv("SUNPROFILER_TRACE_CAPACITY");
+    SUNProfiler_EnableTrace(profiler, max_entries_env ? atol(max_entries_env)
+                                                      : SUNDIALS_TRACE_CAPACITY);
+  }
+
   /* Initialize the overall timer to 0. */
   profiler->sundials_time = 0.0;
 
+  sunLock(&sunTimerLock);
+  sunNumProfilers++;
+  sunUnlock(&sunTimerLock);
+
   SUNDIALS_MARK_BEGIN(profiler, SUNDIALS_ROOT_TIMER);
   sunStopTiming(profiler->overhead);
 
@@ -229,6 +615,9 @@ int SUNProfiler_Free(SUNProfiler* p)
   if (*p)
   {
     SUNHashMap_Destroy(&(*p)->map, sunTimerStructFree);
+    if ((*p)->timers) free((*p)->timers);
+    sunTraceFree(*p);
+    SUNProfiler_EnableCounters(*p, SUNFALSE);
     sunTimerStructFree((void*) (*p)->overhead);
 #if SUNDIALS_MPI_ENABLED
     if ((*p)->comm)
@@ -239,6 +628,11 @@ int SUNProfiler_Free(SUNProfiler* p)
 #endif
     free((*p)->title);
     free(*p);
+
+    /* The registered names are freed with the last profiler */
+    sunLock(&sunTimerLock);
+    if (--sunNumProfilers == 0) sunTimerNamesFree();
+    sunUnlock(&sunTimerLock);
   }
   *p = NULL;
 
@@ -259,8 +653,13 @@ int SUNProfiler_Begin(SUNProfiler p, const char* name)
 
   if (SUNHashMap_GetValue(p->map, name, (void**) &timer))
   {
-    timer = sunTimerStructNew();
-    ier = SUNHashMap_Insert(p->map, name, (void*) timer);
+    timer = sunTimerStructNew(name);
+    if (timer == NULL)
+    {
+      sunStopTiming(p->overhead);
+      return(-1);
+    }
+    ier = SUNHashMap_Insert(p->map, timer->name, (void*) timer);
     if (ier)
     {
 #ifdef SUNDIALS_DEBUG
@@ -277,7 +676,10 @@ int SUNProfiler_Begin(SUNProfiler p, const char* name)
   }
 
   timer->count++;
+  if (p->counters_on) sunStartCounters(p, timer);
   sunStartTiming(timer);
+  if (p->trace_capacity)
+    sunTraceRecord(p, timer->name, sunTimeStamp(timer, 0), 'B');
 
   sunStopTiming(p->overhead);
   return(0);
@@ -297,11 +699,255 @@ int SUNProfiler_End(SUNProfiler p, const char* name)
   }
 
   sunStopTiming(timer);
+  if (p->counters_on) sunStopCounters(p, timer);
+  if (p->trace_capacity)
+    sunTraceRecord(p, timer->name, sunTimeStamp(timer, 1), 'E');
 
   sunStopTiming(p->overhead);
   return(0);
 }
 
+int SUNProfiler_RegisterTimer(const char* name, int* id)
+{
+  int i, n, c;
+  char* copy;
+
+  if (name == NULL || id == NULL) return(-1);
+
+  sunLock(&sunTimerLock);
+
+  /* Return the existing handle if the name was already registered */
+  n = sunNumTimerNames;
+  for (i = 0; i < n; i++)
+    if (!strcmp(sunTimerName(i), name)) break;
+
+  if (i == n)
+  {
+    c    = n / SUN_TIMER_CHUNK;
+    copy = NULL;
+    if (c < SUN_TIMER_MAX_CHUNKS)
+    {
+      if (sunTimerChunks[c] == NULL)
+        sunTimerChunks[c] = (char**) malloc(SUN_TIMER_CHUNK * sizeof(char*));
+      if (sunTimerChunks[c] != NULL)
+        copy = (char*) malloc((strlen(name) + 1) * sizeof(char));
+    }
+    if (copy == NULL)
+    {
+      sunUnlock(&sunTimerLock);
+      return(-1);
+    }
+    strcpy(copy, name);
+    sunTimerChunks[c][n % SUN_TIMER_CHUNK] = copy;
+    sunAtomicStore(&sunNumTimerNames, n + 1);
+  }
+
+  *id = (sunTimerGeneration << SUN_TIMER_INDEX_BITS) | i;
+
+  sunUnlock(&sunTimerLock);
+
+  return(0);
+}
+
+int SUNProfiler_TimerId(const char* name, int* cache)
+{
+  int id;
+
+  if (cache == NULL) return(-1);
+
+  id = sunAtomicLoad(cache);
+  if (sunTimerIndex(id) >= 0) return(id);
+
+  if (SUNProfiler_RegisterTimer(name, &id)) return(-1);
+  sunAtomicStore(cache, id);
+
+  return(id);
+}
+
+int SUNProfiler_BeginId(SUNProfiler p, int id)
+{
+  int idx;
+  sunTimerStruct* timer;
+
+  if (p == NULL) return(-1);
+  idx = sunTimerIndex(id);
+  if (idx < 0) return(-1);
+
+  if (idx >= p->ntimers || p->timers[idx] == NULL)
+    if (sunBindTimer(p, idx)) return(-1);
+
+  timer = p->timers[idx];
+  timer->count++;
+  if (p->counters_on) sunStartCounters(p, timer);
+  sunStartTiming(timer);
+  if (p->trace_capacity)
+    sunTraceRecord(p, timer->name, sunTimeStamp(timer, 0), 'B');
+
+  return(0);
+}
+
+int SUNProfiler_EndId(SUNProfiler p, int id)
+{
+  int idx;
+  sunTimerStruct* timer;
+
+  if (p == NULL) return(-1);
+  idx = sunTimerIndex(id);
+  if (idx < 0 || idx >= p->ntimers || p->timers[idx] == NULL) return(-1);
+
+  timer = p->timers[idx];
+  sunStopTiming(timer);
+  if (p->counters_on) sunStopCounters(p, timer);
+  if (p->trace_capacity)
+    sunTraceRecord(p, timer->name, sunTimeStamp(timer, 1), 'E');
+
+  return(0);
+}
+
+int SUNProfiler_EnableCounters(SUNProfiler p, booleantype onoff)
+{
+  int i;
+#if defined(SUNDIALS_HAVE_PERF_EVENTS)
+  struct perf_event_attr attr;
+  const uint32_t types[SUNDIALS_NUM_COUNTERS] = {
+    PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE };
+  const uint64_t configs[SUNDIALS_NUM_COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) };
+#endif
+
+  if (p == NULL) return(-1);
+
+  /* Close any open counters */
+  for (i = 0; i < SUNDIALS_NUM_COUNTERS; i++)
+  {
+#if defined(SUNDIALS_HAVE_PERF_EVENTS)
+    if (p->counter_fd[i] >= 0) close(p->counter_fd[i]);
+#endif
+    p->counter_fd[i] = -1;
+  }
+  p->counters_on = 0;
+
+  if (!onoff) return(0);
+
+#if defined(SUNDIALS_HAVE_PERF_EVENTS)
+  /* Open the counters for the calling thread as one group so they can be read
+     with a single system call, the group leader (cycles) is required */
+  for (i = 0; i < SUNDIALS_NUM_COUNTERS; i++)
+  {
+    memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = types[i];
+    attr.config         = configs[i];
+    attr.disabled       = (i == 0);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_GROUP;
+
+    p->counter_fd[i] = (int) syscall(SYS_perf_event_open, &attr, 0, -1,
+                                     p->counter_fd[0], 0);
+
+    /* Fall back to the generic cache miss event */
+    if (i == SUNDIALS_CTR_LLC_MISSES && p->counter_fd[i] < 0)
+    {
+      attr.type        = PERF_TYPE_HARDWARE;
+      attr.config      = PERF_COUNT_HW_CACHE_MISSES;
+      p->counter_fd[i] = (int) syscall(SYS_perf_event_open, &attr, 0, -1,
+                                       p->counter_fd[0], 0);
+    }
+
+    if (p->counter_fd[0] < 0) return(-1);
+  }
+
+  ioctl(p->counter_fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(p->counter_fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  p->counters_on = 1;
+
+  return(0);
+#else
+  return(-1);
+#endif
+}
+
+int SUNProfiler_EnableTrace(SUNProfiler p, long capacity)
+{
+  int i;
+  double start;
+
+  if (p == NULL || capacity < 0) return(-1);
+
+  /* Discard any existing events, a new serial number invalidates the buffers
+     cached by each thread */
+  sunTraceFree(p);
+  p->trace_capacity = SUNMIN(capacity, 64);
+  p->trace_serial   = sunAtomicIncrement(&sunTraceSerialCounter);
+
+  if (capacity == 0) return(0);
+
+  /* Measure the cost of recording an event to estimate the trace overhead
+     using a small buffer to exclude the cost of first touching the memory,
+     the first event allocates the buffer for this thread */
+  sunTraceRecord(p, SUNDIALS_ROOT_TIMER, 0.0, 'B');
+  start = sunWallTime();
+  for (i = 0; i < 2048; i++)
+  {
+    sunTraceRecord(p, SUNDIALS_ROOT_TIMER, start, 'B');
+    sunTraceRecord(p, SUNDIALS_ROOT_TIMER, start, 'E');
+  }
+  p->trace_cost = (sunWallTime() - start) / 4096.0;
+
+  sunTraceFree(p);
+  p->trace_capacity = capacity;
+  p->trace_serial   = sunAtomicIncrement(&sunTraceSerialCounter);
+  p->trace_epoch    = sunWallTime();
+
+  return(0);
+}
+
+int SUNProfiler_WriteTrace(SUNProfiler p, const char* filename)
+{
+  int rank = 0;
+  int nranks = 1;
+  int r, retval = 0;
+  FILE* fp;
+
+  if (p == NULL || filename == NULL) return(-1);
+
+#if SUNDIALS_MPI_ENABLED
+  if (p->comm)
+  {
+    MPI_Comm_rank(*((MPI_Comm*) p->comm), &rank);
+    MPI_Comm_size(*((MPI_Comm*) p->comm), &nranks);
+  }
+#endif
+
+  /* Ranks append their events to the file in order, one process per rank */
+  for (r = 0; r < nranks; r++)
+  {
+    if (r == rank)
+    {
+      fp = fopen(filename, (r == 0) ? "w" : "a");
+      if (fp == NULL)
+      {
+        retval = -1;
+      }
+      else
+      {
+        fprintf(fp, (r == 0) ? "{\"traceEvents\":[\n" : ",\n");
+        sunTraceWriteEvents(p, rank, fp);
+        if (r == nranks - 1) fprintf(fp, "\n],\"displayTimeUnit\":\"ms\"}\n");
+        fclose(fp);
+      }
+    }
+#if SUNDIALS_MPI_ENABLED
+    if (p->comm) MPI_Barrier(*((MPI_Comm*) p->comm));
+#endif
+  }
+
+  return(retval);
+}
+
 int SUNProfiler_Reset(SUNProfiler p)
 {
   int i = 0;
@@ -325,6 +971,9 @@ int SUNProfiler_Reset(SUNProfiler p)
     if (timer) sunResetTiming(timer);
   }
 
+  /* Discard the trace events */
+  if (p->trace_capacity) SUNProfiler_EnableTrace(p, p->trace_capacity);
+
   /* Reset the overall timer. */
   p->sundials_time = 0.0;
 
@@ -338,6 +987,8 @@ int SUNProfiler_Print(SUNProfiler p, FILE* fp)
 {
   int i = 0;
   int rank = 0;
+  long trace_events = 0;
+  sunTraceBuffer* buf = NULL;
   sunTimerStruct* timer = NULL;
   SUNHashMapKeyValue* sorted = NULL;
 
@@ -369,7 +1020,9 @@ int SUNProfiler_Print(SUNProfiler p, FILE* fp)
     fprintf(fp, "\n================================================================================================================\n");
     fprintf(fp, "SUNDIALS GIT VERSION: %s\n", SUNDIALS_GIT_VERSION);
     fprintf(fp, "SUNDIALS PROFILER: %s\n", p->title);
-    fprintf(fp, "%-40s\t %% time (inclusive) \t max/rank \t average/rank \t count \n", "Results:");
+    fprintf(fp, "%-40s\t %% time (inclusive) \t max/rank \t average/rank \t count", "Results:");
+    if (p->counters_on) fprintf(fp, " \t IPC \t LLC misses \t GB/s");
+    fprintf(fp, " \n");
     fprintf(fp, "================================================================================================================\n");
 
 #if SUNDIALS_MPI_ENABLED
@@ -389,9 +1042,20 @@ int SUNProfiler_Print(SUNProfiler p, FILE* fp)
   {
     /* Print out the total time and the profiler overhead */
     fprintf(fp, "%-40s\t %6.2f%% \t         %.6fs \t -- \t\t -- \n", "Est. profiler overhead",
-            p->overhead->elapsed/p->sundials_time,
+            p->overhead->elapsed/p->sundials_time*100,
             p->overhead->elapsed);
 
+    if (p->trace_capacity)
+    {
+      trace_events = 0;
+      for (buf = p->trace_buffers; buf != NULL; buf = buf->next)
+        trace_events += buf->count + buf->dropped;
+      fprintf(fp, "%-40s\t %6.2f%% \t         %.6fs \t -- \t\t %ld\n",
+              "Est. trace overhead",
+              trace_events*p->trace_cost/p->sundials_time*100,
+              trace_events*p->trace_cost, trace_events);
+    }
+
     /* End of output */
     fprintf(fp, "\n");
   }
@@ -405,16 +1069,19 @@ static void sunTimerStructReduceMaxAndSum(void* a, void* b, int* len, MPI_Dataty
   sunTimerStruct* a_ts = (sunTimerStruct*) a;
   sunTimerStruct* b_ts = (sunTimerStruct*) b;
   int i;
+  int k;
   for (i = 0; i < *len; ++i) {
     b_ts[i].average += a_ts[i].elapsed;
     b_ts[i].maximum = SUNMAX(a_ts[i].maximum, b_ts[i].maximum);
+    for (k = 0; k < SUNDIALS_NUM_COUNTERS; k++)
+      b_ts[i].counters[k] += a_ts[i].counters[k];
   }
 }
 
 /* Find the max and average time across all ranks */
 int sunCollectTimers(SUNProfiler p)
 {
-  int i, rank, nranks;
+  int i, k, rank, nranks;
 
   MPI_Comm comm = *((MPI_Comm*) p->comm);
   MPI_Comm_rank(comm, &rank);
@@ -430,13 +1097,14 @@ int sunCollectTimers(SUNProfiler p)
 
   /* Register MPI datatype for sunTimerStruct */
   MPI_Datatype tmp_type, MPI_sunTimerStruct;
-  const int block_lens[2] = { 5, 1 };
-  const MPI_Datatype types[2] = { MPI_DOUBLE, MPI_LONG };
-  const MPI_Aint displ[2] = { offsetof(sunTimerStruct, tic),
-                              offsetof(sunTimerStruct, count) };
+  const int block_lens[3] = { 5, 1, SUNDIALS_NUM_COUNTERS };
+  const MPI_Datatype types[3] = { MPI_DOUBLE, MPI_LONG, MPI_DOUBLE };
+  const MPI_Aint displ[3] = { offsetof(sunTimerStruct, tic),
+                              offsetof(sunTimerStruct, count),
+                              offsetof(sunTimerStruct, counters) };
   MPI_Aint lb, extent;
 
-  MPI_Type_create_struct(2, block_lens, displ, types, &tmp_type);
+  MPI_Type_create_struct(3, block_lens, displ, types, &tmp_type);
   MPI_Type_get_extent(tmp_type, &lb, &extent);
   extent = sizeof(sunTimerStruct);
   MPI_Type_create_resized(tmp_type, lb, extent, &MPI_sunTimerStruct);
@@ -467,6 +1135,8 @@ int sunCollectTimers(SUNProfiler p)
   for (i = 0; i < p->map->size; ++i) {
     values[i]->average = reduced[i].average / (realtype) nranks;
     values[i]->maximum = reduced[i].maximum;
+    for (k = 0; k < SUNDIALS_NUM_COUNTERS; k++)
+      values[i]->counters[k] = reduced[i].counters[k];
   }
 
   free(reduced);
@@ -476,6 +1146,117 @@ int sunCollectTimers(SUNProfiler p)
 }
 #endif
 
+/* Attach the timer for the registered name with index idx to the profiler, the
+   timer is shared with the name based functions so it is created if necessary */
+int sunBindTimer(SUNProfiler p, int idx)
+{
+  int i, n, ier;
+  sunTimerStruct*  timer = NULL;
+  sunTimerStruct** timers;
+
+  sunStartTiming(p->overhead);
+
+  if (idx >= p->ntimers)
+  {
+    n = (idx / SUN_TIMER_CHUNK + 1) * SUN_TIMER_CHUNK;
+    timers = (sunTimerStruct**) realloc(p->timers, n * sizeof(sunTimerStruct*));
+    if (timers == NULL)
+    {
+      sunStopTiming(p->overhead);
+      return(-1);
+    }
+    for (i = p->ntimers; i < n; i++) timers[i] = NULL;
+    p->timers  = timers;
+    p->ntimers = n;
+  }
+
+  if (SUNHashMap_GetValue(p->map, sunTimerName(idx), (void**) &timer))
+  {
+    timer = sunTimerStructNew(sunTimerName(idx));
+    if (timer == NULL)
+    {
+      sunStopTiming(p->overhead);
+      return(-1);
+    }
+    ier = SUNHashMap_Insert(p->map, timer->name, (void*) timer);
+    if (ier)
+    {
+      sunTimerStructFree(timer);
+      sunStopTiming(p->overhead);
+      return(-1);
+    }
+  }
+
+  p->timers[idx] = timer;
+
+  sunStopTiming(p->overhead);
+  return(0);
+}
+
+/* Free all trace buffers */
+void sunTraceFree(SUNProfiler p)
+{
+  sunTraceBuffer* buf;
+
+  while (p->trace_buffers)
+  {
+    buf = p->trace_buffers;
+    p->trace_buffers = buf->next;
+    free(buf->events);
+    free(buf);
+  }
+  p->trace_nthreads = 0;
+}
+
+/* Write a string escaped for JSON (without the enclosing quotes) */
+static void sunTraceWriteName(const char* name, FILE* fp)
+{
+  for (; *name; name++)
+  {
+    if (*name == '"' || *name == '\\') fputc('\\', fp);
+    if ((unsigned char) *name >= 0x20) fputc(*name, fp);
+  }
+}
+
+/* Write the events for this rank in the Chrome trace event format */
+void sunTraceWriteEvents(SUNProfiler p, int rank, FILE* fp)
+{
+  long i, k, depth;
+  sunTraceBuffer* buf;
+  sunTraceEvent*  e;
+
+  fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+          "\"args\":{\"name\":\"", rank);
+  sunTraceWriteName(p->title, fp);
+  fprintf(fp, " rank %d\"}}", rank);
+
+  for (buf = p->trace_buffers; buf != NULL; buf = buf->next)
+  {
+    fprintf(fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+            "\"tid\":%d,\"args\":{\"name\":\"thread %d (%ld events dropped)\"}}",
+            rank, buf->tid, buf->tid, buf->dropped);
+
+    /* Write from the oldest event, skipping end events whose begin event was
+       overwritten */
+    depth = 0;
+    k = (buf->head - buf->count + p->trace_capacity) % p->trace_capacity;
+    for (i = 0; i < buf->count; i++)
+    {
+      e = &buf->events[k];
+      if (++k == p->trace_capacity) k = 0;
+
+      if (e->phase == 'B') depth++;
+      else if (depth > 0) depth--;
+      else continue;
+
+      fprintf(fp, ",\n{\"name\":\"");
+      sunTraceWriteName(e->name, fp);
+      fprintf(fp, "\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d}",
+              e->phase, e->ts * 1e6, rank, buf->tid);
+    }
+  }
+}
+
 /* Print out the: timer name, percentage of exec time (based on the max),
    max across ranks, average across ranks, and the timer counter. */
 void sunPrintTimers(int idx, SUNHashMapKeyValue kv, FILE* fp, void* pvoid)
@@ -485,8 +1266,21 @@ void sunPrintTimers(int idx, SUNHashMapKeyValue kv, FILE* fp, void* pvoid)
   double maximum = ts->maximum;
   double average = ts->average;
   double percent = strcmp((const char*) kv->key, (const char*) SUNDIALS_ROOT_TIMER) ? maximum / p->sundials_time * 100 : 100;
-  fprintf(fp, "%-40s\t %6.2f%% \t         %.6fs \t %.6fs \t %ld\n",
+  double cycles, instructions, misses;
+  fprintf(fp, "%-40s\t %6.2f%% \t         %.6fs \t %.6fs \t %ld",
           kv->key, percent, maximum, average, ts->count);
+  if (p->counters_on)
+  {
+    /* The counters are summed over all ranks, the bandwidth is the total bytes
+       read from memory by all ranks over the max time */
+    cycles       = ts->counters[SUNDIALS_CTR_CYCLES];
+    instructions = ts->counters[SUNDIALS_CTR_INSTR];
+    misses       = ts->counters[SUNDIALS_CTR_LLC_MISSES];
+    fprintf(fp, " \t %5.2f \t %.3e \t %8.3f",
+            cycles > 0.0 ? instructions / cycles : 0.0, misses,
+            maximum > 0.0 ? misses * SUNDIALS_CACHE_LINE / maximum * 1e-9 : 0.0);
+  }
+  fprintf(fp, "\n");
 }
 
 /* Comparator for qsort that compares key-value pairs
@@ -0,0 +1,320 @@
+/* -----------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------
+ * This is the implementation file for the block-diagonal dense
+ * implementation of the SUNLINSOL package.
+ *
+ * The factorization and solve use the batched dense kernels shared
+ * with the CVODE batched integrator, which apply every scalar
+ * operation to all blocks in an inner loop over the interleaved
+ * block entries. When compiled with OpenMP the blocks are split into
+ * contiguous ranges, one per thread, using the number of threads set
+ * in the matrix.
+ * -----------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <sunlinsol/sunlinsol_blockdense.h>
+#include <sundials/sundials_math.h>
+
+#include "sundials_dense_impl.h"
+
+#define ZERO RCONST(0.0)
+#define ONE  RCONST(1.0)
+
+/*
+ * -----------------------------------------------------------------
+ * Block-diagonal dense solver structure accessibility macros:
+ * -----------------------------------------------------------------
+ */
+
+#define BLOCKDENSE_CONTENT(S) ( (SUNLinearSolverContent_BlockDense)(S->content) )
+#define PIVOTS(S)             ( BLOCKDENSE_CONTENT(S)->pivots )
+#define LASTFLAG(S)           ( BLOCKDENSE_CONTENT(S)->last_flag )
+
+/* Private function prototypes */
+static void blockRange(sunindextype nblocks, sunindextype *k0, sunindextype *k1);
+
+/*
+ * -----------------------------------------------------------------
+ * exported functions
+ * -----------------------------------------------------------------
+ */
+
+/* ----------------------------------------------------------------------------
+ * Function to create a new block-diagonal dense linear solver
+ */
+
+SUNLinearSolver SUNLinSol_BlockDense(N_Vector y, SUNMatrix A, SUNContext sunctx)
+{
+  SUNLinearSolver S;
+  SUNLinearSolverContent_BlockDense content;
+  sunindextype nblocks, M;
+
+  /* Check compatibility with supplied SUNMatrix and N_Vector */
+  if (SUNMatGetID(A) != SUNMATRIX_BLOCKDENSE) return(NULL);
+
+  if ( (N_VGetVectorID(y) != SUNDIALS_NVEC_SERIAL) &&
+       (N_VGetVectorID(y) != SUNDIALS_NVEC_OPENMP) &&
+       (N_VGetVectorID(y) != SUNDIALS_NVEC_PTHREADS) )
+    return(NULL);
+
+  if (SUNBlockDenseMatrix_Rows(A) != N_VGetLength(y)) return(NULL);
+
+  nblocks = SUNBlockDenseMatrix_NumBlocks(A);
+  M       = SUNBlockDenseMatrix_BlockRows(A);
+
+  /* Create an empty linear solver */
+  S = NULL;
+  S = SUNLinSolNewEmpty(sunctx);
+  if (S == NULL) return(NULL);
+
+  /* Attach operations */
+  S->ops->gettype    = SUNLinSolGetType_BlockDense;
+  S->ops->getid      = SUNLinSolGetID_BlockDense;
+  S->ops->initialize = SUNLinSolInitialize_BlockDense;
+  S->ops->setup      = SUNLinSolSetup_BlockDense;
+  S->ops->solve      = SUNLinSolSolve_BlockDense;
+  S->ops->lastflag   = SUNLinSolLastFlag_BlockDense;
+  S->ops->space      = SUNLinSolSpace_BlockDense;
+  S->ops->free       = SUNLinSolFree_BlockDense;
+
+  /* Create content */
+  content = NULL;
+  content = (SUNLinearSolverContent_BlockDense) malloc(sizeof *content);
+  if (content == NULL) { SUNLinSolFree(S); return(NULL); }
+
+  /* Attach content */
+  S->content = content;
+
+  /* Fill content */
+  content->nblocks   = nblocks;
+  content->M         = M;
+  content->last_flag = 0;
+  content->pivots    = NULL;
+  content->failed    = NULL;
+  content->work      = NULL;
+  content->rhs       = NULL;
+
+  /* Allocate content */
+  content->pivots = (sunindextype *) malloc(nblocks * M * sizeof(sunindextype));
+  content->failed = (sunindextype *) malloc(nblocks * sizeof(sunindextype));
+  content->work   = (realtype *) malloc(nblocks * sizeof(realtype));
+  content->rhs    = (realtype *) malloc(nblocks * M * sizeof(realtype));
+  if ( (content->pivots == NULL) || (content->failed == NULL) ||
+       (content->work == NULL) || (content->rhs == NULL) ) {
+    SUNLinSolFree(S);
+    return(NULL);
+  }
+
+  return(S);
+}
+
+/*
+ * -----------------------------------------------------------------
+ * implementation of linear solver operations
+ * -----------------------------------------------------------------
+ */
+
+SUNLinearSolver_Type SUNLinSolGetType_BlockDense(SUNLinearSolver S)
+{
+  return(SUNLINEARSOLVER_DIRECT);
+}
+
+SUNLinearSolver_ID SUNLinSolGetID_BlockDense(SUNLinearSolver S)
+{
+  return(SUNLINEARSOLVER_BLOCKDENSE);
+}
+
+int SUNLinSolInitialize_BlockDense(SUNLinearSolver S)
+{
+  /* all solver-specific memory has already been allocated */
+  LASTFLAG(S) = SUNLS_SUCCESS;
+  return(SUNLS_SUCCESS);
+}
+
+int SUNLinSolSetup_BlockDense(SUNLinearSolver S, SUNMatrix A)
+{
+  SUNLinearSolverContent_BlockDense content;
+  sunindextype nb, M, kfail;
+  realtype *Adata;
+
+  /* check for valid inputs */
+  if ( (A == NULL) || (S == NULL) )
+    return(SUNLS_MEM_NULL);
+
+  content = BLOCKDENSE_CONTENT(S);
+
+  /* Ensure that A is a block-diagonal dense matrix of the right shape */
+  if ( (SUNMatGetID(A) != SUNMATRIX_BLOCKDENSE) ||
+       (SUNBlockDenseMatrix_NumBlocks(A) != content->nblocks) ||
+       (SUNBlockDenseMatrix_BlockRows(A) != content->M) ) {
+    LASTFLAG(S) = SUNLS_ILL_INPUT;
+    return(SUNLS_ILL_INPUT);
+  }
+
+  Adata = SUNBlockDenseMatrix_Data(A);
+  if (Adata == NULL) {
+    LASTFLAG(S) = SUNLS_MEM_FAIL;
+    return(SUNLS_MEM_FAIL);
+  }
+
+  nb = content->nblocks;
+  M  = content->M;
+
+  /* perform the LU factorization of all blocks, a block with a zero pivot
+     records the column in failed and continues with non-finite values */
+#ifdef _OPENMP
+#pragma omp parallel num_threads(SUNBlockDenseMatrix_NumThreads(A))
+#endif
+  {
+    sunindextype k0, k1;
+
+    blockRange(nb, &k0, &k1);
+    sunBatchedDenseGETRF(Adata, M, nb, k0, k1, content->pivots,
+                         content->work, content->failed);
+  }
+
+  /* report the first block with a zero pivot as the global column + 1 */
+  LASTFLAG(S) = SUNLS_SUCCESS;
+  for (kfail = 0; kfail < nb; kfail++) {
+    if (content->failed[kfail] > 0) {
+      LASTFLAG(S) = kfail * M + content->failed[kfail];
+      return(SUNLS_LUFACT_FAIL);
+    }
+  }
+  return(SUNLS_SUCCESS);
+}
+
+int SUNLinSolSolve_BlockDense(SUNLinearSolver S, SUNMatrix A, N_Vector x,
+                              N_Vector b, realtype tol)
+{
+  SUNLinearSolverContent_BlockDense content;
+  sunindextype nb, M;
+  realtype *Adata, *xdata, *bdata;
+
+  if ( (A == NULL) || (S == NULL) || (x == NULL) || (b == NULL) )
+    return(SUNLS_MEM_NULL);
+
+  content = BLOCKDENSE_CONTENT(S);
+
+  /* access data pointers (return with failure on NULL) */
+  Adata = SUNBlockDenseMatrix_Data(A);
+  xdata = N_VGetArrayPointer(x);
+  bdata = N_VGetArrayPointer(b);
+  if ( (Adata == NULL) || (xdata == NULL) || (bdata == NULL) ) {
+    LASTFLAG(S) = SUNLS_MEM_FAIL;
+    return(SUNLS_MEM_FAIL);
+  }
+
+  nb = content->nblocks;
+  M  = content->M;
+
+  /* solve using the LU factors of each block, the right-hand sides are
+     interleaved like the matrix so the solve runs across the blocks */
+#ifdef _OPENMP
+#pragma omp parallel num_threads(SUNBlockDenseMatrix_NumThreads(A))
+#endif
+  {
+    sunindextype i, k, k0, k1;
+    realtype *rhs = content->rhs;
+
+    blockRange(nb, &k0, &k1);
+    for (k = k0; k < k1; k++)
+      for (i = 0; i < M; i++)
+        rhs[i*nb + k] = bdata[k*M + i];
+    sunBatchedDenseGETRS(Adata, M, nb, k0, k1, content->pivots, rhs);
+    for (k = k0; k < k1; k++)
+      for (i = 0; i < M; i++)
+        xdata[k*M + i] = rhs[i*nb + k];
+  }
+
+  LASTFLAG(S) = SUNLS_SUCCESS;
+  return(SUNLS_SUCCESS);
+}
+
+sunindextype SUNLinSolLastFlag_BlockDense(SUNLinearSolver S)
+{
+  /* return the stored 'last_flag' value */
+  if (S == NULL) return(-1);
+  return(LASTFLAG(S));
+}
+
+int SUNLinSolSpace_BlockDense(SUNLinearSolver S,
+                              long int *lenrwLS,
+                              long int *leniwLS)
+{
+  SUNLinearSolverContent_BlockDense content = BLOCKDENSE_CONTENT(S);
+  *leniwLS = 3 + content->nblocks * (content->M + 1);
+  *lenrwLS = content->nblocks * (content->M + 1);
+  return(SUNLS_SUCCESS);
+}
+
+int SUNLinSolFree_BlockDense(SUNLinearSolver S)
+{
+  /* return if S is already free */
+  if (S == NULL) return(SUNLS_SUCCESS);
+
+  /* delete items from contents, then delete generic structure */
+  if (S->content) {
+    if (PIVOTS(S)) {
+      free(PIVOTS(S));
+      PIVOTS(S) = NULL;
+    }
+    if (BLOCKDENSE_CONTENT(S)->failed) {
+      free(BLOCKDENSE_CONTENT(S)->failed);
+      BLOCKDENSE_CONTENT(S)->failed = NULL;
+    }
+    if (BLOCKDENSE_CONTENT(S)->work) {
+      free(BLOCKDENSE_CONTENT(S)->work);
+      BLOCKDENSE_CONTENT(S)->work = NULL;
+    }
+    if (BLOCKDENSE_CONTENT(S)->rhs) {
+      free(BLOCKDENSE_CONTENT(S)->rhs);
+      BLOCKDENSE_CONTENT(S)->rhs = NULL;
+    }
+    free(S->content);
+    S->content = NULL;
+  }
+  if (S->ops) {
+    free(S->ops);
+    S->ops = NULL;
+  }
+  free(S); S = NULL;
+  return(SUNLS_SUCCESS);
+}
+
+/*
+ * -----------------------------------------------------------------
+ * private functions
+ * -----------------------------------------------------------------
+ */
+
+/* Range of blocks [k0, k1) handled by the calling thread */
+
+static void blockRange(sunindextype nblocks, sunindextype *k0, sunindextype *k1)
+{
+#ifdef _OPENMP
+  sunindextype tid = (sunindextype) omp_get_thread_num();
+  sunindextype nth = (sunindextype) omp_get_num_threads();
+#else
+  sunindextype tid = 0;
+  sunindextype nth = 1;
+#endif
+
+  *k0 = (nblocks * tid) / nth;
+  *k1 = (nblocks * (tid + 1)) / nth;
+}
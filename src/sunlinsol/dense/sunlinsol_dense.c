@@ -15,14 +15,21 @@
  * the SUNLINSOL package.
  * -----------------------------------------------------------------*/
 
+#include <float.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #include <sunlinsol/sunlinsol_dense.h>
 #include <sundials/sundials_math.h>
 
+#define ZERO RCONST(0.0)
+#define HALF RCONST(0.5)
 #define ONE  RCONST(1.0)
 
+/* maximum number of iterative refinement steps in mixed precision */
+#define MAX_REFINE 10
+
 /*
  * -----------------------------------------------------------------
  * Dense solver structure accessibility macros:
@@ -33,6 +40,18 @@
 #define PIVOTS(S)         ( DENSE_CONTENT(S)->pivots )
 #define LASTFLAG(S)       ( DENSE_CONTENT(S)->last_flag )
 
+/*
+ * -----------------------------------------------------------------
+ * private functions for the single precision factorization
+ * -----------------------------------------------------------------
+ */
+
+static sunindextype denseGETRF_float(float *a, sunindextype n,
+                                     sunindextype *p);
+static void denseGETRS_float(float *a, sunindextype n, sunindextype *p,
+                             float *b);
+static int fallbackSetup(SUNLinearSolver S, SUNMatrix A);
+
 /*
  * -----------------------------------------------------------------
  * exported functions
@@ -89,6 +108,14 @@ SUNLinearSolver SUNLinSol_Dense(N_Vector y, SUNMatrix A, SUNContext sunctx)
   content->N         = MatrixRows;
   content->last_flag = 0;
   content->pivots    = NULL;
+  content->mixed     = SUNFALSE;
+  content->fallback  = SUNFALSE;
+  content->lu        = NULL;
+  content->fwork     = NULL;
+  content->rwork     = NULL;
+  content->anorm     = ZERO;
+  content->nrefine   = 0;
+  content->nfallback = 0;
 
   /* Allocate content */
   content->pivots = (sunindextype *) malloc(MatrixRows * sizeof(sunindextype));
@@ -97,6 +124,64 @@ SUNLinearSolver SUNLinSol_Dense(N_Vector y, SUNMatrix A, SUNContext sunctx)
   return(S);
 }
 
+/* ----------------------------------------------------------------------------
+ * Function to toggle the mixed precision mode. The matrix is factored in
+ * single precision and double precision accuracy is recovered by iterative
+ * refinement in the solve (the input matrix is not overwritten). If the
+ * single precision factorization fails or the refinement stalls, the solver
+ * falls back to factoring the matrix in full precision until the next setup.
+ */
+
+int SUNLinSol_DenseSetMixedPrecision(SUNLinearSolver S, booleantype onoff)
+{
+  SUNLinearSolverContent_Dense content;
+  sunindextype N;
+
+  if (S == NULL) return(SUNLS_MEM_NULL);
+  content = DENSE_CONTENT(S);
+
+#if defined(SUNDIALS_SINGLE_PRECISION)
+  /* there is no lower precision to factor in */
+  if (onoff) return(SUNLS_ILL_INPUT);
+#endif
+
+  if (onoff && (content->lu == NULL)) {
+    N = content->N;
+    content->lu    = (float *) malloc(N * N * sizeof(float));
+    content->fwork = (float *) malloc(N * sizeof(float));
+    content->rwork = (realtype *) malloc(2 * N * sizeof(realtype));
+    if ( (content->lu == NULL) || (content->fwork == NULL) ||
+         (content->rwork == NULL) ) {
+      free(content->lu);    content->lu    = NULL;
+      free(content->fwork); content->fwork = NULL;
+      free(content->rwork); content->rwork = NULL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  content->mixed = onoff;
+  return(SUNLS_SUCCESS);
+}
+
+/* ----------------------------------------------------------------------------
+ * Functions to get the total number of refinement steps and the number of
+ * fallbacks to a full precision factorization in the mixed precision mode
+ */
+
+int SUNLinSol_DenseGetNumRefineIters(SUNLinearSolver S, long int *nrefine)
+{
+  if ( (S == NULL) || (nrefine == NULL) ) return(SUNLS_MEM_NULL);
+  *nrefine = DENSE_CONTENT(S)->nrefine;
+  return(SUNLS_SUCCESS);
+}
+
+int SUNLinSol_DenseGetNumFallbacks(SUNLinearSolver S, long int *nfallback)
+{
+  if ( (S == NULL) || (nfallback == NULL) ) return(SUNLS_MEM_NULL);
+  *nfallback = DENSE_CONTENT(S)->nfallback;
+  return(SUNLS_SUCCESS);
+}
+
 /*
  * -----------------------------------------------------------------
  * implementation of linear solver operations
@@ -145,6 +230,34 @@ int SUNLinSolSetup_Dense(SUNLinearSolver S, SUNMatrix A)
     return(SUNLS_MEM_FAIL);
   }
 
+  /* mixed precision: factor a single precision copy of A and keep A for
+     computing residuals in the refinement */
+  DENSE_CONTENT(S)->fallback = SUNFALSE;
+  if (DENSE_CONTENT(S)->mixed) {
+    SUNLinearSolverContent_Dense content = DENSE_CONTENT(S);
+    sunindextype i, j, N = content->N;
+    realtype colsum;
+
+    /* 1-norm of A for the refinement stopping test */
+    content->anorm = ZERO;
+    for (j=0; j<N; j++) {
+      colsum = ZERO;
+      for (i=0; i<N; i++) {
+        colsum += SUNRabs(A_cols[j][i]);
+        content->lu[j*N+i] = (float) A_cols[j][i];
+      }
+      content->anorm = SUNMAX(content->anorm, colsum);
+    }
+
+    /* fall back if A is out of range or singular in single precision */
+    if ( (content->anorm < (realtype) FLT_MAX) &&
+         (denseGETRF_float(content->lu, N, pivots) == 0) ) {
+      LASTFLAG(S) = SUNLS_SUCCESS;
+      return(SUNLS_SUCCESS);
+    }
+    return(fallbackSetup(S, A));
+  }
+
   /* perform LU factorization of input matrix */
   LASTFLAG(S) = SUNDlsMat_denseGETRF(A_cols, SUNDenseMatrix_Rows(A),
                                      SUNDenseMatrix_Columns(A), pivots);
@@ -179,6 +292,63 @@ int SUNLinSolSolve_Dense(SUNLinearSolver S, SUNMatrix A, N_Vector x,
     return(SUNLS_MEM_FAIL);
   }
 
+  /* mixed precision: solve with the single precision factors and refine
+     until the residual is at the level of the full precision roundoff */
+  if (DENSE_CONTENT(S)->mixed && !DENSE_CONTENT(S)->fallback) {
+    SUNLinearSolverContent_Dense content = DENSE_CONTENT(S);
+    sunindextype i, j, N = content->N;
+    realtype *bcopy = content->rwork, *r = content->rwork + N;
+    realtype rnorm, rnorm_old, xnorm, rtol;
+    float *w = content->fwork;
+    int iter;
+
+    /* x holds b, keep a copy since x and b may be the same vector */
+    for (i=0; i<N; i++) {
+      bcopy[i] = xdata[i];
+      w[i] = (float) xdata[i];
+    }
+    denseGETRS_float(content->lu, N, pivots, w);
+    for (i=0; i<N; i++) xdata[i] = (realtype) w[i];
+
+    rtol      = SUNRsqrt((realtype) N) * UNIT_ROUNDOFF * content->anorm;
+    rnorm_old = ZERO;
+    for (iter=0; iter<=MAX_REFINE; iter++) {
+
+      /* r = b - A x in full precision */
+      for (i=0; i<N; i++) r[i] = bcopy[i];
+      for (j=0; j<N; j++)
+        for (i=0; i<N; i++)
+          r[i] -= A_cols[j][i] * xdata[j];
+
+      rnorm = ZERO;
+      xnorm = ZERO;
+      for (i=0; i<N; i++) {
+        rnorm = SUNMAX(rnorm, SUNRabs(r[i]));
+        xnorm = SUNMAX(xnorm, SUNRabs(xdata[i]));
+      }
+
+      if (rnorm <= rtol * xnorm) {
+        LASTFLAG(S) = SUNLS_SUCCESS;
+        return(SUNLS_SUCCESS);
+      }
+
+      /* stop refining if the residual is not reduced by at least half */
+      if ( (iter > 0) && (rnorm > HALF * rnorm_old) ) break;
+      rnorm_old = rnorm;
+
+      /* x = x + (LU)^{-1} r */
+      for (i=0; i<N; i++) w[i] = (float) r[i];
+      denseGETRS_float(content->lu, N, pivots, w);
+      for (i=0; i<N; i++) xdata[i] += (realtype) w[i];
+      content->nrefine++;
+    }
+
+    /* refinement stalled, factor and solve in full precision */
+    if (fallbackSetup(S, A) != SUNLS_SUCCESS)
+      return(SUNLS_LUFACT_FAIL);
+    for (i=0; i<N; i++) xdata[i] = bcopy[i];
+  }
+
   /* solve using LU factors */
   SUNDlsMat_denseGETRS(A_cols, SUNDenseMatrix_Rows(A), pivots, xdata);
   LASTFLAG(S) = SUNLS_SUCCESS;
@@ -198,6 +368,10 @@ int SUNLinSolSpace_Dense(SUNLinearSolver S,
 {
   *leniwLS = 2 + DENSE_CONTENT(S)->N;
   *lenrwLS = 0;
+  if (DENSE_CONTENT(S)->lu) {
+    /* single precision storage counted as half a realtype */
+    *lenrwLS = DENSE_CONTENT(S)->N * (DENSE_CONTENT(S)->N + 5) / 2;
+  }
   return(SUNLS_SUCCESS);
 }
 
@@ -212,6 +386,9 @@ int SUNLinSolFree_Dense(SUNLinearSolver S)
       free(PIVOTS(S));
       PIVOTS(S) = NULL;
     }
+    free(DENSE_CONTENT(S)->lu);
+    free(DENSE_CONTENT(S)->fwork);
+    free(DENSE_CONTENT(S)->rwork);
     free(S->content);
     S->content = NULL;
   }
@@ -222,3 +399,111 @@ int SUNLinSolFree_Dense(SUNLinearSolver S)
   free(S); S = NULL;
   return(SUNLS_SUCCESS);
 }
+
+/*
+ * -----------------------------------------------------------------
+ * private functions
+ * -----------------------------------------------------------------
+ */
+
+/* ----------------------------------------------------------------------------
+ * Factors A in place in full precision after the mixed precision
+ * factorization or refinement failed. The full precision factors are used by
+ * all solves until the next setup.
+ */
+
+static int fallbackSetup(SUNLinearSolver S, SUNMatrix A)
+{
+  DENSE_CONTENT(S)->fallback = SUNTRUE;
+  DENSE_CONTENT(S)->nfallback++;
+
+  LASTFLAG(S) = SUNDlsMat_denseGETRF(SUNDenseMatrix_Cols(A),
+                                     SUNDenseMatrix_Rows(A),
+                                     SUNDenseMatrix_Columns(A), PIVOTS(S));
+  if (LASTFLAG(S) > 0)
+    return(SUNLS_LUFACT_FAIL);
+  return(SUNLS_SUCCESS);
+}
+
+/* ----------------------------------------------------------------------------
+ * Single precision versions of SUNDlsMat_denseGETRF and SUNDlsMat_denseGETRS
+ * for an n by n matrix stored column-wise in the array a
+ */
+
+static sunindextype denseGETRF_float(float *a, sunindextype n,
+                                     sunindextype *p)
+{
+  sunindextype i, j, k, l;
+  float *col_j, *col_k;
+  float temp, mult, a_kj;
+
+  for (k=0; k<n; k++) {
+
+    col_k = a + k*n;
+
+    /* find l = pivot row number */
+    l = k;
+    for (i=k+1; i<n; i++)
+      if (fabsf(col_k[i]) > fabsf(col_k[l])) l=i;
+    p[k] = l;
+
+    /* check for zero pivot element */
+    if (col_k[l] == 0.0f) return(k+1);
+
+    /* swap a(k,1:n) and a(l,1:n) if necessary */
+    if ( l!= k ) {
+      for (i=0; i<n; i++) {
+        temp = a[i*n+l];
+        a[i*n+l] = a[i*n+k];
+        a[i*n+k] = temp;
+      }
+    }
+
+    /* scale the elements below the diagonal in column k by 1.0/a(k,k) */
+    mult = 1.0f/col_k[k];
+    for(i=k+1; i<n; i++) col_k[i] *= mult;
+
+    /* row_i = row_i - [a(i,k)/a(k,k)] row_k, i=k+1, ..., n-1 */
+    for (j=k+1; j<n; j++) {
+      col_j = a + j*n;
+      a_kj = col_j[k];
+      if (a_kj != 0.0f) {
+        for (i=k+1; i<n; i++)
+          col_j[i] -= a_kj * col_k[i];
+      }
+    }
+  }
+
+  return(0);
+}
+
+static void denseGETRS_float(float *a, sunindextype n, sunindextype *p,
+                             float *b)
+{
+  sunindextype i, k, pk;
+  float *col_k, tmp;
+
+  /* permute b, based on pivot information in p */
+  for (k=0; k<n; k++) {
+    pk = p[k];
+    if(pk != k) {
+      tmp = b[k];
+      b[k] = b[pk];
+      b[pk] = tmp;
+    }
+  }
+
+  /* solve Ly = b, store solution y in b */
+  for (k=0; k<n-1; k++) {
+    col_k = a + k*n;
+    for (i=k+1; i<n; i++) b[i] -= col_k[i]*b[k];
+  }
+
+  /* solve Ux = y, store solution x in b */
+  for (k = n-1; k > 0; k--) {
+    col_k = a + k*n;
+    b[k] /= col_k[k];
+    for (i=0; i<k; i++) b[i] -= col_k[i]*b[k];
+  }
+  b[0] /= a[0];
+}
@@ -0,0 +1,1694 @@
+/* -----------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------
+ * This is the implementation file for the GCRODR implementation of
+ * the SUNLINSOL package.
+ *
+ * GCRODR (GCRO with deflated restarting, Parks et al. 2006) keeps a
+ * recycle space U of dimension k together with C = A-tilde U, where
+ * A-tilde is the scaled preconditioned operator and C has
+ * orthonormal columns. Each cycle first removes the component of the
+ * residual in span(C) and then runs maxl - k Arnoldi steps with the
+ * new basis vectors orthogonalized against both C and the Krylov
+ * vectors, so that with Z = [U, V_0, ..., V_{m-1}] and
+ * W = [C, V_0, ..., V_m]
+ *
+ *   A-tilde Z = W G,   G = [ I  B ]
+ *                          [ 0  H ]
+ *
+ * where H is the usual (m+1) x m Hessenberg matrix. Since W has
+ * orthonormal columns the residual is minimized with the GMRES least
+ * squares problem for H alone.
+ *
+ * At the end of every cycle the recycle space is replaced by the k
+ * harmonic Ritz vectors Z p of smallest magnitude, the solutions of
+ * the generalized eigenvalue problem
+ *
+ *   G^T G p = theta G^T W^T Z p.
+ *
+ * The space is kept between calls to the solver. Since the operator
+ * may change between calls (e.g., with a new step size or Jacobian)
+ * C is recomputed from U at the start of each solve, at the cost of
+ * k operator applications, and reorthonormalized with two passes of
+ * Cholesky QR.
+ * -----------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <sunlinsol/sunlinsol_gcrodr.h>
+#include <sundials/sundials_dense.h>
+#include <sundials/sundials_math.h>
+
+#include "sundials_context_impl.h"
+#include "sundials_logger_impl.h"
+#include "sundials_iterative_impl.h"
+
+#define ZERO    RCONST(0.0)
+#define ONE     RCONST(1.0)
+#define TWO     RCONST(2.0)
+
+/*
+ * -----------------------------------------------------------------
+ * GCRODR solver structure accessibility macros:
+ * -----------------------------------------------------------------
+ */
+
+#define GCRODR_CONTENT(S)  ( (SUNLinearSolverContent_GCRODR)(S->content) )
+#define LASTFLAG(S)        ( GCRODR_CONTENT(S)->last_flag )
+
+/*
+ * -----------------------------------------------------------------
+ * private functions
+ * -----------------------------------------------------------------
+ */
+
+static int gcrodrATilde(SUNLinearSolver S, N_Vector x, N_Vector y,
+                        realtype delta);
+static int gcrodrRefresh(SUNLinearSolver S, realtype delta);
+static int gcrodrCholQR(SUNLinearSolver S, int *nc);
+static int gcrodrProject(SUNLinearSolver S, N_Vector r);
+static int gcrodrUpdateRecycle(SUNLinearSolver S, int nc, int m);
+static int gcrodrSelect(SUNLinearSolver S, int n, int kmax);
+static int gcrodrInvIter(int n, realtype **X, realtype re, realtype im,
+                         realtype **E, sunindextype *pivots, realtype *rhs);
+static void gcrodrHessReduce(int n, realtype *a, realtype *v);
+static int gcrodrAllocRecycle(SUNLinearSolver S);
+static void gcrodrFreeRecycle(SUNLinearSolver S);
+static int gcrodrFinalize(SUNLinearSolver S, N_Vector x, realtype delta);
+
+/*
+ * -----------------------------------------------------------------
+ * exported functions
+ * -----------------------------------------------------------------
+ */
+
+/* ----------------------------------------------------------------------------
+ * Function to create a new GCRODR linear solver
+ */
+
+SUNLinearSolver SUNLinSol_GCRODR(N_Vector y, int pretype, int maxl, SUNContext sunctx)
+{
+  SUNLinearSolver S;
+  SUNLinearSolverContent_GCRODR content;
+
+  /* check for legal pretype and maxl values; if illegal use defaults */
+  if ((pretype != SUN_PREC_NONE)  && (pretype != SUN_PREC_LEFT) &&
+      (pretype != SUN_PREC_RIGHT) && (pretype != SUN_PREC_BOTH))
+    pretype = SUN_PREC_NONE;
+  if (maxl <= 0)
+    maxl = SUNGCRODR_MAXL_DEFAULT;
+
+  /* check that the supplied N_Vector supports all requisite operations */
+  if ( (y->ops->nvclone == NULL) || (y->ops->nvdestroy == NULL) ||
+       (y->ops->nvlinearsum == NULL) || (y->ops->nvconst == NULL) ||
+       (y->ops->nvprod == NULL) || (y->ops->nvdiv == NULL) ||
+       (y->ops->nvscale == NULL) || (y->ops->nvdotprod == NULL) )
+    return(NULL);
+
+  /* Create linear solver */
+  S = NULL;
+  S = SUNLinSolNewEmpty(sunctx);
+  if (S == NULL) return(NULL);
+
+  /* Attach operations */
+  S->ops->gettype           = SUNLinSolGetType_GCRODR;
+  S->ops->getid             = SUNLinSolGetID_GCRODR;
+  S->ops->setatimes         = SUNLinSolSetATimes_GCRODR;
+  S->ops->setpreconditioner = SUNLinSolSetPreconditioner_GCRODR;
+  S->ops->setscalingvectors = SUNLinSolSetScalingVectors_GCRODR;
+  S->ops->setzeroguess      = SUNLinSolSetZeroGuess_GCRODR;
+  S->ops->initialize        = SUNLinSolInitialize_GCRODR;
+  S->ops->setup             = SUNLinSolSetup_GCRODR;
+  S->ops->solve             = SUNLinSolSolve_GCRODR;
+  S->ops->numiters          = SUNLinSolNumIters_GCRODR;
+  S->ops->resnorm           = SUNLinSolResNorm_GCRODR;
+  S->ops->resid             = SUNLinSolResid_GCRODR;
+  S->ops->lastflag          = SUNLinSolLastFlag_GCRODR;
+  S->ops->space             = SUNLinSolSpace_GCRODR;
+  S->ops->free              = SUNLinSolFree_GCRODR;
+
+  /* Create content */
+  content = NULL;
+  content = (SUNLinearSolverContent_GCRODR) malloc(sizeof *content);
+  if (content == NULL) { SUNLinSolFree(S); return(NULL); }
+
+  /* Attach content */
+  S->content = content;
+
+  /* Fill content */
+  content->last_flag    = 0;
+  content->maxl         = maxl;
+  content->pretype      = pretype;
+  content->kdim         = SUNMIN(SUNGCRODR_KDIM_DEFAULT, maxl-1);
+  content->max_restarts = SUNGCRODR_MAXRS_DEFAULT;
+  content->zeroguess    = SUNFALSE;
+  content->numiters     = 0;
+  content->resnorm      = ZERO;
+  content->xcor         = NULL;
+  content->vtemp        = NULL;
+  content->s1           = NULL;
+  content->s2           = NULL;
+  content->ATimes       = NULL;
+  content->ATData       = NULL;
+  content->Psetup       = NULL;
+  content->Psolve       = NULL;
+  content->PData        = NULL;
+  content->V            = NULL;
+  content->Hes          = NULL;
+  content->QR           = NULL;
+  content->givens       = NULL;
+  content->yg           = NULL;
+  content->cv           = NULL;
+  content->Xv           = NULL;
+  content->W            = NULL;
+  content->nrecycle     = 0;
+  content->U            = NULL;
+  content->C            = NULL;
+  content->Unew         = NULL;
+  content->Cnew         = NULL;
+  content->WZ           = NULL;
+  content->A1           = NULL;
+  content->X            = NULL;
+  content->E            = NULL;
+  content->P            = NULL;
+  content->Q            = NULL;
+  content->R            = NULL;
+  content->pivots       = NULL;
+  content->work         = NULL;
+  content->nupdates     = 0;
+  content->nratimes     = 0;
+
+  /* use a single reduction for blocks of inner products when possible */
+  content->sb = (y->ops->nvdotprodmultilocal != NULL) &&
+                (y->ops->nvdotprodmultiallreduce != NULL);
+
+  /* Allocate content */
+  content->xcor = N_VClone(y);
+  if (content->xcor == NULL) { SUNLinSolFree(S); return(NULL); }
+
+  content->vtemp = N_VClone(y);
+  if (content->vtemp == NULL) { SUNLinSolFree(S); return(NULL); }
+
+  return(S);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Function to set the type of preconditioning for GCRODR to use
+ */
+
+int SUNLinSol_GCRODRSetPrecType(SUNLinearSolver S, int pretype)
+{
+  /* Check for legal pretype */
+  if ((pretype != SUN_PREC_NONE)  && (pretype != SUN_PREC_LEFT) &&
+      (pretype != SUN_PREC_RIGHT) && (pretype != SUN_PREC_BOTH)) {
+    return(SUNLS_ILL_INPUT);
+  }
+
+  /* Check for non-NULL SUNLinearSolver */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+
+  /* Set pretype */
+  GCRODR_CONTENT(S)->pretype = pretype;
+  return(SUNLS_SUCCESS);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Function to set the dimension of the recycle space
+ */
+
+int SUNLinSol_GCRODRSetRecycleDim(SUNLinearSolver S, int kdim)
+{
+  int ier;
+
+  /* Check for non-NULL SUNLinearSolver */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+
+  /* Illegal kdim implies use of default value, at least one Arnoldi step
+     is required in each cycle */
+  if (kdim <= 0)
+    kdim = SUNMIN(SUNGCRODR_KDIM_DEFAULT, GCRODR_CONTENT(S)->maxl-1);
+  if (kdim > GCRODR_CONTENT(S)->maxl-1) return(SUNLS_ILL_INPUT);
+
+  if (kdim == GCRODR_CONTENT(S)->kdim) return(SUNLS_SUCCESS);
+
+  /* Discard the current space and reallocate if already initialized */
+  if (GCRODR_CONTENT(S)->V != NULL) {
+    gcrodrFreeRecycle(S);
+    GCRODR_CONTENT(S)->kdim = kdim;
+    ier = gcrodrAllocRecycle(S);
+    if (ier != SUNLS_SUCCESS) return(ier);
+  }
+
+  GCRODR_CONTENT(S)->kdim     = kdim;
+  GCRODR_CONTENT(S)->nrecycle = 0;
+  return(SUNLS_SUCCESS);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Function to set the maximum number of GMRES restarts to allow
+ */
+
+int SUNLinSol_GCRODRSetMaxRestarts(SUNLinearSolver S, int maxrs)
+{
+  /* Illegal maxrs implies use of default value */
+  if (maxrs < 0)
+    maxrs = SUNGCRODR_MAXRS_DEFAULT;
+
+  /* Check for non-NULL SUNLinearSolver */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+
+  /* Set max_restarts */
+  GCRODR_CONTENT(S)->max_restarts = maxrs;
+  return(SUNLS_SUCCESS);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Function to discard the current recycle space
+ */
+
+int SUNLinSol_GCRODRResetRecycle(SUNLinearSolver S)
+{
+  /* Check for non-NULL SUNLinearSolver */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+
+  GCRODR_CONTENT(S)->nrecycle = 0;
+  return(SUNLS_SUCCESS);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Functions to get the current recycle space dimension and statistics
+ */
+
+int SUNLinSol_GCRODRGetRecycleDim(SUNLinearSolver S, int *nrecycle)
+{
+  /* Check for non-NULL SUNLinearSolver */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+
+  *nrecycle = GCRODR_CONTENT(S)->nrecycle;
+  return(SUNLS_SUCCESS);
+}
+
+
+int SUNLinSol_GCRODRGetNumRecycleUpdates(SUNLinearSolver S, long int *nupdates)
+{
+  /* Check for non-NULL SUNLinearSolver */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+
+  *nupdates = GCRODR_CONTENT(S)->nupdates;
+  return(SUNLS_SUCCESS);
+}
+
+
+int SUNLinSol_GCRODRGetNumRecycleATimes(SUNLinearSolver S, long int *nratimes)
+{
+  /* Check for non-NULL SUNLinearSolver */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+
+  *nratimes = GCRODR_CONTENT(S)->nratimes;
+  return(SUNLS_SUCCESS);
+}
+
+
+/*
+ * -----------------------------------------------------------------
+ * implementation of linear solver operations
+ * -----------------------------------------------------------------
+ */
+
+SUNLinearSolver_Type SUNLinSolGetType_GCRODR(SUNLinearSolver S)
+{
+  return(SUNLINEARSOLVER_ITERATIVE);
+}
+
+
+SUNLinearSolver_ID SUNLinSolGetID_GCRODR(SUNLinearSolver S)
+{
+  return(SUNLINEARSOLVER_GCRODR);
+}
+
+
+int SUNLinSolInitialize_GCRODR(SUNLinearSolver S)
+{
+  int k, maxl;
+  SUNLinearSolverContent_GCRODR content;
+
+  /* set shortcut to GCRODR memory structure */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+  content = GCRODR_CONTENT(S);
+  maxl    = content->maxl;
+
+  /* ensure valid options */
+  if (content->max_restarts < 0)
+    content->max_restarts = SUNGCRODR_MAXRS_DEFAULT;
+
+  if (content->ATimes == NULL) {
+    LASTFLAG(S) = SUNLS_ATIMES_NULL;
+    return(LASTFLAG(S));
+  }
+
+  if ( (content->pretype != SUN_PREC_LEFT) &&
+       (content->pretype != SUN_PREC_RIGHT) &&
+       (content->pretype != SUN_PREC_BOTH) )
+    content->pretype = SUN_PREC_NONE;
+
+  if ((content->pretype != SUN_PREC_NONE) && (content->Psolve == NULL)) {
+    LASTFLAG(S) = SUNLS_PSOLVE_NULL;
+    return(LASTFLAG(S));
+  }
+
+  /* allocate solver-specific memory (where the size depends on the
+     choice of maxl) here */
+
+  /*   Krylov subspace vectors */
+  if (content->V == NULL) {
+    content->V = N_VCloneVectorArray(maxl+1, content->vtemp);
+    if (content->V == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  /*   Hessenberg matrix Hes, including the projections onto the recycle
+       space, and the QR factorization of its Krylov block */
+  if (content->Hes == NULL) {
+    content->Hes = (realtype **) calloc(maxl+1, sizeof(realtype *));
+    if (content->Hes == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+
+    for (k=0; k<=maxl; k++) {
+      content->Hes[k] = (realtype *) malloc(maxl*sizeof(realtype));
+      if (content->Hes[k] == NULL) {
+        content->last_flag = SUNLS_MEM_FAIL;
+        return(SUNLS_MEM_FAIL);
+      }
+    }
+  }
+
+  if (content->QR == NULL) {
+    content->QR = (realtype **) calloc(maxl+1, sizeof(realtype *));
+    if (content->QR == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+
+    for (k=0; k<=maxl; k++) {
+      content->QR[k] = (realtype *) malloc(maxl*sizeof(realtype));
+      if (content->QR[k] == NULL) {
+        content->last_flag = SUNLS_MEM_FAIL;
+        return(SUNLS_MEM_FAIL);
+      }
+    }
+  }
+
+  /*   Givens rotation components */
+  if (content->givens == NULL) {
+    content->givens = (realtype *) malloc(2*maxl*sizeof(realtype));
+    if (content->givens == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  /*    y and g vectors */
+  if (content->yg == NULL) {
+    content->yg = (realtype *) malloc((maxl+1)*sizeof(realtype));
+    if (content->yg == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  /*    cv vector for fused vector ops */
+  if (content->cv == NULL) {
+    content->cv = (realtype *) malloc((maxl+1)*sizeof(realtype));
+    if (content->cv == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  /*    Xv vector for fused vector ops */
+  if (content->Xv == NULL) {
+    content->Xv = (N_Vector *) malloc((maxl+1)*sizeof(N_Vector));
+    if (content->Xv == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  /*    combined basis [C, V] for Gram-Schmidt */
+  if (content->W == NULL) {
+    content->W = (N_Vector *) malloc((maxl+1)*sizeof(N_Vector));
+    if (content->W == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  /*    recycle space vectors */
+  if (content->U == NULL) {
+    if (gcrodrAllocRecycle(S) != SUNLS_SUCCESS) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  /*    dense matrices for the recycle space update */
+  if (content->WZ == NULL) {
+    content->WZ = SUNDlsMat_newDenseMat(maxl+1, maxl);
+    if (content->WZ == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  if (content->A1 == NULL) {
+    content->A1 = SUNDlsMat_newDenseMat(maxl, maxl);
+    if (content->A1 == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  if (content->X == NULL) {
+    content->X = SUNDlsMat_newDenseMat(maxl, maxl);
+    if (content->X == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  if (content->E == NULL) {
+    content->E = SUNDlsMat_newDenseMat(2*maxl, 2*maxl);
+    if (content->E == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  if (content->P == NULL) {
+    content->P = SUNDlsMat_newDenseMat(maxl, maxl);
+    if (content->P == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  if (content->Q == NULL) {
+    content->Q = SUNDlsMat_newDenseMat(maxl+1, maxl);
+    if (content->Q == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  if (content->R == NULL) {
+    content->R = SUNDlsMat_newDenseMat(maxl, maxl);
+    if (content->R == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  if (content->pivots == NULL) {
+    content->pivots = SUNDlsMat_newIndexArray(2*maxl);
+    if (content->pivots == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  if (content->work == NULL) {
+    content->work = (realtype *) malloc(maxl*(maxl+6)*sizeof(realtype));
+    if (content->work == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  /* discard the recycle space from a previous problem */
+  content->nrecycle = 0;
+
+  /* return with success */
+  content->last_flag = SUNLS_SUCCESS;
+  return(SUNLS_SUCCESS);
+}
+
+
+int SUNLinSolSetATimes_GCRODR(SUNLinearSolver S, void* ATData,
+                              SUNATimesFn ATimes)
+{
+  /* set function pointers to integrator-supplied ATimes routine
+     and data, and return with success */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+  GCRODR_CONTENT(S)->ATimes = ATimes;
+  GCRODR_CONTENT(S)->ATData = ATData;
+  LASTFLAG(S) = SUNLS_SUCCESS;
+  return(LASTFLAG(S));
+}
+
+
+int SUNLinSolSetPreconditioner_GCRODR(SUNLinearSolver S, void* PData,
+                                      SUNPSetupFn Psetup, SUNPSolveFn Psolve)
+{
+  /* set function pointers to integrator-supplied Psetup and PSolve
+     routines and data, and return with success */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+  GCRODR_CONTENT(S)->Psetup = Psetup;
+  GCRODR_CONTENT(S)->Psolve = Psolve;
+  GCRODR_CONTENT(S)->PData = PData;
+  LASTFLAG(S) = SUNLS_SUCCESS;
+  return(LASTFLAG(S));
+}
+
+
+int SUNLinSolSetScalingVectors_GCRODR(SUNLinearSolver S, N_Vector s1,
+                                      N_Vector s2)
+{
+  /* set N_Vector pointers to integrator-supplied scaling vectors,
+     and return with success */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+  GCRODR_CONTENT(S)->s1 = s1;
+  GCRODR_CONTENT(S)->s2 = s2;
+  LASTFLAG(S) = SUNLS_SUCCESS;
+  return(LASTFLAG(S));
+}
+
+
+int SUNLinSolSetZeroGuess_GCRODR(SUNLinearSolver S, booleantype onff)
+{
+  /* set flag indicating a zero initial guess */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+  GCRODR_CONTENT(S)->zeroguess = onff;
+  LASTFLAG(S) = SUNLS_SUCCESS;
+  return(LASTFLAG(S));
+}
+
+
+int SUNLinSolSetup_GCRODR(SUNLinearSolver S, SUNMatrix A)
+{
+  int ier;
+  SUNPSetupFn Psetup;
+  void* PData;
+
+  /* Set shortcuts to GCRODR memory structures */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+  Psetup = GCRODR_CONTENT(S)->Psetup;
+  PData = GCRODR_CONTENT(S)->PData;
+
+  /* no solver-specific setup is required, but if user-supplied
+     Psetup routine exists, call that here */
+  if (Psetup != NULL) {
+    ier = Psetup(PData);
+    if (ier != 0) {
+      LASTFLAG(S) = (ier < 0) ?
+        SUNLS_PSET_FAIL_UNREC : SUNLS_PSET_FAIL_REC;
+      return(LASTFLAG(S));
+    }
+  }
+
+  /* return with success */
+  return(SUNLS_SUCCESS);
+}
+
+
+int SUNLinSolSolve_GCRODR(SUNLinearSolver S, SUNMatrix A, N_Vector x,
+                          N_Vector b, realtype delta)
+{
+  /* local data and shortcut variables */
+  N_Vector *V, *W, xcor, vtemp, s1;
+  realtype **Hes, **QR, *givens, *yg, *res_norm;
+  realtype beta, rotation_product, r_norm, s_product, rho, h;
+  booleantype preOnLeft, preOnRight, scale1, converged;
+  booleantype *zeroguess;
+  int i, j, k, l, l_max, m, nc, krydim, ier, ntries;
+  int max_restarts;
+  int *nli;
+  void *A_data, *P_data;
+  SUNATimesFn atimes;
+  SUNPSolveFn psolve;
+
+  /* local shortcuts for fused vector operations */
+  realtype* cv;
+  N_Vector* Xv;
+
+  /* Initialize some variables */
+  krydim = 0;
+
+  /* Make local shorcuts to solver variables. */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+  l_max        = GCRODR_CONTENT(S)->maxl;
+  max_restarts = GCRODR_CONTENT(S)->max_restarts;
+  V            = GCRODR_CONTENT(S)->V;
+  W            = GCRODR_CONTENT(S)->W;
+  Hes          = GCRODR_CONTENT(S)->Hes;
+  QR           = GCRODR_CONTENT(S)->QR;
+  givens       = GCRODR_CONTENT(S)->givens;
+  xcor         = GCRODR_CONTENT(S)->xcor;
+  yg           = GCRODR_CONTENT(S)->yg;
+  vtemp        = GCRODR_CONTENT(S)->vtemp;
+  s1           = GCRODR_CONTENT(S)->s1;
+  A_data       = GCRODR_CONTENT(S)->ATData;
+  P_data       = GCRODR_CONTENT(S)->PData;
+  atimes       = GCRODR_CONTENT(S)->ATimes;
+  psolve       = GCRODR_CONTENT(S)->Psolve;
+  zeroguess    = &(GCRODR_CONTENT(S)->zeroguess);
+  nli          = &(GCRODR_CONTENT(S)->numiters);
+  res_norm     = &(GCRODR_CONTENT(S)->resnorm);
+  cv           = GCRODR_CONTENT(S)->cv;
+  Xv           = GCRODR_CONTENT(S)->Xv;
+
+  /* Initialize counters and convergence flag */
+  *nli = 0;
+  converged = SUNFALSE;
+
+  /* Set booleantype flags for internal solver options */
+  preOnLeft  = ( (GCRODR_CONTENT(S)->pretype == SUN_PREC_LEFT) ||
+                 (GCRODR_CONTENT(S)->pretype == SUN_PREC_BOTH) );
+  preOnRight = ( (GCRODR_CONTENT(S)->pretype == SUN_PREC_RIGHT) ||
+                 (GCRODR_CONTENT(S)->pretype == SUN_PREC_BOTH) );
+  scale1 = (s1 != NULL);
+
+  /* Check if Atimes function has been set */
+  if (atimes == NULL) {
+    *zeroguess  = SUNFALSE;
+    LASTFLAG(S) = SUNLS_ATIMES_NULL;
+    return(LASTFLAG(S));
+  }
+
+  /* If preconditioning, check if psolve has been set */
+  if ((preOnLeft || preOnRight) && psolve == NULL) {
+    *zeroguess  = SUNFALSE;
+    LASTFLAG(S) = SUNLS_PSOLVE_NULL;
+    return(LASTFLAG(S));
+  }
+
+  /* Set vtemp and V[0] to initial (unscaled) residual r_0 = b - A*x_0 */
+  if (*zeroguess) {
+    N_VScale(ONE, b, vtemp);
+  } else {
+    ier = atimes(A_data, x, vtemp);
+    if (ier != 0) {
+      *zeroguess  = SUNFALSE;
+      LASTFLAG(S) = (ier < 0) ?
+        SUNLS_ATIMES_FAIL_UNREC : SUNLS_ATIMES_FAIL_REC;
+      return(LASTFLAG(S));
+    }
+    N_VLinearSum(ONE, b, -ONE, vtemp, vtemp);
+  }
+  N_VScale(ONE, vtemp, V[0]);
+
+  /* Apply left preconditioner and left scaling to V[0] = r_0 */
+  if (preOnLeft) {
+    ier = psolve(P_data, V[0], vtemp, delta, SUN_PREC_LEFT);
+    if (ier != 0) {
+      *zeroguess  = SUNFALSE;
+      LASTFLAG(S) = (ier < 0) ?
+        SUNLS_PSOLVE_FAIL_UNREC : SUNLS_PSOLVE_FAIL_REC;
+      return(LASTFLAG(S));
+    }
+  } else {
+    N_VScale(ONE, V[0], vtemp);
+  }
+
+  if (scale1) {
+    N_VProd(s1, vtemp, V[0]);
+  } else {
+    N_VScale(ONE, vtemp, V[0]);
+  }
+
+  /* Set r_norm = beta to L2 norm of V[0] = s1 P1_inv r_0, and
+     return if small  */
+  *res_norm = r_norm = beta = SUNRsqrt(N_VDotProd(V[0], V[0]));
+
+#if SUNDIALS_LOGGING_LEVEL >= SUNDIALS_LOGGING_INFO
+  /* print initial residual */
+  SUNLogger_QueueMsg(S->sunctx->logger, SUN_LOGLEVEL_INFO,
+    "SUNLinSolSolve_GCRODR", "initial-residual",
+    "nli = %li, resnorm = %.16g", (long int) 0, *res_norm);
+#endif
+
+  if (r_norm <= delta) {
+    *zeroguess  = SUNFALSE;
+    LASTFLAG(S) = SUNLS_SUCCESS;
+    return(LASTFLAG(S));
+  }
+
+  /* Set xcor = 0 */
+  N_VConst(ZERO, xcor);
+
+  /* Rebuild C = A-tilde U for the current operator and remove the
+     component of the residual in span(C), xcor = U C^T r, r = r - C C^T r */
+  if (GCRODR_CONTENT(S)->nrecycle > 0) {
+    ier = gcrodrRefresh(S, delta);
+    if (ier == SUNLS_SUCCESS) ier = gcrodrProject(S, V[0]);
+    if (ier != SUNLS_SUCCESS) {
+      *zeroguess  = SUNFALSE;
+      LASTFLAG(S) = ier;
+      return(LASTFLAG(S));
+    }
+
+    *res_norm = r_norm = SUNRsqrt(N_VDotProd(V[0], V[0]));
+
+    if (r_norm <= delta) {
+      ier = gcrodrFinalize(S, x, delta);
+      *zeroguess  = SUNFALSE;
+      LASTFLAG(S) = (ier == SUNLS_SUCCESS) ? SUNLS_SUCCESS : ier;
+      return(LASTFLAG(S));
+    }
+  }
+
+  /* Initialize rho to avoid compiler warning message */
+  rho = r_norm;
+
+  /* Begin outer iterations: up to (max_restarts + 1) attempts */
+  for (ntries=0; ntries<=max_restarts; ntries++) {
+
+    /* The number of Arnoldi steps in this cycle is limited so that the
+       recycle space and the Krylov basis fit in maxl + 1 vectors */
+    nc = GCRODR_CONTENT(S)->nrecycle;
+    m  = l_max - nc;
+
+    for (i=0; i<nc; i++) W[i] = GCRODR_CONTENT(S)->C[i];
+    for (i=0; i<=m; i++) W[nc+i] = V[i];
+
+    /* Initialize the Hessenberg matrix Hes (G above), its QR factorization,
+       and the Givens rotation product.  Normalize the initial vector V[0] */
+    for (i=0; i<=l_max; i++)
+      for (j=0; j<l_max; j++) {
+        Hes[i][j] = (i == j && j < nc) ? ONE : ZERO;
+        QR[i][j]  = ZERO;
+      }
+
+    rotation_product = ONE;
+    N_VScale(ONE/r_norm, V[0], V[0]);
+
+    /* Inner loop: generate Krylov sequence and Arnoldi basis */
+    for (l=0; l<m; l++) {
+
+      (*nli)++;
+
+      krydim = l + 1;
+
+      /* Generate A-tilde V[l], where A-tilde = s1 P1_inv A P2_inv s2_inv */
+      ier = gcrodrATilde(S, V[l], V[l+1], delta);
+      if (ier != SUNLS_SUCCESS) {
+        *zeroguess  = SUNFALSE;
+        LASTFLAG(S) = ier;
+        return(LASTFLAG(S));
+      }
+
+      /* Orthogonalize V[l+1] against C and V[0], ..., V[l], the
+         projections onto C form the block B of G */
+      if (SUNClassicalGS(W, Hes, nc+l+1, l_max, &(Hes[nc+l+1][nc+l]),
+                         cv, Xv) != 0) {
+        *zeroguess  = SUNFALSE;
+        LASTFLAG(S) = SUNLS_GS_FAIL;
+        return(LASTFLAG(S));
+      }
+
+      /* Update the QR factorization of the Krylov block of Hes */
+      for (i=0; i<=krydim; i++) QR[i][l] = Hes[nc+i][nc+l];
+
+      if (SUNQRfact(krydim, QR, givens, l) != 0 ) {
+        *zeroguess  = SUNFALSE;
+        LASTFLAG(S) = SUNLS_QRFACT_FAIL;
+        return(LASTFLAG(S));
+      }
+
+      /* Normalize V[l+1] with norm value from the Gram-Schmidt routine,
+         the complete basis is needed for the recycle space update */
+      h = Hes[nc+l+1][nc+l];
+      if (h != ZERO) N_VScale(ONE/h, V[l+1], V[l+1]);
+      else N_VConst(ZERO, V[l+1]);
+
+      /*  Update residual norm estimate; break if convergence test passes */
+      rotation_product *= givens[2*l+1];
+      *res_norm = rho = SUNRabs(rotation_product*r_norm);
+
+#if SUNDIALS_LOGGING_LEVEL >= SUNDIALS_LOGGING_INFO
+      /* print current iteration number and the residual */
+      SUNLogger_QueueMsg(S->sunctx->logger, SUN_LOGLEVEL_INFO,
+        "SUNLinSolSolve_GCRODR", "iterate-residual",
+        "nli = %li, resnorm = %.16g", (long int) *nli, *res_norm);
+#endif
+
+      if (rho <= delta) { converged = SUNTRUE; break; }
+    }
+
+    /* Inner loop is done.  Compute the new correction vector xcor */
+
+    /*   Construct g, then solve for y */
+    yg[0] = r_norm;
+    for (i=1; i<=krydim; i++) yg[i]=ZERO;
+    if (SUNQRsol(krydim, QR, givens, yg) != 0) {
+      *zeroguess  = SUNFALSE;
+      LASTFLAG(S) = SUNLS_QRSOL_FAIL;
+      return(LASTFLAG(S));
+    }
+
+    /*   Add correction vector V_l y - U B y to xcor */
+    cv[0] = ONE;
+    Xv[0] = xcor;
+
+    for (k=0; k<krydim; k++) {
+      cv[k+1] = yg[k];
+      Xv[k+1] = V[k];
+    }
+    for (i=0; i<nc; i++) {
+      h = ZERO;
+      for (k=0; k<krydim; k++) h += Hes[i][nc+k] * yg[k];
+      cv[krydim+1+i] = -h;
+      Xv[krydim+1+i] = GCRODR_CONTENT(S)->U[i];
+    }
+    ier = N_VLinearCombination(krydim+nc+1, cv, Xv, xcor);
+    if (ier != SUNLS_SUCCESS) {
+      *zeroguess  = SUNFALSE;
+      LASTFLAG(S) = SUNLS_VECTOROP_ERR;
+      return(SUNLS_VECTOROP_ERR);
+    }
+
+    /* Replace the recycle space with harmonic Ritz vectors of this cycle,
+       U, C, and V[0], ..., V[krydim] are only read */
+    ier = gcrodrUpdateRecycle(S, nc, krydim);
+    if (ier != SUNLS_SUCCESS) {
+      *zeroguess  = SUNFALSE;
+      LASTFLAG(S) = ier;
+      return(LASTFLAG(S));
+    }
+
+    /* If converged, construct the final solution vector x and return */
+    if (converged) {
+      ier = gcrodrFinalize(S, x, delta);
+      *zeroguess  = SUNFALSE;
+      LASTFLAG(S) = ier;
+      return(LASTFLAG(S));
+    }
+
+    /* Not yet converged; if allowed, prepare for restart */
+    if (ntries == max_restarts) break;
+
+    /* Construct last column of Q in yg */
+    s_product = ONE;
+    for (i=krydim; i>0; i--) {
+      yg[i] = s_product*givens[2*i-2];
+      s_product *= givens[2*i-1];
+    }
+    yg[0] = s_product;
+
+    /* Scale r_norm and yg */
+    r_norm *= s_product;
+    for (i=0; i<=krydim; i++)
+      yg[i] *= r_norm;
+    r_norm = SUNRabs(r_norm);
+
+    /* Multiply yg by V_(krydim+1) to get last residual vector; restart,
+       the residual is orthogonal to the range of A-tilde Z and so to the
+       updated C */
+    for (k=0; k<=krydim; k++) {
+      cv[k] = yg[k];
+      Xv[k] = V[k];
+    }
+    ier = N_VLinearCombination(krydim+1, cv, Xv, V[0]);
+    if (ier != SUNLS_SUCCESS) {
+      *zeroguess  = SUNFALSE;
+      LASTFLAG(S) = SUNLS_VECTOROP_ERR;
+      return(SUNLS_VECTOROP_ERR);
+    }
+
+  }
+
+  /* Failed to converge, even after allowed restarts.
+     If the residual norm was reduced below its initial value, compute
+     and return x anyway.  Otherwise return failure flag. */
+  if (rho < beta) {
+    ier = gcrodrFinalize(S, x, delta);
+    *zeroguess  = SUNFALSE;
+    LASTFLAG(S) = (ier == SUNLS_SUCCESS) ? SUNLS_RES_REDUCED : ier;
+    return(LASTFLAG(S));
+  }
+
+  *zeroguess  = SUNFALSE;
+  LASTFLAG(S) = SUNLS_CONV_FAIL;
+  return(LASTFLAG(S));
+}
+
+
+int SUNLinSolNumIters_GCRODR(SUNLinearSolver S)
+{
+  /* return the stored 'numiters' value */
+  if (S == NULL) return(-1);
+  return (GCRODR_CONTENT(S)->numiters);
+}
+
+
+realtype SUNLinSolResNorm_GCRODR(SUNLinearSolver S)
+{
+  /* return the stored 'resnorm' value */
+  if (S == NULL) return(-ONE);
+  return (GCRODR_CONTENT(S)->resnorm);
+}
+
+
+N_Vector SUNLinSolResid_GCRODR(SUNLinearSolver S)
+{
+  /* return the stored 'vtemp' vector */
+  return (GCRODR_CONTENT(S)->vtemp);
+}
+
+
+sunindextype SUNLinSolLastFlag_GCRODR(SUNLinearSolver S)
+{
+  /* return the stored 'last_flag' value */
+  if (S == NULL) return(-1);
+  return (LASTFLAG(S));
+}
+
+
+int SUNLinSolSpace_GCRODR(SUNLinearSolver S,
+                          long int *lenrwLS,
+                          long int *leniwLS)
+{
+  int maxl, kdim;
+  sunindextype liw1, lrw1;
+  maxl = GCRODR_CONTENT(S)->maxl;
+  kdim = GCRODR_CONTENT(S)->kdim;
+  if (GCRODR_CONTENT(S)->vtemp->ops->nvspace)
+    N_VSpace(GCRODR_CONTENT(S)->vtemp, &lrw1, &liw1);
+  else
+    lrw1 = liw1 = 0;
+  *lenrwLS = lrw1*(maxl + 5 + 4*kdim) + maxl*(13*maxl + 15) + 2;
+  *leniwLS = liw1*(maxl + 5 + 4*kdim) + 2*maxl;
+  return(SUNLS_SUCCESS);
+}
+
+
+int SUNLinSolFree_GCRODR(SUNLinearSolver S)
+{
+  int k;
+
+  if (S == NULL) return(SUNLS_SUCCESS);
+
+  if (S->content) {
+    /* delete items from within the content structure */
+    if (GCRODR_CONTENT(S)->xcor) {
+      N_VDestroy(GCRODR_CONTENT(S)->xcor);
+      GCRODR_CONTENT(S)->xcor = NULL;
+    }
+    if (GCRODR_CONTENT(S)->vtemp) {
+      N_VDestroy(GCRODR_CONTENT(S)->vtemp);
+      GCRODR_CONTENT(S)->vtemp = NULL;
+    }
+    if (GCRODR_CONTENT(S)->V) {
+      N_VDestroyVectorArray(GCRODR_CONTENT(S)->V,
+                            GCRODR_CONTENT(S)->maxl+1);
+      GCRODR_CONTENT(S)->V = NULL;
+    }
+    gcrodrFreeRecycle(S);
+    if (GCRODR_CONTENT(S)->Hes) {
+      for (k=0; k<=GCRODR_CONTENT(S)->maxl; k++)
+        if (GCRODR_CONTENT(S)->Hes[k]) {
+          free(GCRODR_CONTENT(S)->Hes[k]);
+          GCRODR_CONTENT(S)->Hes[k] = NULL;
+        }
+      free(GCRODR_CONTENT(S)->Hes);
+      GCRODR_CONTENT(S)->Hes = NULL;
+    }
+    if (GCRODR_CONTENT(S)->QR) {
+      for (k=0; k<=GCRODR_CONTENT(S)->maxl; k++)
+        if (GCRODR_CONTENT(S)->QR[k]) {
+          free(GCRODR_CONTENT(S)->QR[k]);
+          GCRODR_CONTENT(S)->QR[k] = NULL;
+        }
+      free(GCRODR_CONTENT(S)->QR);
+      GCRODR_CONTENT(S)->QR = NULL;
+    }
+    if (GCRODR_CONTENT(S)->givens) {
+      free(GCRODR_CONTENT(S)->givens);
+      GCRODR_CONTENT(S)->givens = NULL;
+    }
+    if (GCRODR_CONTENT(S)->yg) {
+      free(GCRODR_CONTENT(S)->yg);
+      GCRODR_CONTENT(S)->yg = NULL;
+    }
+    if (GCRODR_CONTENT(S)->cv) {
+      free(GCRODR_CONTENT(S)->cv);
+      GCRODR_CONTENT(S)->cv = NULL;
+    }
+    if (GCRODR_CONTENT(S)->Xv) {
+      free(GCRODR_CONTENT(S)->Xv);
+      GCRODR_CONTENT(S)->Xv = NULL;
+    }
+    if (GCRODR_CONTENT(S)->W) {
+      free(GCRODR_CONTENT(S)->W);
+      GCRODR_CONTENT(S)->W = NULL;
+    }
+    if (GCRODR_CONTENT(S)->WZ) {
+      SUNDlsMat_destroyMat(GCRODR_CONTENT(S)->WZ);
+      GCRODR_CONTENT(S)->WZ = NULL;
+    }
+    if (GCRODR_CONTENT(S)->A1) {
+      SUNDlsMat_destroyMat(GCRODR_CONTENT(S)->A1);
+      GCRODR_CONTENT(S)->A1 = NULL;
+    }
+    if (GCRODR_CONTENT(S)->X) {
+      SUNDlsMat_destroyMat(GCRODR_CONTENT(S)->X);
+      GCRODR_CONTENT(S)->X = NULL;
+    }
+    if (GCRODR_CONTENT(S)->E) {
+      SUNDlsMat_destroyMat(GCRODR_CONTENT(S)->E);
+      GCRODR_CONTENT(S)->E = NULL;
+    }
+    if (GCRODR_CONTENT(S)->P) {
+      SUNDlsMat_destroyMat(GCRODR_CONTENT(S)->P);
+      GCRODR_CONTENT(S)->P = NULL;
+    }
+    if (GCRODR_CONTENT(S)->Q) {
+      SUNDlsMat_destroyMat(GCRODR_CONTENT(S)->Q);
+      GCRODR_CONTENT(S)->Q = NULL;
+    }
+    if (GCRODR_CONTENT(S)->R) {
+      SUNDlsMat_destroyMat(GCRODR_CONTENT(S)->R);
+      GCRODR_CONTENT(S)->R = NULL;
+    }
+    if (GCRODR_CONTENT(S)->pivots) {
+      SUNDlsMat_destroyArray(GCRODR_CONTENT(S)->pivots);
+      GCRODR_CONTENT(S)->pivots = NULL;
+    }
+    if (GCRODR_CONTENT(S)->work) {
+      free(GCRODR_CONTENT(S)->work);
+      GCRODR_CONTENT(S)->work = NULL;
+    }
+    free(S->content); S->content = NULL;
+  }
+  if (S->ops) { free(S->ops); S->ops = NULL; }
+  free(S); S = NULL;
+  return(SUNLS_SUCCESS);
+}
+
+
+/*
+ * -----------------------------------------------------------------
+ * private functions
+ * -----------------------------------------------------------------
+ */
+
+/* ----------------------------------------------------------------------------
+ * Apply the scaled preconditioned operator, y = s1 P1_inv A P2_inv s2_inv x,
+ * using vtemp and y as work space (x and y must differ)
+ */
+
+static int gcrodrATilde(SUNLinearSolver S, N_Vector x, N_Vector y,
+                        realtype delta)
+{
+  int ier;
+  N_Vector vtemp = GCRODR_CONTENT(S)->vtemp;
+  N_Vector s1    = GCRODR_CONTENT(S)->s1;
+  N_Vector s2    = GCRODR_CONTENT(S)->s2;
+  int pretype    = GCRODR_CONTENT(S)->pretype;
+
+  /* Apply right scaling: vtemp = s2_inv x */
+  if (s2 != NULL) N_VDiv(x, s2, vtemp);
+  else N_VScale(ONE, x, vtemp);
+
+  /* Apply right preconditioner: vtemp = P2_inv s2_inv x */
+  if ((pretype == SUN_PREC_RIGHT) || (pretype == SUN_PREC_BOTH)) {
+    N_VScale(ONE, vtemp, y);
+    ier = GCRODR_CONTENT(S)->Psolve(GCRODR_CONTENT(S)->PData, y, vtemp, delta,
+                                    SUN_PREC_RIGHT);
+    if (ier != 0)
+      return((ier < 0) ? SUNLS_PSOLVE_FAIL_UNREC : SUNLS_PSOLVE_FAIL_REC);
+  }
+
+  /* Apply A: y = A P2_inv s2_inv x */
+  ier = GCRODR_CONTENT(S)->ATimes(GCRODR_CONTENT(S)->ATData, vtemp, y);
+  if (ier != 0)
+    return((ier < 0) ? SUNLS_ATIMES_FAIL_UNREC : SUNLS_ATIMES_FAIL_REC);
+
+  /* Apply left preconditioning: vtemp = P1_inv A P2_inv s2_inv x */
+  if ((pretype == SUN_PREC_LEFT) || (pretype == SUN_PREC_BOTH)) {
+    ier = GCRODR_CONTENT(S)->Psolve(GCRODR_CONTENT(S)->PData, y, vtemp, delta,
+                                    SUN_PREC_LEFT);
+    if (ier != 0)
+      return((ier < 0) ? SUNLS_PSOLVE_FAIL_UNREC : SUNLS_PSOLVE_FAIL_REC);
+  } else {
+    N_VScale(ONE, y, vtemp);
+  }
+
+  /* Apply left scaling: y = s1 P1_inv A P2_inv s2_inv x */
+  if (s1 != NULL) N_VProd(s1, vtemp, y);
+  else N_VScale(ONE, vtemp, y);
+
+  return(SUNLS_SUCCESS);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Recompute C = A-tilde U for the current operator and orthonormalize C with
+ * two passes of Cholesky QR, applying the same change of basis to U. Columns
+ * that become numerically dependent are dropped along with all following
+ * columns.
+ */
+
+static int gcrodrRefresh(SUNLinearSolver S, realtype delta)
+{
+  int j, nc, pass, ier;
+  N_Vector *U = GCRODR_CONTENT(S)->U;
+  N_Vector *C = GCRODR_CONTENT(S)->C;
+
+  nc = GCRODR_CONTENT(S)->nrecycle;
+
+  for (j=0; j<nc; j++) {
+    ier = gcrodrATilde(S, U[j], C[j], delta);
+    if (ier != SUNLS_SUCCESS) return(ier);
+    GCRODR_CONTENT(S)->nratimes++;
+  }
+
+  for (pass=0; pass<2; pass++) {
+    ier = gcrodrCholQR(S, &nc);
+    if (ier != SUNLS_SUCCESS) return(ier);
+  }
+
+  GCRODR_CONTENT(S)->nrecycle = nc;
+  return(SUNLS_SUCCESS);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * One pass of Cholesky QR, C = C R^{-1} and U = U R^{-1} where R^T R = C^T C.
+ * On return nc is the number of columns kept.
+ */
+
+static int gcrodrCholQR(SUNLinearSolver S, int *nc)
+{
+  int i, j, p, n, ier;
+  realtype d, tol;
+  N_Vector *U    = GCRODR_CONTENT(S)->U;
+  N_Vector *C    = GCRODR_CONTENT(S)->C;
+  N_Vector *Xv   = GCRODR_CONTENT(S)->Xv;
+  realtype *cv   = GCRODR_CONTENT(S)->cv;
+  realtype *g    = GCRODR_CONTENT(S)->work;
+  realtype **R   = GCRODR_CONTENT(S)->R;
+
+  n   = *nc;
+  tol = SUNRsqrt(SUN_UNIT_ROUNDOFF);
+
+  /* Gram matrix, the upper triangle is stored by columns in g */
+  for (i=0; i<n*n; i++) g[i] = ZERO;
+
+  for (j=0; j<n; j++) {
+    if (GCRODR_CONTENT(S)->sb)
+      ier = N_VDotProdMultiLocal(j+1, C[j], C, g + j*n);
+    else
+      ier = N_VDotProdMulti(j+1, C[j], C, g + j*n);
+    if (ier != 0) return(SUNLS_VECTOROP_ERR);
+  }
+
+  if (GCRODR_CONTENT(S)->sb) {
+    ier = N_VDotProdMultiAllReduce(n*n, C[0], g);
+    if (ier != 0) return(SUNLS_VECTOROP_ERR);
+  }
+
+  /* Cholesky factorization, stop at the first dependent column */
+  for (j=0; j<n; j++) {
+    for (i=0; i<j; i++) {
+      d = g[j*n+i];
+      for (p=0; p<i; p++) d -= R[i][p] * R[j][p];
+      R[j][i] = d / R[i][i];
+    }
+    d = g[j*n+j];
+    for (p=0; p<j; p++) d -= R[j][p] * R[j][p];
+    if (d <= tol * g[j*n+j]) { n = j; break; }
+    R[j][j] = SUNRsqrt(d);
+  }
+
+  /* C_j = (C_j - sum_{i<j} R(i,j) C_i) / R(j,j) and likewise for U */
+  for (j=0; j<n; j++) {
+    cv[0] = ONE / R[j][j];
+    for (i=0; i<j; i++) cv[i+1] = -R[j][i] / R[j][j];
+
+    Xv[0] = C[j];
+    for (i=0; i<j; i++) Xv[i+1] = C[i];
+    ier = N_VLinearCombination(j+1, cv, Xv, C[j]);
+    if (ier != 0) return(SUNLS_VECTOROP_ERR);
+
+    Xv[0] = U[j];
+    for (i=0; i<j; i++) Xv[i+1] = U[i];
+    ier = N_VLinearCombination(j+1, cv, Xv, U[j]);
+    if (ier != 0) return(SUNLS_VECTOROP_ERR);
+  }
+
+  *nc = n;
+  return(SUNLS_SUCCESS);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Project the residual onto the complement of span(C), z = C^T r,
+ * xcor = U z, r = r - C z
+ */
+
+static int gcrodrProject(SUNLinearSolver S, N_Vector r)
+{
+  int i, nc, ier;
+  N_Vector *U    = GCRODR_CONTENT(S)->U;
+  N_Vector *C    = GCRODR_CONTENT(S)->C;
+  N_Vector *Xv   = GCRODR_CONTENT(S)->Xv;
+  realtype *cv   = GCRODR_CONTENT(S)->cv;
+  realtype *z    = GCRODR_CONTENT(S)->work;
+
+  nc = GCRODR_CONTENT(S)->nrecycle;
+  if (nc == 0) return(SUNLS_SUCCESS);
+
+  ier = N_VDotProdMulti(nc, r, C, z);
+  if (ier != 0) return(SUNLS_VECTOROP_ERR);
+
+  ier = N_VLinearCombination(nc, z, U, GCRODR_CONTENT(S)->xcor);
+  if (ier != 0) return(SUNLS_VECTOROP_ERR);
+
+  cv[0] = ONE;
+  Xv[0] = r;
+  for (i=0; i<nc; i++) {
+    cv[i+1] = -z[i];
+    Xv[i+1] = C[i];
+  }
+  ier = N_VLinearCombination(nc+1, cv, Xv, r);
+  if (ier != 0) return(SUNLS_VECTOROP_ERR);
+
+  return(SUNLS_SUCCESS);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Update the recycle space after a cycle with nc recycled vectors and m
+ * Arnoldi steps. With Z, W, and G = Hes(0:n, 0:n-1), n = nc + m, as described
+ * at the top of this file the harmonic Ritz vectors are Z P where P holds
+ * the dominant eigenvectors of X = (G^T G)^{-1} G^T W^T Z. Then with
+ * G P = Q R the new space is U = Z P R^{-1}, C = W Q. If the dense
+ * computations fail the current space is kept.
+ */
+
+static int gcrodrUpdateRecycle(SUNLinearSolver S, int nc, int m)
+{
+  int i, j, r, n, k, kmax, pass, ier;
+  realtype s, nrm, nrm0, tol;
+  N_Vector *U, *C, *V, *Xv, *tmp;
+  realtype **Hes, **WZ, **A1, **X, **P, **Q, **R;
+
+  U    = GCRODR_CONTENT(S)->U;
+  C    = GCRODR_CONTENT(S)->C;
+  V    = GCRODR_CONTENT(S)->V;
+  Xv   = GCRODR_CONTENT(S)->Xv;
+  Hes  = GCRODR_CONTENT(S)->Hes;
+  WZ   = GCRODR_CONTENT(S)->WZ;
+  A1   = GCRODR_CONTENT(S)->A1;
+  X    = GCRODR_CONTENT(S)->X;
+  P    = GCRODR_CONTENT(S)->P;
+  Q    = GCRODR_CONTENT(S)->Q;
+  R    = GCRODR_CONTENT(S)->R;
+
+  n    = nc + m;
+  kmax = SUNMIN(GCRODR_CONTENT(S)->kdim, n);
+  tol  = SUNRsqrt(SUN_UNIT_ROUNDOFF);
+  if (kmax < 1) return(SUNLS_SUCCESS);
+
+  /* W^T Z, the first nc columns are the inner products of U with W and the
+     remaining columns are unit vectors */
+  for (j=0; j<n; j++)
+    for (i=0; i<=GCRODR_CONTENT(S)->maxl; i++)
+      WZ[j][i] = (i == j && j >= nc) ? ONE : ZERO;
+
+  for (i=0; i<nc; i++) Xv[i] = C[i];
+  for (i=0; i<=m; i++) Xv[nc+i] = V[i];
+
+  for (j=0; j<nc; j++) {
+    if (GCRODR_CONTENT(S)->sb)
+      ier = N_VDotProdMultiLocal(n+1, U[j], Xv, WZ[j]);
+    else
+      ier = N_VDotProdMulti(n+1, U[j], Xv, WZ[j]);
+    if (ier != 0) return(SUNLS_VECTOROP_ERR);
+  }
+
+  if (GCRODR_CONTENT(S)->sb && (nc > 0)) {
+    ier = N_VDotProdMultiAllReduce(nc*(GCRODR_CONTENT(S)->maxl+1), U[0],
+                                   WZ[0]);
+    if (ier != 0) return(SUNLS_VECTOROP_ERR);
+  }
+
+  /* A1 = G^T G and X = G^T W^T Z */
+  for (j=0; j<n; j++)
+    for (i=0; i<n; i++) {
+      s = ZERO;
+      for (r=0; r<=n; r++) s += Hes[r][i] * Hes[r][j];
+      A1[j][i] = s;
+      s = ZERO;
+      for (r=0; r<=n; r++) s += Hes[r][i] * WZ[j][r];
+      X[j][i] = s;
+    }
+
+  /* X = A1^{-1} X */
+  if (SUNDlsMat_denseGETRF(A1, n, n, GCRODR_CONTENT(S)->pivots) != 0)
+    return(SUNLS_SUCCESS);
+  for (j=0; j<n; j++)
+    SUNDlsMat_denseGETRS(A1, n, GCRODR_CONTENT(S)->pivots, X[j]);
+
+  /* eigenvectors for the kmax eigenvalues of largest magnitude in P */
+  k = gcrodrSelect(S, n, kmax);
+  if (k < 1) return(SUNLS_SUCCESS);
+
+  /* Q = G P, orthonormalize with two passes of modified Gram-Schmidt,
+     dropping dependent columns along with the matching columns of P */
+  for (j=0; j<k; j++)
+    for (i=0; i<=n; i++) {
+      s = ZERO;
+      for (r=0; r<n; r++) s += Hes[i][r] * P[j][r];
+      Q[j][i] = s;
+    }
+
+  kmax = k;
+  k    = 0;
+  for (j=0; j<kmax; j++) {
+    if (j != k)
+      for (i=0; i<=n; i++) {
+        Q[k][i] = Q[j][i];
+        if (i < n) P[k][i] = P[j][i];
+      }
+
+    nrm0 = ZERO;
+    for (i=0; i<=n; i++) nrm0 += Q[k][i] * Q[k][i];
+    nrm0 = SUNRsqrt(nrm0);
+
+    for (r=0; r<k; r++) R[k][r] = ZERO;
+    for (pass=0; pass<2; pass++)
+      for (r=0; r<k; r++) {
+        s = ZERO;
+        for (i=0; i<=n; i++) s += Q[r][i] * Q[k][i];
+        for (i=0; i<=n; i++) Q[k][i] -= s * Q[r][i];
+        R[k][r] += s;
+      }
+
+    nrm = ZERO;
+    for (i=0; i<=n; i++) nrm += Q[k][i] * Q[k][i];
+    nrm = SUNRsqrt(nrm);
+    if ((nrm0 == ZERO) || (nrm <= tol * nrm0)) continue;
+
+    R[k][k] = nrm;
+    for (i=0; i<=n; i++) Q[k][i] /= nrm;
+    k++;
+  }
+  if (k < 1) return(SUNLS_SUCCESS);
+
+  /* P = P R^{-1} */
+  for (j=0; j<k; j++) {
+    for (r=0; r<j; r++)
+      for (i=0; i<n; i++) P[j][i] -= R[j][r] * P[r][i];
+    for (i=0; i<n; i++) P[j][i] /= R[j][j];
+  }
+
+  /* C_new = W Q and U_new = Z P */
+  for (j=0; j<k; j++) {
+    ier = N_VLinearCombination(n+1, Q[j], Xv, GCRODR_CONTENT(S)->Cnew[j]);
+    if (ier != 0) return(SUNLS_VECTOROP_ERR);
+  }
+
+  for (i=0; i<nc; i++) Xv[i] = U[i];
+  for (j=0; j<k; j++) {
+    ier = N_VLinearCombination(n, P[j], Xv, GCRODR_CONTENT(S)->Unew[j]);
+    if (ier != 0) return(SUNLS_VECTOROP_ERR);
+  }
+
+  tmp = GCRODR_CONTENT(S)->U;
+  GCRODR_CONTENT(S)->U    = GCRODR_CONTENT(S)->Unew;
+  GCRODR_CONTENT(S)->Unew = tmp;
+
+  tmp = GCRODR_CONTENT(S)->C;
+  GCRODR_CONTENT(S)->C    = GCRODR_CONTENT(S)->Cnew;
+  GCRODR_CONTENT(S)->Cnew = tmp;
+
+  GCRODR_CONTENT(S)->nrecycle = k;
+  GCRODR_CONTENT(S)->nupdates++;
+
+  return(SUNLS_SUCCESS);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Compute eigenvectors of the n x n matrix X for its eigenvalues of largest
+ * magnitude and store them in the columns of P. A complex conjugate pair
+ * contributes the real and imaginary parts of its eigenvector, or only the
+ * real part if a single column remains. Returns the number of columns
+ * filled (at most kmax).
+ */
+
+static int gcrodrSelect(SUNLinearSolver S, int n, int kmax)
+{
+  int i, j, k, best;
+  realtype *h, *wr, *wi, *mod, *rhs;
+  realtype **X = GCRODR_CONTENT(S)->X;
+  realtype **P = GCRODR_CONTENT(S)->P;
+
+  h   = GCRODR_CONTENT(S)->work;
+  wr  = h + n*n;
+  wi  = wr + n;
+  mod = wi + n;
+  rhs = mod + n;
+
+  /* eigenvalues of X from its Hessenberg form (stored by rows) */
+  for (i=0; i<n; i++)
+    for (j=0; j<n; j++)
+      h[i*n+j] = X[j][i];
+  gcrodrHessReduce(n, h, rhs);
+  if (sunHessenbergEig(n, h, wr, wi) != 0) return(0);
+
+  /* one candidate for each real eigenvalue or conjugate pair */
+  for (i=0; i<n; i++)
+    mod[i] = (wi[i] < ZERO) ? -ONE : SUNRsqrt(SUNSQR(wr[i]) + SUNSQR(wi[i]));
+
+  k = 0;
+  while (k < kmax) {
+    best = -1;
+    for (i=0; i<n; i++)
+      if ((mod[i] > ZERO) && ((best < 0) || (mod[i] > mod[best]))) best = i;
+    if (best < 0) break;
+    mod[best] = -ONE;
+
+    if (gcrodrInvIter(n, X, wr[best], wi[best], GCRODR_CONTENT(S)->E,
+                      GCRODR_CONTENT(S)->pivots, rhs) != 0)
+      continue;
+
+    for (i=0; i<n; i++) P[k][i] = rhs[i];
+    k++;
+
+    if ((wi[best] != ZERO) && (k < kmax)) {
+      for (i=0; i<n; i++) P[k][i] = rhs[n+i];
+      k++;
+    }
+  }
+
+  return(k);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Inverse iteration for the eigenvector of X for the eigenvalue re + i im.
+ * For a complex eigenvalue the real form of (X - (re + i im) I) p = b,
+ *
+ *   [ X - re I    im I    ] [ p_r ]   [ b ]
+ *   [ -im I       X - re I] [ p_i ] = [ 0 ],
+ *
+ * is used. The shift is perturbed slightly so that the matrix is
+ * nonsingular. On return rhs holds p (length n) or [p_r; p_i] (length 2n).
+ */
+
+static int gcrodrInvIter(int n, realtype **X, realtype re, realtype im,
+                         realtype **E, sunindextype *pivots, realtype *rhs)
+{
+  int i, j, it, ntry, nn;
+  realtype shift, pert, big;
+  sunindextype ier;
+
+  nn   = (im == ZERO) ? n : 2*n;
+  pert = SUNRsqrt(SUN_UNIT_ROUNDOFF) * SUNRsqrt(SUNSQR(re) + SUNSQR(im));
+
+  ier = 1;
+  for (ntry=0; ntry<3; ntry++) {
+    shift = re + pert;
+    for (j=0; j<nn; j++)
+      for (i=0; i<nn; i++)
+        E[j][i] = ZERO;
+    for (j=0; j<n; j++)
+      for (i=0; i<n; i++) {
+        E[j][i] = X[j][i] - ((i == j) ? shift : ZERO);
+        if (nn > n) E[n+j][n+i] = E[j][i];
+      }
+    if (nn > n)
+      for (i=0; i<n; i++) {
+        E[n+i][i] = im;
+        E[i][n+i] = -im;
+      }
+
+    ier = SUNDlsMat_denseGETRF(E, nn, nn, pivots);
+    if (ier == 0) break;
+    pert *= RCONST(100.0);
+  }
+  if (ier != 0) return(1);
+
+  for (i=0; i<nn; i++) rhs[i] = ONE;
+
+  for (it=0; it<2; it++) {
+    SUNDlsMat_denseGETRS(E, nn, pivots, rhs);
+    big = ZERO;
+    for (i=0; i<nn; i++) big = SUNMAX(big, SUNRabs(rhs[i]));
+    if (big == ZERO) return(1);
+    for (i=0; i<nn; i++) rhs[i] /= big;
+  }
+
+  return(0);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Reduce the n x n matrix a (stored by rows) to upper Hessenberg form with
+ * Householder similarity transformations, v is work space of length n
+ */
+
+static void gcrodrHessReduce(int n, realtype *a, realtype *v)
+{
+  int i, j, k;
+  realtype alpha, vnorm2, s;
+
+  for (k=0; k<n-2; k++) {
+
+    alpha = ZERO;
+    for (i=k+1; i<n; i++) alpha += a[i*n+k] * a[i*n+k];
+    alpha = SUNRsqrt(alpha);
+    if (alpha == ZERO) continue;
+    if (a[(k+1)*n+k] > ZERO) alpha = -alpha;
+
+    for (i=k+1; i<n; i++) v[i] = a[i*n+k];
+    v[k+1] -= alpha;
+
+    vnorm2 = ZERO;
+    for (i=k+1; i<n; i++) vnorm2 += v[i] * v[i];
+    if (vnorm2 == ZERO) continue;
+
+    /* a = (I - 2 v v^T / v^T v) a */
+    for (j=0; j<n; j++) {
+      s = ZERO;
+      for (i=k+1; i<n; i++) s += v[i] * a[i*n+j];
+      s *= TWO / vnorm2;
+      for (i=k+1; i<n; i++) a[i*n+j] -= s * v[i];
+    }
+
+    /* a = a (I - 2 v v^T / v^T v) */
+    for (i=0; i<n; i++) {
+      s = ZERO;
+      for (j=k+1; j<n; j++) s += a[i*n+j] * v[j];
+      s *= TWO / vnorm2;
+      for (j=k+1; j<n; j++) a[i*n+j] -= s * v[j];
+    }
+
+    a[(k+1)*n+k] = alpha;
+    for (i=k+2; i<n; i++) a[i*n+k] = ZERO;
+  }
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Allocate and free the recycle space vectors
+ */
+
+static int gcrodrAllocRecycle(SUNLinearSolver S)
+{
+  int kdim = GCRODR_CONTENT(S)->kdim;
+
+  if (kdim < 1) return(SUNLS_SUCCESS);
+
+  GCRODR_CONTENT(S)->U    = N_VCloneVectorArray(kdim, GCRODR_CONTENT(S)->vtemp);
+  GCRODR_CONTENT(S)->C    = N_VCloneVectorArray(kdim, GCRODR_CONTENT(S)->vtemp);
+  GCRODR_CONTENT(S)->Unew = N_VCloneVectorArray(kdim, GCRODR_CONTENT(S)->vtemp);
+  GCRODR_CONTENT(S)->Cnew = N_VCloneVectorArray(kdim, GCRODR_CONTENT(S)->vtemp);
+
+  if ((GCRODR_CONTENT(S)->U == NULL)    || (GCRODR_CONTENT(S)->C == NULL) ||
+      (GCRODR_CONTENT(S)->Unew == NULL) || (GCRODR_CONTENT(S)->Cnew == NULL)) {
+    gcrodrFreeRecycle(S);
+    return(SUNLS_MEM_FAIL);
+  }
+
+  return(SUNLS_SUCCESS);
+}
+
+
+static void gcrodrFreeRecycle(SUNLinearSolver S)
+{
+  int kdim = GCRODR_CONTENT(S)->kdim;
+
+  if (GCRODR_CONTENT(S)->U) {
+    N_VDestroyVectorArray(GCRODR_CONTENT(S)->U, kdim);
+    GCRODR_CONTENT(S)->U = NULL;
+  }
+  if (GCRODR_CONTENT(S)->C) {
+    N_VDestroyVectorArray(GCRODR_CONTENT(S)->C, kdim);
+    GCRODR_CONTENT(S)->C = NULL;
+  }
+  if (GCRODR_CONTENT(S)->Unew) {
+    N_VDestroyVectorArray(GCRODR_CONTENT(S)->Unew, kdim);
+    GCRODR_CONTENT(S)->Unew = NULL;
+  }
+  if (GCRODR_CONTENT(S)->Cnew) {
+    N_VDestroyVectorArray(GCRODR_CONTENT(S)->Cnew, kdim);
+    GCRODR_CONTENT(S)->Cnew = NULL;
+  }
+  GCRODR_CONTENT(S)->nrecycle = 0;
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Apply right scaling and right preconditioning to xcor and add the result
+ * to x (or overwrite x for a zero initial guess)
+ */
+
+static int gcrodrFinalize(SUNLinearSolver S, N_Vector x, realtype delta)
+{
+  int ier, pretype;
+  N_Vector xcor  = GCRODR_CONTENT(S)->xcor;
+  N_Vector vtemp = GCRODR_CONTENT(S)->vtemp;
+  N_Vector s2    = GCRODR_CONTENT(S)->s2;
+
+  pretype = GCRODR_CONTENT(S)->pretype;
+
+  /* Apply right scaling and right precond.: vtemp = P2_inv s2_inv xcor */
+  if (s2 != NULL) N_VDiv(xcor, s2, xcor);
+  if ((pretype == SUN_PREC_RIGHT) || (pretype == SUN_PREC_BOTH)) {
+    ier = GCRODR_CONTENT(S)->Psolve(GCRODR_CONTENT(S)->PData, xcor, vtemp,
+                                    delta, SUN_PREC_RIGHT);
+    if (ier != 0)
+      return((ier < 0) ? SUNLS_PSOLVE_FAIL_UNREC : SUNLS_PSOLVE_FAIL_REC);
+  } else {
+    N_VScale(ONE, xcor, vtemp);
+  }
+
+  /* Add vtemp to initial x to get final solution x */
+  if (GCRODR_CONTENT(S)->zeroguess)
+    N_VScale(ONE, vtemp, x);
+  else
+    N_VLinearSum(ONE, x, ONE, vtemp, x);
+
+  return(SUNLS_SUCCESS);
+}
@@ -28,6 +28,9 @@
 #define ZERO RCONST(0.0)
 #define ONE  RCONST(1.0)
 
+/* Number of pipelined iterations between residual replacements */
+#define PCG_PIPE_REPLACE 50
+
 /*
  * -----------------------------------------------------------------
  * PCG solver structure accessibility macros:
@@ -38,6 +41,17 @@
 #define PRETYPE(S)      ( PCG_CONTENT(S)->pretype )
 #define LASTFLAG(S)     ( PCG_CONTENT(S)->last_flag )
 
+/*
+ * -----------------------------------------------------------------
+ * private functions
+ * -----------------------------------------------------------------
+ */
+
+static int pcgSolvePipelined(SUNLinearSolver S, N_Vector x, N_Vector b,
+                             realtype delta);
+static int pcgPrecAtimes(SUNLinearSolver S, N_Vector v, N_Vector Pv,
+                         N_Vector APv, booleantype UsePrec, realtype delta);
+
 /*
  * -----------------------------------------------------------------
  * exported functions
@@ -102,6 +116,12 @@ SUNLinearSolver SUNLinSol_PCG(N_Vector y, int pretype, int maxl, SUNContext sunc
   content->z           = NULL;
   content->Ap          = NULL;
   content->s           = NULL;
+  content->pipelined   = SUNFALSE;
+  content->w           = NULL;
+  content->m           = NULL;
+  content->n           = NULL;
+  content->q           = NULL;
+  content->Aq          = NULL;
   content->ATimes      = NULL;
   content->ATData      = NULL;
   content->Psetup      = NULL;
@@ -170,6 +190,39 @@ int SUNLinSol_PCGSetMaxl(SUNLinearSolver S, int maxl)
 }
 
 
+/* ----------------------------------------------------------------------------
+ * Function to enable or disable the pipelined PCG iteration
+ */
+
+int SUNLinSol_PCGSetPipelined(SUNLinearSolver S, booleantype onoff)
+{
+  int i;
+  N_Vector *vecs[5];
+
+  /* Check for non-NULL SUNLinearSolver */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+
+  /* Allocate the additional vectors used by the pipelined iteration */
+  if (onoff) {
+    vecs[0] = &(PCG_CONTENT(S)->w);
+    vecs[1] = &(PCG_CONTENT(S)->m);
+    vecs[2] = &(PCG_CONTENT(S)->n);
+    vecs[3] = &(PCG_CONTENT(S)->q);
+    vecs[4] = &(PCG_CONTENT(S)->Aq);
+    for (i=0; i<5; i++) {
+      if (*vecs[i] == NULL) {
+        *vecs[i] = N_VClone(PCG_CONTENT(S)->r);
+        if (*vecs[i] == NULL) return(SUNLS_MEM_FAIL);
+      }
+    }
+  }
+
+  /* Set pipelined flag */
+  PCG_CONTENT(S)->pipelined = onoff;
+  return(SUNLS_SUCCESS);
+}
+
+
 /*
  * -----------------------------------------------------------------
  * implementation of linear solver operations
@@ -313,6 +366,7 @@ int SUNLinSolSolve_PCG(SUNLinearSolver S, SUNMatrix nul, N_Vector x,
 
   /* Make local shorcuts to solver variables. */
   if (S == NULL) return(SUNLS_MEM_NULL);
+  if (PCG_CONTENT(S)->pipelined) return(pcgSolvePipelined(S, x, b, delta));
   l_max        = PCG_CONTENT(S)->maxl;
   r            = PCG_CONTENT(S)->r;
   p            = PCG_CONTENT(S)->p;
@@ -542,10 +596,12 @@ int SUNLinSolSpace_PCG(SUNLinearSolver S,
                        long int *lenrwLS,
                        long int *leniwLS)
 {
+  int nvecs;
   sunindextype liw1, lrw1;
+  nvecs = (PCG_CONTENT(S)->w) ? 9 : 4;
   N_VSpace(PCG_CONTENT(S)->r, &lrw1, &liw1);
-  *lenrwLS = 1 + lrw1*4;
-  *leniwLS = 4 + liw1*4;
+  *lenrwLS = 1 + lrw1*nvecs;
+  *leniwLS = 4 + liw1*nvecs;
   return(SUNLS_SUCCESS);
 }
 
@@ -571,6 +627,26 @@ int SUNLinSolFree_PCG(SUNLinearSolver S)
       N_VDestroy(PCG_CONTENT(S)->Ap);
       PCG_CONTENT(S)->Ap = NULL;
     }
+    if (PCG_CONTENT(S)->w) {
+      N_VDestroy(PCG_CONTENT(S)->w);
+      PCG_CONTENT(S)->w = NULL;
+    }
+    if (PCG_CONTENT(S)->m) {
+      N_VDestroy(PCG_CONTENT(S)->m);
+      PCG_CONTENT(S)->m = NULL;
+    }
+    if (PCG_CONTENT(S)->n) {
+      N_VDestroy(PCG_CONTENT(S)->n);
+      PCG_CONTENT(S)->n = NULL;
+    }
+    if (PCG_CONTENT(S)->q) {
+      N_VDestroy(PCG_CONTENT(S)->q);
+      PCG_CONTENT(S)->q = NULL;
+    }
+    if (PCG_CONTENT(S)->Aq) {
+      N_VDestroy(PCG_CONTENT(S)->Aq);
+      PCG_CONTENT(S)->Aq = NULL;
+    }
     free(S->content); S->content = NULL;
   }
   if (S->ops) { free(S->ops); S->ops = NULL; }
@@ -607,3 +683,294 @@ int SUNLinSolSetPrintLevel_PCG(SUNLinearSolver S,
 
   return(SUNLS_SUCCESS);
 }
+
+
+/*
+ * -----------------------------------------------------------------
+ * private functions
+ * -----------------------------------------------------------------
+ */
+
+/* ----------------------------------------------------------------------------
+ * Pipelined PCG (Ghysels and Vanroose, 2014). In addition to the residual r
+ * and preconditioned residual u = P^{-1} r the recurrences update w = A u and
+ * the auxiliary vectors m = P^{-1} w, n = A m, q = P^{-1} s and Aq = A q, where
+ * s = A p. The inner products <r,u>, <w,u> and the scaled residual norm are
+ * computed together with a single global reduction per iteration when the
+ * vector supports the local dot product and all-reduce operations. The
+ * reduction does not depend on the preconditioner solve and matrix-vector
+ * product of the same iteration, so it is completed after them. Every
+ * PCG_PIPE_REPLACE iterations the residual and auxiliary vectors are
+ * recomputed from x and p (residual replacement).
+ */
+
+static int pcgSolvePipelined(SUNLinearSolver S, N_Vector x, N_Vector b,
+                             realtype delta)
+{
+  /* local data and shortcut variables */
+  realtype alpha, beta, r0_norm, rho, gamma, gamma_old, eta, dots[3];
+  N_Vector r, u, w, m, n, p, s, q, Aq, sc, rs, Y[2];
+  booleantype UsePrec, UseScaling, converged, sb;
+  booleantype *zeroguess;
+  int l, l_max, pretype, ier;
+  void *A_data;
+  SUNATimesFn atimes;
+  SUNPSolveFn psolve;
+  realtype *res_norm;
+  int *nli;
+
+  /* Make local shorcuts to solver variables. */
+  l_max        = PCG_CONTENT(S)->maxl;
+  r            = PCG_CONTENT(S)->r;
+  p            = PCG_CONTENT(S)->p;
+  u            = PCG_CONTENT(S)->z;
+  s            = PCG_CONTENT(S)->Ap;
+  w            = PCG_CONTENT(S)->w;
+  m            = PCG_CONTENT(S)->m;
+  n            = PCG_CONTENT(S)->n;
+  q            = PCG_CONTENT(S)->q;
+  Aq           = PCG_CONTENT(S)->Aq;
+  sc           = PCG_CONTENT(S)->s;
+  A_data       = PCG_CONTENT(S)->ATData;
+  atimes       = PCG_CONTENT(S)->ATimes;
+  psolve       = PCG_CONTENT(S)->Psolve;
+  pretype      = PCG_CONTENT(S)->pretype;
+  zeroguess    = &(PCG_CONTENT(S)->zeroguess);
+  nli          = &(PCG_CONTENT(S)->numiters);
+  res_norm     = &(PCG_CONTENT(S)->resnorm);
+
+  /* Initialize counters and convergence flag */
+  *nli = 0;
+  converged = SUNFALSE;
+  r0_norm = rho = ZERO;
+  alpha = gamma_old = ONE;
+
+  /* set booleantype flags for internal solver options */
+  UsePrec = ( (pretype == SUN_PREC_BOTH) ||
+              (pretype == SUN_PREC_LEFT) ||
+              (pretype == SUN_PREC_RIGHT) );
+  UseScaling = (sc != NULL);
+  sb = (r->ops->nvdotprodmultilocal != NULL) &&
+       (r->ops->nvdotprodmultiallreduce != NULL);
+
+#if SUNDIALS_LOGGING_LEVEL >= SUNDIALS_LOGGING_INFO
+  if (PCG_CONTENT(S)->print_level && PCG_CONTENT(S)->info_file
+      && (PCG_CONTENT(S)->info_file != S->sunctx->logger->info_fp))
+    fprintf(PCG_CONTENT(S)->info_file, "SUNLINSOL_PCG:\n");
+#endif
+
+  /* Check if Atimes function has been set */
+  if (atimes == NULL) {
+    *zeroguess  = SUNFALSE;
+    LASTFLAG(S) = SUNLS_ATIMES_NULL;
+    return(LASTFLAG(S));
+  }
+
+  /* If preconditioning, check if psolve has been set */
+  if (UsePrec && psolve == NULL) {
+    *zeroguess  = SUNFALSE;
+    LASTFLAG(S) = SUNLS_PSOLVE_NULL;
+    return(LASTFLAG(S));
+  }
+
+  /* Check that the pipelined vectors have been allocated */
+  if (w == NULL) {
+    *zeroguess  = SUNFALSE;
+    LASTFLAG(S) = SUNLS_MEM_NULL;
+    return(LASTFLAG(S));
+  }
+
+  /* Set r to initial residual r_0 = b - A*x_0 */
+  if (*zeroguess) {
+    N_VScale(ONE, b, r);
+  } else {
+    ier = atimes(A_data, x, r);
+    if (ier != 0) {
+      *zeroguess  = SUNFALSE;
+      LASTFLAG(S) = (ier < 0) ?
+        SUNLS_ATIMES_FAIL_UNREC : SUNLS_ATIMES_FAIL_REC;
+      return(LASTFLAG(S));
+    }
+    N_VLinearSum(ONE, b, -ONE, r, r);
+  }
+
+  /* Set u = P^{-1}*r and w = A*u */
+  ier = pcgPrecAtimes(S, r, u, w, UsePrec, delta);
+  if (ier != SUNLS_SUCCESS) {
+    *zeroguess  = SUNFALSE;
+    LASTFLAG(S) = ier;
+    return(LASTFLAG(S));
+  }
+
+  /* Begin main iteration loop, the residual of iteration l is checked at the
+     start of iteration l+1 */
+  for(l=0; ; l++) {
+
+    /* Local inner products gamma = <r,u>, eta = <w,u>, and rho^2 = <Sr,Sr>
+       (m is used as temporary storage for the scaled residual) */
+    rs = r;
+    if (UseScaling) { N_VProd(r, sc, m); rs = m; }
+    Y[0] = r;
+    Y[1] = w;
+    if (sb) {
+      ier = N_VDotProdMultiLocal(2, u, Y, dots);
+      if (ier == 0) ier = N_VDotProdMultiLocal(1, rs, &rs, dots + 2);
+    } else {
+      ier = N_VDotProdMulti(2, u, Y, dots);
+      dots[2] = N_VDotProd(rs, rs);
+    }
+    if (ier != 0) {
+      *zeroguess  = SUNFALSE;
+      LASTFLAG(S) = SUNLS_VECTOROP_ERR;
+      return(LASTFLAG(S));
+    }
+
+    /* Apply preconditioner and matrix: m = P^{-1}*w, n = A*m */
+    if (l < l_max) {
+      ier = pcgPrecAtimes(S, w, m, n, UsePrec, delta);
+      if (ier != SUNLS_SUCCESS) {
+        *zeroguess  = SUNFALSE;
+        LASTFLAG(S) = ier;
+        return(LASTFLAG(S));
+      }
+    }
+
+    /* Complete the reduction */
+    if (sb) {
+      ier = N_VDotProdMultiAllReduce(3, r, dots);
+      if (ier != 0) {
+        *zeroguess  = SUNFALSE;
+        LASTFLAG(S) = SUNLS_VECTOROP_ERR;
+        return(LASTFLAG(S));
+      }
+    }
+    gamma = dots[0];
+    eta   = dots[1];
+
+    /* Set rho and check convergence */
+    *res_norm = rho = SUNRsqrt(dots[2]);
+    if (l == 0) r0_norm = rho;
+
+#if SUNDIALS_LOGGING_LEVEL >= SUNDIALS_LOGGING_INFO
+    /* print current iteration number and the residual */
+    if (PCG_CONTENT(S)->print_level && PCG_CONTENT(S)->info_file
+      && (PCG_CONTENT(S)->info_file != S->sunctx->logger->info_fp))
+    {
+      fprintf(PCG_CONTENT(S)->info_file,
+              SUNLS_MSG_RESIDUAL,
+              (long int) *nli, *res_norm);
+    }
+    SUNLogger_QueueMsg(S->sunctx->logger, SUN_LOGLEVEL_INFO,
+      "SUNLinSolSolve_PCG", (l == 0) ? "initial-residual" : "iterate-residual",
+      "nli = %li, resnorm = %.16g", (long int) *nli, *res_norm);
+#endif
+
+    if (rho <= delta) {
+      converged = SUNTRUE;
+      break;
+    }
+
+    /* Exit after the last iteration */
+    if (l == l_max) break;
+
+    /* increment counter */
+    (*nli)++;
+
+    /* Calculate beta = <r,u> / <r_old,u_old> and
+       alpha = <r,u> / (<w,u> - beta <r,u> / alpha_old) */
+    if (l == 0) {
+      beta  = ZERO;
+      alpha = gamma / eta;
+    } else {
+      beta  = gamma / gamma_old;
+      alpha = gamma / (eta - beta * gamma / alpha);
+    }
+    gamma_old = gamma;
+
+    /* Update Aq = n + beta*Aq, q = m + beta*q, s = w + beta*s, p = u + beta*p */
+    if (l == 0) {
+      N_VScale(ONE, n, Aq);
+      N_VScale(ONE, m, q);
+      N_VScale(ONE, w, s);
+      N_VScale(ONE, u, p);
+    } else {
+      N_VLinearSum(ONE, n, beta, Aq, Aq);
+      N_VLinearSum(ONE, m, beta, q, q);
+      N_VLinearSum(ONE, w, beta, s, s);
+      N_VLinearSum(ONE, u, beta, p, p);
+    }
+
+    /* Update x = x + alpha*p */
+    if (l == 0 && *zeroguess)
+      N_VScale(alpha, p, x);
+    else
+      N_VLinearSum(ONE, x, alpha, p, x);
+
+    /* Update r = r - alpha*s, u = u - alpha*q, w = w - alpha*Aq */
+    N_VLinearSum(ONE, r, -alpha, s, r);
+    N_VLinearSum(ONE, u, -alpha, q, u);
+    N_VLinearSum(ONE, w, -alpha, Aq, w);
+
+    /* Periodically replace the recursively updated vectors with their true
+       values to limit the loss of attainable accuracy caused by the
+       additional recurrences */
+    if ((l + 1) % PCG_PIPE_REPLACE == 0) {
+      ier = atimes(A_data, x, r);
+      if (ier == 0) {
+        N_VLinearSum(ONE, b, -ONE, r, r);
+        ier = atimes(A_data, p, s);
+      }
+      if (ier != 0) {
+        *zeroguess  = SUNFALSE;
+        LASTFLAG(S) = (ier < 0) ?
+          SUNLS_ATIMES_FAIL_UNREC : SUNLS_ATIMES_FAIL_REC;
+        return(LASTFLAG(S));
+      }
+
+      ier = pcgPrecAtimes(S, r, u, w, UsePrec, delta);
+      if (ier == SUNLS_SUCCESS)
+        ier = pcgPrecAtimes(S, s, q, Aq, UsePrec, delta);
+      if (ier != SUNLS_SUCCESS) {
+        *zeroguess  = SUNFALSE;
+        LASTFLAG(S) = ier;
+        return(LASTFLAG(S));
+      }
+    }
+  }
+
+  /* Main loop finished, return with result */
+  *zeroguess = SUNFALSE;
+  if (converged == SUNTRUE) {
+    LASTFLAG(S) = SUNLS_SUCCESS;
+  } else if (rho < r0_norm) {
+    LASTFLAG(S) = SUNLS_RES_REDUCED;
+  } else {
+    LASTFLAG(S) = SUNLS_CONV_FAIL;
+  }
+  return(LASTFLAG(S));
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Compute Pv = P^{-1}*v (or Pv = v without preconditioning) and APv = A*Pv
+ */
+
+static int pcgPrecAtimes(SUNLinearSolver S, N_Vector v, N_Vector Pv,
+                         N_Vector APv, booleantype UsePrec, realtype delta)
+{
+  int ier;
+
+  if (UsePrec) {
+    ier = PCG_CONTENT(S)->Psolve(PCG_CONTENT(S)->PData, v, Pv, delta,
+                                 SUN_PREC_LEFT);
+    if (ier != 0)
+      return((ier < 0) ? SUNLS_PSOLVE_FAIL_UNREC : SUNLS_PSOLVE_FAIL_REC);
+  }
+  else N_VScale(ONE, v, Pv);
+
+  ier = PCG_CONTENT(S)->ATimes(PCG_CONTENT(S)->ATData, Pv, APv);
+  if (ier != 0)
+    return((ier < 0) ? SUNLS_ATIMES_FAIL_UNREC : SUNLS_ATIMES_FAIL_REC);
+
+  return(SUNLS_SUCCESS);
+}
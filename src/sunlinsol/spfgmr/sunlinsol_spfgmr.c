@@ -25,6 +25,7 @@
 
 #include "sundials_context_impl.h"
 #include "sundials_logger_impl.h"
+#include "sundials_iterative_impl.h"
 
 #define ZERO RCONST(0.0)
 #define ONE  RCONST(1.0)
@@ -169,7 +170,8 @@ int SUNLinSol_SPFGMRSetPrecType(SUNLinearSolver S, int pretype)
 int SUNLinSol_SPFGMRSetGSType(SUNLinearSolver S, int gstype)
 {
   /* Check for legal gstype */
-  if ((gstype != SUN_MODIFIED_GS) && (gstype != SUN_CLASSICAL_GS)) {
+  if ((gstype != SUN_MODIFIED_GS) && (gstype != SUN_CLASSICAL_GS) &&
+      (gstype != SUN_DCGS2_GS)) {
     return(SUNLS_ILL_INPUT);
   }
 
@@ -304,9 +306,9 @@ int SUNLinSolInitialize_SPFGMR(SUNLinearSolver S)
     }
   }
 
-  /*    cv vector for fused vector ops */
+  /*    cv vector for fused vector ops (and the DCGS2 reduction buffer) */
   if (content->cv == NULL) {
-    content->cv = (realtype *) malloc((content->maxl+1)*sizeof(realtype));
+    content->cv = (realtype *) malloc(2*(content->maxl+1)*sizeof(realtype));
     if (content->cv == NULL) {
       content->last_flag = SUNLS_MEM_FAIL;
       return(SUNLS_MEM_FAIL);
@@ -415,6 +417,7 @@ int SUNLinSolSolve_SPFGMR(SUNLinearSolver S, SUNMatrix A, N_Vector x,
   booleantype preOnRight, scale1, scale2, converged;
   booleantype *zeroguess;
   int i, j, k, l, l_max, krydim, ier, ntries, max_restarts, gstype;
+  int lcol, delay;
   int *nli;
   void *A_data, *P_data;
   SUNATimesFn atimes;
@@ -432,6 +435,7 @@ int SUNLinSolSolve_SPFGMR(SUNLinearSolver S, SUNMatrix A, N_Vector x,
   l_max        = SPFGMR_CONTENT(S)->maxl;
   max_restarts = SPFGMR_CONTENT(S)->max_restarts;
   gstype       = SPFGMR_CONTENT(S)->gstype;
+  delay        = (gstype == SUN_DCGS2_GS) ? 1 : 0;
   V            = SPFGMR_CONTENT(S)->V;
   Z            = SPFGMR_CONTENT(S)->Z;
   Hes          = SPFGMR_CONTENT(S)->Hes;
@@ -543,68 +547,94 @@ int SUNLinSolSolve_SPFGMR(SUNLinearSolver S, SUNMatrix A, N_Vector x,
     rotation_product = ONE;
     N_VScale(ONE/r_norm, V[0], V[0]);
 
-    /* Inner loop: generate Krylov sequence and Arnoldi basis. */
-    for (l=0; l<l_max; l++) {
-
-      (*nli)++;
-
-      krydim = l + 1;
-
-      /* Generate A-tilde V[l], where A-tilde = s1 A P_inv s2_inv. */
-
-      /*   Apply right scaling: vtemp = s2_inv V[l]. */
-      if (scale2) N_VDiv(V[l], s2, vtemp);
-      else N_VScale(ONE, V[l], vtemp);
+    /* Inner loop: generate Krylov sequence and Arnoldi basis. With DCGS2
+       the orthogonalization of each column is completed one iteration
+       later, so one extra pass (without applying A) finishes the last
+       column. */
+    for (l=0; l<l_max+delay; l++) {
+
+      if (l < l_max) {
+
+        /* Generate A-tilde V[l], where A-tilde = s1 A P_inv s2_inv. */
+
+        /*   Apply right scaling: vtemp = s2_inv V[l]. */
+        if (scale2) N_VDiv(V[l], s2, vtemp);
+        else N_VScale(ONE, V[l], vtemp);
+
+        /*   Apply right preconditioner: vtemp = Z[l] = P_inv s2_inv V[l]. */
+        if (preOnRight) {
+          N_VScale(ONE, vtemp, V[l+1]);
+          ier = psolve(P_data, V[l+1], vtemp, delta, SUN_PREC_RIGHT);
+          if (ier != 0) {
+            *zeroguess  = SUNFALSE;
+            LASTFLAG(S) = (ier < 0) ?
+              SUNLS_PSOLVE_FAIL_UNREC : SUNLS_PSOLVE_FAIL_REC;
+            return(LASTFLAG(S));
+          }
+        }
+        N_VScale(ONE, vtemp, Z[l]);
 
-      /*   Apply right preconditioner: vtemp = Z[l] = P_inv s2_inv V[l]. */
-      if (preOnRight) {
-        N_VScale(ONE, vtemp, V[l+1]);
-        ier = psolve(P_data, V[l+1], vtemp, delta, SUN_PREC_RIGHT);
+        /*   Apply A: V[l+1] = A P_inv s2_inv V[l]. */
+        ier = atimes(A_data, vtemp, V[l+1]);
         if (ier != 0) {
           *zeroguess  = SUNFALSE;
           LASTFLAG(S) = (ier < 0) ?
-            SUNLS_PSOLVE_FAIL_UNREC : SUNLS_PSOLVE_FAIL_REC;
+            SUNLS_ATIMES_FAIL_UNREC : SUNLS_ATIMES_FAIL_REC;
           return(LASTFLAG(S));
         }
-      }
-      N_VScale(ONE, vtemp, Z[l]);
 
-      /*   Apply A: V[l+1] = A P_inv s2_inv V[l]. */
-      ier = atimes(A_data, vtemp, V[l+1]);
-      if (ier != 0) {
-        *zeroguess  = SUNFALSE;
-        LASTFLAG(S) = (ier < 0) ?
-          SUNLS_ATIMES_FAIL_UNREC : SUNLS_ATIMES_FAIL_REC;
-        return(LASTFLAG(S));
+        /*   Apply left scaling: V[l+1] = s1 A P_inv s2_inv V[l]. */
+        if (scale1)  N_VProd(s1, V[l+1], V[l+1]);
       }
 
-      /*   Apply left scaling: V[l+1] = s1 A P_inv s2_inv V[l]. */
-      if (scale1)  N_VProd(s1, V[l+1], V[l+1]);
-
       /* Orthogonalize V[l+1] against previous V[i]: V[l+1] = w_tilde. */
-      if (gstype == SUN_CLASSICAL_GS) {
+      if (gstype == SUN_DCGS2_GS) {
+        if (l < l_max)
+          ier = sunDelayedClassicalGS(V, Hes, l+1, SUNFALSE, cv, Xv);
+        else
+          ier = sunDelayedClassicalGSFinalize(V, Hes, l, cv, Xv);
+        if (ier != 0) {
+          *zeroguess  = SUNFALSE;
+          LASTFLAG(S) = SUNLS_GS_FAIL;
+          return(LASTFLAG(S));
+        }
+
+        /* Column l-1 of Hes is now complete, there is nothing to test yet
+           after the first step. Z[l] was generated from the unnormalized
+           V[l], apply the same normalization. */
+        if (l == 0) continue;
+        if ((l < l_max) && (Hes[l][l-1] != ZERO))
+          N_VScale(ONE/Hes[l][l-1], Z[l], Z[l]);
+        lcol = l - 1;
+      } else if (gstype == SUN_CLASSICAL_GS) {
         if (SUNClassicalGS(V, Hes, l+1, l_max, &(Hes[l+1][l]), cv, Xv) != 0) {
           *zeroguess  = SUNFALSE;
           LASTFLAG(S) = SUNLS_GS_FAIL;
           return(LASTFLAG(S));
         }
+        lcol = l;
       } else {
         if (SUNModifiedGS(V, Hes, l+1, l_max, &(Hes[l+1][l])) != 0) {
           *zeroguess  = SUNFALSE;
           LASTFLAG(S) = SUNLS_GS_FAIL;
           return(LASTFLAG(S));
         }
+        lcol = l;
       }
 
+      (*nli)++;
+
+      krydim = lcol + 1;
+
       /* Update the QR factorization of Hes. */
-      if(SUNQRfact(krydim, Hes, givens, l) != 0 ) {
+      if(SUNQRfact(krydim, Hes, givens, lcol) != 0 ) {
         *zeroguess  = SUNFALSE;
         LASTFLAG(S) = SUNLS_QRFACT_FAIL;
         return(LASTFLAG(S));
       }
 
       /* Update residual norm estimate; break if convergence test passes. */
-      rotation_product *= givens[2*l+1];
+      rotation_product *= givens[2*lcol+1];
       *res_norm = rho = SUNRabs(rotation_product*r_norm);
 
 #if SUNDIALS_LOGGING_LEVEL >= SUNDIALS_LOGGING_INFO
@@ -623,8 +653,10 @@ int SUNLinSolSolve_SPFGMR(SUNLinearSolver S, SUNMatrix A, N_Vector x,
 
       if (rho <= delta) { converged = SUNTRUE; break; }
 
-      /* Normalize V[l+1] with norm value from the Gram-Schmidt routine. */
-      N_VScale(ONE/Hes[l+1][l], V[l+1], V[l+1]);
+      /* Normalize V[l+1] with norm value from the Gram-Schmidt routine,
+         DCGS2 normalizes the vector in the next step. */
+      if (gstype != SUN_DCGS2_GS)
+        N_VScale(ONE/Hes[l+1][l], V[l+1], V[l+1]);
     }
 
     /* Inner loop is done.  Compute the new correction vector xcor. */
@@ -756,7 +788,7 @@ int SUNLinSolSpace_SPFGMR(SUNLinearSolver S,
     N_VSpace(SPFGMR_CONTENT(S)->vtemp, &lrw1, &liw1);
   else
     lrw1 = liw1 = 0;
-  *lenrwLS = lrw1*(2*maxl + 4) + maxl*(maxl + 5) + 2;
+  *lenrwLS = lrw1*(2*maxl + 4) + maxl*(maxl + 6) + 3;
   *leniwLS = liw1*(2*maxl + 4);
   return(SUNLS_SUCCESS);
 }
@@ -25,6 +25,7 @@
 
 #include "sundials_context_impl.h"
 #include "sundials_logger_impl.h"
+#include "sundials_iterative_impl.h"
 
 #define ZERO RCONST(0.0)
 #define ONE  RCONST(1.0)
@@ -38,6 +39,10 @@
 #define SPGMR_CONTENT(S)  ( (SUNLinearSolverContent_SPGMR)(S->content) )
 #define LASTFLAG(S)       ( SPGMR_CONTENT(S)->last_flag )
 
+/* Private function prototypes */
+static int spgmrAllocQR(SUNLinearSolverContent_SPGMR content);
+static void spgmrFreeQR(SUNLinearSolverContent_SPGMR content);
+
 /*
  * -----------------------------------------------------------------
  * exported functions
@@ -117,6 +122,7 @@ SUNLinearSolver SUNLinSol_SPGMR(N_Vector y, int pretype, int maxl, SUNContext su
   content->PData        = NULL;
   content->V            = NULL;
   content->Hes          = NULL;
+  content->QR           = NULL;
   content->givens       = NULL;
   content->yg           = NULL;
   content->cv           = NULL;
@@ -166,15 +172,22 @@ int SUNLinSol_SPGMRSetPrecType(SUNLinearSolver S, int pretype)
 int SUNLinSol_SPGMRSetGSType(SUNLinearSolver S, int gstype)
 {
   /* Check for legal gstype */
-  if ((gstype != SUN_MODIFIED_GS) && (gstype != SUN_CLASSICAL_GS)) {
+  if ((gstype != SUN_MODIFIED_GS) && (gstype != SUN_CLASSICAL_GS) &&
+      (gstype != SUN_DCGS2_GS)) {
     return(SUNLS_ILL_INPUT);
   }
 
   /* Check for non-NULL SUNLinearSolver */
   if (S == NULL) return(SUNLS_MEM_NULL);
 
-  /* Set pretype */
+  /* Set gstype, the QR copy of Hes is only needed with DCGS2 (allocate it
+     here if the solver was already initialized) */
   SPGMR_CONTENT(S)->gstype = gstype;
+  if (gstype != SUN_DCGS2_GS) {
+    spgmrFreeQR(SPGMR_CONTENT(S));
+  } else if (SPGMR_CONTENT(S)->Hes != NULL) {
+    if (spgmrAllocQR(SPGMR_CONTENT(S))) return(SUNLS_MEM_FAIL);
+  }
   return(SUNLS_SUCCESS);
 }
 
@@ -274,6 +287,17 @@ int SUNLinSolInitialize_SPGMR(SUNLinearSolver S)
     }
   }
 
+  /*   QR factorization of Hes, DCGS2 needs the unfactored columns of Hes
+       to correct the projection in the next step so it factors a copy */
+  if (content->gstype == SUN_DCGS2_GS) {
+    if (spgmrAllocQR(content)) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  } else {
+    spgmrFreeQR(content);
+  }
+
   /*   Givens rotation components */
   if (content->givens == NULL) {
     content->givens = (realtype *) malloc(2*content->maxl*sizeof(realtype));
@@ -292,9 +316,9 @@ int SUNLinSolInitialize_SPGMR(SUNLinearSolver S)
     }
   }
 
-  /*    cv vector for fused vector ops */
+  /*    cv vector for fused vector ops (and the DCGS2 reduction buffer) */
   if (content->cv == NULL) {
-    content->cv = (realtype *) malloc((content->maxl+1)*sizeof(realtype));
+    content->cv = (realtype *) malloc(2*(content->maxl+1)*sizeof(realtype));
     if (content->cv == NULL) {
       content->last_flag = SUNLS_MEM_FAIL;
       return(SUNLS_MEM_FAIL);
@@ -398,11 +422,12 @@ int SUNLinSolSolve_SPGMR(SUNLinearSolver S, SUNMatrix A, N_Vector x,
 {
   /* local data and shortcut variables */
   N_Vector *V, xcor, vtemp, s1, s2;
-  realtype **Hes, *givens, *yg, *res_norm;
+  realtype **Hes, **QR, *givens, *yg, *res_norm;
   realtype beta, rotation_product, r_norm, s_product, rho;
   booleantype preOnLeft, preOnRight, scale2, scale1, converged;
   booleantype *zeroguess;
   int i, j, k, l, l_plus_1, l_max, krydim, ier, ntries, max_restarts, gstype;
+  int lcol, delay;
   int *nli;
   void *A_data, *P_data;
   SUNATimesFn atimes;
@@ -421,8 +446,10 @@ int SUNLinSolSolve_SPGMR(SUNLinearSolver S, SUNMatrix A, N_Vector x,
   l_max        = SPGMR_CONTENT(S)->maxl;
   max_restarts = SPGMR_CONTENT(S)->max_restarts;
   gstype       = SPGMR_CONTENT(S)->gstype;
+  delay        = (gstype == SUN_DCGS2_GS) ? 1 : 0;
   V            = SPGMR_CONTENT(S)->V;
   Hes          = SPGMR_CONTENT(S)->Hes;
+  QR           = (gstype == SUN_DCGS2_GS) ? SPGMR_CONTENT(S)->QR : Hes;
   givens       = SPGMR_CONTENT(S)->givens;
   xcor         = SPGMR_CONTENT(S)->xcor;
   yg           = SPGMR_CONTENT(S)->yg;
@@ -547,83 +574,111 @@ int SUNLinSolSolve_SPGMR(SUNLinearSolver S, SUNMatrix A, N_Vector x,
     rotation_product = ONE;
     N_VScale(ONE/r_norm, V[0], V[0]);
 
-    /* Inner loop: generate Krylov sequence and Arnoldi basis */
-    for (l=0; l<l_max; l++) {
-      (*nli)++;
-      krydim = l_plus_1 = l + 1;
-
-      /* Generate A-tilde V[l], where A-tilde = s1 P1_inv A P2_inv s2_inv */
-
-      /*   Apply right scaling: vtemp = s2_inv V[l] */
-      if (scale2) N_VDiv(V[l], s2, vtemp);
-      else N_VScale(ONE, V[l], vtemp);
+    /* Inner loop: generate Krylov sequence and Arnoldi basis. With DCGS2
+       the orthogonalization of each column is completed one iteration
+       later, so one extra pass (without applying A) finishes the last
+       column. */
+    for (l=0; l<l_max+delay; l++) {
+      l_plus_1 = l + 1;
+
+      if (l < l_max) {
+
+        /* Generate A-tilde V[l], where A-tilde = s1 P1_inv A P2_inv s2_inv */
+
+        /*   Apply right scaling: vtemp = s2_inv V[l] */
+        if (scale2) N_VDiv(V[l], s2, vtemp);
+        else N_VScale(ONE, V[l], vtemp);
+
+        /*   Apply right preconditioner: vtemp = P2_inv s2_inv V[l] */
+        if (preOnRight) {
+          N_VScale(ONE, vtemp, V[l_plus_1]);
+          ier = psolve(P_data, V[l_plus_1], vtemp, delta, SUN_PREC_RIGHT);
+          if (ier != 0) {
+            *zeroguess  = SUNFALSE;
+            LASTFLAG(S) = (ier < 0) ?
+              SUNLS_PSOLVE_FAIL_UNREC : SUNLS_PSOLVE_FAIL_REC;
+            return(LASTFLAG(S));
+          }
+        }
 
-      /*   Apply right preconditioner: vtemp = P2_inv s2_inv V[l] */
-      if (preOnRight) {
-        N_VScale(ONE, vtemp, V[l_plus_1]);
-        ier = psolve(P_data, V[l_plus_1], vtemp, delta, SUN_PREC_RIGHT);
+        /* Apply A: V[l+1] = A P2_inv s2_inv V[l] */
+        ier = atimes( A_data, vtemp, V[l_plus_1] );
         if (ier != 0) {
           *zeroguess  = SUNFALSE;
           LASTFLAG(S) = (ier < 0) ?
-            SUNLS_PSOLVE_FAIL_UNREC : SUNLS_PSOLVE_FAIL_REC;
+            SUNLS_ATIMES_FAIL_UNREC : SUNLS_ATIMES_FAIL_REC;
           return(LASTFLAG(S));
         }
-      }
 
-      /* Apply A: V[l+1] = A P2_inv s2_inv V[l] */
-      ier = atimes( A_data, vtemp, V[l_plus_1] );
-      if (ier != 0) {
-        *zeroguess  = SUNFALSE;
-        LASTFLAG(S) = (ier < 0) ?
-          SUNLS_ATIMES_FAIL_UNREC : SUNLS_ATIMES_FAIL_REC;
-        return(LASTFLAG(S));
+        /* Apply left preconditioning: vtemp = P1_inv A P2_inv s2_inv V[l] */
+        if (preOnLeft) {
+          ier = psolve(P_data, V[l_plus_1], vtemp, delta, SUN_PREC_LEFT);
+          if (ier != 0) {
+            *zeroguess  = SUNFALSE;
+            LASTFLAG(S) = (ier < 0) ?
+              SUNLS_PSOLVE_FAIL_UNREC : SUNLS_PSOLVE_FAIL_REC;
+            return(LASTFLAG(S));
+          }
+        } else {
+          N_VScale(ONE, V[l_plus_1], vtemp);
+        }
+
+        /* Apply left scaling: V[l+1] = s1 P1_inv A P2_inv s2_inv V[l] */
+        if (scale1) {
+          N_VProd(s1, vtemp, V[l_plus_1]);
+        } else {
+          N_VScale(ONE, vtemp, V[l_plus_1]);
+        }
       }
 
-      /* Apply left preconditioning: vtemp = P1_inv A P2_inv s2_inv V[l] */
-      if (preOnLeft) {
-        ier = psolve(P_data, V[l_plus_1], vtemp, delta, SUN_PREC_LEFT);
+      /*  Orthogonalize V[l+1] against previous V[i]: V[l+1] = w_tilde */
+      if (gstype == SUN_DCGS2_GS) {
+        if (l < l_max)
+          ier = sunDelayedClassicalGS(V, Hes, l_plus_1, SUNTRUE, cv, Xv);
+        else
+          ier = sunDelayedClassicalGSFinalize(V, Hes, l, cv, Xv);
         if (ier != 0) {
           *zeroguess  = SUNFALSE;
-          LASTFLAG(S) = (ier < 0) ?
-            SUNLS_PSOLVE_FAIL_UNREC : SUNLS_PSOLVE_FAIL_REC;
+          LASTFLAG(S) = SUNLS_GS_FAIL;
           return(LASTFLAG(S));
         }
-      } else {
-        N_VScale(ONE, V[l_plus_1], vtemp);
-      }
-
-      /* Apply left scaling: V[l+1] = s1 P1_inv A P2_inv s2_inv V[l] */
-      if (scale1) {
-        N_VProd(s1, vtemp, V[l_plus_1]);
-      } else {
-        N_VScale(ONE, vtemp, V[l_plus_1]);
-      }
 
-      /*  Orthogonalize V[l+1] against previous V[i]: V[l+1] = w_tilde */
-      if (gstype == SUN_CLASSICAL_GS) {
+        /* Column l-1 of Hes is now complete, there is nothing to test yet
+           after the first step */
+        if (l == 0) continue;
+        lcol = l - 1;
+      } else if (gstype == SUN_CLASSICAL_GS) {
         if (SUNClassicalGS(V, Hes, l_plus_1, l_max, &(Hes[l_plus_1][l]),
                            cv, Xv) != 0) {
           *zeroguess  = SUNFALSE;
           LASTFLAG(S) = SUNLS_GS_FAIL;
           return(LASTFLAG(S));
         }
+        lcol = l;
       } else {
         if (SUNModifiedGS(V, Hes, l_plus_1, l_max, &(Hes[l_plus_1][l])) != 0) {
           *zeroguess  = SUNFALSE;
           LASTFLAG(S) = SUNLS_GS_FAIL;
           return(LASTFLAG(S));
         }
+        lcol = l;
       }
 
+      (*nli)++;
+      krydim = lcol + 1;
+
       /*  Update the QR factorization of Hes */
-      if(SUNQRfact(krydim, Hes, givens, l) != 0 ) {
+      if (QR != Hes)
+        for (i=0; i<=krydim; i++) QR[i][lcol] = Hes[i][lcol];
+
+      if(SUNQRfact(krydim, QR, givens, lcol) != 0 ) {
         *zeroguess  = SUNFALSE;
         LASTFLAG(S) = SUNLS_QRFACT_FAIL;
         return(LASTFLAG(S));
       }
 
       /*  Update residual norm estimate; break if convergence test passes */
-      rotation_product *= givens[2*l+1];
+      rotation_product *= givens[2*lcol+1];
       *res_norm = rho = SUNRabs(rotation_product*r_norm);
 
 #if SUNDIALS_LOGGING_LEVEL >= SUNDIALS_LOGGING_INFO
@@ -642,8 +697,10 @@ int SUNLinSolSolve_SPGMR(SUNLinearSolver S, SUNMatrix A, N_Vector x,
 
       if (rho <= delta) { converged = SUNTRUE; break; }
 
-      /* Normalize V[l+1] with norm value from the Gram-Schmidt routine */
-      N_VScale(ONE/Hes[l_plus_1][l], V[l_plus_1], V[l_plus_1]);
+      /* Normalize V[l+1] with norm value from the Gram-Schmidt routine,
+         DCGS2 normalizes the vector in the next step */
+      if (gstype != SUN_DCGS2_GS)
+        N_VScale(ONE/Hes[l_plus_1][l], V[l_plus_1], V[l_plus_1]);
     }
 
     /* Inner loop is done.  Compute the new correction vector xcor */
@@ -651,7 +708,7 @@ int SUNLinSolSolve_SPGMR(SUNLinearSolver S, SUNMatrix A, N_Vector x,
     /*   Construct g, then solve for y */
     yg[0] = r_norm;
     for (i=1; i<=krydim; i++) yg[i]=ZERO;
-    if (SUNQRsol(krydim, Hes, givens, yg) != 0) {
+    if (SUNQRsol(krydim, QR, givens, yg) != 0) {
       *zeroguess  = SUNFALSE;
       LASTFLAG(S) = SUNLS_QRSOL_FAIL;
       return(LASTFLAG(S));
@@ -809,7 +866,8 @@ int SUNLinSolSpace_SPGMR(SUNLinearSolver S,
     N_VSpace(SPGMR_CONTENT(S)->vtemp, &lrw1, &liw1);
   else
     lrw1 = liw1 = 0;
-  *lenrwLS = lrw1*(maxl + 5) + maxl*(maxl + 5) + 2;
+  *lenrwLS = lrw1*(maxl + 5) + maxl*(maxl + 6) + 3;
+  if (SPGMR_CONTENT(S)->QR) *lenrwLS += maxl*(maxl + 1);
   *leniwLS = liw1*(maxl + 5);
   return(SUNLS_SUCCESS);
 }
@@ -845,6 +903,7 @@ int SUNLinSolFree_SPGMR(SUNLinearSolver S)
       free(SPGMR_CONTENT(S)->Hes);
       SPGMR_CONTENT(S)->Hes = NULL;
     }
+    spgmrFreeQR(SPGMR_CONTENT(S));
     if (SPGMR_CONTENT(S)->givens) {
       free(SPGMR_CONTENT(S)->givens);
       SPGMR_CONTENT(S)->givens = NULL;
@@ -897,3 +956,46 @@ int SUNLinSolSetPrintLevel_SPGMR(SUNLinearSolver S,
 
   return(SUNLS_SUCCESS);
 }
+
+
+/*
+ * -----------------------------------------------------------------
+ * private functions
+ * -----------------------------------------------------------------
+ */
+
+/* Allocate the copy of Hes factored with DCGS2 (if not already allocated) */
+
+static int spgmrAllocQR(SUNLinearSolverContent_SPGMR content)
+{
+  int k;
+
+  if (content->QR != NULL) return(0);
+
+  content->QR = (realtype **) calloc(content->maxl+1, sizeof(realtype *));
+  if (content->QR == NULL) return(-1);
+
+  for (k=0; k<=content->maxl; k++) {
+    content->QR[k] = (realtype *) malloc(content->maxl*sizeof(realtype));
+    if (content->QR[k] == NULL) {
+      spgmrFreeQR(content);
+      return(-1);
+    }
+  }
+
+  return(0);
+}
+
+/* Free the copy of Hes factored with DCGS2 */
+
+static void spgmrFreeQR(SUNLinearSolverContent_SPGMR content)
+{
+  int k;
+
+  if (content->QR == NULL) return;
+
+  for (k=0; k<=content->maxl; k++)
+    if (content->QR[k]) free(content->QR[k]);
+  free(content->QR);
+  content->QR = NULL;
+}
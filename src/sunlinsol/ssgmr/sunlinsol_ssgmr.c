@@ -0,0 +1,1468 @@
+/* -----------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------
+ * This is the implementation file for the SSGMR implementation of
+ * the SUNLINSOL package.
+ *
+ * Each GMRES cycle is built in blocks of s columns. For a block
+ * starting at the orthonormal vector v_j, the Newton basis
+ *
+ *   z_0 = v_j,  z_{t+1} = ((A - theta_t I) z_t + c_t z_{t-1}) / sigma
+ *
+ * is generated with s matrix-vector products and no inner products,
+ * where the shifts theta_t are Leja ordered Ritz values of the
+ * previous cycle (complex conjugate pairs use the real three-term
+ * form). The block is orthogonalized against the existing basis and
+ * itself with two passes of block classical Gram-Schmidt, the
+ * second using a Cholesky QR of the projected Gram matrix. When the
+ * vector supports the local dot product and all-reduce operations
+ * all inner products of a pass are combined into a single global
+ * reduction. The Hessenberg matrix columns of the block are then
+ * recovered from the change of basis and the GMRES least squares
+ * problem is updated one column at a time as in SPGMR.
+ *
+ * Before Ritz values are available (the first cycle of the first
+ * solve) blocks of size one are used, i.e., GMRES with classical
+ * Gram-Schmidt and reorthogonalization.
+ * -----------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <sunlinsol/sunlinsol_ssgmr.h>
+#include <sundials/sundials_math.h>
+
+#include "sundials_context_impl.h"
+#include "sundials_logger_impl.h"
+#include "sundials_iterative_impl.h"
+
+#define ZERO    RCONST(0.0)
+#define ONE     RCONST(1.0)
+
+/*
+ * -----------------------------------------------------------------
+ * SSGMR solver structure accessibility macros:
+ * -----------------------------------------------------------------
+ */
+
+#define SSGMR_CONTENT(S)  ( (SUNLinearSolverContent_SSGMR)(S->content) )
+#define LASTFLAG(S)       ( SSGMR_CONTENT(S)->last_flag )
+
+/*
+ * -----------------------------------------------------------------
+ * private functions
+ * -----------------------------------------------------------------
+ */
+
+static int ssgmrATilde(SUNLinearSolver S, N_Vector x, N_Vector y,
+                       realtype delta);
+static int ssgmrBasis(SUNLinearSolver S, int j0, int s, realtype delta);
+static int ssgmrDots(SUNLinearSolver S, int j0, int s, int pass);
+static int ssgmrBlockOrth(SUNLinearSolver S, int j0, int s, int *nacc);
+static void ssgmrHessenberg(SUNLinearSolver S, int j0, int nacc);
+static void ssgmrShifts(SUNLinearSolver S, int s);
+static void ssgmrUpdateRitz(SUNLinearSolver S, int krydim);
+static void ssgmrLeja(int n, realtype *re, realtype *im, realtype *work);
+
+/*
+ * -----------------------------------------------------------------
+ * exported functions
+ * -----------------------------------------------------------------
+ */
+
+/* ----------------------------------------------------------------------------
+ * Function to create a new SSGMR linear solver
+ */
+
+SUNLinearSolver SUNLinSol_SSGMR(N_Vector y, int pretype, int maxl, SUNContext sunctx)
+{
+  SUNLinearSolver S;
+  SUNLinearSolverContent_SSGMR content;
+
+  /* check for legal pretype and maxl values; if illegal use defaults */
+  if ((pretype != SUN_PREC_NONE)  && (pretype != SUN_PREC_LEFT) &&
+      (pretype != SUN_PREC_RIGHT) && (pretype != SUN_PREC_BOTH))
+    pretype = SUN_PREC_NONE;
+  if (maxl <= 0)
+    maxl = SUNSSGMR_MAXL_DEFAULT;
+
+  /* check that the supplied N_Vector supports all requisite operations */
+  if ( (y->ops->nvclone == NULL) || (y->ops->nvdestroy == NULL) ||
+       (y->ops->nvlinearsum == NULL) || (y->ops->nvconst == NULL) ||
+       (y->ops->nvprod == NULL) || (y->ops->nvdiv == NULL) ||
+       (y->ops->nvscale == NULL) || (y->ops->nvdotprod == NULL) )
+    return(NULL);
+
+  /* Create linear solver */
+  S = NULL;
+  S = SUNLinSolNewEmpty(sunctx);
+  if (S == NULL) return(NULL);
+
+  /* Attach operations */
+  S->ops->gettype           = SUNLinSolGetType_SSGMR;
+  S->ops->getid             = SUNLinSolGetID_SSGMR;
+  S->ops->setatimes         = SUNLinSolSetATimes_SSGMR;
+  S->ops->setpreconditioner = SUNLinSolSetPreconditioner_SSGMR;
+  S->ops->setscalingvectors = SUNLinSolSetScalingVectors_SSGMR;
+  S->ops->setzeroguess      = SUNLinSolSetZeroGuess_SSGMR;
+  S->ops->initialize        = SUNLinSolInitialize_SSGMR;
+  S->ops->setup             = SUNLinSolSetup_SSGMR;
+  S->ops->solve             = SUNLinSolSolve_SSGMR;
+  S->ops->numiters          = SUNLinSolNumIters_SSGMR;
+  S->ops->resnorm           = SUNLinSolResNorm_SSGMR;
+  S->ops->resid             = SUNLinSolResid_SSGMR;
+  S->ops->lastflag          = SUNLinSolLastFlag_SSGMR;
+  S->ops->space             = SUNLinSolSpace_SSGMR;
+  S->ops->free              = SUNLinSolFree_SSGMR;
+
+  /* Create content */
+  content = NULL;
+  content = (SUNLinearSolverContent_SSGMR) malloc(sizeof *content);
+  if (content == NULL) { SUNLinSolFree(S); return(NULL); }
+
+  /* Attach content */
+  S->content = content;
+
+  /* Fill content */
+  content->last_flag    = 0;
+  content->maxl         = maxl;
+  content->pretype      = pretype;
+  content->steps        = SUNSSGMR_STEPS_DEFAULT;
+  content->max_restarts = SUNSSGMR_MAXRS_DEFAULT;
+  content->zeroguess    = SUNFALSE;
+  content->numiters     = 0;
+  content->resnorm      = ZERO;
+  content->xcor         = NULL;
+  content->vtemp        = NULL;
+  content->s1           = NULL;
+  content->s2           = NULL;
+  content->ATimes       = NULL;
+  content->ATData       = NULL;
+  content->Psetup       = NULL;
+  content->Psolve       = NULL;
+  content->PData        = NULL;
+  content->V            = NULL;
+  content->Hes          = NULL;
+  content->QR           = NULL;
+  content->givens       = NULL;
+  content->yg           = NULL;
+  content->cv           = NULL;
+  content->Xv           = NULL;
+  content->dots         = NULL;
+  content->C            = NULL;
+  content->R            = NULL;
+  content->B            = NULL;
+  content->work         = NULL;
+  content->nritz        = 0;
+  content->ritz_re      = NULL;
+  content->ritz_im      = NULL;
+  content->ritz_scale   = ONE;
+  content->nreduce      = 0;
+
+  /* use a single reduction per block when the vector supports it */
+  content->sb = (y->ops->nvdotprodmultilocal != NULL) &&
+                (y->ops->nvdotprodmultiallreduce != NULL);
+
+  /* Allocate content */
+  content->xcor = N_VClone(y);
+  if (content->xcor == NULL) { SUNLinSolFree(S); return(NULL); }
+
+  content->vtemp = N_VClone(y);
+  if (content->vtemp == NULL) { SUNLinSolFree(S); return(NULL); }
+
+  return(S);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Function to set the type of preconditioning for SSGMR to use
+ */
+
+int SUNLinSol_SSGMRSetPrecType(SUNLinearSolver S, int pretype)
+{
+  /* Check for legal pretype */
+  if ((pretype != SUN_PREC_NONE)  && (pretype != SUN_PREC_LEFT) &&
+      (pretype != SUN_PREC_RIGHT) && (pretype != SUN_PREC_BOTH)) {
+    return(SUNLS_ILL_INPUT);
+  }
+
+  /* Check for non-NULL SUNLinearSolver */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+
+  /* Set pretype */
+  SSGMR_CONTENT(S)->pretype = pretype;
+  return(SUNLS_SUCCESS);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Function to set the number of basis vectors generated per block
+ */
+
+int SUNLinSol_SSGMRSetSteps(SUNLinearSolver S, int steps)
+{
+  /* Illegal steps implies use of default value */
+  if (steps <= 0)
+    steps = SUNSSGMR_STEPS_DEFAULT;
+
+  /* Check for non-NULL SUNLinearSolver */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+
+  /* Set steps */
+  SSGMR_CONTENT(S)->steps = steps;
+  return(SUNLS_SUCCESS);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Function to set the maximum number of GMRES restarts to allow
+ */
+
+int SUNLinSol_SSGMRSetMaxRestarts(SUNLinearSolver S, int maxrs)
+{
+  /* Illegal maxrs implies use of default value */
+  if (maxrs < 0)
+    maxrs = SUNSSGMR_MAXRS_DEFAULT;
+
+  /* Check for non-NULL SUNLinearSolver */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+
+  /* Set max_restarts */
+  SSGMR_CONTENT(S)->max_restarts = maxrs;
+  return(SUNLS_SUCCESS);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Function to get the number of global reductions performed
+ */
+
+int SUNLinSol_SSGMRGetNumReductions(SUNLinearSolver S, long int *nreduce)
+{
+  /* Check for non-NULL SUNLinearSolver */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+
+  *nreduce = SSGMR_CONTENT(S)->nreduce;
+  return(SUNLS_SUCCESS);
+}
+
+
+/*
+ * -----------------------------------------------------------------
+ * implementation of linear solver operations
+ * -----------------------------------------------------------------
+ */
+
+SUNLinearSolver_Type SUNLinSolGetType_SSGMR(SUNLinearSolver S)
+{
+  return(SUNLINEARSOLVER_ITERATIVE);
+}
+
+
+SUNLinearSolver_ID SUNLinSolGetID_SSGMR(SUNLinearSolver S)
+{
+  return(SUNLINEARSOLVER_SSGMR);
+}
+
+
+int SUNLinSolInitialize_SSGMR(SUNLinearSolver S)
+{
+  int k, maxl;
+  SUNLinearSolverContent_SSGMR content;
+
+  /* set shortcut to SSGMR memory structure */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+  content = SSGMR_CONTENT(S);
+  maxl    = content->maxl;
+
+  /* ensure valid options */
+  if (content->max_restarts < 0)
+    content->max_restarts = SUNSSGMR_MAXRS_DEFAULT;
+
+  if (content->steps <= 0)
+    content->steps = SUNSSGMR_STEPS_DEFAULT;
+
+  if (content->ATimes == NULL) {
+    LASTFLAG(S) = SUNLS_ATIMES_NULL;
+    return(LASTFLAG(S));
+  }
+
+  if ( (content->pretype != SUN_PREC_LEFT) &&
+       (content->pretype != SUN_PREC_RIGHT) &&
+       (content->pretype != SUN_PREC_BOTH) )
+    content->pretype = SUN_PREC_NONE;
+
+  if ((content->pretype != SUN_PREC_NONE) && (content->Psolve == NULL)) {
+    LASTFLAG(S) = SUNLS_PSOLVE_NULL;
+    return(LASTFLAG(S));
+  }
+
+  /* allocate solver-specific memory (where the size depends on the
+     choice of maxl) here, the block arrays are sized for the largest
+     possible block (maxl columns) so the number of steps may be changed
+     at any time */
+
+  /*   Krylov subspace vectors */
+  if (content->V == NULL) {
+    content->V = N_VCloneVectorArray(maxl+1, content->vtemp);
+    if (content->V == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  /*   Hessenberg matrix Hes and its QR factorization */
+  if (content->Hes == NULL) {
+    content->Hes = (realtype **) calloc(maxl+1, sizeof(realtype *));
+    if (content->Hes == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+
+    for (k=0; k<=maxl; k++) {
+      content->Hes[k] = (realtype *) malloc(maxl*sizeof(realtype));
+      if (content->Hes[k] == NULL) {
+        content->last_flag = SUNLS_MEM_FAIL;
+        return(SUNLS_MEM_FAIL);
+      }
+    }
+  }
+
+  if (content->QR == NULL) {
+    content->QR = (realtype **) calloc(maxl+1, sizeof(realtype *));
+    if (content->QR == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+
+    for (k=0; k<=maxl; k++) {
+      content->QR[k] = (realtype *) malloc(maxl*sizeof(realtype));
+      if (content->QR[k] == NULL) {
+        content->last_flag = SUNLS_MEM_FAIL;
+        return(SUNLS_MEM_FAIL);
+      }
+    }
+  }
+
+  /*   Givens rotation components */
+  if (content->givens == NULL) {
+    content->givens = (realtype *) malloc(2*maxl*sizeof(realtype));
+    if (content->givens == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  /*    y and g vectors */
+  if (content->yg == NULL) {
+    content->yg = (realtype *) malloc((maxl+1)*sizeof(realtype));
+    if (content->yg == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  /*    cv vector for fused vector ops */
+  if (content->cv == NULL) {
+    content->cv = (realtype *) malloc((maxl+1)*sizeof(realtype));
+    if (content->cv == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  /*    Xv vector for fused vector ops */
+  if (content->Xv == NULL) {
+    content->Xv = (N_Vector *) malloc((maxl+1)*sizeof(N_Vector));
+    if (content->Xv == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  /*    inner products of a block */
+  if (content->dots == NULL) {
+    content->dots = (realtype *) malloc(maxl*(maxl+1)*sizeof(realtype));
+    if (content->dots == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  /*    block projection coefficients C, Cholesky factor R, basis change
+        matrix B, and work array */
+  if (content->C == NULL) {
+    content->C = (realtype *) malloc(maxl*(maxl+1)*sizeof(realtype));
+    if (content->C == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  if (content->R == NULL) {
+    content->R = (realtype *) malloc(maxl*maxl*sizeof(realtype));
+    if (content->R == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  if (content->B == NULL) {
+    content->B = (realtype *) malloc(maxl*(maxl+1)*sizeof(realtype));
+    if (content->B == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  if (content->work == NULL) {
+    content->work = (realtype *) malloc(maxl*(maxl+1)*sizeof(realtype));
+    if (content->work == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  /*    Ritz values used as Newton basis shifts */
+  if (content->ritz_re == NULL) {
+    content->ritz_re = (realtype *) malloc(maxl*sizeof(realtype));
+    if (content->ritz_re == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  if (content->ritz_im == NULL) {
+    content->ritz_im = (realtype *) malloc(maxl*sizeof(realtype));
+    if (content->ritz_im == NULL) {
+      content->last_flag = SUNLS_MEM_FAIL;
+      return(SUNLS_MEM_FAIL);
+    }
+  }
+
+  /* discard shifts from a previous problem */
+  content->nritz      = 0;
+  content->ritz_scale = ONE;
+
+  /* return with success */
+  content->last_flag = SUNLS_SUCCESS;
+  return(SUNLS_SUCCESS);
+}
+
+
+int SUNLinSolSetATimes_SSGMR(SUNLinearSolver S, void* ATData,
+                             SUNATimesFn ATimes)
+{
+  /* set function pointers to integrator-supplied ATimes routine
+     and data, and return with success */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+  SSGMR_CONTENT(S)->ATimes = ATimes;
+  SSGMR_CONTENT(S)->ATData = ATData;
+  LASTFLAG(S) = SUNLS_SUCCESS;
+  return(LASTFLAG(S));
+}
+
+
+int SUNLinSolSetPreconditioner_SSGMR(SUNLinearSolver S, void* PData,
+                                     SUNPSetupFn Psetup, SUNPSolveFn Psolve)
+{
+  /* set function pointers to integrator-supplied Psetup and PSolve
+     routines and data, and return with success */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+  SSGMR_CONTENT(S)->Psetup = Psetup;
+  SSGMR_CONTENT(S)->Psolve = Psolve;
+  SSGMR_CONTENT(S)->PData = PData;
+  LASTFLAG(S) = SUNLS_SUCCESS;
+  return(LASTFLAG(S));
+}
+
+
+int SUNLinSolSetScalingVectors_SSGMR(SUNLinearSolver S, N_Vector s1,
+                                     N_Vector s2)
+{
+  /* set N_Vector pointers to integrator-supplied scaling vectors,
+     and return with success */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+  SSGMR_CONTENT(S)->s1 = s1;
+  SSGMR_CONTENT(S)->s2 = s2;
+  LASTFLAG(S) = SUNLS_SUCCESS;
+  return(LASTFLAG(S));
+}
+
+
+int SUNLinSolSetZeroGuess_SSGMR(SUNLinearSolver S, booleantype onff)
+{
+  /* set flag indicating a zero initial guess */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+  SSGMR_CONTENT(S)->zeroguess = onff;
+  LASTFLAG(S) = SUNLS_SUCCESS;
+  return(LASTFLAG(S));
+}
+
+
+int SUNLinSolSetup_SSGMR(SUNLinearSolver S, SUNMatrix A)
+{
+  int ier;
+  SUNPSetupFn Psetup;
+  void* PData;
+
+  /* Set shortcuts to SSGMR memory structures */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+  Psetup = SSGMR_CONTENT(S)->Psetup;
+  PData = SSGMR_CONTENT(S)->PData;
+
+  /* no solver-specific setup is required, but if user-supplied
+     Psetup routine exists, call that here */
+  if (Psetup != NULL) {
+    ier = Psetup(PData);
+    if (ier != 0) {
+      LASTFLAG(S) = (ier < 0) ?
+        SUNLS_PSET_FAIL_UNREC : SUNLS_PSET_FAIL_REC;
+      return(LASTFLAG(S));
+    }
+  }
+
+  /* return with success */
+  return(SUNLS_SUCCESS);
+}
+
+
+int SUNLinSolSolve_SSGMR(SUNLinearSolver S, SUNMatrix A, N_Vector x,
+                         N_Vector b, realtype delta)
+{
+  /* local data and shortcut variables */
+  N_Vector *V, xcor, vtemp, s1, s2;
+  realtype **Hes, **QR, *givens, *yg, *res_norm;
+  realtype beta, rotation_product, r_norm, s_product, rho;
+  booleantype preOnLeft, preOnRight, scale2, scale1, converged;
+  booleantype *zeroguess;
+  int i, j, k, l, j0, s, nacc, ncols, l_max, krydim, ier, ntries;
+  int max_restarts;
+  int *nli;
+  void *A_data, *P_data;
+  SUNATimesFn atimes;
+  SUNPSolveFn psolve;
+
+  /* local shortcuts for fused vector operations */
+  realtype* cv;
+  N_Vector* Xv;
+
+  /* Initialize some variables */
+  krydim = 0;
+
+  /* Make local shorcuts to solver variables. */
+  if (S == NULL) return(SUNLS_MEM_NULL);
+  l_max        = SSGMR_CONTENT(S)->maxl;
+  max_restarts = SSGMR_CONTENT(S)->max_restarts;
+  V            = SSGMR_CONTENT(S)->V;
+  Hes          = SSGMR_CONTENT(S)->Hes;
+  QR           = SSGMR_CONTENT(S)->QR;
+  givens       = SSGMR_CONTENT(S)->givens;
+  xcor         = SSGMR_CONTENT(S)->xcor;
+  yg           = SSGMR_CONTENT(S)->yg;
+  vtemp        = SSGMR_CONTENT(S)->vtemp;
+  s1           = SSGMR_CONTENT(S)->s1;
+  s2           = SSGMR_CONTENT(S)->s2;
+  A_data       = SSGMR_CONTENT(S)->ATData;
+  P_data       = SSGMR_CONTENT(S)->PData;
+  atimes       = SSGMR_CONTENT(S)->ATimes;
+  psolve       = SSGMR_CONTENT(S)->Psolve;
+  zeroguess    = &(SSGMR_CONTENT(S)->zeroguess);
+  nli          = &(SSGMR_CONTENT(S)->numiters);
+  res_norm     = &(SSGMR_CONTENT(S)->resnorm);
+  cv           = SSGMR_CONTENT(S)->cv;
+  Xv           = SSGMR_CONTENT(S)->Xv;
+
+  /* Initialize counters and convergence flag */
+  *nli = 0;
+  converged = SUNFALSE;
+
+  /* Set booleantype flags for internal solver options */
+  preOnLeft  = ( (SSGMR_CONTENT(S)->pretype == SUN_PREC_LEFT) ||
+                 (SSGMR_CONTENT(S)->pretype == SUN_PREC_BOTH) );
+  preOnRight = ( (SSGMR_CONTENT(S)->pretype == SUN_PREC_RIGHT) ||
+                 (SSGMR_CONTENT(S)->pretype == SUN_PREC_BOTH) );
+  scale1 = (s1 != NULL);
+  scale2 = (s2 != NULL);
+
+  /* Check if Atimes function has been set */
+  if (atimes == NULL) {
+    *zeroguess  = SUNFALSE;
+    LASTFLAG(S) = SUNLS_ATIMES_NULL;
+    return(LASTFLAG(S));
+  }
+
+  /* If preconditioning, check if psolve has been set */
+  if ((preOnLeft || preOnRight) && psolve == NULL) {
+    *zeroguess  = SUNFALSE;
+    LASTFLAG(S) = SUNLS_PSOLVE_NULL;
+    return(LASTFLAG(S));
+  }
+
+  /* Set vtemp and V[0] to initial (unscaled) residual r_0 = b - A*x_0 */
+  if (*zeroguess) {
+    N_VScale(ONE, b, vtemp);
+  } else {
+    ier = atimes(A_data, x, vtemp);
+    if (ier != 0) {
+      *zeroguess  = SUNFALSE;
+      LASTFLAG(S) = (ier < 0) ?
+        SUNLS_ATIMES_FAIL_UNREC : SUNLS_ATIMES_FAIL_REC;
+      return(LASTFLAG(S));
+    }
+    N_VLinearSum(ONE, b, -ONE, vtemp, vtemp);
+  }
+  N_VScale(ONE, vtemp, V[0]);
+
+  /* Apply left preconditioner and left scaling to V[0] = r_0 */
+  if (preOnLeft) {
+    ier = psolve(P_data, V[0], vtemp, delta, SUN_PREC_LEFT);
+    if (ier != 0) {
+      *zeroguess  = SUNFALSE;
+      LASTFLAG(S) = (ier < 0) ?
+        SUNLS_PSOLVE_FAIL_UNREC : SUNLS_PSOLVE_FAIL_REC;
+      return(LASTFLAG(S));
+    }
+  } else {
+    N_VScale(ONE, V[0], vtemp);
+  }
+
+  if (scale1) {
+    N_VProd(s1, vtemp, V[0]);
+  } else {
+    N_VScale(ONE, vtemp, V[0]);
+  }
+
+  /* Set r_norm = beta to L2 norm of V[0] = s1 P1_inv r_0, and
+     return if small  */
+  *res_norm = r_norm = beta = SUNRsqrt(N_VDotProd(V[0], V[0]));
+  SSGMR_CONTENT(S)->nreduce++;
+
+#if SUNDIALS_LOGGING_LEVEL >= SUNDIALS_LOGGING_INFO
+  /* print initial residual */
+  SUNLogger_QueueMsg(S->sunctx->logger, SUN_LOGLEVEL_INFO,
+    "SUNLinSolSolve_SSGMR", "initial-residual",
+    "nli = %li, resnorm = %.16g", (long int) 0, *res_norm);
+#endif
+
+  if (r_norm <= delta) {
+    *zeroguess  = SUNFALSE;
+    LASTFLAG(S) = SUNLS_SUCCESS;
+    return(LASTFLAG(S));
+  }
+
+  /* Initialize rho to avoid compiler warning message */
+  rho = beta;
+
+  /* Set xcor = 0 */
+  N_VConst(ZERO, xcor);
+
+  /* Begin outer iterations: up to (max_restarts + 1) attempts */
+  for (ntries=0; ntries<=max_restarts; ntries++) {
+
+    /* Initialize the Hessenberg matrix Hes, its QR factorization, and the
+       Givens rotation product.  Normalize the initial vector V[0] */
+    for (i=0; i<=l_max; i++)
+      for (j=0; j<l_max; j++)
+        Hes[i][j] = QR[i][j] = ZERO;
+
+    rotation_product = ONE;
+    N_VScale(ONE/r_norm, V[0], V[0]);
+
+    /* Inner loop: generate the Krylov basis s vectors at a time */
+    for (j0=0; j0<l_max; j0+=ncols) {
+
+      /* Block size, use single steps until shifts are available */
+      s = (SSGMR_CONTENT(S)->nritz > 0) ?
+        SUNMIN(SSGMR_CONTENT(S)->steps, l_max - j0) : 1;
+
+      /* Generate the Newton basis V[j0+1], ..., V[j0+s] */
+      ssgmrShifts(S, s);
+      ier = ssgmrBasis(S, j0, s, delta);
+      if (ier != SUNLS_SUCCESS) {
+        *zeroguess  = SUNFALSE;
+        LASTFLAG(S) = ier;
+        return(LASTFLAG(S));
+      }
+
+      /* Orthonormalize the block against V[0], ..., V[j0] and itself */
+      ier = ssgmrBlockOrth(S, j0, s, &nacc);
+      if (ier != SUNLS_SUCCESS) {
+        *zeroguess  = SUNFALSE;
+        LASTFLAG(S) = ier;
+        return(LASTFLAG(S));
+      }
+
+      /* Recover the Hessenberg matrix columns of the block */
+      ssgmrHessenberg(S, j0, nacc);
+      ncols = SUNMAX(nacc, 1);
+
+      /* Update the QR factorization of Hes one column at a time */
+      for (l=j0; l<j0+ncols; l++) {
+        (*nli)++;
+        krydim = l + 1;
+
+        for (i=0; i<=krydim; i++) QR[i][l] = Hes[i][l];
+
+        if (SUNQRfact(krydim, QR, givens, l) != 0 ) {
+          *zeroguess  = SUNFALSE;
+          LASTFLAG(S) = SUNLS_QRFACT_FAIL;
+          return(LASTFLAG(S));
+        }
+
+        /*  Update residual norm estimate; break if convergence test passes */
+        rotation_product *= givens[2*l+1];
+        *res_norm = rho = SUNRabs(rotation_product*r_norm);
+
+#if SUNDIALS_LOGGING_LEVEL >= SUNDIALS_LOGGING_INFO
+        /* print current iteration number and the residual */
+        SUNLogger_QueueMsg(S->sunctx->logger, SUN_LOGLEVEL_INFO,
+          "SUNLinSolSolve_SSGMR", "iterate-residual",
+          "nli = %li, resnorm = %.16g", (long int) *nli, *res_norm);
+#endif
+
+        if (rho <= delta) { converged = SUNTRUE; break; }
+      }
+
+      if (converged) break;
+
+      /* The new column was in the span of the basis but the residual did
+         not vanish, this can only happen due to a loss of accuracy */
+      if (nacc == 0) {
+        *zeroguess  = SUNFALSE;
+        LASTFLAG(S) = SUNLS_GS_FAIL;
+        return(LASTFLAG(S));
+      }
+    }
+
+    /* Inner loop is done.  Update the Newton basis shifts with the Ritz
+       values of this cycle */
+    ssgmrUpdateRitz(S, krydim);
+
+    /*   Construct g, then solve for y */
+    yg[0] = r_norm;
+    for (i=1; i<=krydim; i++) yg[i]=ZERO;
+    if (SUNQRsol(krydim, QR, givens, yg) != 0) {
+      *zeroguess  = SUNFALSE;
+      LASTFLAG(S) = SUNLS_QRSOL_FAIL;
+      return(LASTFLAG(S));
+    }
+
+    /*   Add correction vector V_l y to xcor */
+    cv[0] = ONE;
+    Xv[0] = xcor;
+
+    for (k=0; k<krydim; k++) {
+      cv[k+1] = yg[k];
+      Xv[k+1] = V[k];
+    }
+    ier = N_VLinearCombination(krydim+1, cv, Xv, xcor);
+    if (ier != SUNLS_SUCCESS) {
+      *zeroguess  = SUNFALSE;
+      LASTFLAG(S) = SUNLS_VECTOROP_ERR;
+      return(SUNLS_VECTOROP_ERR);
+    }
+
+    /* If converged, construct the final solution vector x and return */
+    if (converged) {
+
+      /* Apply right scaling and right precond.: vtemp = P2_inv s2_inv xcor */
+      if (scale2) N_VDiv(xcor, s2, xcor);
+      if (preOnRight) {
+        ier = psolve(P_data, xcor, vtemp, delta, SUN_PREC_RIGHT);
+        if (ier != 0) {
+          *zeroguess  = SUNFALSE;
+          LASTFLAG(S) = (ier < 0) ?
+            SUNLS_PSOLVE_FAIL_UNREC : SUNLS_PSOLVE_FAIL_REC;
+          return(LASTFLAG(S));
+        }
+      } else {
+        N_VScale(ONE, xcor, vtemp);
+      }
+
+      /* Add vtemp to initial x to get final solution x, and return */
+      if (*zeroguess)
+        N_VScale(ONE, vtemp, x);
+      else
+        N_VLinearSum(ONE, x, ONE, vtemp, x);
+
+      *zeroguess  = SUNFALSE;
+      LASTFLAG(S) = SUNLS_SUCCESS;
+      return(LASTFLAG(S));
+    }
+
+    /* Not yet converged; if allowed, prepare for restart */
+    if (ntries == max_restarts) break;
+
+    /* Construct last column of Q in yg */
+    s_product = ONE;
+    for (i=krydim; i>0; i--) {
+      yg[i] = s_product*givens[2*i-2];
+      s_product *= givens[2*i-1];
+    }
+    yg[0] = s_product;
+
+    /* Scale r_norm and yg */
+    r_norm *= s_product;
+    for (i=0; i<=krydim; i++)
+      yg[i] *= r_norm;
+    r_norm = SUNRabs(r_norm);
+
+    /* Multiply yg by V_(krydim+1) to get last residual vector; restart */
+    for (k=0; k<=krydim; k++) {
+      cv[k] = yg[k];
+      Xv[k] = V[k];
+    }
+    ier = N_VLinearCombination(krydim+1, cv, Xv, V[0]);
+    if (ier != SUNLS_SUCCESS) {
+      *zeroguess  = SUNFALSE;
+      LASTFLAG(S) = SUNLS_VECTOROP_ERR;
+      return(SUNLS_VECTOROP_ERR);
+    }
+
+  }
+
+  /* Failed to converge, even after allowed restarts.
+     If the residual norm was reduced below its initial value, compute
+     and return x anyway.  Otherwise return failure flag. */
+  if (rho < beta) {
+
+    /* Apply right scaling and right precond.: vtemp = P2_inv s2_inv xcor */
+    if (scale2) N_VDiv(xcor, s2, xcor);
+    if (preOnRight) {
+      ier = psolve(P_data, xcor, vtemp, delta, SUN_PREC_RIGHT);
+      if (ier != 0) {
+        *zeroguess  = SUNFALSE;
+        LASTFLAG(S) = (ier < 0) ?
+          SUNLS_PSOLVE_FAIL_UNREC : SUNLS_PSOLVE_FAIL_REC;
+        return(LASTFLAG(S));
+      }
+    } else {
+      N_VScale(ONE, xcor, vtemp);
+    }
+
+    /* Add vtemp to initial x to get final solution x, and return */
+    if (*zeroguess)
+      N_VScale(ONE, vtemp, x);
+    else
+      N_VLinearSum(ONE, x, ONE, vtemp, x);
+
+    *zeroguess  = SUNFALSE;
+    LASTFLAG(S) = SUNLS_RES_REDUCED;
+    return(LASTFLAG(S));
+  }
+
+  *zeroguess  = SUNFALSE;
+  LASTFLAG(S) = SUNLS_CONV_FAIL;
+  return(LASTFLAG(S));
+}
+
+
+int SUNLinSolNumIters_SSGMR(SUNLinearSolver S)
+{
+  /* return the stored 'numiters' value */
+  if (S == NULL) return(-1);
+  return (SSGMR_CONTENT(S)->numiters);
+}
+
+
+realtype SUNLinSolResNorm_SSGMR(SUNLinearSolver S)
+{
+  /* return the stored 'resnorm' value */
+  if (S == NULL) return(-ONE);
+  return (SSGMR_CONTENT(S)->resnorm);
+}
+
+
+N_Vector SUNLinSolResid_SSGMR(SUNLinearSolver S)
+{
+  /* return the stored 'vtemp' vector */
+  return (SSGMR_CONTENT(S)->vtemp);
+}
+
+
+sunindextype SUNLinSolLastFlag_SSGMR(SUNLinearSolver S)
+{
+  /* return the stored 'last_flag' value */
+  if (S == NULL) return(-1);
+  return (LASTFLAG(S));
+}
+
+
+int SUNLinSolSpace_SSGMR(SUNLinearSolver S,
+                         long int *lenrwLS,
+                         long int *leniwLS)
+{
+  int maxl;
+  sunindextype liw1, lrw1;
+  maxl = SSGMR_CONTENT(S)->maxl;
+  if (SSGMR_CONTENT(S)->vtemp->ops->nvspace)
+    N_VSpace(SSGMR_CONTENT(S)->vtemp, &lrw1, &liw1);
+  else
+    lrw1 = liw1 = 0;
+  *lenrwLS = lrw1*(maxl + 5) + maxl*(7*maxl + 13) + 2;
+  *leniwLS = liw1*(maxl + 5);
+  return(SUNLS_SUCCESS);
+}
+
+
+int SUNLinSolFree_SSGMR(SUNLinearSolver S)
+{
+  int k;
+
+  if (S == NULL) return(SUNLS_SUCCESS);
+
+  if (S->content) {
+    /* delete items from within the content structure */
+    if (SSGMR_CONTENT(S)->xcor) {
+      N_VDestroy(SSGMR_CONTENT(S)->xcor);
+      SSGMR_CONTENT(S)->xcor = NULL;
+    }
+    if (SSGMR_CONTENT(S)->vtemp) {
+      N_VDestroy(SSGMR_CONTENT(S)->vtemp);
+      SSGMR_CONTENT(S)->vtemp = NULL;
+    }
+    if (SSGMR_CONTENT(S)->V) {
+      N_VDestroyVectorArray(SSGMR_CONTENT(S)->V,
+                            SSGMR_CONTENT(S)->maxl+1);
+      SSGMR_CONTENT(S)->V = NULL;
+    }
+    if (SSGMR_CONTENT(S)->Hes) {
+      for (k=0; k<=SSGMR_CONTENT(S)->maxl; k++)
+        if (SSGMR_CONTENT(S)->Hes[k]) {
+          free(SSGMR_CONTENT(S)->Hes[k]);
+          SSGMR_CONTENT(S)->Hes[k] = NULL;
+        }
+      free(SSGMR_CONTENT(S)->Hes);
+      SSGMR_CONTENT(S)->Hes = NULL;
+    }
+    if (SSGMR_CONTENT(S)->QR) {
+      for (k=0; k<=SSGMR_CONTENT(S)->maxl; k++)
+        if (SSGMR_CONTENT(S)->QR[k]) {
+          free(SSGMR_CONTENT(S)->QR[k]);
+          SSGMR_CONTENT(S)->QR[k] = NULL;
+        }
+      free(SSGMR_CONTENT(S)->QR);
+      SSGMR_CONTENT(S)->QR = NULL;
+    }
+    if (SSGMR_CONTENT(S)->givens) {
+      free(SSGMR_CONTENT(S)->givens);
+      SSGMR_CONTENT(S)->givens = NULL;
+    }
+    if (SSGMR_CONTENT(S)->yg) {
+      free(SSGMR_CONTENT(S)->yg);
+      SSGMR_CONTENT(S)->yg = NULL;
+    }
+    if (SSGMR_CONTENT(S)->cv) {
+      free(SSGMR_CONTENT(S)->cv);
+      SSGMR_CONTENT(S)->cv = NULL;
+    }
+    if (SSGMR_CONTENT(S)->Xv) {
+      free(SSGMR_CONTENT(S)->Xv);
+      SSGMR_CONTENT(S)->Xv = NULL;
+    }
+    if (SSGMR_CONTENT(S)->dots) {
+      free(SSGMR_CONTENT(S)->dots);
+      SSGMR_CONTENT(S)->dots = NULL;
+    }
+    if (SSGMR_CONTENT(S)->C) {
+      free(SSGMR_CONTENT(S)->C);
+      SSGMR_CONTENT(S)->C = NULL;
+    }
+    if (SSGMR_CONTENT(S)->R) {
+      free(SSGMR_CONTENT(S)->R);
+      SSGMR_CONTENT(S)->R = NULL;
+    }
+    if (SSGMR_CONTENT(S)->B) {
+      free(SSGMR_CONTENT(S)->B);
+      SSGMR_CONTENT(S)->B = NULL;
+    }
+    if (SSGMR_CONTENT(S)->work) {
+      free(SSGMR_CONTENT(S)->work);
+      SSGMR_CONTENT(S)->work = NULL;
+    }
+    if (SSGMR_CONTENT(S)->ritz_re) {
+      free(SSGMR_CONTENT(S)->ritz_re);
+      SSGMR_CONTENT(S)->ritz_re = NULL;
+    }
+    if (SSGMR_CONTENT(S)->ritz_im) {
+      free(SSGMR_CONTENT(S)->ritz_im);
+      SSGMR_CONTENT(S)->ritz_im = NULL;
+    }
+    free(S->content); S->content = NULL;
+  }
+  if (S->ops) { free(S->ops); S->ops = NULL; }
+  free(S); S = NULL;
+  return(SUNLS_SUCCESS);
+}
+
+
+/*
+ * -----------------------------------------------------------------
+ * private functions
+ * -----------------------------------------------------------------
+ */
+
+/* ----------------------------------------------------------------------------
+ * Apply the scaled preconditioned operator, y = s1 P1_inv A P2_inv s2_inv x,
+ * using vtemp and y as work space (x and y must differ)
+ */
+
+static int ssgmrATilde(SUNLinearSolver S, N_Vector x, N_Vector y,
+                       realtype delta)
+{
+  int ier;
+  N_Vector vtemp = SSGMR_CONTENT(S)->vtemp;
+  N_Vector s1    = SSGMR_CONTENT(S)->s1;
+  N_Vector s2    = SSGMR_CONTENT(S)->s2;
+  int pretype    = SSGMR_CONTENT(S)->pretype;
+
+  /* Apply right scaling: vtemp = s2_inv x */
+  if (s2 != NULL) N_VDiv(x, s2, vtemp);
+  else N_VScale(ONE, x, vtemp);
+
+  /* Apply right preconditioner: vtemp = P2_inv s2_inv x */
+  if ((pretype == SUN_PREC_RIGHT) || (pretype == SUN_PREC_BOTH)) {
+    N_VScale(ONE, vtemp, y);
+    ier = SSGMR_CONTENT(S)->Psolve(SSGMR_CONTENT(S)->PData, y, vtemp, delta,
+                                   SUN_PREC_RIGHT);
+    if (ier != 0)
+      return((ier < 0) ? SUNLS_PSOLVE_FAIL_UNREC : SUNLS_PSOLVE_FAIL_REC);
+  }
+
+  /* Apply A: y = A P2_inv s2_inv x */
+  ier = SSGMR_CONTENT(S)->ATimes(SSGMR_CONTENT(S)->ATData, vtemp, y);
+  if (ier != 0)
+    return((ier < 0) ? SUNLS_ATIMES_FAIL_UNREC : SUNLS_ATIMES_FAIL_REC);
+
+  /* Apply left preconditioning: vtemp = P1_inv A P2_inv s2_inv x */
+  if ((pretype == SUN_PREC_LEFT) || (pretype == SUN_PREC_BOTH)) {
+    ier = SSGMR_CONTENT(S)->Psolve(SSGMR_CONTENT(S)->PData, y, vtemp, delta,
+                                   SUN_PREC_LEFT);
+    if (ier != 0)
+      return((ier < 0) ? SUNLS_PSOLVE_FAIL_UNREC : SUNLS_PSOLVE_FAIL_REC);
+  } else {
+    N_VScale(ONE, y, vtemp);
+  }
+
+  /* Apply left scaling: y = s1 P1_inv A P2_inv s2_inv x */
+  if (s1 != NULL) N_VProd(s1, vtemp, y);
+  else N_VScale(ONE, vtemp, y);
+
+  return(SUNLS_SUCCESS);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Generate the Newton basis vectors V[j0+1], ..., V[j0+s] from V[j0] using
+ * the basis change matrix B (stored by columns with leading dimension
+ * maxl+1) so that A-tilde z_t = sum_c B(c,t) z_c
+ */
+
+static int ssgmrBasis(SUNLinearSolver S, int j0, int s, realtype delta)
+{
+  int t, ier, ld;
+  N_Vector *V = SSGMR_CONTENT(S)->V;
+  realtype *B = SSGMR_CONTENT(S)->B;
+
+  ld = SSGMR_CONTENT(S)->maxl + 1;
+
+  for (t=0; t<s; t++) {
+
+    /* V[j0+t+1] = A-tilde z_t */
+    ier = ssgmrATilde(S, V[j0+t], V[j0+t+1], delta);
+    if (ier != SUNLS_SUCCESS) return(ier);
+
+    /* subtract the shift terms and scale */
+    if ((t > 0) && (B[t*ld+t-1] != ZERO))
+      N_VLinearSum(ONE, V[j0+t+1], -B[t*ld+t-1], V[j0+t-1], V[j0+t+1]);
+    N_VLinearSum(ONE/B[t*ld+t+1], V[j0+t+1], -B[t*ld+t]/B[t*ld+t+1],
+                 V[j0+t], V[j0+t+1]);
+  }
+
+  return(SUNLS_SUCCESS);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Compute the inner products for a block orthogonalization pass. In the first
+ * pass each new vector w_i = V[j0+1+i] is dotted with V[0], ..., V[j0] and
+ * itself, in the second pass with V[0], ..., V[j0+1+i]. The results are
+ * stored consecutively in dots using a single global reduction if possible.
+ */
+
+static int ssgmrDots(SUNLinearSolver S, int j0, int s, int pass)
+{
+  int i, r, n, off, ier;
+  N_Vector *V    = SSGMR_CONTENT(S)->V;
+  N_Vector *Xv   = SSGMR_CONTENT(S)->Xv;
+  realtype *dots = SSGMR_CONTENT(S)->dots;
+
+  off = 0;
+  for (i=0; i<s; i++) {
+    if (pass == 1) {
+      n = j0 + 2;
+      for (r=0; r<=j0; r++) Xv[r] = V[r];
+      Xv[j0+1] = V[j0+1+i];
+    } else {
+      n = j0 + 2 + i;
+      for (r=0; r<n; r++) Xv[r] = V[r];
+    }
+
+    if (SSGMR_CONTENT(S)->sb) {
+      ier = N_VDotProdMultiLocal(n, V[j0+1+i], Xv, dots + off);
+    } else {
+      ier = N_VDotProdMulti(n, V[j0+1+i], Xv, dots + off);
+      SSGMR_CONTENT(S)->nreduce++;
+    }
+    if (ier != 0) return(SUNLS_VECTOROP_ERR);
+
+    off += n;
+  }
+
+  if (SSGMR_CONTENT(S)->sb) {
+    ier = N_VDotProdMultiAllReduce(off, V[j0+1], dots);
+    SSGMR_CONTENT(S)->nreduce++;
+    if (ier != 0) return(SUNLS_VECTOROP_ERR);
+  }
+
+  return(SUNLS_SUCCESS);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Orthonormalize the block W = [V[j0+1], ..., V[j0+s]] against
+ * Q = [V[0], ..., V[j0]] and itself with two passes of block classical
+ * Gram-Schmidt, the second pass using a Cholesky QR of the projected Gram
+ * matrix. On return W = Q C + W_new R where C is stored by columns with
+ * leading dimension maxl+1 and R is upper triangular with leading dimension
+ * maxl. nacc is the number of new vectors accepted, a new vector is rejected
+ * (along with all following vectors) if it is numerically dependent on the
+ * preceding basis vectors.
+ */
+
+static int ssgmrBlockOrth(SUNLinearSolver S, int j0, int s, int *nacc)
+{
+  int i, k, p, r, nq, off, ld, ldr, ier;
+  realtype g, d, tol;
+  N_Vector *V    = SSGMR_CONTENT(S)->V;
+  N_Vector *Xv   = SSGMR_CONTENT(S)->Xv;
+  realtype *cv   = SSGMR_CONTENT(S)->cv;
+  realtype *dots = SSGMR_CONTENT(S)->dots;
+  realtype *C    = SSGMR_CONTENT(S)->C;
+  realtype *R    = SSGMR_CONTENT(S)->R;
+
+  nq  = j0 + 1;
+  ld  = SSGMR_CONTENT(S)->maxl + 1;
+  ldr = SSGMR_CONTENT(S)->maxl;
+  tol = SUNRsqrt(SUN_UNIT_ROUNDOFF);
+
+  /* First pass: C = Q^T W, diag(R) = ||w_i||^2, W = W - Q C */
+  ier = ssgmrDots(S, j0, s, 1);
+  if (ier != SUNLS_SUCCESS) return(ier);
+
+  for (i=0; i<s; i++) {
+    off = i * (nq + 1);
+    for (r=0; r<nq; r++) C[i*ld+r] = dots[off+r];
+    R[i*ldr+i] = dots[off+nq];
+  }
+
+  for (i=0; i<s; i++) {
+    cv[0] = ONE;
+    Xv[0] = V[j0+1+i];
+    for (r=0; r<nq; r++) {
+      cv[r+1] = -C[i*ld+r];
+      Xv[r+1] = V[r];
+    }
+    ier = N_VLinearCombination(nq+1, cv, Xv, V[j0+1+i]);
+    if (ier != 0) return(SUNLS_VECTOROP_ERR);
+  }
+
+  /* Second pass: [C2; G] = [Q W]^T W */
+  ier = ssgmrDots(S, j0, s, 2);
+  if (ier != SUNLS_SUCCESS) return(ier);
+
+  /* Cholesky factorization of the projected Gram matrix G - C2^T C2, the
+     diagonal of R holds the initial squared norms until overwritten */
+  *nacc = s;
+  off   = 0;
+  for (i=0; i<s; i++) {
+
+    /* entries of column i above the diagonal, the second pass dots of w_k
+       start at offset k (nq + 1) + k (k - 1) / 2 */
+    for (k=0; k<i; k++) {
+      g = dots[off+nq+k];
+      for (r=0; r<nq; r++)
+        g -= dots[off+r] * dots[k*(nq+1) + k*(k-1)/2 + r];
+      for (p=0; p<k; p++)
+        g -= R[k*ldr+p] * R[i*ldr+p];
+      R[i*ldr+k] = g / R[k*ldr+k];
+    }
+
+    /* diagonal entry */
+    d = dots[off+nq+i];
+    for (r=0; r<nq; r++)
+      d -= dots[off+r] * dots[off+r];
+    for (p=0; p<i; p++)
+      d -= R[i*ldr+p] * R[i*ldr+p];
+
+    if ((d <= ZERO) || ((i > 0) && (d <= tol * R[i*ldr+i]))) {
+      *nacc = i;
+      break;
+    }
+    R[i*ldr+i] = SUNRsqrt(d);
+
+    off += nq + 1 + i;
+  }
+
+  /* W_new = (W - Q C2) R^{-1} and C = C1 + C2 */
+  off = 0;
+  for (i=0; i<*nacc; i++) {
+    cv[0] = ONE / R[i*ldr+i];
+    Xv[0] = V[j0+1+i];
+    for (r=0; r<nq; r++) {
+      cv[r+1] = -dots[off+r] / R[i*ldr+i];
+      Xv[r+1] = V[r];
+      C[i*ld+r] += dots[off+r];
+    }
+    for (k=0; k<i; k++) {
+      cv[nq+1+k] = -R[i*ldr+k] / R[i*ldr+i];
+      Xv[nq+1+k] = V[j0+1+k];
+    }
+    ier = N_VLinearCombination(nq+1+i, cv, Xv, V[j0+1+i]);
+    if (ier != 0) return(SUNLS_VECTOROP_ERR);
+
+    off += nq + 1 + i;
+  }
+
+  /* if the first new vector was rejected, keep its projection onto Q */
+  if (*nacc == 0)
+    for (r=0; r<nq; r++) C[r] += dots[r];
+
+  return(SUNLS_SUCCESS);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Recover the Hessenberg matrix columns j0, ..., j0+ncols-1 for the block.
+ *
+ * With z_0 = V[j0] and z_1, ..., z_nacc represented as
+ * [z_0, ..., z_nacc] = V F where F = [e_j0, [C; R]] and A-tilde Z = Z B, the
+ * new columns satisfy H_new T = F B - [H_old E; 0] where T and E are the
+ * rows j0, ..., j0+ncols-1 and 0, ..., j0-1 of the first ncols columns of F.
+ * When no new vector was accepted (nacc = 0) the projection of z_1 onto V
+ * gives a single column with a zero subdiagonal entry.
+ */
+
+static void ssgmrHessenberg(SUNLinearSolver S, int j0, int nacc)
+{
+  int c, t, k, p, r, nq, ncols, nrows, ld, ldr;
+  realtype f, *X;
+  realtype **Hes = SSGMR_CONTENT(S)->Hes;
+  realtype *C    = SSGMR_CONTENT(S)->C;
+  realtype *R    = SSGMR_CONTENT(S)->R;
+  realtype *B    = SSGMR_CONTENT(S)->B;
+
+  nq    = j0 + 1;
+  ncols = SUNMAX(nacc, 1);
+  nrows = nq + ncols;
+  ld    = SSGMR_CONTENT(S)->maxl + 1;
+  ldr   = SSGMR_CONTENT(S)->maxl;
+  X     = SSGMR_CONTENT(S)->work;
+
+/* entry (r,c) of F, i.e., the coefficient of V[r] in z_c */
+#define FENTRY(r,c) ( ((c) == 0) ? (((r) == j0) ? ONE : ZERO) :        \
+                      (((r) < nq) ? C[((c)-1)*ld+(r)] :                 \
+                       ((((r)-nq < nacc) && ((r)-nq <= (c)-1)) ?        \
+                        R[((c)-1)*ldr+(r)-nq] : ZERO)) )
+
+  for (t=0; t<ncols; t++) {
+
+    /* X(:,t) = F B(:,t), B has nonzeros in rows t-1, t, t+1 */
+    for (r=0; r<nrows; r++) {
+      f = ZERO;
+      for (c=SUNMAX(t-1,0); c<=t+1; c++)
+        f += FENTRY(r,c) * B[t*ld+c];
+      X[t*ld+r] = f;
+    }
+
+    /* X(:,t) -= H_old E(:,t) */
+    for (p=0; p<j0; p++) {
+      f = FENTRY(p,t);
+      if (f == ZERO) continue;
+      for (r=0; r<=SUNMIN(p+1, j0); r++)
+        X[t*ld+r] -= Hes[r][p] * f;
+    }
+
+    /* X(:,t) = (X(:,t) - sum_k X(:,k) T(k,t)) / T(t,t) */
+    for (k=0; k<t; k++) {
+      f = FENTRY(j0+k,t);
+      for (r=0; r<nrows; r++)
+        X[t*ld+r] -= X[k*ld+r] * f;
+    }
+    f = FENTRY(j0+t,t);
+    for (r=0; r<nrows; r++)
+      X[t*ld+r] /= f;
+  }
+
+#undef FENTRY
+
+  /* copy the upper Hessenberg part into Hes */
+  for (t=0; t<ncols; t++)
+    for (r=0; r<=j0+t+1; r++)
+      Hes[r][j0+t] = X[t*ld+r];
+  if (nacc == 0) Hes[j0+1][j0] = ZERO;
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Fill the basis change matrix B for a block of s steps from the Leja ordered
+ * Ritz values. Real shifts give z_{t+1} = (A - a) z_t / sigma, a complex pair
+ * a +/- ib gives the two real steps
+ *   z_{t+1} = (A - a) z_t / sigma
+ *   z_{t+2} = ((A - a) z_{t+1} + (b^2 / sigma) z_t) / sigma
+ * A pair that does not fit in the block is replaced by its real part.
+ */
+
+static void ssgmrShifts(SUNLinearSolver S, int s)
+{
+  int t, k, c, ld, nritz;
+  realtype a, bi, sigma;
+  realtype *B = SSGMR_CONTENT(S)->B;
+
+  ld    = SSGMR_CONTENT(S)->maxl + 1;
+  nritz = SSGMR_CONTENT(S)->nritz;
+  sigma = SSGMR_CONTENT(S)->ritz_scale;
+
+  for (t=0; t<s; t++)
+    for (c=0; c<=s; c++)
+      B[t*ld+c] = ZERO;
+
+  /* no shifts, monomial basis */
+  if (nritz == 0) {
+    for (t=0; t<s; t++)
+      B[t*ld+t+1] = ONE;
+    return;
+  }
+
+  k = 0;
+  t = 0;
+  while (t < s) {
+    a  = SSGMR_CONTENT(S)->ritz_re[k];
+    bi = SSGMR_CONTENT(S)->ritz_im[k];
+    B[t*ld+t]   = a;
+    B[t*ld+t+1] = sigma;
+    if ((bi != ZERO) && (t+1 < s)) {
+      B[(t+1)*ld+t]   = -bi*bi/sigma;
+      B[(t+1)*ld+t+1] = a;
+      B[(t+1)*ld+t+2] = sigma;
+      t += 2;
+    } else {
+      t += 1;
+    }
+    k = (k + 1) % nritz;
+  }
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Update the Newton basis shifts with the Ritz values of the leading
+ * krydim x krydim block of Hes. The shifts are kept if the new Krylov space
+ * is smaller than a block and shifts are already available, or if the
+ * eigenvalue iteration fails.
+ */
+
+static void ssgmrUpdateRitz(SUNLinearSolver S, int krydim)
+{
+  int i, j, n, ier;
+  realtype *a, *wr, *wi, sigma;
+
+  if (krydim < 1) return;
+  if ((SSGMR_CONTENT(S)->nritz > 0) &&
+      (krydim < SUNMIN(SSGMR_CONTENT(S)->steps, SSGMR_CONTENT(S)->maxl)))
+    return;
+
+  a  = SSGMR_CONTENT(S)->work;
+  wr = SSGMR_CONTENT(S)->dots;
+  wi = SSGMR_CONTENT(S)->dots + krydim;
+
+  for (i=0; i<krydim; i++)
+    for (j=0; j<krydim; j++)
+      a[i*krydim+j] = (j >= i-1) ? SSGMR_CONTENT(S)->Hes[i][j] : ZERO;
+
+  ier = sunHessenbergEig(krydim, a, wr, wi);
+  if (ier != 0) return;
+
+  /* keep one entry for each complex conjugate pair */
+  n = 0;
+  for (i=0; i<krydim; i++) {
+    if (wi[i] < ZERO) continue;
+    SSGMR_CONTENT(S)->ritz_re[n] = wr[i];
+    SSGMR_CONTENT(S)->ritz_im[n] = wi[i];
+    n++;
+  }
+  if (n == 0) return;
+
+  ssgmrLeja(n, SSGMR_CONTENT(S)->ritz_re, SSGMR_CONTENT(S)->ritz_im,
+            SSGMR_CONTENT(S)->cv);
+
+  /* scale the basis with the largest Ritz value magnitude */
+  sigma = SUNRsqrt(SUNSQR(SSGMR_CONTENT(S)->ritz_re[0]) +
+                   SUNSQR(SSGMR_CONTENT(S)->ritz_im[0]));
+  if (sigma == ZERO) sigma = ONE;
+
+  SSGMR_CONTENT(S)->nritz      = n;
+  SSGMR_CONTENT(S)->ritz_scale = sigma;
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Reorder the n values re + i im (im >= 0 denoting a conjugate pair) in Leja
+ * order: the first value has the largest magnitude and each following value
+ * maximizes the product of the distances to the previous values and their
+ * conjugates. The products are accumulated in work (length n) and rescaled
+ * after each step to avoid under- or overflow.
+ */
+
+static void ssgmrLeja(int n, realtype *re, realtype *im, realtype *work)
+{
+  int i, k, best;
+  realtype pmax, tmp;
+
+  for (i=0; i<n; i++)
+    work[i] = SUNRsqrt(SUNSQR(re[i]) + SUNSQR(im[i]));
+
+  for (k=0; k<n; k++) {
+
+    /* select the next value */
+    best = k;
+    for (i=k+1; i<n; i++)
+      if (work[i] > work[best]) best = i;
+
+    tmp = re[k];   re[k]   = re[best];   re[best]   = tmp;
+    tmp = im[k];   im[k]   = im[best];   im[best]   = tmp;
+    tmp = work[k]; work[k] = work[best]; work[best] = tmp;
+
+    /* update the products of the remaining values */
+    if (k == 0)
+      for (i=1; i<n; i++) work[i] = ONE;
+
+    pmax = ZERO;
+    for (i=k+1; i<n; i++) {
+      work[i] *= SUNRsqrt(SUNSQR(re[i] - re[k]) + SUNSQR(im[i] - im[k]));
+      if (im[k] != ZERO)
+        work[i] *= SUNRsqrt(SUNSQR(re[i] - re[k]) + SUNSQR(im[i] + im[k]));
+      pmax = SUNMAX(pmax, work[i]);
+    }
+    if (pmax > ZERO)
+      for (i=k+1; i<n; i++) work[i] /= pmax;
+  }
+}
@@ -0,0 +1,434 @@
+/* -----------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------
+ * This is the implementation file for the block-diagonal dense
+ * implementation of the SUNMATRIX package.
+ *
+ * All operations loop over the blocks in the innermost loop so the
+ * interleaved entries are accessed with unit stride. When compiled
+ * with OpenMP the blocks are split into contiguous ranges, one per
+ * thread.
+ * -----------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <sundials/sundials_math.h>
+#include <sunmatrix/sunmatrix_blockdense.h>
+
+#define ZERO RCONST(0.0)
+#define ONE  RCONST(1.0)
+
+/* Private function prototypes */
+static booleantype compatibleMatrices(SUNMatrix A, SUNMatrix B);
+static booleantype compatibleMatrixAndVectors(SUNMatrix A, N_Vector x, N_Vector y);
+static void blockRange(sunindextype nblocks, sunindextype *k0, sunindextype *k1);
+
+/*
+ * -----------------------------------------------------------------
+ * exported functions
+ * -----------------------------------------------------------------
+ */
+
+/* ----------------------------------------------------------------------------
+ * Function to create a new block-diagonal dense matrix with nblocks blocks of
+ * size M by M
+ */
+
+SUNMatrix SUNBlockDenseMatrix(sunindextype nblocks, sunindextype M,
+                              SUNContext sunctx)
+{
+  SUNMatrix A;
+  SUNMatrixContent_BlockDense content;
+
+  /* return with NULL matrix on illegal dimension input */
+  if ((nblocks <= 0) || (M <= 0))
+    return (NULL);
+
+  /* Create an empty matrix object */
+  A = NULL;
+  A = SUNMatNewEmpty(sunctx);
+  if (A == NULL)
+    return (NULL);
+
+  /* Attach operations */
+  A->ops->getid     = SUNMatGetID_BlockDense;
+  A->ops->clone     = SUNMatClone_BlockDense;
+  A->ops->destroy   = SUNMatDestroy_BlockDense;
+  A->ops->zero      = SUNMatZero_BlockDense;
+  A->ops->copy      = SUNMatCopy_BlockDense;
+  A->ops->scaleadd  = SUNMatScaleAdd_BlockDense;
+  A->ops->scaleaddi = SUNMatScaleAddI_BlockDense;
+  A->ops->matvec    = SUNMatMatvec_BlockDense;
+  A->ops->space     = SUNMatSpace_BlockDense;
+
+  /* Create content */
+  content = NULL;
+  content = (SUNMatrixContent_BlockDense)malloc(sizeof *content);
+  if (content == NULL) {
+    SUNMatDestroy(A);
+    return (NULL);
+  }
+
+  /* Attach content */
+  A->content = content;
+
+  /* Fill content */
+  content->nblocks     = nblocks;
+  content->M           = M;
+  content->ldata       = nblocks * M * M;
+  content->data        = NULL;
+  content->num_threads = 1;
+
+  /* Allocate content */
+  content->data = (realtype*)calloc(content->ldata, sizeof(realtype));
+  if (content->data == NULL) {
+    SUNMatDestroy(A);
+    return (NULL);
+  }
+
+  return (A);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function to set the number of OpenMP threads used by the matrix operations
+ * and the SUNLINSOL_BLOCKDENSE linear solver (ignored without OpenMP)
+ */
+
+int SUNBlockDenseMatrix_SetNumThreads(SUNMatrix A, int num_threads)
+{
+  if (SUNMatGetID(A) != SUNMATRIX_BLOCKDENSE)
+    return SUNMAT_ILL_INPUT;
+  if (num_threads < 1)
+    return SUNMAT_ILL_INPUT;
+
+  SM_NUMTHREADS_BD(A) = num_threads;
+  return SUNMAT_SUCCESS;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function to print the block-diagonal dense matrix one block at a time
+ */
+
+void SUNBlockDenseMatrix_Print(SUNMatrix A, FILE* outfile)
+{
+  sunindextype i, j, k;
+
+  /* should not be called unless A is a block-diagonal dense matrix;
+     otherwise return immediately */
+  if (SUNMatGetID(A) != SUNMATRIX_BLOCKDENSE)
+    return;
+
+  /* perform operation */
+  for (k = 0; k < SM_NBLOCKS_BD(A); k++) {
+    fprintf(outfile, "\nblock %ld\n", (long int) k);
+    for (i = 0; i < SM_BLOCKROWS_BD(A); i++) {
+      for (j = 0; j < SM_BLOCKROWS_BD(A); j++) {
+#if defined(SUNDIALS_EXTENDED_PRECISION)
+        fprintf(outfile, "%12Lg  ", SM_ELEMENT_BD(A, k, i, j));
+#else
+        fprintf(outfile, "%12g  ", SM_ELEMENT_BD(A, k, i, j));
+#endif
+      }
+      fprintf(outfile, "\n");
+    }
+  }
+  fprintf(outfile, "\n");
+  return;
+}
+
+/* ----------------------------------------------------------------------------
+ * Functions to access the contents of the block-diagonal dense matrix
+ */
+
+sunindextype SUNBlockDenseMatrix_Rows(SUNMatrix A)
+{
+  if (SUNMatGetID(A) == SUNMATRIX_BLOCKDENSE)
+    return SM_ROWS_BD(A);
+  else
+    return SUNMAT_ILL_INPUT;
+}
+
+sunindextype SUNBlockDenseMatrix_Columns(SUNMatrix A)
+{
+  if (SUNMatGetID(A) == SUNMATRIX_BLOCKDENSE)
+    return SM_COLUMNS_BD(A);
+  else
+    return SUNMAT_ILL_INPUT;
+}
+
+sunindextype SUNBlockDenseMatrix_NumBlocks(SUNMatrix A)
+{
+  if (SUNMatGetID(A) == SUNMATRIX_BLOCKDENSE)
+    return SM_NBLOCKS_BD(A);
+  else
+    return SUNMAT_ILL_INPUT;
+}
+
+sunindextype SUNBlockDenseMatrix_BlockRows(SUNMatrix A)
+{
+  if (SUNMatGetID(A) == SUNMATRIX_BLOCKDENSE)
+    return SM_BLOCKROWS_BD(A);
+  else
+    return SUNMAT_ILL_INPUT;
+}
+
+sunindextype SUNBlockDenseMatrix_LData(SUNMatrix A)
+{
+  if (SUNMatGetID(A) == SUNMATRIX_BLOCKDENSE)
+    return SM_LDATA_BD(A);
+  else
+    return SUNMAT_ILL_INPUT;
+}
+
+realtype* SUNBlockDenseMatrix_Data(SUNMatrix A)
+{
+  if (SUNMatGetID(A) == SUNMATRIX_BLOCKDENSE)
+    return SM_DATA_BD(A);
+  else
+    return NULL;
+}
+
+int SUNBlockDenseMatrix_NumThreads(SUNMatrix A)
+{
+  if (SUNMatGetID(A) == SUNMATRIX_BLOCKDENSE)
+    return SM_NUMTHREADS_BD(A);
+  else
+    return SUNMAT_ILL_INPUT;
+}
+
+/*
+ * -----------------------------------------------------------------
+ * implementation of matrix operations
+ * -----------------------------------------------------------------
+ */
+
+SUNMatrix_ID SUNMatGetID_BlockDense(SUNMatrix A) { return SUNMATRIX_BLOCKDENSE; }
+
+SUNMatrix SUNMatClone_BlockDense(SUNMatrix A)
+{
+  SUNMatrix B = SUNBlockDenseMatrix(SM_NBLOCKS_BD(A), SM_BLOCKROWS_BD(A),
+                                    A->sunctx);
+  if (B != NULL)
+    SM_NUMTHREADS_BD(B) = SM_NUMTHREADS_BD(A);
+  return (B);
+}
+
+void SUNMatDestroy_BlockDense(SUNMatrix A)
+{
+  if (A == NULL)
+    return;
+
+  /* free content */
+  if (A->content != NULL) {
+    /* free data array */
+    if (SM_DATA_BD(A) != NULL) {
+      free(SM_DATA_BD(A));
+      SM_DATA_BD(A) = NULL;
+    }
+    /* free content struct */
+    free(A->content);
+    A->content = NULL;
+  }
+
+  /* free ops and matrix */
+  if (A->ops) {
+    free(A->ops);
+    A->ops = NULL;
+  }
+  free(A);
+  A = NULL;
+
+  return;
+}
+
+int SUNMatZero_BlockDense(SUNMatrix A)
+{
+  sunindextype i;
+  realtype* Adata;
+
+  /* Perform operation A_ij = 0 */
+  Adata = SM_DATA_BD(A);
+  for (i = 0; i < SM_LDATA_BD(A); i++)
+    Adata[i] = ZERO;
+
+  return SUNMAT_SUCCESS;
+}
+
+int SUNMatCopy_BlockDense(SUNMatrix A, SUNMatrix B)
+{
+  sunindextype i;
+  realtype *Adata, *Bdata;
+
+  if (!compatibleMatrices(A, B))
+    return SUNMAT_ILL_INPUT;
+
+  /* Perform operation B_ij = A_ij */
+  Adata = SM_DATA_BD(A);
+  Bdata = SM_DATA_BD(B);
+  for (i = 0; i < SM_LDATA_BD(A); i++)
+    Bdata[i] = Adata[i];
+
+  return SUNMAT_SUCCESS;
+}
+
+int SUNMatScaleAddI_BlockDense(realtype c, SUNMatrix A)
+{
+  sunindextype i, j, k, nb, M;
+  realtype *Adata, *Aij;
+
+  /* Perform operation A = c*A + I */
+  Adata = SM_DATA_BD(A);
+  nb    = SM_NBLOCKS_BD(A);
+  M     = SM_BLOCKROWS_BD(A);
+  for (j = 0; j < M; j++) {
+    for (i = 0; i < M; i++) {
+      Aij = Adata + (j * M + i) * nb;
+      if (i == j) {
+        for (k = 0; k < nb; k++)
+          Aij[k] = c * Aij[k] + ONE;
+      } else {
+        for (k = 0; k < nb; k++)
+          Aij[k] *= c;
+      }
+    }
+  }
+
+  return SUNMAT_SUCCESS;
+}
+
+int SUNMatScaleAdd_BlockDense(realtype c, SUNMatrix A, SUNMatrix B)
+{
+  sunindextype i;
+  realtype *Adata, *Bdata;
+
+  if (!compatibleMatrices(A, B))
+    return SUNMAT_ILL_INPUT;
+
+  /* Perform operation A = c*A + B */
+  Adata = SM_DATA_BD(A);
+  Bdata = SM_DATA_BD(B);
+  for (i = 0; i < SM_LDATA_BD(A); i++)
+    Adata[i] = c * Adata[i] + Bdata[i];
+
+  return SUNMAT_SUCCESS;
+}
+
+int SUNMatMatvec_BlockDense(SUNMatrix A, N_Vector x, N_Vector y)
+{
+  sunindextype nb, M;
+  realtype *Adata, *xd, *yd;
+
+  if (!compatibleMatrixAndVectors(A, x, y))
+    return SUNMAT_ILL_INPUT;
+
+  /* access vector data (return if NULL data pointers) */
+  xd = N_VGetArrayPointer(x);
+  yd = N_VGetArrayPointer(y);
+  if ((xd == NULL) || (yd == NULL) || (xd == yd))
+    return SUNMAT_MEM_FAIL;
+
+  Adata = SM_DATA_BD(A);
+  nb    = SM_NBLOCKS_BD(A);
+  M     = SM_BLOCKROWS_BD(A);
+
+  /* Perform operation y = Ax, block k maps x[k*M:(k+1)*M-1] to the same
+     entries of y */
+#ifdef _OPENMP
+#pragma omp parallel num_threads(SM_NUMTHREADS_BD(A))
+#endif
+  {
+    sunindextype i, j, k, k0, k1;
+    realtype *Aij;
+
+    blockRange(nb, &k0, &k1);
+
+    for (i = 0; i < M; i++)
+      for (k = k0; k < k1; k++)
+        yd[k * M + i] = ZERO;
+
+    for (j = 0; j < M; j++) {
+      for (i = 0; i < M; i++) {
+        Aij = Adata + (j * M + i) * nb;
+        for (k = k0; k < k1; k++)
+          yd[k * M + i] += Aij[k] * xd[k * M + j];
+      }
+    }
+  }
+
+  return SUNMAT_SUCCESS;
+}
+
+int SUNMatSpace_BlockDense(SUNMatrix A, long int* lenrw, long int* leniw)
+{
+  *lenrw = SM_LDATA_BD(A);
+  *leniw = 4;
+  return SUNMAT_SUCCESS;
+}
+
+/*
+ * -----------------------------------------------------------------
+ * private functions
+ * -----------------------------------------------------------------
+ */
+
+static booleantype compatibleMatrices(SUNMatrix A, SUNMatrix B)
+{
+  /* both matrices must be SUNMATRIX_BLOCKDENSE */
+  if ((SUNMatGetID(A) != SUNMATRIX_BLOCKDENSE) ||
+      (SUNMatGetID(B) != SUNMATRIX_BLOCKDENSE)) {
+    return SUNFALSE;
+  }
+
+  /* both matrices must have the same block structure */
+  if ((SM_NBLOCKS_BD(A) != SM_NBLOCKS_BD(B)) ||
+      (SM_BLOCKROWS_BD(A) != SM_BLOCKROWS_BD(B))) {
+    return SUNFALSE;
+  }
+
+  return SUNTRUE;
+}
+
+static booleantype compatibleMatrixAndVectors(SUNMatrix A, N_Vector x, N_Vector y)
+{
+  /* Vectors must provide nvgetarraypointer and cannot be a parallel vector */
+  if (!x->ops->nvgetarraypointer || !y->ops->nvgetarraypointer) {
+    return SUNFALSE;
+  }
+
+  /* Check that the dimensions agree */
+  if ((N_VGetLength(x) != SM_COLUMNS_BD(A)) || (N_VGetLength(y) != SM_ROWS_BD(A))) {
+    return SUNFALSE;
+  }
+
+  return SUNTRUE;
+}
+
+/* Range of blocks [k0, k1) handled by the calling thread */
+
+static void blockRange(sunindextype nblocks, sunindextype *k0, sunindextype *k1)
+{
+#ifdef _OPENMP
+  sunindextype tid = (sunindextype) omp_get_thread_num();
+  sunindextype nth = (sunindextype) omp_get_num_threads();
+#else
+  sunindextype tid = 0;
+  sunindextype nth = 1;
+#endif
+
+  *k0 = (nblocks * tid) / nth;
+  *k1 = (nblocks * (tid + 1)) / nth;
+}
@@ -23,6 +23,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include <sunmatrix/sunmatrix_sparse.h>
 #include <sundials/sundials_nvector.h>
 #include <sundials/sundials_math.h>
@@ -30,12 +34,34 @@
 #define ZERO RCONST(0.0)
 #define ONE  RCONST(1.0)
 
+/* minimum average number of rows per level for a threaded ILU solve */
+#define ILU_LEVEL_ROWS 64
+
 /* Private function prototypes */
 static booleantype SMCompatible_Sparse(SUNMatrix A, SUNMatrix B);
 static booleantype SMCompatible2_Sparse(SUNMatrix A, N_Vector x, N_Vector y);
 static int Matvec_SparseCSC(SUNMatrix A, N_Vector x, N_Vector y);
 static int Matvec_SparseCSR(SUNMatrix A, N_Vector x, N_Vector y);
+#ifdef _OPENMP
+static int Matvec_SparseCSC_OMP(SUNMatrix A, N_Vector x, N_Vector y);
+static int Matvec_SparseCSR_OMP(SUNMatrix A, N_Vector x, N_Vector y);
+static void nnzRange(sunindextype *Ap, sunindextype NP, sunindextype *p0,
+                     sunindextype *p1);
+static sunindextype nnzSplit(sunindextype *Ap, sunindextype NP, sunindextype k,
+                             sunindextype nthreads);
+#endif
+static booleantype AddMap_Matches(struct _SUNSparseAddMap *map, SUNMatrix A,
+                                  SUNMatrix B);
+static int AddMap_Build(SUNMatrix A, SUNMatrix B,
+                        struct _SUNSparseAddMap **mapout);
+static int AddMap_Apply(realtype c, SUNMatrix A, SUNMatrix B,
+                        struct _SUNSparseAddMap *map);
+static void AddMap_Free(struct _SUNSparseAddMap **map);
+static int compare_indices(const void *a, const void *b);
 static int format_convert(const SUNMatrix A, SUNMatrix B);
+static int ILU_LevelSchedule(sunindextype N, sunindextype *lev,
+                             sunindextype *nlev, sunindextype **levptr,
+                             sunindextype **levrow);
 
 /*
  * -----------------------------------------------------------------
@@ -113,6 +139,10 @@ SUNMatrix SUNSparseMatrix(sunindextype M, sunindextype N,
   content->data      = NULL;
   content->indexvals = NULL;
   content->indexptrs = NULL;
+  content->num_threads = 1;
+  content->work        = NULL;
+  content->addimap     = NULL;
+  content->addmap      = NULL;
 
   /* Allocate content */
   content->data = (realtype *) calloc(NNZ, sizeof(realtype));
@@ -342,6 +372,37 @@ int SUNSparseMatrix_Reallocate(SUNMatrix A, sunindextype NNZ)
 }
 
 
+/* ----------------------------------------------------------------------------
+ * Function to set the number of OpenMP threads used in the matrix-vector
+ * product. A CSC matrix also allocates one partial result per thread.
+ */
+
+int SUNSparseMatrix_SetNumThreads(SUNMatrix A, int num_threads)
+{
+  /* check for valid matrix type and input */
+  if (SUNMatGetID(A) != SUNMATRIX_SPARSE)  return SUNMAT_ILL_INPUT;
+  if (num_threads < 1)  return SUNMAT_ILL_INPUT;
+
+  /* free any existing workspace */
+  if (SM_CONTENT_S(A)->work) {
+    free(SM_CONTENT_S(A)->work);
+    SM_CONTENT_S(A)->work = NULL;
+  }
+
+  if ( (SM_SPARSETYPE_S(A) == CSC_MAT) && (num_threads > 1) ) {
+    SM_CONTENT_S(A)->work = (realtype *) malloc(num_threads * SM_ROWS_S(A) *
+                                                sizeof(realtype));
+    if (SM_CONTENT_S(A)->work == NULL) {
+      SM_NUMTHREADS_S(A) = 1;
+      return SUNMAT_MEM_FAIL;
+    }
+  }
+
+  SM_NUMTHREADS_S(A) = num_threads;
+  return SUNMAT_SUCCESS;
+}
+
+
 /* ----------------------------------------------------------------------------
  * Function to print the sparse matrix
  */
@@ -461,6 +522,14 @@ sunindextype* SUNSparseMatrix_IndexPointers(SUNMatrix A)
     return NULL;
 }
 
+int SUNSparseMatrix_NumThreads(SUNMatrix A)
+{
+  if (SUNMatGetID(A) == SUNMATRIX_SPARSE)
+    return SM_NUMTHREADS_S(A);
+  else
+    return SUNMAT_ILL_INPUT;
+}
+
 
 /*
  * -----------------------------------------------------------------
@@ -477,6 +546,12 @@ SUNMatrix SUNMatClone_Sparse(SUNMatrix A)
 {
   SUNMatrix B = SUNSparseMatrix(SM_ROWS_S(A), SM_COLUMNS_S(A),
                                 SM_NNZ_S(A), SM_SPARSETYPE_S(A), A->sunctx);
+  if ( (B != NULL) && (SM_NUMTHREADS_S(A) > 1) ) {
+    if (SUNSparseMatrix_SetNumThreads(B, SM_NUMTHREADS_S(A))) {
+      SUNMatDestroy(B);
+      return(NULL);
+    }
+  }
   return(B);
 }
 
@@ -505,6 +580,14 @@ void SUNMatDestroy_Sparse(SUNMatrix A)
       SM_CONTENT_S(A)->colptrs = NULL;
       SM_CONTENT_S(A)->rowptrs = NULL;
     }
+    /* free matrix-vector product workspace */
+    if (SM_CONTENT_S(A)->work) {
+      free(SM_CONTENT_S(A)->work);
+      SM_CONTENT_S(A)->work = NULL;
+    }
+    /* free cached pattern maps */
+    AddMap_Free(&(SM_CONTENT_S(A)->addimap));
+    AddMap_Free(&(SM_CONTENT_S(A)->addmap));
     /* free content struct */
     free(A->content);
     A->content = NULL;
@@ -572,459 +655,521 @@ int SUNMatCopy_Sparse(SUNMatrix A, SUNMatrix B)
 
 int SUNMatScaleAddI_Sparse(realtype c, SUNMatrix A)
 {
-  sunindextype j, i, p, nz, newvals, M, N, cend;
-  booleantype newmat, found;
-  sunindextype *w, *Ap, *Ai, *Cp, *Ci;
-  realtype *x, *Ax, *Cx;
-  SUNMatrix C;
-
-  /* store shortcuts to matrix dimensions (M is inner dimension, N is outer) */
-  if (SM_SPARSETYPE_S(A) == CSC_MAT) {
-    M = SM_ROWS_S(A);
-    N = SM_COLUMNS_S(A);
-  }
-  else {
-    M = SM_COLUMNS_S(A);
-    N = SM_ROWS_S(A);
-  }
+  int retval;
 
   /* access data arrays from A (return if failure) */
-  Ap = Ai = NULL;
-  Ax = NULL;
-  if (SM_INDEXPTRS_S(A))  Ap = SM_INDEXPTRS_S(A);
-  else  return (SUNMAT_MEM_FAIL);
-  if (SM_INDEXVALS_S(A))  Ai = SM_INDEXVALS_S(A);
-  else  return (SUNMAT_MEM_FAIL);
-  if (SM_DATA_S(A))       Ax = SM_DATA_S(A);
-  else  return (SUNMAT_MEM_FAIL);
-
-
-  /* determine if A: contains values on the diagonal (so I can just be added in);
-     if not, then increment counter for extra storage that should be required. */
-  newvals = 0;
-  for (j=0; j < SUNMIN(M,N); j++) {
-    /* scan column (row if CSR) of A, searching for diagonal value */
-    found = SUNFALSE;
-    for (i=Ap[j]; i<Ap[j+1]; i++) {
-      if (Ai[i] == j) {
-        found = SUNTRUE;
-        break;
-      }
-    }
-    /* if no diagonal found, increment necessary storage counter */
-    if (!found)  newvals += 1;
+  if (SM_INDEXPTRS_S(A) == NULL)  return (SUNMAT_MEM_FAIL);
+  if (SM_INDEXVALS_S(A) == NULL)  return (SUNMAT_MEM_FAIL);
+  if (SM_DATA_S(A) == NULL)       return (SUNMAT_MEM_FAIL);
+
+  /* record the location of the diagonal if the pattern of A has changed */
+  if (!AddMap_Matches(SM_CONTENT_S(A)->addimap, A, NULL)) {
+    AddMap_Free(&(SM_CONTENT_S(A)->addimap));
+    retval = AddMap_Build(A, NULL, &(SM_CONTENT_S(A)->addimap));
+    if (retval != SUNMAT_SUCCESS)  return(retval);
   }
 
-  /* If extra nonzeros required, check whether matrix has sufficient storage space
-     for new nonzero entries  (so I can be inserted into existing storage) */
-  newmat = SUNFALSE;   /* no reallocation needed */
-  if (newvals > (SM_NNZ_S(A) - Ap[N]))
-    newmat = SUNTRUE;
-
-
-  /* perform operation based on existing/necessary structure */
-
-  /*   case 1: A already contains a diagonal */
-  if (newvals == 0) {
-
-    /* iterate through columns, adding 1.0 to diagonal */
-    for (j=0; j < SUNMIN(M,N); j++)
-      for (i=Ap[j]; i<Ap[j+1]; i++)
-        if (Ai[i] == j) {
-          Ax[i] = ONE + c*Ax[i];
-        } else {
-          Ax[i] = c*Ax[i];
-        }
-
+  /* A = c*A + I */
+  return(AddMap_Apply(c, A, NULL, SM_CONTENT_S(A)->addimap));
+}
 
-  /*   case 2: A has sufficient storage, but does not already contain a diagonal */
-  } else if (!newmat) {
+int SUNMatScaleAdd_Sparse(realtype c, SUNMatrix A, SUNMatrix B)
+{
+  int retval;
 
+  /* Verify that A and B are compatible */
+  if (!SMCompatible_Sparse(A, B))
+    return SUNMAT_ILL_INPUT;
 
-    /* create work arrays for nonzero indices and values in a single column (row) */
-    w = (sunindextype *) malloc(M * sizeof(sunindextype));
-    x = (realtype *) malloc(M * sizeof(realtype));
+  /* access data arrays from A and B (return if failure) */
+  if (SM_INDEXPTRS_S(A) == NULL)  return(SUNMAT_MEM_FAIL);
+  if (SM_INDEXVALS_S(A) == NULL)  return(SUNMAT_MEM_FAIL);
+  if (SM_DATA_S(A) == NULL)       return(SUNMAT_MEM_FAIL);
+  if (SM_INDEXPTRS_S(B) == NULL)  return(SUNMAT_MEM_FAIL);
+  if (SM_INDEXVALS_S(B) == NULL)  return(SUNMAT_MEM_FAIL);
+  if (SM_DATA_S(B) == NULL)       return(SUNMAT_MEM_FAIL);
+
+  /* record the merged pattern if the pattern of A or B has changed */
+  if (!AddMap_Matches(SM_CONTENT_S(A)->addmap, A, B)) {
+    AddMap_Free(&(SM_CONTENT_S(A)->addmap));
+    retval = AddMap_Build(A, B, &(SM_CONTENT_S(A)->addmap));
+    if (retval != SUNMAT_SUCCESS)  return(retval);
+  }
 
-    /* determine storage location where last column (row) should end */
-    nz = Ap[N] + newvals;
+  /* A = c*A + B */
+  return(AddMap_Apply(c, A, B, SM_CONTENT_S(A)->addmap));
+}
 
-    /* store pointer past last column (row) from original A,
-       and store updated value in revised A */
-    cend = Ap[N];
-    Ap[N] = nz;
+int SUNMatMatvec_Sparse(SUNMatrix A, N_Vector x, N_Vector y)
+{
+  /* Verify that A, x and y are compatible */
+  if (!SMCompatible2_Sparse(A, x, y))
+    return SUNMAT_ILL_INPUT;
 
-    /* iterate through columns (rows) backwards */
-    for (j=N-1; j>=0; j--) {
+  /* Perform operation, threaded if requested */
+#ifdef _OPENMP
+  if (SM_NUMTHREADS_S(A) > 1) {
+    if(SM_SPARSETYPE_S(A) == CSC_MAT)
+      return Matvec_SparseCSC_OMP(A, x, y);
+    else
+      return Matvec_SparseCSR_OMP(A, x, y);
+  }
+#endif
+  if(SM_SPARSETYPE_S(A) == CSC_MAT)
+    return Matvec_SparseCSC(A, x, y);
+  else
+    return Matvec_SparseCSR(A, x, y);
+}
 
-      /* clear out temporary arrays for this column (row) */
-      for (i=0; i<M; i++) {
-        w[i] = 0;
-        x[i] = RCONST(0.0);
-      }
+int SUNMatSpace_Sparse(SUNMatrix A, long int *lenrw, long int *leniw)
+{
+  *lenrw = SM_NNZ_S(A);
+  if (SM_CONTENT_S(A)->work)
+    *lenrw += SM_NUMTHREADS_S(A) * SM_ROWS_S(A);
+  *leniw = 11 + SM_NP_S(A) + SM_NNZ_S(A);
+  return SUNMAT_SUCCESS;
+}
 
-      /* iterate down column (row) of A, collecting nonzeros */
-      for (p=Ap[j]; p<cend; p++) {
-        w[Ai[p]] += 1;         /* indicate that row (column) is filled */
-        x[Ai[p]] = c*Ax[p];    /* collect/scale value */
-      }
+/*
+ * =================================================================
+ * incomplete LU factorization
+ * =================================================================
+ */
 
-      /* add identity to this column (row) */
-      if (j < M) {
-        w[j] += 1;     /* indicate that row (column) is filled */
-        x[j] += ONE;   /* update value */
-      }
+/* ----------------------------------------------------------------------------
+ * Function to create an ILU(fill) factorization object for the square sparse
+ * matrix A. The level-of-fill pattern of the factors, the map from the entries
+ * of A into the factors, and the level schedules for the triangular solves are
+ * computed here once and reused by every call to SUNSparseMatrix_ILUFactor.
+ */
 
-      /* fill entries of A with this column's (row's) data */
-      for (i=M-1; i>=0; i--) {
-        if ( w[i] > 0 ) {
-          Ai[--nz] = i;
-          Ax[nz] = x[i];
-        }
-      }
+SUNSparseILU SUNSparseMatrix_ILUCreate(SUNMatrix A, int fill)
+{
+  SUNSparseILU ilu;
+  sunindextype N, annz, maxlev, i, j, k, p, q, c, prev, len, cap;
+  sunindextype *Ap, *Ai, *arp, *acol, *asrc, *next, *rlev, *lulev, *tmp;
+
+  /* A must be a square sparse matrix */
+  if ((A == NULL) || (fill < 0)) return(NULL);
+  if (SUNMatGetID(A) != SUNMATRIX_SPARSE) return(NULL);
+  if (SM_ROWS_S(A) != SM_COLUMNS_S(A)) return(NULL);
+
+  N    = SM_ROWS_S(A);
+  Ap   = SM_INDEXPTRS_S(A);
+  Ai   = SM_INDEXVALS_S(A);
+  annz = Ap[N];
+
+  /* levels above N do not add any further fill */
+  maxlev = SUNMIN((sunindextype) fill, N);
+
+  ilu = NULL;
+  ilu = (SUNSparseILU) calloc(1, sizeof(*ilu));
+  if (ilu == NULL) return(NULL);
+
+  ilu->N           = N;
+  ilu->fill        = fill;
+  ilu->num_threads = SM_NUMTHREADS_S(A);
+  ilu->droptol     = ZERO;
+  ilu->sparsetype  = SM_SPARSETYPE_S(A);
+  ilu->annz        = annz;
+
+  /* row-wise pattern of A (arp, acol) and the location of each entry in the
+     data array of A (asrc) */
+  arp   = (sunindextype*) calloc(N+1, sizeof(sunindextype));
+  acol  = (sunindextype*) malloc(SUNMAX(annz,1) * sizeof(sunindextype));
+  asrc  = (sunindextype*) malloc(SUNMAX(annz,1) * sizeof(sunindextype));
+  next  = (sunindextype*) malloc((N+1) * sizeof(sunindextype));
+  rlev  = (sunindextype*) malloc(N * sizeof(sunindextype));
+  cap   = annz + N;
+  lulev = (sunindextype*) malloc(cap * sizeof(sunindextype));
+
+  ilu->rowptr = (sunindextype*) malloc((N+1) * sizeof(sunindextype));
+  ilu->colind = (sunindextype*) malloc(cap * sizeof(sunindextype));
+  ilu->diag   = (sunindextype*) malloc(N * sizeof(sunindextype));
+  ilu->aptr   = (sunindextype*) malloc((N+1) * sizeof(sunindextype));
+  ilu->aidx   = (sunindextype*) malloc(SUNMAX(annz,1) * sizeof(sunindextype));
+  ilu->amap   = (sunindextype*) malloc(SUNMAX(annz,1) * sizeof(sunindextype));
+  ilu->iwork  = (sunindextype*) malloc(N * sizeof(sunindextype));
+  ilu->rwork  = (realtype*) malloc(N * sizeof(realtype));
+
+  if ((arp == NULL) || (acol == NULL) || (asrc == NULL) || (next == NULL) ||
+      (rlev == NULL) || (lulev == NULL) || (ilu->rowptr == NULL) ||
+      (ilu->colind == NULL) || (ilu->diag == NULL) || (ilu->aptr == NULL) ||
+      (ilu->aidx == NULL) || (ilu->amap == NULL) || (ilu->iwork == NULL) ||
+      (ilu->rwork == NULL)) {
+    free(arp); free(acol); free(asrc); free(next); free(rlev); free(lulev);
+    SUNSparseMatrix_ILUFree(ilu);
+    return(NULL);
+  }
 
-      /* store ptr past this col (row) from orig A, update value for new A */
-      cend = Ap[j];
-      Ap[j] = nz;
+  /* keep the pattern of A to check the matrices given to ILUFactor */
+  for (i=0; i<=N; i++) ilu->aptr[i] = Ap[i];
+  for (k=0; k<annz; k++) ilu->aidx[k] = Ai[k];
 
+  if (SM_SPARSETYPE_S(A) == CSR_MAT) {
+    for (i=0; i<=N; i++) arp[i] = Ap[i];
+    for (k=0; k<annz; k++) {
+      acol[k] = Ai[k];
+      asrc[k] = k;
     }
-
-    /* clean up */
-    free(w);
-    free(x);
-
-
-  /*   case 3: A must be reallocated with sufficient storage */
   } else {
-
-    /* create work arrays for nonzero indices and values */
-    w = (sunindextype *) malloc(M * sizeof(sunindextype));
-    x = (realtype *) malloc(M * sizeof(realtype));
-
-    /* create new matrix for sum */
-    C = SUNSparseMatrix(SM_ROWS_S(A), SM_COLUMNS_S(A),
-                        Ap[N] + newvals,
-                        SM_SPARSETYPE_S(A), A->sunctx);
-
-    /* access data from CSR structures (return if failure) */
-    Cp = Ci = NULL;
-    Cx = NULL;
-    if (SM_INDEXPTRS_S(C))  Cp = SM_INDEXPTRS_S(C);
-    else  return (SUNMAT_MEM_FAIL);
-    if (SM_INDEXVALS_S(C))  Ci = SM_INDEXVALS_S(C);
-    else  return (SUNMAT_MEM_FAIL);
-    if (SM_DATA_S(C))       Cx = SM_DATA_S(C);
-    else  return (SUNMAT_MEM_FAIL);
-
-    /* initialize total nonzero count */
-    nz = 0;
-
-    /* iterate through columns (rows for CSR) */
+    /* count the entries in each row and transpose the CSC pattern */
+    for (k=0; k<annz; k++) arp[Ai[k]+1]++;
+    for (i=0; i<N; i++) arp[i+1] += arp[i];
+    for (i=0; i<N; i++) ilu->iwork[i] = arp[i];
     for (j=0; j<N; j++) {
-
-      /* set current column (row) pointer to current # nonzeros */
-      Cp[j] = nz;
-
-      /* clear out temporary arrays for this column (row) */
-      for (i=0; i<M; i++) {
-        w[i] = 0;
-        x[i] = 0.0;
-      }
-
-      /* iterate down column (along row) of A, collecting nonzeros */
-      for (p=Ap[j]; p<Ap[j+1]; p++) {
-        w[Ai[p]] += 1;         /* indicate that row is filled */
-        x[Ai[p]] = c*Ax[p];    /* collect/scale value */
+      for (k=Ap[j]; k<Ap[j+1]; k++) {
+        p = ilu->iwork[Ai[k]]++;
+        acol[p] = j;
+        asrc[p] = k;
       }
+    }
+  }
 
-      /* add identity to this column (row) */
-      if (j < M) {
-        w[j] += 1;     /* indicate that row is filled */
-        x[j] += ONE;   /* update value */
-      }
+  /* symbolic ILU(k): each row is assembled in a sorted linked list headed by
+     next[N] (which also terminates the list) with the level of each entry in
+     rlev, entries not in the list have level -1 */
+  for (i=0; i<N; i++) rlev[i] = -1;
+
+  ilu->rowptr[0] = 0;
+  for (i=0; i<N; i++) {
+
+    /* start with the diagonal and the pattern of row i of A at level 0 */
+    next[N] = i;
+    next[i] = N;
+    rlev[i] = 0;
+    for (k=arp[i]; k<arp[i+1]; k++) {
+      j = acol[k];
+      if (rlev[j] >= 0) continue;
+      prev = N;
+      c    = next[N];
+      while (c < j) { prev = c; c = next[c]; }
+      next[prev] = j;
+      next[j]    = c;
+      rlev[j]    = 0;
+    }
 
-      /* fill entries of C with this column's (row's) data */
-      for (i=0; i<M; i++) {
-        if ( w[i] > 0 ) {
-          Ci[nz] = i;
-          Cx[nz++] = x[i];
+    /* eliminate with the previous rows in increasing order, fill entries are
+       always inserted after the current pivot column k */
+    k = next[N];
+    while (k < i) {
+      for (q=ilu->diag[k]+1; q<ilu->rowptr[k+1]; q++) {
+        j = ilu->colind[q];
+        len = rlev[k] + lulev[q] + 1;
+        if (len > maxlev) continue;
+        if (rlev[j] >= 0) {
+          if (len < rlev[j]) rlev[j] = len;
+          continue;
         }
+        prev = k;
+        c    = next[k];
+        while (c < j) { prev = c; c = next[c]; }
+        next[prev] = j;
+        next[j]    = c;
+        rlev[j]    = len;
       }
+      k = next[k];
     }
 
-    /* indicate end of data */
-    Cp[N] = nz;
-
-    /* update A's structure with C's values; nullify C's pointers */
-    SM_NNZ_S(A) = SM_NNZ_S(C);
-
-    if (SM_DATA_S(A))
-      free(SM_DATA_S(A));
-    SM_DATA_S(A) = SM_DATA_S(C);
-    SM_DATA_S(C) = NULL;
-
-    if (SM_INDEXVALS_S(A))
-      free(SM_INDEXVALS_S(A));
-    SM_INDEXVALS_S(A) = SM_INDEXVALS_S(C);
-    SM_INDEXVALS_S(C) = NULL;
-
-    if (SM_INDEXPTRS_S(A))
-      free(SM_INDEXPTRS_S(A));
-    SM_INDEXPTRS_S(A) = SM_INDEXPTRS_S(C);
-    SM_INDEXPTRS_S(C) = NULL;
-
-    /* clean up */
-    SUNMatDestroy_Sparse(C);
-    free(w);
-    free(x);
+    /* grow the factor storage if necessary */
+    len = 0;
+    for (c=next[N]; c<N; c=next[c]) len++;
+    if (ilu->rowptr[i] + len > cap) {
+      cap = SUNMAX(2*cap, ilu->rowptr[i] + len);
+      tmp = (sunindextype*) realloc(ilu->colind, cap * sizeof(sunindextype));
+      if (tmp == NULL) {
+        free(arp); free(acol); free(asrc); free(next); free(rlev); free(lulev);
+        SUNSparseMatrix_ILUFree(ilu);
+        return(NULL);
+      }
+      ilu->colind = tmp;
+      tmp = (sunindextype*) realloc(lulev, cap * sizeof(sunindextype));
+      if (tmp == NULL) {
+        free(arp); free(acol); free(asrc); free(next); free(rlev); free(lulev);
+        SUNSparseMatrix_ILUFree(ilu);
+        return(NULL);
+      }
+      lulev = tmp;
+    }
 
+    /* store the row and reset the levels */
+    p = ilu->rowptr[i];
+    for (c=next[N]; c<N; c=next[c]) {
+      if (c == i) ilu->diag[i] = p;
+      ilu->colind[p] = c;
+      lulev[p]       = rlev[c];
+      rlev[c]        = -1;
+      p++;
+    }
+    ilu->rowptr[i+1] = p;
   }
-  return SUNMAT_SUCCESS;
-
-}
+  ilu->nnz = ilu->rowptr[N];
 
-int SUNMatScaleAdd_Sparse(realtype c, SUNMatrix A, SUNMatrix B)
-{
-  sunindextype j, i, p, nz, newvals, M, N, cend;
-  booleantype newmat;
-  sunindextype *w, *Ap, *Ai, *Bp, *Bi, *Cp, *Ci;
-  realtype *x, *Ax, *Bx, *Cx;
-  SUNMatrix C;
+  ilu->vals = (realtype*) malloc(SUNMAX(ilu->nnz,1) * sizeof(realtype));
+  if (ilu->vals == NULL) {
+    free(arp); free(acol); free(asrc); free(next); free(rlev); free(lulev);
+    SUNSparseMatrix_ILUFree(ilu);
+    return(NULL);
+  }
 
-  /* Verify that A and B are compatible */
-  if (!SMCompatible_Sparse(A, B))
-    return SUNMAT_ILL_INPUT;
+  /* map the entries of A to their location in the factors */
+  for (i=0; i<N; i++) ilu->iwork[i] = -1;
+  for (i=0; i<N; i++) {
+    for (p=ilu->rowptr[i]; p<ilu->rowptr[i+1]; p++)
+      ilu->iwork[ilu->colind[p]] = p;
+    for (k=arp[i]; k<arp[i+1]; k++)
+      ilu->amap[asrc[k]] = ilu->iwork[acol[k]];
+    for (p=ilu->rowptr[i]; p<ilu->rowptr[i+1]; p++)
+      ilu->iwork[ilu->colind[p]] = -1;
+  }
 
-  /* store shortcuts to matrix dimensions (M is inner dimension, N is outer) */
-  if (SM_SPARSETYPE_S(A) == CSC_MAT) {
-    M = SM_ROWS_S(A);
-    N = SM_COLUMNS_S(A);
+  /* level schedules for the forward (L) and backward (U) solves */
+  for (i=0; i<N; i++) {
+    len = 0;
+    for (p=ilu->rowptr[i]; p<ilu->diag[i]; p++)
+      len = SUNMAX(len, rlev[ilu->colind[p]] + 1);
+    rlev[i] = len;
   }
-  else {
-    M = SM_COLUMNS_S(A);
-    N = SM_ROWS_S(A);
+  if (ILU_LevelSchedule(N, rlev, &(ilu->nlevL), &(ilu->levptrL),
+                        &(ilu->levrowL))) {
+    free(arp); free(acol); free(asrc); free(next); free(rlev); free(lulev);
+    SUNSparseMatrix_ILUFree(ilu);
+    return(NULL);
   }
 
-  /* access data arrays from A and B (return if failure) */
-  Ap = Ai = Bp = Bi = NULL;
-  Ax = Bx = NULL;
-  if (SM_INDEXPTRS_S(A))  Ap = SM_INDEXPTRS_S(A);
-  else  return(SUNMAT_MEM_FAIL);
-  if (SM_INDEXVALS_S(A))  Ai = SM_INDEXVALS_S(A);
-  else  return(SUNMAT_MEM_FAIL);
-  if (SM_DATA_S(A))       Ax = SM_DATA_S(A);
-  else  return(SUNMAT_MEM_FAIL);
-  if (SM_INDEXPTRS_S(B))  Bp = SM_INDEXPTRS_S(B);
-  else  return(SUNMAT_MEM_FAIL);
-  if (SM_INDEXVALS_S(B))  Bi = SM_INDEXVALS_S(B);
-  else  return(SUNMAT_MEM_FAIL);
-  if (SM_DATA_S(B))       Bx = SM_DATA_S(B);
-  else  return(SUNMAT_MEM_FAIL);
-
-  /* create work arrays for row indices and nonzero column values */
-  w = (sunindextype *) malloc(M * sizeof(sunindextype));
-  x = (realtype *) malloc(M * sizeof(realtype));
-
-  /* determine if A already contains the sparsity pattern of B */
-  newvals = 0;
-  for (j=0; j<N; j++) {
-
-    /* clear work array */
-    for (i=0; i<M; i++)  w[i] = 0;
-
-    /* scan column of A, incrementing w by one */
-    for (i=Ap[j]; i<Ap[j+1]; i++)
-      w[Ai[i]] += 1;
-
-    /* scan column of B, decrementing w by one */
-    for (i=Bp[j]; i<Bp[j+1]; i++)
-      w[Bi[i]] -= 1;
-
-    /* if any entry of w is negative, A doesn't contain B's sparsity,
-       so increment necessary storage counter */
-    for (i=0; i<M; i++)
-      if (w[i] < 0)  newvals += 1;
+  for (i=N-1; i>=0; i--) {
+    len = 0;
+    for (p=ilu->diag[i]+1; p<ilu->rowptr[i+1]; p++)
+      len = SUNMAX(len, rlev[ilu->colind[p]] + 1);
+    rlev[i] = len;
+  }
+  if (ILU_LevelSchedule(N, rlev, &(ilu->nlevU), &(ilu->levptrU),
+                        &(ilu->levrowU))) {
+    free(arp); free(acol); free(asrc); free(next); free(rlev); free(lulev);
+    SUNSparseMatrix_ILUFree(ilu);
+    return(NULL);
   }
 
-  /* If extra nonzeros required, check whether A has sufficient storage space
-     for new nonzero entries (so B can be inserted into existing storage) */
-  newmat = SUNFALSE;   /* no reallocation needed */
-  if (newvals > (SM_NNZ_S(A) - Ap[N]))
-    newmat = SUNTRUE;
-
-  /* perform operation based on existing/necessary structure */
-
-  /*   case 1: A already contains sparsity pattern of B */
-  if (newvals == 0) {
+  free(arp);
+  free(acol);
+  free(asrc);
+  free(next);
+  free(rlev);
+  free(lulev);
 
-    /* iterate through columns, adding matrices */
-    for (j=0; j<N; j++) {
+  return(ilu);
+}
 
-      /* clear work array */
-      for (i=0; i<M; i++)
-        x[i] = ZERO;
+/* ----------------------------------------------------------------------------
+ * Function to set the relative drop tolerance for the numeric factorization.
+ * Entries of row i of the factors smaller in magnitude than droptol times the
+ * 2-norm of row i of A are dropped, a value of zero disables dropping.
+ */
 
-      /* scan column of B, updating work array */
-      for (i = Bp[j]; i < Bp[j+1]; i++)
-        x[Bi[i]] = Bx[i];
+int SUNSparseMatrix_ILUSetDropTol(SUNSparseILU ilu, realtype droptol)
+{
+  if ((ilu == NULL) || (droptol < ZERO)) return SUNMAT_ILL_INPUT;
+  ilu->droptol = droptol;
+  return SUNMAT_SUCCESS;
+}
 
-      /* scan column of A, updating array entries appropriately */
-      for (i = Ap[j]; i < Ap[j+1]; i++)
-        Ax[i] = c*Ax[i] + x[Ai[i]];
+/* ----------------------------------------------------------------------------
+ * Function to compute the numeric incomplete factorization of A. The matrix
+ * must have the same dimensions, storage type and sparsity pattern as the
+ * matrix used to create the factorization object. The triangular solves use
+ * the number of threads set in A. Returns a positive value i+1 if a zero pivot
+ * is encountered in row i.
+ */
 
+int SUNSparseMatrix_ILUFactor(SUNSparseILU ilu, SUNMatrix A)
+{
+  sunindextype N, i, j, k, p, q;
+  sunindextype *rowptr, *colind, *diag, *marker;
+  realtype *Ax, *vals, *tau, lik;
+
+  if ((ilu == NULL) || (A == NULL)) return SUNMAT_ILL_INPUT;
+  if (SUNMatGetID(A) != SUNMATRIX_SPARSE) return SUNMAT_ILL_INPUT;
+
+  N = ilu->N;
+  if ((SM_ROWS_S(A) != N) || (SM_COLUMNS_S(A) != N)) return SUNMAT_ILL_INPUT;
+  if (SM_SPARSETYPE_S(A) != ilu->sparsetype) return SUNMAT_ILL_INPUT;
+  if (SM_INDEXPTRS_S(A)[N] != ilu->annz) return SUNMAT_ILL_INPUT;
+
+  /* the map into the factors is only valid for the pattern used to create
+     the factorization object */
+  for (i=0; i<=N; i++)
+    if (SM_INDEXPTRS_S(A)[i] != ilu->aptr[i]) return SUNMAT_ILL_INPUT;
+  for (k=0; k<ilu->annz; k++)
+    if (SM_INDEXVALS_S(A)[k] != ilu->aidx[k]) return SUNMAT_ILL_INPUT;
+
+  ilu->num_threads = SM_NUMTHREADS_S(A);
+
+  rowptr = ilu->rowptr;
+  colind = ilu->colind;
+  diag   = ilu->diag;
+  vals   = ilu->vals;
+  marker = ilu->iwork;
+  tau    = ilu->rwork;
+  Ax     = SM_DATA_S(A);
+
+  /* scatter A into the factor pattern */
+  for (p=0; p<ilu->nnz; p++) vals[p] = ZERO;
+  for (k=0; k<ilu->annz; k++) vals[ilu->amap[k]] += Ax[k];
+
+  /* drop thresholds relative to the row norms of A */
+  for (i=0; i<N; i++) {
+    tau[i] = ZERO;
+    if (ilu->droptol > ZERO) {
+      for (p=rowptr[i]; p<rowptr[i+1]; p++) tau[i] += vals[p]*vals[p];
+      tau[i] = ilu->droptol * SUNRsqrt(tau[i]);
     }
+  }
 
-
-  /*   case 2: A has sufficient storage, but does not already contain B's sparsity */
-  } else if (!newmat) {
-
-    /* determine storage location where last column (row) should end */
-    nz = Ap[N] + newvals;
-
-    /* store pointer past last column (row) from original A,
-       and store updated value in revised A */
-    cend = Ap[N];
-    Ap[N] = nz;
-
-    /* iterate through columns (rows) backwards */
-    for (j=N-1; j>=0; j--) {
-
-      /* clear out temporary arrays for this column (row) */
-      for (i=0; i<M; i++) {
-        w[i] = 0;
-        x[i] = RCONST(0.0);
-      }
-
-      /* iterate down column (row) of A, collecting nonzeros */
-      for (p=Ap[j]; p<cend; p++) {
-        w[Ai[p]] += 1;         /* indicate that row (column) is filled */
-        x[Ai[p]] = c*Ax[p];    /* collect/scale value */
-      }
-
-      /* iterate down column of B, collecting nonzeros */
-      for (p=Bp[j]; p<Bp[j+1]; p++) {
-        w[Bi[p]] += 1;       /* indicate that row is filled */
-        x[Bi[p]] += Bx[p];   /* collect value */
+  /* IKJ variant of Gaussian elimination restricted to the pattern */
+  for (i=0; i<N; i++) marker[i] = -1;
+  for (i=0; i<N; i++) {
+
+    for (p=rowptr[i]; p<rowptr[i+1]; p++) marker[colind[p]] = p;
+
+    for (p=rowptr[i]; p<diag[i]; p++) {
+      k   = colind[p];
+      lik = vals[p] / vals[diag[k]];
+      if (SUNRabs(lik) < tau[i]) lik = ZERO;
+      vals[p] = lik;
+      if (lik == ZERO) continue;
+      for (q=diag[k]+1; q<rowptr[k+1]; q++) {
+        j = marker[colind[q]];
+        if (j >= 0) vals[j] -= lik * vals[q];
       }
+    }
 
-      /* fill entries of A with this column's (row's) data */
-      for (i=M-1; i>=0; i--) {
-        if ( w[i] > 0 ) {
-          Ai[--nz] = i;
-          Ax[nz] = x[i];
-        }
-      }
+    for (p=diag[i]+1; p<rowptr[i+1]; p++)
+      if (SUNRabs(vals[p]) < tau[i]) vals[p] = ZERO;
 
-      /* store ptr past this col (row) from orig A, update value for new A */
-      cend = Ap[j];
-      Ap[j] = nz;
+    for (p=rowptr[i]; p<rowptr[i+1]; p++) marker[colind[p]] = -1;
 
-    }
+    if (vals[diag[i]] == ZERO) return((int) (i+1));
+  }
 
+  return SUNMAT_SUCCESS;
+}
 
-  /*   case 3: A must be reallocated with sufficient storage */
-  } else {
+/* ----------------------------------------------------------------------------
+ * Function to solve L U x = b with the incomplete factors. The vectors must
+ * provide access to their data with N_VGetArrayPointer, x and b may be the
+ * same vector. The rows within each level are independent of each other, so
+ * with OpenMP the rows of a level are split across the threads with a barrier
+ * between levels. Threads are only used for a triangular solve when its levels
+ * hold ILU_LEVEL_ROWS rows on average, as the barriers dominate otherwise.
+ */
 
+int SUNSparseMatrix_ILUSolve(SUNSparseILU ilu, N_Vector b, N_Vector x)
+{
+  sunindextype N, i;
+  realtype *bd, *xd;
+#ifdef _OPENMP
+  booleantype threadL, threadU;
+#endif
 
-    /* create new matrix for sum */
-    C = SUNSparseMatrix(SM_ROWS_S(A), SM_COLUMNS_S(A),
-                        Ap[N] + newvals, SM_SPARSETYPE_S(A), A->sunctx);
+  if ((ilu == NULL) || (b == NULL) || (x == NULL)) return SUNMAT_ILL_INPUT;
 
-    /* access data from CSR structures (return if failure) */
-    Cp = Ci = NULL;
-    Cx = NULL;
-    if (SM_INDEXPTRS_S(C))  Cp = SM_INDEXPTRS_S(C);
-    else  return(SUNMAT_MEM_FAIL);
-    if (SM_INDEXVALS_S(C))  Ci = SM_INDEXVALS_S(C);
-    else  return(SUNMAT_MEM_FAIL);
-    if (SM_DATA_S(C))       Cx = SM_DATA_S(C);
-    else  return(SUNMAT_MEM_FAIL);
+  bd = N_VGetArrayPointer(b);
+  xd = N_VGetArrayPointer(x);
+  if ((bd == NULL) || (xd == NULL)) return SUNMAT_ILL_INPUT;
 
-    /* initialize total nonzero count */
-    nz = 0;
+  N = ilu->N;
 
-    /* iterate through columns (rows) */
-    for (j=0; j<N; j++) {
+  if (xd != bd)
+    for (i=0; i<N; i++) xd[i] = bd[i];
 
-      /* set current column (row) pointer to current # nonzeros */
-      Cp[j] = nz;
+#ifdef _OPENMP
+  threadL = (ilu->num_threads > 1) && (N >= ILU_LEVEL_ROWS * ilu->nlevL);
+  threadU = (ilu->num_threads > 1) && (N >= ILU_LEVEL_ROWS * ilu->nlevU);
+#endif
 
-      /* clear out temporary arrays for this column (row) */
-      for (i=0; i<M; i++) {
-        w[i] = 0;
-        x[i] = RCONST(0.0);
-      }
+  /* forward solve with the unit lower triangle */
+#ifdef _OPENMP
+#pragma omp parallel num_threads(ilu->num_threads) if(threadL)
+#endif
+  {
+    sunindextype lev, r, i, p;
+    realtype sum;
 
-      /* iterate down column of A, collecting nonzeros */
-      for (p=Ap[j]; p<Ap[j+1]; p++) {
-        w[Ai[p]] += 1;         /* indicate that row is filled */
-        x[Ai[p]] = c*Ax[p];    /* collect/scale value */
+    for (lev=0; lev<ilu->nlevL; lev++) {
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+      for (r=ilu->levptrL[lev]; r<ilu->levptrL[lev+1]; r++) {
+        i   = ilu->levrowL[r];
+        sum = xd[i];
+        for (p=ilu->rowptr[i]; p<ilu->diag[i]; p++)
+          sum -= ilu->vals[p] * xd[ilu->colind[p]];
+        xd[i] = sum;
       }
+    }
+  }
 
-      /* iterate down column of B, collecting nonzeros */
-      for (p=Bp[j]; p<Bp[j+1]; p++) {
-        w[Bi[p]] += 1;       /* indicate that row is filled */
-        x[Bi[p]] += Bx[p];   /* collect value */
-      }
+  /* backward solve with the upper triangle */
+#ifdef _OPENMP
+#pragma omp parallel num_threads(ilu->num_threads) if(threadU)
+#endif
+  {
+    sunindextype lev, r, i, p;
+    realtype sum;
 
-      /* fill entries of C with this column's data */
-      for (i=0; i<M; i++) {
-        if ( w[i] > 0 ) {
-          Ci[nz] = i;
-          Cx[nz++] = x[i];
-        }
+    for (lev=0; lev<ilu->nlevU; lev++) {
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+      for (r=ilu->levptrU[lev]; r<ilu->levptrU[lev+1]; r++) {
+        i   = ilu->levrowU[r];
+        sum = xd[i];
+        for (p=ilu->diag[i]+1; p<ilu->rowptr[i+1]; p++)
+          sum -= ilu->vals[p] * xd[ilu->colind[p]];
+        xd[i] = sum / ilu->vals[ilu->diag[i]];
       }
     }
-
-    /* indicate end of data */
-    Cp[N] = nz;
-
-    /* update A's structure with C's values; nullify C's pointers */
-    SM_NNZ_S(A) = SM_NNZ_S(C);
-
-    free(SM_DATA_S(A));
-    SM_DATA_S(A) = SM_DATA_S(C);
-    SM_DATA_S(C) = NULL;
-
-    free(SM_INDEXVALS_S(A));
-    SM_INDEXVALS_S(A) = SM_INDEXVALS_S(C);
-    SM_INDEXVALS_S(C) = NULL;
-
-    free(SM_INDEXPTRS_S(A));
-    SM_INDEXPTRS_S(A) = SM_INDEXPTRS_S(C);
-    SM_INDEXPTRS_S(C) = NULL;
-
-    /* clean up */
-    SUNMatDestroy_Sparse(C);
-
   }
 
-  /* clean up */
-  free(w);
-  free(x);
-
-  /* return success */
-  return(0);
-
+  return SUNMAT_SUCCESS;
 }
 
-int SUNMatMatvec_Sparse(SUNMatrix A, N_Vector x, N_Vector y)
-{
-  /* Verify that A, x and y are compatible */
-  if (!SMCompatible2_Sparse(A, x, y))
-    return SUNMAT_ILL_INPUT;
+/* ----------------------------------------------------------------------------
+ * Function to get the number of nonzeros in the factors and the number of
+ * levels in the forward and backward triangular solves
+ */
 
-  /* Perform operation */
-  if(SM_SPARSETYPE_S(A) == CSC_MAT)
-    return Matvec_SparseCSC(A, x, y);
-  else
-    return Matvec_SparseCSR(A, x, y);
+int SUNSparseMatrix_ILUGetInfo(SUNSparseILU ilu, sunindextype *nnzLU,
+                               sunindextype *nlevL, sunindextype *nlevU)
+{
+  if (ilu == NULL) return SUNMAT_ILL_INPUT;
+  if (nnzLU) *nnzLU = ilu->nnz;
+  if (nlevL) *nlevL = ilu->nlevL;
+  if (nlevU) *nlevU = ilu->nlevU;
+  return SUNMAT_SUCCESS;
 }
 
-int SUNMatSpace_Sparse(SUNMatrix A, long int *lenrw, long int *leniw)
+/* ----------------------------------------------------------------------------
+ * Function to free an incomplete factorization object
+ */
+
+void SUNSparseMatrix_ILUFree(SUNSparseILU ilu)
 {
-  *lenrw = SM_NNZ_S(A);
-  *leniw = 10 + SM_NP_S(A) + SM_NNZ_S(A);
-  return SUNMAT_SUCCESS;
+  if (ilu == NULL) return;
+  free(ilu->rowptr);
+  free(ilu->colind);
+  free(ilu->diag);
+  free(ilu->vals);
+  free(ilu->aptr);
+  free(ilu->aidx);
+  free(ilu->amap);
+  free(ilu->levptrL);
+  free(ilu->levrowL);
+  free(ilu->levptrU);
+  free(ilu->levrowU);
+  free(ilu->iwork);
+  free(ilu->rwork);
+  free(ilu);
 }
 
 
@@ -1165,6 +1310,437 @@ int Matvec_SparseCSR(SUNMatrix A, N_Vector x, N_Vector y)
 }
 
 
+#ifdef _OPENMP
+
+/* -----------------------------------------------------------------
+ * Threaded version of Matvec_SparseCSC. Each thread scatters the
+ * products of a range of columns, holding about the same number of
+ * nonzeros, into its own partial result in the matrix workspace, and
+ * the partial results are then summed by rows.
+ */
+int Matvec_SparseCSC_OMP(SUNMatrix A, N_Vector x, N_Vector y)
+{
+  sunindextype M, *Ap, *Ai;
+  realtype *Ax, *xd, *yd, *work;
+
+  /* access data from CSC structure (return if failure) */
+  Ap = SM_INDEXPTRS_S(A);
+  Ai = SM_INDEXVALS_S(A);
+  Ax = SM_DATA_S(A);
+  work = SM_CONTENT_S(A)->work;
+  if ((Ap == NULL) || (Ai == NULL) || (Ax == NULL) || (work == NULL))
+    return SUNMAT_MEM_FAIL;
+
+  /* access vector data (return if failure) */
+  xd = N_VGetArrayPointer(x);
+  yd = N_VGetArrayPointer(y);
+  if ((xd == NULL) || (yd == NULL) || (xd == yd) )
+    return SUNMAT_MEM_FAIL;
+
+  M = SM_ROWS_S(A);
+
+#pragma omp parallel num_threads(SM_NUMTHREADS_S(A))
+  {
+    sunindextype i, j, j0, j1, t, nthreads;
+    realtype *w, sum;
+
+    nthreads = (sunindextype) omp_get_num_threads();
+
+    /* scatter the products of this thread's columns */
+    w = work + omp_get_thread_num() * M;
+    for (i=0; i<M; i++)
+      w[i] = ZERO;
+
+    nnzRange(Ap, SM_COLUMNS_S(A), &j0, &j1);
+    for (j=j0; j<j1; j++)
+      for (i=Ap[j]; i<Ap[j+1]; i++)
+        w[Ai[i]] += Ax[i]*xd[j];
+
+    /* sum the partial results */
+#pragma omp barrier
+#pragma omp for schedule(static)
+    for (i=0; i<M; i++) {
+      sum = ZERO;
+      for (t=0; t<nthreads; t++)
+        sum += work[t*M + i];
+      yd[i] = sum;
+    }
+  }
+
+  return SUNMAT_SUCCESS;
+}
+
+
+/* -----------------------------------------------------------------
+ * Threaded version of Matvec_SparseCSR. The rows are split into one
+ * contiguous range per thread holding about the same number of
+ * nonzeros, and the product along each row is a SIMD reduction.
+ */
+int Matvec_SparseCSR_OMP(SUNMatrix A, N_Vector x, N_Vector y)
+{
+  sunindextype *Ap, *Aj;
+  realtype *Ax, *xd, *yd;
+
+  /* access data from CSR structure (return if failure) */
+  Ap = SM_INDEXPTRS_S(A);
+  Aj = SM_INDEXVALS_S(A);
+  Ax = SM_DATA_S(A);
+  if ((Ap == NULL) || (Aj == NULL) || (Ax == NULL))
+    return SUNMAT_MEM_FAIL;
+
+  /* access vector data (return if failure) */
+  xd = N_VGetArrayPointer(x);
+  yd = N_VGetArrayPointer(y);
+  if ((xd == NULL) || (yd == NULL) || (xd == yd))
+    return SUNMAT_MEM_FAIL;
+
+#pragma omp parallel num_threads(SM_NUMTHREADS_S(A))
+  {
+    sunindextype i, j, i0, i1;
+    realtype sum;
+
+    nnzRange(Ap, SM_ROWS_S(A), &i0, &i1);
+    for (i=i0; i<i1; i++) {
+      sum = ZERO;
+#pragma omp simd reduction(+:sum)
+      for (j=Ap[i]; j<Ap[i+1]; j++)
+        sum += Ax[j]*xd[Aj[j]];
+      yd[i] = sum;
+    }
+  }
+
+  return SUNMAT_SUCCESS;
+}
+
+
+/* -----------------------------------------------------------------
+ * Range of rows (CSR) or columns (CSC) [p0, p1) handled by the calling
+ * thread, chosen so that each thread has about nnz/nthreads nonzeros.
+ */
+void nnzRange(sunindextype *Ap, sunindextype NP, sunindextype *p0,
+              sunindextype *p1)
+{
+  sunindextype tid, nthreads;
+
+  tid = (sunindextype) omp_get_thread_num();
+  nthreads = (sunindextype) omp_get_num_threads();
+
+  *p0 = nnzSplit(Ap, NP, tid, nthreads);
+  *p1 = nnzSplit(Ap, NP, tid + 1, nthreads);
+}
+
+
+/* -----------------------------------------------------------------
+ * First pointer index p with at least k/nthreads of the nonzeros in
+ * the rows (CSR) or columns (CSC) before it.
+ */
+sunindextype nnzSplit(sunindextype *Ap, sunindextype NP, sunindextype k,
+                      sunindextype nthreads)
+{
+  sunindextype nnz, target, lo, hi, mid;
+
+  if (k >= nthreads) return(NP);
+
+  /* nnz*k/nthreads split as q*k + r*k/nthreads with nnz = q*nthreads + r so
+     the product does not overflow a 32-bit sunindextype */
+  nnz = Ap[NP] - Ap[0];
+  target = Ap[0] + (nnz / nthreads) * k + ((nnz % nthreads) * k) / nthreads;
+  lo = 0;
+  hi = NP;
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    if (Ap[mid] < target) lo = mid + 1;
+    else hi = mid;
+  }
+  return(lo);
+}
+
+#endif
+
+
+/* -----------------------------------------------------------------
+ * Checks whether the map was recorded for the current patterns of A
+ * and B (B is NULL for the identity). Returns SUNTRUE if so.
+ */
+booleantype AddMap_Matches(struct _SUNSparseAddMap *map, SUNMatrix A,
+                           SUNMatrix B)
+{
+  sunindextype i, NP, *Ap, *Ai, *Bp, *Bi;
+
+  if (map == NULL)  return SUNFALSE;
+
+  NP = SM_NP_S(A);
+  Ap = SM_INDEXPTRS_S(A);
+  Ai = SM_INDEXVALS_S(A);
+  if ( (map->NP != NP) || (map->nnzA != Ap[NP]) )  return SUNFALSE;
+
+  for (i=0; i<=NP; i++)
+    if (Ap[i] != map->Ap[i])  return SUNFALSE;
+  for (i=0; i<map->nnzA; i++)
+    if (Ai[i] != map->Ai[i])  return SUNFALSE;
+
+  if (B == NULL)  return SUNTRUE;
+
+  Bp = SM_INDEXPTRS_S(B);
+  Bi = SM_INDEXVALS_S(B);
+  if (map->nnzB != Bp[NP])  return SUNFALSE;
+
+  for (i=0; i<=NP; i++)
+    if (Bp[i] != map->Bp[i])  return SUNFALSE;
+  for (i=0; i<map->nnzB; i++)
+    if (Bi[i] != map->Bi[i])  return SUNFALSE;
+
+  return SUNTRUE;
+}
+
+
+/* -----------------------------------------------------------------
+ * Records the pattern of c*A + B (B is NULL for the identity) and the
+ * locations of the entries of A and B in it. Entries of B that are
+ * missing from A are inserted in increasing order before the first
+ * entry of A with a larger index, so sorted columns (rows) stay sorted
+ * and the locations of the entries of A never decrease.
+ * Returns 0 if successful, nonzero if unsuccessful.
+ */
+int AddMap_Build(SUNMatrix A, SUNMatrix B, struct _SUNSparseAddMap **mapout)
+{
+  sunindextype i, j, k, p, q, nmiss, M, NP, nnzA, nnzB, nnzC;
+  sunindextype *Ap, *Ai, *Bp, *Bi, *tag, *pos, *miss;
+  struct _SUNSparseAddMap *map;
+  int retval;
+
+  /* store shortcuts to matrix dimensions (M is inner dimension) */
+  M  = (SM_SPARSETYPE_S(A) == CSC_MAT) ? SM_ROWS_S(A) : SM_COLUMNS_S(A);
+  NP = SM_NP_S(A);
+  Ap = SM_INDEXPTRS_S(A);
+  Ai = SM_INDEXVALS_S(A);
+  nnzA = Ap[NP];
+
+  retval = SUNMAT_MEM_FAIL;
+  Bp = Bi = tag = pos = miss = NULL;
+  map = NULL;
+
+  /* use the pattern of B or build the pattern of the identity */
+  if (B != NULL) {
+    Bp = SM_INDEXPTRS_S(B);
+    Bi = SM_INDEXVALS_S(B);
+    nnzB = Bp[NP];
+  } else {
+    nnzB = SUNMIN(M, NP);
+    Bp = (sunindextype *) malloc((NP+1) * sizeof(sunindextype));
+    Bi = (sunindextype *) malloc(SUNMAX(nnzB,1) * sizeof(sunindextype));
+    if ( (Bp == NULL) || (Bi == NULL) )  goto cleanup;
+    for (j=0; j<=NP; j++)  Bp[j] = SUNMIN(j, nnzB);
+    for (k=0; k<nnzB; k++)  Bi[k] = k;
+  }
+
+  /* create work arrays (tag[i] == j if index i is in column j) */
+  tag  = (sunindextype *) malloc(M * sizeof(sunindextype));
+  pos  = (sunindextype *) malloc(M * sizeof(sunindextype));
+  miss = (sunindextype *) malloc(M * sizeof(sunindextype));
+  if ( (tag == NULL) || (pos == NULL) || (miss == NULL) )  goto cleanup;
+  for (i=0; i<M; i++)  tag[i] = -1;
+
+  /* count the entries of B missing from A */
+  nnzC = nnzA;
+  for (j=0; j<NP; j++) {
+    for (p=Ap[j]; p<Ap[j+1]; p++)  tag[Ai[p]] = j;
+    for (k=Bp[j]; k<Bp[j+1]; k++) {
+      if (tag[Bi[k]] != j) {
+        tag[Bi[k]] = j;
+        nnzC++;
+      }
+    }
+  }
+  for (i=0; i<M; i++)  tag[i] = -1;
+
+  /* create the map and save the current patterns */
+  map = (struct _SUNSparseAddMap *) calloc(1, sizeof(*map));
+  if (map == NULL)  goto cleanup;
+  map->NP   = NP;
+  map->nnzA = nnzA;
+  map->nnzB = nnzB;
+  map->nnzC = nnzC;
+
+  map->Ap   = (sunindextype *) malloc((NP+1) * sizeof(sunindextype));
+  map->Ai   = (sunindextype *) malloc(SUNMAX(nnzA,1) * sizeof(sunindextype));
+  map->bmap = (sunindextype *) malloc(SUNMAX(nnzB,1) * sizeof(sunindextype));
+  if ( (map->Ap == NULL) || (map->Ai == NULL) || (map->bmap == NULL) )
+    goto cleanup;
+  for (j=0; j<=NP; j++)  map->Ap[j] = Ap[j];
+  for (p=0; p<nnzA; p++)  map->Ai[p] = Ai[p];
+
+  if (B != NULL) {
+    map->Bp = (sunindextype *) malloc((NP+1) * sizeof(sunindextype));
+    map->Bi = (sunindextype *) malloc(SUNMAX(nnzB,1) * sizeof(sunindextype));
+    if ( (map->Bp == NULL) || (map->Bi == NULL) )  goto cleanup;
+    for (j=0; j<=NP; j++)  map->Bp[j] = Bp[j];
+    for (k=0; k<nnzB; k++)  map->Bi[k] = Bi[k];
+  }
+
+  /*   case 1: A already contains the pattern of B */
+  if (nnzC == nnzA) {
+
+    for (j=0; j<NP; j++) {
+      for (p=Ap[j]; p<Ap[j+1]; p++)  pos[Ai[p]] = p;
+      for (k=Bp[j]; k<Bp[j+1]; k++)  map->bmap[k] = pos[Bi[k]];
+    }
+
+  /*   case 2: merge the patterns of A and B */
+  } else {
+
+    map->Cp   = (sunindextype *) malloc((NP+1) * sizeof(sunindextype));
+    map->Ci   = (sunindextype *) malloc(nnzC * sizeof(sunindextype));
+    map->amap = (sunindextype *) malloc(SUNMAX(nnzA,1) * sizeof(sunindextype));
+    if ( (map->Cp == NULL) || (map->Ci == NULL) || (map->amap == NULL) )
+      goto cleanup;
+
+    q = 0;
+    for (j=0; j<NP; j++) {
+      map->Cp[j] = q;
+
+      /* collect the sorted entries of B missing from this column of A */
+      for (p=Ap[j]; p<Ap[j+1]; p++)  tag[Ai[p]] = j;
+      nmiss = 0;
+      for (k=Bp[j]; k<Bp[j+1]; k++) {
+        if (tag[Bi[k]] != j) {
+          tag[Bi[k]] = j;
+          miss[nmiss++] = Bi[k];
+        }
+      }
+      qsort(miss, nmiss, sizeof(sunindextype), compare_indices);
+
+      /* merge the missing entries into the column of A */
+      k = 0;
+      for (p=Ap[j]; p<Ap[j+1]; p++) {
+        while ( (k < nmiss) && (miss[k] < Ai[p]) )
+          map->Ci[q++] = miss[k++];
+        map->amap[p] = q;
+        map->Ci[q++] = Ai[p];
+      }
+      while (k < nmiss)  map->Ci[q++] = miss[k++];
+
+      /* locate the entries of B in the merged column */
+      for (p=map->Cp[j]; p<q; p++)  pos[map->Ci[p]] = p;
+      for (k=Bp[j]; k<Bp[j+1]; k++)  map->bmap[k] = pos[Bi[k]];
+    }
+    map->Cp[NP] = q;
+
+  }
+
+  *mapout = map;
+  map = NULL;
+  retval = SUNMAT_SUCCESS;
+
+ cleanup:
+  if (B == NULL) {
+    free(Bp);
+    free(Bi);
+  }
+  free(tag);
+  free(pos);
+  free(miss);
+  AddMap_Free(&map);
+  return(retval);
+}
+
+
+/* -----------------------------------------------------------------
+ * Computes A = c*A + B (B is NULL for the identity) with a map
+ * recorded for the current patterns of A and B. When the pattern
+ * grows, the entries of A are moved back to front into their new
+ * locations, which is safe in place since an entry never moves to a
+ * lower location.
+ * Returns 0 if successful, nonzero if unsuccessful.
+ */
+int AddMap_Apply(realtype c, SUNMatrix A, SUNMatrix B,
+                 struct _SUNSparseAddMap *map)
+{
+  sunindextype p, q, k;
+  sunindextype *Ap, *Ai, *bmap;
+  realtype *Ax, *Bx;
+
+  /* ensure A has storage for the result */
+  if (SM_NNZ_S(A) < map->nnzC) {
+    if (SUNSparseMatrix_Reallocate(A, map->nnzC) != SUNMAT_SUCCESS)
+      return(SUNMAT_MEM_FAIL);
+    if ( (SM_DATA_S(A) == NULL) || (SM_INDEXVALS_S(A) == NULL) )
+      return(SUNMAT_MEM_FAIL);
+  }
+
+  Ap = SM_INDEXPTRS_S(A);
+  Ai = SM_INDEXVALS_S(A);
+  Ax = SM_DATA_S(A);
+  bmap = map->bmap;
+
+  /* B may be A itself, in which case the pattern is unchanged */
+  if (B == A) {
+    for (p=0; p<map->nnzA; p++)
+      Ax[p] = c*Ax[p] + Ax[p];
+    return(SUNMAT_SUCCESS);
+  }
+
+  /* scale A, moving its entries into the merged pattern if necessary */
+  if (map->Ci == NULL) {
+    for (p=0; p<map->nnzA; p++)
+      Ax[p] *= c;
+  } else {
+    q = map->nnzC - 1;
+    for (p=map->nnzA-1; p>=0; p--) {
+      for (; q>map->amap[p]; q--)  Ax[q] = ZERO;
+      Ax[q--] = c*Ax[p];
+    }
+    for (; q>=0; q--)  Ax[q] = ZERO;
+
+    for (q=0; q<map->nnzC; q++)  Ai[q] = map->Ci[q];
+    for (k=0; k<=map->NP; k++)  Ap[k] = map->Cp[k];
+  }
+
+  /* add B */
+  if (B == NULL) {
+    for (k=0; k<map->nnzB; k++)
+      Ax[bmap[k]] += ONE;
+  } else {
+    Bx = SM_DATA_S(B);
+    for (k=0; k<map->nnzB; k++)
+      Ax[bmap[k]] += Bx[k];
+  }
+
+  return(SUNMAT_SUCCESS);
+}
+
+
+/* -----------------------------------------------------------------
+ * Frees a pattern map and sets the pointer to NULL.
+ */
+void AddMap_Free(struct _SUNSparseAddMap **map)
+{
+  if (*map == NULL)  return;
+
+  free((*map)->Ap);
+  free((*map)->Ai);
+  free((*map)->Bp);
+  free((*map)->Bi);
+  free((*map)->Cp);
+  free((*map)->Ci);
+  free((*map)->amap);
+  free((*map)->bmap);
+  free(*map);
+  *map = NULL;
+}
+
+
+/* -----------------------------------------------------------------
+ * Comparison function for sorting indices with qsort.
+ */
+int compare_indices(const void *a, const void *b)
+{
+  sunindextype ia = *((const sunindextype *) a);
+  sunindextype ib = *((const sunindextype *) b);
+  return( (ia > ib) - (ia < ib) );
+}
+
+
 /* -----------------------------------------------------------------
  * Copies A into a matrix B in the opposite format of A.
  * Returns 0 if successful, nonzero if unsuccessful.
@@ -1234,3 +1810,35 @@ int format_convert(const SUNMatrix A, SUNMatrix B)
 
     return 0;
 }
+
+/* -----------------------------------------------------------------
+ * Groups the rows 0,...,N-1 by the level array lev into the arrays
+ * levptr (length nlev+1) and levrow (length N) so that the rows of
+ * level l are levrow[levptr[l]],...,levrow[levptr[l+1]-1].
+ * Returns 0 if successful, nonzero if unsuccessful.
+ */
+static int ILU_LevelSchedule(sunindextype N, sunindextype *lev,
+                             sunindextype *nlev, sunindextype **levptr,
+                             sunindextype **levrow)
+{
+  sunindextype i, l, n;
+
+  n = 0;
+  for (i=0; i<N; i++) n = SUNMAX(n, lev[i]+1);
+
+  *nlev   = n;
+  *levptr = (sunindextype*) calloc(n+1, sizeof(sunindextype));
+  *levrow = (sunindextype*) malloc(SUNMAX(N,1) * sizeof(sunindextype));
+  if ((*levptr == NULL) || (*levrow == NULL)) return(-1);
+
+  for (i=0; i<N; i++) (*levptr)[lev[i]+1]++;
+  for (l=0; l<n; l++) (*levptr)[l+1] += (*levptr)[l];
+  for (i=0; i<N; i++) {
+    l = lev[i];
+    (*levrow)[(*levptr)[l]++] = i;
+  }
+  for (l=n; l>0; l--) (*levptr)[l] = (*levptr)[l-1];
+  (*levptr)[0] = 0;
+
+  return(0);
+}
@@ -24,14 +24,20 @@
 #include <sundials/sundials_nvector_senswrapper.h>
 
 #include "sundials_context_impl.h"
+#include "sundials_iterative_impl.h"
 #include "sundials_logger_impl.h"
 
 /* Internal utility routines */
 static int AndersonAccelerate(SUNNonlinearSolver NLS, N_Vector gval, N_Vector x,
                               N_Vector xold, int iter);
+static int QRAdd_MGS(N_Vector *Q, realtype *R, N_Vector df, int m, int mMax,
+                     void *QRdata);
+static int QRDelete(SUNNonlinearSolver NLS, N_Vector vtemp);
+static realtype ConditionR(SUNNonlinearSolver NLS);
 
 static int AllocateContent(SUNNonlinearSolver NLS, N_Vector tmpl);
 static void FreeContent(SUNNonlinearSolver NLS);
+static void FreeQRData(SUNNonlinearSolver NLS);
 
 /* Content structure accessibility macros */
 #define FP_CONTENT(S)  ( (SUNNonlinearSolverContent_FixedPoint)(S->content) )
@@ -99,6 +105,12 @@ SUNNonlinearSolver SUNNonlinSol_FixedPoint(N_Vector y, int m, SUNContext sunctx)
   content->niters      = 0;
   content->nconvfails  = 0;
   content->ctest_data  = NULL;
+  content->qr_func     = NULL;
+  content->qr_data     = NULL;
+  content->maxcond     = ZERO;
+  content->naa         = 0;
+  content->inext       = 0;
+  content->nrestarts   = 0;
   content->print_level = 0;
   content->info_file   = stdout;
 #if SUNDIALS_LOGGING_LEVEL >= SUNDIALS_LOGGING_INFO
@@ -156,9 +168,10 @@ int SUNNonlinSolInitialize_FixedPoint(SUNNonlinearSolver NLS)
   if ( (FP_CONTENT(NLS)->Sys == NULL) || (FP_CONTENT(NLS)->CTest == NULL) )
     return(SUN_NLS_MEM_NULL);
 
-  /* reset the total number of iterations and convergence failures */
+  /* reset the total number of iterations, convergence failures and restarts */
   FP_CONTENT(NLS)->niters     = 0;
   FP_CONTENT(NLS)->nconvfails = 0;
+  FP_CONTENT(NLS)->nrestarts  = 0;
 
   return(SUN_NLS_SUCCESS);
 }
@@ -395,6 +408,69 @@ int SUNNonlinSolSetDamping_FixedPoint(SUNNonlinearSolver NLS, realtype beta)
 }
 
 
+int SUNNonlinSolSetQRAdd_FixedPoint(SUNNonlinearSolver NLS, SUNQRAddFn qr_func)
+{
+  int m;
+  N_Vector y;
+
+  /* check that the nonlinear solver is non-null */
+  if (NLS == NULL)
+    return(SUN_NLS_MEM_NULL);
+
+  m = FP_CONTENT(NLS)->m;
+  y = FP_CONTENT(NLS)->yprev;
+
+  /* single buffer reductions require the local dot products and allreduce */
+  if ( (qr_func == SUNQRAdd_ICWY_SB) || (qr_func == SUNQRAdd_DCGS2_SB) ) {
+    if ( ((y->ops->nvdotprodlocal == NULL) &&
+          (y->ops->nvdotprodmultilocal == NULL)) ||
+         (y->ops->nvdotprodmultiallreduce == NULL) )
+      return(SUN_NLS_ILL_INPUT);
+  }
+
+  /* free any existing workspace */
+  FreeQRData(NLS);
+  FP_CONTENT(NLS)->qr_func = NULL;
+
+  /* use the built-in orthogonalization without acceleration or on request */
+  if ( (m == 0) || (qr_func == NULL) )
+    return(SUN_NLS_SUCCESS);
+
+  /* allocate the workspace, the first vector is set on each call */
+  FP_CONTENT(NLS)->qr_data = (struct _SUNQRData *)
+    malloc(sizeof *(FP_CONTENT(NLS)->qr_data));
+  if (FP_CONTENT(NLS)->qr_data == NULL)
+    return(SUN_NLS_MEM_FAIL);
+  FP_CONTENT(NLS)->qr_data->vtemp = NULL;
+
+  FP_CONTENT(NLS)->qr_data->vtemp2 = N_VClone(y);
+  FP_CONTENT(NLS)->qr_data->temp_array =
+    (realtype *) malloc((m*m) * sizeof(realtype));
+  if ( (FP_CONTENT(NLS)->qr_data->vtemp2 == NULL) ||
+       (FP_CONTENT(NLS)->qr_data->temp_array == NULL) ) {
+    FreeQRData(NLS);
+    return(SUN_NLS_MEM_FAIL);
+  }
+
+  FP_CONTENT(NLS)->qr_func = qr_func;
+  return(SUN_NLS_SUCCESS);
+}
+
+int SUNNonlinSolSetMaxCond_FixedPoint(SUNNonlinearSolver NLS, realtype maxcond)
+{
+  /* check that the nonlinear solver is non-null */
+  if (NLS == NULL)
+    return(SUN_NLS_MEM_NULL);
+
+  /* check that maxcond is valid (zero disables the limit) */
+  if ( (maxcond < ZERO) || ((maxcond > ZERO) && (maxcond < ONE)) )
+    return(SUN_NLS_ILL_INPUT);
+
+  FP_CONTENT(NLS)->maxcond = maxcond;
+  return(SUN_NLS_SUCCESS);
+}
+
+
 /*==============================================================================
   Get functions
   ============================================================================*/
@@ -447,6 +523,19 @@ int SUNNonlinSolGetSysFn_FixedPoint(SUNNonlinearSolver NLS, SUNNonlinSolSysFn *S
 }
 
 
+int SUNNonlinSolGetNumRestarts_FixedPoint(SUNNonlinearSolver NLS,
+                                          long int *nrestarts)
+{
+  /* check that the nonlinear solver is non-null */
+  if (NLS == NULL)
+    return(SUN_NLS_MEM_NULL);
+
+  /* return the number of acceleration subspace depth reductions */
+  *nrestarts = FP_CONTENT(NLS)->nrestarts;
+  return(SUN_NLS_SUCCESS);
+}
+
+
 /*=============================================================================
   Utility routines
   ===========================================================================*/
@@ -460,18 +549,27 @@ int SUNNonlinSolGetSysFn_FixedPoint(SUNNonlinearSolver NLS, SUNNonlinSolSysFn *S
 
   The result of the routine is held in x.
 
+  The QR factorization of the df vectors is updated with the
+  built-in modified Gram-Schmidt or the SUNQRAddFn supplied with
+  SUNNonlinSolSetQRAdd_FixedPoint. When the subspace is full the
+  oldest vector is removed, and if a condition limit is set the
+  oldest vectors are also removed while the estimated condition
+  number of R exceeds the limit.
+
   Possible return values:
-    SUN_NLS_MEM_NULL --> a required item was missing from memory
-    SUN_NLS_SUCCESS  --> successful completion
+    SUN_NLS_MEM_NULL      --> a required item was missing from memory
+    SUN_NLS_VECTOROP_ERR  --> a vector operation failed
+    SUN_NLS_SUCCESS       --> successful completion
   -------------------------------------------------------------*/
 static int AndersonAccelerate(SUNNonlinearSolver NLS, N_Vector gval,
                               N_Vector x, N_Vector xold, int iter)
 {
   /* local variables */
   int         nvec, retval, i_pt, i, j, lAA, maa, *ipt_map;
-  realtype    a, b, rtemp, c, s, beta, onembeta, *cvals, *R, *gamma;
+  realtype    beta, onembeta, *cvals, *R, *gamma;
   N_Vector    fv, vtemp, gold, fold, *df, *dg, *Q, *Xvecs;
   booleantype damping;
+  struct _SUNQRData mgs_data;
 
   /* local shortcut variables */
   vtemp   = x;    /* use result as temporary vector */
@@ -490,99 +588,60 @@ static int AndersonAccelerate(SUNNonlinearSolver NLS, N_Vector gval,
   damping = FP_CONTENT(NLS)->damping;
   beta    = FP_CONTENT(NLS)->beta;
 
-  /* reset ipt_map, i_pt */
-  for (i = 0; i < maa; i++)  ipt_map[i]=0;
-  i_pt = iter-1 - ((iter-1)/maa)*maa;
-
-  /* update dg[i_pt], df[i_pt], fv, gold and fold*/
-  N_VLinearSum(ONE, gval, -ONE, xold, fv);
-  if (iter > 0) {
-    N_VLinearSum(ONE, gval, -ONE, gold, dg[i_pt]);  /* dg_new = gval - gold */
-    N_VLinearSum(ONE, fv, -ONE, fold, df[i_pt]);    /* df_new = fv - fold */
-  }
-  N_VScale(ONE, gval, gold);
-  N_VScale(ONE, fv, fold);
-
-  /* on first iteration, just do basic fixed-point update */
+  /* on first iteration, reset the subspace and do basic fixed-point update */
   if (iter == 0) {
+    FP_CONTENT(NLS)->naa   = 0;
+    FP_CONTENT(NLS)->inext = 0;
+    N_VLinearSum(ONE, gval, -ONE, xold, fv);
+    N_VScale(ONE, gval, gold);
+    N_VScale(ONE, fv, fold);
     N_VScale(ONE, gval, x);
     return(SUN_NLS_SUCCESS);
   }
 
-  /* update data structures based on current iteration index */
-
-  if (iter == 1) {   /* second iteration */
-
-    R[0] = SUNRsqrt( N_VDotProd(df[i_pt], df[i_pt]) );
-    N_VScale(ONE/R[0], df[i_pt], Q[i_pt]);
-    ipt_map[0] = 0;
-
-  } else if (iter <= maa) {   /* another iteration before we've reached maa */
+  /* if the subspace is full, delete the oldest vector to free its slot */
+  if (FP_CONTENT(NLS)->naa == maa) {
+    retval = QRDelete(NLS, vtemp);
+    if (retval != SUN_NLS_SUCCESS)  return(retval);
+  }
 
-    N_VScale(ONE, df[i_pt], vtemp);
-    for (j = 0; j < iter-1; j++) {
-      ipt_map[j] = j;
-      R[(iter-1)*maa+j] = N_VDotProd(Q[j], vtemp);
-      N_VLinearSum(ONE, vtemp, -R[(iter-1)*maa+j], Q[j], vtemp);
-    }
-    R[(iter-1)*maa+iter-1] = SUNRsqrt( N_VDotProd(vtemp, vtemp) );
-    if (R[(iter-1)*maa+iter-1] == ZERO) {
-      N_VScale(ZERO, vtemp, Q[i_pt]);
-    } else {
-      N_VScale((ONE/R[(iter-1)*maa+iter-1]), vtemp, Q[i_pt]);
-    }
-    ipt_map[iter-1] = iter-1;
-
-  } else {   /* we've filled the acceleration subspace, so start recycling */
-
-    /* delete left-most column vector from QR factorization */
-    for (i = 0; i < maa-1; i++) {
-      a = R[(i+1)*maa + i];
-      b = R[(i+1)*maa + i+1];
-      rtemp = SUNRsqrt(a*a + b*b);
-      c = a / rtemp;
-      s = b / rtemp;
-      R[(i+1)*maa + i] = rtemp;
-      R[(i+1)*maa + i+1] = ZERO;
-      if (i < maa-1) {
-        for (j = i+2; j < maa; j++) {
-          a = R[j*maa + i];
-          b = R[j*maa + i+1];
-          rtemp = c * a + s * b;
-          R[j*maa + i+1] = -s*a + c*b;
-          R[j*maa + i] = rtemp;
-        }
-      }
-      N_VLinearSum(c, Q[i], s, Q[i+1], vtemp);
-      N_VLinearSum(-s, Q[i], c, Q[i+1], Q[i+1]);
-      N_VScale(ONE, vtemp, Q[i]);
-    }
+  /* update dg[i_pt], df[i_pt], fv, gold and fold */
+  i_pt = FP_CONTENT(NLS)->inext;
+  FP_CONTENT(NLS)->inext = (i_pt + 1) % maa;
 
-    /* ahift R to the left by one */
-    for (i = 1; i < maa; i++)
-      for (j = 0; j < maa-1; j++)
-        R[(i-1)*maa + j] = R[i*maa + j];
+  N_VLinearSum(ONE, gval, -ONE, xold, fv);
+  N_VLinearSum(ONE, gval, -ONE, gold, dg[i_pt]);  /* dg_new = gval - gold */
+  N_VLinearSum(ONE, fv, -ONE, fold, df[i_pt]);    /* df_new = fv - fold */
+  N_VScale(ONE, gval, gold);
+  N_VScale(ONE, fv, fold);
 
-    /* add the new df vector */
-    N_VScale(ONE, df[i_pt], vtemp);
-    for (j = 0; j < maa-1; j++) {
-      R[(maa-1)*maa+j] = N_VDotProd(Q[j], vtemp);
-      N_VLinearSum(ONE, vtemp, -R[(maa-1)*maa+j], Q[j], vtemp);
-    }
-    R[(maa-1)*maa+maa-1] = SUNRsqrt( N_VDotProd(vtemp, vtemp) );
-    N_VScale((ONE/R[(maa-1)*maa+maa-1]), vtemp, Q[maa-1]);
-
-    /* update the iteration map */
-    j = 0;
-    for (i = i_pt+1; i < maa; i++)
-      ipt_map[j++] = i;
-    for (i = 0; i < i_pt+1; i++)
-      ipt_map[j++] = i;
+  /* add the new df vector to the QR factorization */
+  lAA = FP_CONTENT(NLS)->naa;
+  if (FP_CONTENT(NLS)->qr_func == NULL) {
+    mgs_data.vtemp = vtemp;
+    retval = QRAdd_MGS(Q, R, df[i_pt], lAA, maa, &mgs_data);
+  } else {
+    FP_CONTENT(NLS)->qr_data->vtemp = vtemp;
+    retval = FP_CONTENT(NLS)->qr_func(Q, R, df[i_pt], lAA, maa,
+                                      FP_CONTENT(NLS)->qr_data);
+  }
+  if (retval != 0)  return(SUN_NLS_VECTOROP_ERR);
+  ipt_map[lAA] = i_pt;
+  FP_CONTENT(NLS)->naa = ++lAA;
+
+  /* if the conditioning of R has degraded, reduce the subspace depth */
+  if ( (FP_CONTENT(NLS)->maxcond > ZERO) && (lAA > 1) &&
+       (ConditionR(NLS) > FP_CONTENT(NLS)->maxcond) ) {
+    FP_CONTENT(NLS)->nrestarts++;
+    do {
+      retval = QRDelete(NLS, vtemp);
+      if (retval != SUN_NLS_SUCCESS)  return(retval);
+    } while ( (FP_CONTENT(NLS)->naa > 1) &&
+              (ConditionR(NLS) > FP_CONTENT(NLS)->maxcond) );
+    lAA = FP_CONTENT(NLS)->naa;
   }
 
   /* solve least squares problem and update solution */
-  lAA = iter;
-  if (maa < iter)  lAA = maa;
   retval = N_VDotProdMulti(lAA, fv, Q, gamma);
   if (retval != 0)  return(SUN_NLS_VECTOROP_ERR);
 
@@ -623,6 +682,138 @@ static int AndersonAccelerate(SUNNonlinearSolver NLS, N_Vector gval,
   return(SUN_NLS_SUCCESS);
 }
 
+/*---------------------------------------------------------------
+  QRAdd_MGS
+
+  Built-in modified Gram-Schmidt update of the QR factorization,
+  a SUNQRAddFn that leaves a zero column in Q when df is in the
+  span of the existing columns.
+  -------------------------------------------------------------*/
+static int QRAdd_MGS(N_Vector *Q, realtype *R, N_Vector df, int m, int mMax,
+                     void *QRdata)
+{
+  int j;
+  N_Vector vtemp = ((struct _SUNQRData *) QRdata)->vtemp;
+
+  N_VScale(ONE, df, vtemp);
+  for (j = 0; j < m; j++) {
+    R[m*mMax+j] = N_VDotProd(Q[j], vtemp);
+    N_VLinearSum(ONE, vtemp, -R[m*mMax+j], Q[j], vtemp);
+  }
+  R[m*mMax+m] = SUNRsqrt( N_VDotProd(vtemp, vtemp) );
+  if (R[m*mMax+m] == ZERO) {
+    N_VScale(ZERO, vtemp, Q[m]);
+  } else {
+    N_VScale((ONE/R[m*mMax+m]), vtemp, Q[m]);
+  }
+
+  return(0);
+}
+
+/*---------------------------------------------------------------
+  QRDelete
+
+  Removes the oldest (left-most) column from the QR factorization
+  with Givens rotations and shifts the remaining columns and the
+  iteration map to the left. For the inverse compact WY updates
+  the triangular matrix T held in the QR workspace is rebuilt for
+  the rotated Q.
+  -------------------------------------------------------------*/
+static int QRDelete(SUNNonlinearSolver NLS, N_Vector vtemp)
+{
+  int       i, j, naa, maa, retval, *ipt_map;
+  realtype  a, b, rtemp, c, s, *R, *T;
+  N_Vector *Q;
+
+  naa     = FP_CONTENT(NLS)->naa;
+  maa     = FP_CONTENT(NLS)->m;
+  ipt_map = FP_CONTENT(NLS)->imap;
+  R       = FP_CONTENT(NLS)->R;
+  Q       = FP_CONTENT(NLS)->q;
+
+  /* delete left-most column vector from QR factorization */
+  for (i = 0; i < naa-1; i++) {
+    a = R[(i+1)*maa + i];
+    b = R[(i+1)*maa + i+1];
+    rtemp = SUNRsqrt(a*a + b*b);
+    c = a / rtemp;
+    s = b / rtemp;
+    R[(i+1)*maa + i] = rtemp;
+    R[(i+1)*maa + i+1] = ZERO;
+    for (j = i+2; j < naa; j++) {
+      a = R[j*maa + i];
+      b = R[j*maa + i+1];
+      rtemp = c * a + s * b;
+      R[j*maa + i+1] = -s*a + c*b;
+      R[j*maa + i] = rtemp;
+    }
+    N_VLinearSum(c, Q[i], s, Q[i+1], vtemp);
+    N_VLinearSum(-s, Q[i], c, Q[i+1], Q[i+1]);
+    N_VScale(ONE, vtemp, Q[i]);
+  }
+
+  /* shift R and the iteration map to the left by one */
+  for (i = 1; i < naa; i++) {
+    for (j = 0; j < naa-1; j++)
+      R[(i-1)*maa + j] = R[i*maa + j];
+    ipt_map[i-1] = ipt_map[i];
+  }
+  FP_CONTENT(NLS)->naa = --naa;
+
+  /* rebuild T = Q^T Q (lower part) for the inverse compact WY updates,
+     the last column is filled by the next update */
+  if ( (FP_CONTENT(NLS)->qr_func == SUNQRAdd_ICWY) ||
+       (FP_CONTENT(NLS)->qr_func == SUNQRAdd_ICWY_SB) ) {
+    T = FP_CONTENT(NLS)->qr_data->temp_array;
+    for (i = 0; i < maa*maa; i++)  T[i] = ZERO;
+    if (FP_CONTENT(NLS)->qr_func == SUNQRAdd_ICWY_SB) {
+      for (i = 1; i < naa-1; i++) {
+        retval = N_VDotProdMultiLocal(i, Q[i], Q, T + i*maa);
+        if (retval != 0)  return(SUN_NLS_VECTOROP_ERR);
+      }
+      if (naa > 2) {
+        retval = N_VDotProdMultiAllReduce((naa-1)*maa, vtemp, T);
+        if (retval != 0)  return(SUN_NLS_VECTOROP_ERR);
+      }
+    } else {
+      for (i = 1; i < naa-1; i++) {
+        retval = N_VDotProdMulti(i, Q[i], Q, T + i*maa);
+        if (retval != 0)  return(SUN_NLS_VECTOROP_ERR);
+      }
+    }
+    for (i = 0; i < naa-1; i++)  T[i*maa + i] = ONE;
+  }
+
+  return(SUN_NLS_SUCCESS);
+}
+
+/*---------------------------------------------------------------
+  ConditionR
+
+  Returns the ratio of the largest to the smallest diagonal entry
+  of R (in magnitude) as an inexpensive estimate of its condition
+  number. A zero diagonal entry gives an infinite estimate.
+  -------------------------------------------------------------*/
+static realtype ConditionR(SUNNonlinearSolver NLS)
+{
+  int      i, naa, maa;
+  realtype rmin, rmax, rii, *R;
+
+  naa = FP_CONTENT(NLS)->naa;
+  maa = FP_CONTENT(NLS)->m;
+  R   = FP_CONTENT(NLS)->R;
+
+  rmin = rmax = SUNRabs(R[0]);
+  for (i = 1; i < naa; i++) {
+    rii  = SUNRabs(R[i*maa + i]);
+    rmin = SUNMIN(rmin, rii);
+    rmax = SUNMAX(rmax, rii);
+  }
+
+  if (rmin == ZERO)  return(SUN_BIG_REAL);
+  return(rmax / rmin);
+}
+
 static int AllocateContent(SUNNonlinearSolver NLS, N_Vector y)
 {
   int m = FP_CONTENT(NLS)->m;
@@ -737,6 +928,24 @@ static void FreeContent(SUNNonlinearSolver NLS)
     free(FP_CONTENT(NLS)->Xvecs);
     FP_CONTENT(NLS)->Xvecs = NULL; }
 
+  FreeQRData(NLS);
+
+  return;
+}
+
+static void FreeQRData(SUNNonlinearSolver NLS)
+{
+  if (FP_CONTENT(NLS)->qr_data == NULL) return;
+
+  if (FP_CONTENT(NLS)->qr_data->vtemp2)
+    N_VDestroy(FP_CONTENT(NLS)->qr_data->vtemp2);
+
+  if (FP_CONTENT(NLS)->qr_data->temp_array)
+    free(FP_CONTENT(NLS)->qr_data->temp_array);
+
+  free(FP_CONTENT(NLS)->qr_data);
+  FP_CONTENT(NLS)->qr_data = NULL;
+
   return;
 }
 
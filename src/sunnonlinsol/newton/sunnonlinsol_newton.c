@@ -31,8 +31,19 @@
 
 /* Constant macros */
 #define ZERO RCONST(0.0) /* real 0.0 */
+#define PT1  RCONST(0.1) /* real 0.1 */
 #define ONE  RCONST(1.0) /* real 1.0 */
 
+/* Default Eisenstat-Walker forcing term parameters */
+#define ETA0_DEFAULT    RCONST(0.1)
+#define ETAMAX_DEFAULT  RCONST(0.9)
+#define EGAMMA_DEFAULT  RCONST(0.9)
+#define EALPHA_DEFAULT  RCONST(2.0)
+
+/* Private function prototypes */
+static void UpdateForcingTerm(SUNNonlinearSolver NLS, N_Vector fvec,
+                              N_Vector w);
+
 /*==============================================================================
   Constructor to create a new Newton solver
   ============================================================================*/
@@ -69,6 +80,7 @@ SUNNonlinearSolver SUNNonlinSol_Newton(N_Vector y, SUNContext sunctx)
   NLS->ops->getnumiters     = SUNNonlinSolGetNumIters_Newton;
   NLS->ops->getcuriter      = SUNNonlinSolGetCurIter_Newton;
   NLS->ops->getnumconvfails = SUNNonlinSolGetNumConvFails_Newton;
+  NLS->ops->getforcingterm  = SUNNonlinSolGetForcingTerm_Newton;
 
   /* Create content */
   content = NULL;
@@ -92,6 +104,13 @@ SUNNonlinearSolver SUNNonlinSol_Newton(N_Vector y, SUNContext sunctx)
   content->niters      = 0;
   content->nconvfails  = 0;
   content->ctest_data  = NULL;
+  content->forcing     = SUNFALSE;
+  content->eta         = ZERO;
+  content->eta0        = ETA0_DEFAULT;
+  content->eta_max     = ETAMAX_DEFAULT;
+  content->egamma      = EGAMMA_DEFAULT;
+  content->ealpha      = EALPHA_DEFAULT;
+  content->fnorm       = ZERO;
   content->print_level = 0;
   content->info_file   = stdout;
 #if SUNDIALS_LOGGING_LEVEL >= SUNDIALS_LOGGING_INFO
@@ -261,6 +280,9 @@ int SUNNonlinSolSolve_Newton(SUNNonlinearSolver NLS,
       /* increment nonlinear solver iteration counter */
       NEWTON_CONTENT(NLS)->niters++;
 
+      /* update the forcing term for the linear solve */
+      if (NEWTON_CONTENT(NLS)->forcing) UpdateForcingTerm(NLS, delta, w);
+
       /* compute the negative of the residual for the linear system rhs */
       N_VScale(-ONE, delta, delta);
 
@@ -293,6 +315,7 @@ int SUNNonlinSolSolve_Newton(SUNNonlinearSolver NLS,
       /* if successful update Jacobian status and return */
       if (retval == SUN_NLS_SUCCESS) {
         NEWTON_CONTENT(NLS)->jcur = SUNFALSE;
+        NEWTON_CONTENT(NLS)->eta  = ZERO;
         return(SUN_NLS_SUCCESS);
       }
 
@@ -333,6 +356,9 @@ int SUNNonlinSolSolve_Newton(SUNNonlinearSolver NLS,
   /* increment number of convergence failures */
   NEWTON_CONTENT(NLS)->nconvfails++;
 
+  /* the forcing term only applies to linear solves within a nonlinear solve */
+  NEWTON_CONTENT(NLS)->eta = ZERO;
+
   /* all error returns exit here */
   return(retval);
 }
@@ -449,6 +475,50 @@ int SUNNonlinSolSetMaxIters_Newton(SUNNonlinearSolver NLS, int maxiters)
 }
 
 
+int SUNNonlinSolSetForcing_Newton(SUNNonlinearSolver NLS, booleantype adaptive)
+{
+  /* check that the nonlinear solver is non-null */
+  if (NLS == NULL)
+    return(SUN_NLS_MEM_NULL);
+
+  /* the forcing term requires the residual norm */
+  if (adaptive && (NEWTON_CONTENT(NLS)->delta->ops->nvwrmsnorm == NULL))
+    return(SUN_NLS_ILL_INPUT);
+
+  NEWTON_CONTENT(NLS)->forcing = adaptive;
+  NEWTON_CONTENT(NLS)->eta     = ZERO;
+  NEWTON_CONTENT(NLS)->fnorm   = ZERO;
+  return(SUN_NLS_SUCCESS);
+}
+
+
+int SUNNonlinSolSetForcingParams_Newton(SUNNonlinearSolver NLS, realtype eta0,
+                                        realtype eta_max, realtype egamma,
+                                        realtype ealpha)
+{
+  /* check that the nonlinear solver is non-null */
+  if (NLS == NULL)
+    return(SUN_NLS_MEM_NULL);
+
+  /* non-positive values select the defaults */
+  if (eta0    <= ZERO) eta0    = ETA0_DEFAULT;
+  if (eta_max <= ZERO) eta_max = ETAMAX_DEFAULT;
+  if (egamma  <= ZERO) egamma  = EGAMMA_DEFAULT;
+  if (ealpha  <= ZERO) ealpha  = EALPHA_DEFAULT;
+
+  /* check that the parameters are valid */
+  if ( (eta_max >= ONE) || (eta0 > eta_max) ||
+       (egamma > ONE) || (ealpha <= ONE) || (ealpha > RCONST(2.0)) )
+    return(SUN_NLS_ILL_INPUT);
+
+  NEWTON_CONTENT(NLS)->eta0    = eta0;
+  NEWTON_CONTENT(NLS)->eta_max = eta_max;
+  NEWTON_CONTENT(NLS)->egamma  = egamma;
+  NEWTON_CONTENT(NLS)->ealpha  = ealpha;
+  return(SUN_NLS_SUCCESS);
+}
+
+
 /*==============================================================================
   Get functions
   ============================================================================*/
@@ -489,6 +559,19 @@ int SUNNonlinSolGetNumConvFails_Newton(SUNNonlinearSolver NLS, long int *nconvfa
 }
 
 
+int SUNNonlinSolGetForcingTerm_Newton(SUNNonlinearSolver NLS, realtype *eta)
+{
+  /* check that the nonlinear solver is non-null */
+  if (NLS == NULL)
+    return(SUN_NLS_MEM_NULL);
+
+  /* return the forcing term for the current linear solve (zero if disabled or
+     called outside of a nonlinear solve) */
+  *eta = (NEWTON_CONTENT(NLS)->forcing) ? NEWTON_CONTENT(NLS)->eta : ZERO;
+  return(SUN_NLS_SUCCESS);
+}
+
+
 int SUNNonlinSolGetSysFn_Newton(SUNNonlinearSolver NLS, SUNNonlinSolSysFn *SysFn)
 {
   /* check that the nonlinear solver is non-null */
@@ -527,3 +610,46 @@ int SUNNonlinSolSetPrintLevel_Newton(SUNNonlinearSolver NLS,
 
   return(SUN_NLS_SUCCESS);
 }
+
+
+/*==============================================================================
+  Private functions
+  ============================================================================*/
+
+/*------------------------------------------------------------------------------
+  UpdateForcingTerm: Computes the Eisenstat-Walker forcing term (choice 2)
+
+    eta_k = gamma * (||F_k|| / ||F_{k-1}||)^alpha
+
+  for the linear solve in the current Newton iteration, where F_k is the
+  nonlinear residual (fvec) and the norm is the WRMS norm with weights w. The
+  first iteration of each solve attempt uses eta0. To avoid oversolving when
+  the residual drops sharply, eta_k is not allowed to fall below
+  gamma * eta_{k-1}^alpha when that value exceeds 0.1, and eta_k is capped at
+  eta_max.
+  ----------------------------------------------------------------------------*/
+static void UpdateForcingTerm(SUNNonlinearSolver NLS, N_Vector fvec,
+                              N_Vector w)
+{
+  realtype fnorm, eta, etasafe;
+
+  fnorm = N_VWrmsNorm(fvec, w);
+
+  if ( (NEWTON_CONTENT(NLS)->curiter == 0) ||
+       (NEWTON_CONTENT(NLS)->fnorm <= ZERO) ) {
+    eta = NEWTON_CONTENT(NLS)->eta0;
+  } else {
+    eta = NEWTON_CONTENT(NLS)->egamma *
+      SUNRpowerR(fnorm / NEWTON_CONTENT(NLS)->fnorm,
+                 NEWTON_CONTENT(NLS)->ealpha);
+
+    etasafe = NEWTON_CONTENT(NLS)->egamma *
+      SUNRpowerR(NEWTON_CONTENT(NLS)->eta, NEWTON_CONTENT(NLS)->ealpha);
+    if (etasafe > PT1) eta = SUNMAX(eta, etasafe);
+
+    eta = SUNMIN(eta, NEWTON_CONTENT(NLS)->eta_max);
+  }
+
+  NEWTON_CONTENT(NLS)->eta   = eta;
+  NEWTON_CONTENT(NLS)->fnorm = fnorm;
+}
@@ -0,0 +1,191 @@
+/* -----------------------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------------------
+ * Unit test for the CPU fused integrator kernels. The problem
+ *
+ *   y_i' = -(i + 1) y_i,  y_i(0) = 1,  i = 0, ..., N - 1
+ *
+ * is solved with the diagonal linear solver and inequality constraints with
+ * and without fused kernels using scalar and vector absolute tolerances. The
+ * solutions should agree to roundoff.
+ * ---------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "nvector/nvector_serial.h"
+#include "cvode/cvode.h"
+#include "cvode/cvode_diag.h"
+#include "sundials/sundials_math.h"
+
+#define ZERO SUN_RCONST(0.0)
+#define ONE  SUN_RCONST(1.0)
+
+#define NEQ  32
+#define TOUT SUN_RCONST(1.0)
+#define RTOL SUN_RCONST(1.0e-6)
+#define ATOL SUN_RCONST(1.0e-10)
+
+/* Right-hand side function */
+static int f(realtype t, N_Vector y, N_Vector ydot, void *user_data)
+{
+  sunindextype i;
+  realtype     *yd  = N_VGetArrayPointer(y);
+  realtype     *ydd = N_VGetArrayPointer(ydot);
+
+  for (i = 0; i < NEQ; i++)
+    ydd[i] = -((realtype) (i + 1)) * yd[i];
+
+  return 0;
+}
+
+/* Integrate to TOUT and return the solution in y */
+static int integrate(booleantype fused, booleantype vtol, N_Vector y,
+                     SUNContext sunctx)
+{
+  int      retval;
+  realtype t;
+  void     *cvode_mem = NULL;
+  N_Vector abstol     = NULL;
+  N_Vector constr     = NULL;
+
+  N_VConst(ONE, y);
+
+  abstol = N_VClone(y);
+  constr = N_VClone(y);
+  if (!abstol || !constr)
+  {
+    fprintf(stderr, "N_VClone returned NULL\n");
+    return 1;
+  }
+  N_VConst(ATOL, abstol);
+  N_VConst(ONE, constr);
+
+  cvode_mem = CVodeCreate(CV_BDF, sunctx);
+  if (!cvode_mem)
+  {
+    fprintf(stderr, "CVodeCreate returned NULL\n");
+    return 1;
+  }
+
+  retval = CVodeInit(cvode_mem, f, ZERO, y);
+  if (retval)
+  {
+    fprintf(stderr, "CVodeInit returned %i\n", retval);
+    return 1;
+  }
+
+  if (vtol) retval = CVodeSVtolerances(cvode_mem, RTOL, abstol);
+  else      retval = CVodeSStolerances(cvode_mem, RTOL, ATOL);
+  if (retval)
+  {
+    fprintf(stderr, "CVode*tolerances returned %i\n", retval);
+    return 1;
+  }
+
+  retval = CVodeSetConstraints(cvode_mem, constr);
+  if (retval)
+  {
+    fprintf(stderr, "CVodeSetConstraints returned %i\n", retval);
+    return 1;
+  }
+
+  retval = CVDiag(cvode_mem);
+  if (retval)
+  {
+    fprintf(stderr, "CVDiag returned %i\n", retval);
+    return 1;
+  }
+
+  retval = CVodeSetUseIntegratorFusedKernels(cvode_mem, fused);
+  if (retval)
+  {
+    fprintf(stderr, "CVodeSetUseIntegratorFusedKernels returned %i\n", retval);
+    return 1;
+  }
+
+  retval = CVode(cvode_mem, TOUT, y, &t, CV_NORMAL);
+  if (retval < 0)
+  {
+    fprintf(stderr, "CVode returned %i\n", retval);
+    return 1;
+  }
+
+  CVodeFree(&cvode_mem);
+  N_VDestroy(abstol);
+  N_VDestroy(constr);
+
+  return 0;
+}
+
+/* Main program */
+int main(int argc, char *argv[])
+{
+  int          retval = 0;
+  int          vtol;
+  sunindextype i;
+  realtype     err, maxerr;
+  realtype     *yd, *yfd;
+  SUNContext   sunctx = NULL;
+  N_Vector     y      = NULL;
+  N_Vector     yfused = NULL;
+
+  /* Create the SUNDIALS context object for this simulation. */
+  retval = SUNContext_Create(NULL, &sunctx);
+  if (retval)
+  {
+    fprintf(stderr, "SUNContext_Create returned %i\n", retval);
+    return 1;
+  }
+
+  y      = N_VNew_Serial(NEQ, sunctx);
+  yfused = N_VNew_Serial(NEQ, sunctx);
+  if (!y || !yfused)
+  {
+    fprintf(stderr, "N_VNew_Serial returned NULL\n");
+    return 1;
+  }
+
+  for (vtol = 0; vtol < 2; vtol++)
+  {
+    if (integrate(SUNFALSE, vtol, y, sunctx)) return 1;
+    if (integrate(SUNTRUE, vtol, yfused, sunctx)) return 1;
+
+    yd     = N_VGetArrayPointer(y);
+    yfd    = N_VGetArrayPointer(yfused);
+    maxerr = ZERO;
+    for (i = 0; i < NEQ; i++)
+    {
+      err = SUNRabs(yd[i] - yfd[i]) / (RTOL * SUNRabs(yd[i]) + ATOL);
+      if (err > maxerr) maxerr = err;
+    }
+
+    printf("%s tolerances: max weighted difference = %g\n",
+           vtol ? "vector" : "scalar", (double) maxerr);
+
+    if (maxerr > SUN_RCONST(1.0e-4))
+    {
+      fprintf(stderr, "fused and unfused solutions differ\n");
+      return 1;
+    }
+  }
+
+  /* Clean up */
+  N_VDestroy(y);
+  N_VDestroy(yfused);
+  SUNContext_Free(&sunctx);
+
+  printf("SUCCESS\n");
+
+  return 0;
+}
+
+/*---- end of file ----*/
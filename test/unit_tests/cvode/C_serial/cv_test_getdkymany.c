@@ -0,0 +1,263 @@
+/* -----------------------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------------------
+ * Unit test for CVodeGetDkyMany. A linear problem is integrated one step
+ * at a time with the Adams method. After every step the derivatives of all
+ * orders at NOUT times within the step are computed with CVodeGetDkyMany and
+ * compared with CVodeGetDky. Invalid inputs must be rejected.
+ *
+ * With a serial vector CVodeGetDkyMany evaluates all times in one pass over
+ * the data, with a ManyVector it uses N_Vector operations for each time.
+ *
+ * Usage: cv_test_getdkymany <vector type: 0 = serial, 1 = ManyVector>
+ * ---------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "nvector/nvector_serial.h"
+#include "nvector/nvector_manyvector.h"
+#include "sunnonlinsol/sunnonlinsol_fixedpoint.h"
+#include "cvode/cvode.h"
+#include "sundials/sundials_math.h"
+
+#define ZERO SUN_RCONST(0.0)
+#define ONE  SUN_RCONST(1.0)
+
+#define NEQ    300
+#define NOUT   37
+#define NSTEPS 60
+#define RTOL   SUN_RCONST(1.0e-8)
+#define ATOL   SUN_RCONST(1.0e-10)
+#define TOL    SUN_RCONST(1.0e-10)
+
+/* y_i' = -(1 + i/NEQ) y_i + 1/(1 + t) */
+static int f(realtype t, N_Vector y, N_Vector ydot, void *user_data)
+{
+  realtype *yd, *fd;
+  sunindextype i;
+
+  /* with a ManyVector the data is accessed through the subvector */
+  if (N_VGetVectorID(y) == SUNDIALS_NVEC_MANYVECTOR)
+  {
+    yd = N_VGetArrayPointer(N_VGetSubvector_ManyVector(y, 0));
+    fd = N_VGetArrayPointer(N_VGetSubvector_ManyVector(ydot, 0));
+  }
+  else
+  {
+    yd = N_VGetArrayPointer(y);
+    fd = N_VGetArrayPointer(ydot);
+  }
+
+  for (i = 0; i < NEQ; i++)
+    fd[i] = -(ONE + (realtype) i / NEQ) * yd[i] + ONE / (ONE + t);
+
+  return 0;
+}
+
+/* Create a vector of the requested type */
+static N_Vector NewVector(int vtype, SUNContext sunctx)
+{
+  N_Vector v = N_VNew_Serial(NEQ, sunctx);
+  if (v == NULL || vtype == 0) return v;
+  return N_VNew_ManyVector(1, &v, sunctx);
+}
+
+static void DestroyVector(N_Vector v)
+{
+  if (N_VGetVectorID(v) == SUNDIALS_NVEC_MANYVECTOR)
+    N_VDestroy(N_VGetSubvector_ManyVector(v, 0));
+  N_VDestroy(v);
+}
+
+/* Main program */
+int main(int argc, char *argv[])
+{
+  int                 retval     = 0;
+  int                 vtype      = 0;
+  int                 nfail      = 0;
+  int                 i, k, q, step;
+  SUNContext          sunctx     = NULL;
+  N_Vector            y          = NULL;
+  N_Vector            dky        = NULL;
+  N_Vector            *dkys      = NULL;
+  SUNNonlinearSolver  NLS        = NULL;
+  void                *cvode_mem = NULL;
+  realtype            t[NOUT];
+  realtype            tret, hlast, err, maxerr;
+
+  if (argc > 1) vtype = atoi(argv[1]);
+
+  /* Create the SUNDIALS context object for this simulation. */
+  retval = SUNContext_Create(NULL, &sunctx);
+  if (retval)
+  {
+    fprintf(stderr, "SUNContext_Create returned %i\n", retval);
+    return 1;
+  }
+
+  /* Create vectors */
+  y    = NewVector(vtype, sunctx);
+  dky  = NewVector(vtype, sunctx);
+  dkys = (N_Vector*) malloc(NOUT * sizeof(N_Vector));
+  if (!y || !dky || !dkys)
+  {
+    fprintf(stderr, "Vector allocation failed\n");
+    return 1;
+  }
+  for (i = 0; i < NOUT; i++)
+  {
+    dkys[i] = NewVector(vtype, sunctx);
+    if (!dkys[i])
+    {
+      fprintf(stderr, "Vector allocation failed\n");
+      return 1;
+    }
+  }
+  N_VConst(ONE, y);
+
+  /* Create and setup CVODE */
+  cvode_mem = CVodeCreate(CV_ADAMS, sunctx);
+  if (!cvode_mem)
+  {
+    fprintf(stderr, "CVodeCreate returned NULL\n");
+    return 1;
+  }
+
+  retval = CVodeInit(cvode_mem, f, ZERO, y);
+  if (retval)
+  {
+    fprintf(stderr, "CVodeInit returned %i\n", retval);
+    return 1;
+  }
+
+  retval = CVodeSStolerances(cvode_mem, RTOL, ATOL);
+  if (retval)
+  {
+    fprintf(stderr, "CVodeSStolerances returned %i\n", retval);
+    return 1;
+  }
+
+  NLS = SUNNonlinSol_FixedPoint(y, 0, sunctx);
+  if (!NLS)
+  {
+    fprintf(stderr, "SUNNonlinSol_FixedPoint returned NULL\n");
+    return 1;
+  }
+
+  retval = CVodeSetNonlinearSolver(cvode_mem, NLS);
+  if (retval)
+  {
+    fprintf(stderr, "CVodeSetNonlinearSolver returned %i\n", retval);
+    return 1;
+  }
+
+  /* Compare CVodeGetDkyMany and CVodeGetDky after each step */
+  maxerr = ZERO;
+  for (step = 0; step < NSTEPS; step++)
+  {
+    retval = CVode(cvode_mem, SUN_RCONST(100.0), y, &tret, CV_ONE_STEP);
+    if (retval < 0)
+    {
+      fprintf(stderr, "CVode returned %i\n", retval);
+      return 1;
+    }
+
+    retval  = CVodeGetLastStep(cvode_mem, &hlast);
+    retval += CVodeGetLastOrder(cvode_mem, &q);
+    if (retval)
+    {
+      fprintf(stderr, "CVodeGetLastStep or CVodeGetLastOrder failed\n");
+      return 1;
+    }
+
+    for (i = 0; i < NOUT; i++)
+      t[i] = tret - hlast + hlast * (realtype) i / (NOUT - 1);
+
+    for (k = 0; k <= q; k++)
+    {
+      retval = CVodeGetDkyMany(cvode_mem, NOUT, t, k, dkys);
+      if (retval)
+      {
+        fprintf(stderr, "CVodeGetDkyMany returned %i\n", retval);
+        return 1;
+      }
+
+      for (i = 0; i < NOUT; i++)
+      {
+        retval = CVodeGetDky(cvode_mem, t[i], k, dky);
+        if (retval)
+        {
+          fprintf(stderr, "CVodeGetDky returned %i\n", retval);
+          return 1;
+        }
+
+        /* relative difference */
+        err = N_VMaxNorm(dky);
+        N_VLinearSum(ONE, dkys[i], -ONE, dky, dky);
+        err = N_VMaxNorm(dky) / SUNMAX(err, ONE);
+        maxerr = SUNMAX(maxerr, err);
+      }
+    }
+  }
+
+  printf("Max relative difference = %g\n", (double) maxerr);
+  if (maxerr > TOL)
+  {
+    fprintf(stderr, "CVodeGetDkyMany and CVodeGetDky differ\n");
+    nfail++;
+  }
+
+  /* Invalid inputs */
+  t[0] = tret + ONE;
+  if (CVodeGetDkyMany(cvode_mem, NOUT, t, 0, dkys) != CV_BAD_T)
+  {
+    fprintf(stderr, "A time outside of the last step was accepted\n");
+    nfail++;
+  }
+  t[0] = tret;
+  if (CVodeGetDkyMany(cvode_mem, NOUT, t, q + 1, dkys) != CV_BAD_K)
+  {
+    fprintf(stderr, "k > q was accepted\n");
+    nfail++;
+  }
+  if (CVodeGetDkyMany(cvode_mem, -1, t, 0, dkys) != CV_ILL_INPUT)
+  {
+    fprintf(stderr, "nt < 0 was accepted\n");
+    nfail++;
+  }
+  if (CVodeGetDkyMany(cvode_mem, NOUT, t, 0, NULL) != CV_BAD_DKY)
+  {
+    fprintf(stderr, "dky = NULL was accepted\n");
+    nfail++;
+  }
+
+  /* Clean up */
+  for (i = 0; i < NOUT; i++) DestroyVector(dkys[i]);
+  free(dkys);
+  DestroyVector(dky);
+  DestroyVector(y);
+  CVodeFree(&cvode_mem);
+  SUNNonlinSolFree(NLS);
+  SUNContext_Free(&sunctx);
+
+  if (nfail)
+  {
+    printf("FAIL\n");
+    return 1;
+  }
+
+  printf("SUCCESS\n");
+
+  return 0;
+}
+
+/*---- end of file ----*/
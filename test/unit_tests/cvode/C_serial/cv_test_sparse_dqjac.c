@@ -0,0 +1,335 @@
+/* -----------------------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------------------
+ * Unit test for the sparse difference quotient Jacobian approximation. The
+ * linear problem y' = A y, with A sparse, is integrated using a CSC or CSR
+ * SUNMATRIX_SPARSE matrix and the Jacobian sparsity pattern. The saved
+ * Jacobian must match A, and each Jacobian evaluation must use one right-hand
+ * side evaluation per column color.
+ *
+ * The sparse system matrix is solved by copying it into a dense matrix and
+ * using the dense linear solver so the test does not require KLU or SuperLU.
+ *
+ * Usage: cv_test_sparse_dqjac <sparse type: 0 = CSC, 1 = CSR>
+ * ---------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "nvector/nvector_serial.h"
+#include "sunmatrix/sunmatrix_dense.h"
+#include "sunmatrix/sunmatrix_sparse.h"
+#include "sunlinsol/sunlinsol_dense.h"
+#include "cvode/cvode.h"
+#include "sundials/sundials_math.h"
+
+#define ZERO SUN_RCONST(0.0)
+#define ONE  SUN_RCONST(1.0)
+
+#define NEQ  64
+#define TOUT SUN_RCONST(1.0)
+#define RTOL SUN_RCONST(1.0e-6)
+#define ATOL SUN_RCONST(1.0e-10)
+
+/* -----------------------------------------------------------------------------
+ * Test linear solver: densify the sparse matrix and use the dense solver
+ * ---------------------------------------------------------------------------*/
+
+typedef struct {
+  SUNMatrix       D;
+  SUNLinearSolver LS;
+} *DenseWrapperContent;
+
+static SUNLinearSolver_Type DenseWrapperGetType(SUNLinearSolver S)
+{
+  return SUNLINEARSOLVER_DIRECT;
+}
+
+static int DenseWrapperSetup(SUNLinearSolver S, SUNMatrix A)
+{
+  DenseWrapperContent content = (DenseWrapperContent) S->content;
+  sunindextype p, k;
+  sunindextype *ptrs = SUNSparseMatrix_IndexPointers(A);
+  sunindextype *vals = SUNSparseMatrix_IndexValues(A);
+  realtype     *data = SUNSparseMatrix_Data(A);
+
+  SUNMatZero(content->D);
+  for (p = 0; p < SUNSparseMatrix_NP(A); p++)
+  {
+    for (k = ptrs[p]; k < ptrs[p + 1]; k++)
+    {
+      if (SUNSparseMatrix_SparseType(A) == CSC_MAT)
+        SM_ELEMENT_D(content->D, vals[k], p) = data[k];
+      else
+        SM_ELEMENT_D(content->D, p, vals[k]) = data[k];
+    }
+  }
+
+  return SUNLinSolSetup(content->LS, content->D);
+}
+
+static int DenseWrapperSolve(SUNLinearSolver S, SUNMatrix A, N_Vector x,
+                             N_Vector b, realtype tol)
+{
+  DenseWrapperContent content = (DenseWrapperContent) S->content;
+  return SUNLinSolSolve(content->LS, content->D, x, b, tol);
+}
+
+static int DenseWrapperFree(SUNLinearSolver S)
+{
+  DenseWrapperContent content = (DenseWrapperContent) S->content;
+  SUNLinSolFree(content->LS);
+  SUNMatDestroy(content->D);
+  free(content);
+  SUNLinSolFreeEmpty(S);
+  return 0;
+}
+
+static SUNLinearSolver DenseWrapper(N_Vector y, SUNContext sunctx)
+{
+  SUNLinearSolver     S;
+  DenseWrapperContent content;
+
+  S = SUNLinSolNewEmpty(sunctx);
+  if (!S) return NULL;
+
+  S->ops->gettype = DenseWrapperGetType;
+  S->ops->setup   = DenseWrapperSetup;
+  S->ops->solve   = DenseWrapperSolve;
+  S->ops->free    = DenseWrapperFree;
+
+  content     = (DenseWrapperContent) malloc(sizeof *content);
+  content->D  = SUNDenseMatrix(NEQ, NEQ, sunctx);
+  content->LS = SUNLinSol_Dense(y, content->D, sunctx);
+  S->content  = content;
+
+  return S;
+}
+
+/* -----------------------------------------------------------------------------
+ * Problem
+ * ---------------------------------------------------------------------------*/
+
+/* Fill the dense matrix A: a stiff tridiagonal matrix with periodic coupling
+   and a few long range entries */
+static void FillA(SUNMatrix A)
+{
+  sunindextype i;
+
+  SUNMatZero(A);
+  for (i = 0; i < NEQ; i++)
+  {
+    SM_ELEMENT_D(A, i, i) = -((realtype) (i + 1));
+    SM_ELEMENT_D(A, i, (i + 1) % NEQ)       = SUN_RCONST(0.5);
+    SM_ELEMENT_D(A, i, (i + NEQ - 1) % NEQ) = SUN_RCONST(0.25);
+    if (i % 16 == 0)
+      SM_ELEMENT_D(A, i, (i + NEQ / 2) % NEQ) = SUN_RCONST(0.125);
+  }
+}
+
+/* Right-hand side function, f(t,y) = A y */
+static int f(realtype t, N_Vector y, N_Vector ydot, void *user_data)
+{
+  return SUNMatMatvec((SUNMatrix) user_data, y, ydot);
+}
+
+/* Main program */
+int main(int argc, char *argv[])
+{
+  int             retval    = 0;
+  int             sparsetype;
+  sunindextype    p, k, i, j, maxrow, nnzrow;
+  sunindextype    *ptrs, *vals;
+  realtype        t, err, maxerr;
+  realtype        *data;
+  long int        ncolors, nje, nfeLS;
+  SUNContext      sunctx    = NULL;
+  N_Vector        y         = NULL;
+  SUNMatrix       Ad        = NULL;
+  SUNMatrix       S         = NULL;
+  SUNMatrix       A         = NULL;
+  SUNMatrix       J         = NULL;
+  SUNLinearSolver LS        = NULL;
+  void            *cvode_mem = NULL;
+
+  if (argc < 2)
+  {
+    fprintf(stderr, "ERROR: ONE (1) input required\n");
+    fprintf(stderr, "  sparse type (0 = CSC, 1 = CSR)\n");
+    return 1;
+  }
+  sparsetype = (atoi(argv[1]) == 0) ? CSC_MAT : CSR_MAT;
+
+  /* Create the SUNDIALS context object for this simulation. */
+  retval = SUNContext_Create(NULL, &sunctx);
+  if (retval)
+  {
+    fprintf(stderr, "SUNContext_Create returned %i\n", retval);
+    return 1;
+  }
+
+  y  = N_VNew_Serial(NEQ, sunctx);
+  Ad = SUNDenseMatrix(NEQ, NEQ, sunctx);
+  if (!y || !Ad)
+  {
+    fprintf(stderr, "Vector or matrix allocation failed\n");
+    return 1;
+  }
+  FillA(Ad);
+  N_VConst(ONE, y);
+
+  /* Sparsity pattern and system matrix */
+  S = SUNSparseFromDenseMatrix(Ad, ZERO, sparsetype);
+  A = SUNSparseMatrix(NEQ, NEQ, SUNSparseMatrix_NNZ(S), sparsetype, sunctx);
+  LS = DenseWrapper(y, sunctx);
+  if (!S || !A || !LS)
+  {
+    fprintf(stderr, "Sparse matrix or linear solver allocation failed\n");
+    return 1;
+  }
+
+  cvode_mem = CVodeCreate(CV_BDF, sunctx);
+  if (!cvode_mem)
+  {
+    fprintf(stderr, "CVodeCreate returned NULL\n");
+    return 1;
+  }
+
+  retval = CVodeInit(cvode_mem, f, ZERO, y);
+  if (retval)
+  {
+    fprintf(stderr, "CVodeInit returned %i\n", retval);
+    return 1;
+  }
+
+  retval = CVodeSStolerances(cvode_mem, RTOL, ATOL);
+  if (retval)
+  {
+    fprintf(stderr, "CVodeSStolerances returned %i\n", retval);
+    return 1;
+  }
+
+  retval = CVodeSetUserData(cvode_mem, Ad);
+  if (retval)
+  {
+    fprintf(stderr, "CVodeSetUserData returned %i\n", retval);
+    return 1;
+  }
+
+  retval = CVodeSetLinearSolver(cvode_mem, LS, A);
+  if (retval)
+  {
+    fprintf(stderr, "CVodeSetLinearSolver returned %i\n", retval);
+    return 1;
+  }
+
+  retval = CVodeSetJacSparsityPattern(cvode_mem, S);
+  if (retval)
+  {
+    fprintf(stderr, "CVodeSetJacSparsityPattern returned %i\n", retval);
+    return 1;
+  }
+
+  retval = CVode(cvode_mem, TOUT, y, &t, CV_NORMAL);
+  if (retval < 0)
+  {
+    fprintf(stderr, "CVode returned %i\n", retval);
+    return 1;
+  }
+
+  /* Check the number of colors and f evaluations */
+  retval  = CVodeGetNumJacColors(cvode_mem, &ncolors);
+  retval += CVodeGetNumJacEvals(cvode_mem, &nje);
+  retval += CVodeGetNumLinRhsEvals(cvode_mem, &nfeLS);
+  if (retval)
+  {
+    fprintf(stderr, "CVodeGet* returned an error\n");
+    return 1;
+  }
+
+  /* at least the maximum number of nonzeros in a row are needed */
+  ptrs   = SUNSparseMatrix_IndexPointers(S);
+  vals   = SUNSparseMatrix_IndexValues(S);
+  maxrow = 0;
+  for (i = 0; i < NEQ; i++)
+  {
+    nnzrow = 0;
+    for (p = 0; p < NEQ; p++)
+      for (k = ptrs[p]; k < ptrs[p + 1]; k++)
+        if ((sparsetype == CSC_MAT && vals[k] == i) ||
+            (sparsetype == CSR_MAT && p == i))
+          nnzrow++;
+    if (nnzrow > maxrow) maxrow = nnzrow;
+  }
+
+  printf("%s: colors = %ld, max row nnz = %ld, nje = %ld, nfeLS = %ld\n",
+         (sparsetype == CSC_MAT) ? "CSC" : "CSR", ncolors, (long int) maxrow,
+         nje, nfeLS);
+
+  if (ncolors < maxrow || ncolors >= NEQ / 4 || nje < 1 ||
+      nfeLS != ncolors * nje)
+  {
+    fprintf(stderr, "unexpected number of colors or f evaluations\n");
+    return 1;
+  }
+
+  /* Check the saved Jacobian against A, the error is measured relative to the
+     largest entry of A, |A_ii| = NEQ */
+  retval = CVodeGetJac(cvode_mem, &J);
+  if (retval || !J)
+  {
+    fprintf(stderr, "CVodeGetJac returned %i\n", retval);
+    return 1;
+  }
+
+  ptrs   = SUNSparseMatrix_IndexPointers(J);
+  vals   = SUNSparseMatrix_IndexValues(J);
+  data   = SUNSparseMatrix_Data(J);
+  maxerr = ZERO;
+  if (ptrs[NEQ] != SUNSparseMatrix_IndexPointers(S)[NEQ])
+  {
+    fprintf(stderr, "Jacobian pattern differs from the sparsity pattern\n");
+    return 1;
+  }
+  for (p = 0; p < NEQ; p++)
+  {
+    for (k = ptrs[p]; k < ptrs[p + 1]; k++)
+    {
+      i   = (sparsetype == CSC_MAT) ? vals[k] : p;
+      j   = (sparsetype == CSC_MAT) ? p : vals[k];
+      err = SUNRabs(data[k] - SM_ELEMENT_D(Ad, i, j)) / ((realtype) NEQ);
+      if (err > maxerr) maxerr = err;
+    }
+  }
+
+  printf("max Jacobian error relative to max |A| = %g\n", (double) maxerr);
+
+  if (maxerr > SUN_RCONST(1.0e-4))
+  {
+    fprintf(stderr, "difference quotient Jacobian is inaccurate\n");
+    return 1;
+  }
+
+  /* Clean up */
+  CVodeFree(&cvode_mem);
+  SUNLinSolFree(LS);
+  SUNMatDestroy(A);
+  SUNMatDestroy(S);
+  SUNMatDestroy(Ad);
+  N_VDestroy(y);
+  SUNContext_Free(&sunctx);
+
+  printf("SUCCESS\n");
+
+  return 0;
+}
+
+/*---- end of file ----*/
@@ -0,0 +1,300 @@
+/* -----------------------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------------------
+ * Unit test for CVodeWriteState and CVodeReadState. The Robertson problem with
+ * a root function is integrated with BDF and the dense linear solver. At every
+ * output after TSAVE the state is written, a new integrator reads the state,
+ * and the original integrator reads back its own state so that both recompute
+ * their Jacobian on the next step. Both integrators must then produce
+ * identical solutions, root returns, and counters up to the next output. A
+ * state written by an integrator with a different maximum order must be
+ * rejected.
+ * ---------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "nvector/nvector_serial.h"
+#include "sunmatrix/sunmatrix_dense.h"
+#include "sunlinsol/sunlinsol_dense.h"
+#include "cvode/cvode.h"
+
+#define ZERO SUN_RCONST(0.0)
+#define ONE  SUN_RCONST(1.0)
+
+#define NEQ   3
+#define RTOL  SUN_RCONST(1.0e-6)
+#define ATOL  SUN_RCONST(1.0e-10)
+#define TSAVE SUN_RCONST(0.4)
+#define TEND  SUN_RCONST(4.0e6)
+#define TMULT SUN_RCONST(2.0)
+
+/* Robertson chemical kinetics */
+static int f(realtype t, N_Vector y, N_Vector ydot, void *user_data)
+{
+  realtype *yd = N_VGetArrayPointer(y);
+  realtype *fd = N_VGetArrayPointer(ydot);
+
+  fd[0] = SUN_RCONST(-0.04) * yd[0] + SUN_RCONST(1.0e4) * yd[1] * yd[2];
+  fd[2] = SUN_RCONST(3.0e7) * yd[1] * yd[1];
+  fd[1] = -fd[0] - fd[2];
+
+  return 0;
+}
+
+/* Roots where y1 and y3 cross given values */
+static int g(realtype t, N_Vector y, realtype *gout, void *user_data)
+{
+  realtype *yd = N_VGetArrayPointer(y);
+
+  gout[0] = yd[0] - SUN_RCONST(0.2);
+  gout[1] = yd[2] - SUN_RCONST(0.5);
+
+  return 0;
+}
+
+/* Create and setup an integrator */
+static void *CreateIntegrator(N_Vector y, int maxord, SUNMatrix *A,
+                              SUNLinearSolver *LS, SUNContext sunctx)
+{
+  void *cvode_mem = NULL;
+  int retval = 0;
+
+  cvode_mem = CVodeCreate(CV_BDF, sunctx);
+  if (!cvode_mem) return NULL;
+
+  *A  = SUNDenseMatrix(NEQ, NEQ, sunctx);
+  *LS = SUNLinSol_Dense(y, *A, sunctx);
+  if (!(*A) || !(*LS)) return NULL;
+
+  retval += CVodeInit(cvode_mem, f, ZERO, y);
+  retval += CVodeSStolerances(cvode_mem, RTOL, ATOL);
+  retval += CVodeRootInit(cvode_mem, 2, g);
+  retval += CVodeSetLinearSolver(cvode_mem, *LS, *A);
+  retval += CVodeSetMaxOrd(cvode_mem, maxord);
+  if (retval) return NULL;
+
+  return cvode_mem;
+}
+
+/* Compare the counters of two integrators */
+static int CompareStats(void *mem1, void *mem2)
+{
+  long int s1[6], s2[6];
+  int q1, q2, i, nfail = 0;
+  realtype h1, h2;
+
+  CVodeGetNumSteps(mem1, &s1[0]);
+  CVodeGetNumSteps(mem2, &s2[0]);
+  CVodeGetNumRhsEvals(mem1, &s1[1]);
+  CVodeGetNumRhsEvals(mem2, &s2[1]);
+  CVodeGetNumErrTestFails(mem1, &s1[2]);
+  CVodeGetNumErrTestFails(mem2, &s2[2]);
+  CVodeGetNumLinSolvSetups(mem1, &s1[3]);
+  CVodeGetNumLinSolvSetups(mem2, &s2[3]);
+  CVodeGetNumJacEvals(mem1, &s1[4]);
+  CVodeGetNumJacEvals(mem2, &s2[4]);
+  CVodeGetNumGEvals(mem1, &s1[5]);
+  CVodeGetNumGEvals(mem2, &s2[5]);
+
+  for (i = 0; i < 6; i++)
+  {
+    if (s1[i] != s2[i])
+    {
+      fprintf(stderr, "Counter %d differs: %ld vs %ld\n", i, s1[i], s2[i]);
+      nfail++;
+    }
+  }
+
+  CVodeGetLastOrder(mem1, &q1);
+  CVodeGetLastOrder(mem2, &q2);
+  CVodeGetLastStep(mem1, &h1);
+  CVodeGetLastStep(mem2, &h2);
+  if (q1 != q2 || h1 != h2)
+  {
+    fprintf(stderr, "Last order or step differs\n");
+    nfail++;
+  }
+
+  return nfail;
+}
+
+/* Main program */
+int main(int argc, char *argv[])
+{
+  int             retval, retval2;
+  int             nfail = 0;
+  int             nroots = 0;
+  int             nrestarts = 0;
+  SUNContext      sunctx = NULL;
+  N_Vector        y = NULL, y2 = NULL;
+  SUNMatrix       A = NULL, A2 = NULL, A3 = NULL;
+  SUNLinearSolver LS = NULL, LS2 = NULL, LS3 = NULL;
+  void            *mem = NULL, *mem2 = NULL, *mem3 = NULL;
+  void            *buf = NULL;
+  long int        size, nst;
+  realtype        tout, t, t2;
+  realtype        *yd;
+
+  /* Create the SUNDIALS context object for this simulation. */
+  retval = SUNContext_Create(NULL, &sunctx);
+  if (retval)
+  {
+    fprintf(stderr, "SUNContext_Create returned %i\n", retval);
+    return 1;
+  }
+
+  y  = N_VNew_Serial(NEQ, sunctx);
+  y2 = N_VNew_Serial(NEQ, sunctx);
+  if (!y || !y2)
+  {
+    fprintf(stderr, "N_VNew_Serial returned NULL\n");
+    return 1;
+  }
+  yd    = N_VGetArrayPointer(y);
+  yd[0] = ONE;
+  yd[1] = ZERO;
+  yd[2] = ZERO;
+
+  mem = CreateIntegrator(y, 5, &A, &LS, sunctx);
+  if (!mem)
+  {
+    fprintf(stderr, "Integrator setup failed\n");
+    return 1;
+  }
+
+  /* Integrate to TSAVE before the first restart */
+  tout = SUN_RCONST(0.4);
+  while (tout <= TSAVE)
+  {
+    retval = CVode(mem, tout, y, &t, CV_NORMAL);
+    if (retval < 0)
+    {
+      fprintf(stderr, "CVode returned %i\n", retval);
+      return 1;
+    }
+    if (retval == CV_SUCCESS) tout *= TMULT;
+  }
+
+  /* At every following output write the state, read it into a new
+     integrator and back into the original, and compare both up to the
+     next output */
+  while (tout <= TEND)
+  {
+    retval = CVodeGetStateBufSize(mem, &size);
+    if (retval)
+    {
+      fprintf(stderr, "CVodeGetStateBufSize returned %i\n", retval);
+      return 1;
+    }
+
+    free(buf);
+    buf = malloc(size);
+    if (!buf)
+    {
+      fprintf(stderr, "Buffer allocation failed\n");
+      return 1;
+    }
+
+    retval = CVodeWriteState(mem, buf);
+    if (retval)
+    {
+      fprintf(stderr, "CVodeWriteState returned %i\n", retval);
+      return 1;
+    }
+
+    CVodeFree(&mem2);
+    SUNLinSolFree(LS2);
+    SUNMatDestroy(A2);
+    N_VConst(ONE, y2);
+    mem2 = CreateIntegrator(y2, 5, &A2, &LS2, sunctx);
+    if (!mem2)
+    {
+      fprintf(stderr, "Integrator setup failed\n");
+      return 1;
+    }
+
+    retval  = CVodeReadState(mem2, buf);
+    retval2 = CVodeReadState(mem, buf);
+    if (retval || retval2)
+    {
+      fprintf(stderr, "CVodeReadState returned %i, %i\n", retval, retval2);
+      return 1;
+    }
+    nrestarts++;
+
+    retval  = CVode(mem, tout, y, &t, CV_NORMAL);
+    retval2 = CVode(mem2, tout, y2, &t2, CV_NORMAL);
+    if (retval < 0 || retval2 < 0)
+    {
+      fprintf(stderr, "CVode returned %i, %i\n", retval, retval2);
+      return 1;
+    }
+
+    N_VLinearSum(ONE, y, -ONE, y2, y2);
+    if (retval != retval2 || t != t2 || N_VMaxNorm(y2) != ZERO)
+    {
+      fprintf(stderr, "Solutions differ at t = %g\n", (double) t);
+      nfail++;
+      break;
+    }
+
+    nfail += CompareStats(mem, mem2);
+    if (nfail) break;
+
+    if (retval == CV_ROOT_RETURN) nroots++;
+    if (retval == CV_SUCCESS) tout *= TMULT;
+  }
+
+  CVodeGetNumSteps(mem, &nst);
+  printf("Restarts = %d, root returns = %d, steps = %ld\n", nrestarts, nroots,
+         nst);
+
+  /* A different maximum order must be rejected */
+  mem3 = CreateIntegrator(y2, 3, &A3, &LS3, sunctx);
+  if (!mem3)
+  {
+    fprintf(stderr, "Integrator setup failed\n");
+    return 1;
+  }
+  if (CVodeReadState(mem3, buf) != CV_ILL_INPUT)
+  {
+    fprintf(stderr, "A state with a different maximum order was accepted\n");
+    nfail++;
+  }
+
+  /* Clean up */
+  free(buf);
+  CVodeFree(&mem);
+  CVodeFree(&mem2);
+  CVodeFree(&mem3);
+  SUNLinSolFree(LS);
+  SUNLinSolFree(LS2);
+  SUNLinSolFree(LS3);
+  SUNMatDestroy(A);
+  SUNMatDestroy(A2);
+  SUNMatDestroy(A3);
+  N_VDestroy(y);
+  N_VDestroy(y2);
+  SUNContext_Free(&sunctx);
+
+  if (nfail)
+  {
+    printf("FAIL\n");
+    return 1;
+  }
+
+  printf("SUCCESS\n");
+
+  return 0;
+}
+
+/*---- end of file ----*/
@@ -0,0 +1,279 @@
+/* -----------------------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------------------
+ * Unit test for the adjoint check point file. The damped oscillator
+ *
+ *   y1' = -y1 + y2,  y2' = -y1 - 0.1 y2,  y(0) = (1, 0)
+ *
+ * with the quadrature q' = y1 included in the error test is integrated
+ * forward to T = 20 and the adjoint problem yB' = -J^T yB, yB(T) = (1, 0), is
+ * integrated back to t = 0 in CV_NORMAL and CV_ONE_STEP mode with the check
+ * points in memory and in a file, optionally with a memory budget. The adjoint
+ * solutions must agree and the file must be removed by CVodeFree.
+ *
+ * Usage: cvs_test_adj_ckfile <memory budget in bytes, 0 = no budget>
+ * ---------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "nvector/nvector_serial.h"
+#include "cvodes/cvodes.h"
+#include "cvodes/cvodes_diag.h"
+#include "sundials/sundials_math.h"
+
+#define ZERO SUN_RCONST(0.0)
+#define ONE  SUN_RCONST(1.0)
+
+#define TFINAL SUN_RCONST(20.0)
+#define NSTEPS 10
+#define RTOL   SUN_RCONST(1.0e-6)
+#define ATOL   SUN_RCONST(1.0e-10)
+
+/* Check point file name, unique for each memory budget so that the test
+   runs may execute concurrently */
+static char ckfile_name[64];
+
+/* Forward right-hand side function */
+static int f(realtype t, N_Vector y, N_Vector ydot, void *user_data)
+{
+  realtype *yd  = N_VGetArrayPointer(y);
+  realtype *ydd = N_VGetArrayPointer(ydot);
+
+  ydd[0] = -yd[0] + yd[1];
+  ydd[1] = -yd[0] - SUN_RCONST(0.1) * yd[1];
+
+  return 0;
+}
+
+/* Quadrature right-hand side function */
+static int fQ(realtype t, N_Vector y, N_Vector qdot, void *user_data)
+{
+  N_VGetArrayPointer(qdot)[0] = N_VGetArrayPointer(y)[0];
+  return 0;
+}
+
+/* Adjoint right-hand side function, yB' = -J^T yB */
+static int fB(realtype t, N_Vector y, N_Vector yB, N_Vector yBdot,
+              void *user_dataB)
+{
+  realtype *yBd  = N_VGetArrayPointer(yB);
+  realtype *yBdd = N_VGetArrayPointer(yBdot);
+
+  yBdd[0] = yBd[0] + yBd[1];
+  yBdd[1] = -yBd[0] + SUN_RCONST(0.1) * yBd[1];
+
+  return 0;
+}
+
+/* Solve the forward and adjoint problems, return the adjoint at t = 0 */
+static int solve(long int budget, booleantype ckfile, int itaskB, N_Vector yB,
+                 SUNContext sunctx)
+{
+  int      retval, which, ncheck;
+  realtype t;
+  FILE     *fp;
+  void     *cvode_mem = NULL;
+  N_Vector y          = NULL;
+  N_Vector q          = NULL;
+
+  y = N_VNew_Serial(2, sunctx);
+  q = N_VNew_Serial(1, sunctx);
+  if (!y || !q)
+  {
+    fprintf(stderr, "N_VNew_Serial returned NULL\n");
+    return 1;
+  }
+  N_VGetArrayPointer(y)[0] = ONE;
+  N_VGetArrayPointer(y)[1] = ZERO;
+  N_VConst(ZERO, q);
+
+  cvode_mem = CVodeCreate(CV_BDF, sunctx);
+  if (!cvode_mem)
+  {
+    fprintf(stderr, "CVodeCreate returned NULL\n");
+    return 1;
+  }
+
+  retval  = CVodeInit(cvode_mem, f, ZERO, y);
+  retval += CVodeSStolerances(cvode_mem, RTOL, ATOL);
+  retval += CVDiag(cvode_mem);
+  retval += CVodeQuadInit(cvode_mem, fQ, q);
+  retval += CVodeQuadSStolerances(cvode_mem, RTOL, ATOL);
+  retval += CVodeSetQuadErrCon(cvode_mem, SUNTRUE);
+  retval += CVodeAdjInit(cvode_mem, NSTEPS, CV_HERMITE);
+  if (retval)
+  {
+    fprintf(stderr, "Forward problem setup failed\n");
+    return 1;
+  }
+
+  if (ckfile)
+  {
+    retval = CVodeSetAdjCheckpointFile(cvode_mem, ckfile_name);
+    if (retval)
+    {
+      fprintf(stderr, "CVodeSetAdjCheckpointFile returned %i\n", retval);
+      return 1;
+    }
+  }
+
+  if (budget > 0)
+  {
+    retval = CVodeSetAdjMemoryBudget(cvode_mem, budget);
+    if (retval)
+    {
+      fprintf(stderr, "CVodeSetAdjMemoryBudget returned %i\n", retval);
+      return 1;
+    }
+  }
+
+  retval = CVodeF(cvode_mem, TFINAL, y, &t, CV_NORMAL, &ncheck);
+  if (retval < 0)
+  {
+    fprintf(stderr, "CVodeF returned %i\n", retval);
+    return 1;
+  }
+
+  fp = fopen(ckfile_name, "r");
+  if (fp) fclose(fp);
+  if (ckfile && !fp)
+  {
+    fprintf(stderr, "check point file was not created\n");
+    return 1;
+  }
+
+  /* Backward problem */
+  N_VGetArrayPointer(yB)[0] = ONE;
+  N_VGetArrayPointer(yB)[1] = ZERO;
+
+  retval  = CVodeCreateB(cvode_mem, CV_BDF, &which);
+  retval += CVodeInitB(cvode_mem, which, fB, TFINAL, yB);
+  retval += CVodeSStolerancesB(cvode_mem, which, RTOL, ATOL);
+  retval += CVDiagB(cvode_mem, which);
+  if (retval)
+  {
+    fprintf(stderr, "Backward problem setup failed\n");
+    return 1;
+  }
+
+  if (itaskB == CV_NORMAL)
+  {
+    retval = CVodeB(cvode_mem, ZERO, CV_NORMAL);
+    if (retval < 0)
+    {
+      fprintf(stderr, "CVodeB returned %i\n", retval);
+      return 1;
+    }
+  }
+  else
+  {
+    do {
+      retval = CVodeB(cvode_mem, ZERO, CV_ONE_STEP);
+      if (retval < 0)
+      {
+        fprintf(stderr, "CVodeB returned %i\n", retval);
+        return 1;
+      }
+      retval = CVodeGetB(cvode_mem, which, &t, yB);
+    } while (t > ZERO);
+  }
+
+  retval = CVodeGetB(cvode_mem, which, &t, yB);
+  if (retval < 0)
+  {
+    fprintf(stderr, "CVodeGetB returned %i\n", retval);
+    return 1;
+  }
+
+  CVodeFree(&cvode_mem);
+  N_VDestroy(y);
+  N_VDestroy(q);
+
+  /* The check point file is removed with the adjoint memory */
+  fp = fopen(ckfile_name, "r");
+  if (fp)
+  {
+    fclose(fp);
+    fprintf(stderr, "check point file was not removed\n");
+    return 1;
+  }
+
+  return 0;
+}
+
+/* Main program */
+int main(int argc, char *argv[])
+{
+  int        retval = 0;
+  int        itaskB;
+  long int   budget;
+  realtype   err;
+  realtype   *yd, *yfd;
+  SUNContext sunctx = NULL;
+  N_Vector   yB     = NULL;
+  N_Vector   yBfile = NULL;
+
+  if (argc < 2)
+  {
+    fprintf(stderr, "ERROR: ONE (1) input required\n");
+    fprintf(stderr, "  memory budget in bytes (0 = no budget)\n");
+    return 1;
+  }
+  budget = atol(argv[1]);
+  sprintf(ckfile_name, "cvs_test_adj_ckfile_%ld.bin", budget);
+
+  /* Create the SUNDIALS context object for this simulation. */
+  retval = SUNContext_Create(NULL, &sunctx);
+  if (retval)
+  {
+    fprintf(stderr, "SUNContext_Create returned %i\n", retval);
+    return 1;
+  }
+
+  yB     = N_VNew_Serial(2, sunctx);
+  yBfile = N_VNew_Serial(2, sunctx);
+  if (!yB || !yBfile)
+  {
+    fprintf(stderr, "N_VNew_Serial returned NULL\n");
+    return 1;
+  }
+
+  for (itaskB = CV_NORMAL; itaskB <= CV_ONE_STEP; itaskB++)
+  {
+    if (solve(budget, SUNFALSE, itaskB, yB, sunctx)) return 1;
+    if (solve(budget, SUNTRUE, itaskB, yBfile, sunctx)) return 1;
+
+    yd  = N_VGetArrayPointer(yB);
+    yfd = N_VGetArrayPointer(yBfile);
+    err = SUNMAX(SUNRabs(yd[0] - yfd[0]), SUNRabs(yd[1] - yfd[1]));
+
+    printf("%s: difference = %g\n",
+           (itaskB == CV_NORMAL) ? "CV_NORMAL" : "CV_ONE_STEP", (double) err);
+
+    if (err > SUN_RCONST(1.0e-10) * (SUNRabs(yd[0]) + SUNRabs(yd[1])))
+    {
+      fprintf(stderr, "adjoint solutions differ\n");
+      return 1;
+    }
+  }
+
+  /* Clean up */
+  N_VDestroy(yB);
+  N_VDestroy(yBfile);
+  SUNContext_Free(&sunctx);
+
+  printf("SUCCESS\n");
+
+  return 0;
+}
+
+/*---- end of file ----*/
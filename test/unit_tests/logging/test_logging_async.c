@@ -0,0 +1,235 @@
+/* -----------------------------------------------------------------------------
+ * SUNDIALS Copyright Start
+ * Copyright (c) 2002-2023, Lawrence Livermore National Security
+ * and Southern Methodist University.
+ * All rights reserved.
+ *
+ * See the top-level LICENSE and NOTICE files for details.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SUNDIALS Copyright End
+ * -----------------------------------------------------------------------------
+ * Unit test for the asynchronous SUNLogger backend. Several threads queue
+ * error messages whose scope, label, format string, and string arguments are
+ * stack buffers that are overwritten right after each call. The output file is
+ * changed between two rounds of messages. The files must contain exactly the
+ * messages of each round, formatted as the synchronous logger would, and an
+ * overlong format string must be truncated.
+ * ---------------------------------------------------------------------------*/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sundials/sundials_logger.h"
+
+#define NTHREADS 4
+#define NMSGS    500
+#define CAPACITY (2 * NTHREADS * NMSGS)
+#define LINE_LEN 512
+
+static const char* files[2] = {"test_logging_async_0.log",
+                               "test_logging_async_1.log"};
+
+typedef struct {
+  SUNLogger logger;
+  int round;
+  int thread;
+} ThreadData;
+
+/* Expected message text for a message */
+static void MessageText(int round, int thread, int i, char* scope, char* label,
+                        char* msg)
+{
+  sprintf(scope, "round %d", round);
+  sprintf(label, "thread %d", thread);
+  sprintf(msg, "message %d of %s x = %.3e", i, "NMSGS", (double)i / 8);
+}
+
+static void* QueueMessages(void* ptr)
+{
+  ThreadData* data = (ThreadData*)ptr;
+  char scope[64], label[64], fmt[64], arg[64];
+  int i;
+
+  for (i = 0; i < NMSGS; i++)
+  {
+    sprintf(scope, "round %d", data->round);
+    sprintf(label, "thread %d", data->thread);
+    strcpy(fmt, "message %d of %s x = %.3e");
+    strcpy(arg, "NMSGS");
+
+    SUNLogger_QueueMsg(data->logger, SUN_LOGLEVEL_ERROR, scope, label, fmt, i,
+                       arg, (double)i / 8);
+
+    /* the logger must not depend on the buffers after the call */
+    memset(scope, 'x', sizeof(scope) - 1);
+    memset(label, 'x', sizeof(label) - 1);
+    memset(fmt, '%', sizeof(fmt) - 1);
+    memset(arg, 'x', sizeof(arg) - 1);
+    scope[63] = label[63] = fmt[63] = arg[63] = '\0';
+  }
+
+  return NULL;
+}
+
+/* Run one round of messages from NTHREADS threads */
+static int RunRound(SUNLogger logger, int round)
+{
+  pthread_t threads[NTHREADS];
+  ThreadData data[NTHREADS];
+  int t;
+
+  for (t = 0; t < NTHREADS; t++)
+  {
+    data[t].logger = logger;
+    data[t].round  = round;
+    data[t].thread = t;
+    if (pthread_create(&threads[t], NULL, QueueMessages, &data[t])) return 1;
+  }
+  for (t = 0; t < NTHREADS; t++) pthread_join(threads[t], NULL);
+
+  return 0;
+}
+
+/* Check that a file contains exactly the messages of one round */
+static int CheckFile(const char* fname, int round)
+{
+  FILE* fp;
+  char line[LINE_LEN], expected[LINE_LEN];
+  char scope[64], label[64], msg[256];
+  int* found;
+  int rank, thread, i, nlines = 0, nfail = 0;
+
+  fp = fopen(fname, "r");
+  if (fp == NULL)
+  {
+    fprintf(stderr, "Could not open %s\n", fname);
+    return 1;
+  }
+
+  found = (int*)calloc(NTHREADS * NMSGS, sizeof(int));
+
+  while (fgets(line, LINE_LEN, fp))
+  {
+    nlines++;
+    if (sscanf(line, "[ERROR][rank::%d][round %*d][thread %d] message %d",
+               &rank, &thread, &i) != 3 ||
+        thread < 0 || thread >= NTHREADS || i < 0 || i >= NMSGS)
+    {
+      fprintf(stderr, "Unexpected line in %s: %s", fname, line);
+      nfail++;
+      continue;
+    }
+
+    MessageText(round, thread, i, scope, label, msg);
+    sprintf(expected, "[ERROR][rank::%d][%s][%s] %s\n", rank, scope, label,
+            msg);
+    if (strcmp(line, expected))
+    {
+      fprintf(stderr, "Line in %s: %s differs from: %s", fname, line,
+              expected);
+      nfail++;
+    }
+    found[thread * NMSGS + i]++;
+  }
+  fclose(fp);
+
+  for (i = 0; i < NTHREADS * NMSGS; i++)
+  {
+    if (found[i] != 1)
+    {
+      fprintf(stderr, "Message %d written %d times to %s\n", i, found[i],
+              fname);
+      nfail++;
+      break;
+    }
+  }
+  if (nlines != NTHREADS * NMSGS)
+  {
+    fprintf(stderr, "%s has %d lines instead of %d\n", fname, nlines,
+            NTHREADS * NMSGS);
+    nfail++;
+  }
+
+  free(found);
+  return nfail;
+}
+
+int main(int argc, char* argv[])
+{
+  SUNLogger logger = NULL;
+  FILE* fp;
+  char fmt[600], line[LINE_LEN];
+  long int ndropped;
+  int nfail = 0;
+
+  if (SUNLogger_Create(NULL, 0, &logger))
+  {
+    fprintf(stderr, "SUNLogger_Create failed\n");
+    return 1;
+  }
+
+  if (SUNLogger_EnableAsync(logger, CAPACITY))
+  {
+    fprintf(stderr, "SUNLogger_EnableAsync failed\n");
+    return 1;
+  }
+
+  /* Two rounds of messages written to different files */
+  if (SUNLogger_SetErrorFilename(logger, files[0]) || RunRound(logger, 0))
+  {
+    fprintf(stderr, "Round 0 failed\n");
+    return 1;
+  }
+  if (SUNLogger_SetErrorFilename(logger, files[1]) || RunRound(logger, 1))
+  {
+    fprintf(stderr, "Round 1 failed\n");
+    return 1;
+  }
+  SUNLogger_Flush(logger, SUN_LOGLEVEL_ALL);
+
+  SUNLogger_GetNumDroppedMsgs(logger, &ndropped);
+  if (ndropped != 0)
+  {
+    fprintf(stderr, "%ld messages were dropped\n", ndropped);
+    nfail++;
+  }
+
+  nfail += CheckFile(files[0], 0);
+  nfail += CheckFile(files[1], 1);
+
+  /* A format string longer than the record is truncated */
+  memset(fmt, 'a', sizeof(fmt) - 1);
+  fmt[sizeof(fmt) - 1] = '\0';
+  if (SUNLogger_SetErrorFilename(logger, files[0]))
+  {
+    fprintf(stderr, "SUNLogger_SetErrorFilename failed\n");
+    return 1;
+  }
+  SUNLogger_QueueMsg(logger, SUN_LOGLEVEL_ERROR, "scope", "label", fmt);
+  SUNLogger_Destroy(&logger);
+
+  fp = fopen(files[0], "r");
+  line[0] = '\0';
+  while (fp && fgets(line, LINE_LEN, fp)) {}
+  if (fp) fclose(fp);
+  if (!strstr(line, "[scope][label] aaaa") || !strstr(line, "a[truncated]"))
+  {
+    fprintf(stderr, "Long format string was not truncated: %s\n", line);
+    nfail++;
+  }
+
+  remove(files[0]);
+  remove(files[1]);
+
+  if (nfail)
+  {
+    printf("FAIL\n");
+    return 1;
+  }
+
+  printf("SUCCESS\n");
+  return 0;
+}